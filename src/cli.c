@@ -258,7 +258,7 @@ struct pgmoneta_command command_table[] = {
    {
       .command = "verify",
       .subcommand = "",
-      .accepted_argument_count = {3, 4},
+      .accepted_argument_count = {2, 3, 4},
       .action = MANAGEMENT_VERIFY,
       .deprecated = false,
       .log_message = "<verify> [%s]",
@@ -854,10 +854,14 @@ execute:
       {
          exit_code = verify(s_ssl, socket, parsed.args[0], parsed.args[1], parsed.args[2], parsed.args[3], compression, encryption, output_format);
       }
-      else
+      else if (parsed.args[2])
       {
          exit_code = verify(s_ssl, socket, parsed.args[0], parsed.args[1], parsed.args[2], "failed", compression, encryption, output_format);
       }
+      else
+      {
+         exit_code = verify(s_ssl, socket, parsed.args[0], parsed.args[1], NULL, "failed", compression, encryption, output_format);
+      }
    }
    else if (parsed.cmd->action == MANAGEMENT_ARCHIVE)
    {
@@ -1043,7 +1047,7 @@ static void
 help_verify(void)
 {
    printf("Verify a backup for a server\n");
-   printf("  pgmoneta-cli verify <server> <timestamp|oldest|newest> <directory> [failed|all]\n");
+   printf("  pgmoneta-cli verify <server> <timestamp|oldest|newest> [<directory> [failed|all]]\n");
 }
 
 static void
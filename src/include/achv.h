@@ -36,6 +36,7 @@ extern "C" {
 #include <pgmoneta.h>
 #include <json.h>
 #include <message.h>
+#include <streamer.h>
 #include <tablespace.h>
 
 #include <stdlib.h>
@@ -62,14 +63,18 @@ int
 pgmoneta_extract_tar_file(char* file_path, char* destination);
 
 /**
- * Create a tar archive of the given directory
+ * Create a tar archive of the given directory in one pass, compressed and
+ * encrypted as configured. The files of a stored backup are decrypted and
+ * decompressed while they are written, and lose their storage suffixes
  * @param src The source directory
- * @param dst The destination tar file path
+ * @param dst The destination tar file path, including its extensions
  * @param destination The destination name
+ * @param stored Is the source the data directory of a stored backup
+ * @param workers The number of compression threads, or 0
  * @return 0 upon success, otherwise 1
  */
 int
-pgmoneta_tar_directory(char* src, char* dst, char* destination);
+pgmoneta_tar_directory(char* src, char* dst, char* destination, bool stored, int workers);
 
 /**
  * Receive backup tar files from the copy stream and write to disk
@@ -96,10 +101,12 @@ pgmoneta_receive_archive_files(SSL* ssl, int socket, struct stream_buffer* buffe
  * @param tablespaces The user level tablespaces
  * @param bucket The rate limit bucket
  * @param network_bucket The network rate limit bucket
+ * @param streamer The optional streamer, which writes each file of the tar stream
+ * in its final form instead of extracting the tar files afterwards
  * @return 0 upon success, otherwise 1
  */
 int
-pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buffer, char* basedir, struct tablespace* tablespaces, struct token_bucket* bucket, struct token_bucket* network_bucket);
+pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buffer, char* basedir, struct tablespace* tablespaces, struct token_bucket* bucket, struct token_bucket* network_bucket, struct streamer* streamer);
 
 #ifdef __cplusplus
 }
@@ -138,6 +138,24 @@ pgmoneta_decrypt_directory(char* d, struct workers* workers);
 void
 pgmoneta_decrypt_request(SSL* ssl, int client_fd, uint8_t compression, uint8_t encryption, struct json* payload);
 
+/**
+ * Derive the key and IV used for file encryption from the master key
+ * @param mode The encryption mode
+ * @param key The key, at least EVP_MAX_KEY_LENGTH bytes
+ * @param iv The IV, at least EVP_MAX_IV_LENGTH bytes
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_derive_file_key_iv(int mode, unsigned char* key, unsigned char* iv);
+
+/**
+ * Get the cipher used for file encryption
+ * @param mode The encryption mode
+ * @return The cipher
+ */
+const EVP_CIPHER*
+pgmoneta_get_file_cipher(int mode);
+
 /**
  *
  * Encrypt a buffer
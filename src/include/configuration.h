@@ -52,6 +52,7 @@ extern "C" {
 #define CONFIGURATION_ARGUMENT_MANAGEMENT             "management"
 #define CONFIGURATION_ARGUMENT_COMPRESSION            "compression"
 #define CONFIGURATION_ARGUMENT_COMPRESSION_LEVEL      "compression_level"
+#define CONFIGURATION_ARGUMENT_COMPRESSION_FRAME_SIZE "compression_frame_size"
 #define CONFIGURATION_ARGUMENT_WORKERS                "workers"
 #define CONFIGURATION_ARGUMENT_STORAGE_ENGINE         "storage_engine"
 #define CONFIGURATION_ARGUMENT_ENCRYPTION             "encryption"
@@ -65,10 +66,16 @@ extern "C" {
 #define CONFIGURATION_ARGUMENT_S3_SECRET_ACCESS_KEY   "s3_secret_access_key"
 #define CONFIGURATION_ARGUMENT_S3_BUCKET              "s3_bucket"
 #define CONFIGURATION_ARGUMENT_S3_BASE_DIR            "s3_base_dir"
+#define CONFIGURATION_ARGUMENT_S3_ENDPOINT            "s3_endpoint"
+#define CONFIGURATION_ARGUMENT_S3_PART_SIZE           "s3_part_size"
+#define CONFIGURATION_ARGUMENT_S3_CONCURRENCY         "s3_concurrency"
 #define CONFIGURATION_ARGUMENT_AZURE_STORAGE_ACCOUNT  "azure_storage_account"
 #define CONFIGURATION_ARGUMENT_AZURE_CONTAINER        "azure_container"
 #define CONFIGURATION_ARGUMENT_AZURE_SHARED_KEY       "azure_shared_key"
 #define CONFIGURATION_ARGUMENT_AZURE_BASE_DIR         "azure_base_dir"
+#define CONFIGURATION_ARGUMENT_AZURE_ENDPOINT         "azure_endpoint"
+#define CONFIGURATION_ARGUMENT_AZURE_BLOCK_SIZE       "azure_block_size"
+#define CONFIGURATION_ARGUMENT_AZURE_CONCURRENCY      "azure_concurrency"
 #define CONFIGURATION_ARGUMENT_RETENTION              "retention"
 #define CONFIGURATION_ARGUMENT_LOG_TYPE               "log_type"
 #define CONFIGURATION_ARGUMENT_LOG_LEVEL              "log_level"
@@ -89,6 +96,15 @@ extern "C" {
 #define CONFIGURATION_ARGUMENT_BACKUP_MAX_RATE        "backup_max_rate"
 #define CONFIGURATION_ARGUMENT_NETWORK_MAX_RATE       "network_max_rate"
 #define CONFIGURATION_ARGUMENT_MANIFEST               "manifest"
+#define CONFIGURATION_ARGUMENT_BACKUP_STREAMING       "backup_streaming"
+#define CONFIGURATION_ARGUMENT_BACKUP_PARALLEL        "backup_parallel"
+#define CONFIGURATION_ARGUMENT_DEDUPLICATION          "deduplication"
+#define CONFIGURATION_ARGUMENT_VERIFICATION_INTERVAL  "verification_interval"
+#define CONFIGURATION_ARGUMENT_VERIFICATION_WINDOW    "verification_window"
+#define CONFIGURATION_ARGUMENT_VERIFICATION_MAX_RATE  "verification_max_rate"
+#define CONFIGURATION_ARGUMENT_WAL_FSYNC              "wal_fsync"
+#define CONFIGURATION_ARGUMENT_WAL_FSYNC_INTERVAL     "wal_fsync_interval"
+#define CONFIGURATION_ARGUMENT_WAL_STATUS_INTERVAL    "wal_status_interval"
 #define CONFIGURATION_ARGUMENT_KEEP_ALIVE             "keep_alive"
 #define CONFIGURATION_ARGUMENT_NODELAY                "nodelay"
 #define CONFIGURATION_ARGUMENT_NON_BLOCKING           "non_blocking"
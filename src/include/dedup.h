@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PGMONETA_DEDUP_H
+#define PGMONETA_DEDUP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pgmoneta.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define DEDUP_DIRECTORY  "chunks"
+#define DEDUP_MANIFEST   "backup.chunks"
+#define DEDUP_USERS      "backup.users"
+
+/**
+ * Move the files of a full backup into the chunk store. The files are split
+ * with content-defined chunking, each chunk is stored once under its SHA-256
+ * and reference counted, and the files are replaced by backup.chunks.
+ * The directories and symbolic links of the backup are kept
+ * @param server The server
+ * @param label The label of the backup
+ * @param size The size of the chunks that were added to the store
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_dedup_backup(int server, char* label, uint64_t* size);
+
+/**
+ * Is the backup kept in the chunk store
+ * @param server The server
+ * @param label The label of the backup
+ * @return True if it is, otherwise false
+ */
+bool
+pgmoneta_dedup_is_backup(int server, char* label);
+
+/**
+ * Recreate the files of a backup from the chunk store, so it can be read
+ * like any other backup. The users of the files are counted in backup.users,
+ * so only the first one recreates them. Nothing is done for a backup not in the chunk store
+ * @param server The server
+ * @param label The label of the backup
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_dedup_materialize(int server, char* label);
+
+/**
+ * Remove the files recreated by pgmoneta_dedup_materialize again, once
+ * the last user is done with them. Must only follow a successful pgmoneta_dedup_materialize
+ * @param server The server
+ * @param label The label of the backup
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_dedup_dematerialize(int server, char* label);
+
+/**
+ * Drop the references of a backup from the chunk store, and remove the
+ * chunks no other backup refers to. Nothing is done for a backup not in the chunk store
+ * @param server The server
+ * @param label The label of the backup
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_dedup_release(int server, char* label);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
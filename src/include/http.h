@@ -42,8 +42,10 @@ extern "C" {
 #include <sys/stat.h>
 #include <sys/types.h>
 
-#define HTTP_GET 0
-#define HTTP_PUT 1
+#define HTTP_GET    0
+#define HTTP_PUT    1
+#define HTTP_POST   2
+#define HTTP_DELETE 3
 
 /**
  * Add a header
@@ -71,7 +73,7 @@ pgmoneta_http_set_header_option(CURL* handle, struct curl_slist* chunk);
  * @return 0 upon success, otherwise 1
  */
 int
-pgmoneta_http_set_request_option(CURL* handle, bool request_type);
+pgmoneta_http_set_request_option(CURL* handle, int request_type);
 
 /**
  * set the URL
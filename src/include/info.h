@@ -35,10 +35,12 @@ extern "C" {
 
 /* pgmoneta */
 #include <pgmoneta.h>
+#include <deque.h>
 #include <json.h>
 
 /* system */
 #include <stdlib.h>
+#include <sys/types.h>
 
 #define INFO_PGMONETA_VERSION          "PGMONETA_VERSION"
 #define INFO_BACKUP                    "BACKUP"
@@ -75,6 +77,9 @@ extern "C" {
 #define INFO_WAL                       "WAL"
 #define INFO_TYPE                      "TYPE"
 #define INFO_PARENT                    "PARENT"
+#define INFO_VERIFIED                  "VERIFIED"
+#define INFO_VERIFIED_FILES            "VERIFIED_FILES"
+#define INFO_VERIFIED_FAILED           "VERIFIED_FAILED"
 
 #define TYPE_FULL        0
 #define TYPE_INCREMENTAL 1
@@ -87,12 +92,15 @@ extern "C" {
 #define INCREMENTAL_PREFIX_LENGTH (sizeof(INCREMENTAL_PREFIX) - 1)
 #define MANIFEST_FILES "Files"
 
+struct stream_reader;
+
 /**
  * @struct rfile
  * An rfile stores the metadata we need to use a file on disk for reconstruction.
  * For full backup file in the chain, only file name and file pointer are initialized.
  *
- * extracted flag indicates if the file is a copy extracted from the original file
+ * The file is read in place from the backup directory. A plain file is read through the file pointer,
+ * a compressed or encrypted file is decrypted and decompressed in memory by the stream reader.
  * num_blocks is the number of blocks present inside an incremental file.
  * These are the blocks that have changed since the last checkpoint.
  * truncation_block_length is basically the shortest length this file has been between this and last checkpoint.
@@ -106,6 +114,7 @@ struct rfile
 {
    char* filepath;                     /**< The path of the backup file  */
    FILE* fp;                           /**< The file descriptor corresponding to the backup file */
+   struct stream_reader* reader;       /**< The stream reader of a compressed or encrypted backup file */
    size_t header_length;               /**< The header length */
    uint32_t num_blocks;                /**< The number of blocks present inside an incremental file */
    uint32_t* relative_block_numbers;   /**< relative_block_numbers are the relative BlockNumber of each block in the file */
@@ -157,8 +166,94 @@ struct backup
    char extra[MAX_EXTRA_PATH];                                    /**< The extra directory */
    int type;                                                      /**< The backup type */
    char parent_label[MISC_LENGTH];                                /**< The label of backup's parent, only used when backup is incremental */
+   int64_t verified;                                              /**< The oldest verification of a file, 0 if a file was never verified */
+   uint64_t verified_files;                                       /**< The number of files that have been verified */
+   uint64_t verified_failed;                                      /**< The number of files that failed their last verification */
 } __attribute__ ((aligned (64)));
 
+/** @struct info_transaction
+ * Defines a set of changes to a backup information file, which are
+ * written at once when the transaction is committed
+ */
+struct info_transaction
+{
+   char directory[MAX_PATH]; /**< The backup directory */
+   struct deque* entries;    /**< The keys and values in file order */
+};
+
+/**
+ * Begin a transaction on the backup information file of a backup
+ * @param directory The backup directory
+ * @param transaction [out] The transaction
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_info_begin(char* directory, struct info_transaction** transaction);
+
+/**
+ * Begin a transaction on a new backup information file. Nothing is
+ * written before the transaction is committed
+ * @param directory The backup directory
+ * @param label The label
+ * @param status The status
+ * @param transaction [out] The transaction
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_info_begin_new(char* directory, char* label, int status, struct info_transaction** transaction);
+
+/**
+ * Set a value: unsigned long
+ * @param transaction The transaction
+ * @param key The key
+ * @param value The value
+ */
+void
+pgmoneta_info_set_unsigned_long(struct info_transaction* transaction, char* key, unsigned long value);
+
+/**
+ * Set a value: double
+ * @param transaction The transaction
+ * @param key The key
+ * @param value The value
+ */
+void
+pgmoneta_info_set_double(struct info_transaction* transaction, char* key, double value);
+
+/**
+ * Set a value: string
+ * @param transaction The transaction
+ * @param key The key
+ * @param value The value, or NULL for an empty value
+ */
+void
+pgmoneta_info_set_string(struct info_transaction* transaction, char* key, char* value);
+
+/**
+ * Set a value: bool
+ * @param transaction The transaction
+ * @param key The key
+ * @param value The value
+ */
+void
+pgmoneta_info_set_bool(struct info_transaction* transaction, char* key, bool value);
+
+/**
+ * Commit a transaction. The backup information file is replaced
+ * with a single write, fsync and rename
+ * @param transaction The transaction
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_info_commit(struct info_transaction* transaction);
+
+/**
+ * Destroy a transaction, uncommitted changes are lost
+ * @param transaction The transaction
+ */
+void
+pgmoneta_info_destroy(struct info_transaction* transaction);
+
 /**
  * Create a backup information file
  * @param directory The backup directory
@@ -348,6 +443,19 @@ pgmoneta_rfile_create(int server, char* label, char* relative_dir, char* base_fi
 void
 pgmoneta_rfile_destroy(struct rfile* rf);
 
+/**
+ * Read the raw content of an rfile. Reads should move forward through the file,
+ * since a compressed or encrypted file is restarted when reading backwards
+ * @param rf The rfile
+ * @param offset The raw offset
+ * @param length The number of bytes wanted
+ * @param buffer The buffer
+ * @param nread [out] The number of bytes read, less than length only at the end of the file
+ * @return 0 if success, otherwise 1
+ */
+int
+pgmoneta_rfile_read(struct rfile* rf, off_t offset, size_t length, void* buffer, size_t* nread);
+
 /**
  * Initialize an rfile structure of an incremental file by reading the incremental file headers
  * @param server The server
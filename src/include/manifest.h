@@ -70,9 +70,10 @@ int
 pgmoneta_manifest_checksum_verify(char* root);
 
 /**
- * Compare manifests
- * @param manifest1 The path to the first manifest
- * @param manifest2 The path to the second manifest
+ * Compare manifests. The new manifest is indexed once, and the old manifest
+ * is read once against that index
+ * @param old_manifest The path to the old manifest
+ * @param new_manifest The path to the new manifest
  * @param deleted_files The deleted files
  * @param changed_files The changed files
  * @param added_files The added files
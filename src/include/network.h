@@ -163,6 +163,15 @@ pgmoneta_socket_is_nonblocking(int fd);
 int
 pgmoneta_socket_has_error(int fd);
 
+/**
+ * Wait for a descriptor to become readable
+ * @param fd The descriptor
+ * @param timeout The timeout in milliseconds, -1 waits forever
+ * @return 1 if readable, 0 upon timeout, otherwise -1
+ */
+int
+pgmoneta_socket_wait_readable(int fd, int timeout);
+
 /**
  * Get the network max rate for a server
  * @param server The server
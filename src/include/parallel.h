@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PGMONETA_PARALLEL_H
+#define PGMONETA_PARALLEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pgmoneta.h>
+#include <tablespace.h>
+#include <utils.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/** @struct parallel_result
+ * Defines the WAL positions of a parallel backup
+ */
+struct parallel_result
+{
+   char startpos[MISC_LENGTH];  /**< The WAL starting point */
+   char endpos[MISC_LENGTH];    /**< The WAL ending point */
+   uint32_t start_timeline;     /**< The starting timeline */
+   uint32_t end_timeline;       /**< The ending timeline */
+};
+
+/**
+ * Take a full backup of a primary over multiple connections.
+ *
+ * The backup is started once with pg_backup_start, the files of the data
+ * directory and the tablespaces are divided between one connection per worker
+ * and read with pg_read_binary_file, and the backup is finished with
+ * pg_backup_stop. The backup_label, the backup_manifest and the WAL segments
+ * of the backup are written like a BASE_BACKUP would write them
+ * @param server The server
+ * @param usr The user index
+ * @param label The label of the backup
+ * @param backup_base The root directory of the backup
+ * @param tablespaces The user level tablespaces
+ * @param hash The manifest checksum algorithm
+ * @param number_of_connections The number of connections
+ * @param bucket The rate limit bucket
+ * @param network_bucket The network rate limit bucket
+ * @param result The resulting WAL positions
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_parallel_backup(int server, int usr, char* label, char* backup_base, struct tablespace* tablespaces, int hash,
+                         int number_of_connections, struct token_bucket* bucket, struct token_bucket* network_bucket,
+                         struct parallel_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -114,6 +114,16 @@ extern "C" {
 
 #define DEFAULT_BLOCKING_TIMEOUT 30
 
+#define WAL_FSYNC_SEGMENT  0
+#define WAL_FSYNC_INTERVAL 1
+#define WAL_FSYNC_MESSAGE  2
+#define WAL_FSYNC_SYNC     3
+
+#define DEFAULT_WAL_FSYNC_INTERVAL  200
+#define DEFAULT_WAL_STATUS_INTERVAL 10
+
+#define DEFAULT_VERIFICATION_WINDOW (7 * 24 * 3600)
+
 #define UPDATE_PROCESS_TITLE_NEVER   0
 #define UPDATE_PROCESS_TITLE_STRICT  1
 #define UPDATE_PROCESS_TITLE_MINIMAL 2
@@ -204,6 +214,25 @@ extern void* shmem;
  */
 extern void* prometheus_cache_shmem;
 
+#define HISTOGRAM_BUCKETS 13
+
+#define SPACE_BACKUP       0
+#define SPACE_WAL          1
+#define SPACE_WAL_SHIPPING 2
+#define SPACE_HOT_STANDBY  3
+#define SPACE_WORKSPACE    4
+#define NUMBER_OF_SPACES   5
+
+/** @struct histogram
+ * Defines a Prometheus histogram of durations
+ */
+struct histogram
+{
+   atomic_ulong bucket[HISTOGRAM_BUCKETS]; /**< The observations per bucket, the last bucket is +Inf */
+   atomic_ulong count;                     /**< The number of observations */
+   atomic_ullong sum;                      /**< The sum of the observations in microseconds */
+};
+
 /** @struct server
  * Defines a server
  */
@@ -224,6 +253,7 @@ struct server
    int retention_years;                     /**< The retention years for the server */
    int create_slot;                         /**< Create a slot */
    atomic_bool repository;                  /**< Repository lock */
+   atomic_bool verification;                /**< Is a scheduled verification running */
    bool active_backup;                      /**< Is there an active backup */
    bool active_restore;                     /**< Is there an active restore */
    bool active_archive;                     /**< Is there an active archive */
@@ -244,6 +274,10 @@ struct server
    uint32_t cur_timeline;                   /**< Current timeline the server is on*/
    atomic_llong last_operation_time;        /**< Last operation time of the server */
    atomic_llong last_failed_operation_time; /**< Last failed operation time of the server */
+   struct histogram wal_sync_duration;      /**< Time spent syncing streamed WAL */
+   struct histogram wal_flush_lag;          /**< Time from receiving WAL until it is synced */
+   atomic_llong space[NUMBER_OF_SPACES];    /**< The used space of the server areas */
+   atomic_uint space_invalid;               /**< The server areas that must be walked again */
    char wal_shipping[MAX_PATH];             /**< The WAL shipping directory */
    char hot_standby[MAX_PATH];              /**< The hot standby directory */
    char hot_standby_overrides[MAX_PATH];    /**< The hot standby overrides directory */
@@ -254,6 +288,7 @@ struct server
    int workers;                             /**< The number of workers */
    int backup_max_rate;                     /**< Number of tokens added to the bucket with each replenishment for backup. */
    int network_max_rate;                    /**< Number of bytes of tokens added every one second to limit the netowrk backup rate */
+   int verification_max_rate;               /**< Number of bytes per second the scheduled verification may read */
    int manifest;                            /**< The manifest hash algorithm */
    int number_of_extra;                     /**< The number of source directory*/
    char extra[MAX_EXTRA][MAX_EXTRA_PATH];   /**< Source directory*/
@@ -357,6 +392,7 @@ struct main_configuration
 
    int compression_type;                        /**< The compression type */
    int compression_level;                       /**< The compression level */
+   int compression_frame_size;                  /**< The raw size of a seekable zstd frame, 0 for a single frame */
 
    int create_slot;                             /**< Create a slot */
 
@@ -374,11 +410,17 @@ struct main_configuration
    char s3_secret_access_key[MISC_LENGTH];      /**< The IAM Secret Access Key */
    char s3_bucket[MISC_LENGTH];                 /**< The S3 bucket */
    char s3_base_dir[MAX_PATH];                  /**< The S3 base directory */
+   char s3_endpoint[MISC_LENGTH];               /**< The S3 endpoint, empty for AWS */
+   int s3_part_size;                            /**< The size of a part of a multipart upload */
+   int s3_concurrency;                          /**< The number of concurrent S3 requests */
 
    char azure_storage_account[MISC_LENGTH];     /**< The Azure storage account name */
    char azure_container[MISC_LENGTH];           /**< The Azure container name */
    char azure_shared_key[MISC_LENGTH];          /**< The Azure storage account key */
    char azure_base_dir[MAX_PATH];               /**< The Azure base directory */
+   char azure_endpoint[MISC_LENGTH];            /**< The Azure endpoint, empty for Azure */
+   int azure_block_size;                        /**< The size of a block of a block blob */
+   int azure_concurrency;                       /**< The number of concurrent Azure requests */
 
    int retention_days;                          /**< The retention days for the server */
    int retention_weeks;                         /**< The retention weeks for the server */
@@ -386,6 +428,10 @@ struct main_configuration
    int retention_years;                         /**< The retention years for the server */
    int retention_interval;                      /**< The retention interval */
 
+   int verification_interval;                   /**< The scheduled verification interval in seconds, 0 is off */
+   int verification_window;                     /**< Every file of a backup is verified within this number of seconds */
+   int verification_max_rate;                   /**< Number of bytes per second the scheduled verification may read */
+
    char workspace[MAX_PATH];                    /**< A workspace for combining incremental backups */
 
    bool tls;                                    /**< Is TLS enabled */
@@ -416,6 +462,19 @@ struct main_configuration
 
    int manifest;                                /**< The manifest hash algorithm */
 
+   bool backup_streaming;                       /**< Compress, encrypt and hash the backup while receiving it */
+   bool backup_parallel;                        /**< Receive full backups over multiple connections */
+   bool deduplication;                          /**< Keep full backups in the chunk store */
+
+   int wal_fsync;                               /**< When received WAL is synced to disk */
+   int wal_fsync_interval;                      /**< The WAL sync interval in milliseconds */
+   int wal_status_interval;                     /**< The WAL status report interval in seconds */
+
+   atomic_llong space_other;                    /**< The used space of the base directory outside of the servers */
+   atomic_bool space_other_invalid;             /**< The space outside of the servers must be walked again */
+   atomic_llong space_reconciled;               /**< The time of the last full space reconciliation */
+   atomic_bool space_active;                    /**< Is a space reconciliation running */
+
 #ifdef DEBUG
    bool link;                                   /**< Do linking */
 #endif
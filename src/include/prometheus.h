@@ -98,6 +98,14 @@ pgmoneta_prometheus_reset(void);
 int
 pgmoneta_init_prometheus_cache(size_t* p_size, void** p_shmem);
 
+/**
+ * Record an observation in a histogram
+ * @param h The histogram
+ * @param usec The observed duration in microseconds
+ */
+void
+pgmoneta_prometheus_histogram_observe(struct histogram* h, int64_t usec);
+
 /**
  * Add a logging count
  * @param logging The logging type
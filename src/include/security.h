@@ -36,7 +36,9 @@ extern "C" {
 #include <pgmoneta.h>
 #include <deque.h>
 
+#include <stdbool.h>
 #include <stdlib.h>
+#include <openssl/evp.h>
 #include <openssl/ssl.h>
 
 #define HASH_ALGORITHM_DEFAULT 0
@@ -132,6 +134,16 @@ pgmoneta_create_sha384_file(char* filename, char** sha384);
 int
 pgmoneta_create_sha512_file(char* filename, char** sha512);
 
+/**
+ * Generate SHA256 for a buffer
+ * @param buffer The buffer
+ * @param size The size of the buffer
+ * @param sha256 The hash value
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_create_sha256_buffer(void* buffer, size_t size, char** sha256);
+
 /**
  * Update the SHA512 hash for a specific file in the backup.sha512 file
  * @param root_dir The root directory of the backup
@@ -141,6 +153,77 @@ pgmoneta_create_sha512_file(char* filename, char** sha512);
 int
 pgmoneta_update_sha512(char* root_dir, char* filename);
 
+/** @struct file_hash
+ * Defines the digests of a file that are computed while the file is written
+ */
+struct file_hash
+{
+   EVP_MD_CTX* sha256;   /**< The SHA-256 context, or NULL */
+   EVP_MD_CTX* sha512;   /**< The SHA-512 context */
+};
+
+/**
+ * Start collecting the digests of the files written by the compression and
+ * encryption stages, so backup.sha512 and backup.sha256 don't read the backup again.
+ * Starting an active collection keeps it
+ * @param sha256 Also collect SHA-256
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_hash_collector_start(bool sha256);
+
+/**
+ * Get the collected digests of a file. They are only returned when the
+ * file still has the size it had when it was written
+ * @param path The path of the file
+ * @param sha256 The SHA-256, or NULL if it isn't wanted
+ * @param sha512 The SHA-512, or NULL if it isn't wanted
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_hash_collector_get(char* path, char** sha256, char** sha512);
+
+/**
+ * Stop collecting digests and forget the collected ones
+ */
+void
+pgmoneta_hash_collector_stop(void);
+
+/**
+ * Create the digests of a file being written. No digests are created
+ * when no collection is active, and the file_hash is NULL
+ * @param hash The resulting file_hash
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_file_hash_create(struct file_hash** hash);
+
+/**
+ * Add written data to the digests
+ * @param hash The file_hash, may be NULL
+ * @param data The data
+ * @param size The size of the data
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_file_hash_update(struct file_hash* hash, void* data, size_t size);
+
+/**
+ * Finish the digests of a written and closed file, and add them to the collection
+ * @param hash The file_hash, may be NULL
+ * @param path The path of the file
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_file_hash_finish(struct file_hash* hash, char* path);
+
+/**
+ * Destroy the digests of a file
+ * @param hash The file_hash
+ */
+void
+pgmoneta_file_hash_destroy(struct file_hash* hash);
+
 /**
  * Generate SHA256 for a string.
  * @param filename The string.
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PGMONETA_SPACE_H
+#define PGMONETA_SPACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pgmoneta.h>
+
+#include <stdint.h>
+
+#define SPACE_OTHER -1
+
+#define SPACE_RECONCILE_INTERVAL 3600
+
+/**
+ * Add to the used space of a server area. The counters are kept in shared
+ * memory, so status and metrics do not have to walk the repository
+ * @param server The server, or SPACE_OTHER for the rest of the base directory
+ * @param area The area, like SPACE_BACKUP
+ * @param delta The number of bytes added, negative when removed
+ */
+void
+pgmoneta_space_add(int server, int area, int64_t delta);
+
+/**
+ * Mark the used space of a server area as unknown, so the next
+ * reconciliation walks it again
+ * @param server The server, or SPACE_OTHER for the rest of the base directory
+ * @param area The area, like SPACE_BACKUP
+ */
+void
+pgmoneta_space_invalidate(int server, int area);
+
+/**
+ * Get the space used by a file, counted like pgmoneta_directory_size does
+ * @param path The path of the file
+ * @return The used space
+ */
+int64_t
+pgmoneta_space_file(char* path);
+
+/**
+ * Get the used space of a server area. The area is walked
+ * until the first reconciliation has run
+ * @param server The server
+ * @param area The area, like SPACE_BACKUP
+ * @return The used space
+ */
+uint64_t
+pgmoneta_space_get(int server, int area);
+
+/**
+ * Get the used space of a server, which is its backups and WAL
+ * @param server The server
+ * @return The used space
+ */
+uint64_t
+pgmoneta_space_server(int server);
+
+/**
+ * Get the used space of the base directory
+ * @return The used space
+ */
+uint64_t
+pgmoneta_space_used(void);
+
+/**
+ * Reconcile the counters with the file system. The areas marked as unknown
+ * are walked, and every SPACE_RECONCILE_INTERVAL seconds all of them are.
+ * The caller claims space_active, so only one reconciliation runs
+ */
+void
+pgmoneta_space_reconcile(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PGMONETA_STREAMER_H
+#define PGMONETA_STREAMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pgmoneta.h>
+#include <art.h>
+#include <zstandard_compression.h>
+
+#include <bzlib.h>
+#include <lz4.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <zlib.h>
+#include <zstd.h>
+#include <openssl/evp.h>
+
+/** @struct streamer
+ * Defines a streamer, which turns the raw content of a file into its final
+ * compressed and encrypted form while it is being written
+ */
+struct streamer
+{
+   int compression;                                /**< The client side compression type */
+   int level;                                      /**< The compression level */
+   int encryption;                                 /**< The encryption type */
+   int hash;                                       /**< The checksum algorithm of the raw content */
+   char root[MAX_PATH];                            /**< The root directory of the backup */
+   char path[MAX_PATH];                            /**< The path of the current file */
+   char manifest_path[MAX_PATH];                   /**< The manifest path of the current file */
+   FILE* file;                                     /**< The current file */
+   bool compress;                                  /**< Compress the current file */
+   bool encrypt;                                   /**< Encrypt the current file */
+   size_t file_size;                               /**< The raw size of the current file */
+   uint64_t total_size;                            /**< The raw size of all the files */
+   uint64_t biggest_file_size;                     /**< The raw size of the biggest file */
+   uint32_t crc;                                   /**< The CRC32C of the raw content */
+   EVP_MD_CTX* checksum;                           /**< The digest of the raw content */
+   EVP_MD_CTX* sha512;                             /**< The SHA-512 of the stored content */
+   EVP_CIPHER_CTX* cipher;                         /**< The cipher context */
+   unsigned char key[EVP_MAX_KEY_LENGTH];          /**< The encryption key */
+   unsigned char iv[EVP_MAX_IV_LENGTH];            /**< The encryption IV */
+   ZSTD_CCtx* zstd;                                /**< The Zstandard context */
+   struct zstd_seek_table* seek_table;             /**< The Zstandard seek table of the current file */
+   size_t frame_size;                              /**< The raw size of a seekable Zstandard frame */
+   size_t frame_raw;                               /**< The raw size of the current Zstandard frame */
+   size_t frame_compressed;                        /**< The compressed size of the current Zstandard frame */
+   z_stream* gzip;                                 /**< The GZip stream */
+   bz_stream* bzip2;                               /**< The BZip2 stream */
+   LZ4_stream_t* lz4;                              /**< The LZ4 stream */
+   char* lz4_in;                                   /**< The LZ4 double input block */
+   int lz4_index;                                  /**< The current LZ4 input block */
+   size_t lz4_length;                              /**< The length of the current LZ4 input block */
+   unsigned char* out;                             /**< The compression output buffer */
+   size_t out_size;                                /**< The size of the compression output buffer */
+   unsigned char* enc;                             /**< The encryption output buffer */
+   size_t enc_size;                                /**< The size of the encryption output buffer */
+   struct art* checksums;                          /**< The checksums of the raw content by manifest path */
+   struct art* hashes;                             /**< The SHA-512 of the stored files by backup relative path */
+};
+
+/** @struct stream_reader
+ * Defines a stream reader, which turns a stored file back into its raw
+ * content while it is being read, without extracting it to the workspace
+ */
+struct stream_reader
+{
+   char path[MAX_PATH];                            /**< The path of the stored file */
+   FILE* file;                                     /**< The stored file */
+   int compression;                                /**< The compression type of the stored file */
+   int encryption;                                 /**< The encryption type of the stored file */
+   uint64_t position;                              /**< The raw offset of the next read */
+   bool eof;                                       /**< The stored file has been consumed */
+   bool end;                                       /**< The raw content has been consumed */
+   bool complete;                                  /**< The compressed content is at a stream boundary */
+   EVP_CIPHER_CTX* cipher;                         /**< The cipher context */
+   unsigned char key[EVP_MAX_KEY_LENGTH];          /**< The encryption key */
+   unsigned char iv[EVP_MAX_IV_LENGTH];            /**< The encryption IV */
+   ZSTD_DCtx* zstd;                                /**< The Zstandard context */
+   struct zstd_seek_table* seek_table;             /**< The seek table of a seekable Zstandard file */
+   z_stream* gzip;                                 /**< The GZip stream */
+   bz_stream* bzip2;                               /**< The BZip2 stream */
+   LZ4_streamDecode_t* lz4;                        /**< The LZ4 stream */
+   char* lz4_in;                                   /**< The current LZ4 compressed block */
+   char* lz4_out;                                  /**< The LZ4 double output block */
+   int lz4_index;                                  /**< The current LZ4 output block */
+   unsigned char* in;                              /**< The stored content buffer */
+   unsigned char* dec;                             /**< The compressed content buffer */
+   size_t dec_size;                                /**< The size of the compressed content buffer */
+   size_t dec_pos;                                 /**< The offset into the compressed content */
+   size_t dec_length;                              /**< The length of the compressed content */
+   unsigned char* out;                             /**< The raw content buffer */
+   unsigned char* raw;                             /**< The pending raw content */
+   size_t raw_pos;                                 /**< The offset into the pending raw content */
+   size_t raw_length;                              /**< The length of the pending raw content */
+};
+
+/**
+ * Create a streamer for a backup using the compression, encryption
+ * and manifest checksum settings of the server
+ * @param server The server
+ * @param root The root directory of the backup
+ * @param streamer The resulting streamer
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_streamer_create(int server, char* root, struct streamer** streamer);
+
+/**
+ * Start a new file. The compression and encryption suffixes are added to the path
+ * @param streamer The streamer
+ * @param path The path of the raw file
+ * @param manifest_path The path of the file in the backup manifest
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_streamer_open(struct streamer* streamer, char* path, char* manifest_path);
+
+/**
+ * Write raw content to the current file
+ * @param streamer The streamer
+ * @param data The data
+ * @param size The size of the data
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_streamer_write(struct streamer* streamer, void* data, size_t size);
+
+/**
+ * Finish the current file, and record its checksum and SHA-512
+ * @param streamer The streamer
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_streamer_close(struct streamer* streamer);
+
+/**
+ * Verify the recorded checksums against a backup manifest
+ * @param streamer The streamer
+ * @param manifest The path of the backup manifest
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_streamer_verify(struct streamer* streamer, char* manifest);
+
+/**
+ * Destroy a streamer, an open file is removed
+ * @param streamer The streamer
+ */
+void
+pgmoneta_streamer_destroy(struct streamer* streamer);
+
+/**
+ * Create a stream reader for a stored file. The compression and encryption
+ * are detected from the suffixes of the path
+ * @param path The path of the stored file
+ * @param reader The resulting stream reader
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_stream_reader_create(char* path, struct stream_reader** reader);
+
+/**
+ * Read raw content from the current position
+ * @param reader The stream reader
+ * @param buffer The buffer
+ * @param size The number of bytes wanted
+ * @param length The number of bytes read, less than size only at the end of the content
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_stream_reader_read(struct stream_reader* reader, void* buffer, size_t size, size_t* length);
+
+/**
+ * Move to a raw offset. Moving forward decodes and discards the content in between,
+ * moving backward restarts the stream. A seekable Zstandard file starts over
+ * at the frame holding the offset instead. Moving past the end stops at the end
+ * @param reader The stream reader
+ * @param offset The raw offset
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_stream_reader_seek(struct stream_reader* reader, uint64_t offset);
+
+/**
+ * Calculate the checksum of the raw content from the current position to the end,
+ * in the format of the backup manifest
+ * @param reader The stream reader
+ * @param hash The hash algorithm
+ * @param checksum The resulting checksum
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_stream_reader_checksum(struct stream_reader* reader, int hash, char** checksum);
+
+/**
+ * Destroy a stream reader
+ * @param reader The stream reader
+ */
+void
+pgmoneta_stream_reader_destroy(struct stream_reader* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PGMONETA_STRING_BUILDER_H
+#define PGMONETA_STRING_BUILDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pgmoneta.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** @struct string_builder
+ * Defines a string builder, which keeps track of the length of the string
+ * and grows its allocation geometrically, so appending is amortized constant time.
+ * A failed append sets the error flag, and every append after it is ignored,
+ * so a series of appends only needs the flag checked once at the end
+ */
+struct string_builder
+{
+   char* data;      /**< The string, always terminated */
+   size_t length;   /**< The length of the string */
+   size_t capacity; /**< The size of the allocation */
+   bool error;      /**< An append has failed, so the string is incomplete */
+};
+
+/**
+ * Create a string builder
+ * @param capacity The initial capacity, or 0 for the default
+ * @param sb The string builder
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_create(size_t capacity, struct string_builder** sb);
+
+/**
+ * Append a string
+ * @param sb The string builder
+ * @param s The string, NULL is ignored
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_append(struct string_builder* sb, char* s);
+
+/**
+ * Append the first bytes of a string
+ * @param sb The string builder
+ * @param s The string
+ * @param length The number of bytes
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_append_length(struct string_builder* sb, char* s, size_t length);
+
+/**
+ * Append a character
+ * @param sb The string builder
+ * @param c The character
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_append_char(struct string_builder* sb, char c);
+
+/**
+ * Append an integer
+ * @param sb The string builder
+ * @param i The integer
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_append_int(struct string_builder* sb, int i);
+
+/**
+ * Append an unsigned long
+ * @param sb The string builder
+ * @param l The unsigned long
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_append_ulong(struct string_builder* sb, unsigned long l);
+
+/**
+ * Append a double
+ * @param sb The string builder
+ * @param d The double
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_append_double(struct string_builder* sb, double d);
+
+/**
+ * Append a double with a precision
+ * @param sb The string builder
+ * @param d The double
+ * @param precision The number of decimals
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_append_double_precision(struct string_builder* sb, double d, int precision);
+
+/**
+ * Append a bool as 1 or 0
+ * @param sb The string builder
+ * @param b The bool
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_append_bool(struct string_builder* sb, bool b);
+
+/**
+ * Append a formatted string
+ * @param sb The string builder
+ * @param format The format
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_append_format(struct string_builder* sb, char* format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * Append an indentation followed by a tag, like pgmoneta_indent()
+ * @param sb The string builder
+ * @param tag The tag, or NULL
+ * @param indent The number of spaces
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_string_builder_indent(struct string_builder* sb, char* tag, int indent);
+
+/**
+ * Empty the string builder, keeping its allocation for reuse. The error flag is kept
+ * @param sb The string builder
+ */
+void
+pgmoneta_string_builder_reset(struct string_builder* sb);
+
+/**
+ * Take the string out of the string builder, and destroy the builder
+ * @param sb The string builder
+ * @return The string, which the caller must free, or NULL if an append has failed
+ */
+char*
+pgmoneta_string_builder_finish(struct string_builder* sb);
+
+/**
+ * Destroy a string builder
+ * @param sb The string builder
+ */
+void
+pgmoneta_string_builder_destroy(struct string_builder* sb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -38,7 +38,9 @@ extern "C" {
 #include <workers.h>
 
 #include <stdbool.h>
+#include <time.h>
 #include <openssl/asn1.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 
 #define SHORT_TIME_LENGTH  8 + 1
@@ -1175,6 +1177,14 @@ pgmoneta_convert_base32_to_hex(unsigned char* base32, int base32_length, unsigne
 size_t
 pgmoneta_get_file_size(char* file_path);
 
+/**
+ * Get the modification time of a file, including the nanoseconds
+ * @param st The status of the file
+ * @param mtime The modification time
+ */
+void
+pgmoneta_get_file_mtime(struct stat* st, struct timespec* mtime);
+
 /**
  * Is the file encrypted
  * @param file_path The file path
@@ -35,9 +35,12 @@ extern "C" {
 
 #include <pgmoneta.h>
 #include <json.h>
+#include <workers.h>
 
 #include <stdlib.h>
 
+#define VERIFICATION_STATE "backup.verified"
+
 /**
  * Create a verify
  * @param ssl The SSL connection
@@ -50,6 +53,41 @@ extern "C" {
 void
 pgmoneta_verify(SSL* ssl, int client_fd, int server, uint8_t compression, uint8_t encryption, struct json* payload);
 
+/**
+ * Verify a file of a backup against the checksum of the backup manifest.
+ * The file is read in place if only its compressed or encrypted form exists.
+ * The worker input holds the file as a JSON object, which is moved to the
+ * failed or the all deque
+ * @param wc The worker input
+ */
+void
+pgmoneta_verify_file(struct worker_common* wc);
+
+/**
+ * Find the compressed or encrypted form of a backup file
+ * @param path The path of the file as listed in the backup manifest
+ * @return The path of the stored file, or NULL if there is none
+ */
+char*
+pgmoneta_verify_stored_file(char* path);
+
+/**
+ * Run the scheduled verification. Each server verifies the files of its backups
+ * that were verified the longest time ago, enough of them to cover every file
+ * within the verification window
+ * @param argv The argv
+ */
+void
+pgmoneta_verification(char** argv);
+
+/**
+ * Get the verification max rate for a server
+ * @param server The server
+ * @return The max rate in bytes per second, 0 is no limit
+ */
+int
+pgmoneta_get_verification_max_rate(int server);
+
 #ifdef __cplusplus
 }
 #endif
@@ -122,8 +122,8 @@ void
 pgmoneta_destroy_walfile(struct walfile* wf);
 
 /**
- * Describe a WAL file
- * @param path The path to the WAL file
+ * Describe a WAL file, or the WAL files in a directory as one stream
+ * @param path The path to the WAL file, or a directory of WAL files
  * @param type The type of output description
  * @param output The output descriptor
  * @param quiet Is the WAL file printed
@@ -328,6 +328,57 @@ struct rel_file_node
    oid relNode;      /**< Relation OID. */
 };
 
+/**
+ * @struct wal_record_iterator
+ * @brief Iterates over the records of a WAL file one at a time.
+ *
+ * The WAL file is memory mapped, and each record is decoded into a single
+ * decoded_xlog_record that is reused by the next call, so a segment of any
+ * size is processed in constant memory. The iterator can move on to the
+ * following WAL files of a range, stitching records that cross a segment boundary.
+ *
+ * Fields:
+ * - fd: The file descriptor of the WAL file.
+ * - data: The memory mapped content of the WAL file.
+ * - size: The size of the WAL file.
+ * - long_phd: The long page header of the WAL file.
+ * - base: The LSN of the start of the WAL file.
+ * - next_record: The offset of the next record.
+ * - page_number: The page holding the next record.
+ * - partial: Indicates if the WAL file starts with the end of a record.
+ * - done: Indicates if all records have been returned.
+ * - buffer: The buffer for records crossing a page boundary.
+ * - buffer_size: The size of the buffer.
+ * - storage: The aligned storage for the decoded data of a record.
+ * - storage_size: The size of the storage.
+ * - carry: The start of a record cut at the end of the WAL file.
+ * - carry_size: The size of the carry buffer.
+ * - carry_length: The length of the cut record start, 0 if none.
+ * - carry_lsn: The location of the cut record.
+ * - record: The current decoded record.
+ */
+struct wal_record_iterator
+{
+   int fd;                                       /**< The file descriptor of the WAL file. */
+   char* data;                                   /**< The memory mapped content of the WAL file. */
+   size_t size;                                  /**< The size of the WAL file. */
+   struct xlog_long_page_header_data* long_phd;  /**< The long page header of the WAL file. */
+   xlog_rec_ptr base;                            /**< The LSN of the start of the WAL file. */
+   size_t next_record;                           /**< The offset of the next record. */
+   size_t page_number;                           /**< The page holding the next record. */
+   bool partial;                                 /**< Indicates if the WAL file starts with the end of a record. */
+   bool done;                                    /**< Indicates if all records have been returned. */
+   char* buffer;                                 /**< The buffer for records crossing a page boundary. */
+   size_t buffer_size;                           /**< The size of the buffer. */
+   char* storage;                                /**< The aligned storage for the decoded data of a record. */
+   size_t storage_size;                          /**< The size of the storage. */
+   char* carry;                                  /**< The start of a record cut at the end of the WAL file. */
+   size_t carry_size;                            /**< The size of the carry buffer. */
+   size_t carry_length;                          /**< The length of the cut record start, 0 if none. */
+   xlog_rec_ptr carry_lsn;                       /**< The location of the cut record. */
+   struct decoded_xlog_record record;            /**< The current decoded record. */
+};
+
 /* External variables */
 extern struct server* server_config;
 
@@ -344,6 +395,52 @@ extern struct server* server_config;
 int
 pgmoneta_wal_parse_wal_file(char* path, int server, struct walfile* wal_file);
 
+/**
+ * Creates an iterator over the records of a WAL file.
+ *
+ * @param path The file path of the WAL file.
+ * @param server The index of the server structure, if -1, config.servers[0] will be initialized based on magic value.
+ * @param iterator The resulting iterator.
+ * @return 0 on success, otherwise 1.
+ */
+int
+pgmoneta_wal_record_iterator_create(char* path, int server, struct wal_record_iterator** iterator);
+
+/**
+ * Decodes the next record of a WAL file.
+ *
+ * The record is owned by the iterator and is only valid until the next call.
+ * A record cut at the start or the end of the WAL file is returned as partial,
+ * unless it is completed by pgmoneta_wal_record_iterator_advance.
+ *
+ * @param iterator The iterator.
+ * @param record The next record, or NULL when there are no more records.
+ * @return 0 on success, otherwise 1.
+ */
+int
+pgmoneta_wal_record_iterator_next(struct wal_record_iterator* iterator, struct decoded_xlog_record** record);
+
+/**
+ * Moves an iterator to the next WAL file of a range.
+ *
+ * A record cut at the end of the current WAL file is completed from the start
+ * of the next one, when the next one directly follows it.
+ *
+ * @param iterator The iterator.
+ * @param path The file path of the next WAL file.
+ * @return 0 on success, otherwise 1.
+ */
+int
+pgmoneta_wal_record_iterator_advance(struct wal_record_iterator* iterator, char* path);
+
+/**
+ * Destroys an iterator over the records of a WAL file.
+ *
+ * @param iterator The iterator.
+ */
+void
+pgmoneta_wal_record_iterator_destroy(struct wal_record_iterator* iterator);
+
 /**
  * Retrieves block data from the decoded XLOG record.
  *
@@ -103,6 +103,7 @@ struct worker_input
    char from[MAX_PATH];         /**< The from directory */
    char to[MAX_PATH];           /**< The to directory */
    int level;                   /**< The compression level */
+   int server;                  /**< The server */
    struct json* data;           /**< JSON data */
    struct deque* failed;        /**< Failed files */
    struct deque* all;           /**< All files */
@@ -77,6 +77,8 @@ extern "C" {
 #define NODE_SERVER_BACKUP       "server_backup"        /* The backup directory of the server */
 #define NODE_SERVER_BASE         "server_base"          /* The base directory of the server */
 #define NODE_SERVER_ID           "server_id"            /* The server number */
+#define NODE_SHA512              "sha512"               /* The SHA-512 of the backup files, by relative path */
+#define NODE_STREAMED            "streamed"             /* Whether the backup was compressed and encrypted while received */
 #define NODE_TARGET_BASE         "target_base"          /* The target base directory */
 #define NODE_TARGET_FILE         "target_file"          /* The target file */
 #define NODE_TARGET_ROOT         "target_root"          /* The target root directory */
@@ -141,6 +141,13 @@ pgmoneta_create_bzip2(bool compress);
 struct workflow*
 pgmoneta_create_link(void);
 
+/**
+ * Create a workflow for moving a backup into the chunk store
+ * @return The workflow
+ */
+struct workflow*
+pgmoneta_create_dedup(void);
+
 struct workflow*
 pgmoneta_create_copy_wal(void);
 
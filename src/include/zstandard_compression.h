@@ -37,8 +37,22 @@ extern "C" {
 #include <json.h>
 #include <workers.h>
 
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
+/** @struct zstd_seek_table
+ * Defines the seek table of a file in the Zstandard seekable format, where
+ * independent frames are followed by a skippable frame listing their sizes
+ */
+struct zstd_seek_table
+{
+   uint32_t frames;        /**< The number of frames */
+   uint32_t capacity;      /**< The number of frames that fit in the arrays */
+   uint64_t* compressed;   /**< The compressed offset of each frame, followed by the end offset */
+   uint64_t* raw;          /**< The raw offset of each frame, followed by the raw size */
+};
+
 /**
  * Compress a data directory with Zstandard
  * @param directory The directory
@@ -130,6 +144,59 @@ pgmoneta_zstdc_string(char* s, unsigned char** buffer, size_t* buffer_size);
 int
 pgmoneta_zstdd_string(unsigned char* compressed_buffer, size_t compressed_size, char** output_string);
 
+/**
+ * Create an empty seek table
+ * @param table The resulting seek table
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_zstd_seek_table_create(struct zstd_seek_table** table);
+
+/**
+ * Add a frame to a seek table
+ * @param table The seek table
+ * @param compressed_size The compressed size of the frame
+ * @param raw_size The raw size of the frame
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_zstd_seek_table_add(struct zstd_seek_table* table, uint32_t compressed_size, uint32_t raw_size);
+
+/**
+ * Serialize a seek table into the skippable frame that ends a seekable file
+ * @param table The seek table
+ * @param buffer The resulting buffer
+ * @param size The size of the buffer
+ * @return 0 upon success, otherwise 1
+ */
+int
+pgmoneta_zstd_seek_table_serialize(struct zstd_seek_table* table, unsigned char** buffer, size_t* size);
+
+/**
+ * Read the seek table at the end of a file
+ * @param file The file
+ * @param table The resulting seek table
+ * @return 0 upon success, otherwise 1 if the file isn't in the seekable format
+ */
+int
+pgmoneta_zstd_seek_table_read(FILE* file, struct zstd_seek_table** table);
+
+/**
+ * Find the frame holding a raw offset
+ * @param table The seek table
+ * @param offset The raw offset
+ * @return The frame, or the number of frames if the offset is past the end
+ */
+uint32_t
+pgmoneta_zstd_seek_table_find(struct zstd_seek_table* table, uint64_t offset);
+
+/**
+ * Destroy a seek table
+ * @param table The seek table
+ */
+void
+pgmoneta_zstd_seek_table_destroy(struct zstd_seek_table* table);
+
 #ifdef __cplusplus
 }
 #endif
@@ -240,7 +240,10 @@ pgmoneta_encrypt_wal(char* d)
    {
       if (entry->d_type == DT_REG)
       {
-         if (!pgmoneta_ends_with(entry->d_name, compress_suffix))
+         if (!pgmoneta_ends_with(entry->d_name, compress_suffix) ||
+             pgmoneta_is_encrypted(entry->d_name) ||
+             pgmoneta_ends_with(entry->d_name, ".partial") ||
+             pgmoneta_ends_with(entry->d_name, ".history"))
          {
             continue;
          }
@@ -869,13 +872,48 @@ static const EVP_CIPHER* (*get_cipher(int mode))(void)
    return &EVP_aes_256_cbc;
 }
 
+int
+pgmoneta_derive_file_key_iv(int mode, unsigned char* key, unsigned char* iv)
+{
+   char* master_key = NULL;
+
+   if (pgmoneta_get_master_key(&master_key))
+   {
+      pgmoneta_log_error("pgmoneta_get_master_key: Invalid master key");
+      goto error;
+   }
+
+   memset(key, 0, EVP_MAX_KEY_LENGTH);
+   memset(iv, 0, EVP_MAX_IV_LENGTH);
+   if (derive_key_iv(master_key, key, iv, mode) != 0)
+   {
+      pgmoneta_log_error("derive_key_iv: Failed to derive key and iv");
+      goto error;
+   }
+
+   free(master_key);
+
+   return 0;
+
+error:
+
+   free(master_key);
+
+   return 1;
+}
+
+const EVP_CIPHER*
+pgmoneta_get_file_cipher(int mode)
+{
+   return get_cipher(mode)();
+}
+
 // enc: 1 for encrypt, 0 for decrypt
 static int
 encrypt_file(char* from, char* to, int enc)
 {
    unsigned char key[EVP_MAX_KEY_LENGTH];
    unsigned char iv[EVP_MAX_IV_LENGTH];
-   char* master_key = NULL;
    EVP_CIPHER_CTX* ctx = NULL;
    struct main_configuration* config;
    const EVP_CIPHER* (* cipher_fp)(void) = NULL;
@@ -887,6 +925,7 @@ encrypt_file(char* from, char* to, int enc)
    int inl = 0;
    int outl = 0;
    int f_len = 0;
+   struct file_hash* hash = NULL;
 
    config = (struct main_configuration*)shmem;
    cipher_fp = get_cipher(config->encryption);
@@ -896,16 +935,8 @@ encrypt_file(char* from, char* to, int enc)
    unsigned char inbuf[inbuf_size];
    unsigned char outbuf[outbuf_size];
 
-   if (pgmoneta_get_master_key(&master_key))
-   {
-      pgmoneta_log_error("pgmoneta_get_master_key: Invalid master key");
-      goto error;
-   }
-   memset(&key, 0, sizeof(key));
-   memset(&iv, 0, sizeof(iv));
-   if (derive_key_iv(master_key, key, iv, config->encryption) != 0)
+   if (pgmoneta_derive_file_key_iv(config->encryption, key, iv))
    {
-      pgmoneta_log_error("derive_key_iv: Failed to derive key and iv");
       goto error;
    }
 
@@ -929,6 +960,11 @@ encrypt_file(char* from, char* to, int enc)
       goto error;
    }
 
+   if (enc && pgmoneta_file_hash_create(&hash))
+   {
+      goto error;
+   }
+
    if (EVP_CipherInit_ex(ctx, cipher_fp(), NULL, key, iv, enc) == 0)
    {
       pgmoneta_log_error("EVP_CipherInit_ex: ailed to initialize context");
@@ -947,6 +983,7 @@ encrypt_file(char* from, char* to, int enc)
          pgmoneta_log_error("fwrite: failed to write cipher");
          goto error;
       }
+      pgmoneta_file_hash_update(hash, outbuf, outl);
    }
 
    if (ferror(in))
@@ -968,15 +1005,19 @@ encrypt_file(char* from, char* to, int enc)
          pgmoneta_log_error("fwrite: failed to write final block");
          goto error;
       }
+      pgmoneta_file_hash_update(hash, outbuf, f_len);
    }
 
    if (ctx)
    {
       EVP_CIPHER_CTX_free(ctx);
    }
-   free(master_key);
    fclose(in);
    fclose(out);
+
+   pgmoneta_file_hash_finish(hash, to);
+   pgmoneta_file_hash_destroy(hash);
+
    return 0;
 
 error:
@@ -985,8 +1026,6 @@ error:
       EVP_CIPHER_CTX_free(ctx);
    }
 
-   free(master_key);
-
    if (in != NULL)
    {
       fclose(in);
@@ -997,6 +1036,8 @@ error:
       fclose(out);
    }
 
+   pgmoneta_file_hash_destroy(hash);
+
    return 1;
 }
 
@@ -29,7 +29,11 @@
 /* pgmoneta */
 #include <pgmoneta.h>
 #include <achv.h>
+#include <aes.h>
+#include <art.h>
+#include <dedup.h>
 #include <gzip_compression.h>
+#include <info.h>
 #include <logging.h>
 #include <lz4_compression.h>
 #include <management.h>
@@ -44,20 +48,72 @@
 #include <archive.h>
 #include <archive_entry.h>
 #include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #define NAME "archive"
 
-static bool is_server_side_compression(void);
+#define TAR_BLOCK_SIZE 512
+#define TAR_BUFFER_SIZE (1024 * 1024)
+
+/** @struct tar_stream
+ * Defines the state of a tar file being received
+ */
+struct tar_stream
+{
+   char header[TAR_BLOCK_SIZE]; /**< The current header */
+   size_t header_length;        /**< The received length of the header */
+   uint64_t remaining;          /**< The remaining bytes of the current member */
+   uint64_t padding;            /**< The remaining padding of the current member */
+   bool open;                   /**< Is a member being written */
+   bool end;                    /**< Has the end of the tar file been reached */
+};
+
+/** @struct tar_source
+ * Defines the directory a tar file is written from
+ */
+struct tar_source
+{
+   bool stored;       /**< Are the files stored, and decoded while they are written */
+   char* destination; /**< The top directory in the tar file */
+   struct art* sizes; /**< The raw sizes of the stored files from the backup manifest */
+   char* buffer;      /**< The read buffer */
+};
+
+/** @struct tar_output
+ * Defines the tar file being written, encrypted on the way out if configured
+ */
+struct tar_output
+{
+   FILE* file;             /**< The tar file */
+   EVP_CIPHER_CTX* cipher; /**< The cipher context, or NULL */
+   unsigned char* buffer;  /**< The encryption buffer */
+};
 
-static void write_tar_file(struct archive* a, char* src, char* dst);
+static bool is_server_side_compression(void);
+static int stream_tar_data(struct streamer* streamer, struct tar_stream* tar, char* directory, char* prefix, char* data, size_t size);
+static int stream_tar_header(struct streamer* streamer, struct tar_stream* tar, char* directory, char* prefix);
+static uint64_t tar_size(char* field);
+
+static int write_tar_file(struct archive* a, struct tar_source* source, char* src, char* dst, char* relative);
+static int write_tar_tablespace(struct archive* a, struct tar_source* source, struct archive_entry* entry, char* link, char* target, char* relative);
+static int write_tar_data(struct archive* a, struct tar_source* source, struct archive_entry* entry, char* path, char* relative, struct stat* s);
+static int tar_filter(struct archive* a, int workers);
+static int tar_sizes(char* src, struct art* sizes);
+static int tar_output_open(struct tar_output* output, char* path);
+static la_ssize_t tar_output_write(struct archive* a, void* client_data, const void* buffer, size_t length);
+static int tar_output_close(struct tar_output* output, bool complete);
 
 void
 pgmoneta_archive(SSL* ssl, int client_fd, int server, uint8_t compression, uint8_t encryption, struct json* payload)
 {
    bool active = false;
+   bool stream = false;
+   bool materialized = false;
    char* identifier = NULL;
    char* position = NULL;
    char* directory = NULL;
@@ -131,86 +187,89 @@ pgmoneta_archive(SSL* ssl, int client_fd, int server, uint8_t compression, uint8
       goto error;
    }
 
-   real_directory = pgmoneta_append(real_directory, directory);
-   if (!pgmoneta_ends_with(real_directory, "/"))
-   {
-      real_directory = pgmoneta_append_char(real_directory, '/');
-   }
-   real_directory = pgmoneta_append(real_directory, config->common.servers[server].name);
-   real_directory = pgmoneta_append_char(real_directory, '-');
-   real_directory = pgmoneta_append(real_directory, backup->label);
-
-   if (pgmoneta_exists(real_directory))
-   {
-      pgmoneta_delete_directory(real_directory);
-   }
-
-   pgmoneta_mkdir(real_directory);
-
-   if (pgmoneta_art_insert(nodes, NODE_TARGET_BASE, (uintptr_t)real_directory, ValueString))
-   {
-      goto error;
-   }
+   // A full backup without recovery settings is read straight from the repository
+   stream = backup->type == TYPE_FULL && (position == NULL || strlen(position) == 0);
 
-   if (!pgmoneta_restore_backup(nodes))
+   if (stream)
    {
-      workflow = pgmoneta_workflow_create(WORKFLOW_TYPE_ARCHIVE, backup);
-
-      if (pgmoneta_workflow_execute(workflow, nodes, &en, &ec))
+      if (pgmoneta_dedup_materialize(server, backup->label))
       {
+         pgmoneta_log_error("Archive: Unable to read %s/%s from the chunk store", config->common.servers[server].name, backup->label);
          goto error;
       }
-
-      if (pgmoneta_management_create_response(payload, server, &response))
+      materialized = true;
+   }
+   else
+   {
+      real_directory = pgmoneta_append(real_directory, directory);
+      if (!pgmoneta_ends_with(real_directory, "/"))
       {
-         ec = MANAGEMENT_ERROR_ALLOCATION;
-         goto error;
+         real_directory = pgmoneta_append_char(real_directory, '/');
       }
+      real_directory = pgmoneta_append(real_directory, config->common.servers[server].name);
+      real_directory = pgmoneta_append_char(real_directory, '-');
+      real_directory = pgmoneta_append(real_directory, backup->label);
 
-      filename = pgmoneta_append(filename, (char*)pgmoneta_art_search(nodes, NODE_TARGET_FILE));
-      if (config->compression_type == COMPRESSION_CLIENT_GZIP || config->compression_type == COMPRESSION_SERVER_GZIP)
-      {
-         filename = pgmoneta_append(filename, ".gz");
-      }
-      else if (config->compression_type == COMPRESSION_CLIENT_ZSTD || config->compression_type == COMPRESSION_SERVER_ZSTD)
-      {
-         filename = pgmoneta_append(filename, ".zstd");
-      }
-      else if (config->compression_type == COMPRESSION_CLIENT_LZ4 || config->compression_type == COMPRESSION_SERVER_LZ4)
+      if (pgmoneta_exists(real_directory))
       {
-         filename = pgmoneta_append(filename, ".lz4");
+         pgmoneta_delete_directory(real_directory);
       }
-      else if (config->compression_type == COMPRESSION_CLIENT_BZIP2)
+
+      pgmoneta_mkdir(real_directory);
+
+      if (pgmoneta_art_insert(nodes, NODE_TARGET_BASE, (uintptr_t)real_directory, ValueString))
       {
-         filename = pgmoneta_append(filename, ".bz2");
+         goto error;
       }
 
-      if (config->encryption != ENCRYPTION_NONE)
+      if (pgmoneta_restore_backup(nodes))
       {
-         filename = pgmoneta_append(filename, ".aes");
+         pgmoneta_log_error("Archive: Unable to restore %s/%s", config->common.servers[server].name, backup->label);
+         goto error;
       }
+   }
+
+   workflow = pgmoneta_workflow_create(WORKFLOW_TYPE_ARCHIVE, backup);
+
+   if (pgmoneta_workflow_execute(workflow, nodes, &en, &ec))
+   {
+      goto error;
+   }
+
+   if (materialized)
+   {
+      pgmoneta_dedup_dematerialize(server, backup->label);
+      materialized = false;
+   }
+
+   if (pgmoneta_management_create_response(payload, server, &response))
+   {
+      ec = MANAGEMENT_ERROR_ALLOCATION;
+      goto error;
+   }
 
-      pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_SERVER, (uintptr_t)config->common.servers[server].name, ValueString);
-      pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_BACKUP, (uintptr_t)label, ValueString);
-      pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_FILENAME, (uintptr_t)filename, ValueString);
+   filename = pgmoneta_append(filename, (char*)pgmoneta_art_search(nodes, NODE_TARGET_FILE));
+
+   pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_SERVER, (uintptr_t)config->common.servers[server].name, ValueString);
+   pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_BACKUP, (uintptr_t)label, ValueString);
+   pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_FILENAME, (uintptr_t)filename, ValueString);
 
 #ifdef HAVE_FREEBSD
-      clock_gettime(CLOCK_MONOTONIC_FAST, &end_t);
+   clock_gettime(CLOCK_MONOTONIC_FAST, &end_t);
 #else
-      clock_gettime(CLOCK_MONOTONIC_RAW, &end_t);
+   clock_gettime(CLOCK_MONOTONIC_RAW, &end_t);
 #endif
 
-      if (pgmoneta_management_response_ok(NULL, client_fd, start_t, end_t, compression, encryption, payload))
-      {
-         ec = MANAGEMENT_ERROR_ARCHIVE_NETWORK;
-         pgmoneta_log_error("Archive: Error sending response for %s/%s", config->common.servers[server].name, identifier);
-         goto error;
-      }
+   if (pgmoneta_management_response_ok(NULL, client_fd, start_t, end_t, compression, encryption, payload))
+   {
+      ec = MANAGEMENT_ERROR_ARCHIVE_NETWORK;
+      pgmoneta_log_error("Archive: Error sending response for %s/%s", config->common.servers[server].name, identifier);
+      goto error;
+   }
 
-      elapsed = pgmoneta_get_timestamp_string(start_t, end_t, &total_seconds);
+   elapsed = pgmoneta_get_timestamp_string(start_t, end_t, &total_seconds);
 
-      pgmoneta_log_info("Archive: %s/%s (Elapsed: %s)", config->common.servers[server].name, label, elapsed);
-   }
+   pgmoneta_log_info("Archive: %s/%s (Elapsed: %s)", config->common.servers[server].name, label, elapsed);
 
    pgmoneta_art_destroy(nodes);
 
@@ -233,6 +292,11 @@ pgmoneta_archive(SSL* ssl, int client_fd, int server, uint8_t compression, uint8
 
 error:
 
+   if (materialized)
+   {
+      pgmoneta_dedup_dematerialize(server, backup->label);
+   }
+
    pgmoneta_management_response_error(ssl, client_fd,
                                       config->common.servers[server].name,
                                       ec != -1 ? ec : MANAGEMENT_ERROR_ARCHIVE_ERROR, en != NULL ? en : NAME,
@@ -341,30 +405,94 @@ error:
 }
 
 int
-pgmoneta_tar_directory(char* src, char* dst, char* destination)
+pgmoneta_tar_directory(char* src, char* dst, char* destination, bool stored, int workers)
 {
    struct archive* a = NULL;
-   int status;
+   struct tar_source source;
+   struct tar_output output;
+
+   memset(&source, 0, sizeof(struct tar_source));
+   memset(&output, 0, sizeof(struct tar_output));
+
+   source.stored = stored;
+   source.destination = destination;
+
+   if (pgmoneta_art_create(&source.sizes))
+   {
+      goto error;
+   }
+
+   if (stored && tar_sizes(src, source.sizes))
+   {
+      goto error;
+   }
+
+   source.buffer = (char*)malloc(TAR_BUFFER_SIZE);
+   if (source.buffer == NULL)
+   {
+      goto error;
+   }
+
+   if (tar_output_open(&output, dst))
+   {
+      goto error;
+   }
 
    a = archive_write_new();
    archive_write_set_format_ustar(a);  // Set tar format
-   status = archive_write_open_filename(a, dst);
+   archive_write_set_bytes_in_last_block(a, 1);
+
+   if (tar_filter(a, workers))
+   {
+      goto error;
+   }
+
+   if (archive_write_open(a, &output, NULL, &tar_output_write, NULL) != ARCHIVE_OK)
+   {
+      pgmoneta_log_error("Could not create tar file %s: %s", dst, archive_error_string(a));
+      goto error;
+   }
+
+   if (write_tar_file(a, &source, src, destination, ""))
+   {
+      goto error;
+   }
 
-   if (status != ARCHIVE_OK)
+   if (archive_write_close(a) != ARCHIVE_OK)
    {
-      pgmoneta_log_error("Could not create tar file %s", dst);
+      pgmoneta_log_error("Could not complete tar file %s: %s", dst, archive_error_string(a));
       goto error;
    }
-   write_tar_file(a, src, destination);
 
-   archive_write_close(a);
    archive_write_free(a);
+   a = NULL;
+
+   if (tar_output_close(&output, true))
+   {
+      pgmoneta_log_error("Could not complete tar file %s", dst);
+      goto error;
+   }
+
+   pgmoneta_art_destroy(source.sizes);
+   free(source.buffer);
 
    return 0;
 
 error:
-   archive_write_close(a);
-   archive_write_free(a);
+   if (a != NULL)
+   {
+      archive_write_free(a);
+   }
+
+   tar_output_close(&output, false);
+
+   if (pgmoneta_exists(dst))
+   {
+      pgmoneta_delete_file(dst, NULL);
+   }
+
+   pgmoneta_art_destroy(source.sizes);
+   free(source.buffer);
 
    return 1;
 }
@@ -576,7 +704,7 @@ error:
 }
 
 int
-pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buffer, char* basedir, struct tablespace* tablespaces, struct token_bucket* bucket, struct token_bucket* network_bucket)
+pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buffer, char* basedir, struct tablespace* tablespaces, struct token_bucket* bucket, struct token_bucket* network_bucket, struct streamer* streamer)
 {
    struct query_response* response = NULL;
    struct message* msg = (struct message*)malloc(sizeof (struct message));
@@ -588,14 +716,20 @@ pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buff
    char link_path[MAX_PATH];
    char tmp_manifest_file_path[MAX_PATH];
    char manifest_file_path[MAX_PATH];
+   char prefix[MAX_PATH];
    memset(file_path, 0, sizeof(file_path));
    memset(directory, 0, sizeof(directory));
    memset(link_path, 0, sizeof(link_path));
    memset(manifest_file_path, 0, sizeof(manifest_file_path));
    memset(tmp_manifest_file_path, 0, sizeof(tmp_manifest_file_path));
+   memset(prefix, 0, sizeof(prefix));
    memset(null_buffer, 0, 2 * 512);
    char type;
    FILE* file = NULL;
+   bool manifest = false;
+   struct tar_stream tar;
+
+   memset(&tar, 0, sizeof(struct tar_stream));
 
    if (msg == NULL)
    {
@@ -654,12 +788,18 @@ pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buff
                   pgmoneta_extract_tar_file(file_path, directory);
                   remove(file_path);
                }
+               if (streamer != NULL && (tar.open || tar.remaining > 0 || tar.header_length > 0))
+               {
+                  pgmoneta_log_error("Incomplete tar stream for %s", directory);
+                  goto error;
+               }
                // new tablespace or main directory tar file
                char* archive_name = pgmoneta_read_string(msg->data + 1);
                char* archive_path = pgmoneta_read_string(msg->data + 1 + strlen(archive_name) + 1);
 
                memset(file_path, 0, sizeof(file_path));
                memset(directory, 0, sizeof(directory));
+               memset(prefix, 0, sizeof(prefix));
                // The tablespace order in the second result set is presumably the same as the order in which the server sends tablespaces
                tblspc = tablespaces;
                if (tup == NULL)
@@ -707,8 +847,14 @@ pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buff
                      snprintf(file_path, sizeof(file_path), "%s/tblspc_%s/%s.tar", basedir, tblspc->name, tblspc->name);
                      snprintf(directory, sizeof(directory), "%s/tblspc_%s/", basedir, tblspc->name);
                   }
+                  snprintf(prefix, sizeof(prefix), "pg_tblspc/%d/", tblspc->oid);
                }
                pgmoneta_mkdir(directory);
+               if (streamer != NULL)
+               {
+                  memset(&tar, 0, sizeof(struct tar_stream));
+                  break;
+               }
                file = fopen(file_path, "wb");
                if (file == NULL)
                {
@@ -746,6 +892,21 @@ pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buff
                   snprintf(tmp_manifest_file_path, sizeof(tmp_manifest_file_path), "%s/data/%s", basedir, "backup_manifest.tmp");
                   snprintf(manifest_file_path, sizeof(manifest_file_path), "%s/data/%s", basedir, "backup_manifest");
                }
+               if (streamer != NULL)
+               {
+                  if (tar.open || tar.remaining > 0 || tar.header_length > 0)
+                  {
+                     pgmoneta_log_error("Incomplete tar stream for %s", directory);
+                     goto error;
+                  }
+                  // the manifest is kept as is, but still accounted for
+                  if (pgmoneta_streamer_open(streamer, manifest_file_path, "backup_manifest"))
+                  {
+                     goto error;
+                  }
+                  manifest = true;
+                  break;
+               }
                file = fopen(tmp_manifest_file_path, "wb");
                break;
             }
@@ -772,6 +933,22 @@ pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buff
                   }
                }
 
+               if (streamer != NULL)
+               {
+                  if (manifest)
+                  {
+                     if (pgmoneta_streamer_write(streamer, msg->data + 1, msg->length - 1))
+                     {
+                        goto error;
+                     }
+                  }
+                  else if (stream_tar_data(streamer, &tar, directory, prefix, (char*)msg->data + 1, msg->length - 1))
+                  {
+                     goto error;
+                  }
+                  break;
+               }
+
                if (fwrite(msg->data + 1, msg->length - 1, 1, file) != 1)
                {
                   pgmoneta_log_error("could not write to file %s", file_path);
@@ -807,6 +984,20 @@ pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buff
       file = NULL;
    }
 
+   if (manifest)
+   {
+      if (pgmoneta_streamer_close(streamer))
+      {
+         goto error;
+      }
+      manifest = false;
+   }
+   else if (streamer != NULL)
+   {
+      pgmoneta_log_error("No manifest received for %s", basedir);
+      goto error;
+   }
+
    // update symlink
    tblspc = tablespaces;
    while (tblspc != NULL)
@@ -840,7 +1031,16 @@ pgmoneta_receive_archive_stream(SSL* ssl, int socket, struct stream_buffer* buff
    {
       snprintf(dir, sizeof(dir), "%s/data", basedir);
    }
-   if (pgmoneta_manifest_checksum_verify(dir))
+   if (streamer != NULL)
+   {
+      // the checksums were calculated while receiving, so the files are not read again
+      if (pgmoneta_streamer_verify(streamer, manifest_file_path))
+      {
+         pgmoneta_log_error("Manifest verification failed");
+         goto error;
+      }
+   }
+   else if (pgmoneta_manifest_checksum_verify(dir))
    {
       pgmoneta_log_error("Manifest verification failed");
       goto error;
@@ -866,95 +1066,752 @@ error:
    return 1;
 }
 
-static void
-write_tar_file(struct archive* a, char* src, char* dst)
+static int
+write_tar_file(struct archive* a, struct tar_source* source, char* src, char* dst, char* relative)
 {
    char real_path[MAX_PATH];
    char save_path[MAX_PATH];
+   char relative_path[MAX_PATH];
+   char target[MAX_PATH];
+   char* name = NULL;
+   char* n = NULL;
    ssize_t size;
-   struct archive_entry* entry;
+   struct archive_entry* entry = NULL;
    struct stat s;
    struct dirent* dent;
+   DIR* dir = NULL;
 
-   DIR* dir = opendir(src);
+   dir = opendir(src);
    if (!dir)
    {
       pgmoneta_log_error("Could not open directory: %s", src);
-      return;
+      goto error;
    }
    while ((dent = readdir(dir)) != NULL)
    {
-      char* entry_name = dent->d_name;
-
-      if (pgmoneta_compare_string(entry_name, ".") || pgmoneta_compare_string(entry_name, ".."))
+      if (pgmoneta_compare_string(dent->d_name, ".") || pgmoneta_compare_string(dent->d_name, ".."))
       {
          continue;
       }
 
-      snprintf(real_path, sizeof(real_path), "%s/%s", src, entry_name);
-      snprintf(save_path, sizeof(save_path), "%s/%s", dst, entry_name);
+      snprintf(real_path, sizeof(real_path), "%s/%s", src, dent->d_name);
+
+      if (lstat(real_path, &s))
+      {
+         pgmoneta_log_error("Could not stat %s: %s", real_path, strerror(errno));
+         goto error;
+      }
+
+      name = pgmoneta_append(name, dent->d_name);
+
+      // A stored file is named after its raw content
+      if (source->stored && S_ISREG(s.st_mode))
+      {
+         if (pgmoneta_is_encrypted(name))
+         {
+            n = pgmoneta_remove_suffix(name, ".aes");
+            free(name);
+            name = n;
+         }
+
+         if (pgmoneta_is_compressed(name))
+         {
+            if (pgmoneta_strip_extension(name, &n))
+            {
+               goto error;
+            }
+            free(name);
+            name = n;
+         }
+      }
+
+      snprintf(save_path, sizeof(save_path), "%s/%s", dst, name);
+      if (strlen(relative) > 0)
+      {
+         snprintf(relative_path, sizeof(relative_path), "%s/%s", relative, name);
+      }
+      else
+      {
+         snprintf(relative_path, sizeof(relative_path), "%s", name);
+      }
 
       entry = archive_entry_new();
       archive_entry_copy_pathname(entry, save_path);
+      archive_entry_set_perm(entry, s.st_mode);
+      archive_entry_set_mtime(entry, s.st_mtime, 0);
 
-      lstat(real_path, &s);
       if (S_ISDIR(s.st_mode))
       {
          archive_entry_set_filetype(entry, AE_IFDIR);
-         archive_entry_set_perm(entry, s.st_mode);
-         archive_write_header(a, entry);
-         write_tar_file(a, real_path, save_path);
+         if (archive_write_header(a, entry) != ARCHIVE_OK)
+         {
+            pgmoneta_log_error("Could not write header: %s", archive_error_string(a));
+            goto error;
+         }
+
+         if (write_tar_file(a, source, real_path, save_path, relative_path))
+         {
+            goto error;
+         }
       }
       else if (S_ISLNK(s.st_mode))
       {
-         char target[MAX_PATH];
          memset(target, 0, sizeof(target));
-         size = readlink(real_path, target, sizeof(target));
+         size = readlink(real_path, target, sizeof(target) - 1);
          if (size == -1)
          {
-            return;
+            pgmoneta_log_error("Could not read link %s: %s", real_path, strerror(errno));
+            goto error;
          }
 
-         archive_entry_set_filetype(entry, AE_IFLNK);
-         archive_entry_set_perm(entry, s.st_mode);
-         archive_entry_set_symlink(entry, target);
-         archive_write_header(a, entry);
-      }
-      else if (S_ISREG(s.st_mode))
-      {
-         FILE* file = NULL;
-
-         archive_entry_set_filetype(entry, AE_IFREG);
-         archive_entry_set_perm(entry, s.st_mode);
-         archive_entry_set_size(entry, s.st_size);
-         int status = archive_write_header(a, entry);
-         if (status != ARCHIVE_OK)
+         if (source->stored && pgmoneta_compare_string(relative, "pg_tblspc"))
          {
-            pgmoneta_log_error("Could not write header: %s", archive_error_string(a));
-            return;
+            if (write_tar_tablespace(a, source, entry, real_path, target, relative_path))
+            {
+               goto error;
+            }
          }
-
-         file = fopen(real_path, "rb");
-
-         if (file != NULL)
+         else
          {
-            char buf[DEFAULT_BUFFER_SIZE];
-            size_t bytes_read = 0;
-
-            memset(buf, 0, sizeof(buf));
-            while ((bytes_read = fread(buf, 1, sizeof(buf), file)) > 0)
+            archive_entry_set_filetype(entry, AE_IFLNK);
+            archive_entry_set_symlink(entry, target);
+            if (archive_write_header(a, entry) != ARCHIVE_OK)
             {
-               archive_write_data(a, buf, bytes_read);
-               memset(buf, 0, sizeof(buf));
+               pgmoneta_log_error("Could not write header: %s", archive_error_string(a));
+               goto error;
             }
-            fclose(file);
+         }
+      }
+      else if (S_ISREG(s.st_mode))
+      {
+         archive_entry_set_filetype(entry, AE_IFREG);
+         if (write_tar_data(a, source, entry, real_path, relative_path, &s))
+         {
+            goto error;
          }
       }
 
       archive_entry_free(entry);
+      entry = NULL;
+
+      free(name);
+      name = NULL;
    }
 
    closedir(dir);
+
+   return 0;
+
+error:
+
+   archive_entry_free(entry);
+   free(name);
+
+   if (dir != NULL)
+   {
+      closedir(dir);
+   }
+
+   return 1;
+}
+
+static int
+write_tar_tablespace(struct archive* a, struct tar_source* source, struct archive_entry* entry, char* link, char* target, char* relative)
+{
+   char top[MAX_PATH];
+   char symlink[MAX_PATH + 8];
+   char* tblspc = NULL;
+   struct archive_entry* directory = NULL;
+   struct stat s;
+
+   // The tablespace is placed next to the data directory, like a restore does
+   if (pgmoneta_ends_with(target, "/"))
+   {
+      target[strlen(target) - 1] = '\0';
+   }
+
+   tblspc = strrchr(target, '/');
+   tblspc = tblspc != NULL ? tblspc + 1 : target;
+
+   snprintf(top, sizeof(top), "%s-%s", source->destination, tblspc);
+   snprintf(symlink, sizeof(symlink), "../../%s/", top);
+
+   archive_entry_set_filetype(entry, AE_IFLNK);
+   archive_entry_set_symlink(entry, symlink);
+   if (archive_write_header(a, entry) != ARCHIVE_OK)
+   {
+      pgmoneta_log_error("Could not write header: %s", archive_error_string(a));
+      goto error;
+   }
+
+   directory = archive_entry_new();
+   archive_entry_copy_pathname(directory, top);
+   archive_entry_set_filetype(directory, AE_IFDIR);
+   archive_entry_set_perm(directory, 0700);
+   if (!stat(link, &s))
+   {
+      archive_entry_set_perm(directory, s.st_mode);
+      archive_entry_set_mtime(directory, s.st_mtime, 0);
+   }
+   if (archive_write_header(a, directory) != ARCHIVE_OK)
+   {
+      pgmoneta_log_error("Could not write header: %s", archive_error_string(a));
+      goto error;
+   }
+
+   if (write_tar_file(a, source, link, top, relative))
+   {
+      goto error;
+   }
+
+   archive_entry_free(directory);
+
+   return 0;
+
+error:
+
+   archive_entry_free(directory);
+
+   return 1;
+}
+
+static int
+write_tar_data(struct archive* a, struct tar_source* source, struct archive_entry* entry, char* path, char* relative, struct stat* s)
+{
+   uint64_t size = 0;
+   uint64_t written = 0;
+   size_t length = 0;
+   FILE* file = NULL;
+   struct stream_reader* reader = NULL;
+
+   if (source->stored)
+   {
+      if (pgmoneta_stream_reader_create(path, &reader))
+      {
+         goto error;
+      }
+
+      if (pgmoneta_art_contains_key(source->sizes, relative))
+      {
+         size = (uint64_t)pgmoneta_art_search(source->sizes, relative);
+      }
+      else if (reader->compression == COMPRESSION_NONE && reader->encryption == ENCRYPTION_NONE)
+      {
+         size = (uint64_t)s->st_size;
+      }
+      else
+      {
+         // The header needs the size up front, so a file missing from the manifest is decoded twice
+         if (pgmoneta_stream_reader_seek(reader, UINT64_MAX))
+         {
+            goto error;
+         }
+         size = reader->position;
+
+         if (pgmoneta_stream_reader_seek(reader, 0))
+         {
+            goto error;
+         }
+      }
+   }
+   else
+   {
+      file = fopen(path, "rb");
+      if (file == NULL)
+      {
+         pgmoneta_log_error("Could not open %s: %s", path, strerror(errno));
+         goto error;
+      }
+      size = (uint64_t)s->st_size;
+   }
+
+   archive_entry_set_size(entry, size);
+   if (archive_write_header(a, entry) != ARCHIVE_OK)
+   {
+      pgmoneta_log_error("Could not write header: %s", archive_error_string(a));
+      goto error;
+   }
+
+   do
+   {
+      if (reader != NULL)
+      {
+         if (pgmoneta_stream_reader_read(reader, source->buffer, TAR_BUFFER_SIZE, &length))
+         {
+            goto error;
+         }
+      }
+      else
+      {
+         length = fread(source->buffer, 1, TAR_BUFFER_SIZE, file);
+         if (length == 0 && ferror(file))
+         {
+            pgmoneta_log_error("Could not read %s", path);
+            goto error;
+         }
+      }
+
+      if (length > 0 && archive_write_data(a, source->buffer, length) < 0)
+      {
+         pgmoneta_log_error("Could not write %s: %s", path, archive_error_string(a));
+         goto error;
+      }
+
+      written += length;
+   }
+   while (length == TAR_BUFFER_SIZE);
+
+   if (written != size)
+   {
+      pgmoneta_log_error("Could not write %s: %" PRIu64 " bytes instead of %" PRIu64, path, written, size);
+      goto error;
+   }
+
+   pgmoneta_stream_reader_destroy(reader);
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   return 0;
+
+error:
+
+   pgmoneta_stream_reader_destroy(reader);
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   return 1;
+}
+
+static int
+tar_filter(struct archive* a, int workers)
+{
+   char option[16];
+   int status = ARCHIVE_OK;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (config->compression_type == COMPRESSION_CLIENT_GZIP || config->compression_type == COMPRESSION_SERVER_GZIP)
+   {
+      status = archive_write_add_filter_gzip(a);
+   }
+   else if (config->compression_type == COMPRESSION_CLIENT_ZSTD || config->compression_type == COMPRESSION_SERVER_ZSTD)
+   {
+      status = archive_write_add_filter_zstd(a);
+   }
+   else if (config->compression_type == COMPRESSION_CLIENT_LZ4 || config->compression_type == COMPRESSION_SERVER_LZ4)
+   {
+      status = archive_write_add_filter_lz4(a);
+   }
+   else if (config->compression_type == COMPRESSION_CLIENT_BZIP2)
+   {
+      status = archive_write_add_filter_bzip2(a);
+   }
+   else
+   {
+      return 0;
+   }
+
+   // A warning means that libarchive runs the external program instead of the library
+   if (status < ARCHIVE_WARN)
+   {
+      pgmoneta_log_error("Could not enable compression: %s", archive_error_string(a));
+      goto error;
+   }
+
+   snprintf(option, sizeof(option), "%d", config->compression_level);
+   if (archive_write_set_filter_option(a, NULL, "compression-level", option) != ARCHIVE_OK)
+   {
+      pgmoneta_log_warn("Compression level %d is not supported, using the default", config->compression_level);
+   }
+
+   if (workers > 0 && (config->compression_type == COMPRESSION_CLIENT_ZSTD || config->compression_type == COMPRESSION_SERVER_ZSTD))
+   {
+      snprintf(option, sizeof(option), "%d", workers);
+      if (archive_write_set_filter_option(a, NULL, "threads", option) != ARCHIVE_OK)
+      {
+         pgmoneta_log_debug("Compression is done without threads: %s", archive_error_string(a));
+      }
+   }
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+static int
+tar_sizes(char* src, struct art* sizes)
+{
+   char* path = NULL;
+   char* file_path = NULL;
+   struct json* manifest = NULL;
+   struct json* files = NULL;
+   struct json_iterator* iter = NULL;
+
+   path = pgmoneta_append(path, src);
+   if (!pgmoneta_ends_with(path, "/"))
+   {
+      path = pgmoneta_append(path, "/");
+   }
+   path = pgmoneta_append(path, "backup_manifest");
+
+   if (!pgmoneta_exists(path))
+   {
+      pgmoneta_log_debug("%s doesn't exists", path);
+      free(path);
+      return 0;
+   }
+
+   if (pgmoneta_json_read_file(path, &manifest))
+   {
+      pgmoneta_log_error("Unable to read manifest %s", path);
+      goto error;
+   }
+
+   files = (struct json*)pgmoneta_json_get(manifest, MANIFEST_FILES);
+   if (files != NULL)
+   {
+      if (pgmoneta_json_iterator_create(files, &iter))
+      {
+         goto error;
+      }
+
+      while (pgmoneta_json_iterator_next(iter))
+      {
+         struct json* file = (struct json*)pgmoneta_value_data(iter->value);
+
+         file_path = (char*)pgmoneta_json_get(file, "Path");
+         if (file_path != NULL &&
+             pgmoneta_art_insert(sizes, file_path, (uintptr_t)pgmoneta_json_get(file, "Size"), ValueUInt64))
+         {
+            goto error;
+         }
+      }
+   }
+
+   pgmoneta_json_iterator_destroy(iter);
+   pgmoneta_json_destroy(manifest);
+   free(path);
+
+   return 0;
+
+error:
+
+   pgmoneta_json_iterator_destroy(iter);
+   pgmoneta_json_destroy(manifest);
+   free(path);
+
+   return 1;
+}
+
+static int
+tar_output_open(struct tar_output* output, char* path)
+{
+   unsigned char key[EVP_MAX_KEY_LENGTH];
+   unsigned char iv[EVP_MAX_IV_LENGTH];
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   output->file = fopen(path, "wb");
+   if (output->file == NULL)
+   {
+      pgmoneta_log_error("Could not create tar file %s: %s", path, strerror(errno));
+      goto error;
+   }
+
+   // Encrypted the same way as pgmoneta_encrypt_file(), so the tar file can be decrypted with it
+   if (config->encryption != ENCRYPTION_NONE)
+   {
+      if (pgmoneta_derive_file_key_iv(config->encryption, key, iv))
+      {
+         goto error;
+      }
+
+      output->cipher = EVP_CIPHER_CTX_new();
+      output->buffer = (unsigned char*)malloc(TAR_BUFFER_SIZE + EVP_MAX_BLOCK_LENGTH);
+      if (output->cipher == NULL || output->buffer == NULL)
+      {
+         goto error;
+      }
+
+      if (EVP_CipherInit_ex(output->cipher, pgmoneta_get_file_cipher(config->encryption), NULL, key, iv, 1) == 0)
+      {
+         pgmoneta_log_error("EVP_CipherInit_ex: Failed to initialize context");
+         goto error;
+      }
+   }
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+static la_ssize_t
+tar_output_write(struct archive* a, void* client_data, const void* buffer, size_t length)
+{
+   struct tar_output* output = (struct tar_output*)client_data;
+   const unsigned char* b = (const unsigned char*)buffer;
+   size_t offset = 0;
+   size_t n = 0;
+   int outl = 0;
+
+   if (output->cipher == NULL)
+   {
+      if (fwrite(buffer, 1, length, output->file) != length)
+      {
+         archive_set_error(a, errno, "Could not write the tar file");
+         return -1;
+      }
+
+      return (la_ssize_t)length;
+   }
+
+   while (offset < length)
+   {
+      n = MIN(length - offset, (size_t)TAR_BUFFER_SIZE);
+
+      if (EVP_CipherUpdate(output->cipher, output->buffer, &outl, b + offset, (int)n) == 0 ||
+          fwrite(output->buffer, 1, outl, output->file) != (size_t)outl)
+      {
+         archive_set_error(a, errno, "Could not write the encrypted tar file");
+         return -1;
+      }
+
+      offset += n;
+   }
+
+   return (la_ssize_t)length;
+}
+
+static int
+tar_output_close(struct tar_output* output, bool complete)
+{
+   int outl = 0;
+   int ret = 0;
+
+   if (complete && output->cipher != NULL)
+   {
+      if (EVP_CipherFinal_ex(output->cipher, output->buffer, &outl) == 0 ||
+          fwrite(output->buffer, 1, outl, output->file) != (size_t)outl)
+      {
+         ret = 1;
+      }
+   }
+
+   if (output->file != NULL && fclose(output->file) != 0)
+   {
+      ret = 1;
+   }
+   output->file = NULL;
+
+   if (output->cipher != NULL)
+   {
+      EVP_CIPHER_CTX_free(output->cipher);
+      output->cipher = NULL;
+   }
+
+   free(output->buffer);
+   output->buffer = NULL;
+
+   return ret;
+}
+
+static int
+stream_tar_data(struct streamer* streamer, struct tar_stream* tar, char* directory, char* prefix, char* data, size_t size)
+{
+   size_t length;
+
+   while (size > 0 && !tar->end)
+   {
+      if (tar->remaining > 0)
+      {
+         length = (size_t)MIN((uint64_t)size, tar->remaining);
+
+         if (tar->open && pgmoneta_streamer_write(streamer, data, length))
+         {
+            goto error;
+         }
+
+         tar->remaining -= length;
+
+         if (tar->remaining == 0 && tar->open)
+         {
+            tar->open = false;
+            if (pgmoneta_streamer_close(streamer))
+            {
+               goto error;
+            }
+         }
+      }
+      else if (tar->padding > 0)
+      {
+         length = (size_t)MIN((uint64_t)size, tar->padding);
+         tar->padding -= length;
+      }
+      else
+      {
+         length = MIN(size, TAR_BLOCK_SIZE - tar->header_length);
+         memcpy(tar->header + tar->header_length, data, length);
+         tar->header_length += length;
+
+         if (tar->header_length == TAR_BLOCK_SIZE)
+         {
+            tar->header_length = 0;
+            if (stream_tar_header(streamer, tar, directory, prefix))
+            {
+               goto error;
+            }
+         }
+      }
+
+      data += length;
+      size -= length;
+   }
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+static int
+stream_tar_header(struct streamer* streamer, struct tar_stream* tar, char* directory, char* prefix)
+{
+   char name[257];
+   char link_target[101];
+   char* path = NULL;
+   char* manifest_path = NULL;
+   char* h = tar->header;
+   bool empty = true;
+   uint64_t size;
+
+   for (int i = 0; empty && i < TAR_BLOCK_SIZE; i++)
+   {
+      if (h[i] != '\0')
+      {
+         empty = false;
+      }
+   }
+
+   if (empty)
+   {
+      tar->end = true;
+      return 0;
+   }
+
+   memset(name, 0, sizeof(name));
+   if (!strncmp(h + 257, "ustar", 5) && h[345] != '\0')
+   {
+      snprintf(name, sizeof(name), "%.155s/%.100s", h + 345, h);
+   }
+   else
+   {
+      snprintf(name, sizeof(name), "%.100s", h);
+   }
+
+   size = tar_size(h + 124);
+
+   tar->remaining = size;
+   tar->padding = (TAR_BLOCK_SIZE - (size % TAR_BLOCK_SIZE)) % TAR_BLOCK_SIZE;
+
+   path = pgmoneta_append(path, directory);
+   path = pgmoneta_append(path, name);
+
+   switch (h[156])
+   {
+      case '0':
+      case '\0':
+         manifest_path = pgmoneta_append(manifest_path, prefix);
+         manifest_path = pgmoneta_append(manifest_path, name);
+
+         if (pgmoneta_streamer_open(streamer, path, manifest_path))
+         {
+            goto error;
+         }
+
+         if (size == 0)
+         {
+            if (pgmoneta_streamer_close(streamer))
+            {
+               goto error;
+            }
+         }
+         else
+         {
+            tar->open = true;
+         }
+         break;
+      case '5':
+         pgmoneta_mkdir(path);
+         break;
+      case '2':
+         memset(link_target, 0, sizeof(link_target));
+         memcpy(link_target, h + 157, 100);
+         if (pgmoneta_ends_with(path, "/"))
+         {
+            path[strlen(path) - 1] = '\0';
+         }
+         unlink(path);
+         if (pgmoneta_symlink_file(path, link_target))
+         {
+            pgmoneta_log_error("Could not create symbolic link %s", path);
+            goto error;
+         }
+         break;
+      default:
+         pgmoneta_log_debug("Skipping tar member %s of type %c", name, h[156]);
+         break;
+   }
+
+   free(path);
+   free(manifest_path);
+
+   return 0;
+
+error:
+
+   free(path);
+   free(manifest_path);
+
+   return 1;
+}
+
+static uint64_t
+tar_size(char* field)
+{
+   uint64_t size = 0;
+
+   // base-256 encoding is used for members of 8GB and larger
+   if ((unsigned char)field[0] & 0x80)
+   {
+      for (int i = 1; i < 12; i++)
+      {
+         size = (size << 8) | (unsigned char)field[i];
+      }
+      return size;
+   }
+
+   for (int i = 0; i < 12 && field[i] != '\0'; i++)
+   {
+      if (field[i] >= '0' && field[i] <= '7')
+      {
+         size = (size << 3) | (uint64_t)(field[i] - '0');
+      }
+   }
+
+   return size;
 }
 
 static bool
@@ -29,6 +29,7 @@
 #include <art.h>
 #include <json.h>
 #include <logging.h>
+#include <string_builder.h>
 #include <utils.h>
 
 #define IS_LEAF(x) (((uintptr_t)(x) & 1))
@@ -116,7 +117,7 @@ struct art_node256
 
 struct to_string_param
 {
-   char* str;
+   struct string_builder* sb;
    int indent;
    uint64_t cnt;
    char* tag;
@@ -1312,6 +1313,7 @@ node4_remove_child(struct art_node4* node, struct art_node** node_ref, unsigned
       if (IS_LEAF(child))
       {
          // replace directly
+         free(node);
          *node_ref = child;
          return;
       }
@@ -1630,8 +1632,8 @@ art_to_json_string_cb(void* param, char* key, struct value* value)
    tag = pgmoneta_append(tag, ": ");
    str = pgmoneta_value_to_string(value, FORMAT_JSON, tag, p->indent);
    free(tag);
-   p->str = pgmoneta_append(p->str, str);
-   p->str = pgmoneta_append(p->str, has_next ? ",\n" : "\n");
+   pgmoneta_string_builder_append(p->sb, str);
+   pgmoneta_string_builder_append(p->sb, has_next ? ",\n" : "\n");
 
    free(str);
    return 0;
@@ -1654,8 +1656,8 @@ art_to_compact_json_string_cb(void* param, char* key, struct value* value)
    tag = pgmoneta_append(tag, ":");
    str = pgmoneta_value_to_string(value, FORMAT_JSON_COMPACT, tag, p->indent);
    free(tag);
-   p->str = pgmoneta_append(p->str, str);
-   p->str = pgmoneta_append(p->str, has_next ? "," : "");
+   pgmoneta_string_builder_append(p->sb, str);
+   pgmoneta_string_builder_append(p->sb, has_next ? "," : "");
 
    free(str);
    return 0;
@@ -1689,7 +1691,7 @@ art_to_text_string_cb(void* param, char* key, struct value* value)
          }
          else
          {
-            p->str = pgmoneta_indent(p->str, tag, 0);
+            pgmoneta_string_builder_indent(p->sb, tag, 0);
             str = pgmoneta_value_to_string(value, FORMAT_TEXT, NULL, p->indent + INDENT_PER_LEVEL);
          }
       }
@@ -1703,8 +1705,8 @@ art_to_text_string_cb(void* param, char* key, struct value* value)
       str = pgmoneta_value_to_string(value, FORMAT_TEXT, tag, p->indent);
    }
    free(tag);
-   p->str = pgmoneta_append(p->str, str);
-   p->str = pgmoneta_append(p->str, has_next ? "\n" : "");
+   pgmoneta_string_builder_append(p->sb, str);
+   pgmoneta_string_builder_append(p->sb, has_next ? "\n" : "");
 
    free(str);
    return 0;
@@ -1713,75 +1715,83 @@ art_to_text_string_cb(void* param, char* key, struct value* value)
 static char*
 to_json_string(struct art* t, char* tag, int indent)
 {
-   char* ret = NULL;
-   ret = pgmoneta_indent(ret, tag, indent);
+   struct string_builder* sb = NULL;
+   if (pgmoneta_string_builder_create(0, &sb))
+   {
+      return NULL;
+   }
+   pgmoneta_string_builder_indent(sb, tag, indent);
    if (t == NULL || t->size == 0)
    {
-      ret = pgmoneta_append(ret, "{}");
-      return ret;
+      pgmoneta_string_builder_append(sb, "{}");
+      return pgmoneta_string_builder_finish(sb);
    }
-   ret = pgmoneta_append(ret, "{\n");
+   pgmoneta_string_builder_append(sb, "{\n");
    struct to_string_param param = {
       .indent = indent + INDENT_PER_LEVEL,
-      .str = ret,
+      .sb = sb,
       .t = t,
       .cnt = 0,
    };
    art_iterate(t, art_to_json_string_cb, &param);
-   ret = param.str;
-   ret = pgmoneta_indent(ret, NULL, indent);
-   ret = pgmoneta_append(ret, "}");
-   return ret;
+   pgmoneta_string_builder_indent(sb, NULL, indent);
+   pgmoneta_string_builder_append(sb, "}");
+   return pgmoneta_string_builder_finish(sb);
 }
 
 static char*
 to_compact_json_string(struct art* t, char* tag, int indent)
 {
-   char* ret = NULL;
-   ret = pgmoneta_indent(ret, tag, indent);
+   struct string_builder* sb = NULL;
+   if (pgmoneta_string_builder_create(0, &sb))
+   {
+      return NULL;
+   }
+   pgmoneta_string_builder_indent(sb, tag, indent);
    if (t == NULL || t->size == 0)
    {
-      ret = pgmoneta_append(ret, "{}");
-      return ret;
+      pgmoneta_string_builder_append(sb, "{}");
+      return pgmoneta_string_builder_finish(sb);
    }
-   ret = pgmoneta_append(ret, "{");
+   pgmoneta_string_builder_append(sb, "{");
    struct to_string_param param = {
       .indent = indent,
-      .str = ret,
+      .sb = sb,
       .t = t,
       .cnt = 0,
    };
    art_iterate(t, art_to_compact_json_string_cb, &param);
-   ret = param.str;
-   ret = pgmoneta_append(ret, "}");
-   return ret;
+   pgmoneta_string_builder_append(sb, "}");
+   return pgmoneta_string_builder_finish(sb);
 }
 
 static char*
 to_text_string(struct art* t, char* tag, int indent)
 {
-   char* ret = NULL;
+   struct string_builder* sb = NULL;
    int next_indent = indent;
+   if (pgmoneta_string_builder_create(0, &sb))
+   {
+      return NULL;
+   }
    if (tag != NULL && !pgmoneta_compare_string(tag, BULLET_POINT))
    {
-      ret = pgmoneta_indent(ret, tag, indent);
+      pgmoneta_string_builder_indent(sb, tag, indent);
       next_indent += INDENT_PER_LEVEL;
    }
    if (t == NULL || t->size == 0)
    {
-      ret = pgmoneta_append(ret, "");
-      return ret;
+      return pgmoneta_string_builder_finish(sb);
    }
    struct to_string_param param = {
       .indent = next_indent,
-      .str = ret,
+      .sb = sb,
       .t = t,
       .cnt = 0,
       .tag = tag
    };
    art_iterate(t, art_to_text_string_cb, &param);
-   ret = param.str;
-   return ret;
+   return pgmoneta_string_builder_finish(sb);
 }
 
 static int
@@ -36,6 +36,7 @@
 #include <management.h>
 #include <network.h>
 #include <security.h>
+#include <space.h>
 #include <utils.h>
 #include <workflow.h>
 
@@ -280,6 +281,8 @@ pgmoneta_backup(int client_fd, int server, uint8_t compression, uint8_t encrypti
 
    pgmoneta_log_info("Backup: %s/%s (Elapsed: %s)", config->common.servers[server].name, date, elapsed);
 
+   pgmoneta_space_add(server, SPACE_BACKUP, (int64_t)pgmoneta_directory_size(root));
+
    config->common.servers[server].active_backup = false;
    atomic_store(&config->common.servers[server].repository, false);
 
@@ -31,6 +31,7 @@
 #include <bzip2_compression.h>
 #include <logging.h>
 #include <management.h>
+#include <security.h>
 #include <utils.h>
 
 /* system */
@@ -658,54 +659,103 @@ bzip2_compress(char* from, int level, char* to)
 {
    FILE* from_ptr = NULL;
    FILE* to_ptr = NULL;
-
-   char buf[BUFFER_LENGTH] = {0};
-   size_t buf_len = BUFFER_LENGTH;
+   char buf[BUFFER_LENGTH];
+   char out_buf[BUFFER_LENGTH];
+   bz_stream stream;
+   bool initialized = false;
+   struct file_hash* hash = NULL;
    size_t length;
-   int bzip2_err = 1;
+   size_t have;
+   int action;
+   int ret;
 
-   from_ptr = fopen(from, "r");
+   from_ptr = fopen(from, "rb");
    if (!from_ptr)
    {
       goto error;
    }
 
-   to_ptr = fopen(to, "wb+");
+   to_ptr = fopen(to, "wb");
    if (!to_ptr)
    {
       goto error;
    }
 
-   bzip2_err = BZ_OK;
+   if (pgmoneta_file_hash_create(&hash))
+   {
+      goto error;
+   }
 
-   BZFILE* zip_file = BZ2_bzWriteOpen(&bzip2_err, to_ptr, level, 0, 0);
-   if (bzip2_err != BZ_OK)
+   memset(&stream, 0, sizeof(stream));
+   if (BZ2_bzCompressInit(&stream, level, 0, 0) != BZ_OK)
    {
-      goto error_zip;
+      goto error;
    }
+   initialized = true;
 
-   while ((length = fread(buf, sizeof(char), buf_len, from_ptr)) > 0)
+   do
    {
-      BZ2_bzWrite(&bzip2_err, zip_file, buf, strlen(buf));
-      if (bzip2_err != BZ_OK)
+      length = fread(buf, sizeof(char), sizeof(buf), from_ptr);
+
+      if (ferror(from_ptr))
       {
-         goto error_zip;
+         goto error;
       }
 
-      memset(buf, 0, buf_len);
+      action = feof(from_ptr) ? BZ_FINISH : BZ_RUN;
+      stream.next_in = buf;
+      stream.avail_in = (unsigned int)length;
+
+      do
+      {
+         stream.next_out = out_buf;
+         stream.avail_out = sizeof(out_buf);
+
+         ret = BZ2_bzCompress(&stream, action);
+         if (ret != BZ_RUN_OK && ret != BZ_FINISH_OK && ret != BZ_STREAM_END)
+         {
+            goto error;
+         }
+
+         have = sizeof(out_buf) - stream.avail_out;
+         if (have > 0)
+         {
+            if (fwrite(out_buf, 1, have, to_ptr) != have)
+            {
+               goto error;
+            }
+            pgmoneta_file_hash_update(hash, out_buf, have);
+         }
+      }
+      while (action == BZ_FINISH ? ret != BZ_STREAM_END : stream.avail_in > 0);
    }
+   while (action != BZ_FINISH);
 
-   BZ2_bzWriteClose(&bzip2_err, zip_file, 0, NULL, NULL);
+   BZ2_bzCompressEnd(&stream);
+   initialized = false;
 
    fclose(from_ptr);
-   fclose(to_ptr);
+   from_ptr = NULL;
 
-   return 0;
+   if (fclose(to_ptr) != 0)
+   {
+      to_ptr = NULL;
+      goto error;
+   }
+   to_ptr = NULL;
+
+   pgmoneta_file_hash_finish(hash, to);
 
-error_zip:
-   BZ2_bzWriteClose(&bzip2_err, zip_file, 0, NULL, NULL);
+   pgmoneta_file_hash_destroy(hash);
+
+   return 0;
 
 error:
+   if (initialized)
+   {
+      BZ2_bzCompressEnd(&stream);
+   }
+
    if (from_ptr)
    {
       fclose(from_ptr);
@@ -716,6 +766,8 @@ error:
       fclose(to_ptr);
    }
 
+   pgmoneta_file_hash_destroy(hash);
+
    return 1;
 }
 
@@ -30,6 +30,7 @@
 #include <pgmoneta.h>
 #include <aes.h>
 #include <configuration.h>
+#include <dedup.h>
 #include <logging.h>
 #include <management.h>
 #include <network.h>
@@ -75,6 +76,7 @@ static int as_seconds(char* str, int* age, int default_age);
 static int as_bytes(char* str, int* bytes, int default_bytes);
 static int as_retention(char* str, int* days, int* weeks, int* months, int* years);
 static int as_create_slot(char* str, int* create_slot);
+static int as_wal_fsync(char* str);
 static char* get_retention_string(int rt_days, int rt_weeks, int rt_months, int rt_year);
 
 static bool transfer_configuration(struct main_configuration* config, struct main_configuration* reload);
@@ -112,6 +114,12 @@ pgmoneta_init_main_configuration(void* shm)
 
    config->storage_engine = STORAGE_ENGINE_LOCAL;
 
+   config->s3_part_size = 16 * 1024 * 1024;
+   config->s3_concurrency = 4;
+
+   config->azure_block_size = 16 * 1024 * 1024;
+   config->azure_concurrency = 4;
+
    config->workers = 0;
 
    config->retention_days = 7;
@@ -120,6 +128,10 @@ pgmoneta_init_main_configuration(void* shm)
    config->retention_years = -1;
    config->retention_interval = 300;
 
+   config->verification_interval = 0;
+   config->verification_window = DEFAULT_VERIFICATION_WINDOW;
+   config->verification_max_rate = 0;
+
    config->tls = false;
 
    config->blocking_timeout = DEFAULT_BLOCKING_TIMEOUT;
@@ -145,6 +157,13 @@ pgmoneta_init_main_configuration(void* shm)
    config->network_max_rate = 0;
 
    config->manifest = HASH_ALGORITHM_SHA256;
+   config->backup_streaming = false;
+   config->backup_parallel = false;
+   config->deduplication = false;
+
+   config->wal_fsync = WAL_FSYNC_SEGMENT;
+   config->wal_fsync_interval = DEFAULT_WAL_FSYNC_INTERVAL;
+   config->wal_status_interval = DEFAULT_WAL_STATUS_INTERVAL;
 
 #ifdef DEBUG
    config->link = true;
@@ -228,6 +247,7 @@ pgmoneta_read_main_configuration(void* shm, char* filename)
                   memcpy(&srv.name, &section, strlen(section));
 
                   atomic_init(&srv.repository, false);
+                  atomic_init(&srv.verification, false);
                   srv.active_backup = false;
                   srv.active_restore = false;
                   srv.active_archive = false;
@@ -244,6 +264,7 @@ pgmoneta_read_main_configuration(void* shm, char* filename)
                   srv.workers = -1;
                   srv.backup_max_rate = -1;
                   srv.network_max_rate = -1;
+                  srv.verification_max_rate = -1;
                   srv.manifest = HASH_ALGORITHM_DEFAULT;
 
                   idx_server++;
@@ -1017,6 +1038,20 @@ pgmoneta_read_main_configuration(void* shm, char* filename)
                      unknown = true;
                   }
                }
+               else if (!strcmp(key, "compression_frame_size"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_bytes(value, &config->compression_frame_size, 0))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
                else if (!strcmp(key, "storage_engine"))
                {
                   if (!strcmp(section, "pgmoneta"))
@@ -1176,6 +1211,50 @@ pgmoneta_read_main_configuration(void* shm, char* filename)
                      unknown = true;
                   }
                }
+               else if (!strcmp(key, "s3_endpoint"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     max = strlen(value);
+                     if (max > MISC_LENGTH - 1)
+                     {
+                        max = MISC_LENGTH - 1;
+                     }
+                     memcpy(config->s3_endpoint, value, max);
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "s3_part_size"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_bytes(value, &config->s3_part_size, 16 * 1024 * 1024))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "s3_concurrency"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_int(value, &config->s3_concurrency))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
                else if (!strcmp(key, "azure_storage_account"))
                {
                   if (!strcmp(section, "pgmoneta"))
@@ -1240,6 +1319,50 @@ pgmoneta_read_main_configuration(void* shm, char* filename)
                      unknown = true;
                   }
                }
+               else if (!strcmp(key, "azure_endpoint"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     max = strlen(value);
+                     if (max > MISC_LENGTH - 1)
+                     {
+                        max = MISC_LENGTH - 1;
+                     }
+                     memcpy(config->azure_endpoint, value, max);
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "azure_block_size"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_bytes(value, &config->azure_block_size, 16 * 1024 * 1024))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "azure_concurrency"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_int(value, &config->azure_concurrency))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
                else if (!strcmp(key, "workspace"))
                {
                   if (!strcmp(section, "pgmoneta"))
@@ -1401,6 +1524,142 @@ pgmoneta_read_main_configuration(void* shm, char* filename)
                      unknown = true;
                   }
                }
+               else if (!strcmp(key, "backup_streaming"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_bool(value, &config->backup_streaming))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "backup_parallel"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_bool(value, &config->backup_parallel))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "deduplication"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_bool(value, &config->deduplication))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "verification_interval"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_seconds(value, &config->verification_interval, 0))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "verification_window"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_seconds(value, &config->verification_window, DEFAULT_VERIFICATION_WINDOW))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "verification_max_rate"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_bytes(value, &config->verification_max_rate, 0))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else if (strlen(section) > 0)
+                  {
+                     max = strlen(section);
+                     if (max > MISC_LENGTH - 1)
+                     {
+                        max = MISC_LENGTH - 1;
+                     }
+                     memcpy(&srv.name, section, max);
+                     if (as_bytes(value, &srv.verification_max_rate, 0))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "wal_fsync"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     config->wal_fsync = as_wal_fsync(value);
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "wal_fsync_interval"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_int(value, &config->wal_fsync_interval))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
+               else if (!strcmp(key, "wal_status_interval"))
+               {
+                  if (!strcmp(section, "pgmoneta"))
+                  {
+                     if (as_seconds(value, &config->wal_status_interval, DEFAULT_WAL_STATUS_INTERVAL))
+                     {
+                        unknown = true;
+                     }
+                  }
+                  else
+                  {
+                     unknown = true;
+                  }
+               }
 #ifdef DEBUG
                else if (!strcmp(key, "link"))
                {
@@ -1580,6 +1839,12 @@ pgmoneta_validate_main_configuration(void* shm)
       return 1;
    }
 
+   if (config->verification_interval > 0 && config->verification_window < config->verification_interval)
+   {
+      pgmoneta_log_fatal("verification window should be at least the verification interval");
+      return 1;
+   }
+
    if (config->backlog < 16)
    {
       config->backlog = 16;
@@ -1641,6 +1906,26 @@ pgmoneta_validate_main_configuration(void* shm)
       config->workers = 0;
    }
 
+   if (config->s3_part_size < 5 * 1024 * 1024)
+   {
+      config->s3_part_size = 5 * 1024 * 1024;
+   }
+
+   if (config->s3_concurrency < 1)
+   {
+      config->s3_concurrency = 1;
+   }
+
+   if (config->azure_block_size < 1024 * 1024)
+   {
+      config->azure_block_size = 1024 * 1024;
+   }
+
+   if (config->azure_concurrency < 1)
+   {
+      config->azure_concurrency = 1;
+   }
+
    if (strlen(config->metrics_cert_file) > 0)
    {
       if (!pgmoneta_exists(config->metrics_cert_file))
@@ -1688,6 +1973,12 @@ pgmoneta_validate_main_configuration(void* shm)
          return 1;
       }
 
+      if (config->deduplication && !strcmp(config->common.servers[i].name, DEDUP_DIRECTORY))
+      {
+         pgmoneta_log_fatal("%s is a reserved word for a host when deduplication is enabled", DEDUP_DIRECTORY);
+         return 1;
+      }
+
       if (strlen(config->common.servers[i].host) == 0)
       {
          pgmoneta_log_fatal("No host defined for %s", config->common.servers[i].name);
@@ -1744,6 +2035,11 @@ pgmoneta_validate_main_configuration(void* shm)
       {
          config->common.servers[i].network_max_rate = -1;
       }
+
+      if (config->common.servers[i].verification_max_rate < -1)
+      {
+         config->common.servers[i].verification_max_rate = -1;
+      }
    }
 
    return 0;
@@ -2470,6 +2766,7 @@ add_configuration_response(struct json* res)
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_MANAGEMENT, (uintptr_t)config->management, ValueInt64);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_COMPRESSION, (uintptr_t)config->compression_type, ValueInt32);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_COMPRESSION_LEVEL, (uintptr_t)config->compression_level, ValueInt64);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_COMPRESSION_FRAME_SIZE, (uintptr_t)config->compression_frame_size, ValueInt64);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_WORKERS, (uintptr_t)config->workers, ValueInt64);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_STORAGE_ENGINE, (uintptr_t)config->storage_engine, ValueInt32);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_ENCRYPTION, (uintptr_t)config->encryption, ValueInt32);
@@ -2483,10 +2780,16 @@ add_configuration_response(struct json* res)
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_S3_SECRET_ACCESS_KEY, (uintptr_t)config->s3_secret_access_key, ValueString);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_S3_BUCKET, (uintptr_t)config->s3_bucket, ValueString);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_S3_BASE_DIR, (uintptr_t)config->s3_base_dir, ValueString);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_S3_ENDPOINT, (uintptr_t)config->s3_endpoint, ValueString);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_S3_PART_SIZE, (uintptr_t)config->s3_part_size, ValueInt64);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_S3_CONCURRENCY, (uintptr_t)config->s3_concurrency, ValueInt64);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_AZURE_BASE_DIR, (uintptr_t)config->azure_base_dir, ValueString);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_AZURE_STORAGE_ACCOUNT, (uintptr_t)config->azure_storage_account, ValueString);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_AZURE_CONTAINER, (uintptr_t)config->azure_container, ValueString);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_AZURE_SHARED_KEY, (uintptr_t)config->azure_shared_key, ValueString);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_AZURE_ENDPOINT, (uintptr_t)config->azure_endpoint, ValueString);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_AZURE_BLOCK_SIZE, (uintptr_t)config->azure_block_size, ValueInt64);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_AZURE_CONCURRENCY, (uintptr_t)config->azure_concurrency, ValueInt64);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_WORKSPACE, (uintptr_t)config->workspace, ValueString);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_RETENTION, (uintptr_t)ret, ValueString);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_LOG_TYPE, (uintptr_t)config->common.log_type, ValueInt32);
@@ -2508,6 +2811,15 @@ add_configuration_response(struct json* res)
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_BACKUP_MAX_RATE, (uintptr_t)config->backup_max_rate, ValueInt64);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_NETWORK_MAX_RATE, (uintptr_t)config->network_max_rate, ValueInt64);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_MANIFEST, (uintptr_t)config->manifest, ValueInt64);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_BACKUP_STREAMING, (uintptr_t)config->backup_streaming, ValueBool);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_BACKUP_PARALLEL, (uintptr_t)config->backup_parallel, ValueBool);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_DEDUPLICATION, (uintptr_t)config->deduplication, ValueBool);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_VERIFICATION_INTERVAL, (uintptr_t)config->verification_interval, ValueInt64);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_VERIFICATION_WINDOW, (uintptr_t)config->verification_window, ValueInt64);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_VERIFICATION_MAX_RATE, (uintptr_t)config->verification_max_rate, ValueInt64);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_WAL_FSYNC, (uintptr_t)config->wal_fsync, ValueInt32);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_WAL_FSYNC_INTERVAL, (uintptr_t)config->wal_fsync_interval, ValueInt32);
+   pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_WAL_STATUS_INTERVAL, (uintptr_t)config->wal_status_interval, ValueInt32);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_KEEP_ALIVE, (uintptr_t)config->common.keep_alive, ValueBool);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_NODELAY, (uintptr_t)config->common.nodelay, ValueBool);
    pgmoneta_json_put(res, CONFIGURATION_ARGUMENT_NON_BLOCKING, (uintptr_t)config->common.non_blocking, ValueBool);
@@ -2555,6 +2867,7 @@ add_servers_configuration_response(struct json* res)
       pgmoneta_json_put(server_conf, CONFIGURATION_ARGUMENT_WORKERS, (uintptr_t)config->common.servers[i].workers, ValueInt64);
       pgmoneta_json_put(server_conf, CONFIGURATION_ARGUMENT_BACKUP_MAX_RATE, (uintptr_t)config->common.servers[i].backup_max_rate, ValueInt64);
       pgmoneta_json_put(server_conf, CONFIGURATION_ARGUMENT_NETWORK_MAX_RATE, (uintptr_t)config->common.servers[i].network_max_rate, ValueInt64);
+      pgmoneta_json_put(server_conf, CONFIGURATION_ARGUMENT_VERIFICATION_MAX_RATE, (uintptr_t)config->common.servers[i].verification_max_rate, ValueInt64);
       pgmoneta_json_put(server_conf, CONFIGURATION_ARGUMENT_MANIFEST, (uintptr_t)config->common.servers[i].manifest, ValueInt64);
       pgmoneta_json_put(server_conf, CONFIGURATION_ARGUMENT_TLS_CERT_FILE, (uintptr_t)config->common.servers[i].tls_cert_file, ValueString);
       pgmoneta_json_put(server_conf, CONFIGURATION_ARGUMENT_TLS_CA_FILE, (uintptr_t)config->common.servers[i].tls_ca_file, ValueString);
@@ -3255,6 +3568,59 @@ pgmoneta_conf_set(SSL* ssl, int client_fd, uint8_t compression, uint8_t encrypti
          }
          pgmoneta_json_put(response, key, (uintptr_t)config->common.nodelay, ValueBool);
       }
+      else if (!strcmp(key, "backup_streaming"))
+      {
+         if (as_bool(config_value, &config->backup_streaming))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->backup_streaming, ValueBool);
+      }
+      else if (!strcmp(key, "backup_parallel"))
+      {
+         if (as_bool(config_value, &config->backup_parallel))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->backup_parallel, ValueBool);
+      }
+      else if (!strcmp(key, "deduplication"))
+      {
+         if (as_bool(config_value, &config->deduplication))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->deduplication, ValueBool);
+      }
+      else if (!strcmp(key, "verification_window"))
+      {
+         if (as_seconds(config_value, &config->verification_window, DEFAULT_VERIFICATION_WINDOW))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->verification_window, ValueInt32);
+      }
+      else if (!strcmp(key, "wal_fsync"))
+      {
+         config->wal_fsync = as_wal_fsync(config_value);
+         pgmoneta_json_put(response, key, (uintptr_t)config->wal_fsync, ValueInt32);
+      }
+      else if (!strcmp(key, "wal_fsync_interval"))
+      {
+         if (as_int(config_value, &config->wal_fsync_interval))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->wal_fsync_interval, ValueInt32);
+      }
+      else if (!strcmp(key, "wal_status_interval"))
+      {
+         if (as_seconds(config_value, &config->wal_status_interval, DEFAULT_WAL_STATUS_INTERVAL))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->wal_status_interval, ValueInt32);
+      }
       else if (!strcmp(key, "non_blocking"))
       {
          if (as_bool(config_value, &config->common.non_blocking))
@@ -3289,6 +3655,14 @@ pgmoneta_conf_set(SSL* ssl, int client_fd, uint8_t compression, uint8_t encrypti
          }
          pgmoneta_json_put(response, key, (uintptr_t)config->compression_level, ValueInt32);
       }
+      else if (!strcmp(key, "compression_frame_size"))
+      {
+         if (as_bytes(config_value, &config->compression_frame_size, 0))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->compression_frame_size, ValueInt64);
+      }
       else if (!strcmp(key, "storage_engine"))
       {
          config->storage_engine = as_storage_engine(config_value);
@@ -3388,6 +3762,32 @@ pgmoneta_conf_set(SSL* ssl, int client_fd, uint8_t compression, uint8_t encrypti
          memcpy(config->s3_base_dir, config_value, max);
          pgmoneta_json_put(response, key, (uintptr_t)config->s3_base_dir, ValueString);
       }
+      else if (!strcmp(key, "s3_endpoint"))
+      {
+         max = strlen(config_value);
+         if (max > MISC_LENGTH - 1)
+         {
+            max = MISC_LENGTH - 1;
+         }
+         memcpy(config->s3_endpoint, config_value, max);
+         pgmoneta_json_put(response, key, (uintptr_t)config->s3_endpoint, ValueString);
+      }
+      else if (!strcmp(key, "s3_part_size"))
+      {
+         if (as_bytes(config_value, &config->s3_part_size, 16 * 1024 * 1024))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->s3_part_size, ValueInt64);
+      }
+      else if (!strcmp(key, "s3_concurrency"))
+      {
+         if (as_int(config_value, &config->s3_concurrency))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->s3_concurrency, ValueInt64);
+      }
       else if (!strcmp(key, "azure_storage_account"))
       {
          max = strlen(config_value);
@@ -3428,6 +3828,32 @@ pgmoneta_conf_set(SSL* ssl, int client_fd, uint8_t compression, uint8_t encrypti
          memcpy(config->azure_base_dir, config_value, max);
          pgmoneta_json_put(response, key, (uintptr_t)config->azure_base_dir, ValueString);
       }
+      else if (!strcmp(key, "azure_endpoint"))
+      {
+         max = strlen(config_value);
+         if (max > MISC_LENGTH - 1)
+         {
+            max = MISC_LENGTH - 1;
+         }
+         memcpy(config->azure_endpoint, config_value, max);
+         pgmoneta_json_put(response, key, (uintptr_t)config->azure_endpoint, ValueString);
+      }
+      else if (!strcmp(key, "azure_block_size"))
+      {
+         if (as_bytes(config_value, &config->azure_block_size, 16 * 1024 * 1024))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->azure_block_size, ValueInt64);
+      }
+      else if (!strcmp(key, "azure_concurrency"))
+      {
+         if (as_int(config_value, &config->azure_concurrency))
+         {
+            unknown = true;
+         }
+         pgmoneta_json_put(response, key, (uintptr_t)config->azure_concurrency, ValueInt64);
+      }
       else if (!strcmp(key, "workspace"))
       {
          max = strlen(config_value);
@@ -3521,6 +3947,26 @@ pgmoneta_conf_set(SSL* ssl, int client_fd, uint8_t compression, uint8_t encrypti
             pgmoneta_json_put(response, key, (uintptr_t)config->network_max_rate, ValueInt32);
          }
       }
+      else if (!strcmp(key, "verification_max_rate"))
+      {
+         if (strlen(section) > 0)
+         {
+            if (as_bytes(config_value, &config->common.servers[server_index].verification_max_rate, 0))
+            {
+               unknown = true;
+            }
+            pgmoneta_json_put(server_j, key, (uintptr_t)config->common.servers[server_index].verification_max_rate, ValueInt32);
+            pgmoneta_json_put(response, config->common.servers[server_index].name, (uintptr_t)server_j, ValueJSON);
+         }
+         else
+         {
+            if (as_bytes(config_value, &config->verification_max_rate, 0))
+            {
+               unknown = true;
+            }
+            pgmoneta_json_put(response, key, (uintptr_t)config->verification_max_rate, ValueInt32);
+         }
+      }
       else if (!strcmp(key, "manifest"))
       {
          if (strlen(section) > 0)
@@ -4026,6 +4472,32 @@ as_hugepage(char* str)
    return HUGEPAGE_OFF;
 }
 
+static int
+as_wal_fsync(char* str)
+{
+   if (!strcasecmp(str, "segment"))
+   {
+      return WAL_FSYNC_SEGMENT;
+   }
+
+   if (!strcasecmp(str, "interval"))
+   {
+      return WAL_FSYNC_INTERVAL;
+   }
+
+   if (!strcasecmp(str, "message"))
+   {
+      return WAL_FSYNC_MESSAGE;
+   }
+
+   if (!strcasecmp(str, "sync"))
+   {
+      return WAL_FSYNC_SYNC;
+   }
+
+   return WAL_FSYNC_SEGMENT;
+}
+
 static int
 as_compression(char* str)
 {
@@ -4763,6 +5235,7 @@ transfer_configuration(struct main_configuration* config, struct main_configurat
    config->create_slot = reload->create_slot;
    config->compression_type = reload->compression_type;
    config->compression_level = reload->compression_level;
+   config->compression_frame_size = reload->compression_frame_size;
    if (restart_string("workspace", config->workspace, reload->workspace))
    {
       changed = true;
@@ -4775,6 +5248,12 @@ transfer_configuration(struct main_configuration* config, struct main_configurat
    {
       changed = true;
    }
+   if (restart_int("verification_interval", config->verification_interval, reload->verification_interval))
+   {
+      changed = true;
+   }
+   config->verification_window = reload->verification_window;
+   config->verification_max_rate = reload->verification_max_rate;
    if (restart_int("log_type", config->common.log_type, reload->common.log_type))
    {
       changed = true;
@@ -4882,6 +5361,12 @@ transfer_configuration(struct main_configuration* config, struct main_configurat
    config->backup_max_rate = reload->backup_max_rate;
    config->network_max_rate = reload->network_max_rate;
    config->manifest = reload->manifest;
+   config->backup_streaming = reload->backup_streaming;
+   config->backup_parallel = reload->backup_parallel;
+   config->deduplication = reload->deduplication;
+   config->wal_fsync = reload->wal_fsync;
+   config->wal_fsync_interval = reload->wal_fsync_interval;
+   config->wal_status_interval = reload->wal_status_interval;
 
    /* prometheus */
    atomic_init(&config->common.prometheus.logging_info, 0);
@@ -4951,6 +5436,7 @@ copy_server(struct server* dst, struct server* src)
    dst->workers = src->workers;
    dst->backup_max_rate = src->backup_max_rate;
    dst->network_max_rate = src->network_max_rate;
+   dst->verification_max_rate = src->verification_max_rate;
    dst->manifest = src->manifest;
 
    if (restart_string("tls_cert_file", dst->tls_cert_file, src->tls_cert_file))
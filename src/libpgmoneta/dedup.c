@@ -0,0 +1,1804 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* pgmoneta */
+#include <pgmoneta.h>
+#include <art.h>
+#include <dedup.h>
+#include <deque.h>
+#include <logging.h>
+#include <space.h>
+#include <utils.h>
+#include <value.h>
+#include <workers.h>
+
+/* system */
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <openssl/evp.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define DEDUP_REFERENCES "references"
+#define DEDUP_LOCK       "lock"
+#define DEDUP_CHUNKS     "chunks.lock"
+
+/*
+ * Normalized content-defined chunking: no cut before CHUNK_MIN_SIZE, a strict
+ * mask up to CHUNK_AVG_SIZE and a loose one after it, so most chunks end up
+ * close to the average, and a hard cut at CHUNK_MAX_SIZE.
+ * Changing any of these, or the gear table, only costs deduplication against
+ * the chunks already in the store
+ */
+#define CHUNK_MIN_SIZE (256 * 1024)
+#define CHUNK_AVG_SIZE (1024 * 1024)
+#define CHUNK_MAX_SIZE (4 * 1024 * 1024)
+#define CHUNK_MASK_S   (~UINT64_C(0) << (64 - 22))
+#define CHUNK_MASK_L   (~UINT64_C(0) << (64 - 18))
+
+#define HASH_LENGTH 64
+
+/** @struct dedup_store
+ * Defines an open chunk store
+ */
+struct dedup_store
+{
+   char path[MAX_PATH];        /**< The chunk store directory */
+   int lock;                   /**< The lock file descriptor of the references or the backup */
+   int chunks;                 /**< The lock file descriptor of the chunk files */
+   struct art* references;     /**< The reference count of each chunk */
+   struct art* added;          /**< The references added by the backup */
+   pthread_mutex_t mutex;      /**< The mutex of the references and the manifest */
+   FILE* manifest;             /**< The chunk manifest being written */
+   uint64_t size;              /**< The size of the added chunks */
+   uint64_t total;             /**< The size of the chunked files */
+};
+
+/** @struct dedup_input
+ * Defines the input of a chunk or materialize task
+ */
+struct dedup_input
+{
+   struct worker_common common;     /**< The common base */
+   struct dedup_store* store;       /**< The chunk store */
+   char root[MAX_PATH];             /**< The backup directory */
+   char relative[MAX_PATH];         /**< The path of the file relative to the backup directory */
+   char manifest[MAX_PATH];         /**< The chunk manifest */
+   long offset;                     /**< The offset of the chunks of the file in the manifest */
+   mode_t mode;                     /**< The mode of the file */
+   uint64_t size;                   /**< The size of the file */
+};
+
+static uint64_t gear[256];
+static pthread_once_t gear_once = PTHREAD_ONCE_INIT;
+
+static void create_gear(void);
+static size_t chunk_boundary(unsigned char* data, size_t length);
+static int store_open(struct dedup_store* store);
+static int store_lock(struct dedup_store* store, char* name, int operation, int* fd);
+static int backup_lock(int server, char* label, int* fd);
+static void store_close(struct dedup_store* store);
+static int load_references(struct dedup_store* store);
+static int add_references(struct dedup_store* store);
+static int save_references(struct dedup_store* store);
+static char* chunk_path(char* store, char* hash);
+static int store_chunk(struct dedup_store* store, unsigned char* data, size_t length, char* hash);
+static int find_files(struct dedup_store* store, char* root, char* relative, struct workers* workers);
+static bool is_excluded(char* relative);
+static int create_input(struct dedup_store* store, char* root, char* relative, struct workers* workers, struct dedup_input** input);
+static void do_chunk_file(struct worker_common* wc);
+static void do_materialize_file(struct worker_common* wc);
+static int parse_file(char* line, mode_t* mode, uint64_t* size, char** relative);
+static int parse_chunk(char* line, char* hash, uint64_t* length);
+static char* manifest_path(int server, char* label);
+static int read_users(int server, char* label, uint64_t* users);
+static int write_users(int server, char* label, uint64_t users);
+static int remove_files(int server, char* label);
+
+int
+pgmoneta_dedup_backup(int server, char* label, uint64_t* size)
+{
+   char* root = NULL;
+   char* manifest = NULL;
+   char* tmp_manifest = NULL;
+   int number_of_workers = 0;
+   struct workers* workers = NULL;
+   struct dedup_store store;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   *size = 0;
+
+   memset(&store, 0, sizeof(struct dedup_store));
+   store.lock = -1;
+   store.chunks = -1;
+   pthread_mutex_init(&store.mutex, NULL);
+
+   root = pgmoneta_get_server_backup_identifier(server, label);
+   manifest = manifest_path(server, label);
+   tmp_manifest = pgmoneta_append(tmp_manifest, manifest);
+   tmp_manifest = pgmoneta_append(tmp_manifest, ".tmp");
+
+   /* The chunks are written without the references lock. The shared lock only */
+   /* keeps a release from removing a chunk this backup found in the store */
+   if (store_open(&store) || store_lock(&store, DEDUP_CHUNKS, LOCK_SH, &store.chunks))
+   {
+      goto error;
+   }
+
+   if (pgmoneta_art_create(&store.added))
+   {
+      goto error;
+   }
+
+   store.manifest = fopen(tmp_manifest, "w");
+   if (store.manifest == NULL)
+   {
+      pgmoneta_log_error("Deduplicate: Could not create %s: %s", tmp_manifest, strerror(errno));
+      goto error;
+   }
+
+   number_of_workers = pgmoneta_get_number_of_workers(server);
+   if (number_of_workers > 0)
+   {
+      pgmoneta_workers_initialize(number_of_workers, &workers);
+   }
+
+   if (find_files(&store, root, "", workers))
+   {
+      goto error;
+   }
+
+   pgmoneta_workers_wait(workers);
+   if (workers != NULL && !workers->outcome)
+   {
+      goto error;
+   }
+   pgmoneta_workers_destroy(workers);
+   workers = NULL;
+
+   /* The references are saved first, so a crash can only leak chunks */
+   if (store_lock(&store, DEDUP_LOCK, LOCK_EX, &store.lock) ||
+       load_references(&store) ||
+       add_references(&store) ||
+       save_references(&store))
+   {
+      goto error;
+   }
+
+   if (fflush(store.manifest) != 0 || fsync(fileno(store.manifest)) != 0)
+   {
+      pgmoneta_log_error("Deduplicate: Could not write %s: %s", tmp_manifest, strerror(errno));
+      goto error;
+   }
+   fclose(store.manifest);
+   store.manifest = NULL;
+
+   if (rename(tmp_manifest, manifest) != 0)
+   {
+      pgmoneta_log_error("Deduplicate: Could not rename %s: %s", tmp_manifest, strerror(errno));
+      goto error;
+   }
+
+   *size = store.size;
+
+   pgmoneta_log_debug("Deduplicate: %s/%s added %" PRIu64 " of %" PRIu64 " bytes to the chunk store",
+                      config->common.servers[server].name, label, store.size, store.total);
+
+   store_close(&store);
+   pthread_mutex_destroy(&store.mutex);
+
+   free(root);
+   free(manifest);
+   free(tmp_manifest);
+
+   return remove_files(server, label);
+
+error:
+
+   if (workers != NULL)
+   {
+      pgmoneta_workers_wait(workers);
+      pgmoneta_workers_destroy(workers);
+   }
+
+   if (store.manifest != NULL)
+   {
+      fclose(store.manifest);
+      store.manifest = NULL;
+   }
+
+   if (tmp_manifest != NULL)
+   {
+      unlink(tmp_manifest);
+   }
+
+   store_close(&store);
+   pthread_mutex_destroy(&store.mutex);
+
+   free(root);
+   free(manifest);
+   free(tmp_manifest);
+
+   return 1;
+}
+
+bool
+pgmoneta_dedup_is_backup(int server, char* label)
+{
+   char* manifest = NULL;
+   bool result = false;
+
+   manifest = manifest_path(server, label);
+   result = pgmoneta_exists(manifest);
+   free(manifest);
+
+   return result;
+}
+
+int
+pgmoneta_dedup_materialize(int server, char* label)
+{
+   char* root = NULL;
+   char* manifest = NULL;
+   char* relative = NULL;
+   char line[MAX_PATH + 128];
+   FILE* file = NULL;
+   mode_t mode = 0;
+   uint64_t size = 0;
+   int number_of_workers = 0;
+   struct workers* workers = NULL;
+   uint64_t users = 0;
+   struct dedup_input* input = NULL;
+   struct dedup_store store;
+
+   if (!pgmoneta_dedup_is_backup(server, label))
+   {
+      return 0;
+   }
+
+   memset(&store, 0, sizeof(struct dedup_store));
+   store.lock = -1;
+   store.chunks = -1;
+
+   /* Restore, archive and verify can read the same backup at the same time. */
+   /* They only wait for each other, the chunks of a live backup aren't removed */
+   if (store_open(&store) || backup_lock(server, label, &store.lock))
+   {
+      goto error;
+   }
+
+   if (read_users(server, label, &users))
+   {
+      goto error;
+   }
+
+   if (users > 0)
+   {
+      if (write_users(server, label, users + 1))
+      {
+         goto error;
+      }
+
+      store_close(&store);
+
+      return 0;
+   }
+
+   root = pgmoneta_get_server_backup_identifier(server, label);
+   manifest = manifest_path(server, label);
+
+   file = fopen(manifest, "r");
+   if (file == NULL)
+   {
+      pgmoneta_log_error("Materialize: Could not open %s: %s", manifest, strerror(errno));
+      goto error;
+   }
+
+   number_of_workers = pgmoneta_get_number_of_workers(server);
+   if (number_of_workers > 0)
+   {
+      pgmoneta_workers_initialize(number_of_workers, &workers);
+   }
+
+   while (fgets(line, sizeof(line), file) != NULL)
+   {
+      if (line[0] != 'F')
+      {
+         continue;
+      }
+
+      if (parse_file(line, &mode, &size, &relative))
+      {
+         pgmoneta_log_error("Materialize: Invalid entry in %s: %s", manifest, line);
+         goto error;
+      }
+
+      if (create_input(&store, root, relative, workers, &input))
+      {
+         goto error;
+      }
+
+      memcpy(input->manifest, manifest, strlen(manifest));
+      input->offset = ftell(file);
+      input->mode = mode;
+      input->size = size;
+
+      if (workers != NULL)
+      {
+         if (workers->outcome)
+         {
+            pgmoneta_workers_add(workers, do_materialize_file, (struct worker_common*)input);
+         }
+         else
+         {
+            free(input);
+         }
+      }
+      else
+      {
+         do_materialize_file((struct worker_common*)input);
+      }
+      input = NULL;
+   }
+
+   if (ferror(file))
+   {
+      pgmoneta_log_error("Materialize: Could not read %s", manifest);
+      goto error;
+   }
+
+   pgmoneta_workers_wait(workers);
+   if (workers != NULL && !workers->outcome)
+   {
+      goto error;
+   }
+   pgmoneta_workers_destroy(workers);
+   workers = NULL;
+
+   fclose(file);
+   file = NULL;
+
+   if (write_users(server, label, 1))
+   {
+      goto error;
+   }
+
+   store_close(&store);
+
+   free(root);
+   free(manifest);
+
+   return 0;
+
+error:
+
+   if (workers != NULL)
+   {
+      pgmoneta_workers_wait(workers);
+      pgmoneta_workers_destroy(workers);
+   }
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   if (users == 0 && root != NULL)
+   {
+      remove_files(server, label);
+   }
+
+   store_close(&store);
+
+   free(root);
+   free(manifest);
+
+   return 1;
+}
+
+int
+pgmoneta_dedup_dematerialize(int server, char* label)
+{
+   uint64_t users = 0;
+   struct dedup_store store;
+
+   if (!pgmoneta_dedup_is_backup(server, label))
+   {
+      return 0;
+   }
+
+   memset(&store, 0, sizeof(struct dedup_store));
+   store.lock = -1;
+   store.chunks = -1;
+
+   if (store_open(&store) || backup_lock(server, label, &store.lock))
+   {
+      goto error;
+   }
+
+   if (read_users(server, label, &users))
+   {
+      goto error;
+   }
+
+   if (users > 1)
+   {
+      if (write_users(server, label, users - 1))
+      {
+         goto error;
+      }
+   }
+   else
+   {
+      if (users == 0)
+      {
+         pgmoneta_log_warn("Dematerialize: %s has no users", label);
+      }
+
+      if (remove_files(server, label))
+      {
+         goto error;
+      }
+
+      if (write_users(server, label, 0))
+      {
+         goto error;
+      }
+   }
+
+   store_close(&store);
+
+   return 0;
+
+error:
+
+   store_close(&store);
+
+   return 1;
+}
+
+int
+pgmoneta_dedup_release(int server, char* label)
+{
+   char* manifest = NULL;
+   char* path = NULL;
+   char hash[HASH_LENGTH + 1];
+   char line[MAX_PATH + 128];
+   uint64_t length = 0;
+   uint64_t count = 0;
+   uint64_t removed = 0;
+   int64_t used = 0;
+   FILE* file = NULL;
+   struct deque* unused = NULL;
+   struct deque_iterator* iter = NULL;
+   struct dedup_store store;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (!pgmoneta_dedup_is_backup(server, label))
+   {
+      return 0;
+   }
+
+   if (pgmoneta_deque_create(false, &unused))
+   {
+      return 1;
+   }
+
+   memset(&store, 0, sizeof(struct dedup_store));
+   store.lock = -1;
+   store.chunks = -1;
+
+   /* Waits for the backups that are writing chunks, they may use the chunks removed here */
+   if (store_open(&store) ||
+       store_lock(&store, DEDUP_CHUNKS, LOCK_EX, &store.chunks) ||
+       store_lock(&store, DEDUP_LOCK, LOCK_EX, &store.lock) ||
+       load_references(&store))
+   {
+      goto error;
+   }
+
+   manifest = manifest_path(server, label);
+
+   file = fopen(manifest, "r");
+   if (file == NULL)
+   {
+      pgmoneta_log_error("Release: Could not open %s: %s", manifest, strerror(errno));
+      goto error;
+   }
+
+   while (fgets(line, sizeof(line), file) != NULL)
+   {
+      if (line[0] != 'C')
+      {
+         continue;
+      }
+
+      if (parse_chunk(line, &hash[0], &length))
+      {
+         pgmoneta_log_error("Release: Invalid entry in %s: %s", manifest, line);
+         goto error;
+      }
+
+      if (!pgmoneta_art_contains_key(store.references, &hash[0]))
+      {
+         pgmoneta_log_warn("Release: No references to chunk %s", &hash[0]);
+         continue;
+      }
+
+      count = (uint64_t)pgmoneta_art_search(store.references, &hash[0]);
+
+      if (count > 1)
+      {
+         pgmoneta_art_insert(store.references, &hash[0], (uintptr_t)(count - 1), ValueUInt64);
+      }
+      else
+      {
+         pgmoneta_art_delete(store.references, &hash[0]);
+
+         if (pgmoneta_deque_add(unused, &hash[0], (uintptr_t)length, ValueUInt64))
+         {
+            goto error;
+         }
+      }
+   }
+
+   if (ferror(file))
+   {
+      pgmoneta_log_error("Release: Could not read %s", manifest);
+      goto error;
+   }
+
+   fclose(file);
+   file = NULL;
+
+   /* The references are saved before the chunks are removed, so a crash can only leak chunks */
+   if (save_references(&store))
+   {
+      goto error;
+   }
+
+   if (pgmoneta_deque_iterator_create(unused, &iter))
+   {
+      goto error;
+   }
+
+   while (pgmoneta_deque_iterator_next(iter))
+   {
+      path = chunk_path(&store.path[0], iter->tag);
+      used = pgmoneta_space_file(path);
+      if (unlink(path) == 0)
+      {
+         pgmoneta_space_add(SPACE_OTHER, 0, -used);
+      }
+      else if (errno != ENOENT)
+      {
+         pgmoneta_log_warn("Release: Could not remove %s: %s", path, strerror(errno));
+      }
+      free(path);
+      path = NULL;
+
+      removed += (uint64_t)pgmoneta_value_data(iter->value);
+   }
+
+   pgmoneta_deque_iterator_destroy(iter);
+   iter = NULL;
+
+   unlink(manifest);
+
+   pgmoneta_log_debug("Release: %s/%s removed %" PRIu64 " bytes from the chunk store",
+                      config->common.servers[server].name, label, removed);
+
+   store_close(&store);
+   pgmoneta_deque_destroy(unused);
+   free(manifest);
+
+   return 0;
+
+error:
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   pgmoneta_deque_iterator_destroy(iter);
+   store_close(&store);
+   pgmoneta_deque_destroy(unused);
+   free(manifest);
+   free(path);
+
+   return 1;
+}
+
+static void
+create_gear(void)
+{
+   uint64_t state = UINT64_C(0x9E3779B97F4A7C15);
+
+   /* splitmix64, so the table is the same on every build */
+   for (int i = 0; i < 256; i++)
+   {
+      uint64_t z = (state += UINT64_C(0x9E3779B97F4A7C15));
+
+      z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+      z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+      gear[i] = z ^ (z >> 31);
+   }
+}
+
+static size_t
+chunk_boundary(unsigned char* data, size_t length)
+{
+   uint64_t hash = 0;
+   size_t i = CHUNK_MIN_SIZE;
+   size_t normal = CHUNK_AVG_SIZE;
+   size_t max = CHUNK_MAX_SIZE;
+
+   if (length <= CHUNK_MIN_SIZE)
+   {
+      return length;
+   }
+
+   if (normal > length)
+   {
+      normal = length;
+   }
+
+   if (max > length)
+   {
+      max = length;
+   }
+
+   for (; i < normal; i++)
+   {
+      hash = (hash << 1) + gear[data[i]];
+      if (!(hash & CHUNK_MASK_S))
+      {
+         return i + 1;
+      }
+   }
+
+   for (; i < max; i++)
+   {
+      hash = (hash << 1) + gear[data[i]];
+      if (!(hash & CHUNK_MASK_L))
+      {
+         return i + 1;
+      }
+   }
+
+   return max;
+}
+
+static int
+store_open(struct dedup_store* store)
+{
+   char* d = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   d = pgmoneta_append(d, config->base_dir);
+   if (!pgmoneta_ends_with(d, "/"))
+   {
+      d = pgmoneta_append(d, "/");
+   }
+   d = pgmoneta_append(d, DEDUP_DIRECTORY);
+   d = pgmoneta_append(d, "/");
+
+   if (strlen(d) >= MAX_PATH - HASH_LENGTH - 32)
+   {
+      pgmoneta_log_error("Deduplicate: Path too long %s", d);
+      goto error;
+   }
+   memcpy(store->path, d, strlen(d) + 1);
+
+   if (pgmoneta_mkdir(d))
+   {
+      pgmoneta_log_error("Deduplicate: Could not create %s: %s", d, strerror(errno));
+      goto error;
+   }
+
+   free(d);
+
+   return 0;
+
+error:
+
+   free(d);
+
+   return 1;
+}
+
+static int
+store_lock(struct dedup_store* store, char* name, int operation, int* fd)
+{
+   char* l = NULL;
+
+   l = pgmoneta_append(l, store->path);
+   l = pgmoneta_append(l, name);
+
+   *fd = open(l, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+   if (*fd == -1)
+   {
+      pgmoneta_log_error("Deduplicate: Could not open %s: %s", l, strerror(errno));
+      goto error;
+   }
+
+   /* The backups, deletes and readers of all the servers share the store */
+   if (flock(*fd, operation) != 0)
+   {
+      pgmoneta_log_error("Deduplicate: Could not lock %s: %s", l, strerror(errno));
+      goto error;
+   }
+
+   free(l);
+
+   return 0;
+
+error:
+
+   if (*fd != -1)
+   {
+      close(*fd);
+      *fd = -1;
+   }
+
+   free(l);
+
+   return 1;
+}
+
+static int
+backup_lock(int server, char* label, int* fd)
+{
+   char* manifest = NULL;
+
+   manifest = manifest_path(server, label);
+
+   *fd = open(manifest, O_RDONLY);
+   if (*fd == -1)
+   {
+      pgmoneta_log_error("Deduplicate: Could not open %s: %s", manifest, strerror(errno));
+      goto error;
+   }
+
+   if (flock(*fd, LOCK_EX) != 0)
+   {
+      pgmoneta_log_error("Deduplicate: Could not lock %s: %s", manifest, strerror(errno));
+      goto error;
+   }
+
+   free(manifest);
+
+   return 0;
+
+error:
+
+   if (*fd != -1)
+   {
+      close(*fd);
+      *fd = -1;
+   }
+
+   free(manifest);
+
+   return 1;
+}
+
+static void
+store_close(struct dedup_store* store)
+{
+   pgmoneta_art_destroy(store->references);
+   store->references = NULL;
+
+   pgmoneta_art_destroy(store->added);
+   store->added = NULL;
+
+   if (store->lock != -1)
+   {
+      flock(store->lock, LOCK_UN);
+      close(store->lock);
+      store->lock = -1;
+   }
+
+   if (store->chunks != -1)
+   {
+      flock(store->chunks, LOCK_UN);
+      close(store->chunks);
+      store->chunks = -1;
+   }
+}
+
+static int
+load_references(struct dedup_store* store)
+{
+   char* path = NULL;
+   char line[128];
+   char hash[HASH_LENGTH + 1];
+   uint64_t count = 0;
+   FILE* file = NULL;
+
+   if (pgmoneta_art_create(&store->references))
+   {
+      goto error;
+   }
+
+   path = pgmoneta_append(path, store->path);
+   path = pgmoneta_append(path, DEDUP_REFERENCES);
+
+   file = fopen(path, "r");
+   if (file == NULL)
+   {
+      if (errno == ENOENT)
+      {
+         free(path);
+         return 0;
+      }
+
+      pgmoneta_log_error("Deduplicate: Could not open %s: %s", path, strerror(errno));
+      goto error;
+   }
+
+   while (fgets(line, sizeof(line), file) != NULL)
+   {
+      if (parse_chunk(line, &hash[0], &count))
+      {
+         pgmoneta_log_error("Deduplicate: Invalid entry in %s: %s", path, line);
+         goto error;
+      }
+
+      if (pgmoneta_art_insert(store->references, &hash[0], (uintptr_t)count, ValueUInt64))
+      {
+         goto error;
+      }
+   }
+
+   if (ferror(file))
+   {
+      pgmoneta_log_error("Deduplicate: Could not read %s", path);
+      goto error;
+   }
+
+   fclose(file);
+   free(path);
+
+   return 0;
+
+error:
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   free(path);
+
+   return 1;
+}
+
+static int
+add_references(struct dedup_store* store)
+{
+   uint64_t count = 0;
+   struct art_iterator* iter = NULL;
+
+   if (pgmoneta_art_iterator_create(store->added, &iter))
+   {
+      goto error;
+   }
+
+   while (pgmoneta_art_iterator_next(iter))
+   {
+      count = (uint64_t)pgmoneta_value_data(iter->value);
+
+      if (pgmoneta_art_contains_key(store->references, iter->key))
+      {
+         count += (uint64_t)pgmoneta_art_search(store->references, iter->key);
+      }
+
+      if (pgmoneta_art_insert(store->references, iter->key, (uintptr_t)count, ValueUInt64))
+      {
+         goto error;
+      }
+   }
+
+   pgmoneta_art_iterator_destroy(iter);
+
+   return 0;
+
+error:
+
+   pgmoneta_art_iterator_destroy(iter);
+
+   return 1;
+}
+
+static int
+save_references(struct dedup_store* store)
+{
+   char* path = NULL;
+   char* tmp = NULL;
+   FILE* file = NULL;
+   struct art_iterator* iter = NULL;
+
+   path = pgmoneta_append(path, store->path);
+   path = pgmoneta_append(path, DEDUP_REFERENCES);
+   tmp = pgmoneta_append(tmp, path);
+   tmp = pgmoneta_append(tmp, ".tmp");
+
+   file = fopen(tmp, "w");
+   if (file == NULL)
+   {
+      pgmoneta_log_error("Deduplicate: Could not create %s: %s", tmp, strerror(errno));
+      goto error;
+   }
+
+   if (pgmoneta_art_iterator_create(store->references, &iter))
+   {
+      goto error;
+   }
+
+   while (pgmoneta_art_iterator_next(iter))
+   {
+      fprintf(file, "C %s %" PRIu64 "\n", iter->key, (uint64_t)pgmoneta_value_data(iter->value));
+   }
+
+   pgmoneta_art_iterator_destroy(iter);
+   iter = NULL;
+
+   if (fflush(file) != 0 || fsync(fileno(file)) != 0 || ferror(file))
+   {
+      pgmoneta_log_error("Deduplicate: Could not write %s: %s", tmp, strerror(errno));
+      goto error;
+   }
+
+   fclose(file);
+   file = NULL;
+
+   if (rename(tmp, path) != 0)
+   {
+      pgmoneta_log_error("Deduplicate: Could not rename %s: %s", tmp, strerror(errno));
+      goto error;
+   }
+
+   free(path);
+   free(tmp);
+
+   return 0;
+
+error:
+
+   pgmoneta_art_iterator_destroy(iter);
+
+   if (file != NULL)
+   {
+      fclose(file);
+      unlink(tmp);
+   }
+
+   free(path);
+   free(tmp);
+
+   return 1;
+}
+
+static char*
+chunk_path(char* store, char* hash)
+{
+   char* path = NULL;
+   char prefix[4];
+
+   memset(&prefix[0], 0, sizeof(prefix));
+   memcpy(&prefix[0], hash, 2);
+   prefix[2] = '/';
+
+   path = pgmoneta_append(path, store);
+   path = pgmoneta_append(path, &prefix[0]);
+   path = pgmoneta_append(path, hash);
+
+   return path;
+}
+
+static int
+store_chunk(struct dedup_store* store, unsigned char* data, size_t length, char* hash)
+{
+   unsigned char digest[EVP_MAX_MD_SIZE];
+   unsigned int digest_length = 0;
+   char* path = NULL;
+   char* tmp = NULL;
+   char* dir = NULL;
+   bool claimed = false;
+   int fd = -1;
+   size_t written = 0;
+   ssize_t w;
+
+   if (EVP_Digest(data, length, digest, &digest_length, EVP_sha256(), NULL) != 1)
+   {
+      goto error;
+   }
+
+   for (unsigned int i = 0; i < digest_length; i++)
+   {
+      sprintf(hash + (i * 2), "%02x", digest[i]);
+   }
+   hash[HASH_LENGTH] = '\0';
+
+   pthread_mutex_lock(&store->mutex);
+   if (pgmoneta_art_contains_key(store->added, hash))
+   {
+      uint64_t count = (uint64_t)pgmoneta_art_search(store->added, hash);
+
+      pgmoneta_art_insert(store->added, hash, (uintptr_t)(count + 1), ValueUInt64);
+   }
+   else
+   {
+      /* The first reference of this backup writes the chunk, the others wait for the end of the backup */
+      pgmoneta_art_insert(store->added, hash, (uintptr_t)1, ValueUInt64);
+      claimed = true;
+   }
+   store->total += length;
+   pthread_mutex_unlock(&store->mutex);
+
+   if (!claimed)
+   {
+      return 0;
+   }
+
+   path = chunk_path(&store->path[0], hash);
+
+   /* Stored by another backup, or left behind by one that didn't complete */
+   if (pgmoneta_exists(path))
+   {
+      free(path);
+      return 0;
+   }
+
+   dir = pgmoneta_append(dir, store->path);
+   dir = pgmoneta_append_char(dir, hash[0]);
+   dir = pgmoneta_append_char(dir, hash[1]);
+   if (pgmoneta_mkdir(dir))
+   {
+      pgmoneta_log_error("Deduplicate: Could not create %s: %s", dir, strerror(errno));
+      goto error;
+   }
+
+   /* Backups of other servers may write the same chunk at the same time, the chunk */
+   /* has the same content whichever rename comes last */
+   tmp = pgmoneta_append(tmp, path);
+   tmp = pgmoneta_append_char(tmp, '.');
+   tmp = pgmoneta_append_int(tmp, (int)getpid());
+   tmp = pgmoneta_append(tmp, ".tmp");
+
+   fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+   if (fd == -1)
+   {
+      pgmoneta_log_error("Deduplicate: Could not create %s: %s", tmp, strerror(errno));
+      goto error;
+   }
+
+   while (written < length)
+   {
+      w = write(fd, data + written, length - written);
+      if (w < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+         pgmoneta_log_error("Deduplicate: Could not write %s: %s", tmp, strerror(errno));
+         goto error;
+      }
+      written += w;
+   }
+
+#if defined(HAVE_DARWIN) || defined(HAVE_OSX)
+   if (fsync(fd) != 0)
+#else
+   if (fdatasync(fd) != 0)
+#endif
+   {
+      pgmoneta_log_error("Deduplicate: Could not sync %s: %s", tmp, strerror(errno));
+      goto error;
+   }
+
+   close(fd);
+   fd = -1;
+
+   if (rename(tmp, path) != 0)
+   {
+      pgmoneta_log_error("Deduplicate: Could not rename %s: %s", tmp, strerror(errno));
+      goto error;
+   }
+
+   pgmoneta_space_add(SPACE_OTHER, 0, pgmoneta_space_file(path));
+
+   pthread_mutex_lock(&store->mutex);
+   store->size += length;
+   pthread_mutex_unlock(&store->mutex);
+
+   free(path);
+   free(tmp);
+   free(dir);
+
+   return 0;
+
+error:
+
+   if (fd != -1)
+   {
+      close(fd);
+      unlink(tmp);
+   }
+
+   free(path);
+   free(tmp);
+   free(dir);
+
+   return 1;
+}
+
+static int
+find_files(struct dedup_store* store, char* root, char* relative, struct workers* workers)
+{
+   DIR* dir = NULL;
+   char* path = NULL;
+   char* entry_relative = NULL;
+   struct dirent* entry;
+   struct stat statbuf;
+   struct dedup_input* input = NULL;
+
+   path = pgmoneta_append(path, root);
+   path = pgmoneta_append(path, relative);
+
+   dir = opendir(path);
+   if (dir == NULL)
+   {
+      pgmoneta_log_error("Deduplicate: Could not open %s: %s", path, strerror(errno));
+      goto error;
+   }
+
+   while ((entry = readdir(dir)) != NULL)
+   {
+      char* entry_path = NULL;
+
+      if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+      {
+         continue;
+      }
+
+      entry_relative = pgmoneta_append(entry_relative, relative);
+      entry_relative = pgmoneta_append(entry_relative, entry->d_name);
+
+      entry_path = pgmoneta_append(entry_path, path);
+      entry_path = pgmoneta_append(entry_path, entry->d_name);
+
+      if (lstat(entry_path, &statbuf) != 0)
+      {
+         pgmoneta_log_error("Deduplicate: Could not stat %s: %s", entry_path, strerror(errno));
+         free(entry_path);
+         goto error;
+      }
+      free(entry_path);
+
+      if (S_ISDIR(statbuf.st_mode))
+      {
+         entry_relative = pgmoneta_append(entry_relative, "/");
+
+         if (find_files(store, root, entry_relative, workers))
+         {
+            goto error;
+         }
+      }
+      else if (S_ISREG(statbuf.st_mode) && strlen(relative) > 0 && !is_excluded(entry_relative))
+      {
+         if (create_input(store, root, entry_relative, workers, &input))
+         {
+            goto error;
+         }
+
+         input->mode = statbuf.st_mode & 07777;
+         input->size = statbuf.st_size;
+
+         if (workers != NULL)
+         {
+            if (workers->outcome)
+            {
+               pgmoneta_workers_add(workers, do_chunk_file, (struct worker_common*)input);
+            }
+            else
+            {
+               free(input);
+            }
+         }
+         else
+         {
+            do_chunk_file((struct worker_common*)input);
+         }
+         input = NULL;
+      }
+
+      free(entry_relative);
+      entry_relative = NULL;
+   }
+
+   closedir(dir);
+   free(path);
+
+   return 0;
+
+error:
+
+   if (dir != NULL)
+   {
+      closedir(dir);
+   }
+
+   free(path);
+   free(entry_relative);
+
+   return 1;
+}
+
+static bool
+is_excluded(char* relative)
+{
+   /* Read by incremental backups, retention and the WAL cleanup without a restore */
+   if (!strcmp(relative, "data/backup_manifest") ||
+       !strcmp(relative, "data/backup_label") ||
+       pgmoneta_starts_with(relative, "data/pg_wal/"))
+   {
+      return true;
+   }
+
+   return false;
+}
+
+static int
+create_input(struct dedup_store* store, char* root, char* relative, struct workers* workers, struct dedup_input** input)
+{
+   struct dedup_input* i = NULL;
+
+   *input = NULL;
+
+   if (strlen(root) + strlen(relative) >= MAX_PATH)
+   {
+      pgmoneta_log_error("Deduplicate: Path too long %s%s", root, relative);
+      return 1;
+   }
+
+   i = (struct dedup_input*)malloc(sizeof(struct dedup_input));
+   if (i == NULL)
+   {
+      return 1;
+   }
+
+   memset(i, 0, sizeof(struct dedup_input));
+   i->common.workers = workers;
+   i->store = store;
+   memcpy(i->root, root, strlen(root));
+   memcpy(i->relative, relative, strlen(relative));
+
+   *input = i;
+
+   return 0;
+}
+
+static void
+do_chunk_file(struct worker_common* wc)
+{
+   struct dedup_input* input = (struct dedup_input*)wc;
+   char* path = NULL;
+   char hash[HASH_LENGTH + 1];
+   char* record = NULL;
+   char entry[MAX_PATH + 64];
+   unsigned char* buffer = NULL;
+   size_t capacity = 2 * CHUNK_MAX_SIZE;
+   size_t start = 0;
+   size_t end = 0;
+   size_t cut = 0;
+   uint64_t size = 0;
+   bool eof = false;
+   FILE* file = NULL;
+
+   pthread_once(&gear_once, create_gear);
+
+   path = pgmoneta_append(path, input->root);
+   path = pgmoneta_append(path, input->relative);
+
+   snprintf(&entry[0], sizeof(entry), "F %o %" PRIu64 " %s\n", (unsigned int)input->mode, input->size, input->relative);
+   record = pgmoneta_append(record, &entry[0]);
+
+   buffer = (unsigned char*)malloc(capacity);
+   if (buffer == NULL)
+   {
+      goto error;
+   }
+
+   file = fopen(path, "rb");
+   if (file == NULL)
+   {
+      pgmoneta_log_error("Deduplicate: Could not open %s: %s", path, strerror(errno));
+      goto error;
+   }
+
+   while (!eof || start < end)
+   {
+      if (!eof && end - start < CHUNK_MAX_SIZE)
+      {
+         if (capacity - start < CHUNK_MAX_SIZE)
+         {
+            memmove(buffer, buffer + start, end - start);
+            end -= start;
+            start = 0;
+         }
+
+         while (!eof && end < capacity)
+         {
+            size_t r = fread(buffer + end, 1, capacity - end, file);
+
+            if (r == 0)
+            {
+               if (ferror(file))
+               {
+                  pgmoneta_log_error("Deduplicate: Could not read %s", path);
+                  goto error;
+               }
+               eof = true;
+            }
+            end += r;
+         }
+         continue;
+      }
+
+      cut = chunk_boundary(buffer + start, end - start);
+
+      if (store_chunk(input->store, buffer + start, cut, &hash[0]))
+      {
+         goto error;
+      }
+
+      snprintf(&entry[0], sizeof(entry), "C %s %zu\n", &hash[0], cut);
+      record = pgmoneta_append(record, &entry[0]);
+
+      start += cut;
+      size += cut;
+   }
+
+   if (size != input->size)
+   {
+      pgmoneta_log_error("Deduplicate: %s changed while it was chunked", path);
+      goto error;
+   }
+
+   pthread_mutex_lock(&input->store->mutex);
+   if (fputs(record, input->store->manifest) == EOF)
+   {
+      pthread_mutex_unlock(&input->store->mutex);
+      pgmoneta_log_error("Deduplicate: Could not write the chunk manifest: %s", strerror(errno));
+      goto error;
+   }
+   pthread_mutex_unlock(&input->store->mutex);
+
+   fclose(file);
+   free(path);
+   free(buffer);
+   free(record);
+   free(input);
+
+   return;
+
+error:
+
+   if (input->common.workers != NULL)
+   {
+      input->common.workers->outcome = false;
+   }
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   free(path);
+   free(buffer);
+   free(record);
+   free(input);
+}
+
+static void
+do_materialize_file(struct worker_common* wc)
+{
+   struct dedup_input* input = (struct dedup_input*)wc;
+   char* path = NULL;
+   char* tmp = NULL;
+   char hash[HASH_LENGTH + 1];
+   char line[MAX_PATH + 128];
+   char* chunk = NULL;
+   unsigned char* buffer = NULL;
+   uint64_t length = 0;
+   uint64_t size = 0;
+   size_t r = 0;
+   struct stat statbuf;
+   FILE* manifest = NULL;
+   FILE* in = NULL;
+   FILE* out = NULL;
+
+   path = pgmoneta_append(path, input->root);
+   path = pgmoneta_append(path, input->relative);
+   tmp = pgmoneta_append(tmp, path);
+   tmp = pgmoneta_append(tmp, ".tmp");
+
+   /* Already there from an earlier materialize */
+   if (!lstat(path, &statbuf) && S_ISREG(statbuf.st_mode) && (uint64_t)statbuf.st_size == input->size)
+   {
+      free(path);
+      free(tmp);
+      free(input);
+      return;
+   }
+
+   buffer = (unsigned char*)malloc(CHUNK_MAX_SIZE);
+   if (buffer == NULL)
+   {
+      goto error;
+   }
+
+   manifest = fopen(input->manifest, "r");
+   if (manifest == NULL || fseek(manifest, input->offset, SEEK_SET) != 0)
+   {
+      pgmoneta_log_error("Materialize: Could not read %s: %s", input->manifest, strerror(errno));
+      goto error;
+   }
+
+   out = fopen(tmp, "wb");
+   if (out == NULL)
+   {
+      pgmoneta_log_error("Materialize: Could not create %s: %s", tmp, strerror(errno));
+      goto error;
+   }
+
+   while (fgets(line, sizeof(line), manifest) != NULL && line[0] == 'C')
+   {
+      if (parse_chunk(line, &hash[0], &length) || length > CHUNK_MAX_SIZE)
+      {
+         pgmoneta_log_error("Materialize: Invalid entry in %s: %s", input->manifest, line);
+         goto error;
+      }
+
+      chunk = chunk_path(&input->store->path[0], &hash[0]);
+
+      in = fopen(chunk, "rb");
+      if (in == NULL)
+      {
+         pgmoneta_log_error("Materialize: Missing chunk %s for %s", chunk, path);
+         goto error;
+      }
+
+      r = fread(buffer, 1, CHUNK_MAX_SIZE, in);
+      if (r != length || ferror(in))
+      {
+         pgmoneta_log_error("Materialize: Invalid chunk %s for %s", chunk, path);
+         goto error;
+      }
+
+      if (fwrite(buffer, 1, r, out) != r)
+      {
+         pgmoneta_log_error("Materialize: Could not write %s: %s", tmp, strerror(errno));
+         goto error;
+      }
+
+      fclose(in);
+      in = NULL;
+
+      free(chunk);
+      chunk = NULL;
+
+      size += length;
+   }
+
+   if (size != input->size)
+   {
+      pgmoneta_log_error("Materialize: %s has %" PRIu64 " bytes, expected %" PRIu64, path, size, input->size);
+      goto error;
+   }
+
+   if (fflush(out) != 0 || ferror(out))
+   {
+      pgmoneta_log_error("Materialize: Could not write %s: %s", tmp, strerror(errno));
+      goto error;
+   }
+
+   fclose(out);
+   out = NULL;
+
+   if (chmod(tmp, input->mode) != 0 || rename(tmp, path) != 0)
+   {
+      pgmoneta_log_error("Materialize: Could not create %s: %s", path, strerror(errno));
+      goto error;
+   }
+
+   fclose(manifest);
+   free(path);
+   free(tmp);
+   free(buffer);
+   free(input);
+
+   return;
+
+error:
+
+   if (input->common.workers != NULL)
+   {
+      input->common.workers->outcome = false;
+   }
+
+   if (in != NULL)
+   {
+      fclose(in);
+   }
+
+   if (out != NULL)
+   {
+      fclose(out);
+      unlink(tmp);
+   }
+
+   if (manifest != NULL)
+   {
+      fclose(manifest);
+   }
+
+   free(path);
+   free(tmp);
+   free(chunk);
+   free(buffer);
+   free(input);
+}
+
+static int
+parse_file(char* line, mode_t* mode, uint64_t* size, char** relative)
+{
+   unsigned int m = 0;
+   int n = 0;
+   char* end = NULL;
+
+   if (sscanf(line, "F %o %" SCNu64 " %n", &m, size, &n) != 2 || n == 0)
+   {
+      return 1;
+   }
+
+   end = line + strlen(line);
+   while (end > line + n && (*(end - 1) == '\n' || *(end - 1) == '\r'))
+   {
+      end--;
+   }
+   *end = '\0';
+
+   if (strlen(line + n) == 0)
+   {
+      return 1;
+   }
+
+   *mode = (mode_t)m;
+   *relative = line + n;
+
+   return 0;
+}
+
+static int
+parse_chunk(char* line, char* hash, uint64_t* length)
+{
+   if (sscanf(line, "C %64s %" SCNu64, hash, length) != 2 || strlen(hash) != HASH_LENGTH)
+   {
+      return 1;
+   }
+
+   return 0;
+}
+
+static char*
+manifest_path(int server, char* label)
+{
+   char* path = NULL;
+
+   path = pgmoneta_get_server_backup_identifier(server, label);
+   path = pgmoneta_append(path, DEDUP_MANIFEST);
+
+   return path;
+}
+
+static int
+read_users(int server, char* label, uint64_t* users)
+{
+   char* path = NULL;
+   FILE* file = NULL;
+
+   *users = 0;
+
+   path = pgmoneta_get_server_backup_identifier(server, label);
+   path = pgmoneta_append(path, DEDUP_USERS);
+
+   file = fopen(path, "r");
+   if (file == NULL)
+   {
+      if (errno != ENOENT)
+      {
+         pgmoneta_log_error("Deduplicate: Could not open %s: %s", path, strerror(errno));
+         goto error;
+      }
+
+      free(path);
+      return 0;
+   }
+
+   /* A file cut short by a crash counts as no users, the files are then recreated */
+   if (fscanf(file, "%" SCNu64, users) != 1)
+   {
+      *users = 0;
+   }
+
+   fclose(file);
+   free(path);
+
+   return 0;
+
+error:
+
+   free(path);
+
+   return 1;
+}
+
+static int
+write_users(int server, char* label, uint64_t users)
+{
+   char* path = NULL;
+   FILE* file = NULL;
+
+   path = pgmoneta_get_server_backup_identifier(server, label);
+   path = pgmoneta_append(path, DEDUP_USERS);
+
+   if (users == 0)
+   {
+      if (unlink(path) != 0 && errno != ENOENT)
+      {
+         pgmoneta_log_error("Deduplicate: Could not remove %s: %s", path, strerror(errno));
+         goto error;
+      }
+
+      free(path);
+      return 0;
+   }
+
+   file = fopen(path, "w");
+   if (file == NULL)
+   {
+      pgmoneta_log_error("Deduplicate: Could not create %s: %s", path, strerror(errno));
+      goto error;
+   }
+
+   fprintf(file, "%" PRIu64 "\n", users);
+
+   if (fclose(file) != 0)
+   {
+      pgmoneta_log_error("Deduplicate: Could not write %s: %s", path, strerror(errno));
+      goto error;
+   }
+
+   free(path);
+
+   return 0;
+
+error:
+
+   free(path);
+
+   return 1;
+}
+
+static int
+remove_files(int server, char* label)
+{
+   char* root = NULL;
+   char* manifest = NULL;
+   char* relative = NULL;
+   char* path = NULL;
+   char line[MAX_PATH + 128];
+   FILE* file = NULL;
+   mode_t mode = 0;
+   uint64_t size = 0;
+
+   root = pgmoneta_get_server_backup_identifier(server, label);
+   manifest = manifest_path(server, label);
+
+   file = fopen(manifest, "r");
+   if (file == NULL)
+   {
+      pgmoneta_log_error("Dematerialize: Could not open %s: %s", manifest, strerror(errno));
+      goto error;
+   }
+
+   while (fgets(line, sizeof(line), file) != NULL)
+   {
+      if (line[0] != 'F')
+      {
+         continue;
+      }
+
+      if (parse_file(line, &mode, &size, &relative))
+      {
+         pgmoneta_log_error("Dematerialize: Invalid entry in %s: %s", manifest, line);
+         goto error;
+      }
+
+      path = pgmoneta_append(path, root);
+      path = pgmoneta_append(path, relative);
+
+      if (unlink(path) != 0 && errno != ENOENT)
+      {
+         pgmoneta_log_error("Dematerialize: Could not remove %s: %s", path, strerror(errno));
+         goto error;
+      }
+
+      free(path);
+      path = NULL;
+   }
+
+   fclose(file);
+
+   free(root);
+   free(manifest);
+
+   return 0;
+
+error:
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   free(root);
+   free(manifest);
+   free(path);
+
+   return 1;
+}
@@ -29,6 +29,7 @@
 /* pgmoneta */
 #include <pgmoneta.h>
 #include <logging.h>
+#include <space.h>
 #include <utils.h>
 #include <workflow.h>
 
@@ -44,9 +45,11 @@
  * @param srv_wal The oldest wal segment file we would like to keep
  * @param base The base directory holding the wal segments
  * @param backup_index The index of the oldest backup
+ * @param server The server
+ * @param area The space area of the base directory
  */
 static void
-delete_wal_older_than(char* srv_wal, char* base, int backup_index);
+delete_wal_older_than(char* srv_wal, char* base, int backup_index, int server, int area);
 
 int
 pgmoneta_delete(int srv, char* label)
@@ -148,7 +151,7 @@ pgmoneta_delete_wal(int srv)
    {
 
       d = pgmoneta_get_server_wal(srv);
-      delete_wal_older_than(srv_wal, d, backup_index);
+      delete_wal_older_than(srv_wal, d, backup_index, srv, SPACE_WAL);
       free(d);
       d = NULL;
 
@@ -156,7 +159,7 @@ pgmoneta_delete_wal(int srv)
       wal_shipping = pgmoneta_get_server_wal_shipping_wal(srv);
       if (wal_shipping != NULL)
       {
-         delete_wal_older_than(srv_wal, wal_shipping, backup_index);
+         delete_wal_older_than(srv_wal, wal_shipping, backup_index, srv, SPACE_WAL_SHIPPING);
       }
 
       free(wal_shipping);
@@ -198,7 +201,7 @@ error:
 }
 
 static void
-delete_wal_older_than(char* srv_wal, char* base, int backup_index)
+delete_wal_older_than(char* srv_wal, char* base, int backup_index, int server, int area)
 {
    int number_of_wal_files = 0;
    char** wal_files = NULL;
@@ -241,7 +244,12 @@ delete_wal_older_than(char* srv_wal, char* base, int backup_index)
          pgmoneta_log_trace("WAL: Deleting %s", wal_address);
          if (pgmoneta_exists(wal_address))
          {
-            pgmoneta_delete_file(wal_address, NULL);
+            int64_t size = pgmoneta_space_file(wal_address);
+
+            if (!pgmoneta_delete_file(wal_address, NULL))
+            {
+               pgmoneta_space_add(server, area, -size);
+            }
          }
          else
          {
@@ -29,6 +29,7 @@
 #include <pgmoneta.h>
 #include <deque.h>
 #include <logging.h>
+#include <string_builder.h>
 #include <utils.h>
 
 #include <stdlib.h>
@@ -657,16 +658,20 @@ deque_find(struct deque* deque, char* tag)
 static char*
 to_json_string(struct deque* deque, char* tag, int indent)
 {
-   char* ret = NULL;
-   ret = pgmoneta_indent(ret, tag, indent);
+   struct string_builder* sb = NULL;
+   if (pgmoneta_string_builder_create(0, &sb))
+   {
+      return NULL;
+   }
+   pgmoneta_string_builder_indent(sb, tag, indent);
    struct deque_node* cur = NULL;
    if (deque == NULL || pgmoneta_deque_empty(deque))
    {
-      ret = pgmoneta_append(ret, "[]");
-      return ret;
+      pgmoneta_string_builder_append(sb, "[]");
+      return pgmoneta_string_builder_finish(sb);
    }
    deque_read_lock(deque);
-   ret = pgmoneta_append(ret, "[\n");
+   pgmoneta_string_builder_append(sb, "[\n");
    cur = deque_next(deque, deque->start);
    while (cur != NULL)
    {
@@ -680,30 +685,34 @@ to_json_string(struct deque* deque, char* tag, int indent)
       }
       str = pgmoneta_value_to_string(cur->data, FORMAT_JSON, t, indent + INDENT_PER_LEVEL);
       free(t);
-      ret = pgmoneta_append(ret, str);
-      ret = pgmoneta_append(ret, has_next ? ",\n" : "\n");
+      pgmoneta_string_builder_append(sb, str);
+      pgmoneta_string_builder_append(sb, has_next ? ",\n" : "\n");
       free(str);
       cur = deque_next(deque, cur);
    }
-   ret = pgmoneta_indent(ret, NULL, indent);
-   ret = pgmoneta_append(ret, "]");
+   pgmoneta_string_builder_indent(sb, NULL, indent);
+   pgmoneta_string_builder_append(sb, "]");
    deque_unlock(deque);
-   return ret;
+   return pgmoneta_string_builder_finish(sb);
 }
 
 static char*
 to_compact_json_string(struct deque* deque, char* tag, int indent)
 {
-   char* ret = NULL;
-   ret = pgmoneta_indent(ret, tag, indent);
+   struct string_builder* sb = NULL;
+   if (pgmoneta_string_builder_create(0, &sb))
+   {
+      return NULL;
+   }
+   pgmoneta_string_builder_indent(sb, tag, indent);
    struct deque_node* cur = NULL;
    if (deque == NULL || pgmoneta_deque_empty(deque))
    {
-      ret = pgmoneta_append(ret, "[]");
-      return ret;
+      pgmoneta_string_builder_append(sb, "[]");
+      return pgmoneta_string_builder_finish(sb);
    }
    deque_read_lock(deque);
-   ret = pgmoneta_append(ret, "[");
+   pgmoneta_string_builder_append(sb, "[");
    cur = deque_next(deque, deque->start);
    while (cur != NULL)
    {
@@ -717,33 +726,37 @@ to_compact_json_string(struct deque* deque, char* tag, int indent)
       }
       str = pgmoneta_value_to_string(cur->data, FORMAT_JSON_COMPACT, t, indent);
       free(t);
-      ret = pgmoneta_append(ret, str);
-      ret = pgmoneta_append(ret, has_next ? "," : "");
+      pgmoneta_string_builder_append(sb, str);
+      pgmoneta_string_builder_append(sb, has_next ? "," : "");
       free(str);
       cur = deque_next(deque, cur);
    }
-   ret = pgmoneta_append(ret, "]");
+   pgmoneta_string_builder_append(sb, "]");
    deque_unlock(deque);
-   return ret;
+   return pgmoneta_string_builder_finish(sb);
 }
 
 static char*
 to_text_string(struct deque* deque, char* tag, int indent)
 {
-   char* ret = NULL;
    int cnt = 0;
    int next_indent = pgmoneta_compare_string(tag, BULLET_POINT) ? 0 : indent;
+   struct string_builder* sb = NULL;
+   if (pgmoneta_string_builder_create(0, &sb))
+   {
+      return NULL;
+   }
    // we have a tag and it's not the bullet point, so that means another line
    if (tag != NULL && !pgmoneta_compare_string(tag, BULLET_POINT))
    {
-      ret = pgmoneta_indent(ret, tag, indent);
+      pgmoneta_string_builder_indent(sb, tag, indent);
       next_indent += INDENT_PER_LEVEL;
    }
    struct deque_node* cur = NULL;
    if (deque == NULL || pgmoneta_deque_empty(deque))
    {
-      ret = pgmoneta_append(ret, "[]");
-      return ret;
+      pgmoneta_string_builder_append(sb, "[]");
+      return pgmoneta_string_builder_finish(sb);
    }
    deque_read_lock(deque);
    cur = deque_next(deque, deque->start);
@@ -762,15 +775,15 @@ to_text_string(struct deque* deque, char* tag, int indent)
       }
       if (cur->data->type == ValueJSON)
       {
-         ret = pgmoneta_indent(ret, BULLET_POINT, next_indent);
+         pgmoneta_string_builder_indent(sb, BULLET_POINT, next_indent);
       }
-      ret = pgmoneta_append(ret, str);
-      ret = pgmoneta_append(ret, has_next ? "\n" : "");
+      pgmoneta_string_builder_append(sb, str);
+      pgmoneta_string_builder_append(sb, has_next ? "\n" : "");
       free(str);
       cur = deque_next(deque, cur);
    }
    deque_unlock(deque);
-   return ret;
+   return pgmoneta_string_builder_finish(sb);
 }
 
 static struct deque_node*
@@ -31,6 +31,7 @@
 #include <gzip_compression.h>
 #include <logging.h>
 #include <management.h>
+#include <security.h>
 #include <utils.h>
 
 /* system */
@@ -865,10 +866,16 @@ static int
 gz_compress(char* from, int level, char* to)
 {
    char buf[BUFFER_LENGTH];
+   unsigned char out_buf[BUFFER_LENGTH];
    FILE* in = NULL;
-   char mode[4];
-   gzFile out = NULL;
+   FILE* out = NULL;
+   z_stream stream;
+   bool initialized = false;
+   struct file_hash* hash = NULL;
    size_t length;
+   size_t have;
+   int flush;
+   int ret;
 
    in = fopen(from, "rb");
    if (in == NULL)
@@ -876,17 +883,25 @@ gz_compress(char* from, int level, char* to)
       goto error;
    }
 
-   memset(&mode[0], 0, sizeof(mode));
-   mode[0] = 'w';
-   mode[1] = 'b';
-   mode[2] = '0' + level;
-
-   out = gzopen(to, mode);
+   out = fopen(to, "wb");
    if (out == NULL)
    {
       goto error;
    }
 
+   if (pgmoneta_file_hash_create(&hash))
+   {
+      goto error;
+   }
+
+   // write the gzip format, so the digest of the file can follow the written bytes
+   memset(&stream, 0, sizeof(stream));
+   if (deflateInit2(&stream, level, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+   {
+      goto error;
+   }
+   initialized = true;
+
    do
    {
       length = fread(buf, 1, sizeof(buf), in);
@@ -896,29 +911,61 @@ gz_compress(char* from, int level, char* to)
          goto error;
       }
 
-      if (length > 0)
+      flush = feof(in) ? Z_FINISH : Z_NO_FLUSH;
+      stream.next_in = (Bytef*)buf;
+      stream.avail_in = (uInt)length;
+
+      do
       {
-         if (gzwrite(out, buf, (unsigned)length) != (int)length)
+         stream.next_out = out_buf;
+         stream.avail_out = sizeof(out_buf);
+
+         ret = deflate(&stream, flush);
+         if (ret == Z_STREAM_ERROR)
          {
             goto error;
          }
+
+         have = sizeof(out_buf) - stream.avail_out;
+         if (have > 0)
+         {
+            if (fwrite(out_buf, 1, have, out) != have)
+            {
+               goto error;
+            }
+            pgmoneta_file_hash_update(hash, out_buf, have);
+         }
       }
+      while (stream.avail_out == 0);
    }
-   while (length > 0);
+   while (flush != Z_FINISH);
+
+   deflateEnd(&stream);
+   initialized = false;
 
    fclose(in);
    in = NULL;
 
-   if (gzclose(out) != Z_OK)
+   if (fclose(out) != 0)
    {
       out = NULL;
       goto error;
    }
+   out = NULL;
+
+   pgmoneta_file_hash_finish(hash, to);
+
+   pgmoneta_file_hash_destroy(hash);
 
    return 0;
 
 error:
 
+   if (initialized)
+   {
+      deflateEnd(&stream);
+   }
+
    if (in != NULL)
    {
       fclose(in);
@@ -926,9 +973,11 @@ error:
 
    if (out != NULL)
    {
-      gzclose(out);
+      fclose(out);
    }
 
+   pgmoneta_file_hash_destroy(hash);
+
    return 1;
 }
 
@@ -72,7 +72,7 @@ error:
 }
 
 int
-pgmoneta_http_set_request_option(CURL* handle, bool request_type)
+pgmoneta_http_set_request_option(CURL* handle, int request_type)
 {
    CURLcode res = -1;
 
@@ -89,6 +89,14 @@ pgmoneta_http_set_request_option(CURL* handle, bool request_type)
    {
       res = curl_easy_setopt(handle, CURLOPT_UPLOAD, 1L);
    }
+   else if (request_type == HTTP_POST)
+   {
+      res = curl_easy_setopt(handle, CURLOPT_POST, 1L);
+   }
+   else if (request_type == HTTP_DELETE)
+   {
+      res = curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+   }
 
    if (res != CURLE_OK)
    {
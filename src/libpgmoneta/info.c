@@ -29,24 +29,51 @@
 /* pgmoneta */
 #include <pgmoneta.h>
 #include <aes.h>
+#include <art.h>
 #include <compression.h>
 #include <info.h>
 #include <logging.h>
 #include <management.h>
 #include <network.h>
+#include <streamer.h>
 #include <utils.h>
+#include <value.h>
 
 /* system */
 #include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <libgen.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 
 #define NAME "info"
 #define INFO_BUFFER_SIZE 8192
 
+#define CATALOG_SUFFIX ".catalog"
+#define CATALOG_HEADER "PGMONETA_CATALOG 1\n"
+#define CATALOG_SLACK  64
+
+/** @struct catalog_index
+ * Defines the backups of a catalog, indexed by label
+ */
+struct catalog_index
+{
+   dev_t device;              /**< The device of the catalog */
+   ino_t inode;               /**< The inode of the catalog */
+   size_t size;               /**< The size of the catalog that is indexed */
+   int records;               /**< The number of records indexed */
+   char stamp[MISC_LENGTH];   /**< The last stamp of the catalog */
+   struct art* backups;       /**< The last record of each backup, by label */
+};
+
+/* The catalog indexes of this process, by backup directory */
+static struct art* catalog_indexes = NULL;
+
 static int
 file_final_name(char* file, int encryption, int compression, char** finalname);
 
@@ -62,193 +89,208 @@ file_final_name(char* file, int encryption, int compression, char** finalname);
 static int
 split_file_path(char* path, char** relative_path, char** bare_file_name);
 
-void
-pgmoneta_create_info(char* directory, char* label, int status)
-{
-   char buffer[INFO_BUFFER_SIZE];
-   char* s = NULL;
-   FILE* sfile = NULL;
-   struct main_configuration* config;
+/**
+ * Create an empty transaction
+ * @param directory The backup directory
+ * @param transaction [out] The transaction
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+create_transaction(char* directory, struct info_transaction** transaction);
 
-   config = (struct main_configuration*)shmem;
+/**
+ * Set a value in a transaction, keeping the position of an existing key
+ * @param transaction The transaction
+ * @param key The key
+ * @param value The value
+ */
+static void
+set_value(struct info_transaction* transaction, char* key, char* value);
 
-   s = pgmoneta_append(s, directory);
-   s = pgmoneta_append(s, "/backup.info");
+/**
+ * Parse the content of a backup information file
+ * @param file The file
+ * @param backup [out] The backup
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+read_info(FILE* file, struct backup** backup);
 
-   sfile = fopen(s, "w");
-   if (sfile == NULL)
-   {
-      pgmoneta_log_error("Could not open file %s due to %s", s, strerror(errno));
-      errno = 0;
-      goto error;
-   }
+/**
+ * Read the backup information file of every backup directory
+ * @param directory The directory holding the backups
+ * @param number_of_backups [out] The number of backups
+ * @param backups [out] The backups
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+scan_backups(char* directory, int* number_of_backups, struct backup*** backups);
 
-   memset(&buffer[0], 0, sizeof(buffer));
-   snprintf(&buffer[0], sizeof(buffer), "%s=%d\n", INFO_STATUS, status);
-   fputs(&buffer[0], sfile);
-   pgmoneta_log_trace("%s=%d", INFO_STATUS, status);
+/**
+ * Get the path of the catalog of a backup directory
+ * @param directory The directory holding the backups
+ * @return The path
+ */
+static char*
+catalog_path(char* directory);
 
-   memset(&buffer[0], 0, sizeof(buffer));
-   snprintf(&buffer[0], sizeof(buffer), "%s=%s\n", INFO_LABEL, label);
-   fputs(&buffer[0], sfile);
-   pgmoneta_log_trace("%s=%s", INFO_LABEL, label);
+/**
+ * Get the stamp of a backup directory. It changes when a backup
+ * directory is added or removed
+ * @param directory The directory holding the backups
+ * @param stamp The stamp
+ * @param size The size of the stamp
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+catalog_stamp(char* directory, char* stamp, size_t size);
 
-   memset(&buffer[0], 0, sizeof(buffer));
-   snprintf(&buffer[0], sizeof(buffer), "%s=0\n", INFO_TABLESPACES);
-   fputs(&buffer[0], sfile);
-   pgmoneta_log_trace("%s=0", INFO_TABLESPACES);
+/**
+ * Lock the catalog of a backup directory
+ * @param directory The directory holding the backups
+ * @param operation LOCK_SH or LOCK_EX
+ * @return The descriptor to close for unlocking, or -1
+ */
+static int
+catalog_lock(char* directory, int operation);
 
-   memset(&buffer[0], 0, sizeof(buffer));
-   snprintf(&buffer[0], sizeof(buffer), "%s=%s\n", INFO_PGMONETA_VERSION, VERSION);
-   fputs(&buffer[0], sfile);
-   pgmoneta_log_trace("%s=%s", INFO_PGMONETA_VERSION, VERSION);
+/**
+ * Get the index of a catalog. The index is kept for the life of the process,
+ * and only the records appended since the last call are parsed. It is only
+ * valid if the catalog ends with the current stamp of the backup directory
+ * @param directory The directory holding the backups
+ * @param catalog The path of the catalog
+ * @param stamp The current stamp
+ * @param index [out] The index
+ * @return 0 on success, 1 if the catalog is missing, damaged or stale
+ */
+static int
+catalog_index(char* directory, char* catalog, char* stamp, struct catalog_index** index);
 
-   memset(&buffer[0], 0, sizeof(buffer));
-   snprintf(&buffer[0], sizeof(buffer), "%s=\n", INFO_COMMENTS);
-   fputs(&buffer[0], sfile);
-   pgmoneta_log_trace("%s=", INFO_COMMENTS);
+static void
+catalog_index_destroy_cb(uintptr_t data);
 
-   memset(&buffer[0], 0, sizeof(buffer));
-   snprintf(&buffer[0], sizeof(buffer), "%s=%d\n", INFO_COMPRESSION, config->compression_type);
-   fputs(&buffer[0], sfile);
-   pgmoneta_log_trace("%s=%d", INFO_COMPRESSION, config->compression_type);
+/**
+ * Copy the backups of a catalog index
+ * @param index The index
+ * @param number_of_backups [out] The number of backups
+ * @param backups [out] The backups, in label order
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+catalog_copy(struct catalog_index* index, int* number_of_backups, struct backup*** backups);
 
-   memset(&buffer[0], 0, sizeof(buffer));
-   snprintf(&buffer[0], sizeof(buffer), "%s=%d\n", INFO_ENCRYPTION, config->encryption);
-   fputs(&buffer[0], sfile);
-   pgmoneta_log_trace("%s=%d", INFO_ENCRYPTION, config->encryption);
+/**
+ * Rebuild a catalog from the backup information files
+ * @param directory The directory holding the backups
+ * @param catalog The path of the catalog
+ * @param number_of_backups [out] The number of backups
+ * @param backups [out] The backups
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+catalog_build(char* directory, char* catalog, int* number_of_backups, struct backup*** backups);
 
-   pgmoneta_permission(s, 6, 0, 0);
+/**
+ * Append the backup information file of a backup to the catalog of its server
+ * @param directory The backup directory
+ */
+static void
+catalog_update(char* directory);
 
-   if (sfile != NULL)
-   {
-      fsync(fileno(sfile));
-      fclose(sfile);
-   }
+static int
+load_file(char* path, char** data, size_t* size);
 
-   free(s);
+static int
+backup_compare(const void* a, const void* b);
 
-   return;
+void
+pgmoneta_create_info(char* directory, char* label, int status)
+{
+   struct info_transaction* transaction = NULL;
 
-error:
+   if (!pgmoneta_info_begin_new(directory, label, status, &transaction))
+   {
+      pgmoneta_info_commit(transaction);
+   }
 
-   free(s);
+   pgmoneta_info_destroy(transaction);
 }
 
 void
 pgmoneta_update_info_unsigned_long(char* directory, char* key, unsigned long value)
 {
-   char buffer[INFO_BUFFER_SIZE];
-   char line[INFO_BUFFER_SIZE];
-   bool found = false;
-   char* s = NULL;
-   FILE* sfile = NULL;
-   char* d = NULL;
-   FILE* dfile = NULL;
-
-   s = pgmoneta_append(s, directory);
-   s = pgmoneta_append(s, "/backup.info");
-
-   d = pgmoneta_append(d, directory);
-   d = pgmoneta_append(d, "/backup.info.tmp");
+   struct info_transaction* transaction = NULL;
 
-   sfile = fopen(s, "r");
-   if (sfile == NULL)
-   {
-      pgmoneta_log_error("Could not open file %s due to %s", s, strerror(errno));
-      errno = 0;
-      goto error;
-   }
-   dfile = fopen(d, "w");
-   if (dfile == NULL)
+   if (!pgmoneta_info_begin(directory, &transaction))
    {
-      pgmoneta_log_error("Could not open file %s due to %s", d, strerror(errno));
-      errno = 0;
-      goto error;
+      pgmoneta_info_set_unsigned_long(transaction, key, value);
+      pgmoneta_info_commit(transaction);
    }
 
-   while ((fgets(&buffer[0], sizeof(buffer), sfile)) != NULL)
-   {
-      char k[INFO_BUFFER_SIZE];
-      char v[INFO_BUFFER_SIZE];
-      char* ptr = NULL;
-
-      memset(&k[0], 0, sizeof(k));
-      memset(&v[0], 0, sizeof(v));
-
-      memset(&line[0], 0, sizeof(line));
-      memcpy(&line[0], &buffer[0], strlen(&buffer[0]));
-
-      ptr = strtok(&buffer[0], "=");
-      memcpy(&k[0], ptr, strlen(ptr));
-
-      ptr = strtok(NULL, "=");
-      memcpy(&v[0], ptr, strlen(ptr) - 1);
+   pgmoneta_info_destroy(transaction);
+}
 
-      if (!strcmp(key, &k[0]))
-      {
-         memset(&line[0], 0, sizeof(line));
-         snprintf(&line[0], sizeof(line), "%s=%lu\n", key, value);
-         fputs(&line[0], dfile);
-         found = true;
-      }
-      else
-      {
-         fputs(&line[0], dfile);
-      }
-   }
+void
+pgmoneta_update_info_double(char* directory, char* key, double value)
+{
+   struct info_transaction* transaction = NULL;
 
-   if (!found)
+   if (!pgmoneta_info_begin(directory, &transaction))
    {
-      memset(&line[0], 0, sizeof(line));
-      pgmoneta_log_trace("%s=%lu", key, value);
-      snprintf(&line[0], sizeof(line), "%s=%lu\n", key, value);
-      fputs(&line[0], dfile);
+      pgmoneta_info_set_double(transaction, key, value);
+      pgmoneta_info_commit(transaction);
    }
 
-   if (sfile != NULL)
-   {
-      fsync(fileno(sfile));
-      fclose(sfile);
-   }
+   pgmoneta_info_destroy(transaction);
+}
+
+void
+pgmoneta_update_info_string(char* directory, char* key, char* value)
+{
+   struct info_transaction* transaction = NULL;
 
-   if (dfile != NULL)
+   if (!pgmoneta_info_begin(directory, &transaction))
    {
-      fsync(fileno(dfile));
-      fclose(dfile);
+      pgmoneta_info_set_string(transaction, key, value);
+      pgmoneta_info_commit(transaction);
    }
 
-   pgmoneta_move_file(d, s);
-   pgmoneta_permission(s, 6, 0, 0);
-
-   free(s);
-   free(d);
+   pgmoneta_info_destroy(transaction);
+}
 
-   return;
+void
+pgmoneta_update_info_bool(char* directory, char* key, bool value)
+{
+   struct info_transaction* transaction = NULL;
 
-error:
+   if (!pgmoneta_info_begin(directory, &transaction))
+   {
+      pgmoneta_info_set_bool(transaction, key, value);
+      pgmoneta_info_commit(transaction);
+   }
 
-   free(s);
-   free(d);
+   pgmoneta_info_destroy(transaction);
 }
 
-void
-pgmoneta_update_info_double(char* directory, char* key, double value)
+int
+pgmoneta_info_begin(char* directory, struct info_transaction** transaction)
 {
    char buffer[INFO_BUFFER_SIZE];
-   char line[INFO_BUFFER_SIZE];
-   bool found = false;
    char* s = NULL;
    FILE* sfile = NULL;
-   char* d = NULL;
-   FILE* dfile = NULL;
+   struct info_transaction* t = NULL;
+
+   *transaction = NULL;
+
+   if (create_transaction(directory, &t))
+   {
+      goto error;
+   }
 
    s = pgmoneta_append(s, directory);
    s = pgmoneta_append(s, "/backup.info");
 
-   d = pgmoneta_append(d, directory);
-   d = pgmoneta_append(d, "/backup.info.tmp");
-
    sfile = fopen(s, "r");
    if (sfile == NULL)
    {
@@ -256,195 +298,221 @@ pgmoneta_update_info_double(char* directory, char* key, double value)
       errno = 0;
       goto error;
    }
-   dfile = fopen(d, "w");
-   if (dfile == NULL)
-   {
-      pgmoneta_log_error("Could not open file %s due to %s", d, strerror(errno));
-      errno = 0;
-      goto error;
-   }
 
    while ((fgets(&buffer[0], sizeof(buffer), sfile)) != NULL)
    {
-      char k[INFO_BUFFER_SIZE];
-      char v[INFO_BUFFER_SIZE];
-      char* ptr = NULL;
-
-      memset(&k[0], 0, sizeof(k));
-      memset(&v[0], 0, sizeof(v));
-
-      memset(&line[0], 0, sizeof(line));
-      memcpy(&line[0], &buffer[0], strlen(&buffer[0]));
+      char* value = NULL;
 
-      ptr = strtok(&buffer[0], "=");
-      memcpy(&k[0], ptr, strlen(ptr));
+      buffer[strcspn(&buffer[0], "\n")] = '\0';
 
-      ptr = strtok(NULL, "=");
-      memcpy(&v[0], ptr, strlen(ptr) - 1);
-
-      if (!strcmp(key, &k[0]))
+      value = strchr(&buffer[0], '=');
+      if (value == NULL)
       {
-         memset(&line[0], 0, sizeof(line));
-         snprintf(&line[0], sizeof(line), "%s=%.4f\n", key, value);
-         fputs(&line[0], dfile);
-         found = true;
+         continue;
       }
-      else
+
+      *value = '\0';
+      value++;
+
+      if (pgmoneta_deque_add(t->entries, &buffer[0], (uintptr_t)value, ValueString))
       {
-         fputs(&line[0], dfile);
+         goto error;
       }
    }
 
-   if (!found)
-   {
-      memset(&line[0], 0, sizeof(line));
-      pgmoneta_log_trace("%s=%.4f", key, value);
-      snprintf(&line[0], sizeof(line), "%s=%.4f\n", key, value);
-      fputs(&line[0], dfile);
-   }
+   fclose(sfile);
+   free(s);
+
+   *transaction = t;
+
+   return 0;
+
+error:
 
    if (sfile != NULL)
    {
-      fsync(fileno(sfile));
       fclose(sfile);
    }
 
-   if (dfile != NULL)
+   free(s);
+   pgmoneta_info_destroy(t);
+
+   return 1;
+}
+
+int
+pgmoneta_info_begin_new(char* directory, char* label, int status, struct info_transaction** transaction)
+{
+   struct info_transaction* t = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   *transaction = NULL;
+
+   if (create_transaction(directory, &t))
    {
-      fsync(fileno(dfile));
-      fclose(dfile);
+      return 1;
    }
 
-   pgmoneta_move_file(d, s);
-   pgmoneta_permission(s, 6, 0, 0);
+   pgmoneta_info_set_unsigned_long(t, INFO_STATUS, status);
+   pgmoneta_info_set_string(t, INFO_LABEL, label);
+   pgmoneta_info_set_unsigned_long(t, INFO_TABLESPACES, 0);
+   pgmoneta_info_set_string(t, INFO_PGMONETA_VERSION, VERSION);
+   pgmoneta_info_set_string(t, INFO_COMMENTS, NULL);
+   pgmoneta_info_set_unsigned_long(t, INFO_COMPRESSION, config->compression_type);
+   pgmoneta_info_set_unsigned_long(t, INFO_ENCRYPTION, config->encryption);
 
-   free(s);
-   free(d);
+   *transaction = t;
 
-   return;
+   return 0;
+}
 
-error:
+void
+pgmoneta_info_set_unsigned_long(struct info_transaction* transaction, char* key, unsigned long value)
+{
+   char v[MISC_LENGTH];
 
-   free(s);
-   free(d);
+   memset(&v[0], 0, sizeof(v));
+   snprintf(&v[0], sizeof(v), "%lu", value);
+
+   set_value(transaction, key, &v[0]);
 }
 
 void
-pgmoneta_update_info_string(char* directory, char* key, char* value)
+pgmoneta_info_set_double(struct info_transaction* transaction, char* key, double value)
+{
+   char v[MISC_LENGTH];
+
+   memset(&v[0], 0, sizeof(v));
+   snprintf(&v[0], sizeof(v), "%.4f", value);
+
+   set_value(transaction, key, &v[0]);
+}
+
+void
+pgmoneta_info_set_string(struct info_transaction* transaction, char* key, char* value)
+{
+   set_value(transaction, key, value != NULL ? value : "");
+}
+
+void
+pgmoneta_info_set_bool(struct info_transaction* transaction, char* key, bool value)
+{
+   set_value(transaction, key, value ? "1" : "0");
+}
+
+int
+pgmoneta_info_commit(struct info_transaction* transaction)
 {
-   char buffer[INFO_BUFFER_SIZE];
-   char line[INFO_BUFFER_SIZE];
-   bool found = false;
    char* s = NULL;
-   FILE* sfile = NULL;
    char* d = NULL;
-   FILE* dfile = NULL;
+   char* content = NULL;
+   size_t length = 0;
+   int fd = -1;
+   struct deque_iterator* iter = NULL;
 
-   s = pgmoneta_append(s, directory);
+   if (transaction == NULL)
+   {
+      goto error;
+   }
+
+   s = pgmoneta_append(s, transaction->directory);
    s = pgmoneta_append(s, "/backup.info");
 
-   d = pgmoneta_append(d, directory);
+   d = pgmoneta_append(d, transaction->directory);
    d = pgmoneta_append(d, "/backup.info.tmp");
 
-   sfile = fopen(s, "r");
-   if (sfile == NULL)
+   if (pgmoneta_deque_iterator_create(transaction->entries, &iter))
    {
-      pgmoneta_log_error("Could not open file %s due to %s", s, strerror(errno));
-      errno = 0;
       goto error;
    }
-   dfile = fopen(d, "w");
-   if (dfile == NULL)
+
+   while (pgmoneta_deque_iterator_next(iter))
+   {
+      content = pgmoneta_append(content, iter->tag);
+      content = pgmoneta_append_char(content, '=');
+      content = pgmoneta_append(content, (char*)pgmoneta_value_data(iter->value));
+      content = pgmoneta_append_char(content, '\n');
+   }
+
+   pgmoneta_deque_iterator_destroy(iter);
+   iter = NULL;
+
+   fd = open(d, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+   if (fd == -1)
    {
       pgmoneta_log_error("Could not open file %s due to %s", d, strerror(errno));
       errno = 0;
       goto error;
    }
 
-   while ((fgets(&buffer[0], sizeof(buffer), sfile)) != NULL)
+   length = content != NULL ? strlen(content) : 0;
+   for (size_t written = 0; written < length;)
    {
-      char k[INFO_BUFFER_SIZE];
-      char v[INFO_BUFFER_SIZE];
-      char* ptr = NULL;
+      ssize_t w = write(fd, content + written, length - written);
 
-      memset(&k[0], 0, sizeof(k));
-      memset(&v[0], 0, sizeof(v));
-
-      memset(&line[0], 0, sizeof(line));
-      memcpy(&line[0], &buffer[0], strlen(&buffer[0]));
-
-      ptr = strtok(&buffer[0], "=");
-      memcpy(&k[0], ptr, strlen(ptr));
-
-      ptr = strtok(NULL, "=");
-      memcpy(&v[0], ptr, strlen(ptr) - 1);
-
-      if (!strcmp(key, &k[0]))
-      {
-         memset(&line[0], 0, sizeof(line));
-         if (value == NULL)
-         {
-            snprintf(&line[0], sizeof(line), "%s=\n", key);
-         }
-         else
-         {
-            snprintf(&line[0], sizeof(line), "%s=%s\n", key, value);
-         }
-         fputs(&line[0], dfile);
-         found = true;
-      }
-      else
+      if (w <= 0)
       {
-         fputs(&line[0], dfile);
+         pgmoneta_log_error("Could not write file %s due to %s", d, strerror(errno));
+         errno = 0;
+         goto error;
       }
-   }
 
-   if (!found)
-   {
-      memset(&line[0], 0, sizeof(line));
-      pgmoneta_log_trace("%s=%s", key, value);
-      if (value == NULL)
-      {
-         snprintf(&line[0], sizeof(line), "%s=\n", key);
-      }
-      else
-      {
-         snprintf(&line[0], sizeof(line), "%s=%s\n", key, value);
-      }
-      fputs(&line[0], dfile);
+      written += w;
    }
 
-   if (sfile != NULL)
+   if (fsync(fd) != 0)
    {
-      fsync(fileno(sfile));
-      fclose(sfile);
+      pgmoneta_log_error("Could not sync file %s due to %s", d, strerror(errno));
+      errno = 0;
+      goto error;
    }
 
-   if (dfile != NULL)
+   close(fd);
+   fd = -1;
+
+   if (pgmoneta_move_file(d, s))
    {
-      fsync(fileno(dfile));
-      fclose(dfile);
+      goto error;
    }
 
-   pgmoneta_move_file(d, s);
    pgmoneta_permission(s, 6, 0, 0);
 
+   catalog_update(transaction->directory);
+
    free(s);
    free(d);
+   free(content);
 
-   return;
+   return 0;
 
 error:
 
-   free(s);
+   if (fd != -1)
+   {
+      close(fd);
+      unlink(d);
+   }
+
+   pgmoneta_deque_iterator_destroy(iter);
+   free(s);
    free(d);
+   free(content);
+
+   return 1;
 }
 
 void
-pgmoneta_update_info_bool(char* directory, char* key, bool value)
+pgmoneta_info_destroy(struct info_transaction* transaction)
 {
-   pgmoneta_log_trace("%s=%d", key, value ? 1 : 0);
-   pgmoneta_update_info_unsigned_long(directory, key, value ? 1 : 0);
+   if (transaction == NULL)
+   {
+      return;
+   }
+
+   pgmoneta_deque_destroy(transaction->entries);
+   free(transaction);
 }
 
 int
@@ -748,64 +816,66 @@ error:
 int
 pgmoneta_get_backups(char* directory, int* number_of_backups, struct backup*** backups)
 {
-   char* d = NULL;
-   struct backup** bcks = NULL;
-   int number_of_directories;
-   char** dirs;
+   char stamp[MISC_LENGTH];
+   char* catalog = NULL;
+   int lock = -1;
+   struct catalog_index* index = NULL;
 
    *number_of_backups = 0;
    *backups = NULL;
 
-   number_of_directories = 0;
-   dirs = NULL;
+   lock = catalog_lock(directory, LOCK_SH);
+   if (lock == -1)
+   {
+      return scan_backups(directory, number_of_backups, backups);
+   }
 
-   pgmoneta_get_directories(directory, &number_of_directories, &dirs);
+   catalog = catalog_path(directory);
 
-   bcks = (struct backup**)malloc(number_of_directories * sizeof(struct backup*));
+   if (!catalog_stamp(directory, &stamp[0], sizeof(stamp)) &&
+       !catalog_index(directory, catalog, &stamp[0], &index))
+   {
+      goto copy;
+   }
 
-   if (bcks == NULL)
+   if (flock(lock, LOCK_EX) != 0)
    {
+      errno = 0;
       goto error;
    }
 
-   memset(bcks, 0, number_of_directories * sizeof(struct backup*));
+   /* Another process may have rebuilt the catalog while we waited */
+   if (!catalog_stamp(directory, &stamp[0], sizeof(stamp)) &&
+       !catalog_index(directory, catalog, &stamp[0], &index))
+   {
+      goto copy;
+   }
 
-   for (int i = 0; i < number_of_directories; i++)
+   if (catalog_build(directory, catalog, number_of_backups, backups))
    {
-      d = pgmoneta_append(d, directory);
+      goto error;
+   }
 
-      if (pgmoneta_get_backup(d, dirs[i], &bcks[i]))
-      {
-         goto error;
-      }
+   goto done;
 
-      free(d);
-      d = NULL;
-   }
+copy:
 
-   for (int i = 0; i < number_of_directories; i++)
+   if (catalog_copy(index, number_of_backups, backups))
    {
-      free(dirs[i]);
+      goto error;
    }
-   free(dirs);
 
-   *number_of_backups = number_of_directories;
-   *backups = bcks;
+done:
+
+   close(lock);
+   free(catalog);
 
    return 0;
 
 error:
 
-   free(d);
-
-   if (dirs != NULL)
-   {
-      for (int i = 0; i < number_of_directories; i++)
-      {
-         free(dirs[i]);
-      }
-      free(dirs);
-   }
+   close(lock);
+   free(catalog);
 
    return 1;
 }
@@ -813,11 +883,41 @@ error:
 int
 pgmoneta_get_backup(char* directory, char* label, struct backup** backup)
 {
+   char stamp[MISC_LENGTH];
+   char* catalog = NULL;
    char* fn = NULL;
+   int lock = -1;
    int ret = 0;
+   struct backup* bck = NULL;
+   struct catalog_index* index = NULL;
 
    *backup = NULL;
 
+   lock = catalog_lock(directory, LOCK_SH);
+   if (lock != -1)
+   {
+      catalog = catalog_path(directory);
+
+      if (!catalog_stamp(directory, &stamp[0], sizeof(stamp)) &&
+          !catalog_index(directory, catalog, &stamp[0], &index) &&
+          (bck = (struct backup*)pgmoneta_art_search(index->backups, label)) != NULL)
+      {
+         *backup = (struct backup*)malloc(sizeof(struct backup));
+         if (*backup != NULL)
+         {
+            memcpy(*backup, bck, sizeof(struct backup));
+         }
+      }
+
+      close(lock);
+      free(catalog);
+
+      if (*backup != NULL)
+      {
+         return 0;
+      }
+   }
+
    fn = NULL;
    fn = pgmoneta_append(fn, directory);
    fn = pgmoneta_append(fn, "/");
@@ -836,8 +936,6 @@ pgmoneta_get_backup_server(int server, char* identifier, struct backup** backup)
 {
    char* d = NULL;
    char* id = NULL;
-   char* root = NULL;
-   char* base = NULL;
    int number_of_backups = 0;
    struct backup** backups = NULL;
    struct backup* bck = NULL;
@@ -904,13 +1002,14 @@ pgmoneta_get_backup_server(int server, char* identifier, struct backup** backup)
       goto error;
    }
 
-   root = pgmoneta_get_server_backup(server);
-   base = pgmoneta_get_server_backup_identifier(server, id);
-
-   if (pgmoneta_get_backup(root, id, &bck))
+   /* Hand over the backup instead of reading its information again */
+   for (int i = 0; bck == NULL && i < number_of_backups; i++)
    {
-      pgmoneta_log_error("Unable to get backup for %s/%s", config->common.servers[server].name, id);
-      goto error;
+      if (backups[i]->label == id)
+      {
+         bck = backups[i];
+         backups[i] = NULL;
+      }
    }
 
    *backup = bck;
@@ -921,8 +1020,6 @@ pgmoneta_get_backup_server(int server, char* identifier, struct backup** backup)
    }
    free(backups);
 
-   free(root);
-   free(base);
    free(d);
 
    return 0;
@@ -935,8 +1032,6 @@ error:
    }
    free(backups);
 
-   free(root);
-   free(base);
    free(d);
 
    return 1;
@@ -945,10 +1040,7 @@ error:
 int
 pgmoneta_get_backup_file(char* fn, struct backup** backup)
 {
-   char buffer[INFO_BUFFER_SIZE];
    FILE* file = NULL;
-   int tbl_idx = 0;
-   struct backup* bck = NULL;
 
    *backup = NULL;
 
@@ -960,288 +1052,74 @@ pgmoneta_get_backup_file(char* fn, struct backup** backup)
       goto error;
    }
 
-   bck = (struct backup*)malloc(sizeof(struct backup));
-
-   if (bck == NULL)
+   if (read_info(file, backup))
    {
       goto error;
    }
 
-   memset(bck, 0, sizeof(struct backup));
-   bck->valid = VALID_UNKNOWN;
-   bck->basebackup_elapsed_time = 0;
-   bck->manifest_elapsed_time = 0;
-   bck->compression_zstd_elapsed_time = 0;
-   bck->compression_bzip2_elapsed_time = 0;
-   bck->compression_lz4_elapsed_time = 0;
-   bck->compression_gzip_elapsed_time = 0;
-   bck->encryption_elapsed_time = 0;
-   bck->linking_elapsed_time = 0;
-   bck->remote_ssh_elapsed_time = 0;
-   bck->remote_azure_elapsed_time = 0;
-   bck->remote_s3_elapsed_time = 0;
+   fclose(file);
+
+   return 0;
+
+error:
 
    if (file != NULL)
    {
-      while ((fgets(&buffer[0], sizeof(buffer), file)) != NULL)
+      fclose(file);
+   }
+
+   return 1;
+}
+
+int
+pgmoneta_get_number_of_valid_backups(int server)
+{
+   char* server_path = NULL;
+   int number_of_backups = 0;
+   struct backup** backups = NULL;
+   int result = 0;
+
+   server_path = pgmoneta_get_server_backup(server);
+   if (server_path == NULL)
+   {
+      goto error;
+   }
+
+   if (pgmoneta_get_backups(server_path, &number_of_backups, &backups))
+   {
+      goto error;
+   }
+
+   for (int i = 0; i < number_of_backups; i++)
+   {
+      if (backups[i] != NULL && backups[i]->valid)
       {
-         char key[INFO_BUFFER_SIZE];
-         char value[INFO_BUFFER_SIZE];
-         char* ptr = NULL;
+         result++;
+      }
+   }
 
-         memset(&key[0], 0, sizeof(key));
-         memset(&value[0], 0, sizeof(value));
+   for (int i = 0; i < number_of_backups; i++)
+   {
+      free(backups[i]);
+   }
+   free(backups);
 
-         ptr = strtok(&buffer[0], "=");
+   free(server_path);
 
-         if (ptr == NULL)
-         {
-            goto error;
-         }
+   return result;
 
-         memcpy(&key[0], ptr, strlen(ptr));
+error:
 
-         ptr = strtok(NULL, "=");
+   return 0;
+}
 
-         if (ptr == NULL)
-         {
-            goto error;
-         }
+int
+pgmoneta_get_backup_parent(int server, struct backup* backup, struct backup** parent)
+{
+   char* d = NULL;
+   struct backup* p = NULL;
 
-         memcpy(&value[0], ptr, strlen(ptr) - 1);
-
-         if (!strcmp(INFO_STATUS, &key[0]))
-         {
-            if (!strcmp("1", &value[0]))
-            {
-               bck->valid = VALID_TRUE;
-            }
-            else
-            {
-               bck->valid = VALID_FALSE;
-            }
-         }
-         else if (!strcmp(INFO_LABEL, &key[0]))
-         {
-            memcpy(&bck->label[0], &value[0], strlen(&value[0]));
-         }
-         else if (!strcmp(INFO_WAL, &key[0]))
-         {
-            memcpy(&bck->wal[0], &value[0], strlen(&value[0]));
-         }
-         else if (!strcmp(INFO_BACKUP, &key[0]))
-         {
-            bck->backup_size = strtoul(&value[0], &ptr, 10);
-         }
-         else if (!strcmp(INFO_RESTORE, &key[0]))
-         {
-            bck->restore_size = strtoul(&value[0], &ptr, 10);
-         }
-         else if (!strcmp(INFO_BIGGEST_FILE, &key[0]))
-         {
-            bck->biggest_file_size = strtoul(&value[0], &ptr, 10);
-         }
-         else if (!strcmp(INFO_ELAPSED, &key[0]))
-         {
-            bck->total_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_BASEBACKUP_ELAPSED, &key[0]))
-         {
-            bck->basebackup_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_MANIFEST_ELAPSED, &key[0]))
-         {
-            bck->manifest_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_COMPRESSION_ZSTD_ELAPSED, &key[0]))
-         {
-            bck->compression_zstd_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_COMPRESSION_BZIP2_ELAPSED, &key[0]))
-         {
-            bck->compression_bzip2_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_COMPRESSION_GZIP_ELAPSED, &key[0]))
-         {
-            bck->compression_gzip_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_COMPRESSION_LZ4_ELAPSED, &key[0]))
-         {
-            bck->compression_lz4_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_ENCRYPTION_ELAPSED, &key[0]))
-         {
-            bck->encryption_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_LINKING_ELAPSED, &key[0]))
-         {
-            bck->linking_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_REMOTE_SSH_ELAPSED, &key[0]))
-         {
-            bck->remote_ssh_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_REMOTE_AZURE_ELAPSED, &key[0]))
-         {
-            bck->remote_azure_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_REMOTE_S3_ELAPSED, &key[0]))
-         {
-            bck->remote_s3_elapsed_time = atof(&value[0]);
-         }
-         else if (!strcmp(INFO_MAJOR_VERSION, &key[0]))
-         {
-            bck->major_version = atoi(&value[0]);
-         }
-         else if (!strcmp(INFO_MINOR_VERSION, &key[0]))
-         {
-            bck->minor_version = atoi(&value[0]);
-         }
-         else if (!strcmp(INFO_KEEP, &key[0]))
-         {
-            bck->keep = atoi(&value[0]) == 1 ? true : false;
-         }
-         else if (!strcmp(INFO_TABLESPACES, &key[0]))
-         {
-            bck->number_of_tablespaces = strtoul(&value[0], &ptr, 10);
-         }
-         else if (pgmoneta_starts_with(&key[0], "TABLESPACE_OID"))
-         {
-            memcpy(&bck->tablespaces_oids[tbl_idx], &value[0], strlen(&value[0]));
-         }
-         else if (pgmoneta_starts_with(&key[0], "TABLESPACE_PATH"))
-         {
-            memcpy(&bck->tablespaces_paths[tbl_idx], &value[0], strlen(&value[0]));
-            /* This one is last */
-            tbl_idx++;
-         }
-         else if (pgmoneta_starts_with(&key[0], "TABLESPACE"))
-         {
-            memcpy(&bck->tablespaces[tbl_idx], &value[0], strlen(&value[0]));
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_START_WALPOS))
-         {
-            sscanf(&value[0], "%X/%X", &bck->start_lsn_hi32, &bck->start_lsn_lo32);
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_END_WALPOS))
-         {
-            sscanf(&value[0], "%X/%X", &bck->end_lsn_hi32, &bck->end_lsn_lo32);
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_CHKPT_WALPOS))
-         {
-            sscanf(&value[0], "%X/%X", &bck->checkpoint_lsn_hi32, &bck->checkpoint_lsn_lo32);
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_START_TIMELINE))
-         {
-            bck->start_timeline = atoi(&value[0]);
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_END_TIMELINE))
-         {
-            bck->end_timeline = atoi(&value[0]);
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_HASH_ALGORITHM))
-         {
-            bck->hash_algorithm = atoi(&value[0]);
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_COMMENTS))
-         {
-            memcpy(&bck->comments[0], &value[0], strlen(&value[0]));
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_EXTRA))
-         {
-            memcpy(&bck->comments[0], &value[0], strlen(&value[0]));
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_COMPRESSION))
-         {
-            bck->compression = atoi(&value[0]);
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_ENCRYPTION))
-         {
-            bck->encryption = atoi(&value[0]);
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_TYPE))
-         {
-            bck->type = atoi(&value[0]);
-         }
-         else if (pgmoneta_starts_with(&key[0], INFO_PARENT))
-         {
-            memcpy(&bck->parent_label[0], &value[0], strlen(&value[0]));
-         }
-      }
-   }
-
-   *backup = bck;
-
-   if (file != NULL)
-   {
-      fsync(fileno(file));
-      fclose(file);
-   }
-
-   return 0;
-
-error:
-
-   free(bck);
-
-   if (file != NULL)
-   {
-      fsync(fileno(file));
-      fclose(file);
-   }
-
-   return 1;
-}
-
-int
-pgmoneta_get_number_of_valid_backups(int server)
-{
-   char* server_path = NULL;
-   int number_of_backups = 0;
-   struct backup** backups = NULL;
-   int result = 0;
-
-   server_path = pgmoneta_get_server_backup(server);
-   if (server_path == NULL)
-   {
-      goto error;
-   }
-
-   if (pgmoneta_get_backups(server_path, &number_of_backups, &backups))
-   {
-      goto error;
-   }
-
-   for (int i = 0; i < number_of_backups; i++)
-   {
-      if (backups[i] != NULL && backups[i]->valid)
-      {
-         result++;
-      }
-   }
-
-   for (int i = 0; i < number_of_backups; i++)
-   {
-      free(backups[i]);
-   }
-   free(backups);
-
-   free(server_path);
-
-   return result;
-
-error:
-
-   return 0;
-}
-
-int
-pgmoneta_get_backup_parent(int server, struct backup* backup, struct backup** parent)
-{
-   char* d = NULL;
-   struct backup* p = NULL;
-
-   *parent = NULL;
+   *parent = NULL;
 
    if (backup == NULL)
    {
@@ -1780,10 +1658,10 @@ int
 pgmoneta_rfile_create(int server, char* label, char* relative_dir, char* base_file_name, int encryption, int compression, struct rfile** rfile)
 {
    struct rfile* rf = NULL;
-   char* extracted_file_path = NULL;
+   char* backup_dir = NULL;
+   char* file_path = NULL;
    char* final_relative_path = NULL;
    char base_relative_path[MAX_PATH];
-   FILE* fp = NULL;
 
    memset(base_relative_path, 0, MAX_PATH);
    if (pgmoneta_ends_with(relative_dir, "/"))
@@ -1795,35 +1673,61 @@ pgmoneta_rfile_create(int server, char* label, char* relative_dir, char* base_fi
       snprintf(base_relative_path, MAX_PATH, "%s/%s", relative_dir, base_file_name);
    }
 
+   backup_dir = pgmoneta_get_server_backup_identifier_data(server, label);
+   if (!pgmoneta_ends_with(backup_dir, "/"))
+   {
+      backup_dir = pgmoneta_append_char(backup_dir, '/');
+   }
+
    // try both base and final relative path
-   if (pgmoneta_extract_backup_file(server, label, base_relative_path, NULL, &extracted_file_path))
+   file_path = pgmoneta_append(file_path, backup_dir);
+   file_path = pgmoneta_append(file_path, base_relative_path);
+   if (!pgmoneta_exists(file_path))
    {
-      free(extracted_file_path);
-      extracted_file_path = NULL;
+      free(file_path);
+      file_path = NULL;
+
       file_final_name(base_relative_path, encryption, compression, &final_relative_path);
-      if (pgmoneta_extract_backup_file(server, label, final_relative_path, NULL, &extracted_file_path))
+      file_path = pgmoneta_append(file_path, backup_dir);
+      file_path = pgmoneta_append(file_path, final_relative_path);
+      if (!pgmoneta_exists(file_path))
       {
          goto error;
       }
    }
-   fp = fopen(extracted_file_path, "r");
 
-   if (fp == NULL)
-   {
-      goto error;
-   }
    rf = (struct rfile*) malloc(sizeof(struct rfile));
    memset(rf, 0, sizeof(struct rfile));
 
-   rf->fp = fp;
-   rf->filepath = extracted_file_path;
+   rf->filepath = file_path;
+   file_path = NULL;
+
+   // compressed and encrypted files are decoded in memory instead of being extracted to the workspace
+   if (pgmoneta_is_encrypted(rf->filepath) || pgmoneta_is_compressed(rf->filepath))
+   {
+      if (pgmoneta_stream_reader_create(rf->filepath, &rf->reader))
+      {
+         goto error;
+      }
+   }
+   else
+   {
+      rf->fp = fopen(rf->filepath, "r");
+      if (rf->fp == NULL)
+      {
+         goto error;
+      }
+   }
+
    *rfile = rf;
 
+   free(backup_dir);
    free(final_relative_path);
    return 0;
 
 error:
-   free(extracted_file_path);
+   free(backup_dir);
+   free(file_path);
    free(final_relative_path);
    pgmoneta_rfile_destroy(rf);
    return 1;
@@ -1840,22 +1744,68 @@ pgmoneta_rfile_destroy(struct rfile* rf)
    {
       fclose(rf->fp);
    }
-   if (rf->filepath != NULL)
-   {
-      // this is the extracted file, we should delete it
-      pgmoneta_delete_file(rf->filepath, NULL);
-   }
+
+   pgmoneta_stream_reader_destroy(rf->reader);
 
    free(rf->filepath);
    free(rf->relative_block_numbers);
    free(rf);
 }
 
+int
+pgmoneta_rfile_read(struct rfile* rf, off_t offset, size_t length, void* buffer, size_t* nread)
+{
+   ssize_t n = 0;
+   size_t total = 0;
+   int fd = -1;
+
+   *nread = 0;
+
+   if (rf->reader != NULL)
+   {
+      if (pgmoneta_stream_reader_seek(rf->reader, (uint64_t)offset))
+      {
+         goto error;
+      }
+
+      return pgmoneta_stream_reader_read(rf->reader, buffer, length, nread);
+   }
+
+   fd = fileno(rf->fp);
+   while (total < length)
+   {
+      n = pread(fd, (char*)buffer + total, length - total, offset + total);
+      if (n < 0 && errno == EINTR)
+      {
+         errno = 0;
+         continue;
+      }
+      if (n < 0)
+      {
+         errno = 0;
+         goto error;
+      }
+      if (n == 0)
+      {
+         break;
+      }
+      total += n;
+   }
+
+   *nread = total;
+
+   return 0;
+
+error:
+   return 1;
+}
+
 int
 pgmoneta_incremental_rfile_initialize(int server, char* label, char* relative_dir, char* base_file_name, int encryption, int compression, struct rfile** rfile)
 {
    uint32_t magic = 0;
-   int nread = 0;
+   size_t nread = 0;
+   off_t offset = 0;
    struct rfile* rf = NULL;
    struct main_configuration* config;
    size_t relsegsz = 0;
@@ -1882,12 +1832,12 @@ pgmoneta_incremental_rfile_initialize(int server, char* label, char* relative_di
    }
 
    // read magic number from header
-   nread = fread(&magic, 1, sizeof(uint32_t), rf->fp);
-   if (nread != sizeof(uint32_t))
+   if (pgmoneta_rfile_read(rf, offset, sizeof(uint32_t), &magic, &nread) || nread != sizeof(uint32_t))
    {
       pgmoneta_log_error("rfile initialize: incomplete file header at %s, cannot read magic number", rf->filepath);
       goto error;
    }
+   offset += nread;
 
    if (magic != INCREMENTAL_MAGIC)
    {
@@ -1896,12 +1846,12 @@ pgmoneta_incremental_rfile_initialize(int server, char* label, char* relative_di
    }
 
    // read number of blocks
-   nread = fread(&rf->num_blocks, 1, sizeof(uint32_t), rf->fp);
-   if (nread != sizeof(uint32_t))
+   if (pgmoneta_rfile_read(rf, offset, sizeof(uint32_t), &rf->num_blocks, &nread) || nread != sizeof(uint32_t))
    {
       pgmoneta_log_error("rfile initialize: incomplete file header at %s%s, cannot read block count", relative_dir, base_file_name);
       goto error;
    }
+   offset += nread;
    if (rf->num_blocks > relsegsz)
    {
       pgmoneta_log_error("rfile initialize: file has %d blocks which is more than server's segment size", rf->num_blocks);
@@ -1909,12 +1859,12 @@ pgmoneta_incremental_rfile_initialize(int server, char* label, char* relative_di
    }
 
    // read truncation block length
-   nread = fread(&rf->truncation_block_length, 1, sizeof(uint32_t), rf->fp);
-   if (nread != sizeof(uint32_t))
+   if (pgmoneta_rfile_read(rf, offset, sizeof(uint32_t), &rf->truncation_block_length, &nread) || nread != sizeof(uint32_t))
    {
       pgmoneta_log_error("rfile initialize: incomplete file header at %s%s, cannot read truncation block length", relative_dir, base_file_name);
       goto error;
    }
+   offset += nread;
    if (rf->truncation_block_length > relsegsz)
    {
       pgmoneta_log_error("rfile initialize: file has truncation block length of %d which is more than server's segment size", rf->truncation_block_length);
@@ -1924,8 +1874,8 @@ pgmoneta_incremental_rfile_initialize(int server, char* label, char* relative_di
    if (rf->num_blocks > 0)
    {
       rf->relative_block_numbers = malloc(sizeof(uint32_t) * rf->num_blocks);
-      nread = fread(rf->relative_block_numbers, sizeof(uint32_t), rf->num_blocks, rf->fp);
-      if (nread != rf->num_blocks)
+      if (pgmoneta_rfile_read(rf, offset, sizeof(uint32_t) * rf->num_blocks, rf->relative_block_numbers, &nread) ||
+          nread != sizeof(uint32_t) * rf->num_blocks)
       {
          pgmoneta_log_error("rfile initialize: incomplete file header at %s, cannot read relative block numbers", rf->filepath);
          goto error;
@@ -2149,6 +2099,78 @@ error:
    return 1;
 }
 
+static int
+create_transaction(char* directory, struct info_transaction** transaction)
+{
+   struct info_transaction* t = NULL;
+
+   *transaction = NULL;
+
+   t = (struct info_transaction*)malloc(sizeof(struct info_transaction));
+   if (t == NULL)
+   {
+      goto error;
+   }
+
+   memset(t, 0, sizeof(struct info_transaction));
+   snprintf(&t->directory[0], sizeof(t->directory), "%s", directory);
+
+   if (pgmoneta_deque_create(false, &t->entries))
+   {
+      goto error;
+   }
+
+   *transaction = t;
+
+   return 0;
+
+error:
+
+   free(t);
+
+   return 1;
+}
+
+static void
+set_value(struct info_transaction* transaction, char* key, char* value)
+{
+   struct deque_iterator* iter = NULL;
+   bool found = false;
+
+   if (transaction == NULL)
+   {
+      return;
+   }
+
+   pgmoneta_log_trace("%s=%s", key, value);
+
+   if (!pgmoneta_deque_iterator_create(transaction->entries, &iter))
+   {
+      while (!found && pgmoneta_deque_iterator_next(iter))
+      {
+         if (!strcmp(iter->tag, key))
+         {
+            struct value* v = NULL;
+
+            if (!pgmoneta_value_create(ValueString, (uintptr_t)value, &v))
+            {
+               pgmoneta_value_destroy(iter->cur->data);
+               iter->cur->data = v;
+            }
+
+            found = true;
+         }
+      }
+
+      pgmoneta_deque_iterator_destroy(iter);
+   }
+
+   if (!found)
+   {
+      pgmoneta_deque_add(transaction->entries, key, (uintptr_t)value, ValueString);
+   }
+}
+
 static int
 file_final_name(char* file, int encryption, int compression, char** finalname)
 {
@@ -2236,3 +2258,1003 @@ error:
    free(path_copy);
    return 1;
 }
+
+static int
+read_info(FILE* file, struct backup** backup)
+{
+   char buffer[INFO_BUFFER_SIZE];
+   int tbl_idx = 0;
+   struct backup* bck = NULL;
+
+   *backup = NULL;
+
+   bck = (struct backup*)malloc(sizeof(struct backup));
+
+   if (bck == NULL)
+   {
+      goto error;
+   }
+
+   memset(bck, 0, sizeof(struct backup));
+   bck->valid = VALID_UNKNOWN;
+   bck->basebackup_elapsed_time = 0;
+   bck->manifest_elapsed_time = 0;
+   bck->compression_zstd_elapsed_time = 0;
+   bck->compression_bzip2_elapsed_time = 0;
+   bck->compression_lz4_elapsed_time = 0;
+   bck->compression_gzip_elapsed_time = 0;
+   bck->encryption_elapsed_time = 0;
+   bck->linking_elapsed_time = 0;
+   bck->remote_ssh_elapsed_time = 0;
+   bck->remote_azure_elapsed_time = 0;
+   bck->remote_s3_elapsed_time = 0;
+
+   if (file != NULL)
+   {
+      while ((fgets(&buffer[0], sizeof(buffer), file)) != NULL)
+      {
+         char key[INFO_BUFFER_SIZE];
+         char value[INFO_BUFFER_SIZE];
+         char* ptr = NULL;
+
+         ptr = strtok(&buffer[0], "=");
+
+         if (ptr == NULL)
+         {
+            goto error;
+         }
+
+         snprintf(&key[0], sizeof(key), "%s", ptr);
+
+         ptr = strtok(NULL, "=");
+
+         if (ptr == NULL)
+         {
+            goto error;
+         }
+
+         snprintf(&value[0], sizeof(value), "%.*s", (int)strlen(ptr) - 1, ptr);
+
+         if (!strcmp(INFO_STATUS, &key[0]))
+         {
+            if (!strcmp("1", &value[0]))
+            {
+               bck->valid = VALID_TRUE;
+            }
+            else
+            {
+               bck->valid = VALID_FALSE;
+            }
+         }
+         else if (!strcmp(INFO_LABEL, &key[0]))
+         {
+            memcpy(&bck->label[0], &value[0], strlen(&value[0]));
+         }
+         else if (!strcmp(INFO_WAL, &key[0]))
+         {
+            memcpy(&bck->wal[0], &value[0], strlen(&value[0]));
+         }
+         else if (!strcmp(INFO_BACKUP, &key[0]))
+         {
+            bck->backup_size = strtoul(&value[0], &ptr, 10);
+         }
+         else if (!strcmp(INFO_RESTORE, &key[0]))
+         {
+            bck->restore_size = strtoul(&value[0], &ptr, 10);
+         }
+         else if (!strcmp(INFO_BIGGEST_FILE, &key[0]))
+         {
+            bck->biggest_file_size = strtoul(&value[0], &ptr, 10);
+         }
+         else if (!strcmp(INFO_ELAPSED, &key[0]))
+         {
+            bck->total_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_BASEBACKUP_ELAPSED, &key[0]))
+         {
+            bck->basebackup_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_MANIFEST_ELAPSED, &key[0]))
+         {
+            bck->manifest_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_COMPRESSION_ZSTD_ELAPSED, &key[0]))
+         {
+            bck->compression_zstd_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_COMPRESSION_BZIP2_ELAPSED, &key[0]))
+         {
+            bck->compression_bzip2_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_COMPRESSION_GZIP_ELAPSED, &key[0]))
+         {
+            bck->compression_gzip_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_COMPRESSION_LZ4_ELAPSED, &key[0]))
+         {
+            bck->compression_lz4_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_ENCRYPTION_ELAPSED, &key[0]))
+         {
+            bck->encryption_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_LINKING_ELAPSED, &key[0]))
+         {
+            bck->linking_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_REMOTE_SSH_ELAPSED, &key[0]))
+         {
+            bck->remote_ssh_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_REMOTE_AZURE_ELAPSED, &key[0]))
+         {
+            bck->remote_azure_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_REMOTE_S3_ELAPSED, &key[0]))
+         {
+            bck->remote_s3_elapsed_time = atof(&value[0]);
+         }
+         else if (!strcmp(INFO_MAJOR_VERSION, &key[0]))
+         {
+            bck->major_version = atoi(&value[0]);
+         }
+         else if (!strcmp(INFO_MINOR_VERSION, &key[0]))
+         {
+            bck->minor_version = atoi(&value[0]);
+         }
+         else if (!strcmp(INFO_KEEP, &key[0]))
+         {
+            bck->keep = atoi(&value[0]) == 1 ? true : false;
+         }
+         else if (!strcmp(INFO_TABLESPACES, &key[0]))
+         {
+            bck->number_of_tablespaces = strtoul(&value[0], &ptr, 10);
+         }
+         else if (pgmoneta_starts_with(&key[0], "TABLESPACE_OID"))
+         {
+            memcpy(&bck->tablespaces_oids[tbl_idx], &value[0], strlen(&value[0]));
+         }
+         else if (pgmoneta_starts_with(&key[0], "TABLESPACE_PATH"))
+         {
+            memcpy(&bck->tablespaces_paths[tbl_idx], &value[0], strlen(&value[0]));
+            /* This one is last */
+            tbl_idx++;
+         }
+         else if (pgmoneta_starts_with(&key[0], "TABLESPACE"))
+         {
+            memcpy(&bck->tablespaces[tbl_idx], &value[0], strlen(&value[0]));
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_START_WALPOS))
+         {
+            sscanf(&value[0], "%X/%X", &bck->start_lsn_hi32, &bck->start_lsn_lo32);
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_END_WALPOS))
+         {
+            sscanf(&value[0], "%X/%X", &bck->end_lsn_hi32, &bck->end_lsn_lo32);
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_CHKPT_WALPOS))
+         {
+            sscanf(&value[0], "%X/%X", &bck->checkpoint_lsn_hi32, &bck->checkpoint_lsn_lo32);
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_START_TIMELINE))
+         {
+            bck->start_timeline = atoi(&value[0]);
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_END_TIMELINE))
+         {
+            bck->end_timeline = atoi(&value[0]);
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_HASH_ALGORITHM))
+         {
+            bck->hash_algorithm = atoi(&value[0]);
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_COMMENTS))
+         {
+            memcpy(&bck->comments[0], &value[0], strlen(&value[0]));
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_EXTRA))
+         {
+            memcpy(&bck->comments[0], &value[0], strlen(&value[0]));
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_COMPRESSION))
+         {
+            bck->compression = atoi(&value[0]);
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_ENCRYPTION))
+         {
+            bck->encryption = atoi(&value[0]);
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_TYPE))
+         {
+            bck->type = atoi(&value[0]);
+         }
+         else if (pgmoneta_starts_with(&key[0], INFO_PARENT))
+         {
+            memcpy(&bck->parent_label[0], &value[0], strlen(&value[0]));
+         }
+         else if (!strcmp(INFO_VERIFIED, &key[0]))
+         {
+            bck->verified = strtoll(&value[0], &ptr, 10);
+         }
+         else if (!strcmp(INFO_VERIFIED_FILES, &key[0]))
+         {
+            bck->verified_files = strtoul(&value[0], &ptr, 10);
+         }
+         else if (!strcmp(INFO_VERIFIED_FAILED, &key[0]))
+         {
+            bck->verified_failed = strtoul(&value[0], &ptr, 10);
+         }
+      }
+   }
+
+   *backup = bck;
+
+   return 0;
+
+error:
+
+   free(bck);
+
+   return 1;
+}
+
+static int
+scan_backups(char* directory, int* number_of_backups, struct backup*** backups)
+{
+   char* d = NULL;
+   struct backup** bcks = NULL;
+   int number_of_directories;
+   char** dirs;
+
+   *number_of_backups = 0;
+   *backups = NULL;
+
+   number_of_directories = 0;
+   dirs = NULL;
+
+   pgmoneta_get_directories(directory, &number_of_directories, &dirs);
+
+   bcks = (struct backup**)malloc(number_of_directories * sizeof(struct backup*));
+
+   if (bcks == NULL)
+   {
+      goto error;
+   }
+
+   memset(bcks, 0, number_of_directories * sizeof(struct backup*));
+
+   for (int i = 0; i < number_of_directories; i++)
+   {
+      d = pgmoneta_append(d, directory);
+
+      if (pgmoneta_get_backup(d, dirs[i], &bcks[i]))
+      {
+         goto error;
+      }
+
+      free(d);
+      d = NULL;
+   }
+
+   for (int i = 0; i < number_of_directories; i++)
+   {
+      free(dirs[i]);
+   }
+   free(dirs);
+
+   *number_of_backups = number_of_directories;
+   *backups = bcks;
+
+   return 0;
+
+error:
+
+   free(d);
+
+   if (dirs != NULL)
+   {
+      for (int i = 0; i < number_of_directories; i++)
+      {
+         free(dirs[i]);
+      }
+      free(dirs);
+   }
+
+   return 1;
+}
+
+static char*
+catalog_path(char* directory)
+{
+   char* catalog = NULL;
+   size_t length;
+
+   catalog = pgmoneta_append(catalog, directory);
+
+   length = strlen(catalog);
+   while (length > 1 && catalog[length - 1] == '/')
+   {
+      catalog[--length] = '\0';
+   }
+
+   catalog = pgmoneta_append(catalog, CATALOG_SUFFIX);
+
+   return catalog;
+}
+
+static int
+catalog_stamp(char* directory, char* stamp, size_t size)
+{
+   struct stat st;
+   struct timespec mtime;
+
+   if (stat(directory, &st) != 0)
+   {
+      errno = 0;
+      return 1;
+   }
+
+   pgmoneta_get_file_mtime(&st, &mtime);
+
+   snprintf(stamp, size, "S %ju %ju %jd %ld %ju\n",
+            (uintmax_t)st.st_dev, (uintmax_t)st.st_ino,
+            (intmax_t)mtime.tv_sec, (long)mtime.tv_nsec,
+            (uintmax_t)st.st_nlink);
+
+   return 0;
+}
+
+static int
+catalog_lock(char* directory, int operation)
+{
+   int fd = -1;
+
+   if (directory == NULL)
+   {
+      return -1;
+   }
+
+   fd = open(directory, O_RDONLY);
+   if (fd == -1)
+   {
+      errno = 0;
+      return -1;
+   }
+
+   if (flock(fd, operation) != 0)
+   {
+      errno = 0;
+      close(fd);
+      return -1;
+   }
+
+   return fd;
+}
+
+static int
+catalog_index(char* directory, char* catalog, char* stamp, struct catalog_index** index)
+{
+   char last[MISC_LENGTH];
+   char* data = NULL;
+   size_t offset = 0;
+   size_t size = 0;
+   size_t pos = 0;
+   bool complete = false;
+   int fd = -1;
+   struct stat st;
+   struct catalog_index* idx = NULL;
+   struct backup* bck = NULL;
+   struct value_config config = {.destroy_data = catalog_index_destroy_cb, .to_string = NULL};
+   FILE* file = NULL;
+
+   *index = NULL;
+
+   if (catalog_indexes == NULL && pgmoneta_art_create(&catalog_indexes))
+   {
+      goto error;
+   }
+
+   fd = open(catalog, O_RDONLY);
+   if (fd == -1 || fstat(fd, &st) != 0)
+   {
+      goto error;
+   }
+
+   idx = (struct catalog_index*)pgmoneta_art_search(catalog_indexes, directory);
+
+   /* Only the records appended since the last call need parsing, as long as the indexed part is untouched */
+   if (idx != NULL && idx->device == st.st_dev && idx->inode == st.st_ino &&
+       idx->size >= strlen(idx->stamp) && (size_t)st.st_size >= idx->size &&
+       pread(fd, &last[0], strlen(idx->stamp), idx->size - strlen(idx->stamp)) == (ssize_t)strlen(idx->stamp) &&
+       !strncmp(&last[0], idx->stamp, strlen(idx->stamp)))
+   {
+      offset = idx->size;
+   }
+   else
+   {
+      if (idx != NULL)
+      {
+         pgmoneta_art_delete(catalog_indexes, directory);
+      }
+
+      idx = (struct catalog_index*)malloc(sizeof(struct catalog_index));
+      if (idx == NULL)
+      {
+         goto error;
+      }
+
+      memset(idx, 0, sizeof(struct catalog_index));
+      idx->device = st.st_dev;
+      idx->inode = st.st_ino;
+
+      if (pgmoneta_art_create(&idx->backups))
+      {
+         free(idx);
+         goto error;
+      }
+
+      if (pgmoneta_art_insert_with_config(catalog_indexes, directory, (uintptr_t)idx, &config))
+      {
+         catalog_index_destroy_cb((uintptr_t)idx);
+         goto error;
+      }
+   }
+
+   size = (size_t)st.st_size - offset;
+
+   if (size > 0)
+   {
+      data = (char*)malloc(size + 1);
+      if (data == NULL)
+      {
+         goto error;
+      }
+
+      for (size_t length = 0; length < size;)
+      {
+         ssize_t r = pread(fd, data + length, size - length, offset + length);
+
+         if (r <= 0)
+         {
+            goto error;
+         }
+
+         length += r;
+      }
+
+      data[size] = '\0';
+
+      if (offset == 0)
+      {
+         if (size < strlen(CATALOG_HEADER) || strncmp(data, CATALOG_HEADER, strlen(CATALOG_HEADER)))
+         {
+            goto error;
+         }
+
+         pos = strlen(CATALOG_HEADER);
+      }
+
+      while (pos < size)
+      {
+         char* line = data + pos;
+         char* end = memchr(line, '\n', size - pos);
+
+         if (end == NULL)
+         {
+            goto error;
+         }
+
+         pos = end - data + 1;
+
+         if (line[0] == 'S')
+         {
+            /* A transaction ends with the stamp of the backup directory it was written against */
+            if ((size_t)(end - line + 1) >= sizeof(idx->stamp))
+            {
+               goto error;
+            }
+
+            memset(&idx->stamp[0], 0, sizeof(idx->stamp));
+            memcpy(&idx->stamp[0], line, end - line + 1);
+            complete = true;
+         }
+         else if (line[0] == 'B')
+         {
+            char label[MISC_LENGTH];
+            size_t length = 0;
+
+            *end = '\0';
+            memset(&label[0], 0, sizeof(label));
+
+            if (sscanf(line, "B %127s %zu", &label[0], &length) != 2 || length == 0 || length > size - pos)
+            {
+               goto error;
+            }
+
+            file = fmemopen(data + pos, length, "r");
+            if (file == NULL || read_info(file, &bck))
+            {
+               errno = 0;
+               goto error;
+            }
+
+            fclose(file);
+            file = NULL;
+
+            /* A later record of a backup replaces the earlier one */
+            if (pgmoneta_art_insert(idx->backups, &label[0], (uintptr_t)bck, ValueMem))
+            {
+               free(bck);
+               goto error;
+            }
+            bck = NULL;
+
+            pos += length;
+            complete = false;
+            idx->records++;
+         }
+         else
+         {
+            goto error;
+         }
+      }
+
+      if (!complete)
+      {
+         goto error;
+      }
+
+      idx->size = (size_t)st.st_size;
+   }
+
+   close(fd);
+   free(data);
+
+   if (idx->size == 0 || strcmp(idx->stamp, stamp))
+   {
+      return 1;
+   }
+
+   *index = idx;
+
+   return 0;
+
+error:
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   if (fd != -1)
+   {
+      close(fd);
+   }
+
+   if (pgmoneta_art_contains_key(catalog_indexes, directory))
+   {
+      pgmoneta_art_delete(catalog_indexes, directory);
+   }
+
+   free(data);
+   errno = 0;
+
+   return 1;
+}
+
+static void
+catalog_index_destroy_cb(uintptr_t data)
+{
+   struct catalog_index* idx = (struct catalog_index*)data;
+
+   if (idx != NULL)
+   {
+      pgmoneta_art_destroy(idx->backups);
+      free(idx);
+   }
+}
+
+static int
+catalog_copy(struct catalog_index* index, int* number_of_backups, struct backup*** backups)
+{
+   int n = 0;
+   struct art_iterator* iter = NULL;
+   struct backup** bcks = NULL;
+
+   *number_of_backups = 0;
+   *backups = NULL;
+
+   bcks = (struct backup**)malloc(index->backups->size * sizeof(struct backup*) + 1);
+   if (bcks == NULL)
+   {
+      goto error;
+   }
+
+   if (pgmoneta_art_iterator_create(index->backups, &iter))
+   {
+      goto error;
+   }
+
+   while (pgmoneta_art_iterator_next(iter))
+   {
+      bcks[n] = (struct backup*)malloc(sizeof(struct backup));
+      if (bcks[n] == NULL)
+      {
+         goto error;
+      }
+
+      memcpy(bcks[n], (struct backup*)pgmoneta_value_data(iter->value), sizeof(struct backup));
+      n++;
+   }
+
+   pgmoneta_art_iterator_destroy(iter);
+
+   qsort(bcks, n, sizeof(struct backup*), backup_compare);
+
+   *number_of_backups = n;
+   *backups = bcks;
+
+   return 0;
+
+error:
+
+   for (int i = 0; i < n; i++)
+   {
+      free(bcks[i]);
+   }
+   free(bcks);
+
+   pgmoneta_art_iterator_destroy(iter);
+
+   return 1;
+}
+
+static int
+catalog_build(char* directory, char* catalog, int* number_of_backups, struct backup*** backups)
+{
+   char stamp[MISC_LENGTH];
+   char* tmp = NULL;
+   char* fn = NULL;
+   char* data = NULL;
+   size_t size = 0;
+   int number_of_directories = 0;
+   char** dirs = NULL;
+   struct backup** bcks = NULL;
+   FILE* file = NULL;
+   FILE* info = NULL;
+
+   *number_of_backups = 0;
+   *backups = NULL;
+
+   /* Take the stamp first, so a change during the scan leaves the catalog stale */
+   if (catalog_stamp(directory, &stamp[0], sizeof(stamp)))
+   {
+      goto error;
+   }
+
+   if (pgmoneta_get_directories(directory, &number_of_directories, &dirs))
+   {
+      goto error;
+   }
+
+   bcks = (struct backup**)malloc(number_of_directories * sizeof(struct backup*) + 1);
+   if (bcks == NULL)
+   {
+      goto error;
+   }
+
+   memset(bcks, 0, number_of_directories * sizeof(struct backup*));
+
+   tmp = pgmoneta_append(tmp, catalog);
+   tmp = pgmoneta_append(tmp, ".tmp");
+
+   file = fopen(tmp, "w");
+   if (file == NULL)
+   {
+      pgmoneta_log_error("Could not open file %s due to %s", tmp, strerror(errno));
+      errno = 0;
+      goto error;
+   }
+
+   fputs(CATALOG_HEADER, file);
+
+   for (int i = 0; i < number_of_directories; i++)
+   {
+      fn = pgmoneta_append(fn, directory);
+      fn = pgmoneta_append(fn, "/");
+      fn = pgmoneta_append(fn, dirs[i]);
+      fn = pgmoneta_append(fn, "/backup.info");
+
+      if (load_file(fn, &data, &size) || size == 0)
+      {
+         pgmoneta_log_error("Could not read file %s", fn);
+         goto error;
+      }
+
+      info = fmemopen(data, size, "r");
+      if (info == NULL || read_info(info, &bcks[i]))
+      {
+         errno = 0;
+         goto error;
+      }
+
+      fclose(info);
+      info = NULL;
+
+      fprintf(file, "B %s %zu\n", dirs[i], size);
+      fwrite(data, 1, size, file);
+
+      free(data);
+      data = NULL;
+      free(fn);
+      fn = NULL;
+   }
+
+   fputs(&stamp[0], file);
+
+   if (fflush(file) != 0 || fsync(fileno(file)) != 0)
+   {
+      pgmoneta_log_error("Could not write file %s due to %s", tmp, strerror(errno));
+      errno = 0;
+      goto error;
+   }
+
+   fclose(file);
+   file = NULL;
+
+   pgmoneta_permission(tmp, 6, 0, 0);
+
+   if (pgmoneta_move_file(tmp, catalog))
+   {
+      goto error;
+   }
+
+   for (int i = 0; i < number_of_directories; i++)
+   {
+      free(dirs[i]);
+   }
+   free(dirs);
+   free(tmp);
+
+   *number_of_backups = number_of_directories;
+   *backups = bcks;
+
+   return 0;
+
+error:
+
+   if (info != NULL)
+   {
+      fclose(info);
+   }
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   if (tmp != NULL)
+   {
+      unlink(tmp);
+   }
+   unlink(catalog);
+   errno = 0;
+
+   if (bcks != NULL)
+   {
+      for (int i = 0; i < number_of_directories; i++)
+      {
+         free(bcks[i]);
+      }
+      free(bcks);
+   }
+
+   for (int i = 0; i < number_of_directories; i++)
+   {
+      free(dirs[i]);
+   }
+   free(dirs);
+   free(tmp);
+   free(fn);
+   free(data);
+
+   return 1;
+}
+
+static void
+catalog_update(char* directory)
+{
+   char stamp[MISC_LENGTH];
+   char header[MISC_LENGTH * 2];
+   char* parent = NULL;
+   char* label = NULL;
+   char* catalog = NULL;
+   char* fn = NULL;
+   char* data = NULL;
+   char* record = NULL;
+   size_t size = 0;
+   size_t length = 0;
+   int number_of_backups = 0;
+   struct backup** backups = NULL;
+   struct catalog_index* index = NULL;
+   int lock = -1;
+   int fd = -1;
+
+   parent = pgmoneta_append(parent, directory);
+
+   length = strlen(parent);
+   while (length > 1 && parent[length - 1] == '/')
+   {
+      parent[--length] = '\0';
+   }
+
+   label = strrchr(parent, '/');
+   if (label == NULL || label == parent)
+   {
+      goto done;
+   }
+
+   *label = '\0';
+   label++;
+
+   catalog = catalog_path(parent);
+
+   /* Only the backup directories of a server have a catalog */
+   if (!pgmoneta_exists(catalog))
+   {
+      goto done;
+   }
+
+   lock = catalog_lock(parent, LOCK_EX);
+   if (lock == -1 || catalog_stamp(parent, &stamp[0], sizeof(stamp)))
+   {
+      goto done;
+   }
+
+   if (catalog_index(parent, catalog, &stamp[0], &index) ||
+       index->records > 2 * (int)index->backups->size + CATALOG_SLACK)
+   {
+      /* A backup was added or removed, or the log has grown; start over */
+      if (!catalog_build(parent, catalog, &number_of_backups, &backups))
+      {
+         for (int i = 0; i < number_of_backups; i++)
+         {
+            free(backups[i]);
+         }
+         free(backups);
+      }
+
+      goto done;
+   }
+
+   fn = pgmoneta_append(fn, parent);
+   fn = pgmoneta_append(fn, "/");
+   fn = pgmoneta_append(fn, label);
+   fn = pgmoneta_append(fn, "/backup.info");
+
+   if (load_file(fn, &data, &size) || size == 0)
+   {
+      goto stale;
+   }
+
+   snprintf(&header[0], sizeof(header), "B %s %zu\n", label, size);
+
+   record = pgmoneta_append(record, &header[0]);
+   record = pgmoneta_append(record, data);
+   record = pgmoneta_append(record, &stamp[0]);
+
+   fd = open(catalog, O_WRONLY | O_APPEND);
+   if (fd == -1)
+   {
+      goto stale;
+   }
+
+   length = strlen(record);
+   for (size_t written = 0; written < length;)
+   {
+      ssize_t w = write(fd, record + written, length - written);
+
+      if (w <= 0)
+      {
+         goto stale;
+      }
+
+      written += w;
+   }
+
+   if (fsync(fd) != 0)
+   {
+      goto stale;
+   }
+
+done:
+
+   if (fd != -1)
+   {
+      close(fd);
+   }
+
+   if (lock != -1)
+   {
+      close(lock);
+   }
+
+   free(parent);
+   free(catalog);
+   free(fn);
+   free(data);
+   free(record);
+
+   return;
+
+stale:
+
+   pgmoneta_log_warn("Removing the backup catalog %s", catalog);
+   unlink(catalog);
+   errno = 0;
+
+   goto done;
+}
+
+static int
+load_file(char* path, char** data, size_t* size)
+{
+   struct stat st;
+   char* buffer = NULL;
+   size_t length = 0;
+   int fd = -1;
+
+   *data = NULL;
+   *size = 0;
+
+   fd = open(path, O_RDONLY);
+   if (fd == -1 || fstat(fd, &st) != 0)
+   {
+      goto error;
+   }
+
+   buffer = (char*)malloc(st.st_size + 1);
+   if (buffer == NULL)
+   {
+      goto error;
+   }
+
+   while (length < (size_t)st.st_size)
+   {
+      ssize_t r = read(fd, buffer + length, st.st_size - length);
+
+      if (r <= 0)
+      {
+         goto error;
+      }
+
+      length += r;
+   }
+
+   buffer[length] = '\0';
+
+   close(fd);
+
+   *data = buffer;
+   *size = length;
+
+   return 0;
+
+error:
+
+   if (fd != -1)
+   {
+      close(fd);
+   }
+
+   free(buffer);
+   errno = 0;
+
+   return 1;
+}
+
+static int
+backup_compare(const void* a, const void* b)
+{
+   return strcmp((*(struct backup**)a)->label, (*(struct backup**)b)->label);
+}
@@ -34,6 +34,7 @@
 #include <lz4.h>
 #include <lz4_compression.h>
 #include <management.h>
+#include <security.h>
 #include <utils.h>
 
 /* system */
@@ -640,6 +641,7 @@ lz4_compress(char* from, char* to)
    char buffIn[2][BLOCK_BYTES];
    int buffInIndex = 0;
    char buffOut[LZ4_COMPRESSBOUND(BLOCK_BYTES)];
+   struct file_hash* hash = NULL;
 
    lz4Stream = LZ4_createStream();
    fin = fopen(from, "rb");
@@ -656,6 +658,11 @@ lz4_compress(char* from, char* to)
       goto error;
    }
 
+   if (pgmoneta_file_hash_create(&hash))
+   {
+      goto error;
+   }
+
    for (;;)
    {
       size_t read = fread(buffIn[buffInIndex], sizeof(char), BLOCK_BYTES, fin);
@@ -673,6 +680,9 @@ lz4_compress(char* from, char* to)
       fwrite(&compression, sizeof(compression), 1, fout);
       fwrite(buffOut, sizeof(char), (size_t)compression, fout);
 
+      pgmoneta_file_hash_update(hash, &compression, sizeof(compression));
+      pgmoneta_file_hash_update(hash, buffOut, (size_t)compression);
+
       buffInIndex = (buffInIndex + 1) % 2;
    }
 
@@ -680,6 +690,9 @@ lz4_compress(char* from, char* to)
    fclose(fin);
    LZ4_freeStream(lz4Stream);
 
+   pgmoneta_file_hash_finish(hash, to);
+   pgmoneta_file_hash_destroy(hash);
+
    return 0;
 
 error:
@@ -694,6 +707,13 @@ error:
       fclose(fout);
    }
 
+   if (lz4Stream != NULL)
+   {
+      LZ4_freeStream(lz4Stream);
+   }
+
+   pgmoneta_file_hash_destroy(hash);
+
    return 1;
 }
 
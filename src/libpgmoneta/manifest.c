@@ -39,11 +39,8 @@
 #include <stdio.h>
 #include <string.h>
 
-static void
-build_deque(struct deque* deque, struct csv_reader* reader, char** f);
-
-static void
-build_tree(struct art* tree, struct csv_reader* reader, char** f);
+static int
+build_tree(char* manifest, struct art** tree);
 
 int
 pgmoneta_manifest_checksum_verify(char* root)
@@ -126,159 +123,71 @@ error:
 int
 pgmoneta_compare_manifests(char* old_manifest, char* new_manifest, struct art** deleted_files, struct art** changed_files, struct art** added_files)
 {
-   struct csv_reader* r1 = NULL;
-   char** f1 = NULL;
-   struct csv_reader* r2 = NULL;
-   char** f2 = NULL;
+   struct csv_reader* reader = NULL;
+   char** f = NULL;
    struct art* deleted = NULL;
    struct art* changed = NULL;
    struct art* added = NULL;
+   char* path = NULL;
    char* checksum = NULL;
+   char* new_checksum = NULL;
    int cols = 0;
    bool manifest_changed = false;
-   struct art* tree = NULL;
-   struct deque* que = NULL;
-   struct deque_iterator* iter = NULL;
 
    *deleted_files = NULL;
    *changed_files = NULL;
    *added_files = NULL;
 
-   pgmoneta_deque_create(false, &que);
-
    pgmoneta_art_create(&deleted);
-   pgmoneta_art_create(&added);
    pgmoneta_art_create(&changed);
 
-   if (pgmoneta_csv_reader_init(old_manifest, &r1))
+   // index the new manifest once, the entries left after the old manifest has been probed are the added files
+   if (build_tree(new_manifest, &added))
    {
       goto error;
    }
 
-   if (pgmoneta_csv_reader_init(new_manifest, &r2))
+   if (pgmoneta_csv_reader_init(old_manifest, &reader))
    {
       goto error;
    }
 
-   while (pgmoneta_csv_next_row(r1, &cols, &f1))
+   while (pgmoneta_csv_next_row(reader, &cols, &f))
    {
       if (cols != MANIFEST_COLUMN_COUNT)
       {
          pgmoneta_log_error("Incorrect number of columns in manifest file");
-         free(f1);
+         free(f);
+         f = NULL;
          continue;
       }
-      // build left chunk into a deque
-      build_deque(que, r1, f1);
-      while (pgmoneta_csv_next_row(r2, &cols, &f2))
-      {
-         if (cols != MANIFEST_COLUMN_COUNT)
-         {
-            pgmoneta_log_error("Incorrect number of columns in manifest file");
-            free(f2);
-            continue;
-         }
-         // build every right chunk into an ART
-         pgmoneta_art_create(&tree);
-         build_tree(tree, r2, f2);
-         pgmoneta_deque_iterator_create(que, &iter);
-         while (pgmoneta_deque_iterator_next(iter))
-         {
-            checksum = (char*)pgmoneta_art_search(tree, iter->tag);
-            if (checksum != NULL)
-            {
-               if (!strcmp((char*)pgmoneta_value_data(iter->value), checksum))
-               {
-                  // not changed but not deleted, remove the entry
-                  pgmoneta_deque_iterator_remove(iter);
-               }
-               else
-               {
-                  // file is changed
-                  manifest_changed = true;
-                  pgmoneta_art_insert(changed, iter->tag, pgmoneta_value_data(iter->value), ValueString);
-                  // changed but not deleted, remove the entry
-                  pgmoneta_deque_iterator_remove(iter);
-               }
-            }
-         }
-         pgmoneta_art_destroy(tree);
-         tree = NULL;
-      }
-      pgmoneta_deque_iterator_destroy(iter);
-      iter = NULL;
 
-      // traverse
-      while (!pgmoneta_deque_empty(que))
-      {
-         char* tag = NULL;
-         uintptr_t val = 0;
-         manifest_changed = true;
-         val = pgmoneta_deque_poll(que, &tag);
-         pgmoneta_art_insert(deleted, tag, val, ValueString);
-         free(tag);
-         free((void*)val);
-      }
-      // reset right reader for the next left chunk
-      if (pgmoneta_csv_reader_reset(r2))
-      {
-         goto error;
-      }
-   }
-   if (pgmoneta_csv_reader_reset(r1))
-   {
-      goto error;
-   }
+      path = f[MANIFEST_PATH_INDEX];
+      checksum = f[MANIFEST_CHECKSUM_INDEX];
 
-   while (pgmoneta_csv_next_row(r2, &cols, &f2))
-   {
-      if (cols != MANIFEST_COLUMN_COUNT)
+      new_checksum = (char*)pgmoneta_art_search(added, path);
+      if (new_checksum == NULL)
       {
-         pgmoneta_log_error("Incorrect number of columns in manifest file");
-         free(f2);
-         continue;
+         manifest_changed = true;
+         pgmoneta_art_insert(deleted, path, (uintptr_t)checksum, ValueString);
       }
-      build_deque(que, r2, f2);
-      while (pgmoneta_csv_next_row(r1, &cols, &f1))
+      else
       {
-         if (cols != MANIFEST_COLUMN_COUNT)
-         {
-            pgmoneta_log_error("Incorrect number of columns in manifest file");
-            free(f1);
-            continue;
-         }
-         pgmoneta_art_create(&tree);
-         build_tree(tree, r1, f1);
-         pgmoneta_deque_iterator_create(que, &iter);
-         while (pgmoneta_deque_iterator_next(iter))
+         if (strcmp(checksum, new_checksum))
          {
-            checksum = (char*)pgmoneta_art_search(tree, iter->tag);
-            if (checksum != NULL)
-            {
-               // the entry is not new, remove it
-               pgmoneta_deque_iterator_remove(iter);
-            }
+            manifest_changed = true;
+            pgmoneta_art_insert(changed, path, (uintptr_t)checksum, ValueString);
          }
-         pgmoneta_art_destroy(tree);
-         tree = NULL;
+         pgmoneta_art_delete(added, path);
       }
-      pgmoneta_deque_iterator_destroy(iter);
-      iter = NULL;
 
-      while (!pgmoneta_deque_empty(que))
-      {
-         char* tag = NULL;
-         uintptr_t val = 0;
-         manifest_changed = true;
-         val = pgmoneta_deque_poll(que, &tag);
-         pgmoneta_art_insert(added, tag, val, ValueString);
-         free(tag);
-         free((void*)val);
-      }
-      if (pgmoneta_csv_reader_reset(r1))
-      {
-         goto error;
-      }
+      free(f);
+      f = NULL;
+   }
+
+   if (added->size > 0)
+   {
+      manifest_changed = true;
    }
 
    if (manifest_changed)
@@ -290,66 +199,38 @@ pgmoneta_compare_manifests(char* old_manifest, char* new_manifest, struct art**
    *changed_files = changed;
    *added_files = added;
 
-   pgmoneta_csv_reader_destroy(r1);
-   pgmoneta_csv_reader_destroy(r2);
-   pgmoneta_art_destroy(tree);
-   pgmoneta_deque_destroy(que);
+   pgmoneta_csv_reader_destroy(reader);
 
    return 0;
 error:
-   pgmoneta_deque_iterator_destroy(iter);
-   pgmoneta_csv_reader_destroy(r1);
-   pgmoneta_csv_reader_destroy(r2);
-   pgmoneta_art_destroy(tree);
-   pgmoneta_deque_destroy(que);
+   pgmoneta_csv_reader_destroy(reader);
+   pgmoneta_art_destroy(deleted);
+   pgmoneta_art_destroy(changed);
+   pgmoneta_art_destroy(added);
    return 1;
 }
 
-static void
-build_deque(struct deque* deque, struct csv_reader* reader, char** f)
+static int
+build_tree(char* manifest, struct art** tree)
 {
+   struct csv_reader* reader = NULL;
+   struct art* t = NULL;
    char** entry = NULL;
-   char* path = NULL;
-   char* checksum = NULL;
    int cols = 0;
-   if (deque == NULL)
-   {
-      return;
-   }
-   path = f[MANIFEST_PATH_INDEX];
-   checksum = f[MANIFEST_CHECKSUM_INDEX];
-   pgmoneta_deque_add(deque, path, (uintptr_t)checksum, ValueString);
-   free(f);
-   while (deque->size < MANIFEST_CHUNK_SIZE && pgmoneta_csv_next_row(reader, &cols, &entry))
+
+   *tree = NULL;
+
+   if (pgmoneta_art_create(&t))
    {
-      if (cols != MANIFEST_COLUMN_COUNT)
-      {
-         pgmoneta_log_error("Incorrect number of columns in manifest file");
-         free(entry);
-         continue;
-      }
-      path = entry[MANIFEST_PATH_INDEX];
-      checksum = entry[MANIFEST_CHECKSUM_INDEX];
-      pgmoneta_deque_add(deque, path, (uintptr_t)checksum, ValueString);
-      free(entry);
-      entry = NULL;
+      goto error;
    }
-}
 
-static void
-build_tree(struct art* tree, struct csv_reader* reader, char** f)
-{
-   char** entry = NULL;
-   char* path = NULL;
-   int cols = 0;
-   if (tree == NULL)
+   if (pgmoneta_csv_reader_init(manifest, &reader))
    {
-      return;
+      goto error;
    }
-   path = f[MANIFEST_PATH_INDEX];
-   pgmoneta_art_insert(tree, path, (uintptr_t)f[MANIFEST_CHECKSUM_INDEX], ValueString);
-   free(f);
-   while (tree->size < MANIFEST_CHUNK_SIZE && pgmoneta_csv_next_row(reader, &cols, &entry))
+
+   while (pgmoneta_csv_next_row(reader, &cols, &entry))
    {
       if (cols != MANIFEST_COLUMN_COUNT)
       {
@@ -357,8 +238,18 @@ build_tree(struct art* tree, struct csv_reader* reader, char** f)
          free(entry);
          continue;
       }
-      path = entry[MANIFEST_PATH_INDEX];
-      pgmoneta_art_insert(tree, path, (uintptr_t)entry[MANIFEST_CHECKSUM_INDEX], ValueString);
+      pgmoneta_art_insert(t, entry[MANIFEST_PATH_INDEX], (uintptr_t)entry[MANIFEST_CHECKSUM_INDEX], ValueString);
       free(entry);
    }
+
+   pgmoneta_csv_reader_destroy(reader);
+
+   *tree = t;
+
+   return 0;
+
+error:
+   pgmoneta_csv_reader_destroy(reader);
+   pgmoneta_art_destroy(t);
+   return 1;
 }
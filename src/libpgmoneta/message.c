@@ -46,6 +46,9 @@
 #include <sys/time.h>
 #include <stdio.h>
 
+/* Milliseconds to wait for a copy stream to become readable before checking again */
+#define COPY_STREAM_WAIT 1000
+
 static struct message* allocate_message(size_t size);
 
 static int read_message(int socket, bool block, int timeout, struct message** msg);
@@ -1034,11 +1037,8 @@ pgmoneta_create_query_message(char* query, struct message** msg)
 {
    struct message* m = NULL;
    size_t size;
-   char cmd[1024];
 
-   memset(&cmd[0], 0, sizeof(cmd));
-   strcpy(cmd, query);
-   size = 1 + 4 + strlen(cmd) + 1;
+   size = 1 + 4 + strlen(query) + 1;
 
    m = allocate_message(size);
 
@@ -1046,7 +1046,7 @@ pgmoneta_create_query_message(char* query, struct message** msg)
 
    pgmoneta_write_byte(m->data, 'Q');
    pgmoneta_write_int32(m->data + 1, size - 1);
-   memcpy(m->data + 5, &cmd[0], strlen(cmd));
+   memcpy(m->data + 5, query, strlen(query));
 
    *msg = m;
 
@@ -1851,7 +1851,7 @@ pgmoneta_read_copy_stream(SSL* ssl, int socket, struct stream_buffer* buffer)
          {
             keep_read = true;
             errno = 0;
-            SLEEP(1000000L);
+            pgmoneta_socket_wait_readable(socket, COPY_STREAM_WAIT);
          }
          else
          {
@@ -1873,6 +1873,7 @@ ssl_error:
                   break;
                case SSL_ERROR_WANT_READ:
                   keep_read = true;
+                  pgmoneta_socket_wait_readable(socket, COPY_STREAM_WAIT);
                   break;
                case SSL_ERROR_WANT_WRITE:
                   keep_read = true;
@@ -1913,7 +1914,7 @@ ssl_error:
             {
                keep_read = true;
                errno = 0;
-               SLEEP(1000000L);
+               pgmoneta_socket_wait_readable(socket, COPY_STREAM_WAIT);
             }
             else
             {
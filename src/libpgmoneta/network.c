@@ -36,6 +36,7 @@
 #include <fcntl.h>
 #include <ifaddrs.h>
 #include <netdb.h>
+#include <poll.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -690,6 +691,45 @@ error:
    return 1;
 }
 
+int
+pgmoneta_socket_wait_readable(int fd, int timeout)
+{
+   struct pollfd pfd;
+   int ret;
+
+   pfd.fd = fd;
+   pfd.events = POLLIN;
+   pfd.revents = 0;
+
+   ret = poll(&pfd, 1, timeout);
+
+   if (ret == -1)
+   {
+      if (errno == EINTR)
+      {
+         errno = 0;
+         return 0;
+      }
+
+      pgmoneta_log_trace("poll: %s (%d)", strerror(errno), fd);
+      errno = 0;
+      return -1;
+   }
+
+   if (ret == 0)
+   {
+      return 0;
+   }
+
+   if (pfd.revents & POLLNVAL)
+   {
+      return -1;
+   }
+
+   /* POLLHUP and POLLERR are reported as readable so the next read sees them */
+   return 1;
+}
+
 int
 pgmoneta_get_network_max_rate(int server)
 {
@@ -0,0 +1,1599 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* pgmoneta */
+#include <pgmoneta.h>
+#include <art.h>
+#include <logging.h>
+#include <memory.h>
+#include <message.h>
+#include <network.h>
+#include <parallel.h>
+#include <security.h>
+#include <tablespace.h>
+#include <utils.h>
+#include <workers.h>
+
+/* system */
+#include <ctype.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <openssl/evp.h>
+
+#define PARALLEL_CHUNK_SIZE (1024 * 1024)
+
+/* How long to wait for the end of the backup to be flushed, in 100 ms steps */
+#define PARALLEL_FLUSH_WAIT 600
+
+/* The directories whose content BASE_BACKUP leaves out */
+static char* excluded_directories[] = {
+   "pg_wal",
+   "pg_dynshmem",
+   "pg_notify",
+   "pg_replslot",
+   "pg_serial",
+   "pg_snapshots",
+   "pg_stat_tmp",
+   "pg_subtrans",
+   NULL
+};
+
+/* The files BASE_BACKUP leaves out */
+static char* excluded_files[] = {
+   "postgresql.auto.conf.tmp",
+   "current_logfiles.tmp",
+   "backup_label",
+   "tablespace_map",
+   "backup_manifest",
+   "postmaster.pid",
+   "postmaster.opts",
+   NULL
+};
+
+/** @struct parallel_file
+ * Defines a file of a parallel backup
+ */
+struct parallel_file
+{
+   char* path;                  /**< The path relative to the data directory */
+   char* local;                 /**< The path in the backup */
+   char modified[MISC_LENGTH];  /**< The last modification time */
+   size_t size;                 /**< The received size */
+   char* checksum;              /**< The manifest checksum */
+   bool required;               /**< The file must exist on the server */
+   bool received;               /**< The file was received */
+};
+
+/** @struct parallel_state
+ * Defines the state shared by the connections of a parallel backup
+ */
+struct parallel_state
+{
+   struct parallel_file* files;          /**< The files */
+   int number_of_files;                  /**< The number of files */
+   atomic_int next;                      /**< The next file to receive */
+   int hash;                             /**< The manifest checksum algorithm, 0 for none */
+   struct token_bucket* bucket;          /**< The rate limit bucket */
+   struct token_bucket* network_bucket;  /**< The network rate limit bucket */
+};
+
+/** @struct parallel_checksum
+ * Defines the manifest checksum of a file while it is written
+ */
+struct parallel_checksum
+{
+   int hash;             /**< The manifest checksum algorithm, 0 for none */
+   uint32_t crc;         /**< The CRC32C value */
+   EVP_MD_CTX* context;  /**< The digest of the other algorithms */
+};
+
+/** @struct parallel_connection
+ * Defines a connection of a parallel backup
+ */
+struct parallel_connection
+{
+   SSL* ssl;                      /**< The SSL structure */
+   int socket;                    /**< The socket */
+   struct stream_buffer* buffer;  /**< The stream buffer */
+   unsigned char* data;           /**< The decoded chunk */
+};
+
+/** @struct parallel_input
+ * Defines the worker input of a parallel backup
+ */
+struct parallel_input
+{
+   struct worker_common common;             /**< The common base */
+   struct parallel_connection* connection;  /**< The connection */
+   struct parallel_state* state;            /**< The shared state */
+};
+
+static int connection_query(struct parallel_connection* connection, char* query, struct query_response** response);
+static void receive_files(struct worker_common* wc);
+static bool workers_ok(struct workers* workers);
+static void workers_fail(struct workers* workers);
+static int receive_file(struct parallel_connection* connection, struct parallel_state* state, struct parallel_file* file);
+static int receive_round(struct parallel_connection* connections, int number_of_connections, struct parallel_state* state);
+static int list_files(struct parallel_connection* control, char* backup_base, struct tablespace* tablespaces, int version, struct parallel_state* state);
+static int add_file(struct parallel_state* state, char* path, char* local, size_t size, char* modified, bool required);
+static void free_files(struct parallel_state* state);
+static bool is_excluded(char* path);
+static int exclude_unlogged(struct parallel_state* state);
+static char* relation_path(char* path, bool* init);
+static char* local_path(char* backup_base, struct tablespace* tablespaces, char* path);
+static int write_file(char* path, char* content);
+static int add_written_file(struct parallel_state* state, char* path, char* local, char* content, char* modified);
+static int wait_for_flush(struct parallel_connection* control, char* lsn);
+static int check_slot(struct parallel_connection* control, char* slot, int version);
+static int write_manifest(char* manifest_path, int version, char* system_identifier, struct parallel_state* state,
+                          struct parallel_result* result);
+static char* checksum_name(int hash);
+static int checksum_start(struct parallel_checksum* checksum, int hash);
+static int checksum_update(struct parallel_checksum* checksum, void* data, size_t size);
+static int checksum_finish(struct parallel_checksum* checksum, char** result);
+static void checksum_destroy(struct parallel_checksum* checksum);
+static char* quote_literal(char* s);
+static int hex_decode(char* hex, unsigned char* data, size_t* size);
+static int hex_value(char c);
+static int compare_files(const void* a, const void* b);
+
+int
+pgmoneta_parallel_backup(int server, int usr, char* label, char* backup_base, struct tablespace* tablespaces, int hash,
+                         int number_of_connections, struct token_bucket* bucket, struct token_bucket* network_bucket,
+                         struct parallel_result* result)
+{
+   int version;
+   int wal_size;
+   bool started = false;
+   char* query = NULL;
+   char* labelfile = NULL;
+   char* spcmapfile = NULL;
+   char* slot = NULL;
+   char* system_identifier = NULL;
+   char* path = NULL;
+   char* local = NULL;
+   char* tag = NULL;
+   char* start = NULL;
+   char now[MISC_LENGTH];
+   char wal[MISC_LENGTH];
+   uint32_t hi;
+   uint32_t lo;
+   uint64_t start_lsn;
+   uint64_t end_lsn;
+   uint64_t segments_per_id;
+   time_t t;
+   struct tm* tinfo;
+   struct parallel_connection control;
+   struct parallel_connection* connections = NULL;
+   struct parallel_state state;
+   struct query_response* response = NULL;
+   struct tablespace* tblspc = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   memset(&control, 0, sizeof(struct parallel_connection));
+   control.socket = -1;
+   memset(&state, 0, sizeof(struct parallel_state));
+   memset(result, 0, sizeof(struct parallel_result));
+
+   version = config->common.servers[server].version;
+   wal_size = config->common.servers[server].wal_size;
+
+   state.hash = hash;
+   state.bucket = bucket;
+   state.network_bucket = network_bucket;
+   atomic_init(&state.next, 0);
+
+   if (wal_size <= 0)
+   {
+      pgmoneta_log_error("Parallel backup: Unknown WAL size for %s", config->common.servers[server].name);
+      goto error;
+   }
+
+   connections = (struct parallel_connection*)malloc(number_of_connections * sizeof(struct parallel_connection));
+   if (connections == NULL)
+   {
+      goto error;
+   }
+   memset(connections, 0, number_of_connections * sizeof(struct parallel_connection));
+
+   // the connections are authenticated before any thread uses them
+   for (int i = -1; i < number_of_connections; i++)
+   {
+      struct parallel_connection* c = i == -1 ? &control : &connections[i];
+
+      c->socket = -1;
+
+      if (pgmoneta_server_authenticate(server, "postgres", config->common.users[usr].username, config->common.users[usr].password,
+                                       false, &c->ssl, &c->socket) != AUTH_SUCCESS)
+      {
+         pgmoneta_log_error("Parallel backup: Could not connect to %s", config->common.servers[server].name);
+         goto error;
+      }
+
+      pgmoneta_memory_stream_buffer_init(&c->buffer);
+      if (c->buffer == NULL || pgmoneta_memory_stream_buffer_enlarge(c->buffer, 2 * PARALLEL_CHUNK_SIZE + DEFAULT_BUFFER_SIZE))
+      {
+         goto error;
+      }
+
+      c->data = (unsigned char*)malloc(PARALLEL_CHUNK_SIZE);
+      if (c->data == NULL)
+      {
+         goto error;
+      }
+   }
+
+   if (version >= 17)
+   {
+      if (connection_query(&control, "SELECT system_identifier FROM pg_control_system();", &response) ||
+          response->tuples == NULL || response->tuples->data[0] == NULL)
+      {
+         pgmoneta_log_error("Parallel backup: Could not get the system identifier of %s", config->common.servers[server].name);
+         goto error;
+      }
+      system_identifier = pgmoneta_append(system_identifier, response->tuples->data[0]);
+      pgmoneta_free_query_response(response);
+      response = NULL;
+   }
+
+   // the user level tablespaces are linked by their oid
+   if (connection_query(&control, "SELECT oid, spcname FROM pg_tablespace;", &response))
+   {
+      goto error;
+   }
+   for (struct tuple* tup = response->tuples; tup != NULL; tup = tup->next)
+   {
+      for (tblspc = tablespaces; tblspc != NULL; tblspc = tblspc->next)
+      {
+         if (tup->data[0] != NULL && tup->data[1] != NULL && pgmoneta_compare_string(tblspc->name, tup->data[1]))
+         {
+            tblspc->oid = (unsigned int)strtoul(tup->data[0], NULL, 10);
+         }
+      }
+   }
+   pgmoneta_free_query_response(response);
+   response = NULL;
+
+   // the same label as BASE_BACKUP would use
+   start = pgmoneta_append(start, "pgmoneta_");
+   start = pgmoneta_append(start, label);
+   tag = quote_literal(start);
+   free(start);
+   start = NULL;
+
+   // the WAL of the backup is read from pg_wal at the end, so a temporary slot keeps it
+   // from being recycled in the meantime. The slot is dropped when the session ends
+   start = pgmoneta_append(start, "pgmoneta_parallel_");
+   start = pgmoneta_append(start, label);
+   slot = quote_literal(start);
+   free(start);
+   start = NULL;
+
+   query = pgmoneta_append(query, "SELECT pg_create_physical_replication_slot(");
+   query = pgmoneta_append(query, slot);
+   query = pgmoneta_append(query, ", true, true);");
+
+   if (connection_query(&control, query, &response) || response->tuples == NULL)
+   {
+      pgmoneta_log_error("Parallel backup: Could not create a temporary replication slot on %s", config->common.servers[server].name);
+      goto error;
+   }
+   pgmoneta_free_query_response(response);
+   response = NULL;
+   free(query);
+   query = NULL;
+
+   query = pgmoneta_append(query, version >= 15 ? "SELECT pg_backup_start(" : "SELECT pg_start_backup(");
+   query = pgmoneta_append(query, tag);
+   query = pgmoneta_append(query, version >= 15 ? ", true);" : ", true, false);");
+
+   if (connection_query(&control, query, &response) || response->tuples == NULL || response->tuples->data[0] == NULL)
+   {
+      pgmoneta_log_error("Parallel backup: Could not start the backup on %s", config->common.servers[server].name);
+      goto error;
+   }
+   started = true;
+   snprintf(result->startpos, sizeof(result->startpos), "%s", response->tuples->data[0]);
+   pgmoneta_free_query_response(response);
+   response = NULL;
+   free(query);
+   query = NULL;
+
+   pgmoneta_log_debug("Parallel backup: %s started at %s with %d connections", config->common.servers[server].name,
+                      result->startpos, number_of_connections);
+
+   if (list_files(&control, backup_base, tablespaces, version, &state))
+   {
+      pgmoneta_log_error("Parallel backup: Could not list the files of %s", config->common.servers[server].name);
+      goto error;
+   }
+
+   if (receive_round(connections, number_of_connections, &state))
+   {
+      goto error;
+   }
+
+   query = pgmoneta_append(query, version >= 15 ? "SELECT lsn, labelfile, spcmapfile FROM pg_backup_stop(false);" :
+                           "SELECT lsn, labelfile, spcmapfile FROM pg_stop_backup(false, false);");
+   if (connection_query(&control, query, &response) || response->tuples == NULL ||
+       response->tuples->data[0] == NULL || response->tuples->data[1] == NULL)
+   {
+      pgmoneta_log_error("Parallel backup: Could not stop the backup on %s", config->common.servers[server].name);
+      goto error;
+   }
+   started = false;
+   snprintf(result->endpos, sizeof(result->endpos), "%s", response->tuples->data[0]);
+   labelfile = pgmoneta_append(labelfile, response->tuples->data[1]);
+   if (response->tuples->data[2] != NULL && strlen(response->tuples->data[2]) > 0)
+   {
+      spcmapfile = pgmoneta_append(spcmapfile, response->tuples->data[2]);
+   }
+   pgmoneta_free_query_response(response);
+   response = NULL;
+   free(query);
+   query = NULL;
+
+   start = pgmoneta_append(NULL, "START TIMELINE: ");
+   if (strstr(labelfile, start) != NULL)
+   {
+      result->start_timeline = (uint32_t)strtoul(strstr(labelfile, start) + strlen(start), NULL, 10);
+   }
+   free(start);
+   start = NULL;
+
+   if (result->start_timeline == 0)
+   {
+      pgmoneta_log_error("Parallel backup: No timeline in the backup label of %s", config->common.servers[server].name);
+      goto error;
+   }
+   // a primary can't change timeline while the backup is running
+   result->end_timeline = result->start_timeline;
+
+   time(&t);
+   tinfo = gmtime(&t);
+   memset(now, 0, sizeof(now));
+   strftime(now, sizeof(now), "%Y-%m-%d %H:%M:%S", tinfo);
+
+   local = pgmoneta_append(local, backup_base);
+   local = pgmoneta_append(local, "data/backup_label");
+   if (add_written_file(&state, "backup_label", local, labelfile, now))
+   {
+      goto error;
+   }
+   free(local);
+   local = NULL;
+
+   // the tablespaces as the server knows them, which recovery uses instead of pg_tblspc
+   if (spcmapfile != NULL)
+   {
+      local = pgmoneta_append(local, backup_base);
+      local = pgmoneta_append(local, "data/tablespace_map");
+      if (add_written_file(&state, "tablespace_map", local, spcmapfile, now))
+      {
+         goto error;
+      }
+      free(local);
+      local = NULL;
+   }
+
+   path = pgmoneta_append(path, backup_base);
+   path = pgmoneta_append(path, "data/backup_manifest");
+   if (write_manifest(path, version, system_identifier, &state, result))
+   {
+      pgmoneta_log_error("Parallel backup: Could not write %s", path);
+      goto error;
+   }
+   free(path);
+   path = NULL;
+
+   // the WAL of the backup, which isn't part of the manifest
+   free_files(&state);
+   atomic_store(&state.next, 0);
+   state.hash = 0;
+
+   sscanf(result->startpos, "%X/%X", &hi, &lo);
+   start_lsn = ((uint64_t)hi << 32) | lo;
+   sscanf(result->endpos, "%X/%X", &hi, &lo);
+   end_lsn = ((uint64_t)hi << 32) | lo;
+   segments_per_id = 0x100000000ULL / wal_size;
+
+   if (wait_for_flush(&control, result->endpos))
+   {
+      pgmoneta_log_error("Parallel backup: %s did not flush %s", config->common.servers[server].name, result->endpos);
+      goto error;
+   }
+
+   for (uint64_t segno = start_lsn / wal_size; segno <= (end_lsn - 1) / wal_size; segno++)
+   {
+      memset(wal, 0, sizeof(wal));
+      snprintf(wal, sizeof(wal), "%08X%08X%08X", result->start_timeline,
+               (uint32_t)(segno / segments_per_id), (uint32_t)(segno % segments_per_id));
+
+      path = pgmoneta_append(path, "pg_wal/");
+      path = pgmoneta_append(path, wal);
+      local = pgmoneta_append(local, backup_base);
+      local = pgmoneta_append(local, "data/");
+      local = pgmoneta_append(local, path);
+
+      if (add_file(&state, path, local, wal_size, "", true))
+      {
+         goto error;
+      }
+
+      free(path);
+      path = NULL;
+      free(local);
+      local = NULL;
+   }
+
+   if (result->start_timeline > 1)
+   {
+      memset(wal, 0, sizeof(wal));
+      snprintf(wal, sizeof(wal), "pg_wal/%08X.history", result->start_timeline);
+
+      local = pgmoneta_append(local, backup_base);
+      local = pgmoneta_append(local, "data/");
+      local = pgmoneta_append(local, wal);
+
+      if (add_file(&state, wal, local, 0, "", true))
+      {
+         goto error;
+      }
+
+      free(local);
+      local = NULL;
+   }
+
+   if (receive_round(connections, number_of_connections, &state))
+   {
+      goto error;
+   }
+
+   if (check_slot(&control, slot, version))
+   {
+      pgmoneta_log_error("Parallel backup: The WAL of the backup was removed from %s", config->common.servers[server].name);
+      goto error;
+   }
+
+   // the tablespaces are linked like a BASE_BACKUP would have them
+   for (tblspc = tablespaces; tblspc != NULL; tblspc = tblspc->next)
+   {
+      path = pgmoneta_append(path, backup_base);
+      path = pgmoneta_append(path, "data/pg_tblspc/");
+      path = pgmoneta_append_int(path, (int)tblspc->oid);
+      local = pgmoneta_append(local, backup_base);
+      local = pgmoneta_append(local, "tblspc_");
+      local = pgmoneta_append(local, tblspc->name);
+      local = pgmoneta_append(local, "/");
+
+      pgmoneta_mkdir(local);
+      unlink(path);
+      pgmoneta_symlink_file(path, local);
+
+      free(path);
+      path = NULL;
+      free(local);
+      local = NULL;
+   }
+
+   for (int i = -1; i < number_of_connections; i++)
+   {
+      struct parallel_connection* c = i == -1 ? &control : &connections[i];
+
+      pgmoneta_close_ssl(c->ssl);
+      if (c->socket != -1)
+      {
+         pgmoneta_disconnect(c->socket);
+      }
+      pgmoneta_memory_stream_buffer_free(c->buffer);
+      free(c->data);
+   }
+   free(connections);
+   free_files(&state);
+   free(labelfile);
+   free(spcmapfile);
+   free(slot);
+   free(system_identifier);
+   free(tag);
+
+   return 0;
+
+error:
+
+   if (started && control.socket != -1)
+   {
+      // ending the session aborts the backup, but be explicit about it
+      pgmoneta_free_query_response(response);
+      response = NULL;
+      connection_query(&control, version >= 15 ? "SELECT pg_backup_stop(false);" : "SELECT pg_stop_backup(false, false);", &response);
+   }
+
+   for (int i = -1; connections != NULL && i < number_of_connections; i++)
+   {
+      struct parallel_connection* c = i == -1 ? &control : &connections[i];
+
+      pgmoneta_close_ssl(c->ssl);
+      if (c->socket != -1)
+      {
+         pgmoneta_disconnect(c->socket);
+      }
+      pgmoneta_memory_stream_buffer_free(c->buffer);
+      free(c->data);
+   }
+   free(connections);
+   free_files(&state);
+   pgmoneta_free_query_response(response);
+   free(query);
+   free(labelfile);
+   free(spcmapfile);
+   free(slot);
+   free(system_identifier);
+   free(path);
+   free(local);
+   free(tag);
+   free(start);
+
+   return 1;
+}
+
+static int
+connection_query(struct parallel_connection* connection, char* query, struct query_response** response)
+{
+   struct message* msg = NULL;
+
+   *response = NULL;
+
+   if (connection->socket == -1)
+   {
+      goto error;
+   }
+
+   if (pgmoneta_create_query_message(query, &msg) != MESSAGE_STATUS_OK || msg == NULL)
+   {
+      goto error;
+   }
+
+   if (pgmoneta_write_message(connection->ssl, connection->socket, msg) != MESSAGE_STATUS_OK)
+   {
+      goto error;
+   }
+
+   // the stream buffer is private to the connection, so this is safe from any thread
+   if (pgmoneta_consume_data_row_messages(connection->ssl, connection->socket, connection->buffer, response))
+   {
+      // the connection was closed
+      connection->ssl = NULL;
+      connection->socket = -1;
+      goto error;
+   }
+
+   if (*response == NULL)
+   {
+      goto error;
+   }
+
+   pgmoneta_free_message(msg);
+
+   return 0;
+
+error:
+
+   pgmoneta_free_message(msg);
+
+   return 1;
+}
+
+static int
+receive_round(struct parallel_connection* connections, int number_of_connections, struct parallel_state* state)
+{
+   struct workers* workers = NULL;
+   struct parallel_input* pi = NULL;
+
+   qsort(state->files, state->number_of_files, sizeof(struct parallel_file), compare_files);
+
+   if (pgmoneta_workers_initialize(number_of_connections, &workers))
+   {
+      goto error;
+   }
+
+   for (int i = 0; i < number_of_connections; i++)
+   {
+      pi = (struct parallel_input*)malloc(sizeof(struct parallel_input));
+      if (pi == NULL)
+      {
+         goto error;
+      }
+
+      memset(pi, 0, sizeof(struct parallel_input));
+      pi->common.workers = workers;
+      pi->connection = &connections[i];
+      pi->state = state;
+
+      if (pgmoneta_workers_add(workers, receive_files, (struct worker_common*)pi))
+      {
+         free(pi);
+         goto error;
+      }
+   }
+
+   pgmoneta_workers_wait(workers);
+
+   if (!workers_ok(workers))
+   {
+      goto error;
+   }
+
+   pgmoneta_workers_destroy(workers);
+
+   return 0;
+
+error:
+
+   if (workers != NULL)
+   {
+      workers_fail(workers);
+      pgmoneta_workers_wait(workers);
+      pgmoneta_workers_destroy(workers);
+   }
+
+   return 1;
+}
+
+static void
+receive_files(struct worker_common* wc)
+{
+   int index;
+   struct parallel_input* pi = (struct parallel_input*)wc;
+
+   // each connection takes the next file until all of them are taken
+   while (workers_ok(pi->common.workers) &&
+          (index = atomic_fetch_add(&pi->state->next, 1)) < pi->state->number_of_files)
+   {
+      if (receive_file(pi->connection, pi->state, &pi->state->files[index]))
+      {
+         pgmoneta_log_error("Parallel backup: Could not receive %s", pi->state->files[index].path);
+         workers_fail(pi->common.workers);
+      }
+   }
+
+   free(pi);
+}
+
+static bool
+workers_ok(struct workers* workers)
+{
+   bool ok;
+
+   // the connections share the outcome
+   pthread_mutex_lock(&workers->worker_lock);
+   ok = workers->outcome;
+   pthread_mutex_unlock(&workers->worker_lock);
+
+   return ok;
+}
+
+static void
+workers_fail(struct workers* workers)
+{
+   pthread_mutex_lock(&workers->worker_lock);
+   workers->outcome = false;
+   pthread_mutex_unlock(&workers->worker_lock);
+}
+
+static int
+receive_file(struct parallel_connection* connection, struct parallel_state* state, struct parallel_file* file)
+{
+   char* query = NULL;
+   char* path = NULL;
+   char* hex = NULL;
+   size_t size = 0;
+   size_t offset = 0;
+   FILE* f = NULL;
+   struct parallel_checksum checksum;
+   struct query_response* response = NULL;
+
+   memset(&checksum, 0, sizeof(struct parallel_checksum));
+
+   path = quote_literal(file->path);
+
+   // the checksum is calculated from the received data, so the file isn't read again
+   if (checksum_start(&checksum, state->hash))
+   {
+      goto error;
+   }
+
+   f = fopen(file->local, "wb");
+   if (f == NULL)
+   {
+      pgmoneta_log_error("Parallel backup: Could not create %s", file->local);
+      goto error;
+   }
+
+   do
+   {
+      query = pgmoneta_append(query, "SELECT pg_read_binary_file(");
+      query = pgmoneta_append(query, path);
+      query = pgmoneta_append(query, ", ");
+      query = pgmoneta_append_ulong(query, offset);
+      query = pgmoneta_append(query, ", ");
+      query = pgmoneta_append_int(query, PARALLEL_CHUNK_SIZE);
+      query = pgmoneta_append(query, ", true);");
+
+      if (connection_query(connection, query, &response))
+      {
+         goto error;
+      }
+
+      hex = response->tuples != NULL ? response->tuples->data[0] : NULL;
+
+      if (hex == NULL)
+      {
+         if (offset == 0 && !file->required)
+         {
+            // removed since the listing, like a dropped relation
+            pgmoneta_log_debug("Parallel backup: %s was removed", file->path);
+            fclose(f);
+            f = NULL;
+            unlink(file->local);
+            goto done;
+         }
+
+         pgmoneta_log_error("Parallel backup: %s is missing", file->path);
+         goto error;
+      }
+
+      if (hex_decode(hex, connection->data, &size))
+      {
+         goto error;
+      }
+
+      if (state->network_bucket)
+      {
+         while (pgmoneta_token_bucket_consume(state->network_bucket, strlen(hex)))
+         {
+            SLEEP(500000000L)
+         }
+      }
+
+      if (state->bucket)
+      {
+         while (pgmoneta_token_bucket_consume(state->bucket, size))
+         {
+            SLEEP(500000000L)
+         }
+      }
+
+      if (size > 0 && fwrite(connection->data, 1, size, f) != size)
+      {
+         pgmoneta_log_error("Parallel backup: Could not write %s", file->local);
+         goto error;
+      }
+
+      if (checksum_update(&checksum, connection->data, size))
+      {
+         goto error;
+      }
+
+      offset += size;
+
+      pgmoneta_free_query_response(response);
+      response = NULL;
+      free(query);
+      query = NULL;
+   }
+   while (size == PARALLEL_CHUNK_SIZE);
+
+   if (fclose(f) != 0)
+   {
+      f = NULL;
+      pgmoneta_log_error("Parallel backup: Could not write %s", file->local);
+      goto error;
+   }
+   f = NULL;
+
+   file->size = offset;
+   file->received = true;
+
+   if (checksum_finish(&checksum, &file->checksum))
+   {
+      goto error;
+   }
+
+done:
+
+   checksum_destroy(&checksum);
+   pgmoneta_free_query_response(response);
+   free(query);
+   free(path);
+
+   return 0;
+
+error:
+
+   if (f != NULL)
+   {
+      fclose(f);
+   }
+   checksum_destroy(&checksum);
+   pgmoneta_free_query_response(response);
+   free(query);
+   free(path);
+
+   return 1;
+}
+
+static int
+list_files(struct parallel_connection* control, char* backup_base, struct tablespace* tablespaces, int version,
+           struct parallel_state* state)
+{
+   char* query = NULL;
+   char* local = NULL;
+   char* d = NULL;
+   struct query_response* response = NULL;
+
+   query = pgmoneta_append(query,
+                           "WITH RECURSIVE files(path, isdir, size, modification) AS ("
+                           "SELECT n, s.isdir, s.size, s.modification FROM pg_ls_dir('.', true, false) AS n, pg_stat_file(n, true) AS s "
+                           "UNION ALL "
+                           "SELECT f.path || '/' || n, s.isdir, s.size, s.modification "
+                           "FROM files AS f, pg_ls_dir(f.path, true, false) AS n, pg_stat_file(f.path || '/' || n, true) AS s "
+                           "WHERE f.isdir AND f.path NOT IN (");
+   for (int i = 0; excluded_directories[i] != NULL; i++)
+   {
+      query = pgmoneta_append(query, i > 0 ? ", '" : "'");
+      query = pgmoneta_append(query, excluded_directories[i]);
+      query = pgmoneta_append(query, "'");
+   }
+   query = pgmoneta_append(query,
+                           ")) "
+                           "SELECT path, isdir, size, to_char(modification AT TIME ZONE 'UTC', 'YYYY-MM-DD HH24:MI:SS') "
+                           "FROM files WHERE isdir IS NOT NULL;");
+
+   if (connection_query(control, query, &response))
+   {
+      goto error;
+   }
+
+   for (struct tuple* tup = response->tuples; tup != NULL; tup = tup->next)
+   {
+      char* path = tup->data[0];
+
+      if (path == NULL || tup->data[1] == NULL || is_excluded(path))
+      {
+         continue;
+      }
+
+      local = local_path(backup_base, tablespaces, path);
+      if (local == NULL)
+      {
+         // the tablespace link itself
+         continue;
+      }
+
+      if (!strcmp(tup->data[1], "t"))
+      {
+         pgmoneta_mkdir(local);
+
+         // BASE_BACKUP keeps the status directories of the WAL
+         if (!strcmp(path, "pg_wal"))
+         {
+            d = pgmoneta_append(d, local);
+            d = pgmoneta_append(d, "/archive_status");
+            pgmoneta_mkdir(d);
+            free(d);
+            d = NULL;
+
+            if (version >= 17)
+            {
+               d = pgmoneta_append(d, local);
+               d = pgmoneta_append(d, "/summaries");
+               pgmoneta_mkdir(d);
+               free(d);
+               d = NULL;
+            }
+         }
+      }
+      else if (add_file(state, path, local, tup->data[2] != NULL ? strtoull(tup->data[2], NULL, 10) : 0,
+                        tup->data[3] != NULL ? tup->data[3] : "", false))
+      {
+         goto error;
+      }
+
+      free(local);
+      local = NULL;
+   }
+
+   if (exclude_unlogged(state))
+   {
+      goto error;
+   }
+
+   pgmoneta_free_query_response(response);
+   free(query);
+
+   return 0;
+
+error:
+
+   pgmoneta_free_query_response(response);
+   free(query);
+   free(local);
+
+   return 1;
+}
+
+static int
+add_file(struct parallel_state* state, char* path, char* local, size_t size, char* modified, bool required)
+{
+   struct parallel_file* files = NULL;
+   struct parallel_file* file = NULL;
+
+   files = (struct parallel_file*)realloc(state->files, (state->number_of_files + 1) * sizeof(struct parallel_file));
+   if (files == NULL)
+   {
+      return 1;
+   }
+   state->files = files;
+
+   file = &state->files[state->number_of_files];
+   memset(file, 0, sizeof(struct parallel_file));
+
+   file->path = pgmoneta_append(NULL, path);
+   file->local = pgmoneta_append(NULL, local);
+   file->size = size;
+   snprintf(file->modified, sizeof(file->modified), "%s", modified);
+   file->required = required;
+
+   state->number_of_files++;
+
+   return 0;
+}
+
+static void
+free_files(struct parallel_state* state)
+{
+   for (int i = 0; i < state->number_of_files; i++)
+   {
+      free(state->files[i].path);
+      free(state->files[i].local);
+      free(state->files[i].checksum);
+   }
+   free(state->files);
+
+   state->files = NULL;
+   state->number_of_files = 0;
+}
+
+static bool
+is_excluded(char* path)
+{
+   char* name = NULL;
+   char* s = NULL;
+
+   name = strrchr(path, '/');
+   name = name != NULL ? name + 1 : path;
+
+   // temporary files and directories anywhere in the cluster
+   if (pgmoneta_starts_with(path, "pgsql_tmp") || strstr(path, "/pgsql_tmp") != NULL)
+   {
+      return true;
+   }
+
+   if (pgmoneta_starts_with(name, "pg_internal.init"))
+   {
+      return true;
+   }
+
+   for (int i = 0; excluded_files[i] != NULL; i++)
+   {
+      if (!strcmp(name, excluded_files[i]))
+      {
+         return true;
+      }
+   }
+
+   // temporary relations, t<backend>_<relfilenode>
+   if (name[0] == 't' && isdigit((unsigned char)name[1]))
+   {
+      s = name + 1;
+      while (isdigit((unsigned char)*s))
+      {
+         s++;
+      }
+      if (*s == '_' && isdigit((unsigned char)*(s + 1)))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+static int
+exclude_unlogged(struct parallel_state* state)
+{
+   char* relation = NULL;
+   bool init = false;
+   int kept = 0;
+   struct art* unlogged = NULL;
+
+   if (pgmoneta_art_create(&unlogged))
+   {
+      goto error;
+   }
+
+   // like BASE_BACKUP, only the init fork of an unlogged relation is kept
+   for (int i = 0; i < state->number_of_files; i++)
+   {
+      relation = relation_path(state->files[i].path, &init);
+      if (relation != NULL && init && pgmoneta_art_insert(unlogged, relation, (uintptr_t)true, ValueBool))
+      {
+         goto error;
+      }
+      free(relation);
+      relation = NULL;
+   }
+
+   for (int i = 0; i < state->number_of_files; i++)
+   {
+      relation = relation_path(state->files[i].path, &init);
+      if (relation != NULL && !init && pgmoneta_art_contains_key(unlogged, relation))
+      {
+         free(state->files[i].path);
+         free(state->files[i].local);
+         free(state->files[i].checksum);
+      }
+      else
+      {
+         state->files[kept++] = state->files[i];
+      }
+      free(relation);
+      relation = NULL;
+   }
+
+   state->number_of_files = kept;
+
+   pgmoneta_art_destroy(unlogged);
+
+   return 0;
+
+error:
+
+   free(relation);
+   pgmoneta_art_destroy(unlogged);
+
+   return 1;
+}
+
+static char*
+relation_path(char* path, bool* init)
+{
+   char* name = NULL;
+   char* s = NULL;
+   char* relation = NULL;
+
+   *init = false;
+
+   // relation files are only in the database directories
+   if (!pgmoneta_starts_with(path, "base/") && !pgmoneta_starts_with(path, "pg_tblspc/"))
+   {
+      return NULL;
+   }
+
+   name = strrchr(path, '/');
+   name = name != NULL ? name + 1 : path;
+
+   // <relfilenode>[_<fork>][.<segment>]
+   s = name;
+   while (isdigit((unsigned char)*s))
+   {
+      s++;
+   }
+
+   if (s == name || (*s != '\0' && *s != '.' && *s != '_'))
+   {
+      return NULL;
+   }
+
+   *init = pgmoneta_starts_with(s, "_init");
+
+   relation = (char*)malloc(s - path + 1);
+   if (relation == NULL)
+   {
+      return NULL;
+   }
+   memcpy(relation, path, s - path);
+   relation[s - path] = '\0';
+
+   return relation;
+}
+
+static char*
+local_path(char* backup_base, struct tablespace* tablespaces, char* path)
+{
+   char* local = NULL;
+   char* rest = NULL;
+   unsigned int oid;
+
+   if (pgmoneta_starts_with(path, "pg_tblspc/"))
+   {
+      oid = (unsigned int)strtoul(path + strlen("pg_tblspc/"), &rest, 10);
+
+      for (struct tablespace* tblspc = tablespaces; tblspc != NULL; tblspc = tblspc->next)
+      {
+         if (tblspc->oid == oid && rest != path + strlen("pg_tblspc/"))
+         {
+            if (*rest == '\0')
+            {
+               return NULL;
+            }
+
+            local = pgmoneta_append(local, backup_base);
+            local = pgmoneta_append(local, "tblspc_");
+            local = pgmoneta_append(local, tblspc->name);
+            local = pgmoneta_append(local, rest);
+
+            return local;
+         }
+      }
+   }
+
+   local = pgmoneta_append(local, backup_base);
+   local = pgmoneta_append(local, "data/");
+   local = pgmoneta_append(local, path);
+
+   return local;
+}
+
+static int
+write_file(char* path, char* content)
+{
+   FILE* file = NULL;
+
+   file = fopen(path, "wb");
+   if (file == NULL)
+   {
+      pgmoneta_log_error("Parallel backup: Could not create %s", path);
+      goto error;
+   }
+
+   if (strlen(content) > 0 && fwrite(content, 1, strlen(content), file) != strlen(content))
+   {
+      pgmoneta_log_error("Parallel backup: Could not write %s", path);
+      goto error;
+   }
+
+   fclose(file);
+
+   return 0;
+
+error:
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   return 1;
+}
+
+static int
+add_written_file(struct parallel_state* state, char* path, char* local, char* content, char* modified)
+{
+   struct parallel_file* file = NULL;
+   struct parallel_checksum checksum;
+
+   memset(&checksum, 0, sizeof(struct parallel_checksum));
+
+   if (write_file(local, content))
+   {
+      return 1;
+   }
+
+   if (add_file(state, path, local, strlen(content), modified, true))
+   {
+      return 1;
+   }
+
+   file = &state->files[state->number_of_files - 1];
+   file->received = true;
+
+   if (checksum_start(&checksum, state->hash) ||
+       checksum_update(&checksum, content, strlen(content)) ||
+       checksum_finish(&checksum, &file->checksum))
+   {
+      checksum_destroy(&checksum);
+      return 1;
+   }
+
+   checksum_destroy(&checksum);
+
+   return 0;
+}
+
+static int
+wait_for_flush(struct parallel_connection* control, char* lsn)
+{
+   char* query = NULL;
+   struct query_response* response = NULL;
+
+   query = pgmoneta_append(query, "SELECT pg_current_wal_flush_lsn() >= '");
+   query = pgmoneta_append(query, lsn);
+   query = pgmoneta_append(query, "'::pg_lsn;");
+
+   for (int i = 0; i < PARALLEL_FLUSH_WAIT; i++)
+   {
+      if (connection_query(control, query, &response) || response->tuples == NULL || response->tuples->data[0] == NULL)
+      {
+         goto error;
+      }
+
+      if (!strcmp(response->tuples->data[0], "t"))
+      {
+         pgmoneta_free_query_response(response);
+         free(query);
+         return 0;
+      }
+
+      pgmoneta_free_query_response(response);
+      response = NULL;
+
+      SLEEP(100000000L);
+   }
+
+error:
+
+   pgmoneta_free_query_response(response);
+   free(query);
+
+   return 1;
+}
+
+static int
+check_slot(struct parallel_connection* control, char* slot, int version)
+{
+   char* query = NULL;
+   struct query_response* response = NULL;
+
+   // the slot can only lose its WAL past max_slot_wal_keep_size
+   if (version < 13)
+   {
+      return 0;
+   }
+
+   query = pgmoneta_append(query, "SELECT wal_status FROM pg_replication_slots WHERE slot_name = ");
+   query = pgmoneta_append(query, slot);
+   query = pgmoneta_append(query, ";");
+
+   if (connection_query(control, query, &response) || response->tuples == NULL ||
+       response->tuples->data[0] == NULL || !strcmp(response->tuples->data[0], "lost"))
+   {
+      goto error;
+   }
+
+   pgmoneta_free_query_response(response);
+   free(query);
+
+   return 0;
+
+error:
+
+   pgmoneta_free_query_response(response);
+   free(query);
+
+   return 1;
+}
+
+static int
+write_manifest(char* manifest_path, int version, char* system_identifier, struct parallel_state* state,
+               struct parallel_result* result)
+{
+   bool first = true;
+   char* manifest = NULL;
+   char* escaped = NULL;
+   char* checksum = NULL;
+
+   // the same layout as the manifest of a BASE_BACKUP, which PostgreSQL accepts for UPLOAD_MANIFEST
+   if (version >= 17)
+   {
+      manifest = pgmoneta_append(manifest, "{ \"PostgreSQL-Backup-Manifest-Version\": 2,\n\"System-Identifier\": ");
+      manifest = pgmoneta_append(manifest, system_identifier);
+      manifest = pgmoneta_append(manifest, ",\n\"Files\": [");
+   }
+   else
+   {
+      manifest = pgmoneta_append(manifest, "{ \"PostgreSQL-Backup-Manifest-Version\": 1,\n\"Files\": [");
+   }
+
+   for (int i = 0; i < state->number_of_files; i++)
+   {
+      struct parallel_file* file = &state->files[i];
+
+      if (!file->received)
+      {
+         continue;
+      }
+
+      escaped = pgmoneta_escape_string(file->path);
+
+      manifest = pgmoneta_append(manifest, first ? "\n" : ",\n");
+      manifest = pgmoneta_append(manifest, "{ \"Path\": \"");
+      manifest = pgmoneta_append(manifest, escaped);
+      manifest = pgmoneta_append(manifest, "\", \"Size\": ");
+      manifest = pgmoneta_append_ulong(manifest, file->size);
+      manifest = pgmoneta_append(manifest, ", \"Last-Modified\": \"");
+      manifest = pgmoneta_append(manifest, file->modified);
+      manifest = pgmoneta_append(manifest, " GMT\"");
+      if (file->checksum != NULL)
+      {
+         manifest = pgmoneta_append(manifest, ", \"Checksum-Algorithm\": \"");
+         manifest = pgmoneta_append(manifest, checksum_name(state->hash));
+         manifest = pgmoneta_append(manifest, "\", \"Checksum\": \"");
+         manifest = pgmoneta_append(manifest, file->checksum);
+         manifest = pgmoneta_append(manifest, "\"");
+      }
+      manifest = pgmoneta_append(manifest, " }");
+
+      free(escaped);
+      escaped = NULL;
+      first = false;
+   }
+
+   manifest = pgmoneta_append(manifest, "\n],\n\"WAL-Ranges\": [\n{ \"Timeline\": ");
+   manifest = pgmoneta_append_ulong(manifest, result->start_timeline);
+   manifest = pgmoneta_append(manifest, ", \"Start-LSN\": \"");
+   manifest = pgmoneta_append(manifest, result->startpos);
+   manifest = pgmoneta_append(manifest, "\", \"End-LSN\": \"");
+   manifest = pgmoneta_append(manifest, result->endpos);
+   manifest = pgmoneta_append(manifest, "\" }\n],\n");
+
+   // the manifest checksum covers everything before it
+   if (pgmoneta_generate_string_sha256_hash(manifest, &checksum))
+   {
+      goto error;
+   }
+
+   manifest = pgmoneta_append(manifest, "\"Manifest-Checksum\": \"");
+   manifest = pgmoneta_append(manifest, checksum);
+   manifest = pgmoneta_append(manifest, "\"}\n");
+
+   if (write_file(manifest_path, manifest))
+   {
+      goto error;
+   }
+
+   free(manifest);
+   free(checksum);
+
+   return 0;
+
+error:
+
+   free(manifest);
+   free(escaped);
+   free(checksum);
+
+   return 1;
+}
+
+static char*
+checksum_name(int hash)
+{
+   switch (hash)
+   {
+      case HASH_ALGORITHM_CRC32C:
+         return "CRC32C";
+      case HASH_ALGORITHM_SHA224:
+         return "SHA224";
+      case HASH_ALGORITHM_SHA384:
+         return "SHA384";
+      case HASH_ALGORITHM_SHA512:
+         return "SHA512";
+      default:
+         return "SHA256";
+   }
+}
+
+static int
+checksum_start(struct parallel_checksum* checksum, int hash)
+{
+   memset(checksum, 0, sizeof(struct parallel_checksum));
+   checksum->hash = hash;
+
+   if (hash == 0 || hash == HASH_ALGORITHM_CRC32C)
+   {
+      return 0;
+   }
+
+   checksum->context = EVP_MD_CTX_new();
+   if (checksum->context == NULL ||
+       EVP_DigestInit_ex(checksum->context, EVP_get_digestbyname(checksum_name(hash)), NULL) != 1)
+   {
+      return 1;
+   }
+
+   return 0;
+}
+
+static int
+checksum_update(struct parallel_checksum* checksum, void* data, size_t size)
+{
+   if (checksum->hash == 0 || size == 0)
+   {
+      return 0;
+   }
+
+   if (checksum->hash == HASH_ALGORITHM_CRC32C)
+   {
+      return pgmoneta_create_crc32c_buffer(data, size, &checksum->crc);
+   }
+
+   return EVP_DigestUpdate(checksum->context, data, size) != 1;
+}
+
+static int
+checksum_finish(struct parallel_checksum* checksum, char** result)
+{
+   unsigned char md[EVP_MAX_MD_SIZE];
+   unsigned int md_len = 0;
+
+   *result = NULL;
+
+   if (checksum->hash == 0)
+   {
+      return 0;
+   }
+
+   if (checksum->hash == HASH_ALGORITHM_CRC32C)
+   {
+      *result = (char*)malloc(9);
+      if (*result == NULL)
+      {
+         return 1;
+      }
+      snprintf(*result, 9, "%08x", checksum->crc);
+
+      return 0;
+   }
+
+   if (EVP_DigestFinal_ex(checksum->context, md, &md_len) != 1)
+   {
+      return 1;
+   }
+
+   return pgmoneta_convert_base32_to_hex(md, md_len, (unsigned char**)result);
+}
+
+static void
+checksum_destroy(struct parallel_checksum* checksum)
+{
+   if (checksum->context != NULL)
+   {
+      EVP_MD_CTX_free(checksum->context);
+      checksum->context = NULL;
+   }
+}
+
+static char*
+quote_literal(char* s)
+{
+   char* quoted = NULL;
+
+   quoted = pgmoneta_append_char(quoted, '\'');
+   for (size_t i = 0; i < strlen(s); i++)
+   {
+      if (s[i] == '\'')
+      {
+         quoted = pgmoneta_append_char(quoted, '\'');
+      }
+      quoted = pgmoneta_append_char(quoted, s[i]);
+   }
+   quoted = pgmoneta_append_char(quoted, '\'');
+
+   return quoted;
+}
+
+static int
+hex_decode(char* hex, unsigned char* data, size_t* size)
+{
+   size_t length;
+   int high;
+   int low;
+
+   *size = 0;
+
+   // bytea in the hex output format
+   if (strncmp(hex, "\\x", 2))
+   {
+      pgmoneta_log_error("Parallel backup: Unexpected bytea format");
+      return 1;
+   }
+
+   length = (strlen(hex) - 2) / 2;
+   if (length > PARALLEL_CHUNK_SIZE)
+   {
+      return 1;
+   }
+
+   for (size_t i = 0; i < length; i++)
+   {
+      high = hex_value(hex[2 + (i * 2)]);
+      low = hex_value(hex[3 + (i * 2)]);
+
+      if (high == -1 || low == -1)
+      {
+         return 1;
+      }
+
+      data[i] = (unsigned char)((high << 4) | low);
+   }
+
+   *size = length;
+
+   return 0;
+}
+
+static int
+hex_value(char c)
+{
+   if (c >= '0' && c <= '9')
+   {
+      return c - '0';
+   }
+   else if (c >= 'a' && c <= 'f')
+   {
+      return c - 'a' + 10;
+   }
+   else if (c >= 'A' && c <= 'F')
+   {
+      return c - 'A' + 10;
+   }
+
+   return -1;
+}
+
+static int
+compare_files(const void* a, const void* b)
+{
+   const struct parallel_file* fa = (const struct parallel_file*)a;
+   const struct parallel_file* fb = (const struct parallel_file*)b;
+
+   // the biggest files first, so that the connections finish at the same time
+   if (fa->size != fb->size)
+   {
+      return fa->size < fb->size ? 1 : -1;
+   }
+
+   return strcmp(fa->path, fb->path);
+}
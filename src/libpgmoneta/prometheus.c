@@ -34,6 +34,8 @@
 #include <prometheus.h>
 #include <security.h>
 #include <shmem.h>
+#include <space.h>
+#include <string_builder.h>
 #include <utils.h>
 #include <wal.h>
 
@@ -52,17 +54,24 @@
 #define PAGE_METRICS 2
 #define BAD_REQUEST  3
 
+/* Upper bounds of the histogram buckets in microseconds, the last bucket is +Inf */
+static const int64_t histogram_bounds[HISTOGRAM_BUCKETS - 1] = {
+   100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000
+};
+
 static int resolve_page(struct message* msg);
 static int unknown_page(SSL* client_ssl, int client_fd);
 static int home_page(SSL* client_ssl, int client_fd);
 static int metrics_page(SSL* client_ssl, int client_fd);
 static int bad_request(SSL* client_ssl, int client_fd);
 static int redirect_page(SSL* client_ssl, int client_fd, char* path);
-static void general_information(SSL* client_ssl, int client_fd);
-static void backup_information(SSL* client_ssl, int client_fd);
-static void size_information(SSL* client_ssl, int client_fd);
+static void general_information(SSL* client_ssl, int client_fd, struct string_builder* data);
+static void backup_information(SSL* client_ssl, int client_fd, struct string_builder* data);
+static void size_information(SSL* client_ssl, int client_fd, struct string_builder* data);
+static void append_histogram(struct string_builder* data, char* metric, char* server, struct histogram* h);
+static void reset_histogram(struct histogram* h);
 
-static int send_chunk(SSL* client_ssl, int client_fd, char* data);
+static int send_chunk(SSL* client_ssl, int client_fd, struct string_builder* data);
 
 static bool is_metrics_cache_configured(void);
 static bool is_metrics_cache_valid(void);
@@ -207,6 +216,12 @@ retry_cache_locking:
       atomic_store(&config->common.prometheus.logging_error, 0);
       atomic_store(&config->common.prometheus.logging_fatal, 0);
 
+      for (int i = 0; i < config->common.number_of_servers; i++)
+      {
+         reset_histogram(&config->common.servers[i].wal_sync_duration);
+         reset_histogram(&config->common.servers[i].wal_flush_lag);
+      }
+
       atomic_store(&cache->lock, STATE_FREE);
    }
    else
@@ -242,6 +257,30 @@ pgmoneta_prometheus_logging(int type)
    }
 }
 
+void
+pgmoneta_prometheus_histogram_observe(struct histogram* h, int64_t usec)
+{
+   int bucket = HISTOGRAM_BUCKETS - 1;
+
+   if (usec < 0)
+   {
+      usec = 0;
+   }
+
+   for (int i = 0; i < HISTOGRAM_BUCKETS - 1; i++)
+   {
+      if (usec <= histogram_bounds[i])
+      {
+         bucket = i;
+         break;
+      }
+   }
+
+   atomic_fetch_add(&h->bucket[bucket], 1);
+   atomic_fetch_add(&h->count, 1);
+   atomic_fetch_add(&h->sum, (unsigned long long)usec);
+}
+
 static int
 resolve_page(struct message* msg)
 {
@@ -353,14 +392,18 @@ unknown_page(SSL* client_ssl, int client_fd)
 static int
 home_page(SSL* client_ssl, int client_fd)
 {
-   char* data = NULL;
+   struct string_builder* data = NULL;
    time_t now;
    char time_buf[32];
    int status;
    struct message msg;
 
    memset(&msg, 0, sizeof(struct message));
-   memset(&data, 0, sizeof(data));
+
+   if (pgmoneta_string_builder_create(0, &data))
+   {
+      return MESSAGE_STATUS_ERROR;
+   }
 
    now = time(NULL);
 
@@ -368,17 +411,23 @@ home_page(SSL* client_ssl, int client_fd)
    ctime_r(&now, &time_buf[0]);
    time_buf[strlen(time_buf) - 1] = 0;
 
-   data = pgmoneta_append(data, "HTTP/1.1 200 OK\r\n");
-   data = pgmoneta_append(data, "Content-Type: text/html; charset=utf-8\r\n");
-   data = pgmoneta_append(data, "Date: ");
-   data = pgmoneta_append(data, &time_buf[0]);
-   data = pgmoneta_append(data, "\r\n");
-   data = pgmoneta_append(data, "Transfer-Encoding: chunked\r\n");
-   data = pgmoneta_append(data, "\r\n");
+   pgmoneta_string_builder_append(data, "HTTP/1.1 200 OK\r\n");
+   pgmoneta_string_builder_append(data, "Content-Type: text/html; charset=utf-8\r\n");
+   pgmoneta_string_builder_append(data, "Date: ");
+   pgmoneta_string_builder_append(data, &time_buf[0]);
+   pgmoneta_string_builder_append(data, "\r\n");
+   pgmoneta_string_builder_append(data, "Transfer-Encoding: chunked\r\n");
+   pgmoneta_string_builder_append(data, "\r\n");
+
+   if (data->error)
+   {
+      status = MESSAGE_STATUS_ERROR;
+      goto done;
+   }
 
    msg.kind = 0;
-   msg.length = strlen(data);
-   msg.data = data;
+   msg.length = data->length;
+   msg.data = data->data;
 
    status = pgmoneta_write_message(client_ssl, client_fd, &msg);
    if (status != MESSAGE_STATUS_OK)
@@ -386,936 +435,991 @@ home_page(SSL* client_ssl, int client_fd)
       goto done;
    }
 
-   free(data);
-   data = NULL;
-
-   data = pgmoneta_append(data, "<html>\n");
-   data = pgmoneta_append(data, "<head>\n");
-   data = pgmoneta_append(data, "  <title>pgmoneta exporter</title>\n");
-   data = pgmoneta_append(data, "</head>\n");
-   data = pgmoneta_append(data, "<body>\n");
-   data = pgmoneta_append(data, "  <h1>pgmoneta exporter</h1>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <a href=\"/metrics\">Metrics</a>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_state</h2>\n");
-   data = pgmoneta_append(data, "  The state of pgmoneta\n");
-   data = pgmoneta_append(data, "  <ul>\n");
-   data = pgmoneta_append(data, "    <li>1 = Running</li>\n");
-   data = pgmoneta_append(data, "  </ul>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_version</h2>\n");
-   data = pgmoneta_append(data, "  The version of pgmoneta\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_extension</h2>\n");
-   data = pgmoneta_append(data, "  The version of pgmoneta extension\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_logging_info</h2>\n");
-   data = pgmoneta_append(data, "  The number of INFO logging statements\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_logging_warn</h2>\n");
-   data = pgmoneta_append(data, "  The number of WARN logging statements\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_logging_error</h2>\n");
-   data = pgmoneta_append(data, "  The number of ERROR logging statements\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_logging_fatal</h2>\n");
-   data = pgmoneta_append(data, "  The number of FATAL logging statements\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_retention_days</h2>\n");
-   data = pgmoneta_append(data, "  The retention of pgmoneta in days\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_retention_weeks</h2>\n");
-   data = pgmoneta_append(data, "  The retention of pgmoneta in weeks\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_retention_months</h2>\n");
-   data = pgmoneta_append(data, "  The retention of pgmoneta in months\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_retention_years</h2>\n");
-   data = pgmoneta_append(data, "  The retention of pgmoneta in years\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_retention_server</h2>\n");
-   data = pgmoneta_append(data, "  The retention of a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>parameter</td>\n");
-   data = pgmoneta_append(data, "        <td>days|weeks|months|years</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_compression</h2>\n");
-   data = pgmoneta_append(data, "  The compression used\n");
-   data = pgmoneta_append(data, "  <ul>\n");
-   data = pgmoneta_append(data, "    <li>0 = None</li>\n");
-   data = pgmoneta_append(data, "    <li>1 = GZip</li>\n");
-   data = pgmoneta_append(data, "    <li>2 = ZSTD</li>\n");
-   data = pgmoneta_append(data, "    <li>3 = LZ4</li>\n");
-   data = pgmoneta_append(data, "    <li>4 = BZIP2</li>\n");
-   data = pgmoneta_append(data, "  </ul>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_used_space</h2>\n");
-   data = pgmoneta_append(data, "  The disk space used for pgmoneta\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_free_space</h2>\n");
-   data = pgmoneta_append(data, "  The free disk space for pgmoneta\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_total_space</h2>\n");
-   data = pgmoneta_append(data, "  The total disk space for pgmoneta\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_valid</h2>\n");
-   data = pgmoneta_append(data, "  Is the server in a valid state\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_wal_streaming</h2>\n");
-   data = pgmoneta_append(data, "  The WAL streaming status of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_operation_count</h2>\n");
-   data = pgmoneta_append(data, "  The count of client operations of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_failed_operation_count</h2>\n");
-   data = pgmoneta_append(data, "  The count of failed client operations of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_last_operation_time</h2>\n");
-   data = pgmoneta_append(data, "  The time of the latest client operation of a server \n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_last_failed_operation_time</h2>\n");
-   data = pgmoneta_append(data, "  The time of the latest failed client operation of a server \n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_wal_shipping</h2>\n");
-   data = pgmoneta_append(data, "  The disk space used for WAL shipping for a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_wal_shipping_used_space</h2>\n");
-   data = pgmoneta_append(data, "  The disk space used for everything under the WAL shipping directory of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_wal_shipping_free_space</h2>\n");
-   data = pgmoneta_append(data, "  The free disk space for the WAL shipping directory of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_wal_shipping_total_space</h2>\n");
-   data = pgmoneta_append(data, "  The total disk space for the WAL shipping directory of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_workspace</h2>\n");
-   data = pgmoneta_append(data, "  The disk space used for workspace for a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_workspace_free_space</h2>\n");
-   data = pgmoneta_append(data, "  The free disk space for the workspace directory of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_workspace_total_space</h2>\n");
-   data = pgmoneta_append(data, "  The total disk space for the workspace directory of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_hot_standby</h2>\n");
-   data = pgmoneta_append(data, "  The disk space used for hot standby for a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_hot_standby_free_space</h2>\n");
-   data = pgmoneta_append(data, "  The free disk space for the hot standby directory of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_hot_standby_total_space</h2>\n");
-   data = pgmoneta_append(data, "  The total disk space for the hot standby directory of a server\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_timeline</h2>\n");
-   data = pgmoneta_append(data, "  The current timeline a server is on\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_parent_tli</h2>\n");
-   data = pgmoneta_append(data, "  The parent timeline of a timeline on a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>tli</td>\n");
-   data = pgmoneta_append(data, "        <td>The current/previous timeline ID in the server history</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_timeline_switchpos</h2>\n");
-   data = pgmoneta_append(data, "  The WAL switch position of a timeline on a server (showed in hex as a parameter)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>tli</td>\n");
-   data = pgmoneta_append(data, "        <td>The current/previous timeline ID in the server history</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>walpos</td>\n");
-   data = pgmoneta_append(data, "        <td>The WAL switch position of this timeline</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_workers</h2>\n");
-   data = pgmoneta_append(data, "  The number of workers for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_checksums</h2>\n");
-   data = pgmoneta_append(data, "  Are checksums enabled for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_server_summarize_wal</h2>\n");
-   data = pgmoneta_append(data, "  Are summarize_wal enabled for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_oldest</h2>\n");
-   data = pgmoneta_append(data, "  The oldest backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_newest</h2>\n");
-   data = pgmoneta_append(data, "  The newest backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_count</h2>\n");
-   data = pgmoneta_append(data, "  The number of valid backups for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup</h2>\n");
-   data = pgmoneta_append(data, "  Is the backup valid for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_version</h2>\n");
-   data = pgmoneta_append(data, "  The version of PostgreSQL for a backup\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>major</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup PostgreSQL major version</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>minor</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup PostgreSQL minor version</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_total_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The backup in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_basebackup_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for basebackup in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_manifest_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for manifest in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_compression_zstd_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for zstd compression in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_compression_gzip_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for gzip compression in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_compression_bzip2_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for bzip2 compression in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_compression_lz4_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for lz4 compression in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_encryption_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for encryption in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_linking_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for linking in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_remote_ssh_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for remote ssh in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_remote_s3_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for remote s3 in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_remote_azure_elapsed_time</h2>\n");
-   data = pgmoneta_append(data, "  The duration for remote azure in seconds for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_throughput</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the backup for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_basebackup_mbs</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the basebackup for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_manifest_mbs</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the manifest for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_compression_zstd_mbs</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the zstd compression for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_compression_gzip_mbs</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the gzip compression for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_compression_bzip2_mbs</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the bzip2 compression for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_compression_lz4_mbs</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the lz4 compression for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_encryption_mbs</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the encryption for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_linking_mbs</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the linking for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_remote_mbs</h2>\n");
-   data = pgmoneta_append(data, "  The throughput of the remote for a server (MB/s)\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_start_timeline</h2>\n");
-   data = pgmoneta_append(data, "  The starting timeline of a backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_end_timeline</h2>\n");
-   data = pgmoneta_append(data, "  The ending timeline of a backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_start_walpos</h2>\n");
-   data = pgmoneta_append(data, "  The starting WAL position of a backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>walpos</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup starting WAL position</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_checkpoint_walpos</h2>\n");
-   data = pgmoneta_append(data, "  The checkpoint WAL pos of a backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>walpos</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup checkpoint WAL position</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_end_walpos</h2>\n");
-   data = pgmoneta_append(data, "  The ending WAL pos of a backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>walpos</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup ending WAL position</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_restore_newest_size</h2>\n");
-   data = pgmoneta_append(data, "  The size of the newest restore for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_newest_size</h2>\n");
-   data = pgmoneta_append(data, "  The size of the newest backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_restore_size</h2>\n");
-   data = pgmoneta_append(data, "  The size of a restore for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_restore_size_increment</h2>\n");
-   data = pgmoneta_append(data, "  The increment size of a restore for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_size</h2>\n");
-   data = pgmoneta_append(data, "  The size of a backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_compression_ratio</h2>\n");
-   data = pgmoneta_append(data, "  The ratio of backup size to restore size for each backup\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_retain</h2>\n");
-   data = pgmoneta_append(data, "  Retain a backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>label</td>\n");
-   data = pgmoneta_append(data, "        <td>The backup label</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_backup_total_size</h2>\n");
-   data = pgmoneta_append(data, "  The total size of the backups for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_wal_total_size</h2>\n");
-   data = pgmoneta_append(data, "  The total size of the WAL for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_total_size</h2>\n");
-   data = pgmoneta_append(data, "  The total size for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_active_backup</h2>\n");
-   data = pgmoneta_append(data, "  Is there an active backup for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_active_restore</h2>\n");
-   data = pgmoneta_append(data, "  Is there an active restore for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_active_archive</h2>\n");
-   data = pgmoneta_append(data, "  Is there an active archive for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_active_delete</h2>\n");
-   data = pgmoneta_append(data, "  Is there an active delete for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_active_retention</h2>\n");
-   data = pgmoneta_append(data, "  Is there an active retention for a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_current_wal_file</h2>\n");
-   data = pgmoneta_append(data, "  The current streaming WAL filename of a server\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>file</td>\n");
-   data = pgmoneta_append(data, "        <td>The current WAL filename for this server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <h2>pgmoneta_current_wal_lsn</h2>\n");
-   data = pgmoneta_append(data, "  The current WAL log sequence number\n");
-   data = pgmoneta_append(data, "  <table border=\"1\">\n");
-   data = pgmoneta_append(data, "    <tbody>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>name</td>\n");
-   data = pgmoneta_append(data, "        <td>The identifier for the server</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "      <tr>\n");
-   data = pgmoneta_append(data, "        <td>lsn</td>\n");
-   data = pgmoneta_append(data, "        <td>The current WAL log sequence number</td>\n");
-   data = pgmoneta_append(data, "      </tr>\n");
-   data = pgmoneta_append(data, "    </tbody>\n");
-   data = pgmoneta_append(data, "  </table>\n");
-   data = pgmoneta_append(data, "  <p>\n");
-   data = pgmoneta_append(data, "  <a href=\"https://pgmoneta.github.io/\">pgmoneta.github.io/</a>\n");
-   data = pgmoneta_append(data, "</body>\n");
-   data = pgmoneta_append(data, "</html>\n");
-
-   send_chunk(client_ssl, client_fd, data);
-   free(data);
-   data = NULL;
+   pgmoneta_string_builder_reset(data);
+
+   pgmoneta_string_builder_append(data, "<html>\n");
+   pgmoneta_string_builder_append(data, "<head>\n");
+   pgmoneta_string_builder_append(data, "  <title>pgmoneta exporter</title>\n");
+   pgmoneta_string_builder_append(data, "</head>\n");
+   pgmoneta_string_builder_append(data, "<body>\n");
+   pgmoneta_string_builder_append(data, "  <h1>pgmoneta exporter</h1>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <a href=\"/metrics\">Metrics</a>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_state</h2>\n");
+   pgmoneta_string_builder_append(data, "  The state of pgmoneta\n");
+   pgmoneta_string_builder_append(data, "  <ul>\n");
+   pgmoneta_string_builder_append(data, "    <li>1 = Running</li>\n");
+   pgmoneta_string_builder_append(data, "  </ul>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_version</h2>\n");
+   pgmoneta_string_builder_append(data, "  The version of pgmoneta\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_extension</h2>\n");
+   pgmoneta_string_builder_append(data, "  The version of pgmoneta extension\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_logging_info</h2>\n");
+   pgmoneta_string_builder_append(data, "  The number of INFO logging statements\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_logging_warn</h2>\n");
+   pgmoneta_string_builder_append(data, "  The number of WARN logging statements\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_logging_error</h2>\n");
+   pgmoneta_string_builder_append(data, "  The number of ERROR logging statements\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_logging_fatal</h2>\n");
+   pgmoneta_string_builder_append(data, "  The number of FATAL logging statements\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_retention_days</h2>\n");
+   pgmoneta_string_builder_append(data, "  The retention of pgmoneta in days\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_retention_weeks</h2>\n");
+   pgmoneta_string_builder_append(data, "  The retention of pgmoneta in weeks\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_retention_months</h2>\n");
+   pgmoneta_string_builder_append(data, "  The retention of pgmoneta in months\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_retention_years</h2>\n");
+   pgmoneta_string_builder_append(data, "  The retention of pgmoneta in years\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_retention_server</h2>\n");
+   pgmoneta_string_builder_append(data, "  The retention of a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>parameter</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>days|weeks|months|years</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_compression</h2>\n");
+   pgmoneta_string_builder_append(data, "  The compression used\n");
+   pgmoneta_string_builder_append(data, "  <ul>\n");
+   pgmoneta_string_builder_append(data, "    <li>0 = None</li>\n");
+   pgmoneta_string_builder_append(data, "    <li>1 = GZip</li>\n");
+   pgmoneta_string_builder_append(data, "    <li>2 = ZSTD</li>\n");
+   pgmoneta_string_builder_append(data, "    <li>3 = LZ4</li>\n");
+   pgmoneta_string_builder_append(data, "    <li>4 = BZIP2</li>\n");
+   pgmoneta_string_builder_append(data, "  </ul>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_used_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The disk space used for pgmoneta\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_free_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The free disk space for pgmoneta\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_total_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The total disk space for pgmoneta\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_valid</h2>\n");
+   pgmoneta_string_builder_append(data, "  Is the server in a valid state\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_wal_streaming</h2>\n");
+   pgmoneta_string_builder_append(data, "  The WAL streaming status of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_wal_sync_seconds</h2>\n");
+   pgmoneta_string_builder_append(data, "  The time to sync streamed WAL to disk for a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_wal_flush_lag_seconds</h2>\n");
+   pgmoneta_string_builder_append(data, "  The time from receiving WAL until it is synced to disk for a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_operation_count</h2>\n");
+   pgmoneta_string_builder_append(data, "  The count of client operations of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_failed_operation_count</h2>\n");
+   pgmoneta_string_builder_append(data, "  The count of failed client operations of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_last_operation_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The time of the latest client operation of a server \n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_last_failed_operation_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The time of the latest failed client operation of a server \n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_wal_shipping</h2>\n");
+   pgmoneta_string_builder_append(data, "  The disk space used for WAL shipping for a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_wal_shipping_used_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The disk space used for everything under the WAL shipping directory of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_wal_shipping_free_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The free disk space for the WAL shipping directory of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_wal_shipping_total_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The total disk space for the WAL shipping directory of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_workspace</h2>\n");
+   pgmoneta_string_builder_append(data, "  The disk space used for workspace for a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_workspace_free_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The free disk space for the workspace directory of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_workspace_total_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The total disk space for the workspace directory of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_hot_standby</h2>\n");
+   pgmoneta_string_builder_append(data, "  The disk space used for hot standby for a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_hot_standby_free_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The free disk space for the hot standby directory of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_hot_standby_total_space</h2>\n");
+   pgmoneta_string_builder_append(data, "  The total disk space for the hot standby directory of a server\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_timeline</h2>\n");
+   pgmoneta_string_builder_append(data, "  The current timeline a server is on\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_parent_tli</h2>\n");
+   pgmoneta_string_builder_append(data, "  The parent timeline of a timeline on a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>tli</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The current/previous timeline ID in the server history</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_timeline_switchpos</h2>\n");
+   pgmoneta_string_builder_append(data, "  The WAL switch position of a timeline on a server (showed in hex as a parameter)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>tli</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The current/previous timeline ID in the server history</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>walpos</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The WAL switch position of this timeline</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_workers</h2>\n");
+   pgmoneta_string_builder_append(data, "  The number of workers for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_checksums</h2>\n");
+   pgmoneta_string_builder_append(data, "  Are checksums enabled for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_server_summarize_wal</h2>\n");
+   pgmoneta_string_builder_append(data, "  Are summarize_wal enabled for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_oldest</h2>\n");
+   pgmoneta_string_builder_append(data, "  The oldest backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_newest</h2>\n");
+   pgmoneta_string_builder_append(data, "  The newest backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_count</h2>\n");
+   pgmoneta_string_builder_append(data, "  The number of valid backups for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup</h2>\n");
+   pgmoneta_string_builder_append(data, "  Is the backup valid for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_verified</h2>\n");
+   pgmoneta_string_builder_append(data, "  The oldest verification of a file of the backup, 0 if a file was never verified\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_verified_files</h2>\n");
+   pgmoneta_string_builder_append(data, "  The number of files of the backup that have been verified\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_verified_failed</h2>\n");
+   pgmoneta_string_builder_append(data, "  The number of files of the backup that failed their last verification\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_version</h2>\n");
+   pgmoneta_string_builder_append(data, "  The version of PostgreSQL for a backup\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>major</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup PostgreSQL major version</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>minor</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup PostgreSQL minor version</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_total_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The backup in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_basebackup_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for basebackup in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_manifest_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for manifest in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_compression_zstd_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for zstd compression in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_compression_gzip_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for gzip compression in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_compression_bzip2_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for bzip2 compression in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_compression_lz4_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for lz4 compression in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_encryption_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for encryption in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_linking_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for linking in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_remote_ssh_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for remote ssh in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_remote_s3_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for remote s3 in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_remote_azure_elapsed_time</h2>\n");
+   pgmoneta_string_builder_append(data, "  The duration for remote azure in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_throughput</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the backup for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_basebackup_mbs</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the basebackup for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_manifest_mbs</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the manifest for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_compression_zstd_mbs</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the zstd compression for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_compression_gzip_mbs</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the gzip compression for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_compression_bzip2_mbs</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the bzip2 compression for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_compression_lz4_mbs</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the lz4 compression for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_encryption_mbs</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the encryption for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_linking_mbs</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the linking for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_remote_mbs</h2>\n");
+   pgmoneta_string_builder_append(data, "  The throughput of the remote for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_start_timeline</h2>\n");
+   pgmoneta_string_builder_append(data, "  The starting timeline of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_end_timeline</h2>\n");
+   pgmoneta_string_builder_append(data, "  The ending timeline of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_start_walpos</h2>\n");
+   pgmoneta_string_builder_append(data, "  The starting WAL position of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>walpos</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup starting WAL position</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_checkpoint_walpos</h2>\n");
+   pgmoneta_string_builder_append(data, "  The checkpoint WAL pos of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>walpos</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup checkpoint WAL position</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_end_walpos</h2>\n");
+   pgmoneta_string_builder_append(data, "  The ending WAL pos of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>walpos</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup ending WAL position</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_restore_newest_size</h2>\n");
+   pgmoneta_string_builder_append(data, "  The size of the newest restore for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_newest_size</h2>\n");
+   pgmoneta_string_builder_append(data, "  The size of the newest backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_restore_size</h2>\n");
+   pgmoneta_string_builder_append(data, "  The size of a restore for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_restore_size_increment</h2>\n");
+   pgmoneta_string_builder_append(data, "  The increment size of a restore for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_size</h2>\n");
+   pgmoneta_string_builder_append(data, "  The size of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_compression_ratio</h2>\n");
+   pgmoneta_string_builder_append(data, "  The ratio of backup size to restore size for each backup\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_retain</h2>\n");
+   pgmoneta_string_builder_append(data, "  Retain a backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>label</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The backup label</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_backup_total_size</h2>\n");
+   pgmoneta_string_builder_append(data, "  The total size of the backups for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_wal_total_size</h2>\n");
+   pgmoneta_string_builder_append(data, "  The total size of the WAL for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_total_size</h2>\n");
+   pgmoneta_string_builder_append(data, "  The total size for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_active_backup</h2>\n");
+   pgmoneta_string_builder_append(data, "  Is there an active backup for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_active_restore</h2>\n");
+   pgmoneta_string_builder_append(data, "  Is there an active restore for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_active_archive</h2>\n");
+   pgmoneta_string_builder_append(data, "  Is there an active archive for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_active_delete</h2>\n");
+   pgmoneta_string_builder_append(data, "  Is there an active delete for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_active_retention</h2>\n");
+   pgmoneta_string_builder_append(data, "  Is there an active retention for a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_current_wal_file</h2>\n");
+   pgmoneta_string_builder_append(data, "  The current streaming WAL filename of a server\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>file</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The current WAL filename for this server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <h2>pgmoneta_current_wal_lsn</h2>\n");
+   pgmoneta_string_builder_append(data, "  The current WAL log sequence number\n");
+   pgmoneta_string_builder_append(data, "  <table border=\"1\">\n");
+   pgmoneta_string_builder_append(data, "    <tbody>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>name</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The identifier for the server</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "      <tr>\n");
+   pgmoneta_string_builder_append(data, "        <td>lsn</td>\n");
+   pgmoneta_string_builder_append(data, "        <td>The current WAL log sequence number</td>\n");
+   pgmoneta_string_builder_append(data, "      </tr>\n");
+   pgmoneta_string_builder_append(data, "    </tbody>\n");
+   pgmoneta_string_builder_append(data, "  </table>\n");
+   pgmoneta_string_builder_append(data, "  <p>\n");
+   pgmoneta_string_builder_append(data, "  <a href=\"https://pgmoneta.github.io/\">pgmoneta.github.io/</a>\n");
+   pgmoneta_string_builder_append(data, "</body>\n");
+   pgmoneta_string_builder_append(data, "</html>\n");
+
+   status = send_chunk(client_ssl, client_fd, data);
+   if (status != MESSAGE_STATUS_OK)
+   {
+      goto done;
+   }
+   pgmoneta_string_builder_reset(data);
 
    /* Footer */
-   data = pgmoneta_append(data, "0\r\n\r\n");
+   pgmoneta_string_builder_append(data, "0\r\n\r\n");
+   if (data->error)
+   {
+      status = MESSAGE_STATUS_ERROR;
+      goto done;
+   }
 
    msg.kind = 0;
-   msg.length = strlen(data);
-   msg.data = data;
+   msg.length = data->length;
+   msg.data = data->data;
 
    status = pgmoneta_write_message(client_ssl, client_fd, &msg);
 
 done:
-   if (data != NULL)
-   {
-      free(data);
-   }
+   pgmoneta_string_builder_destroy(data);
 
    return status;
 }
@@ -1323,7 +1427,7 @@ done:
 static int
 metrics_page(SSL* client_ssl, int client_fd)
 {
-   char* data = NULL;
+   struct string_builder* data = NULL;
    time_t now;
    char time_buf[32];
    int status;
@@ -1363,39 +1467,62 @@ retry_cache_locking:
          ctime_r(&now, &time_buf[0]);
          time_buf[strlen(time_buf) - 1] = 0;
 
-         data = pgmoneta_append(data, "HTTP/1.1 200 OK\r\n");
-         data = pgmoneta_append(data, "Content-Type: text/plain; version=0.0.1; charset=utf-8\r\n");
-         data = pgmoneta_append(data, "Date: ");
-         data = pgmoneta_append(data, &time_buf[0]);
-         data = pgmoneta_append(data, "\r\n");
-         data = pgmoneta_append(data, "Transfer-Encoding: chunked\r\n");
-         data = pgmoneta_append(data, "\r\n");
-         metrics_cache_append(data);
+         if (pgmoneta_string_builder_create(CHUNK_SIZE, &data))
+         {
+            atomic_store(&cache->lock, STATE_FREE);
+            goto error;
+         }
+
+         pgmoneta_string_builder_append(data, "HTTP/1.1 200 OK\r\n");
+         pgmoneta_string_builder_append(data, "Content-Type: text/plain; version=0.0.1; charset=utf-8\r\n");
+         pgmoneta_string_builder_append(data, "Date: ");
+         pgmoneta_string_builder_append(data, &time_buf[0]);
+         pgmoneta_string_builder_append(data, "\r\n");
+         pgmoneta_string_builder_append(data, "Transfer-Encoding: chunked\r\n");
+         pgmoneta_string_builder_append(data, "\r\n");
+
+         if (data->error)
+         {
+            atomic_store(&cache->lock, STATE_FREE);
+            goto error;
+         }
+
+         metrics_cache_append(data->data);
 
          msg.kind = 0;
-         msg.length = strlen(data);
-         msg.data = data;
+         msg.length = data->length;
+         msg.data = data->data;
 
          status = pgmoneta_write_message(client_ssl, client_fd, &msg);
          if (status != MESSAGE_STATUS_OK)
          {
+            metrics_cache_invalidate();
+            atomic_store(&cache->lock, STATE_FREE);
             goto error;
          }
 
-         free(data);
-         data = NULL;
+         pgmoneta_string_builder_reset(data);
 
-         general_information(client_ssl, client_fd);
-         backup_information(client_ssl, client_fd);
-         size_information(client_ssl, client_fd);
+         general_information(client_ssl, client_fd, data);
+         backup_information(client_ssl, client_fd, data);
+         size_information(client_ssl, client_fd, data);
 
          /* Footer */
-         data = pgmoneta_append(data, "0\r\n\r\n");
-         metrics_cache_append(data);
+         pgmoneta_string_builder_append(data, "0\r\n\r\n");
+
+         /* A failed append or chunk leaves the page incomplete, so it is neither sent nor cached */
+         if (data->error)
+         {
+            metrics_cache_invalidate();
+            atomic_store(&cache->lock, STATE_FREE);
+            goto error;
+         }
+
+         metrics_cache_append(data->data);
 
          msg.kind = 0;
-         msg.length = strlen(data);
-         msg.data = data;
+         msg.length = data->length;
+         msg.data = data->data;
 
          metrics_cache_finalize();
       }
@@ -1415,13 +1542,13 @@ retry_cache_locking:
       goto error;
    }
 
-   free(data);
+   pgmoneta_string_builder_destroy(data);
 
    return 0;
 
 error:
 
-   free(data);
+   pgmoneta_string_builder_destroy(data);
 
    return 1;
 }
@@ -1461,12 +1588,11 @@ bad_request(SSL* client_ssl, int client_fd)
 }
 
 static void
-general_information(SSL* client_ssl, int client_fd)
+general_information(SSL* client_ssl, int client_fd, struct string_builder* data)
 {
    char* d;
    unsigned long size;
    int retention;
-   char* data = NULL;
    time_t t;
    char time_str[128];
    struct tm* time_info;
@@ -1474,148 +1600,141 @@ general_information(SSL* client_ssl, int client_fd)
 
    config = (struct main_configuration*)shmem;
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_state The state of pgmoneta\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_state gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_state ");
-   data = pgmoneta_append(data, "1");
-   data = pgmoneta_append(data, "\n\n");
-   data = pgmoneta_append(data, "#HELP pgmoneta_version The version of pgmoneta\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_version gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_version{version=\"");
-   data = pgmoneta_append(data, VERSION);
-   data = pgmoneta_append(data, "\"} 1");
-   data = pgmoneta_append(data, "\n\n");
-   data = pgmoneta_append(data, "#HELP pgmoneta_logging_info The number of INFO logging statements\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_logging_info gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_logging_info ");
-   data = pgmoneta_append_ulong(data, atomic_load(&config->common.prometheus.logging_info));
-   data = pgmoneta_append(data, "\n\n");
-   data = pgmoneta_append(data, "#HELP pgmoneta_logging_warn The number of WARN logging statements\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_logging_warn gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_logging_warn ");
-   data = pgmoneta_append_ulong(data, atomic_load(&config->common.prometheus.logging_warn));
-   data = pgmoneta_append(data, "\n\n");
-   data = pgmoneta_append(data, "#HELP pgmoneta_logging_error The number of ERROR logging statements\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_logging_error gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_logging_error ");
-   data = pgmoneta_append_ulong(data, atomic_load(&config->common.prometheus.logging_error));
-   data = pgmoneta_append(data, "\n\n");
-   data = pgmoneta_append(data, "#HELP pgmoneta_logging_fatal The number of FATAL logging statements\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_logging_fatal gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_logging_fatal ");
-   data = pgmoneta_append_ulong(data, atomic_load(&config->common.prometheus.logging_fatal));
-   data = pgmoneta_append(data, "\n\n");
-   data = pgmoneta_append(data, "#HELP pgmoneta_retention_days The retention days of pgmoneta\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_retention_days gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_retention_days ");
-   data = pgmoneta_append_int(data, config->retention_days <= 0 ? 0 : config->retention_days);
-   data = pgmoneta_append(data, "\n\n");
-
-   data = pgmoneta_append(data, "#HELP pgmoneta_retention_weeks The retention weeks of pgmoneta\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_retention_weeks gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_retention_weeks ");
-   data = pgmoneta_append_int(data, config->retention_weeks <= 0 ? 0 : config->retention_weeks);
-   data = pgmoneta_append(data, "\n\n");
-
-   data = pgmoneta_append(data, "#HELP pgmoneta_retention_months The retention months of pgmoneta\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_retention_months gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_retention_months ");
-   data = pgmoneta_append_int(data, config->retention_months <= 0 ? 0 : config->retention_months);
-   data = pgmoneta_append(data, "\n\n");
-
-   data = pgmoneta_append(data, "#HELP pgmoneta_retention_years The retention years of pgmoneta\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_retention_years gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_retention_years ");
-   data = pgmoneta_append_int(data, config->retention_years <= 0 ? 0 : config->retention_years);
-   data = pgmoneta_append(data, "\n\n");
-
-   data = pgmoneta_append(data, "#HELP pgmoneta_retention_server The retention of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_retention_server gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_state The state of pgmoneta\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_state gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_state ");
+   pgmoneta_string_builder_append(data, "1");
+   pgmoneta_string_builder_append(data, "\n\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_version The version of pgmoneta\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_version gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_version{version=\"");
+   pgmoneta_string_builder_append(data, VERSION);
+   pgmoneta_string_builder_append(data, "\"} 1");
+   pgmoneta_string_builder_append(data, "\n\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_logging_info The number of INFO logging statements\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_logging_info gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_logging_info ");
+   pgmoneta_string_builder_append_ulong(data, atomic_load(&config->common.prometheus.logging_info));
+   pgmoneta_string_builder_append(data, "\n\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_logging_warn The number of WARN logging statements\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_logging_warn gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_logging_warn ");
+   pgmoneta_string_builder_append_ulong(data, atomic_load(&config->common.prometheus.logging_warn));
+   pgmoneta_string_builder_append(data, "\n\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_logging_error The number of ERROR logging statements\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_logging_error gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_logging_error ");
+   pgmoneta_string_builder_append_ulong(data, atomic_load(&config->common.prometheus.logging_error));
+   pgmoneta_string_builder_append(data, "\n\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_logging_fatal The number of FATAL logging statements\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_logging_fatal gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_logging_fatal ");
+   pgmoneta_string_builder_append_ulong(data, atomic_load(&config->common.prometheus.logging_fatal));
+   pgmoneta_string_builder_append(data, "\n\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_retention_days The retention days of pgmoneta\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_retention_days gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_retention_days ");
+   pgmoneta_string_builder_append_int(data, config->retention_days <= 0 ? 0 : config->retention_days);
+   pgmoneta_string_builder_append(data, "\n\n");
+
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_retention_weeks The retention weeks of pgmoneta\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_retention_weeks gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_retention_weeks ");
+   pgmoneta_string_builder_append_int(data, config->retention_weeks <= 0 ? 0 : config->retention_weeks);
+   pgmoneta_string_builder_append(data, "\n\n");
+
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_retention_months The retention months of pgmoneta\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_retention_months gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_retention_months ");
+   pgmoneta_string_builder_append_int(data, config->retention_months <= 0 ? 0 : config->retention_months);
+   pgmoneta_string_builder_append(data, "\n\n");
+
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_retention_years The retention years of pgmoneta\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_retention_years gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_retention_years ");
+   pgmoneta_string_builder_append_int(data, config->retention_years <= 0 ? 0 : config->retention_years);
+   pgmoneta_string_builder_append(data, "\n\n");
+
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_retention_server The retention of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_retention_server gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_retention_server{");
+      pgmoneta_string_builder_append(data, "pgmoneta_retention_server{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"");
-      data = pgmoneta_append(data, ", ");
-      data = pgmoneta_append(data, "parameter=\"days\"");
-      data = pgmoneta_append(data, "} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"");
+      pgmoneta_string_builder_append(data, ", ");
+      pgmoneta_string_builder_append(data, "parameter=\"days\"");
+      pgmoneta_string_builder_append(data, "} ");
       retention = config->common.servers[i].retention_days;
       if (retention <= 0)
       {
          retention = config->retention_days;
       }
-      data = pgmoneta_append_int(data, retention <= 0 ? 0 : retention);
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append_int(data, retention <= 0 ? 0 : retention);
+      pgmoneta_string_builder_append(data, "\n");
 
-      data = pgmoneta_append(data, "pgmoneta_retention_server{");
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"");
-      data = pgmoneta_append(data, ", ");
-      data = pgmoneta_append(data, "parameter=\"weeks\"");
-      data = pgmoneta_append(data, "} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_retention_server{");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"");
+      pgmoneta_string_builder_append(data, ", ");
+      pgmoneta_string_builder_append(data, "parameter=\"weeks\"");
+      pgmoneta_string_builder_append(data, "} ");
       retention = config->common.servers[i].retention_weeks;
       if (retention <= 0)
       {
          retention = config->retention_weeks;
       }
-      data = pgmoneta_append_int(data, retention <= 0 ? 0 : retention);
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append_int(data, retention <= 0 ? 0 : retention);
+      pgmoneta_string_builder_append(data, "\n");
 
-      data = pgmoneta_append(data, "pgmoneta_retention_server{");
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"");
-      data = pgmoneta_append(data, ", ");
-      data = pgmoneta_append(data, "parameter=\"months\"");
-      data = pgmoneta_append(data, "} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_retention_server{");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"");
+      pgmoneta_string_builder_append(data, ", ");
+      pgmoneta_string_builder_append(data, "parameter=\"months\"");
+      pgmoneta_string_builder_append(data, "} ");
       retention = config->common.servers[i].retention_months;
       if (retention <= 0)
       {
          retention = config->retention_months;
       }
-      data = pgmoneta_append_int(data, retention <= 0 ? 0 : retention);
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append_int(data, retention <= 0 ? 0 : retention);
+      pgmoneta_string_builder_append(data, "\n");
 
-      data = pgmoneta_append(data, "pgmoneta_retention_server{");
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"");
-      data = pgmoneta_append(data, ", ");
-      data = pgmoneta_append(data, "parameter=\"years\"");
-      data = pgmoneta_append(data, "} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_retention_server{");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"");
+      pgmoneta_string_builder_append(data, ", ");
+      pgmoneta_string_builder_append(data, "parameter=\"years\"");
+      pgmoneta_string_builder_append(data, "} ");
       retention = config->common.servers[i].retention_years;
       if (retention <= 0)
       {
          retention = config->retention_years;
       }
-      data = pgmoneta_append_int(data, retention <= 0 ? 0 : retention);
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append_int(data, retention <= 0 ? 0 : retention);
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
-
-   data = pgmoneta_append(data, "#HELP pgmoneta_compression The compression used\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_compression gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_compression ");
-   data = pgmoneta_append_int(data, config->compression_type);
-   data = pgmoneta_append(data, "\n\n");
-
-   d = NULL;
+   pgmoneta_string_builder_append(data, "\n");
 
-   d = pgmoneta_append(d, config->base_dir);
-   d = pgmoneta_append(d, "/");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_compression The compression used\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_compression gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_compression ");
+   pgmoneta_string_builder_append_int(data, config->compression_type);
+   pgmoneta_string_builder_append(data, "\n\n");
 
-   size = pgmoneta_directory_size(d);
+   size = pgmoneta_space_used();
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_used_space The disk space used for pgmoneta\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_used_space gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_used_space ");
-   data = pgmoneta_append_ulong(data, size);
-   data = pgmoneta_append(data, "\n\n");
-
-   free(d);
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_used_space The disk space used for pgmoneta\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_used_space gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_used_space ");
+   pgmoneta_string_builder_append_ulong(data, size);
+   pgmoneta_string_builder_append(data, "\n\n");
 
    d = NULL;
 
@@ -1624,11 +1743,11 @@ general_information(SSL* client_ssl, int client_fd)
 
    size = pgmoneta_free_space(d);
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_free_space The free disk space for pgmoneta\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_free_space gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_free_space ");
-   data = pgmoneta_append_ulong(data, size);
-   data = pgmoneta_append(data, "\n\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_free_space The free disk space for pgmoneta\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_free_space gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_free_space ");
+   pgmoneta_string_builder_append_ulong(data, size);
+   pgmoneta_string_builder_append(data, "\n\n");
 
    free(d);
 
@@ -1639,395 +1758,348 @@ general_information(SSL* client_ssl, int client_fd)
 
    size = pgmoneta_total_space(d);
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_total_space The total disk space for pgmoneta\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_total_space gauge\n");
-   data = pgmoneta_append(data, "pgmoneta_total_space ");
-   data = pgmoneta_append_ulong(data, size);
-   data = pgmoneta_append(data, "\n\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_total_space The total disk space for pgmoneta\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_total_space gauge\n");
+   pgmoneta_string_builder_append(data, "pgmoneta_total_space ");
+   pgmoneta_string_builder_append_ulong(data, size);
+   pgmoneta_string_builder_append(data, "\n\n");
 
    free(d);
 
    d = NULL;
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_wal_shipping The disk space used for WAL shipping for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_wal_shipping gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_wal_shipping The disk space used for WAL shipping for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_wal_shipping gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_wal_shipping{");
+      pgmoneta_string_builder_append(data, "pgmoneta_wal_shipping{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      d = pgmoneta_get_server_wal_shipping_wal(i);
+      size = pgmoneta_space_get(i, SPACE_WAL_SHIPPING);
+      pgmoneta_string_builder_append_ulong(data, size);
 
-      if (d != NULL)
-      {
-         size = pgmoneta_directory_size(d);
-         data = pgmoneta_append_ulong(data, size);
-      }
-      else
-      {
-         data = pgmoneta_append_ulong(data, 0);
-      }
-
-      data = pgmoneta_append(data, "\n");
-
-      free(d);
-      d = NULL;
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_wal_shipping_used_space The disk space used for WAL shipping of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_wal_shipping_used_space gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_wal_shipping_used_space The disk space used for WAL shipping of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_wal_shipping_used_space gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_wal_shipping_used_space{");
-
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_wal_shipping_used_space{");
 
-      d = pgmoneta_get_server_wal_shipping(i);
-      if (d != NULL)
-      {
-         size = pgmoneta_directory_size(d);
-         data = pgmoneta_append_ulong(data, size);
-      }
-      else
-      {
-         data = pgmoneta_append_ulong(data, 0);
-      }
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append(data, "\n");
+      size = pgmoneta_space_get(i, SPACE_WAL_SHIPPING);
+      pgmoneta_string_builder_append_ulong(data, size);
 
-      free(d);
-      d = NULL;
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_wal_shipping_free_space The free disk space for WAL shipping of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_wal_shipping_free_space gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_wal_shipping_free_space The free disk space for WAL shipping of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_wal_shipping_free_space gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_wal_shipping_free_space{");
+      pgmoneta_string_builder_append(data, "pgmoneta_wal_shipping_free_space{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       d = pgmoneta_get_server_wal_shipping(i);
 
       if (d != NULL)
       {
          size = pgmoneta_free_space(d);
-         data = pgmoneta_append_ulong(data, size);
+         pgmoneta_string_builder_append_ulong(data, size);
       }
       else
       {
-         data = pgmoneta_append_ulong(data, 0);
+         pgmoneta_string_builder_append_ulong(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       free(d);
       d = NULL;
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_wal_shipping_total_space The total disk space for WAL shipping of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_wal_shipping_total_space gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_wal_shipping_total_space The total disk space for WAL shipping of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_wal_shipping_total_space gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_wal_shipping_total_space{");
+      pgmoneta_string_builder_append(data, "pgmoneta_wal_shipping_total_space{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       d = pgmoneta_get_server_wal_shipping(i);
 
       if (d != NULL)
       {
          size = pgmoneta_total_space(d);
-         data = pgmoneta_append_ulong(data, size);
+         pgmoneta_string_builder_append_ulong(data, size);
       }
       else
       {
-         data = pgmoneta_append_ulong(data, 0);
+         pgmoneta_string_builder_append_ulong(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       free(d);
       d = NULL;
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
    free(d);
 
    d = NULL;
 
    /* workspace */
-   data = pgmoneta_append(data, "#HELP pgmoneta_workspace The disk space used for workspace for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_workspace gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_workspace The disk space used for workspace for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_workspace gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_workspace{");
+      pgmoneta_string_builder_append(data, "pgmoneta_workspace{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      d = pgmoneta_get_server_workspace(i);
+      size = pgmoneta_space_get(i, SPACE_WORKSPACE);
+      pgmoneta_string_builder_append_ulong(data, size);
 
-      if (d != NULL)
-      {
-         size = pgmoneta_directory_size(d);
-         data = pgmoneta_append_ulong(data, size);
-      }
-      else
-      {
-         data = pgmoneta_append_ulong(data, 0);
-      }
-
-      data = pgmoneta_append(data, "\n");
-
-      free(d);
-      d = NULL;
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_workspace_free_space The free disk space for workspace of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_workspace_free_space gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_workspace_free_space The free disk space for workspace of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_workspace_free_space gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_workspace_free_space{");
+      pgmoneta_string_builder_append(data, "pgmoneta_workspace_free_space{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       d = pgmoneta_get_server_workspace(i);
 
       if (d != NULL)
       {
          size = pgmoneta_free_space(d);
-         data = pgmoneta_append_ulong(data, size);
+         pgmoneta_string_builder_append_ulong(data, size);
       }
       else
       {
-         data = pgmoneta_append_ulong(data, 0);
+         pgmoneta_string_builder_append_ulong(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       free(d);
       d = NULL;
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_workspace_total_space The total disk space for workspace of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_workspace_total_space gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_workspace_total_space The total disk space for workspace of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_workspace_total_space gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_workspace_total_space{");
+      pgmoneta_string_builder_append(data, "pgmoneta_workspace_total_space{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       d = pgmoneta_get_server_workspace(i);
 
       if (d != NULL)
       {
          size = pgmoneta_total_space(d);
-         data = pgmoneta_append_ulong(data, size);
+         pgmoneta_string_builder_append_ulong(data, size);
       }
       else
       {
-         data = pgmoneta_append_ulong(data, 0);
+         pgmoneta_string_builder_append_ulong(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       free(d);
       d = NULL;
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
    /* hot_standby */
-   data = pgmoneta_append(data, "#HELP pgmoneta_hot_standby The disk space used for hot standby for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_hot_standby gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_hot_standby The disk space used for hot standby for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_hot_standby gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_hot_standby{");
-
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_hot_standby{");
 
-      d = pgmoneta_get_server_hot_standby(i);
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      if (d != NULL)
-      {
-         size = pgmoneta_directory_size(d);
-         data = pgmoneta_append_ulong(data, size);
-      }
-      else
-      {
-         data = pgmoneta_append_ulong(data, 0);
-      }
+      size = pgmoneta_space_get(i, SPACE_HOT_STANDBY);
+      pgmoneta_string_builder_append_ulong(data, size);
 
-      data = pgmoneta_append(data, "\n");
-
-      free(d);
-      d = NULL;
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_hot_standby_free_space The free disk space for hot standby of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_hot_standby_free_space gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_hot_standby_free_space The free disk space for hot standby of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_hot_standby_free_space gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_hot_standby_free_space{");
+      pgmoneta_string_builder_append(data, "pgmoneta_hot_standby_free_space{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       d = pgmoneta_get_server_hot_standby(i);
 
       if (d != NULL)
       {
          size = pgmoneta_free_space(d);
-         data = pgmoneta_append_ulong(data, size);
+         pgmoneta_string_builder_append_ulong(data, size);
       }
       else
       {
-         data = pgmoneta_append_ulong(data, 0);
+         pgmoneta_string_builder_append_ulong(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       free(d);
       d = NULL;
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_hot_standby_total_space The total disk space for hot standby of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_hot_standby_total_space gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_hot_standby_total_space The total disk space for hot standby of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_hot_standby_total_space gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_hot_standby_total_space{");
+      pgmoneta_string_builder_append(data, "pgmoneta_hot_standby_total_space{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       d = pgmoneta_get_server_hot_standby(i);
 
       if (d != NULL)
       {
          size = pgmoneta_total_space(d);
-         data = pgmoneta_append_ulong(data, size);
+         pgmoneta_string_builder_append_ulong(data, size);
       }
       else
       {
-         data = pgmoneta_append_ulong(data, 0);
+         pgmoneta_string_builder_append_ulong(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       free(d);
       d = NULL;
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_timeline The current timeline a server is on\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_timeline counter\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_timeline The current timeline a server is on\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_timeline counter\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_server_timeline{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_timeline{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_int(data, config->common.servers[i].cur_timeline);
+      pgmoneta_string_builder_append_int(data, config->common.servers[i].cur_timeline);
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_parent_tli The parent timeline of a timeline on a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_parent_tli gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_parent_tli The parent timeline of a timeline on a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_parent_tli gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       struct timeline_history* history = NULL;
       struct timeline_history* curh = NULL;
       int tli = 2;
 
-      data = pgmoneta_append(data, "pgmoneta_server_parent_tli{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_parent_tli{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\", ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\", ");
 
-      data = pgmoneta_append(data, "tli=\"");
-      data = pgmoneta_append_int(data, 1);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "tli=\"");
+      pgmoneta_string_builder_append_int(data, 1);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_int(data, 0);
+      pgmoneta_string_builder_append_int(data, 0);
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       pgmoneta_get_timeline_history(i, config->common.servers[i].cur_timeline, &history);
       curh = history;
       while (curh != NULL)
       {
-         data = pgmoneta_append(data, "pgmoneta_server_parent_tli{");
+         pgmoneta_string_builder_append(data, "pgmoneta_server_parent_tli{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", ");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", ");
 
-         data = pgmoneta_append(data, "tli=\"");
-         data = pgmoneta_append_int(data, tli);
-         data = pgmoneta_append(data, "\"} ");
+         pgmoneta_string_builder_append(data, "tli=\"");
+         pgmoneta_string_builder_append_int(data, tli);
+         pgmoneta_string_builder_append(data, "\"} ");
 
-         data = pgmoneta_append_int(data, curh->parent_tli);
+         pgmoneta_string_builder_append_int(data, curh->parent_tli);
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
 
          curh = curh->next;
          tli++;
       }
       pgmoneta_free_timeline_history(history);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_timeline_switchpos The WAL switch position of a timeline on a server (showed in hex as a parameter)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_timeline_switchpos gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_timeline_switchpos The WAL switch position of a timeline on a server (showed in hex as a parameter)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_timeline_switchpos gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       struct timeline_history* history = NULL;
       struct timeline_history* curh = NULL;
       int tli = 2;
 
-      data = pgmoneta_append(data, "pgmoneta_server_timeline_switchpos{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_timeline_switchpos{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\", ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\", ");
 
-      data = pgmoneta_append(data, "tli=\"1\", ");
+      pgmoneta_string_builder_append(data, "tli=\"1\", ");
 
-      data = pgmoneta_append(data, "walpos=\"0/0\"} ");
+      pgmoneta_string_builder_append(data, "walpos=\"0/0\"} ");
 
-      data = pgmoneta_append(data, "1");
+      pgmoneta_string_builder_append(data, "1");
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       pgmoneta_get_timeline_history(i, config->common.servers[i].cur_timeline, &history);
       curh = history;
@@ -2037,122 +2109,140 @@ general_information(SSL* client_ssl, int client_fd)
          memset(xlogpos, 0, MISC_LENGTH);
          snprintf(xlogpos, MISC_LENGTH, "%X/%X", curh->switchpos_hi, curh->switchpos_lo);
 
-         data = pgmoneta_append(data, "pgmoneta_server_timeline_switchpos{");
+         pgmoneta_string_builder_append(data, "pgmoneta_server_timeline_switchpos{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", ");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", ");
 
-         data = pgmoneta_append(data, "tli=\"");
-         data = pgmoneta_append_int(data, tli);
-         data = pgmoneta_append(data, "\", ");
+         pgmoneta_string_builder_append(data, "tli=\"");
+         pgmoneta_string_builder_append_int(data, tli);
+         pgmoneta_string_builder_append(data, "\", ");
 
-         data = pgmoneta_append(data, "walpos=\"");
-         data = pgmoneta_append(data, xlogpos);
-         data = pgmoneta_append(data, "\"} ");
+         pgmoneta_string_builder_append(data, "walpos=\"");
+         pgmoneta_string_builder_append(data, xlogpos);
+         pgmoneta_string_builder_append(data, "\"} ");
 
-         data = pgmoneta_append_int(data, 1);
+         pgmoneta_string_builder_append_int(data, 1);
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
 
          curh = curh->next;
          tli++;
       }
       pgmoneta_free_timeline_history(history);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_workers The numbeer of workers for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_workers gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_workers The numbeer of workers for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_workers gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       int workers = config->common.servers[i].workers != -1 ? config->common.servers[i].workers : config->workers;
 
-      data = pgmoneta_append(data, "pgmoneta_server_workers{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_workers{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_int(data, workers);
+      pgmoneta_string_builder_append_int(data, workers);
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_valid Is the server in a valid state\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_valid gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_valid Is the server in a valid state\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_valid gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_server_valid{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_valid{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_bool(data, config->common.servers[i].valid);
+      pgmoneta_string_builder_append_bool(data, config->common.servers[i].valid);
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_wal_streaming The WAL streaming status of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_wal_streaming gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_wal_streaming The WAL streaming status of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_wal_streaming gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_wal_streaming{");
+      pgmoneta_string_builder_append(data, "pgmoneta_wal_streaming{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_bool(data, config->common.servers[i].wal_streaming);
+      pgmoneta_string_builder_append_bool(data, config->common.servers[i].wal_streaming);
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_operation_count The count of client operations of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_operation_count gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_wal_sync_seconds The time to sync streamed WAL to disk for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_wal_sync_seconds histogram\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_server_operation_count{");
+      append_histogram(data, "pgmoneta_wal_sync_seconds", config->common.servers[i].name,
+                              &config->common.servers[i].wal_sync_duration);
+   }
+   pgmoneta_string_builder_append(data, "\n");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_wal_flush_lag_seconds The time from receiving WAL until it is synced to disk for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_wal_flush_lag_seconds histogram\n");
+   for (int i = 0; i < config->common.number_of_servers; i++)
+   {
+      append_histogram(data, "pgmoneta_wal_flush_lag_seconds", config->common.servers[i].name,
+                              &config->common.servers[i].wal_flush_lag);
+   }
+   pgmoneta_string_builder_append(data, "\n");
 
-      data = pgmoneta_append_ulong(data, atomic_load(&config->common.servers[i].operation_count));
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_operation_count The count of client operations of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_operation_count gauge\n");
+   for (int i = 0; i < config->common.number_of_servers; i++)
+   {
+      pgmoneta_string_builder_append(data, "pgmoneta_server_operation_count{");
+
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append_ulong(data, atomic_load(&config->common.servers[i].operation_count));
+
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_failed_operation_count The count of failed client operations of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_failed_operation_count gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_failed_operation_count The count of failed client operations of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_failed_operation_count gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_server_failed_operation_count{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_failed_operation_count{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_ulong(data, atomic_load(&config->common.servers[i].failed_operation_count));
+      pgmoneta_string_builder_append_ulong(data, atomic_load(&config->common.servers[i].failed_operation_count));
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_last_operation_time The time of the latest client operation of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_last_operation_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_last_operation_time The time of the latest client operation of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_last_operation_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_server_last_operation_time{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_last_operation_time{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       if (atomic_load(&config->common.servers[i].operation_count) > 0)
       {
@@ -2161,26 +2251,26 @@ general_information(SSL* client_ssl, int client_fd)
          time_info = localtime(&t);
          strftime(&time_str[0], sizeof(time_str), "%Y%m%d%H%M%S", time_info);
 
-         data = pgmoneta_append(data, time_str);
+         pgmoneta_string_builder_append(data, time_str);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_last_failed_operation_time The time of the latest failed client operation of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_last_failed_operation_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_last_failed_operation_time The time of the latest failed client operation of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_last_failed_operation_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_server_last_failed_operation_time{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_last_failed_operation_time{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       if (atomic_load(&config->common.servers[i].failed_operation_count) > 0)
       {
@@ -2189,114 +2279,112 @@ general_information(SSL* client_ssl, int client_fd)
          time_info = localtime(&t);
          strftime(&time_str[0], sizeof(time_str), "%Y%m%d%H%M%S", time_info);
 
-         data = pgmoneta_append(data, time_str);
+         pgmoneta_string_builder_append(data, time_str);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_checksums Are checksums enabled\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_checksums gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_checksums Are checksums enabled\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_checksums gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_server_checksums{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_checksums{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       if (config->common.servers[i].checksums)
       {
-         data = pgmoneta_append_int(data, 1);
+         pgmoneta_string_builder_append_int(data, 1);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_server_summarize_wal Is summarize_wal enabled\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_server_summarize_wal gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_server_summarize_wal Is summarize_wal enabled\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_server_summarize_wal gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_server_summarize_wal{");
+      pgmoneta_string_builder_append(data, "pgmoneta_server_summarize_wal{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       if (config->common.servers[i].summarize_wal)
       {
-         data = pgmoneta_append_int(data, 1);
+         pgmoneta_string_builder_append_int(data, 1);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_extension The version of pgmoneta extension\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_extension gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_extension The version of pgmoneta extension\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_extension gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_extension{");
+      pgmoneta_string_builder_append(data, "pgmoneta_extension{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"");
-      data = pgmoneta_append(data, ", ");
-      data = pgmoneta_append(data, "version=\"");
-      data = pgmoneta_append(data, config->common.servers[i].ext_version);
-      data = pgmoneta_append(data, "\"");
-      data = pgmoneta_append(data, "} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"");
+      pgmoneta_string_builder_append(data, ", ");
+      pgmoneta_string_builder_append(data, "version=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].ext_version);
+      pgmoneta_string_builder_append(data, "\"");
+      pgmoneta_string_builder_append(data, "} ");
       if (config->common.servers[i].ext_valid)
       {
-         data = pgmoneta_append_int(data, 1);
+         pgmoneta_string_builder_append_int(data, 1);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 }
 
 static void
-backup_information(SSL* client_ssl, int client_fd)
+backup_information(SSL* client_ssl, int client_fd, struct string_builder* data)
 {
    char* d;
    int number_of_backups;
    struct backup** backups;
    bool valid;
    int valid_count;
-   char* data = NULL;
    struct main_configuration* config;
 
    config = (struct main_configuration*)shmem;
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_oldest The oldest backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_oldest gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_oldest The oldest backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_oldest gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2306,28 +2394,28 @@ backup_information(SSL* client_ssl, int client_fd)
 
       pgmoneta_get_backups(d, &number_of_backups, &backups);
 
-      data = pgmoneta_append(data, "pgmoneta_backup_oldest{");
+      pgmoneta_string_builder_append(data, "pgmoneta_backup_oldest{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       valid = false;
       for (int j = 0; !valid && j < number_of_backups; j++)
       {
          if (backups[j]->valid == VALID_TRUE)
          {
-            data = pgmoneta_append(data, backups[j]->label);
+            pgmoneta_string_builder_append(data, backups[j]->label);
             valid = true;
          }
       }
 
       if (!valid)
       {
-         data = pgmoneta_append(data, "0");
+         pgmoneta_string_builder_append(data, "0");
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       for (int j = 0; j < number_of_backups; j++)
       {
@@ -2337,18 +2425,17 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_newest The newest backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_newest gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_newest The newest backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_newest gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2358,28 +2445,28 @@ backup_information(SSL* client_ssl, int client_fd)
 
       pgmoneta_get_backups(d, &number_of_backups, &backups);
 
-      data = pgmoneta_append(data, "pgmoneta_backup_newest{");
+      pgmoneta_string_builder_append(data, "pgmoneta_backup_newest{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       valid = false;
       for (int j = number_of_backups - 1; !valid && j >= 0; j--)
       {
          if (backups[j]->valid == VALID_TRUE)
          {
-            data = pgmoneta_append(data, backups[j]->label);
+            pgmoneta_string_builder_append(data, backups[j]->label);
             valid = true;
          }
       }
 
       if (!valid)
       {
-         data = pgmoneta_append(data, "0");
+         pgmoneta_string_builder_append(data, "0");
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       for (int j = 0; j < number_of_backups; j++)
       {
@@ -2389,10 +2476,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_count The number of valid backups for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_count gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_count The number of valid backups for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_count gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2402,11 +2489,11 @@ backup_information(SSL* client_ssl, int client_fd)
 
       pgmoneta_get_backups(d, &number_of_backups, &backups);
 
-      data = pgmoneta_append(data, "pgmoneta_backup_count{");
+      pgmoneta_string_builder_append(data, "pgmoneta_backup_count{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       valid_count = 0;
       for (int j = 0; j < number_of_backups; j++)
@@ -2417,9 +2504,9 @@ backup_information(SSL* client_ssl, int client_fd)
          }
       }
 
-      data = pgmoneta_append_int(data, valid_count);
+      pgmoneta_string_builder_append_int(data, valid_count);
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       for (int j = 0; j < number_of_backups; j++)
       {
@@ -2429,18 +2516,17 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup Is the backup valid for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup Is the backup valid for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2456,29 +2542,153 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_int(data, backups[j]->valid);
+               pgmoneta_string_builder_append_int(data, backups[j]->valid);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup{");
+
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
+
+         pgmoneta_string_builder_append(data, "\n");
+      }
+
+      for (int j = 0; j < number_of_backups; j++)
+      {
+         free(backups[j]);
+      }
+      free(backups);
+
+      free(d);
+   }
+   pgmoneta_string_builder_append(data, "\n");
+
+   if (data->length > 0)
+   {
+      send_chunk(client_ssl, client_fd, data);
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
+   }
+
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_verified The oldest verification of a file of the backup, 0 if a file was never verified\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_verified gauge\n");
+   for (int i = 0; i < config->common.number_of_servers; i++)
+   {
+      d = pgmoneta_get_server_backup(i);
+
+      number_of_backups = 0;
+      backups = NULL;
+
+      pgmoneta_get_backups(d, &number_of_backups, &backups);
+
+      for (int j = 0; j < number_of_backups; j++)
+      {
+         if (backups[j] != NULL && backups[j]->valid == VALID_TRUE)
+         {
+            pgmoneta_string_builder_append(data, "pgmoneta_backup_verified{");
+
+            pgmoneta_string_builder_append(data, "name=\"");
+            pgmoneta_string_builder_append(data, config->common.servers[i].name);
+            pgmoneta_string_builder_append(data, "\", label=\"");
+            pgmoneta_string_builder_append(data, backups[j]->label);
+            pgmoneta_string_builder_append(data, "\"} ");
+
+            pgmoneta_string_builder_append_ulong(data, (unsigned long)backups[j]->verified);
+
+            pgmoneta_string_builder_append(data, "\n");
+         }
+      }
+
+      for (int j = 0; j < number_of_backups; j++)
+      {
+         free(backups[j]);
+      }
+      free(backups);
+
+      free(d);
+   }
+   pgmoneta_string_builder_append(data, "\n");
+
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_verified_files The number of files of the backup that have been verified\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_verified_files gauge\n");
+   for (int i = 0; i < config->common.number_of_servers; i++)
+   {
+      d = pgmoneta_get_server_backup(i);
+
+      number_of_backups = 0;
+      backups = NULL;
+
+      pgmoneta_get_backups(d, &number_of_backups, &backups);
+
+      for (int j = 0; j < number_of_backups; j++)
+      {
+         if (backups[j] != NULL && backups[j]->valid == VALID_TRUE)
+         {
+            pgmoneta_string_builder_append(data, "pgmoneta_backup_verified_files{");
+
+            pgmoneta_string_builder_append(data, "name=\"");
+            pgmoneta_string_builder_append(data, config->common.servers[i].name);
+            pgmoneta_string_builder_append(data, "\", label=\"");
+            pgmoneta_string_builder_append(data, backups[j]->label);
+            pgmoneta_string_builder_append(data, "\"} ");
+
+            pgmoneta_string_builder_append_ulong(data, backups[j]->verified_files);
+
+            pgmoneta_string_builder_append(data, "\n");
+         }
+      }
+
+      for (int j = 0; j < number_of_backups; j++)
+      {
+         free(backups[j]);
+      }
+      free(backups);
+
+      free(d);
+   }
+   pgmoneta_string_builder_append(data, "\n");
+
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_verified_failed The number of files of the backup that failed their last verification\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_verified_failed gauge\n");
+   for (int i = 0; i < config->common.number_of_servers; i++)
+   {
+      d = pgmoneta_get_server_backup(i);
+
+      number_of_backups = 0;
+      backups = NULL;
+
+      pgmoneta_get_backups(d, &number_of_backups, &backups);
+
+      for (int j = 0; j < number_of_backups; j++)
+      {
+         if (backups[j] != NULL && backups[j]->valid == VALID_TRUE)
+         {
+            pgmoneta_string_builder_append(data, "pgmoneta_backup_verified_failed{");
+
+            pgmoneta_string_builder_append(data, "name=\"");
+            pgmoneta_string_builder_append(data, config->common.servers[i].name);
+            pgmoneta_string_builder_append(data, "\", label=\"");
+            pgmoneta_string_builder_append(data, backups[j]->label);
+            pgmoneta_string_builder_append(data, "\"} ");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+            pgmoneta_string_builder_append_ulong(data, backups[j]->verified_failed);
 
-         data = pgmoneta_append(data, "\n");
+            pgmoneta_string_builder_append(data, "\n");
+         }
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2489,18 +2699,17 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_version The version of postgresql for a backup\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_version gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_version The version of postgresql for a backup\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_version gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2516,31 +2725,31 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_version{");
-
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\", major=\"");
-               data = pgmoneta_append_int(data, backups[j]->major_version);
-               data = pgmoneta_append(data, "\", minor=\"");
-               data = pgmoneta_append_int(data, backups[j]->minor_version);
-               data = pgmoneta_append(data, "\"} 1");
-
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_version{");
+
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\", major=\"");
+               pgmoneta_string_builder_append_int(data, backups[j]->major_version);
+               pgmoneta_string_builder_append(data, "\", minor=\"");
+               pgmoneta_string_builder_append_int(data, backups[j]->minor_version);
+               pgmoneta_string_builder_append(data, "\"} 1");
+
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_version{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_version{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2551,18 +2760,17 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_total_elapsed_time The backup in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_total_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_total_elapsed_time The backup in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_total_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2578,29 +2786,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_total_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_total_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->total_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->total_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_total_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_total_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2611,10 +2819,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_basebackup_elapsed_time The duration for basebackup in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_basebackup_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_basebackup_elapsed_time The duration for basebackup in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_basebackup_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2630,29 +2838,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_basebackup_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_basebackup_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->basebackup_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->basebackup_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_basebackup_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_basebackup_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2663,10 +2871,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_manifest_elapsed_time The duration for manifest in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_manifest_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_manifest_elapsed_time The duration for manifest in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_manifest_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2682,29 +2890,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_manifest_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_manifest_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->manifest_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->manifest_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_manifest_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_manifest_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2715,10 +2923,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_compression_zstd_elapsed_time The duration for zstd compression in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_compression_zstd_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_compression_zstd_elapsed_time The duration for zstd compression in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_compression_zstd_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2734,29 +2942,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_compression_zstd_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_zstd_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->compression_zstd_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->compression_zstd_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_compression_zstd_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_zstd_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2767,10 +2975,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_compression_gzip_elapsed_time The duration for gzip compression in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_compression_gzip_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_compression_gzip_elapsed_time The duration for gzip compression in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_compression_gzip_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2786,29 +2994,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_compression_gzip_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_gzip_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->compression_gzip_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->compression_gzip_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_compression_gzip_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_gzip_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2819,10 +3027,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_compression_bzip2_elapsed_time The duration for bzip2 compression in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_compression_bzip2_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_compression_bzip2_elapsed_time The duration for bzip2 compression in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_compression_bzip2_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2838,29 +3046,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_compression_bzip2_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_bzip2_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->compression_bzip2_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->compression_bzip2_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_compression_bzip2_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_bzip2_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2871,10 +3079,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_compression_lz4_elapsed_time The duration for lz4 compression in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_compression_lz4_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_compression_lz4_elapsed_time The duration for lz4 compression in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_compression_lz4_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2890,29 +3098,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_compression_lz4_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_lz4_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->compression_lz4_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->compression_lz4_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_compression_lz4_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_lz4_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2923,10 +3131,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_encryption_elapsed_time The duration for encryption in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_encryption_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_encryption_elapsed_time The duration for encryption in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_encryption_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2942,29 +3150,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_encryption_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_encryption_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->encryption_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->encryption_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_encryption_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_encryption_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -2975,10 +3183,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_linking_elapsed_time The duration for linking in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_linking_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_linking_elapsed_time The duration for linking in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_linking_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -2994,29 +3202,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_linking_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_linking_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->linking_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->linking_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_linking_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_linking_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3027,10 +3235,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_remote_ssh_elapsed_time The duration for remote ssh in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_remote_ssh_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_remote_ssh_elapsed_time The duration for remote ssh in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_remote_ssh_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3046,29 +3254,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_remote_ssh_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_ssh_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->remote_ssh_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->remote_ssh_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_remote_ssh_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_ssh_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3080,10 +3288,10 @@ backup_information(SSL* client_ssl, int client_fd)
       free(d);
    }
 
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_remote_s3_elapsed_time The duration for remote_s3 in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_remote_s3_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_remote_s3_elapsed_time The duration for remote_s3 in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_remote_s3_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3099,29 +3307,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_remote_s3_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_s3_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->remote_s3_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->remote_s3_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_remote_s3_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_s3_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3133,10 +3341,10 @@ backup_information(SSL* client_ssl, int client_fd)
       free(d);
    }
 
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_remote_azure_elapsed_time The duration for remote_azure in seconds for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_remote_azure_elapsed_time gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_remote_azure_elapsed_time The duration for remote_azure in seconds for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_remote_azure_elapsed_time gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3152,29 +3360,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_remote_azure_elapsed_time{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_azure_elapsed_time{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_double_precision(data, backups[j]->remote_azure_elapsed_time, 4);
+               pgmoneta_string_builder_append_double_precision(data, backups[j]->remote_azure_elapsed_time, 4);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_remote_azure_elapsed_time{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_azure_elapsed_time{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3186,10 +3394,10 @@ backup_information(SSL* client_ssl, int client_fd)
       free(d);
    }
 
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_start_timeline The starting timeline of a backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_start_timeline gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_start_timeline The starting timeline of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_start_timeline gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3205,29 +3413,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_start_timeline{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_start_timeline{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_int(data, backups[j]->start_timeline);
+               pgmoneta_string_builder_append_int(data, backups[j]->start_timeline);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_start_timeline{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_start_timeline{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3238,10 +3446,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_end_timeline The ending timeline of a backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_end_timeline gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_end_timeline The ending timeline of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_end_timeline gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3257,29 +3465,29 @@ backup_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_end_timeline{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_end_timeline{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_int(data, backups[j]->end_timeline);
+               pgmoneta_string_builder_append_int(data, backups[j]->end_timeline);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_end_timeline{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_end_timeline{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3290,10 +3498,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_start_walpos The starting WAL position of a backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_start_walpos gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_start_walpos The starting WAL position of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_start_walpos gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3311,35 +3519,35 @@ backup_information(SSL* client_ssl, int client_fd)
             {
                char walpos[MISC_LENGTH];
                memset(walpos, 0, MISC_LENGTH);
-               data = pgmoneta_append(data, "pgmoneta_backup_start_walpos{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_start_walpos{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\", ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\", ");
 
                snprintf(walpos, MISC_LENGTH, "%X/%X", backups[j]->start_lsn_hi32, backups[j]->start_lsn_lo32);
-               data = pgmoneta_append(data, "walpos=\"");
-               data = pgmoneta_append(data, walpos);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "walpos=\"");
+               pgmoneta_string_builder_append(data, walpos);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_int(data, 1);
+               pgmoneta_string_builder_append_int(data, 1);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_start_walpos{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_start_walpos{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\", ");
-         data = pgmoneta_append(data, "walpos=\"0/0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\", ");
+         pgmoneta_string_builder_append(data, "walpos=\"0/0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
       for (int j = 0; j < number_of_backups; j++)
       {
@@ -3349,10 +3557,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_checkpoint_walpos The checkpoint WAL position of a backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_checkpoint_walpos gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_checkpoint_walpos The checkpoint WAL position of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_checkpoint_walpos gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3370,35 +3578,35 @@ backup_information(SSL* client_ssl, int client_fd)
             {
                char walpos[MISC_LENGTH];
                memset(walpos, 0, MISC_LENGTH);
-               data = pgmoneta_append(data, "pgmoneta_backup_checkpoint_walpos{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_checkpoint_walpos{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\", ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\", ");
 
                snprintf(walpos, MISC_LENGTH, "%X/%X", backups[j]->checkpoint_lsn_hi32, backups[j]->checkpoint_lsn_lo32);
-               data = pgmoneta_append(data, "walpos=\"");
-               data = pgmoneta_append(data, walpos);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "walpos=\"");
+               pgmoneta_string_builder_append(data, walpos);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_int(data, 1);
+               pgmoneta_string_builder_append_int(data, 1);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_checkpoint_walpos{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_checkpoint_walpos{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\", ");
-         data = pgmoneta_append(data, "walpos=\"0/0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\", ");
+         pgmoneta_string_builder_append(data, "walpos=\"0/0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3409,10 +3617,10 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_end_walpos The ending WAL position of a backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_end_walpos gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_end_walpos The ending WAL position of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_end_walpos gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3430,35 +3638,35 @@ backup_information(SSL* client_ssl, int client_fd)
             {
                char walpos[MISC_LENGTH];
                memset(walpos, 0, MISC_LENGTH);
-               data = pgmoneta_append(data, "pgmoneta_backup_end_walpos{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_end_walpos{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\", ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\", ");
 
                snprintf(walpos, MISC_LENGTH, "%X/%X", backups[j]->end_lsn_hi32, backups[j]->end_lsn_lo32);
-               data = pgmoneta_append(data, "walpos=\"");
-               data = pgmoneta_append(data, walpos);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "walpos=\"");
+               pgmoneta_string_builder_append(data, walpos);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_int(data, 1);
+               pgmoneta_string_builder_append_int(data, 1);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_end_walpos{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_end_walpos{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\", ");
-         data = pgmoneta_append(data, "walpos=\"0/0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\", ");
+         pgmoneta_string_builder_append(data, "walpos=\"0/0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3469,32 +3677,30 @@ backup_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 }
 
 static void
-size_information(SSL* client_ssl, int client_fd)
+size_information(SSL* client_ssl, int client_fd, struct string_builder* data)
 {
    char* d;
    int number_of_backups;
    struct backup** backups;
    unsigned long size;
    bool valid;
-   char* data = NULL;
    struct main_configuration* config;
 
    config = (struct main_configuration*)shmem;
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_restore_newest_size The size of the newest restore for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_restore_newest_size gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_restore_newest_size The size of the newest restore for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_restore_newest_size gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3504,28 +3710,28 @@ size_information(SSL* client_ssl, int client_fd)
 
       pgmoneta_get_backups(d, &number_of_backups, &backups);
 
-      data = pgmoneta_append(data, "pgmoneta_restore_newest_size{");
+      pgmoneta_string_builder_append(data, "pgmoneta_restore_newest_size{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       valid = false;
       for (int j = number_of_backups - 1; !valid && j >= 0; j--)
       {
          if (backups[j]->valid == VALID_TRUE)
          {
-            data = pgmoneta_append_ulong(data, backups[j]->restore_size);
+            pgmoneta_string_builder_append_ulong(data, backups[j]->restore_size);
             valid = true;
          }
       }
 
       if (!valid)
       {
-         data = pgmoneta_append(data, "0");
+         pgmoneta_string_builder_append(data, "0");
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       for (int j = 0; j < number_of_backups; j++)
       {
@@ -3535,18 +3741,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_newest_size The size of the newest backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_newest_size gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_newest_size The size of the newest backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_newest_size gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3556,28 +3761,28 @@ size_information(SSL* client_ssl, int client_fd)
 
       pgmoneta_get_backups(d, &number_of_backups, &backups);
 
-      data = pgmoneta_append(data, "pgmoneta_backup_newest_size{");
+      pgmoneta_string_builder_append(data, "pgmoneta_backup_newest_size{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       valid = false;
       for (int j = number_of_backups - 1; !valid && j >= 0; j--)
       {
          if (backups[j]->valid == VALID_TRUE)
          {
-            data = pgmoneta_append_ulong(data, backups[j]->backup_size);
+            pgmoneta_string_builder_append_ulong(data, backups[j]->backup_size);
             valid = true;
          }
       }
 
       if (!valid)
       {
-         data = pgmoneta_append(data, "0");
+         pgmoneta_string_builder_append(data, "0");
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
 
       for (int j = 0; j < number_of_backups; j++)
       {
@@ -3587,18 +3792,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_restore_size The size of a restore for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_restore_size gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_restore_size The size of a restore for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_restore_size gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3614,29 +3818,29 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_restore_size{");
+               pgmoneta_string_builder_append(data, "pgmoneta_restore_size{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_ulong(data, backups[j]->restore_size);
+               pgmoneta_string_builder_append_ulong(data, backups[j]->restore_size);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_restore_size{");
+         pgmoneta_string_builder_append(data, "pgmoneta_restore_size{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3647,18 +3851,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_restore_size_increment The size increment of a restore for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_restore_size_increment gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_restore_size_increment The size increment of a restore for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_restore_size_increment gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3674,36 +3877,36 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_restore_size_increment{");
+               pgmoneta_string_builder_append(data, "pgmoneta_restore_size_increment{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (j == 0)
                {
-                  data = pgmoneta_append_int(data, backups[0]->restore_size);
+                  pgmoneta_string_builder_append_int(data, backups[0]->restore_size);
                }
                else
                {
-                  data = pgmoneta_append_int(data, backups[j]->restore_size - backups[j - 1]->restore_size);
+                  pgmoneta_string_builder_append_int(data, backups[j]->restore_size - backups[j - 1]->restore_size);
                }
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_restore_size_increment{");
+         pgmoneta_string_builder_append(data, "pgmoneta_restore_size_increment{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3714,18 +3917,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_size The size of a backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_size gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_size The size of a backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_size gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3741,29 +3943,29 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j]->valid == VALID_TRUE)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_size{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_size{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_ulong(data, backups[j]->backup_size);
+               pgmoneta_string_builder_append_ulong(data, backups[j]->backup_size);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_size{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_size{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3774,18 +3976,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_compression_ratio The ratio of backup size to restore size for each backup\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_compression_ratio gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_compression_ratio The ratio of backup size to restore size for each backup\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_compression_ratio gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3801,36 +4002,36 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_compression_ratio{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_ratio{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->restore_size)
                {
-                  data = pgmoneta_append_double(data, 1.0 * backups[j]->backup_size / backups[j]->restore_size);
+                  pgmoneta_string_builder_append_double(data, 1.0 * backups[j]->backup_size / backups[j]->restore_size);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_compression_ratio{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_ratio{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3841,18 +4042,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_throughput The throughput of the backup for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_throughput gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_throughput The throughput of the backup for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_throughput gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3868,35 +4068,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_throughput{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_throughput{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->total_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->total_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->total_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_throughput{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_throughput{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3907,18 +4107,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_basebackup_mbs The throughput of the basebackup for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_basebackup_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_basebackup_mbs The throughput of the basebackup for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_basebackup_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -3934,35 +4133,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_basebackup_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_basebackup_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->basebackup_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->basebackup_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->basebackup_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_basebackup_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_basebackup_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -3973,18 +4172,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_manifest_mbs The throughput of the manifest for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_manifest_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_manifest_mbs The throughput of the manifest for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_manifest_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4000,35 +4198,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_manifest_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_manifest_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->manifest_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->manifest_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->manifest_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_manifest_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_manifest_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4039,18 +4237,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_compression_zstd_mbs The throughput of the zstd compression for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_compression_zstd_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_compression_zstd_mbs The throughput of the zstd compression for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_compression_zstd_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4066,35 +4263,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_compression_zstd_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_zstd_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->compression_zstd_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->compression_zstd_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->compression_zstd_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_compression_zstd_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_zstd_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4105,18 +4302,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_compression_gzip_mbs The throughput of the gzip compression for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_compression_gzip_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_compression_gzip_mbs The throughput of the gzip compression for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_compression_gzip_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4132,35 +4328,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_compression_gzip_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_gzip_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->compression_gzip_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->compression_gzip_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->compression_gzip_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_compression_gzip_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_gzip_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4171,18 +4367,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_compression_bzip2_mbs The throughput of the bzip2 compression for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_compression_bzip2_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_compression_bzip2_mbs The throughput of the bzip2 compression for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_compression_bzip2_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4198,35 +4393,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_compression_bzip2_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_bzip2_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->compression_bzip2_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->compression_bzip2_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->compression_bzip2_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_compression_bzip2_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_bzip2_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4237,18 +4432,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_compression_lz4_mbs The throughput of the lz4 compression for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_compression_lz4_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_compression_lz4_mbs The throughput of the lz4 compression for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_compression_lz4_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4264,35 +4458,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_compression_lz4_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_lz4_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->compression_lz4_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->compression_lz4_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->compression_lz4_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_compression_lz4_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_compression_lz4_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4303,18 +4497,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_encryption_mbs The throughput of the encryption for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_encryption_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_encryption_mbs The throughput of the encryption for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_encryption_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4330,35 +4523,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_encryption_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_encryption_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->encryption_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->encryption_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->encryption_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_encryption_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_encryption_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4369,18 +4562,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_linking_mbs The throughput of the linking for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_linking_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_linking_mbs The throughput of the linking for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_linking_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4396,35 +4588,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_linking_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_linking_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->linking_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->linking_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->linking_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_linking_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_linking_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4435,18 +4627,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_remote_ssh_mbs The throughput of the remote_ssh for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_remote_ssh_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_remote_ssh_mbs The throughput of the remote_ssh for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_remote_ssh_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4462,35 +4653,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_remote_ssh_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_ssh_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->remote_ssh_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->remote_ssh_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->remote_ssh_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_remote_ssh_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_ssh_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4501,18 +4692,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_remote_s3_mbs The throughput of the remote_s3 for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_remote_s3_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_remote_s3_mbs The throughput of the remote_s3 for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_remote_s3_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4528,35 +4718,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_remote_s3_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_s3_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->remote_s3_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->remote_s3_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->remote_s3_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_remote_s3_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_s3_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4567,18 +4757,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_remote_azure_mbs The throughput of the remote_azure for a server (MB/s)\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_remote_azure_mbs gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_remote_azure_mbs The throughput of the remote_azure for a server (MB/s)\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_remote_azure_mbs gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4594,35 +4783,35 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_remote_azure_mbs{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_azure_mbs{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
                if (backups[j]->remote_azure_elapsed_time)
                {
-                  data = pgmoneta_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->remote_azure_elapsed_time) / (1e6), 4);
+                  pgmoneta_string_builder_append_double_precision(data, (1.0 * backups[j]->backup_size / backups[j]->remote_azure_elapsed_time) / (1e6), 4);
                }
                else
                {
-                  data = pgmoneta_append_int(data, 0);
+                  pgmoneta_string_builder_append_int(data, 0);
                }
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_remote_azure_mbs{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_remote_azure_mbs{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4633,18 +4822,17 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_retain Retain backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_retain gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_retain Retain backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_retain gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
       d = pgmoneta_get_server_backup(i);
@@ -4660,29 +4848,29 @@ size_information(SSL* client_ssl, int client_fd)
          {
             if (backups[j] != NULL)
             {
-               data = pgmoneta_append(data, "pgmoneta_backup_retain{");
+               pgmoneta_string_builder_append(data, "pgmoneta_backup_retain{");
 
-               data = pgmoneta_append(data, "name=\"");
-               data = pgmoneta_append(data, config->common.servers[i].name);
-               data = pgmoneta_append(data, "\", label=\"");
-               data = pgmoneta_append(data, backups[j]->label);
-               data = pgmoneta_append(data, "\"} ");
+               pgmoneta_string_builder_append(data, "name=\"");
+               pgmoneta_string_builder_append(data, config->common.servers[i].name);
+               pgmoneta_string_builder_append(data, "\", label=\"");
+               pgmoneta_string_builder_append(data, backups[j]->label);
+               pgmoneta_string_builder_append(data, "\"} ");
 
-               data = pgmoneta_append_bool(data, backups[j]->keep);
+               pgmoneta_string_builder_append_bool(data, backups[j]->keep);
 
-               data = pgmoneta_append(data, "\n");
+               pgmoneta_string_builder_append(data, "\n");
             }
          }
       }
       else
       {
-         data = pgmoneta_append(data, "pgmoneta_backup_retain{");
+         pgmoneta_string_builder_append(data, "pgmoneta_backup_retain{");
 
-         data = pgmoneta_append(data, "name=\"");
-         data = pgmoneta_append(data, config->common.servers[i].name);
-         data = pgmoneta_append(data, "\", label=\"0\"} 0");
+         pgmoneta_string_builder_append(data, "name=\"");
+         pgmoneta_string_builder_append(data, config->common.servers[i].name);
+         pgmoneta_string_builder_append(data, "\", label=\"0\"} 0");
 
-         data = pgmoneta_append(data, "\n");
+         pgmoneta_string_builder_append(data, "\n");
       }
 
       for (int j = 0; j < number_of_backups; j++)
@@ -4693,324 +4881,355 @@ size_information(SSL* client_ssl, int client_fd)
 
       free(d);
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_backup_total_size The total size of the backups for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_backup_total_size gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_backup_total_size The total size of the backups for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_backup_total_size gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      d = pgmoneta_get_server_backup(i);
-
-      size = pgmoneta_directory_size(d);
+      size = pgmoneta_space_get(i, SPACE_BACKUP);
 
-      data = pgmoneta_append(data, "pgmoneta_backup_total_size{");
+      pgmoneta_string_builder_append(data, "pgmoneta_backup_total_size{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_ulong(data, size);
+      pgmoneta_string_builder_append_ulong(data, size);
 
-      data = pgmoneta_append(data, "\n");
-
-      free(d);
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_wal_total_size The total size of the WAL for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_wal_total_size gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_wal_total_size The total size of the WAL for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_wal_total_size gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      d = pgmoneta_get_server_wal(i);
-
-      size = pgmoneta_directory_size(d);
-
-      free(d);
-
-      d = pgmoneta_get_server_wal_shipping_wal(i);
-
-      if (d != NULL)
-      {
-
-         size += pgmoneta_directory_size(d);
-      }
+      size = pgmoneta_space_get(i, SPACE_WAL) + pgmoneta_space_get(i, SPACE_WAL_SHIPPING);
 
-      data = pgmoneta_append(data, "pgmoneta_wal_total_size{");
+      pgmoneta_string_builder_append(data, "pgmoneta_wal_total_size{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_ulong(data, size);
+      pgmoneta_string_builder_append_ulong(data, size);
 
-      data = pgmoneta_append(data, "\n");
-
-      free(d);
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_total_size The total size for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_total_size gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_total_size The total size for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_total_size gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      d = pgmoneta_get_server(i);
+      size = pgmoneta_space_server(i) + pgmoneta_space_get(i, SPACE_WAL_SHIPPING);
 
-      size = pgmoneta_directory_size(d);
+      pgmoneta_string_builder_append(data, "pgmoneta_total_size{");
 
-      free(d);
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      d = pgmoneta_get_server_wal_shipping(i);
+      pgmoneta_string_builder_append_ulong(data, size);
 
-      if (d != NULL)
-      {
-         size += pgmoneta_directory_size(d);
-      }
-
-      data = pgmoneta_append(data, "pgmoneta_total_size{");
-
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
-
-      data = pgmoneta_append_ulong(data, size);
-
-      data = pgmoneta_append(data, "\n");
-
-      free(d);
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_active_backup Is there an active backup for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_active_backup gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_active_backup Is there an active backup for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_active_backup gauge\n");
 
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_active_backup{");
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_active_backup{");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       if (config->common.servers[i].active_backup)
       {
-         data = pgmoneta_append_int(data, 1);
+         pgmoneta_string_builder_append_int(data, 1);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_active_restore Is there an active restore for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_active_restore gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_active_restore Is there an active restore for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_active_restore gauge\n");
 
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_active_restore{");
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_active_restore{");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       if (config->common.servers[i].active_restore)
       {
-         data = pgmoneta_append_int(data, 1);
+         pgmoneta_string_builder_append_int(data, 1);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_active_archive Is there an active archiving for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_active_archive gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_active_archive Is there an active archiving for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_active_archive gauge\n");
 
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_active_archive{");
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_active_archive{");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       if (config->common.servers[i].active_archive)
       {
-         data = pgmoneta_append_int(data, 1);
+         pgmoneta_string_builder_append_int(data, 1);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_active_delete Is there an active delete for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_active_delete gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_active_delete Is there an active delete for a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_active_delete gauge\n");
 
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_active_delete{");
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_active_delete{");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       if (config->common.servers[i].active_delete)
       {
-         data = pgmoneta_append_int(data, 1);
+         pgmoneta_string_builder_append_int(data, 1);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_active_retention Is there an "
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_active_retention Is there an "
                           "active archiving for a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_active_retention gauge\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_active_retention gauge\n");
 
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_active_retention{");
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "pgmoneta_active_retention{");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\"} ");
 
       if (config->common.servers[i].active_retention)
       {
-         data = pgmoneta_append_int(data, 1);
+         pgmoneta_string_builder_append_int(data, 1);
       }
       else
       {
-         data = pgmoneta_append_int(data, 0);
+         pgmoneta_string_builder_append_int(data, 0);
       }
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   data = pgmoneta_append(data, "#HELP pgmoneta_current_wal_file The current streaming WAL filename of a server\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_current_wal_file gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_current_wal_file The current streaming WAL filename of a server\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_current_wal_file gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_current_wal_file{");
+      pgmoneta_string_builder_append(data, "pgmoneta_current_wal_file{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\", ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\", ");
 
-      data = pgmoneta_append(data, "file=\"");
-      data = pgmoneta_append(data, config->common.servers[i].current_wal_filename);
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "file=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].current_wal_filename);
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_bool(data, config->common.servers[i].wal_streaming);
+      pgmoneta_string_builder_append_bool(data, config->common.servers[i].wal_streaming);
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
    // Append the WAL LSN of every server
-   data = pgmoneta_append(data, "#HELP pgmoneta_current_wal_lsn The current WAL log sequence number\n");
-   data = pgmoneta_append(data, "#TYPE pgmoneta_current_wal_lsn gauge\n");
+   pgmoneta_string_builder_append(data, "#HELP pgmoneta_current_wal_lsn The current WAL log sequence number\n");
+   pgmoneta_string_builder_append(data, "#TYPE pgmoneta_current_wal_lsn gauge\n");
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      data = pgmoneta_append(data, "pgmoneta_current_wal_lsn{");
+      pgmoneta_string_builder_append(data, "pgmoneta_current_wal_lsn{");
 
-      data = pgmoneta_append(data, "name=\"");
-      data = pgmoneta_append(data, config->common.servers[i].name);
-      data = pgmoneta_append(data, "\", ");
+      pgmoneta_string_builder_append(data, "name=\"");
+      pgmoneta_string_builder_append(data, config->common.servers[i].name);
+      pgmoneta_string_builder_append(data, "\", ");
 
-      data = pgmoneta_append(data, "lsn=\"");
+      pgmoneta_string_builder_append(data, "lsn=\"");
       if (!strcmp(config->common.servers[i].current_wal_lsn, ""))
       {
-         data = pgmoneta_append(data, "0/0");
+         pgmoneta_string_builder_append(data, "0/0");
       }
       else
       {
-         data = pgmoneta_append(data, config->common.servers[i].current_wal_lsn);
+         pgmoneta_string_builder_append(data, config->common.servers[i].current_wal_lsn);
       }
-      data = pgmoneta_append(data, "\"} ");
+      pgmoneta_string_builder_append(data, "\"} ");
 
-      data = pgmoneta_append_bool(data, config->common.servers[i].wal_streaming);
+      pgmoneta_string_builder_append_bool(data, config->common.servers[i].wal_streaming);
 
-      data = pgmoneta_append(data, "\n");
+      pgmoneta_string_builder_append(data, "\n");
    }
-   data = pgmoneta_append(data, "\n");
+   pgmoneta_string_builder_append(data, "\n");
 
-   if (data != NULL)
+   if (data->length > 0)
    {
       send_chunk(client_ssl, client_fd, data);
-      metrics_cache_append(data);
-      free(data);
-      data = NULL;
+      metrics_cache_append(data->data);
+      pgmoneta_string_builder_reset(data);
    }
 }
 
+static void
+append_histogram(struct string_builder* data, char* metric, char* server, struct histogram* h)
+{
+   unsigned long cumulative = 0;
+
+   for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+   {
+      cumulative += atomic_load(&h->bucket[i]);
+
+      pgmoneta_string_builder_append(data, metric);
+      pgmoneta_string_builder_append(data, "_bucket{name=\"");
+      pgmoneta_string_builder_append(data, server);
+      pgmoneta_string_builder_append(data, "\", le=\"");
+      if (i < HISTOGRAM_BUCKETS - 1)
+      {
+         pgmoneta_string_builder_append_double(data, histogram_bounds[i] / 1000000.0);
+      }
+      else
+      {
+         pgmoneta_string_builder_append(data, "+Inf");
+      }
+      pgmoneta_string_builder_append(data, "\"} ");
+      pgmoneta_string_builder_append_ulong(data, cumulative);
+      pgmoneta_string_builder_append(data, "\n");
+   }
+
+   pgmoneta_string_builder_append(data, metric);
+   pgmoneta_string_builder_append(data, "_sum{name=\"");
+   pgmoneta_string_builder_append(data, server);
+   pgmoneta_string_builder_append(data, "\"} ");
+   pgmoneta_string_builder_append_double(data, atomic_load(&h->sum) / 1000000.0);
+   pgmoneta_string_builder_append(data, "\n");
+
+   pgmoneta_string_builder_append(data, metric);
+   pgmoneta_string_builder_append(data, "_count{name=\"");
+   pgmoneta_string_builder_append(data, server);
+   pgmoneta_string_builder_append(data, "\"} ");
+   pgmoneta_string_builder_append_ulong(data, atomic_load(&h->count));
+   pgmoneta_string_builder_append(data, "\n");
+}
+
+static void
+reset_histogram(struct histogram* h)
+{
+   for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+   {
+      atomic_store(&h->bucket[i], 0);
+   }
+   atomic_store(&h->count, 0);
+   atomic_store(&h->sum, 0);
+}
+
 static int
-send_chunk(SSL* client_ssl, int client_fd, char* data)
+send_chunk(SSL* client_ssl, int client_fd, struct string_builder* data)
 {
    int status;
-   char* m = NULL;
+   struct string_builder* m = NULL;
    struct message msg;
 
    memset(&msg, 0, sizeof(struct message));
 
-   m = malloc(20);
-
-   if (m == NULL)
+   if (data->error)
    {
       goto error;
    }
 
-   memset(m, 0, 20);
+   if (pgmoneta_string_builder_create(data->length + 32, &m))
+   {
+      goto error;
+   }
 
-   sprintf(m, "%zX\r\n", strlen(data));
+   pgmoneta_string_builder_append_format(m, "%zX\r\n", data->length);
+   pgmoneta_string_builder_append_length(m, data->data, data->length);
+   pgmoneta_string_builder_append(m, "\r\n");
 
-   m = pgmoneta_append(m, data);
-   m = pgmoneta_append(m, "\r\n");
+   if (m->error)
+   {
+      goto error;
+   }
 
    msg.kind = 0;
-   msg.length = strlen(m);
-   msg.data = m;
+   msg.length = m->length;
+   msg.data = m->data;
 
    status = pgmoneta_write_message(client_ssl, client_fd, &msg);
+   if (status != MESSAGE_STATUS_OK)
+   {
+      goto error;
+   }
 
-   free(m);
+   pgmoneta_string_builder_destroy(m);
 
    return status;
 
 error:
 
+   /* The rest of the page is dropped once a chunk is lost */
+   data->error = true;
+
+   pgmoneta_string_builder_destroy(m);
+
    return MESSAGE_STATUS_ERROR;
 }
 
@@ -28,11 +28,14 @@
 
 /* pgmoneta */
 #include <pgmoneta.h>
+#include <dedup.h>
 #include <logging.h>
 #include <management.h>
 #include <network.h>
 #include <restore.h>
 #include <security.h>
+#include <space.h>
+#include <streamer.h>
 #include <utils.h>
 #include <workers.h>
 #include <workflow.h>
@@ -41,6 +44,8 @@
 #include <assert.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -55,6 +60,7 @@
 #define RESTORE_ERROR         4
 #define MAX_PATH_CONCAT (MAX_PATH * 2)
 #define TMP_SUFFIX ".tmp"
+#define RECONSTRUCT_BUFFER_SIZE (1024 * 1024)
 
 struct build_backup_file_input
 {
@@ -182,6 +188,15 @@ copy_backup_file(int server,
 static void
 do_copy_backup_file(struct worker_common* wc);
 
+/**
+ * Copy the raw content of an rfile, decoding it if it is compressed or encrypted
+ * @param rf The rfile
+ * @param to The destination file
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+copy_rfile(struct rfile* rf, char* to);
+
 static void
 create_copy_backup_file_input(
    int server,
@@ -211,8 +226,38 @@ rfile_destroy_cb(uintptr_t data);
 static bool
 is_full_file(struct rfile* rf);
 
+/**
+ * Read a run of consecutive blocks from a source file with a single pread
+ * @param rf The source file
+ * @param offset The offset of the first block
+ * @param length The number of bytes to read
+ * @param buffer The buffer
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+read_blocks(struct rfile* rf, off_t offset, size_t length, uint8_t* buffer);
+
+/**
+ * Write blocks to a reconstructed file in chunks of RECONSTRUCT_BUFFER_SIZE.
+ * Blocks that are adjacent in both the output and the same source file are read together,
+ * the offsets of a source are ascending along the output so each run is a sequential read.
+ * @param wfp The output file
+ * @param output_file_path The output file path
+ * @param block_length The number of blocks
+ * @param source_map The source of each block
+ * @param offset_map The offset of each block in its source
+ * @param blocksz The block size
+ * @param zero_fill Write zeroes for blocks without a source, otherwise skip them
+ * @return 0 on success, 1 if otherwise
+ */
 static int
-read_block(struct rfile* rf, off_t offset, uint32_t blocksz, uint8_t* buffer);
+write_reconstructed_blocks(FILE* wfp,
+                           char* output_file_path,
+                           uint32_t block_length,
+                           struct rfile** source_map,
+                           off_t* offset_map,
+                           uint32_t blocksz,
+                           bool zero_fill);
 
 static int
 write_reconstructed_file_full(char* output_file_path,
@@ -241,6 +286,12 @@ parse_oid(char* name);
 static void
 cleanup_workspaces(int server, struct deque* labels);
 
+static int
+materialize_backups(int server, struct deque* labels);
+
+static void
+dematerialize_backups(int server, struct deque* labels);
+
 static void
 create_workspace_directory(int server, char* label, char* relative_prefix);
 
@@ -262,6 +313,31 @@ construct_backup_label_chain(int server, char* newest_label, char* oldest_label,
 static int
 file_base_name(char* file, char** basename);
 
+/**
+ * Restore a file of a backup. A compressed or encrypted file is decoded while it is
+ * read, and written once to the target without its suffixes
+ * @param from The file in the backup
+ * @param to The target file
+ * @param workers The optional workers
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+restore_file(char* from, char* to, struct workers* workers);
+
+static void
+do_restore_file(struct worker_common* wc);
+
+/**
+ * Restore a directory of a backup
+ * @param from The directory in the backup
+ * @param to The target directory
+ * @param restore_last_files_names The files that are restored separately
+ * @param workers The optional workers
+ * @return 0 on success, 1 if otherwise
+ */
+static int
+restore_directory(char* from, char* to, char** restore_last_files_names, struct workers* workers);
+
 static int copy_tablespaces_restore(char* from, char* to, char* base,
                                     char* server, char* id,
                                     struct backup* backup,
@@ -796,6 +872,8 @@ pgmoneta_rollup_backups(int server, char* newest_label, char* oldest_label)
    char* tmp_old_manifest_path = NULL;
    char* old_manifest_path = NULL;
    struct workflow* workflow = NULL;
+   struct info_transaction* info = NULL;
+   uint64_t previous = 0;
 
    memset(backup_info_path, 0, MAX_PATH);
    memset(tmp_backup_info_path, 0, MAX_PATH);
@@ -885,16 +963,30 @@ pgmoneta_rollup_backups(int server, char* newest_label, char* oldest_label)
       goto error;
    }
 
+   if (pgmoneta_info_begin(tmp_backup_root, &info))
+   {
+      goto error;
+   }
+
    if (!incremental)
    {
-      pgmoneta_update_info_unsigned_long(tmp_backup_root, INFO_TYPE, TYPE_FULL);
-      pgmoneta_update_info_string(tmp_backup_root, INFO_PARENT, NULL);
+      pgmoneta_info_set_unsigned_long(info, INFO_TYPE, TYPE_FULL);
+      pgmoneta_info_set_string(info, INFO_PARENT, NULL);
    }
    else
    {
-      pgmoneta_update_info_string(tmp_backup_root, INFO_PARENT, oldest_backup->parent_label);
+      pgmoneta_info_set_string(info, INFO_PARENT, oldest_backup->parent_label);
    }
 
+   if (pgmoneta_info_commit(info))
+   {
+      goto error;
+   }
+   pgmoneta_info_destroy(info);
+   info = NULL;
+
+   previous = pgmoneta_directory_size(backup_dir);
+
    pgmoneta_delete_directory(backup_dir);
    if (rename(tmp_backup_root, backup_dir) != 0)
    {
@@ -908,7 +1000,10 @@ pgmoneta_rollup_backups(int server, char* newest_label, char* oldest_label)
       goto error;
    }
 
+   pgmoneta_space_add(server, SPACE_BACKUP, (int64_t)pgmoneta_directory_size(backup_dir) - (int64_t)previous);
+
    pgmoneta_workflow_destroy(workflow);
+   pgmoneta_info_destroy(info);
    pgmoneta_art_destroy(nodes);
    free(newest_backup);
    free(oldest_backup);
@@ -924,7 +1019,12 @@ error:
    {
       pgmoneta_delete_directory(tmp_backup_root);
    }
+   if (previous > 0)
+   {
+      pgmoneta_space_invalidate(server, SPACE_BACKUP);
+   }
    pgmoneta_workflow_destroy(workflow);
+   pgmoneta_info_destroy(info);
    pgmoneta_art_destroy(nodes);
    free(newest_backup);
    free(oldest_backup);
@@ -1051,6 +1151,12 @@ pgmoneta_copy_postgresql_restore(char* from, char* to, char* base, char* server,
             continue;
          }
 
+         // pg_tblspc is linked to the restored tablespaces, which the map of the server doesn't know about
+         if (pgmoneta_starts_with(entry->d_name, "tablespace_map"))
+         {
+            continue;
+         }
+
          from_buffer = pgmoneta_append(from_buffer, from);
          if (!pgmoneta_ends_with(from_buffer, "/"))
          {
@@ -1075,7 +1181,7 @@ pgmoneta_copy_postgresql_restore(char* from, char* to, char* base, char* server,
                }
                else
                {
-                  pgmoneta_copy_directory(from_buffer, to_buffer, restore_last_files_names, workers);
+                  restore_directory(from_buffer, to_buffer, restore_last_files_names, workers);
                }
             }
             else
@@ -1085,16 +1191,20 @@ pgmoneta_copy_postgresql_restore(char* from, char* to, char* base, char* server,
                {
                   for (int i = 0; restore_last_files_names[i] != NULL; i++)
                   {
-                     file_is_excluded = !strcmp(from_buffer, restore_last_files_names[i]);
+                     if (!strcmp(from_buffer, restore_last_files_names[i]))
+                     {
+                        file_is_excluded = true;
+                        break;
+                     }
                   }
                   if (!file_is_excluded)
                   {
-                     pgmoneta_copy_file(from_buffer, to_buffer, workers);
+                     restore_file(from_buffer, to_buffer, workers);
                   }
                }
                else
                {
-                  pgmoneta_copy_file(from_buffer, to_buffer, workers);
+                  restore_file(from_buffer, to_buffer, workers);
                }
             }
          }
@@ -1123,8 +1233,6 @@ pgmoneta_copy_postgresql_restore(char* from, char* to, char* base, char* server,
       free(restore_last_files_names);
    }
 
-   pgmoneta_workers_destroy(workers);
-
    return 0;
 
 error:
@@ -1140,8 +1248,6 @@ error:
       free(restore_last_files_names);
    }
 
-   pgmoneta_workers_destroy(workers);
-
    return 1;
 }
 
@@ -1165,6 +1271,12 @@ pgmoneta_copy_postgresql_hotstandby(char* from, char* to, char* tblspc_mappings,
             continue;
          }
 
+         // pg_tblspc is linked to the restored tablespaces, which the map of the server doesn't know about
+         if (pgmoneta_starts_with(entry->d_name, "tablespace_map"))
+         {
+            continue;
+         }
+
          from_buffer = pgmoneta_append(from_buffer, from);
          from_buffer = pgmoneta_append(from_buffer, "/");
          from_buffer = pgmoneta_append(from_buffer, entry->d_name);
@@ -1354,10 +1466,11 @@ combine_backups_recursive(uint32_t tsoid,
          }
       }
 
-      // skip these, backup_label requires special handling
+      // skip these, backup_label requires special handling and pg_tblspc is linked by the restore
       if (relative_dir == NULL &&
           (pgmoneta_compare_string(entry->d_name, "backup_label") ||
-           pgmoneta_compare_string(entry->d_name, "backup_manifest")))
+           pgmoneta_compare_string(entry->d_name, "backup_manifest") ||
+           pgmoneta_starts_with(entry->d_name, "tablespace_map")))
       {
          continue;
       }
@@ -1575,9 +1688,18 @@ reconstruct_backup_file(int server,
       if (is_full_file(rf))
       {
          full_file_found = true;
-         // would be nice if we could check if stat fails
-         file_size = pgmoneta_get_file_size(rf->filepath);
-         nblocks = file_size / blocksz;
+         if (rf->reader == NULL)
+         {
+            // would be nice if we could check if stat fails
+            file_size = pgmoneta_get_file_size(rf->filepath);
+            nblocks = file_size / blocksz;
+         }
+         else
+         {
+            // the raw size of a compressed or encrypted file isn't known without decoding it,
+            // blocks past its end are zero filled when they are read
+            nblocks = latest_source->truncation_block_length;
+         }
 
          // no need to check for blocks beyond truncation_block_length
          // since those blocks should have been truncated away anyway,
@@ -1594,7 +1716,7 @@ reconstruct_backup_file(int server,
          // full_copy_possible only remains true when there are no modified blocks in later incremental files,
          // which means the file has probably never been modified since last full backup.
          // But it still could've gotten truncated, so check the file size.
-         if (full_copy_possible && file_size == block_length * blocksz)
+         if (full_copy_possible && rf->reader == NULL && file_size == block_length * blocksz)
          {
             copy_source = rf;
          }
@@ -1700,8 +1822,8 @@ copy_backup_file(int server,
    bool excluded = false;
    char ofullpath[MAX_PATH_CONCAT];
    char manifest_path[MAX_PATH_CONCAT];
-   char* extracted_file_path = NULL;
    char* base_file_name = NULL;
+   struct rfile* rf = NULL;
    int excluded_files = 0;
 
 #ifdef DEBUG
@@ -1713,25 +1835,25 @@ copy_backup_file(int server,
 
    memset(ofullpath, 0, MAX_PATH_CONCAT);
    memset(manifest_path, 0, MAX_PATH_CONCAT);
-   // copy the full file from input dir to output dir
-   // extract before copy
-   snprintf(manifest_path, MAX_PATH_CONCAT, "%s%s", relative_dir, file_name);
-   if (pgmoneta_extract_backup_file(server, label, manifest_path, NULL, &extracted_file_path))
+   // copy the full file from input dir to output dir,
+   // decoding it on the way instead of extracting it to the workspace first
+   if (pgmoneta_rfile_create(server, label, relative_dir, file_name, ENCRYPTION_NONE, COMPRESSION_NONE, &rf))
    {
       goto error;
    }
 
+   file_base_name(file_name, &base_file_name);
+
+   snprintf(manifest_path, MAX_PATH_CONCAT, "/%s%s", relative_dir, base_file_name);
    for (int i = 0; i < excluded_files; i++)
    {
-      if (pgmoneta_ends_with(extracted_file_path, restore_last_files_names[i]))
+      if (pgmoneta_ends_with(manifest_path, restore_last_files_names[i]))
       {
          pgmoneta_log_debug("combine_backup_recursive: exclude %s", manifest_path);
          excluded = true;
       }
    }
 
-   file_base_name(file_name, &base_file_name);
-
    if (excluded && exclude)
    {
       snprintf(ofullpath, MAX_PATH_CONCAT, "%s/%s%s", output_dir, base_file_name, TMP_SUFFIX);
@@ -1741,23 +1863,75 @@ copy_backup_file(int server,
       snprintf(ofullpath, MAX_PATH_CONCAT, "%s/%s", output_dir, base_file_name);
    }
 
-   pgmoneta_copy_file(extracted_file_path, ofullpath, NULL);
+   if (copy_rfile(rf, ofullpath))
+   {
+      goto error;
+   }
 
-   pgmoneta_delete_file(extracted_file_path, NULL);
-   free(extracted_file_path);
-   extracted_file_path = NULL;
+   pgmoneta_rfile_destroy(rf);
+   free(base_file_name);
+   return 0;
 
+error:
+   pgmoneta_rfile_destroy(rf);
    free(base_file_name);
-   free(extracted_file_path);
+   return 1;
+}
+
+static int
+copy_rfile(struct rfile* rf, char* to)
+{
+   FILE* wfp = NULL;
+   uint8_t* buffer = NULL;
+   off_t offset = 0;
+   size_t nread = 0;
+
+   if (rf->reader == NULL)
+   {
+      return pgmoneta_copy_file(rf->filepath, to, NULL);
+   }
+
+   buffer = (uint8_t*)malloc(RECONSTRUCT_BUFFER_SIZE);
+   if (buffer == NULL)
+   {
+      goto error;
+   }
+
+   wfp = fopen(to, "wb");
+   if (wfp == NULL)
+   {
+      pgmoneta_log_error("copy: unable to open file %s", to);
+      goto error;
+   }
+
+   do
+   {
+      if (pgmoneta_rfile_read(rf, offset, RECONSTRUCT_BUFFER_SIZE, buffer, &nread))
+      {
+         pgmoneta_log_error("copy: unable to read from file %s", rf->filepath);
+         goto error;
+      }
+
+      if (nread > 0 && fwrite(buffer, 1, nread, wfp) != nread)
+      {
+         pgmoneta_log_error("copy: unable to write to file %s", to);
+         goto error;
+      }
+
+      offset += nread;
+   }
+   while (nread == RECONSTRUCT_BUFFER_SIZE);
+
+   fclose(wfp);
+   free(buffer);
    return 0;
 
 error:
-   if (extracted_file_path != NULL)
+   if (wfp != NULL)
    {
-      pgmoneta_delete_file(extracted_file_path, NULL);
+      fclose(wfp);
    }
-   free(extracted_file_path);
-   free(base_file_name);
+   free(buffer);
    return 1;
 }
 
@@ -1798,20 +1972,25 @@ is_full_file(struct rfile* rf)
 }
 
 static int
-read_block(struct rfile* rf, off_t offset, uint32_t blocksz, uint8_t* buffer)
+read_blocks(struct rfile* rf, off_t offset, size_t length, uint8_t* buffer)
 {
-   int nread = 0;
-   if (fseek(rf->fp, offset, SEEK_SET))
+   size_t nread = 0;
+
+   if (pgmoneta_rfile_read(rf, offset, length, buffer, &nread))
    {
-      pgmoneta_log_error("unable to locate file pointer to offset %llu in file %s", offset, rf->filepath);
+      pgmoneta_log_error("unable to read %zu bytes at offset %lld from file %s", length, (long long)offset, rf->filepath);
       goto error;
    }
 
-   nread = fread(buffer, 1, blocksz, rf->fp);
-   if (nread != blocksz)
+   if (nread < length)
    {
-      pgmoneta_log_error("unable to read block at offset %llu from file %s", offset, rf->filepath);
-      goto error;
+      // a decoded full file may end before the truncation block length, see reconstruct_backup_file
+      if (!is_full_file(rf) || rf->reader == NULL)
+      {
+         pgmoneta_log_error("unable to read %zu bytes at offset %lld from file %s", length, (long long)offset, rf->filepath);
+         goto error;
+      }
+      memset(buffer + nread, 0, length - nread);
    }
 
    return 0;
@@ -1820,51 +1999,104 @@ error:
 }
 
 static int
-write_reconstructed_file_full(char* output_file_path,
-                              uint32_t block_length,
-                              struct rfile** source_map,
-                              off_t* offset_map,
-                              uint32_t blocksz)
+write_reconstructed_blocks(FILE* wfp,
+                           char* output_file_path,
+                           uint32_t block_length,
+                           struct rfile** source_map,
+                           off_t* offset_map,
+                           uint32_t blocksz,
+                           bool zero_fill)
 {
-   FILE* wfp = NULL;
-   uint8_t buffer[blocksz];
+   uint8_t* buffer = NULL;
+   uint32_t chunk_blocks = 0;
+   uint32_t count = 0;
+   uint32_t run = 0;
+   uint32_t i = 0;
    struct rfile* s = NULL;
 
-   wfp = fopen(output_file_path, "wb+");
-   if (wfp == NULL)
+   chunk_blocks = RECONSTRUCT_BUFFER_SIZE / blocksz;
+   if (chunk_blocks == 0)
+   {
+      chunk_blocks = 1;
+   }
+
+   buffer = malloc((size_t)chunk_blocks * blocksz);
+   if (buffer == NULL)
    {
-      pgmoneta_log_error("reconstruct: unable to open file for reconstruction at %s", output_file_path);
       goto error;
    }
-   for (uint32_t i = 0; i < block_length; i++)
+
+   while (i < block_length)
    {
-      memset(buffer, 0, blocksz);
-      s = source_map[i];
-      if (s == NULL)
+      count = 0;
+      while (i < block_length && count < chunk_blocks)
       {
-         // zero fill the block since source doesn't exist
-         memset(buffer, 0, blocksz);
-         if (fwrite(buffer, 1, blocksz, wfp) != blocksz)
+         s = source_map[i];
+         if (s == NULL)
          {
-            pgmoneta_log_error("reconstruct: fail to write to file %s", output_file_path);
-            goto error;
+            if (zero_fill)
+            {
+               // zero fill the block since source doesn't exist
+               memset(buffer + (size_t)count * blocksz, 0, blocksz);
+               count++;
+            }
+            i++;
+            continue;
          }
-      }
-      else
-      {
-         // we might be able to use copy_file_range to have faster copy,
-         // but for now let's stay in user space
-         if (read_block(s, offset_map[i], blocksz, buffer))
+
+         run = 1;
+         while (i + run < block_length && count + run < chunk_blocks &&
+                source_map[i + run] == s &&
+                offset_map[i + run] == offset_map[i] + (off_t)run * blocksz)
          {
-            goto error;
+            run++;
          }
-         if (fwrite(buffer, 1, blocksz, wfp) != blocksz)
+
+         if (read_blocks(s, offset_map[i], (size_t)run * blocksz, buffer + (size_t)count * blocksz))
          {
-            pgmoneta_log_error("reconstruct: fail to write to file %s", output_file_path);
             goto error;
          }
+
+         count += run;
+         i += run;
+      }
+
+      if (count > 0 && fwrite(buffer, 1, (size_t)count * blocksz, wfp) != (size_t)count * blocksz)
+      {
+         pgmoneta_log_error("reconstruct: fail to write to file %s", output_file_path);
+         goto error;
       }
    }
+
+   free(buffer);
+   return 0;
+
+error:
+   free(buffer);
+   return 1;
+}
+
+static int
+write_reconstructed_file_full(char* output_file_path,
+                              uint32_t block_length,
+                              struct rfile** source_map,
+                              off_t* offset_map,
+                              uint32_t blocksz)
+{
+   FILE* wfp = NULL;
+
+   wfp = fopen(output_file_path, "wb+");
+   if (wfp == NULL)
+   {
+      pgmoneta_log_error("reconstruct: unable to open file for reconstruction at %s", output_file_path);
+      goto error;
+   }
+
+   if (write_reconstructed_blocks(wfp, output_file_path, block_length, source_map, offset_map, blocksz, true))
+   {
+      goto error;
+   }
+
    if (wfp != NULL)
    {
       fclose(wfp);
@@ -1889,12 +2121,10 @@ write_reconstructed_file_incremental(char* output_file_path,
    FILE* wfp = NULL;
    size_t hdrlen = 0;
    size_t hdrptr = 0;
-   uint8_t buffer[blocksz];
    uint32_t num_blocks = 0;
    uint32_t idx = 0;
    void* header = NULL;
    uint32_t magic = INCREMENTAL_MAGIC;
-   struct rfile* s = NULL;
 
    pgmoneta_log_debug("reconstruct incremental file %s", output_file_path);
 
@@ -1946,24 +2176,9 @@ write_reconstructed_file_incremental(char* output_file_path,
       goto error;
    }
 
-   for (uint32_t i = 0; i < block_length; i++)
+   if (write_reconstructed_blocks(wfp, output_file_path, block_length, source_map, offset_map, blocksz, false))
    {
-      memset(buffer, 0, blocksz);
-      s = source_map[i];
-      if (s != NULL)
-      {
-         // we might be able to use copy_file_range to have faster copy,
-         // but for now let's stay in user space
-         if (read_block(s, offset_map[i], blocksz, buffer))
-         {
-            goto error;
-         }
-         if (fwrite(buffer, 1, blocksz, wfp) != blocksz)
-         {
-            pgmoneta_log_error("reconstruct: fail to write to file %s", output_file_path);
-            goto error;
-         }
-      }
+      goto error;
    }
 
    free(header);
@@ -2241,6 +2456,7 @@ restore_backup_full(struct art* nodes)
 {
    int ret = RESTORE_OK;
    int server = -1;
+   bool materialized = false;
    char* directory = NULL;
    struct backup* backup = NULL;
    char* target_root = NULL;
@@ -2284,9 +2500,9 @@ restore_backup_full(struct art* nodes)
       }
    }
 
+   // Each file is decoded straight into the target, so no room is needed for a stored copy
    free_space = pgmoneta_free_space(target_root);
-   required_space =
-      backup->restore_size + (pgmoneta_get_number_of_workers(server) * backup->biggest_file_size);
+   required_space = backup->restore_size;
 
    if (free_space < required_space)
    {
@@ -2306,6 +2522,14 @@ restore_backup_full(struct art* nodes)
       goto error;
    }
 
+   if (pgmoneta_dedup_materialize(server, backup->label))
+   {
+      pgmoneta_log_error("Restore: Unable to read %s/%s from the chunk store", config->common.servers[server].name, backup->label);
+      ret = RESTORE_ERROR;
+      goto error;
+   }
+   materialized = true;
+
    pgmoneta_art_insert(nodes, NODE_TARGET_ROOT, (uintptr_t)target_root, ValueString);
    pgmoneta_art_insert(nodes, NODE_TARGET_BASE, (uintptr_t)target_base, ValueString);
    pgmoneta_log_trace("Full backup restore: %s", backup->label);
@@ -2315,6 +2539,8 @@ restore_backup_full(struct art* nodes)
       goto error;
    }
 
+   pgmoneta_dedup_dematerialize(server, backup->label);
+
    free(target_root);
    free(target_base);
 
@@ -2322,6 +2548,11 @@ restore_backup_full(struct art* nodes)
    return RESTORE_OK;
 
 error:
+   if (materialized)
+   {
+      pgmoneta_dedup_dematerialize(server, backup->label);
+   }
+
    free(target_root);
    free(target_base);
 
@@ -2335,6 +2566,7 @@ restore_backup_incremental(struct art* nodes)
    int ret = RESTORE_OK;
    int server = -1;
    bool combine_as_is = false;
+   bool materialized = false;
    char* directory = NULL;
    struct backup* backup = NULL;
    struct deque* labels = NULL;
@@ -2417,6 +2649,12 @@ restore_backup_incremental(struct art* nodes)
       goto error;
    }
 
+   if (materialize_backups(server, labels))
+   {
+      goto error;
+   }
+   materialized = true;
+
    pgmoneta_art_insert(nodes, NODE_TARGET_ROOT, (uintptr_t)target_root_combine, ValueString);
    pgmoneta_art_insert(nodes, NODE_TARGET_BASE, (uintptr_t)target_base_combine, ValueString);
 
@@ -2457,6 +2695,7 @@ restore_backup_incremental(struct art* nodes)
 
    pgmoneta_delete_server_workspace(server, (char*)pgmoneta_art_search(nodes, NODE_LABEL));
    cleanup_workspaces(server, labels);
+   dematerialize_backups(server, labels);
 
    pgmoneta_workflow_destroy(workflow);
    workflow = NULL;
@@ -2467,6 +2706,10 @@ restore_backup_incremental(struct art* nodes)
 error:
    pgmoneta_delete_server_workspace(server, (char*)pgmoneta_art_search(nodes, NODE_LABEL));
    cleanup_workspaces(server, labels);
+   if (materialized)
+   {
+      dematerialize_backups(server, labels);
+   }
 
    pgmoneta_delete_directory(target_base_combine);
    // purge each table space
@@ -2561,6 +2804,71 @@ cleanup_workspaces(int server, struct deque* labels)
    pgmoneta_deque_iterator_destroy(iter);
 }
 
+static int
+materialize_backups(int server, struct deque* labels)
+{
+   char* label = NULL;
+   char* failed = NULL;
+   struct deque_iterator* iter = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   pgmoneta_deque_iterator_create(labels, &iter);
+   while (pgmoneta_deque_iterator_next(iter))
+   {
+      label = (char*)pgmoneta_value_data(iter->value);
+
+      if (pgmoneta_dedup_materialize(server, label))
+      {
+         pgmoneta_log_error("Restore: Unable to read %s/%s from the chunk store", config->common.servers[server].name, label);
+         failed = label;
+         break;
+      }
+   }
+   pgmoneta_deque_iterator_destroy(iter);
+
+   if (failed == NULL)
+   {
+      return 0;
+   }
+
+   // release the backups materialized before the failed one
+   pgmoneta_deque_iterator_create(labels, &iter);
+   while (pgmoneta_deque_iterator_next(iter))
+   {
+      label = (char*)pgmoneta_value_data(iter->value);
+
+      if (label == failed)
+      {
+         break;
+      }
+
+      pgmoneta_dedup_dematerialize(server, label);
+   }
+   pgmoneta_deque_iterator_destroy(iter);
+
+   return 1;
+}
+
+static void
+dematerialize_backups(int server, struct deque* labels)
+{
+   struct deque_iterator* iter = NULL;
+
+   if (labels == NULL)
+   {
+      return;
+   }
+
+   pgmoneta_deque_iterator_create(labels, &iter);
+   while (pgmoneta_deque_iterator_next(iter))
+   {
+      pgmoneta_dedup_dematerialize(server, (char*)pgmoneta_value_data(iter->value));
+   }
+   pgmoneta_deque_iterator_destroy(iter);
+}
+
 static int
 construct_backup_label_chain(int server, char* newest_label, char* oldest_label, bool inclusive, struct deque** labels)
 {
@@ -2698,7 +3006,6 @@ do_reconstruct_backup_file(struct worker_common* wc)
    {
       goto error;
    }
-   input->common.workers->outcome = true;
    free(input);
    return;
 
@@ -2833,6 +3140,275 @@ error:
    return 1;
 }
 
+static int
+restore_file(char* from, char* to, struct workers* workers)
+{
+   char* target = NULL;
+   char* raw = NULL;
+   struct worker_input* wi = NULL;
+
+   if (!pgmoneta_is_encrypted(from) && !pgmoneta_is_compressed(from))
+   {
+      return pgmoneta_copy_file(from, to, workers);
+   }
+
+   target = pgmoneta_remove_suffix(to, ".aes");
+   if (pgmoneta_ends_with(target, ".zstd"))
+   {
+      raw = pgmoneta_remove_suffix(target, ".zstd");
+   }
+   else if (pgmoneta_ends_with(target, ".gz"))
+   {
+      raw = pgmoneta_remove_suffix(target, ".gz");
+   }
+   else if (pgmoneta_ends_with(target, ".lz4"))
+   {
+      raw = pgmoneta_remove_suffix(target, ".lz4");
+   }
+   else if (pgmoneta_ends_with(target, ".bz2"))
+   {
+      raw = pgmoneta_remove_suffix(target, ".bz2");
+   }
+   else
+   {
+      raw = pgmoneta_append(raw, target);
+   }
+
+   if (raw == NULL)
+   {
+      goto error;
+   }
+
+   if (pgmoneta_create_worker_input(NULL, from, raw, 0, workers, &wi))
+   {
+      goto error;
+   }
+
+   if (workers != NULL)
+   {
+      if (workers->outcome)
+      {
+         pgmoneta_workers_add(workers, do_restore_file, (struct worker_common*)wi);
+      }
+      else
+      {
+         free(wi);
+      }
+   }
+   else
+   {
+      do_restore_file((struct worker_common*)wi);
+   }
+
+   free(target);
+   free(raw);
+
+   return 0;
+
+error:
+
+   free(target);
+   free(raw);
+
+   return 1;
+}
+
+static void
+do_restore_file(struct worker_common* wc)
+{
+   struct worker_input* wi = (struct worker_input*)wc;
+   struct stream_reader* reader = NULL;
+   struct stat statbuf;
+   char* buffer = NULL;
+   char* dn = NULL;
+   size_t length = 0;
+   ssize_t nwritten;
+   size_t offset;
+   int fd = -1;
+
+   if (stat(wi->from, &statbuf))
+   {
+      pgmoneta_log_error("Restore: File doesn't exists: %s", wi->from);
+      goto error;
+   }
+
+   if (pgmoneta_stream_reader_create(wi->from, &reader))
+   {
+      pgmoneta_log_error("Restore: Unable to read %s", wi->from);
+      goto error;
+   }
+
+   buffer = (char*)malloc(RECONSTRUCT_BUFFER_SIZE);
+   dn = strdup(wi->to);
+   if (buffer == NULL || dn == NULL)
+   {
+      goto error;
+   }
+
+   if (pgmoneta_mkdir(dirname(dn)))
+   {
+      pgmoneta_log_error("Restore: Could not create directory for %s", wi->to);
+      goto error;
+   }
+
+   fd = open(wi->to, O_WRONLY | O_CREAT | O_TRUNC, statbuf.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO));
+   if (fd < 0)
+   {
+      pgmoneta_log_error("Restore: Unable to create file %s", wi->to);
+      goto error;
+   }
+
+   do
+   {
+      if (pgmoneta_stream_reader_read(reader, buffer, RECONSTRUCT_BUFFER_SIZE, &length))
+      {
+         pgmoneta_log_error("Restore: Unable to decode %s", wi->from);
+         goto error;
+      }
+
+      offset = 0;
+      while (offset < length)
+      {
+         nwritten = write(fd, buffer + offset, length - offset);
+         if (nwritten < 0)
+         {
+            if (errno == EINTR)
+            {
+               continue;
+            }
+            pgmoneta_log_error("Restore: Unable to write to %s (%s)", wi->to, strerror(errno));
+            errno = 0;
+            goto error;
+         }
+         offset += nwritten;
+      }
+   }
+   while (length == RECONSTRUCT_BUFFER_SIZE);
+
+   fsync(fd);
+
+   if (close(fd) < 0)
+   {
+      fd = -1;
+      goto error;
+   }
+
+#ifdef DEBUG
+   pgmoneta_log_trace("FILETRACKER | Restore | %s | %s |", wi->from, wi->to);
+#endif
+
+   pgmoneta_stream_reader_destroy(reader);
+   free(buffer);
+   free(dn);
+   free(wi);
+
+   return;
+
+error:
+
+   if (fd >= 0)
+   {
+      close(fd);
+   }
+
+   if (wi->common.workers != NULL)
+   {
+      wi->common.workers->outcome = false;
+   }
+
+   pgmoneta_stream_reader_destroy(reader);
+   free(buffer);
+   free(dn);
+   free(wi);
+}
+
+static int
+restore_directory(char* from, char* to, char** restore_last_files_names, struct workers* workers)
+{
+   DIR* d = opendir(from);
+   char* from_buffer = NULL;
+   char* to_buffer = NULL;
+   struct dirent* entry;
+   struct stat statbuf;
+   bool file_is_excluded;
+
+   if (d == NULL)
+   {
+      goto error;
+   }
+
+   pgmoneta_mkdir(to);
+
+   while ((entry = readdir(d)))
+   {
+      if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+      {
+         continue;
+      }
+
+      from_buffer = pgmoneta_append(from_buffer, from);
+      from_buffer = pgmoneta_append(from_buffer, "/");
+      from_buffer = pgmoneta_append(from_buffer, entry->d_name);
+
+      to_buffer = pgmoneta_append(to_buffer, to);
+      to_buffer = pgmoneta_append(to_buffer, "/");
+      to_buffer = pgmoneta_append(to_buffer, entry->d_name);
+
+      if (!stat(from_buffer, &statbuf))
+      {
+         if (S_ISDIR(statbuf.st_mode))
+         {
+            if (restore_directory(from_buffer, to_buffer, restore_last_files_names, workers))
+            {
+               goto error;
+            }
+         }
+         else
+         {
+            file_is_excluded = false;
+            if (restore_last_files_names != NULL)
+            {
+               for (int i = 0; restore_last_files_names[i] != NULL; i++)
+               {
+                  if (!strcmp(from_buffer, restore_last_files_names[i]))
+                  {
+                     file_is_excluded = true;
+                     break;
+                  }
+               }
+            }
+
+            if (!file_is_excluded && restore_file(from_buffer, to_buffer, workers))
+            {
+               goto error;
+            }
+         }
+      }
+
+      free(from_buffer);
+      free(to_buffer);
+
+      from_buffer = NULL;
+      to_buffer = NULL;
+   }
+
+   closedir(d);
+
+   return 0;
+
+error:
+
+   if (d != NULL)
+   {
+      closedir(d);
+   }
+
+   free(from_buffer);
+   free(to_buffer);
+
+   return 1;
+}
+
 static int
 copy_tablespaces_restore(char* from, char* to, char* base, char* server, char* id, struct backup* backup, struct workers* workers)
 {
@@ -2943,7 +3519,7 @@ copy_tablespaces_restore(char* from, char* to, char* base, char* server, char* i
             pgmoneta_mkdir(to_directory);
             pgmoneta_symlink_at_file(to_oid, relative_directory);
 
-            pgmoneta_copy_directory(link, to_directory, NULL, workers);
+            restore_directory(link, to_directory, NULL, workers);
 
             free(to_oid);
             free(to_directory);
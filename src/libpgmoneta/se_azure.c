@@ -26,8 +26,10 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+
 /* pgmoneta */
 #include <pgmoneta.h>
+#include <deque.h>
 #include <http.h>
 #include <logging.h>
 #include <security.h>
@@ -37,21 +39,89 @@
 /* system */
 #include <assert.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define AZURE_VERSION        "2021-08-06"
+#define AZURE_MAX_BLOCKS     50000
+#define AZURE_RETRIES        3
+#define AZURE_RESPONSE_SIZE  65536
+
+/** @struct azure_upload
+ * Defines the upload of a file, either as a single blob or as a list of blocks
+ */
+struct azure_upload
+{
+   char* local_path;   /**< The path of the local file */
+   char* azure_path;   /**< The name of the blob */
+   int fd;             /**< The local file */
+   size_t size;        /**< The size of the file */
+   size_t block_size;  /**< The size of a block */
+   int blocks;         /**< The number of blocks */
+   int next_block;     /**< The next block to send, starting at 0 */
+   int done_blocks;    /**< The number of blocks sent */
+   int active;         /**< The number of blocks being sent, or waiting to be sent again */
+   bool block_list;    /**< Use Put Block and Put Block List */
+   bool placeholder;   /**< The local file is a placeholder for an empty directory */
+};
+
+/** @struct azure_transfer
+ * Defines a request slot of the connection pool
+ */
+struct azure_transfer
+{
+   CURL* handle;                  /**< The curl handle, keeping its connection alive between requests */
+   struct azure_upload* upload;   /**< The upload, or NULL if the slot is free */
+   int block;                     /**< The block number */
+   int attempt;                   /**< The number of failed attempts of the block */
+   bool running;                  /**< The request is in flight */
+   struct timespec retry_at;      /**< The time to send the block again */
+   unsigned char* buffer;         /**< The content of the block */
+   size_t buffer_size;            /**< The size of the buffer */
+   size_t length;                 /**< The length of the block */
+   size_t position;               /**< The position of the next byte to send */
+   struct curl_slist* headers;    /**< The request headers */
+   char* response;                /**< The response body */
+};
 
 static char* azure_storage_name(void);
 static int azure_storage_setup(char* name, struct art*);
 static int azure_storage_execute(char* name, struct art*);
 static int azure_storage_teardown(char* name, struct art*);
 
-static int azure_upload_files(char* local_root, char* azure_root, char* relative_path);
-static int azure_send_upload_request(char* local_root, char* azure_root, char* relative_path);
+static int azure_find_files(char* local_root, char* relative_path, struct deque* files);
+static int azure_upload_files(char* local_root, char* azure_root, struct deque* files);
+
+static int azure_upload_create(char* local_root, char* azure_root, char* relative_path, struct azure_upload** upload);
+static int azure_upload_complete(struct azure_upload* upload);
+static void azure_upload_destroy(struct azure_upload* upload);
+
+static int azure_transfer_start(struct azure_transfer* transfer);
+static int azure_transfer_finish(struct azure_transfer* transfer, CURLcode result, bool* retry);
+static void azure_transfer_reset(struct azure_transfer* transfer);
+
+static int azure_prepare(CURL* handle, char* azure_path, char* comp, char* block_id, size_t length, bool blob_type, struct curl_slist** headers);
+static int azure_response_code(CURL* handle, char* response, bool* retry);
+static char* azure_block_id(int block);
+static void azure_now(struct timespec* ts);
+
+static size_t azure_read_callback(char* buffer, size_t size, size_t nitems, void* userdata);
+static size_t azure_write_callback(char* ptr, size_t size, size_t nmemb, void* userdata);
 
 static char* azure_get_host(void);
 static char* azure_get_basepath(int server, char* identifier);
+static char* azure_get_url(char* azure_path, char** uri_path);
 
 static CURL* curl = NULL;
+static CURLM* multi = NULL;
+static CURLSH* share = NULL;
+static char* signing_key = NULL;
+static size_t signing_key_length = 0;
+static uint64_t uploaded = 0;
 
 struct workflow*
 pgmoneta_storage_create_azure(void)
@@ -84,12 +154,6 @@ azure_storage_setup(char* name __attribute__((unused)), struct art* nodes)
 
    config = (struct main_configuration*)shmem;
 
-   curl = curl_easy_init();
-   if (curl == NULL)
-   {
-      goto error;
-   }
-
 #ifdef DEBUG
    if (pgmoneta_log_is_enabled(PGMONETA_LOGGING_LEVEL_DEBUG1))
    {
@@ -107,6 +171,38 @@ azure_storage_setup(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_log_debug("Azure storage engine (setup): %s/%s", config->common.servers[server].name, label);
 
+   // all requests share one connection cache, so connections are kept alive and reused
+   share = curl_share_init();
+   if (share == NULL)
+   {
+      goto error;
+   }
+
+   curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+   curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+   curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+   multi = curl_multi_init();
+   if (multi == NULL)
+   {
+      goto error;
+   }
+
+   curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)config->azure_concurrency);
+
+   curl = curl_easy_init();
+   if (curl == NULL)
+   {
+      goto error;
+   }
+
+   // Decode the Azure storage account shared key.
+   if (pgmoneta_base64_decode(config->azure_shared_key, strlen(config->azure_shared_key), (void**)&signing_key, &signing_key_length))
+   {
+      pgmoneta_log_error("Azure: Invalid shared key");
+      goto error;
+   }
+
    return 0;
 
 error:
@@ -123,6 +219,8 @@ azure_storage_execute(char* name __attribute__((unused)), struct art* nodes)
    double remote_azure_elapsed_time;
    char* local_root = NULL;
    char* azure_root = NULL;
+   char* size = NULL;
+   struct deque* files = NULL;
    struct main_configuration* config;
 
 #ifdef HAVE_FREEBSD
@@ -154,7 +252,19 @@ azure_storage_execute(char* name __attribute__((unused)), struct art* nodes)
    local_root = pgmoneta_get_server_backup_identifier(server, label);
    azure_root = azure_get_basepath(server, label);
 
-   if (azure_upload_files(local_root, azure_root, ""))
+   uploaded = 0;
+
+   if (pgmoneta_deque_create(false, &files))
+   {
+      goto error;
+   }
+
+   if (azure_find_files(local_root, "", files))
+   {
+      goto error;
+   }
+
+   if (azure_upload_files(local_root, azure_root, files))
    {
       goto error;
    }
@@ -169,6 +279,13 @@ azure_storage_execute(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_update_info_double(local_root, INFO_REMOTE_AZURE_ELAPSED, remote_azure_elapsed_time);
 
+   size = pgmoneta_translate_file_size(uploaded);
+   pgmoneta_log_info("Azure: %s/%s uploaded %s in %.3f seconds (%.2f MB/s)",
+                     config->common.servers[server].name, label, size, remote_azure_elapsed_time,
+                     remote_azure_elapsed_time > 0 ? ((double)uploaded / remote_azure_elapsed_time) / 1e6 : 0.0);
+
+   free(size);
+   pgmoneta_deque_destroy(files);
    free(local_root);
    free(azure_root);
 
@@ -176,6 +293,7 @@ azure_storage_execute(char* name __attribute__((unused)), struct art* nodes)
 
 error:
 
+   pgmoneta_deque_destroy(files);
    free(local_root);
    free(azure_root);
 
@@ -213,6 +331,14 @@ azure_storage_teardown(char* name __attribute__((unused)), struct art* nodes)
    pgmoneta_delete_directory(root);
 
    curl_easy_cleanup(curl);
+   curl = NULL;
+   curl_multi_cleanup(multi);
+   multi = NULL;
+   curl_share_cleanup(share);
+   share = NULL;
+   free(signing_key);
+   signing_key = NULL;
+   signing_key_length = 0;
 
    pgmoneta_log_debug("Azure storage engine (teardown): %s/%s", config->common.servers[server].name, label);
 
@@ -222,12 +348,13 @@ azure_storage_teardown(char* name __attribute__((unused)), struct art* nodes)
 }
 
 static int
-azure_upload_files(char* local_root, char* azure_root, char* relative_path)
+azure_find_files(char* local_root, char* relative_path, struct deque* files)
 {
    char* local_path = NULL;
    char* relative_file;
    char* new_file;
    bool copied_files = false;
+   FILE* file = NULL;
    DIR* dir;
    struct dirent* entry;
 
@@ -252,7 +379,10 @@ azure_upload_files(char* local_root, char* azure_root, char* relative_path)
 
          snprintf(relative_dir, sizeof(relative_dir), "%s/%s", relative_path, entry->d_name);
 
-         azure_upload_files(local_root, azure_root, relative_dir);
+         if (azure_find_files(local_root, relative_dir, files))
+         {
+            goto error;
+         }
       }
       else
       {
@@ -264,18 +394,14 @@ azure_upload_files(char* local_root, char* azure_root, char* relative_path)
          relative_file = pgmoneta_append(relative_file, "/");
          relative_file = pgmoneta_append(relative_file, entry->d_name);
 
-         if (azure_send_upload_request(local_root, azure_root, relative_file))
-         {
-            free(relative_file);
-            goto error;
-         }
+         pgmoneta_deque_add(files, NULL, (uintptr_t)relative_file, ValueString);
 
          free(relative_file);
       }
    }
 
    // In case no files are copied, then the directory is empty.
-   // Create a .pgmoneta file for uploading.
+   // Create a .pgmoneta file for uploading, it is removed once uploaded.
    if (!copied_files)
    {
       relative_file = NULL;
@@ -288,15 +414,19 @@ azure_upload_files(char* local_root, char* azure_root, char* relative_path)
       new_file = pgmoneta_append(new_file, local_root);
       new_file = pgmoneta_append(new_file, relative_file);
 
-      FILE* file = fopen(new_file, "w");
-
-      pgmoneta_permission(new_file, 6, 4, 4);
-
-      azure_send_upload_request(local_root, azure_root, relative_file);
+      file = fopen(new_file, "w");
+      if (file == NULL)
+      {
+         free(new_file);
+         free(relative_file);
+         goto error;
+      }
 
       fclose(file);
 
-      remove(new_file);
+      pgmoneta_permission(new_file, 6, 4, 4);
+
+      pgmoneta_deque_add(files, NULL, (uintptr_t)relative_file, ValueString);
 
       free(new_file);
       free(relative_file);
@@ -310,7 +440,10 @@ azure_upload_files(char* local_root, char* azure_root, char* relative_path)
 
 error:
 
-   closedir(dir);
+   if (dir != NULL)
+   {
+      closedir(dir);
+   }
 
    free(local_path);
 
@@ -318,224 +451,860 @@ error:
 }
 
 static int
-azure_send_upload_request(char* local_root, char* azure_root, char* relative_path)
+azure_upload_files(char* local_root, char* azure_root, struct deque* files)
 {
-   char utc_date[UTC_TIME_LENGTH];
-   char* string_to_sign = NULL;
-   char* signing_key = NULL;
-   char* signature = NULL;
-   char* base64_signature = NULL;
-   size_t base64_signature_length;
-   char* local_path = NULL;
-   char* azure_path = NULL;
-   char* azure_host = NULL;
-   char* azure_url = NULL;
-   char* auth_value = NULL;
-   unsigned char* signature_hmac = NULL;
-   unsigned char* signature_hex = NULL;
-   int hmac_length = 0;
-   size_t signing_key_length = 0;
-   FILE* file = NULL;
-   struct stat file_info;
-   CURLcode res = -1;
-   struct curl_slist* chunk = NULL;
+   int concurrency = 0;
+   int running = 0;
+   int queued = 0;
+   int busy = 0;
+   bool waiting = false;
+   bool retry = false;
+   char* relative_file = NULL;
+   struct timespec now;
+   struct azure_upload* current = NULL;
+   struct azure_upload* upload = NULL;
+   struct azure_transfer* transfers = NULL;
+   struct azure_transfer* transfer = NULL;
+   CURLMsg* msg = NULL;
+   bool failed = false;
    struct main_configuration* config;
 
    config = (struct main_configuration*)shmem;
 
-   local_path = pgmoneta_append(local_path, local_root);
-   local_path = pgmoneta_append(local_path, relative_path);
+   concurrency = config->azure_concurrency > 0 ? config->azure_concurrency : 1;
+
+   transfers = (struct azure_transfer*)calloc(concurrency, sizeof(struct azure_transfer));
+   if (transfers == NULL)
+   {
+      goto error;
+   }
 
-   azure_path = pgmoneta_append(azure_path, azure_root);
-   azure_path = pgmoneta_append(azure_path, relative_path);
+   for (int i = 0; i < concurrency; i++)
+   {
+      transfers[i].handle = curl_easy_init();
+      if (transfers[i].handle == NULL)
+      {
+         goto error;
+      }
+   }
 
-   memset(&utc_date[0], 0, sizeof(utc_date));
+   // the blocks of the current file, and then the following files, are
+   // sent on the free slots while the other slots are busy. A failed block
+   // keeps its slot, and is sent again once its back off has passed
+   while (!failed)
+   {
+      azure_now(&now);
+      busy = 0;
+      waiting = false;
 
-   if (pgmoneta_get_timestamp_UTC_format(utc_date))
+      for (int i = 0; i < concurrency && !failed; i++)
+      {
+         transfer = &transfers[i];
+
+         if (transfer->upload != NULL)
+         {
+            busy++;
+
+            if (!transfer->running)
+            {
+               if (pgmoneta_compute_duration(now, transfer->retry_at) > 0)
+               {
+                  waiting = true;
+               }
+               else if (azure_transfer_start(transfer))
+               {
+                  failed = true;
+               }
+            }
+
+            continue;
+         }
+
+         while (current == NULL || current->next_block >= current->blocks)
+         {
+            current = NULL;
+
+            if (pgmoneta_deque_empty(files))
+            {
+               break;
+            }
+
+            relative_file = (char*)pgmoneta_deque_poll(files, NULL);
+
+            if (azure_upload_create(local_root, azure_root, relative_file, &current))
+            {
+               failed = true;
+            }
+
+            free(relative_file);
+            relative_file = NULL;
+
+            if (failed)
+            {
+               break;
+            }
+         }
+
+         if (current == NULL)
+         {
+            continue;
+         }
+
+         transfer->upload = current;
+         transfer->block = current->next_block++;
+         transfer->attempt = 0;
+         current->active++;
+         busy++;
+
+         if (azure_transfer_start(transfer))
+         {
+            failed = true;
+         }
+      }
+
+      if (failed || busy == 0)
+      {
+         break;
+      }
+
+      if (curl_multi_perform(multi, &running) != CURLM_OK)
+      {
+         failed = true;
+         break;
+      }
+
+      while ((msg = curl_multi_info_read(multi, &queued)) != NULL)
+      {
+         if (msg->msg != CURLMSG_DONE)
+         {
+            continue;
+         }
+
+         transfer = NULL;
+         curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&transfer);
+
+         curl_multi_remove_handle(multi, transfer->handle);
+         transfer->running = false;
+
+         upload = transfer->upload;
+
+         if (azure_transfer_finish(transfer, msg->data.result, &retry))
+         {
+            if (retry && transfer->attempt < AZURE_RETRIES)
+            {
+               // only this block is sent again, after 1, 2, 4, ... seconds
+               azure_now(&transfer->retry_at);
+               transfer->retry_at.tv_sec += 1 << transfer->attempt;
+               transfer->attempt++;
+
+               pgmoneta_log_warn("Azure: Retrying %s (block %d, attempt %d)", upload->azure_path, transfer->block, transfer->attempt);
+               continue;
+            }
+
+            failed = true;
+         }
+
+         azure_transfer_reset(transfer);
+
+         if (!failed && upload->active == 0 && upload->done_blocks == upload->blocks)
+         {
+            if (azure_upload_complete(upload))
+            {
+               failed = true;
+            }
+            else
+            {
+               if (upload == current)
+               {
+                  current = NULL;
+               }
+               azure_upload_destroy(upload);
+               continue;
+            }
+         }
+
+         if (failed && upload->active == 0 && upload != current)
+         {
+            azure_upload_destroy(upload);
+         }
+      }
+
+      if (!failed && (running > 0 || waiting))
+      {
+         curl_multi_poll(multi, NULL, 0, waiting ? 100 : 1000, NULL);
+      }
+   }
+
+   if (failed)
    {
       goto error;
    }
 
-   file = fopen(local_path, "rb");
-   if (file == NULL)
+   for (int i = 0; i < concurrency; i++)
+   {
+      curl_easy_cleanup(transfers[i].handle);
+      free(transfers[i].buffer);
+   }
+   free(transfers);
+
+   return 0;
+
+error:
+
+   // cancel the requests in flight. The blocks already sent are never
+   // committed, and Azure discards uncommitted blocks by itself
+   for (int i = 0; transfers != NULL && i < concurrency; i++)
+   {
+      upload = transfers[i].upload;
+
+      if (upload != NULL)
+      {
+         if (transfers[i].running)
+         {
+            curl_multi_remove_handle(multi, transfers[i].handle);
+         }
+         azure_transfer_reset(&transfers[i]);
+
+         if (upload->active == 0 && upload != current)
+         {
+            azure_upload_destroy(upload);
+         }
+      }
+   }
+
+   azure_upload_destroy(current);
+
+   for (int i = 0; transfers != NULL && i < concurrency; i++)
+   {
+      curl_easy_cleanup(transfers[i].handle);
+      free(transfers[i].buffer);
+   }
+   free(transfers);
+
+   return 1;
+}
+
+static int
+azure_upload_create(char* local_root, char* azure_root, char* relative_path, struct azure_upload** upload)
+{
+   struct stat st;
+   struct azure_upload* u = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   *upload = NULL;
+
+   u = (struct azure_upload*)malloc(sizeof(struct azure_upload));
+   if (u == NULL)
    {
       goto error;
    }
 
-   if (fstat(fileno(file), &file_info) != 0)
+   memset(u, 0, sizeof(struct azure_upload));
+   u->fd = -1;
+
+   u->local_path = pgmoneta_append(u->local_path, local_root);
+   u->local_path = pgmoneta_append(u->local_path, relative_path);
+
+   u->azure_path = pgmoneta_append(u->azure_path, azure_root);
+   u->azure_path = pgmoneta_append(u->azure_path, relative_path);
+
+   u->placeholder = pgmoneta_ends_with(relative_path, "/.pgmoneta");
+
+   u->fd = open(u->local_path, O_RDONLY);
+   if (u->fd == -1 || fstat(u->fd, &st) != 0)
    {
+      pgmoneta_log_error("Azure: Could not open %s", u->local_path);
       goto error;
    }
 
-   // Construct string to sign.
-   if (file_info.st_size == 0)
+   u->size = (size_t)st.st_size;
+   u->block_size = (size_t)config->azure_block_size;
+
+   // a block blob holds at most 50000 blocks, so the blocks of a very big file are made bigger
+   if (u->size > u->block_size * AZURE_MAX_BLOCKS)
    {
-      string_to_sign = pgmoneta_append(string_to_sign, "PUT\n\n\n\n\n\n\n\n\n\n\n\nx-ms-blob-type:BlockBlob\nx-ms-date:");
+      u->block_size = (u->size + AZURE_MAX_BLOCKS - 1) / AZURE_MAX_BLOCKS;
+      u->block_size = ((u->block_size + 1024 * 1024 - 1) / (1024 * 1024)) * (1024 * 1024);
    }
-   else
+
+   u->block_list = u->size > u->block_size;
+   u->blocks = u->block_list ? (int)((u->size + u->block_size - 1) / u->block_size) : 1;
+   u->next_block = 0;
+
+   pgmoneta_log_trace("Azure: %s (%zu bytes, %d blocks)", u->azure_path, u->size, u->blocks);
+
+   *upload = u;
+
+   return 0;
+
+error:
+
+   azure_upload_destroy(u);
+
+   return 1;
+}
+
+static int
+azure_upload_complete(struct azure_upload* upload)
+{
+   char* body = NULL;
+   char* block_id = NULL;
+   struct azure_transfer commit;
+   bool retry = false;
+   CURLcode res;
+
+   memset(&commit, 0, sizeof(struct azure_transfer));
+
+   if (!upload->block_list)
    {
-      string_to_sign = pgmoneta_append(string_to_sign, "PUT\n\n\n");
-      string_to_sign = pgmoneta_append(string_to_sign, (char*)file_info.st_size);
-      string_to_sign = pgmoneta_append(string_to_sign, "\n\n\n\n\n\n\n\n\nx-ms-blob-type:BlockBlob\nx-ms-date:");
+      return 0;
    }
 
-   string_to_sign = pgmoneta_append(string_to_sign, utc_date);
-   string_to_sign = pgmoneta_append(string_to_sign, "\nx-ms-version:2021-08-06\n/");
-   string_to_sign = pgmoneta_append(string_to_sign, config->azure_storage_account);
-   string_to_sign = pgmoneta_append(string_to_sign, "/");
-   string_to_sign = pgmoneta_append(string_to_sign, config->azure_container);
-   string_to_sign = pgmoneta_append(string_to_sign, "/");
-   string_to_sign = pgmoneta_append(string_to_sign, azure_path);
+   body = pgmoneta_append(body, "<?xml version=\"1.0\" encoding=\"utf-8\"?><BlockList>");
+   for (int i = 0; i < upload->blocks; i++)
+   {
+      block_id = azure_block_id(i);
 
-   // Decode the Azure storage account shared key.
-   pgmoneta_base64_decode(config->azure_shared_key, strlen(config->azure_shared_key), (void**)&signing_key, &signing_key_length);
+      body = pgmoneta_append(body, "<Latest>");
+      body = pgmoneta_append(body, block_id);
+      body = pgmoneta_append(body, "</Latest>");
 
-   // Construct the signature.
-   if (pgmoneta_generate_string_hmac_sha256_hash(signing_key, signing_key_length, string_to_sign, strlen(string_to_sign), &signature_hmac, &hmac_length))
+      free(block_id);
+   }
+   body = pgmoneta_append(body, "</BlockList>");
+
+   commit.handle = curl;
+   commit.buffer = (unsigned char*)body;
+   commit.length = strlen(body);
+
+   for (int attempt = 0; attempt <= AZURE_RETRIES; attempt++)
    {
-      goto error;
+      if (attempt > 0)
+      {
+         pgmoneta_log_warn("Azure: Retrying the block list of %s (attempt %d)", upload->azure_path, attempt);
+         sleep(1 << (attempt - 1));
+      }
+
+      curl_slist_free_all(commit.headers);
+      commit.headers = NULL;
+      free(commit.response);
+      commit.response = NULL;
+      commit.position = 0;
+
+      curl_easy_reset(curl);
+
+      if (azure_prepare(curl, upload->azure_path, "blocklist", NULL, commit.length, false, &commit.headers))
+      {
+         goto error;
+      }
+
+      curl_easy_setopt(curl, CURLOPT_READFUNCTION, azure_read_callback);
+      curl_easy_setopt(curl, CURLOPT_READDATA, (void*)&commit);
+      curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)commit.length);
+      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, azure_write_callback);
+      curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*)&commit.response);
+
+      res = curl_easy_perform(curl);
+      if (res != CURLE_OK)
+      {
+         pgmoneta_log_error("Azure: %s", curl_easy_strerror(res));
+         retry = true;
+         continue;
+      }
+
+      if (azure_response_code(curl, commit.response, &retry))
+      {
+         if (retry)
+         {
+            continue;
+         }
+         break;
+      }
+
+      curl_slist_free_all(commit.headers);
+      free(commit.response);
+      free(body);
+
+      return 0;
    }
 
-   // Encode the signature.
-   pgmoneta_base64_encode((char*) signature_hmac, hmac_length, &base64_signature, &base64_signature_length);
+error:
 
-   // Construct the authorization header.
-   auth_value = pgmoneta_append(auth_value, "SharedKey ");
-   auth_value = pgmoneta_append(auth_value, config->azure_storage_account);
-   auth_value = pgmoneta_append(auth_value, ":");
-   auth_value = pgmoneta_append(auth_value, base64_signature);
+   pgmoneta_log_error("Azure: Could not commit the block list of %s", upload->azure_path);
 
-   chunk = pgmoneta_http_add_header(chunk, "Authorization", auth_value);
+   curl_slist_free_all(commit.headers);
+   free(commit.response);
+   free(body);
 
-   chunk = pgmoneta_http_add_header(chunk, "x-ms-blob-type", "BlockBlob");
+   return 1;
+}
 
-   chunk = pgmoneta_http_add_header(chunk, "x-ms-date", utc_date);
+static void
+azure_upload_destroy(struct azure_upload* upload)
+{
+   if (upload == NULL)
+   {
+      return;
+   }
 
-   chunk = pgmoneta_http_add_header(chunk, "x-ms-version", "2021-08-06");
+   if (upload->fd != -1)
+   {
+      close(upload->fd);
+   }
 
-   if (pgmoneta_http_set_header_option(curl, chunk))
+   if (upload->placeholder)
    {
-      goto error;
+      remove(upload->local_path);
    }
 
-   azure_host = azure_get_host();
+   free(upload->local_path);
+   free(upload->azure_path);
+   free(upload);
+}
 
-   azure_url = pgmoneta_append(azure_url, "https://");
-   azure_url = pgmoneta_append(azure_url, azure_host);
-   azure_url = pgmoneta_append(azure_url, "/");
-   azure_url = pgmoneta_append(azure_url, azure_path);
+static int
+azure_transfer_start(struct azure_transfer* transfer)
+{
+   off_t offset = 0;
+   ssize_t r = 0;
+   char* block_id = NULL;
+   struct azure_upload* upload = transfer->upload;
+
+   offset = (off_t)transfer->block * (off_t)upload->block_size;
+   transfer->length = MIN(upload->block_size, upload->size - (size_t)offset);
+   transfer->position = 0;
+
+   curl_slist_free_all(transfer->headers);
+   transfer->headers = NULL;
+   free(transfer->response);
+   transfer->response = NULL;
 
-   pgmoneta_http_set_request_option(curl, HTTP_PUT);
+   if (transfer->buffer_size < transfer->length)
+   {
+      free(transfer->buffer);
+      transfer->buffer = (unsigned char*)malloc(transfer->length);
+      if (transfer->buffer == NULL)
+      {
+         transfer->buffer_size = 0;
+         goto error;
+      }
+      transfer->buffer_size = transfer->length;
+   }
 
-   pgmoneta_http_set_url_option(curl, azure_url);
+   while (transfer->position < transfer->length)
+   {
+      r = pread(upload->fd, transfer->buffer + transfer->position, transfer->length - transfer->position, offset + transfer->position);
+      if (r <= 0)
+      {
+         pgmoneta_log_error("Azure: Could not read %s", upload->local_path);
+         goto error;
+      }
+      transfer->position += r;
+   }
+   transfer->position = 0;
 
-   curl_easy_setopt(curl, CURLOPT_READDATA, (void*) file);
+   if (upload->block_list)
+   {
+      block_id = azure_block_id(transfer->block);
+   }
 
-   curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)file_info.st_size);
+   curl_easy_reset(transfer->handle);
 
-   res = curl_easy_perform(curl);
-   if (res != CURLE_OK)
+   if (azure_prepare(transfer->handle, upload->azure_path, upload->block_list ? "block" : NULL, block_id,
+                     transfer->length, !upload->block_list, &transfer->headers))
    {
-      fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
       goto error;
    }
 
-   free(local_path);
-   free(azure_path);
-   free(azure_url);
-   free(azure_host);
-   free(signature);
-   free(base64_signature);
-   free(signature_hmac);
-   free(signature_hex);
-   free(string_to_sign);
-   free(auth_value);
+   curl_easy_setopt(transfer->handle, CURLOPT_READFUNCTION, azure_read_callback);
+   curl_easy_setopt(transfer->handle, CURLOPT_READDATA, (void*)transfer);
+   curl_easy_setopt(transfer->handle, CURLOPT_INFILESIZE_LARGE, (curl_off_t)transfer->length);
+   curl_easy_setopt(transfer->handle, CURLOPT_WRITEFUNCTION, azure_write_callback);
+   curl_easy_setopt(transfer->handle, CURLOPT_WRITEDATA, (void*)&transfer->response);
+   curl_easy_setopt(transfer->handle, CURLOPT_PRIVATE, (void*)transfer);
 
-   curl_slist_free_all(chunk);
+   if (curl_multi_add_handle(multi, transfer->handle) != CURLM_OK)
+   {
+      goto error;
+   }
+
+   transfer->running = true;
+
+   free(block_id);
 
-   fclose(file);
    return 0;
 
 error:
 
-   if (local_path != NULL)
+   free(block_id);
+
+   return 1;
+}
+
+static int
+azure_transfer_finish(struct azure_transfer* transfer, CURLcode result, bool* retry)
+{
+   struct azure_upload* upload = transfer->upload;
+
+   *retry = false;
+
+   if (result != CURLE_OK)
    {
-      free(local_path);
+      pgmoneta_log_error("Azure: Could not send %s (block %d): %s", upload->azure_path, transfer->block, curl_easy_strerror(result));
+      *retry = true;
+      goto error;
    }
 
-   if (azure_path != NULL)
+   if (azure_response_code(transfer->handle, transfer->response, retry))
    {
-      free(azure_path);
+      pgmoneta_log_error("Azure: Could not send %s (block %d)", upload->azure_path, transfer->block);
+      goto error;
    }
 
-   if (azure_url != NULL)
+   upload->done_blocks++;
+   uploaded += transfer->length;
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+static void
+azure_transfer_reset(struct azure_transfer* transfer)
+{
+   if (transfer->upload != NULL)
+   {
+      transfer->upload->active--;
+   }
+
+   curl_slist_free_all(transfer->headers);
+
+   transfer->headers = NULL;
+   transfer->upload = NULL;
+   transfer->block = 0;
+   transfer->attempt = 0;
+   transfer->running = false;
+   transfer->length = 0;
+   transfer->position = 0;
+   free(transfer->response);
+   transfer->response = NULL;
+}
+
+static int
+azure_prepare(CURL* handle, char* azure_path, char* comp, char* block_id, size_t length, bool blob_type, struct curl_slist** headers)
+{
+   char utc_date[UTC_TIME_LENGTH];
+   char number[32];
+   char* string_to_sign = NULL;
+   char* base64_signature = NULL;
+   size_t base64_signature_length;
+   char* azure_url = NULL;
+   char* uri_path = NULL;
+   char* escaped = NULL;
+   char* auth_value = NULL;
+   unsigned char* signature_hmac = NULL;
+   int hmac_length = 0;
+   struct curl_slist* chunk = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   *headers = NULL;
+
+   memset(&utc_date[0], 0, sizeof(utc_date));
+
+   if (pgmoneta_get_timestamp_UTC_format(utc_date))
    {
-      free(azure_url);
+      goto error;
    }
 
-   if (azure_host != NULL)
+   azure_url = azure_get_url(azure_path, &uri_path);
+
+   // Construct string to sign, the Content-Length is empty for an empty body.
+   string_to_sign = pgmoneta_append(string_to_sign, "PUT\n\n\n");
+   if (length > 0)
    {
-      free(azure_host);
+      snprintf(number, sizeof(number), "%zu", length);
+      string_to_sign = pgmoneta_append(string_to_sign, number);
    }
+   string_to_sign = pgmoneta_append(string_to_sign, "\n\n\n\n\n\n\n\n\n");
+   if (blob_type)
+   {
+      string_to_sign = pgmoneta_append(string_to_sign, "x-ms-blob-type:BlockBlob\n");
+   }
+   string_to_sign = pgmoneta_append(string_to_sign, "x-ms-date:");
+   string_to_sign = pgmoneta_append(string_to_sign, utc_date);
+   string_to_sign = pgmoneta_append(string_to_sign, "\nx-ms-version:" AZURE_VERSION "\n/");
+   string_to_sign = pgmoneta_append(string_to_sign, config->azure_storage_account);
+   string_to_sign = pgmoneta_append(string_to_sign, uri_path);
 
-   if (signature != NULL)
+   // The query parameters are signed in alphabetical order.
+   if (block_id != NULL)
    {
-      free(signature);
+      string_to_sign = pgmoneta_append(string_to_sign, "\nblockid:");
+      string_to_sign = pgmoneta_append(string_to_sign, block_id);
+   }
+   if (comp != NULL)
+   {
+      string_to_sign = pgmoneta_append(string_to_sign, "\ncomp:");
+      string_to_sign = pgmoneta_append(string_to_sign, comp);
    }
 
-   if (base64_signature != NULL)
+   // Construct the signature.
+   if (pgmoneta_generate_string_hmac_sha256_hash(signing_key, signing_key_length, string_to_sign, strlen(string_to_sign), &signature_hmac, &hmac_length))
    {
-      free(base64_signature);
+      goto error;
    }
 
-   if (signature_hmac != NULL)
+   // Encode the signature.
+   pgmoneta_base64_encode((char*)signature_hmac, hmac_length, &base64_signature, &base64_signature_length);
+
+   // Construct the authorization header.
+   auth_value = pgmoneta_append(auth_value, "SharedKey ");
+   auth_value = pgmoneta_append(auth_value, config->azure_storage_account);
+   auth_value = pgmoneta_append(auth_value, ":");
+   auth_value = pgmoneta_append(auth_value, base64_signature);
+
+   chunk = pgmoneta_http_add_header(chunk, "Authorization", auth_value);
+
+   if (blob_type)
    {
-      free(signature_hmac);
+      chunk = pgmoneta_http_add_header(chunk, "x-ms-blob-type", "BlockBlob");
    }
 
-   if (signature_hex != NULL)
+   chunk = pgmoneta_http_add_header(chunk, "x-ms-date", utc_date);
+
+   chunk = pgmoneta_http_add_header(chunk, "x-ms-version", AZURE_VERSION);
+
+   // the block is sent right away instead of waiting for a 100 Continue
+   chunk = curl_slist_append(chunk, "Expect:");
+
+   if (pgmoneta_http_set_header_option(handle, chunk))
    {
-      free(signature_hex);
+      goto error;
    }
 
-   if (string_to_sign != NULL)
+   if (comp != NULL)
    {
-      free(string_to_sign);
+      azure_url = pgmoneta_append(azure_url, "?comp=");
+      azure_url = pgmoneta_append(azure_url, comp);
    }
+   if (block_id != NULL)
+   {
+      escaped = curl_easy_escape(handle, block_id, 0);
+
+      azure_url = pgmoneta_append(azure_url, "&blockid=");
+      azure_url = pgmoneta_append(azure_url, escaped);
+   }
+
+   pgmoneta_http_set_request_option(handle, HTTP_PUT);
+
+   pgmoneta_http_set_url_option(handle, azure_url);
+
+   curl_easy_setopt(handle, CURLOPT_SHARE, share);
+
+   curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+
+   *headers = chunk;
+
+   curl_free(escaped);
+   free(azure_url);
+   free(uri_path);
+   free(base64_signature);
+   free(signature_hmac);
+   free(string_to_sign);
+   free(auth_value);
 
-   if (auth_value != NULL)
+   return 0;
+
+error:
+
+   curl_free(escaped);
+   free(azure_url);
+   free(uri_path);
+   free(base64_signature);
+   free(signature_hmac);
+   free(string_to_sign);
+   free(auth_value);
+
+   curl_slist_free_all(chunk);
+
+   return 1;
+}
+
+static int
+azure_response_code(CURL* handle, char* response, bool* retry)
+{
+   long code = 0;
+
+   curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &code);
+
+   if (code < 200 || code > 299)
    {
-      free(auth_value);
+      // timeouts, throttling and server errors are transient
+      *retry = code == 408 || code == 429 || code >= 500;
+
+      pgmoneta_log_error("Azure: HTTP %ld %s", code, response != NULL ? response : "");
+      return 1;
    }
 
-   if (chunk != NULL)
+   return 0;
+}
+
+static char*
+azure_block_id(int block)
+{
+   char number[16];
+   char* block_id = NULL;
+   size_t block_id_length = 0;
+
+   // all the block ids of a blob must have the same length
+   snprintf(number, sizeof(number), "%06d", block);
+
+   pgmoneta_base64_encode(number, strlen(number), &block_id, &block_id_length);
+
+   return block_id;
+}
+
+static void
+azure_now(struct timespec* ts)
+{
+#ifdef HAVE_FREEBSD
+   clock_gettime(CLOCK_MONOTONIC_FAST, ts);
+#else
+   clock_gettime(CLOCK_MONOTONIC_RAW, ts);
+#endif
+}
+
+static size_t
+azure_read_callback(char* buffer, size_t size, size_t nitems, void* userdata)
+{
+   struct azure_transfer* transfer = (struct azure_transfer*)userdata;
+   size_t length;
+
+   length = MIN(size * nitems, transfer->length - transfer->position);
+
+   memcpy(buffer, transfer->buffer + transfer->position, length);
+   transfer->position += length;
+
+   return length;
+}
+
+static size_t
+azure_write_callback(char* ptr, size_t size, size_t nmemb, void* userdata)
+{
+   char** response = (char**)userdata;
+   size_t length = size * nmemb;
+   size_t current = *response != NULL ? strlen(*response) : 0;
+   char* r = NULL;
+
+   // only the start of a response is of interest
+   if (current + length > AZURE_RESPONSE_SIZE)
    {
-      curl_slist_free_all(chunk);
+      return length;
    }
 
-   if (file != NULL)
+   r = (char*)realloc(*response, current + length + 1);
+   if (r == NULL)
    {
-      fclose(file);
+      return 0;
    }
 
-   return 1;
+   memcpy(r + current, ptr, length);
+   r[current + length] = '\0';
+   *response = r;
+
+   return length;
 }
 
 static char*
-azure_get_host()
+azure_get_host(void)
 {
    char* host = NULL;
+   char* start = NULL;
+   char* end = NULL;
    struct main_configuration* config;
 
    config = (struct main_configuration*)shmem;
 
+   if (strlen(config->azure_endpoint) > 0)
+   {
+      start = strstr(config->azure_endpoint, "://");
+      start = start != NULL ? start + 3 : config->azure_endpoint;
+      end = strchr(start, '/');
+
+      host = pgmoneta_append(host, start);
+      if (end != NULL)
+      {
+         host[end - start] = '\0';
+      }
+
+      return host;
+   }
+
    host = pgmoneta_append(host, config->azure_storage_account);
-   host = pgmoneta_append(host, ".blob.core.windows.net/");
-   host = pgmoneta_append(host, config->azure_container);
+   host = pgmoneta_append(host, ".blob.core.windows.net");
 
    return host;
 }
 
+static char*
+azure_get_url(char* azure_path, char** uri_path)
+{
+   char* url = NULL;
+   char* host = NULL;
+   char* start = NULL;
+   char* path = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   host = azure_get_host();
+
+   // an emulator, such as Azurite, has the account in the path of the endpoint
+   if (strlen(config->azure_endpoint) > 0)
+   {
+      start = strstr(config->azure_endpoint, "://");
+      start = start != NULL ? start + 3 : config->azure_endpoint;
+      start = strchr(start, '/');
+
+      if (start != NULL)
+      {
+         path = pgmoneta_append(path, start);
+         if (pgmoneta_ends_with(path, "/"))
+         {
+            path[strlen(path) - 1] = '\0';
+         }
+      }
+   }
+
+   path = pgmoneta_append(path, "/");
+   path = pgmoneta_append(path, config->azure_container);
+   path = pgmoneta_append(path, "/");
+   path = pgmoneta_append(path, azure_path);
+
+   if (strlen(config->azure_endpoint) > 0 && !strncmp(config->azure_endpoint, "http://", strlen("http://")))
+   {
+      url = pgmoneta_append(url, "http://");
+   }
+   else
+   {
+      url = pgmoneta_append(url, "https://");
+   }
+   url = pgmoneta_append(url, host);
+   url = pgmoneta_append(url, path);
+
+   *uri_path = path;
+
+   free(host);
+
+   return url;
+}
+
 static char*
 azure_get_basepath(int server, char* identifier)
 {
@@ -28,6 +28,7 @@
 
 /* pgmoneta */
 #include <pgmoneta.h>
+#include <deque.h>
 #include <http.h>
 #include <logging.h>
 #include <security.h>
@@ -37,22 +38,84 @@
 /* system */
 #include <assert.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#define S3_MAX_PARTS      10000
+#define S3_RESPONSE_SIZE  65536
+
+/** @struct s3_upload
+ * Defines the upload of a file, either as a single object or as a multipart upload
+ */
+struct s3_upload
+{
+   char* local_path;   /**< The path of the local file */
+   char* s3_path;      /**< The key of the object */
+   int fd;             /**< The local file */
+   size_t size;        /**< The size of the file */
+   size_t part_size;   /**< The size of a part */
+   int parts;          /**< The number of parts */
+   int next_part;      /**< The next part to send, starting at 1 */
+   int done_parts;     /**< The number of parts sent */
+   int active;         /**< The number of parts being sent */
+   bool multipart;     /**< Use a multipart upload */
+   char* upload_id;    /**< The id of the multipart upload */
+   char** etags;       /**< The ETag of each part */
+};
+
+/** @struct s3_transfer
+ * Defines a request slot of the connection pool
+ */
+struct s3_transfer
+{
+   CURL* handle;                 /**< The curl handle, keeping its connection alive between requests */
+   struct s3_upload* upload;     /**< The upload, or NULL if the slot is free */
+   int part;                     /**< The part number */
+   unsigned char* buffer;        /**< The content of the part */
+   size_t buffer_size;           /**< The size of the buffer */
+   size_t length;                /**< The length of the part */
+   size_t position;              /**< The position of the next byte to send */
+   struct curl_slist* headers;   /**< The request headers */
+   char* response;               /**< The response body */
+   size_t response_length;       /**< The length of the response body */
+   char etag[128];               /**< The ETag of the response */
+};
 
 static char* s3_storage_name(void);
 static int s3_storage_setup(char*, struct art*);
 static int s3_storage_execute(char*, struct art*);
 static int s3_storage_teardown(char*, struct art*);
 
-static int s3_upload_files(char* local_root, char* s3_root, char* relative_path);
-static int s3_send_upload_request(char* local_root, char* s3_root, char* relative_path);
+static int s3_find_files(char* local_root, char* relative_path, struct deque* files);
+static int s3_upload_files(char* local_root, char* s3_root, struct deque* files);
+
+static int s3_upload_create(char* local_root, char* s3_root, char* relative_path, struct s3_upload** upload);
+static int s3_upload_complete(struct s3_upload* upload);
+static void s3_upload_abort(struct s3_upload* upload);
+static void s3_upload_destroy(struct s3_upload* upload);
+
+static int s3_transfer_start(struct s3_transfer* transfer, struct s3_upload* upload);
+static int s3_transfer_finish(struct s3_transfer* transfer, CURLcode result);
+static void s3_transfer_reset(struct s3_transfer* transfer);
+
+static int s3_request(CURL* handle, int method, char* s3_path, char* query, char* body, bool storage_class, char** response);
+static int s3_prepare(CURL* handle, int method, char* s3_path, char* query, char* payload_sha256, bool storage_class, struct curl_slist** headers);
+static int s3_response_code(CURL* handle, char* response);
+
+static size_t s3_read_callback(char* buffer, size_t size, size_t nitems, void* userdata);
+static size_t s3_write_callback(char* ptr, size_t size, size_t nmemb, void* userdata);
+static size_t s3_header_callback(char* buffer, size_t size, size_t nitems, void* userdata);
 
 static char* s3_get_host(void);
 static char* s3_get_basepath(int server, char* identifier);
+static char* s3_get_url(char* s3_path, char* query);
 
 static CURL* curl = NULL;
+static CURLM* multi = NULL;
+static CURLSH* share = NULL;
 
 struct workflow*
 pgmoneta_storage_create_s3(void)
@@ -103,6 +166,25 @@ s3_storage_setup(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_log_debug("S3 storage engine (setup): %s/%s", config->common.servers[server].name, label);
 
+   // all requests share one connection cache, so connections are kept alive and reused
+   share = curl_share_init();
+   if (share == NULL)
+   {
+      goto error;
+   }
+
+   curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+   curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+   curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+   multi = curl_multi_init();
+   if (multi == NULL)
+   {
+      goto error;
+   }
+
+   curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)config->s3_concurrency);
+
    curl = curl_easy_init();
    if (curl == NULL)
    {
@@ -125,6 +207,7 @@ s3_storage_execute(char* name __attribute__((unused)), struct art* nodes)
    double remote_s3_elapsed_time;
    char* local_root = NULL;
    char* s3_root = NULL;
+   struct deque* files = NULL;
    struct main_configuration* config;
 
 #ifdef HAVE_FREEBSD
@@ -156,7 +239,17 @@ s3_storage_execute(char* name __attribute__((unused)), struct art* nodes)
    local_root = pgmoneta_get_server_backup_identifier(server, label);
    s3_root = s3_get_basepath(server, label);
 
-   if (s3_upload_files(local_root, s3_root, ""))
+   if (pgmoneta_deque_create(false, &files))
+   {
+      goto error;
+   }
+
+   if (s3_find_files(local_root, "", files))
+   {
+      goto error;
+   }
+
+   if (s3_upload_files(local_root, s3_root, files))
    {
       goto error;
    }
@@ -171,6 +264,7 @@ s3_storage_execute(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_update_info_double(local_root, INFO_REMOTE_S3_ELAPSED, remote_s3_elapsed_time);
 
+   pgmoneta_deque_destroy(files);
    free(local_root);
    free(s3_root);
 
@@ -178,6 +272,7 @@ s3_storage_execute(char* name __attribute__((unused)), struct art* nodes)
 
 error:
 
+   pgmoneta_deque_destroy(files);
    free(local_root);
    free(s3_root);
 
@@ -217,6 +312,11 @@ s3_storage_teardown(char* name __attribute__((unused)), struct art* nodes)
    pgmoneta_delete_directory(root);
 
    curl_easy_cleanup(curl);
+   curl = NULL;
+   curl_multi_cleanup(multi);
+   multi = NULL;
+   curl_share_cleanup(share);
+   share = NULL;
 
    free(root);
 
@@ -224,7 +324,7 @@ s3_storage_teardown(char* name __attribute__((unused)), struct art* nodes)
 }
 
 static int
-s3_upload_files(char* local_root, char* s3_root, char* relative_path)
+s3_find_files(char* local_root, char* relative_path, struct deque* files)
 {
    char* local_path = NULL;
    char* relative_file;
@@ -252,7 +352,10 @@ s3_upload_files(char* local_root, char* s3_root, char* relative_path)
 
          snprintf(relative_dir, sizeof(relative_dir), "%s/%s", relative_path, entry->d_name);
 
-         s3_upload_files(local_root, s3_root, relative_dir);
+         if (s3_find_files(local_root, relative_dir, files))
+         {
+            goto error;
+         }
       }
       else
       {
@@ -262,11 +365,7 @@ s3_upload_files(char* local_root, char* s3_root, char* relative_path)
          relative_file = pgmoneta_append(relative_file, "/");
          relative_file = pgmoneta_append(relative_file, entry->d_name);
 
-         if (s3_send_upload_request(local_root, s3_root, relative_file))
-         {
-            free(relative_file);
-            goto error;
-         }
+         pgmoneta_deque_add(files, NULL, (uintptr_t)relative_file, ValueString);
 
          free(relative_file);
       }
@@ -280,7 +379,10 @@ s3_upload_files(char* local_root, char* s3_root, char* relative_path)
 
 error:
 
-   closedir(dir);
+   if (dir != NULL)
+   {
+      closedir(dir);
+   }
 
    free(local_path);
 
@@ -288,7 +390,623 @@ error:
 }
 
 static int
-s3_send_upload_request(char* local_root, char* s3_root, char* relative_path)
+s3_upload_files(char* local_root, char* s3_root, struct deque* files)
+{
+   int concurrency = 0;
+   int active = 0;
+   int running = 0;
+   int queued = 0;
+   char* relative_file = NULL;
+   struct s3_upload* current = NULL;
+   struct s3_upload* upload = NULL;
+   struct s3_transfer* transfers = NULL;
+   struct s3_transfer* transfer = NULL;
+   CURLMsg* msg = NULL;
+   bool failed = false;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   concurrency = config->s3_concurrency > 0 ? config->s3_concurrency : 1;
+
+   transfers = (struct s3_transfer*)calloc(concurrency, sizeof(struct s3_transfer));
+   if (transfers == NULL)
+   {
+      goto error;
+   }
+
+   for (int i = 0; i < concurrency; i++)
+   {
+      transfers[i].handle = curl_easy_init();
+      if (transfers[i].handle == NULL)
+      {
+         goto error;
+      }
+   }
+
+   // the parts of the current file, and then the following files, are
+   // sent on the free slots while the other slots are busy
+   while (!failed)
+   {
+      for (int i = 0; i < concurrency && !failed; i++)
+      {
+         if (transfers[i].upload != NULL)
+         {
+            continue;
+         }
+
+         while (current == NULL || current->next_part > current->parts)
+         {
+            current = NULL;
+
+            if (pgmoneta_deque_empty(files))
+            {
+               break;
+            }
+
+            relative_file = (char*)pgmoneta_deque_poll(files, NULL);
+
+            if (s3_upload_create(local_root, s3_root, relative_file, &current))
+            {
+               failed = true;
+            }
+
+            free(relative_file);
+            relative_file = NULL;
+
+            if (failed)
+            {
+               break;
+            }
+         }
+
+         if (current == NULL)
+         {
+            break;
+         }
+
+         if (s3_transfer_start(&transfers[i], current))
+         {
+            failed = true;
+            break;
+         }
+
+         active++;
+      }
+
+      if (failed || active == 0)
+      {
+         break;
+      }
+
+      if (curl_multi_perform(multi, &running) != CURLM_OK)
+      {
+         failed = true;
+         break;
+      }
+
+      while ((msg = curl_multi_info_read(multi, &queued)) != NULL)
+      {
+         if (msg->msg != CURLMSG_DONE)
+         {
+            continue;
+         }
+
+         transfer = NULL;
+         curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&transfer);
+
+         curl_multi_remove_handle(multi, transfer->handle);
+         active--;
+
+         upload = transfer->upload;
+
+         if (s3_transfer_finish(transfer, msg->data.result))
+         {
+            failed = true;
+         }
+
+         s3_transfer_reset(transfer);
+
+         if (!failed && upload->active == 0 && upload->done_parts == upload->parts)
+         {
+            if (s3_upload_complete(upload))
+            {
+               failed = true;
+            }
+            else
+            {
+               if (upload == current)
+               {
+                  current = NULL;
+               }
+               s3_upload_destroy(upload);
+               continue;
+            }
+         }
+
+         if (failed && upload->active == 0 && upload != current)
+         {
+            s3_upload_abort(upload);
+            s3_upload_destroy(upload);
+         }
+      }
+
+      if (!failed && running > 0)
+      {
+         curl_multi_poll(multi, NULL, 0, 1000, NULL);
+      }
+   }
+
+   if (failed)
+   {
+      goto error;
+   }
+
+   for (int i = 0; i < concurrency; i++)
+   {
+      curl_easy_cleanup(transfers[i].handle);
+      free(transfers[i].buffer);
+   }
+   free(transfers);
+
+   return 0;
+
+error:
+
+   // cancel the requests in flight, and the multipart uploads they belong to
+   for (int i = 0; transfers != NULL && i < concurrency; i++)
+   {
+      upload = transfers[i].upload;
+
+      if (upload != NULL)
+      {
+         curl_multi_remove_handle(multi, transfers[i].handle);
+         s3_transfer_reset(&transfers[i]);
+
+         if (upload->active == 0 && upload != current)
+         {
+            s3_upload_abort(upload);
+            s3_upload_destroy(upload);
+         }
+      }
+   }
+
+   if (current != NULL)
+   {
+      s3_upload_abort(current);
+      s3_upload_destroy(current);
+   }
+
+   for (int i = 0; transfers != NULL && i < concurrency; i++)
+   {
+      curl_easy_cleanup(transfers[i].handle);
+      free(transfers[i].buffer);
+   }
+   free(transfers);
+
+   return 1;
+}
+
+static int
+s3_upload_create(char* local_root, char* s3_root, char* relative_path, struct s3_upload** upload)
+{
+   char* response = NULL;
+   char* start = NULL;
+   char* end = NULL;
+   struct stat st;
+   struct s3_upload* u = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   *upload = NULL;
+
+   u = (struct s3_upload*)malloc(sizeof(struct s3_upload));
+   if (u == NULL)
+   {
+      goto error;
+   }
+
+   memset(u, 0, sizeof(struct s3_upload));
+   u->fd = -1;
+
+   u->local_path = pgmoneta_append(u->local_path, local_root);
+   u->local_path = pgmoneta_append(u->local_path, relative_path);
+
+   u->s3_path = pgmoneta_append(u->s3_path, s3_root);
+   u->s3_path = pgmoneta_append(u->s3_path, relative_path);
+
+   u->fd = open(u->local_path, O_RDONLY);
+   if (u->fd == -1 || fstat(u->fd, &st) != 0)
+   {
+      pgmoneta_log_error("S3: Could not open %s", u->local_path);
+      goto error;
+   }
+
+   u->size = (size_t)st.st_size;
+   u->part_size = (size_t)config->s3_part_size;
+
+   // S3 allows at most 10000 parts, so the parts of a very big file are made bigger
+   if (u->size > u->part_size * S3_MAX_PARTS)
+   {
+      u->part_size = (u->size + S3_MAX_PARTS - 1) / S3_MAX_PARTS;
+      u->part_size = ((u->part_size + 1024 * 1024 - 1) / (1024 * 1024)) * (1024 * 1024);
+   }
+
+   u->multipart = u->size > u->part_size;
+   u->parts = u->multipart ? (int)((u->size + u->part_size - 1) / u->part_size) : 1;
+   u->next_part = 1;
+
+   if (u->multipart)
+   {
+      u->etags = (char**)calloc(u->parts, sizeof(char*));
+      if (u->etags == NULL)
+      {
+         goto error;
+      }
+
+      if (s3_request(curl, HTTP_POST, u->s3_path, "uploads=", "", true, &response))
+      {
+         pgmoneta_log_error("S3: Could not start the multipart upload of %s", u->s3_path);
+         goto error;
+      }
+
+      start = strstr(response, "<UploadId>");
+      end = start != NULL ? strstr(start, "</UploadId>") : NULL;
+      if (start == NULL || end == NULL)
+      {
+         pgmoneta_log_error("S3: No upload id for %s", u->s3_path);
+         goto error;
+      }
+
+      start += strlen("<UploadId>");
+      u->upload_id = (char*)calloc(1, end - start + 1);
+      if (u->upload_id == NULL)
+      {
+         goto error;
+      }
+      memcpy(u->upload_id, start, end - start);
+   }
+
+   pgmoneta_log_trace("S3: %s (%zu bytes, %d parts)", u->s3_path, u->size, u->parts);
+
+   free(response);
+
+   *upload = u;
+
+   return 0;
+
+error:
+
+   free(response);
+   s3_upload_destroy(u);
+
+   return 1;
+}
+
+static int
+s3_upload_complete(struct s3_upload* upload)
+{
+   char number[16];
+   char* query = NULL;
+   char* escaped = NULL;
+   char* body = NULL;
+   char* response = NULL;
+
+   if (!upload->multipart)
+   {
+      return 0;
+   }
+
+   body = pgmoneta_append(body, "<CompleteMultipartUpload>");
+   for (int i = 0; i < upload->parts; i++)
+   {
+      snprintf(number, sizeof(number), "%d", i + 1);
+
+      body = pgmoneta_append(body, "<Part><PartNumber>");
+      body = pgmoneta_append(body, number);
+      body = pgmoneta_append(body, "</PartNumber><ETag>");
+      body = pgmoneta_append(body, upload->etags[i]);
+      body = pgmoneta_append(body, "</ETag></Part>");
+   }
+   body = pgmoneta_append(body, "</CompleteMultipartUpload>");
+
+   escaped = curl_easy_escape(curl, upload->upload_id, 0);
+
+   query = pgmoneta_append(query, "uploadId=");
+   query = pgmoneta_append(query, escaped);
+
+   if (s3_request(curl, HTTP_POST, upload->s3_path, query, body, false, &response))
+   {
+      pgmoneta_log_error("S3: Could not complete the multipart upload of %s", upload->s3_path);
+      goto error;
+   }
+
+   curl_free(escaped);
+   free(query);
+   free(body);
+   free(response);
+
+   return 0;
+
+error:
+
+   curl_free(escaped);
+   free(query);
+   free(body);
+   free(response);
+
+   return 1;
+}
+
+static void
+s3_upload_abort(struct s3_upload* upload)
+{
+   char* query = NULL;
+   char* escaped = NULL;
+   char* response = NULL;
+
+   if (upload == NULL || upload->upload_id == NULL)
+   {
+      return;
+   }
+
+   escaped = curl_easy_escape(curl, upload->upload_id, 0);
+
+   query = pgmoneta_append(query, "uploadId=");
+   query = pgmoneta_append(query, escaped);
+
+   if (s3_request(curl, HTTP_DELETE, upload->s3_path, query, NULL, false, &response))
+   {
+      pgmoneta_log_warn("S3: Could not abort the multipart upload of %s", upload->s3_path);
+   }
+
+   curl_free(escaped);
+   free(query);
+   free(response);
+}
+
+static void
+s3_upload_destroy(struct s3_upload* upload)
+{
+   if (upload == NULL)
+   {
+      return;
+   }
+
+   if (upload->fd != -1)
+   {
+      close(upload->fd);
+   }
+
+   for (int i = 0; upload->etags != NULL && i < upload->parts; i++)
+   {
+      free(upload->etags[i]);
+   }
+
+   free(upload->etags);
+   free(upload->upload_id);
+   free(upload->local_path);
+   free(upload->s3_path);
+   free(upload);
+}
+
+static int
+s3_transfer_start(struct s3_transfer* transfer, struct s3_upload* upload)
+{
+   off_t offset = 0;
+   ssize_t r = 0;
+   char number[16];
+   char* query = NULL;
+   char* escaped = NULL;
+   char* sha256 = NULL;
+
+   transfer->upload = upload;
+   transfer->part = upload->next_part++;
+   upload->active++;
+
+   offset = (off_t)(transfer->part - 1) * (off_t)upload->part_size;
+   transfer->length = MIN(upload->part_size, upload->size - (size_t)offset);
+   transfer->position = 0;
+
+   if (transfer->buffer_size < transfer->length)
+   {
+      free(transfer->buffer);
+      transfer->buffer = (unsigned char*)malloc(transfer->length);
+      if (transfer->buffer == NULL)
+      {
+         transfer->buffer_size = 0;
+         goto error;
+      }
+      transfer->buffer_size = transfer->length;
+   }
+
+   // the part is read once, and hashed for the signature from memory
+   while (transfer->position < transfer->length)
+   {
+      r = pread(upload->fd, transfer->buffer + transfer->position, transfer->length - transfer->position, offset + transfer->position);
+      if (r <= 0)
+      {
+         pgmoneta_log_error("S3: Could not read %s", upload->local_path);
+         goto error;
+      }
+      transfer->position += r;
+   }
+   transfer->position = 0;
+
+   if (pgmoneta_create_sha256_buffer(transfer->buffer, transfer->length, &sha256))
+   {
+      goto error;
+   }
+
+   if (upload->multipart)
+   {
+      snprintf(number, sizeof(number), "%d", transfer->part);
+      escaped = curl_easy_escape(transfer->handle, upload->upload_id, 0);
+
+      query = pgmoneta_append(query, "partNumber=");
+      query = pgmoneta_append(query, number);
+      query = pgmoneta_append(query, "&uploadId=");
+      query = pgmoneta_append(query, escaped);
+   }
+
+   curl_easy_reset(transfer->handle);
+
+   if (s3_prepare(transfer->handle, HTTP_PUT, upload->s3_path, query, sha256, !upload->multipart, &transfer->headers))
+   {
+      goto error;
+   }
+
+   curl_easy_setopt(transfer->handle, CURLOPT_READFUNCTION, s3_read_callback);
+   curl_easy_setopt(transfer->handle, CURLOPT_READDATA, (void*)transfer);
+   curl_easy_setopt(transfer->handle, CURLOPT_INFILESIZE_LARGE, (curl_off_t)transfer->length);
+   curl_easy_setopt(transfer->handle, CURLOPT_HEADERFUNCTION, s3_header_callback);
+   curl_easy_setopt(transfer->handle, CURLOPT_HEADERDATA, (void*)transfer);
+   curl_easy_setopt(transfer->handle, CURLOPT_WRITEFUNCTION, s3_write_callback);
+   curl_easy_setopt(transfer->handle, CURLOPT_WRITEDATA, (void*)&transfer->response);
+   curl_easy_setopt(transfer->handle, CURLOPT_PRIVATE, (void*)transfer);
+
+   if (curl_multi_add_handle(multi, transfer->handle) != CURLM_OK)
+   {
+      goto error;
+   }
+
+   curl_free(escaped);
+   free(query);
+   free(sha256);
+
+   return 0;
+
+error:
+
+   curl_free(escaped);
+   free(query);
+   free(sha256);
+
+   s3_transfer_reset(transfer);
+
+   return 1;
+}
+
+static int
+s3_transfer_finish(struct s3_transfer* transfer, CURLcode result)
+{
+   struct s3_upload* upload = transfer->upload;
+
+   if (result != CURLE_OK)
+   {
+      pgmoneta_log_error("S3: Could not send %s (part %d): %s", upload->s3_path, transfer->part, curl_easy_strerror(result));
+      goto error;
+   }
+
+   if (s3_response_code(transfer->handle, transfer->response))
+   {
+      pgmoneta_log_error("S3: Could not send %s (part %d)", upload->s3_path, transfer->part);
+      goto error;
+   }
+
+   if (upload->multipart)
+   {
+      if (strlen(transfer->etag) == 0)
+      {
+         pgmoneta_log_error("S3: No ETag for %s (part %d)", upload->s3_path, transfer->part);
+         goto error;
+      }
+
+      upload->etags[transfer->part - 1] = pgmoneta_append(NULL, transfer->etag);
+   }
+
+   upload->done_parts++;
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+static void
+s3_transfer_reset(struct s3_transfer* transfer)
+{
+   if (transfer->upload != NULL)
+   {
+      transfer->upload->active--;
+   }
+
+   curl_slist_free_all(transfer->headers);
+
+   transfer->headers = NULL;
+   transfer->upload = NULL;
+   transfer->part = 0;
+   transfer->length = 0;
+   transfer->position = 0;
+   free(transfer->response);
+   transfer->response = NULL;
+   memset(transfer->etag, 0, sizeof(transfer->etag));
+}
+
+static int
+s3_request(CURL* handle, int method, char* s3_path, char* query, char* body, bool storage_class, char** response)
+{
+   char* sha256 = NULL;
+   struct curl_slist* headers = NULL;
+   CURLcode res;
+
+   *response = NULL;
+
+   if (pgmoneta_create_sha256_buffer(body != NULL ? body : "", body != NULL ? strlen(body) : 0, &sha256))
+   {
+      goto error;
+   }
+
+   curl_easy_reset(handle);
+
+   if (s3_prepare(handle, method, s3_path, query, sha256, storage_class, &headers))
+   {
+      goto error;
+   }
+
+   if (method == HTTP_POST)
+   {
+      curl_easy_setopt(handle, CURLOPT_POSTFIELDS, body);
+      curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, (long)strlen(body));
+   }
+
+   curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, s3_write_callback);
+   curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void*)response);
+
+   res = curl_easy_perform(handle);
+   if (res != CURLE_OK)
+   {
+      pgmoneta_log_error("S3: %s", curl_easy_strerror(res));
+      goto error;
+   }
+
+   if (s3_response_code(handle, *response))
+   {
+      goto error;
+   }
+
+   if (*response == NULL)
+   {
+      *response = pgmoneta_append(NULL, "");
+   }
+
+   curl_slist_free_all(headers);
+   free(sha256);
+
+   return 0;
+
+error:
+
+   curl_slist_free_all(headers);
+   free(sha256);
+
+   return 1;
+}
+
+static int
+s3_prepare(CURL* handle, int method, char* s3_path, char* query, char* payload_sha256, bool storage_class, struct curl_slist** headers)
 {
    char short_date[SHORT_TIME_LENGTH];
    char long_date[LONG_TIME_LENGTH];
@@ -297,11 +1015,9 @@ s3_send_upload_request(char* local_root, char* s3_root, char* relative_path)
    char* string_to_sign = NULL;
    char* s3_host = NULL;
    char* s3_url = NULL;
-   char* file_sha256 = NULL;
+   char* url_path = NULL;
    char* canonical_request_sha256 = NULL;
    char* key = NULL;
-   char* local_path = NULL;
-   char* s3_path = NULL;
    unsigned char* date_key_hmac = NULL;
    unsigned char* date_region_key_hmac = NULL;
    unsigned char* date_region_service_key_hmac = NULL;
@@ -309,19 +1025,12 @@ s3_send_upload_request(char* local_root, char* s3_root, char* relative_path)
    unsigned char* signature_hmac = NULL;
    unsigned char* signature_hex = NULL;
    int hmac_length = 0;
-   FILE* file = NULL;
-   struct stat file_info;
-   CURLcode res = -1;
    struct curl_slist* chunk = NULL;
    struct main_configuration* config;
 
    config = (struct main_configuration*)shmem;
 
-   local_path = pgmoneta_append(local_path, local_root);
-   local_path = pgmoneta_append(local_path, relative_path);
-
-   s3_path = pgmoneta_append(s3_path, s3_root);
-   s3_path = pgmoneta_append(s3_path, relative_path);
+   *headers = NULL;
 
    memset(&short_date[0], 0, sizeof(short_date));
    memset(&long_date[0], 0, sizeof(long_date));
@@ -331,21 +1040,37 @@ s3_send_upload_request(char* local_root, char* s3_root, char* relative_path)
       goto error;
    }
 
-   pgmoneta_create_sha256_file(local_path, &file_sha256);
-
    s3_host = s3_get_host();
 
+   // an S3 compatible endpoint is addressed path style
+   if (strlen(config->s3_endpoint) > 0)
+   {
+      url_path = pgmoneta_append(url_path, config->s3_bucket);
+      url_path = pgmoneta_append(url_path, "/");
+   }
+   url_path = pgmoneta_append(url_path, s3_path);
+
    // Construct canonical request.
-   canonical_request = pgmoneta_append(canonical_request, "PUT\n/");
-   canonical_request = pgmoneta_append(canonical_request, s3_path);
-   canonical_request = pgmoneta_append(canonical_request, "\n\nhost:");
+   canonical_request = pgmoneta_append(canonical_request, method == HTTP_PUT ? "PUT" : method == HTTP_POST ? "POST" : method == HTTP_DELETE ? "DELETE" : "GET");
+   canonical_request = pgmoneta_append(canonical_request, "\n/");
+   canonical_request = pgmoneta_append(canonical_request, url_path);
+   canonical_request = pgmoneta_append(canonical_request, "\n");
+   canonical_request = pgmoneta_append(canonical_request, query != NULL ? query : "");
+   canonical_request = pgmoneta_append(canonical_request, "\nhost:");
    canonical_request = pgmoneta_append(canonical_request, s3_host);
    canonical_request = pgmoneta_append(canonical_request, "\nx-amz-content-sha256:");
-   canonical_request = pgmoneta_append(canonical_request, file_sha256);
+   canonical_request = pgmoneta_append(canonical_request, payload_sha256);
    canonical_request = pgmoneta_append(canonical_request, "\nx-amz-date:");
    canonical_request = pgmoneta_append(canonical_request, long_date);
-   canonical_request = pgmoneta_append(canonical_request, "\nx-amz-storage-class:REDUCED_REDUNDANCY\n\nhost;x-amz-content-sha256;x-amz-date;x-amz-storage-class\n");
-   canonical_request = pgmoneta_append(canonical_request, file_sha256);
+   if (storage_class)
+   {
+      canonical_request = pgmoneta_append(canonical_request, "\nx-amz-storage-class:REDUCED_REDUNDANCY\n\nhost;x-amz-content-sha256;x-amz-date;x-amz-storage-class\n");
+   }
+   else
+   {
+      canonical_request = pgmoneta_append(canonical_request, "\n\nhost;x-amz-content-sha256;x-amz-date\n");
+   }
+   canonical_request = pgmoneta_append(canonical_request, payload_sha256);
 
    pgmoneta_generate_string_sha256_hash(canonical_request, &canonical_request_sha256);
 
@@ -395,60 +1120,54 @@ s3_send_upload_request(char* local_root, char* s3_root, char* relative_path)
    auth_value = pgmoneta_append(auth_value, short_date);
    auth_value = pgmoneta_append(auth_value, "/");
    auth_value = pgmoneta_append(auth_value, config->s3_aws_region);
-   auth_value = pgmoneta_append(auth_value, "/s3/aws4_request,SignedHeaders=host;x-amz-content-sha256;x-amz-date;x-amz-storage-class,Signature=");
+   if (storage_class)
+   {
+      auth_value = pgmoneta_append(auth_value, "/s3/aws4_request,SignedHeaders=host;x-amz-content-sha256;x-amz-date;x-amz-storage-class,Signature=");
+   }
+   else
+   {
+      auth_value = pgmoneta_append(auth_value, "/s3/aws4_request,SignedHeaders=host;x-amz-content-sha256;x-amz-date,Signature=");
+   }
    auth_value = pgmoneta_append(auth_value, (char*)signature_hex);
 
    chunk = pgmoneta_http_add_header(chunk, "Authorization", auth_value);
 
    chunk = pgmoneta_http_add_header(chunk, "Host", s3_host);
 
-   chunk = pgmoneta_http_add_header(chunk, "x-amz-content-sha256", file_sha256);
+   chunk = pgmoneta_http_add_header(chunk, "x-amz-content-sha256", payload_sha256);
 
    chunk = pgmoneta_http_add_header(chunk, "x-amz-date", long_date);
 
-   chunk = pgmoneta_http_add_header(chunk, "x-amz-storage-class", "REDUCED_REDUNDANCY");
-
-   if (pgmoneta_http_set_header_option(curl, chunk))
+   if (storage_class)
    {
-      goto error;
+      chunk = pgmoneta_http_add_header(chunk, "x-amz-storage-class", "REDUCED_REDUNDANCY");
    }
 
-   s3_url = pgmoneta_append(s3_url, "https://");
-   s3_url = pgmoneta_append(s3_url, s3_host);
-   s3_url = pgmoneta_append(s3_url, "/");
-   s3_url = pgmoneta_append(s3_url, s3_path);
-
-   file = fopen(local_path, "rb");
-   if (file == NULL)
+   if (method == HTTP_POST)
    {
-      goto error;
+      chunk = pgmoneta_http_add_header(chunk, "Content-Type", "application/xml");
    }
 
-   if (fstat(fileno(file), &file_info) != 0)
+   if (pgmoneta_http_set_header_option(handle, chunk))
    {
       goto error;
    }
 
-   pgmoneta_http_set_request_option(curl, HTTP_PUT);
+   s3_url = s3_get_url(url_path, query);
 
-   pgmoneta_http_set_url_option(curl, s3_url);
+   pgmoneta_http_set_request_option(handle, method);
 
-   curl_easy_setopt(curl, CURLOPT_READDATA, (void*) file);
+   pgmoneta_http_set_url_option(handle, s3_url);
 
-   curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)file_info.st_size);
+   curl_easy_setopt(handle, CURLOPT_SHARE, share);
 
-   curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
+   curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
 
-   res = curl_easy_perform(curl);
-   if (res != CURLE_OK)
-   {
-      fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-      goto error;
-   }
+   *headers = chunk;
 
    free(s3_url);
+   free(url_path);
    free(s3_host);
-   free(file_sha256);
    free(signature_hex);
    free(signature_hmac);
    free(signing_key_hmac);
@@ -456,121 +1175,142 @@ s3_send_upload_request(char* local_root, char* s3_root, char* relative_path)
    free(date_region_key_hmac);
    free(date_key_hmac);
    free(key);
-   free(local_path);
-   free(s3_path);
    free(canonical_request_sha256);
    free(canonical_request);
    free(string_to_sign);
    free(auth_value);
 
-   curl_slist_free_all(chunk);
-
-   fclose(file);
    return 0;
 
 error:
 
-   if (s3_url != NULL)
-   {
-      free(s3_url);
-   }
+   free(s3_url);
+   free(url_path);
+   free(s3_host);
+   free(signature_hex);
+   free(signature_hmac);
+   free(signing_key_hmac);
+   free(date_region_service_key_hmac);
+   free(date_region_key_hmac);
+   free(date_key_hmac);
+   free(key);
+   free(canonical_request_sha256);
+   free(canonical_request);
+   free(string_to_sign);
+   free(auth_value);
 
-   if (s3_host != NULL)
-   {
-      free(s3_host);
-   }
+   curl_slist_free_all(chunk);
 
-   if (signature_hex != NULL)
-   {
-      free(signature_hex);
-   }
+   return 1;
+}
 
-   if (signature_hmac != NULL)
-   {
-      free(signature_hmac);
-   }
+static int
+s3_response_code(CURL* handle, char* response)
+{
+   long code = 0;
 
-   if (signing_key_hmac != NULL)
-   {
-      free(signing_key_hmac);
-   }
+   curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &code);
 
-   if (date_region_service_key_hmac != NULL)
+   // S3 may report an error of a completed multipart upload in a 200 response
+   if (code < 200 || code > 299 || (response != NULL && strstr(response, "<Error>") != NULL))
    {
-      free(date_region_service_key_hmac);
+      pgmoneta_log_error("S3: HTTP %ld %s", code, response != NULL ? response : "");
+      return 1;
    }
 
-   if (date_region_key_hmac != NULL)
-   {
-      free(date_region_key_hmac);
-   }
+   return 0;
+}
 
-   if (date_key_hmac != NULL)
-   {
-      free(date_region_key_hmac);
-   }
+static size_t
+s3_read_callback(char* buffer, size_t size, size_t nitems, void* userdata)
+{
+   struct s3_transfer* transfer = (struct s3_transfer*)userdata;
+   size_t length;
 
-   if (key != NULL)
-   {
-      free(key);
-   }
+   length = MIN(size * nitems, transfer->length - transfer->position);
 
-   if (local_path != NULL)
-   {
-      free(local_path);
-   }
+   memcpy(buffer, transfer->buffer + transfer->position, length);
+   transfer->position += length;
 
-   if (s3_path != NULL)
-   {
-      free(s3_path);
-   }
+   return length;
+}
 
-   if (canonical_request_sha256 != NULL)
-   {
-      free(canonical_request_sha256);
-   }
+static size_t
+s3_write_callback(char* ptr, size_t size, size_t nmemb, void* userdata)
+{
+   char** response = (char**)userdata;
+   size_t length = size * nmemb;
+   size_t current = *response != NULL ? strlen(*response) : 0;
+   char* r = NULL;
 
-   if (file_sha256 != NULL)
+   // only the start of a response is of interest
+   if (current + length > S3_RESPONSE_SIZE)
    {
-      free(file_sha256);
+      return length;
    }
 
-   if (canonical_request != NULL)
+   r = (char*)realloc(*response, current + length + 1);
+   if (r == NULL)
    {
-      free(canonical_request);
+      return 0;
    }
 
-   if (string_to_sign != NULL)
-   {
-      free(string_to_sign);
-   }
+   memcpy(r + current, ptr, length);
+   r[current + length] = '\0';
+   *response = r;
 
-   if (auth_value != NULL)
-   {
-      free(auth_value);
-   }
+   return length;
+}
 
-   if (chunk != NULL)
-   {
-      curl_slist_free_all(chunk);
-   }
+static size_t
+s3_header_callback(char* buffer, size_t size, size_t nitems, void* userdata)
+{
+   struct s3_transfer* transfer = (struct s3_transfer*)userdata;
+   size_t length = size * nitems;
+   size_t start = strlen("ETag:");
+   size_t end = length;
 
-   if (file != NULL)
+   if (length > start && !strncasecmp(buffer, "ETag:", start))
    {
-      fclose(file);
+      while (start < end && buffer[start] == ' ')
+      {
+         start++;
+      }
+      while (end > start && (buffer[end - 1] == '\r' || buffer[end - 1] == '\n' || buffer[end - 1] == ' '))
+      {
+         end--;
+      }
+
+      memset(transfer->etag, 0, sizeof(transfer->etag));
+      memcpy(transfer->etag, buffer + start, MIN(end - start, sizeof(transfer->etag) - 1));
    }
 
-   return 1;
+   return length;
 }
 
 static char*
 s3_get_host(void)
 {
    char* host = NULL;
+   char* start = NULL;
    struct main_configuration* config;
 
    config = (struct main_configuration*)shmem;
 
+   if (strlen(config->s3_endpoint) > 0)
+   {
+      start = strstr(config->s3_endpoint, "://");
+      start = start != NULL ? start + 3 : config->s3_endpoint;
+
+      host = pgmoneta_append(host, start);
+      if (pgmoneta_ends_with(host, "/"))
+      {
+         host[strlen(host) - 1] = '\0';
+      }
+
+      return host;
+   }
+
    host = pgmoneta_append(host, config->s3_bucket);
    host = pgmoneta_append(host, ".s3.");
    host = pgmoneta_append(host, config->s3_aws_region);
@@ -579,6 +1319,40 @@ s3_get_host(void)
    return host;
 }
 
+static char*
+s3_get_url(char* url_path, char* query)
+{
+   char* url = NULL;
+   char* host = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   host = s3_get_host();
+
+   if (strlen(config->s3_endpoint) > 0 && !strncmp(config->s3_endpoint, "http://", strlen("http://")))
+   {
+      url = pgmoneta_append(url, "http://");
+   }
+   else
+   {
+      url = pgmoneta_append(url, "https://");
+   }
+   url = pgmoneta_append(url, host);
+   url = pgmoneta_append(url, "/");
+   url = pgmoneta_append(url, url_path);
+
+   if (query != NULL)
+   {
+      url = pgmoneta_append(url, "?");
+      url = pgmoneta_append(url, query);
+   }
+
+   free(host);
+
+   return url;
+}
+
 static char*
 s3_get_basepath(int server, char* identifier)
 {
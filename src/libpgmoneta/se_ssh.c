@@ -30,9 +30,11 @@
 
 /* pgmoneta */
 #include <pgmoneta.h>
+#include <deque.h>
 #include <logging.h>
 #include <security.h>
 #include <utils.h>
+#include <workers.h>
 #include <workflow.h>
 
 /* system */
@@ -43,6 +45,30 @@
 #include <libssh/libssh.h>
 #include <libssh/sftp.h>
 
+#define SFTP_CHUNK_SIZE  (256 * 1024)
+#define SFTP_IN_FLIGHT   32
+
+/** @struct sftp_channel
+ * Defines an SSH session and its SFTP session, used by one thread at a time
+ */
+struct sftp_channel
+{
+   ssh_session session; /**< The SSH session */
+   sftp_session sftp;   /**< The SFTP session */
+};
+
+/** @struct sftp_copy_input
+ * Defines the input of a worker copying files over its own channel
+ */
+struct sftp_copy_input
+{
+   struct worker_common common;  /**< The common base */
+   struct sftp_channel* channel; /**< The channel of the worker */
+   char* local_root;             /**< The local root directory */
+   char* remote_root;            /**< The remote root directory */
+   struct deque* files;          /**< The files left to copy, shared by the workers */
+};
+
 static char* ssh_storage_name(void);
 static int ssh_storage_setup(char*, struct art*);
 static int ssh_storage_backup_execute(char*, struct art*);
@@ -57,14 +83,22 @@ static char* get_remote_server_wal(int server);
 
 static int read_latest_backup_sha256(char* path);
 
+static int ssh_open_channel(struct sftp_channel* channel);
+static void ssh_close_channel(struct sftp_channel* channel);
+
 static int sftp_make_directory(char* local_dir, char* remote_dir);
-static int sftp_copy_directory(char* local_root, char* remote_root, char* relative_path);
-static int sftp_copy_file(char* local_root, char* remote_root, char* relative_path);
+static int sftp_find_files(char* local_root, char* remote_root, char* relative_path, struct deque* files);
+static int sftp_copy_files(int server, char* local_root, char* remote_root, struct deque* files);
+static void do_sftp_copy_files(struct worker_common* wc);
+static int sftp_copy_queue(struct sftp_copy_input* input);
+static int sftp_copy_file(struct sftp_channel* channel, char* local_root, char* remote_root, char* relative_path);
+static int sftp_write_file(struct sftp_channel* channel, FILE* sfile, sftp_file dfile, char* path);
 static int sftp_wal_prepare(sftp_file* file, int segsize);
 static bool sftp_exists(char* path);
 static int sftp_get_file_size(char* file_path, size_t* file_size);
 static int sftp_permission(char* path, int user, int group, int all);
 
+static struct sftp_channel channel = {NULL, NULL};
 static ssh_session session = NULL;
 static sftp_session sftp = NULL;
 
@@ -118,19 +152,6 @@ ssh_storage_setup(char* name __attribute__((unused)), struct art* nodes)
 {
    int server = -1;
    char* label = NULL;
-   ssh_key srv_pubkey = NULL;
-   ssh_key client_pubkey = NULL;
-   ssh_key client_privkey = NULL;
-   char* pubkey_path = NULL;
-   char* privkey_path = NULL;
-   char* pubkey_full_path = NULL;
-   char* privkey_full_path = NULL;
-   char* homedir = NULL;
-   char* hexa = NULL;
-   unsigned char* srv_pubkey_hash = NULL;
-   size_t hash_length;
-   int rc;
-   enum ssh_known_hosts_e state;
    struct main_configuration* config;
 
    config = (struct main_configuration*)shmem;
@@ -153,151 +174,18 @@ ssh_storage_setup(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_log_debug("SSH storage engine (setup): %s/%s", config->common.servers[server].name, label);
 
-   homedir = getenv("HOME");
-   pubkey_path = "/.ssh/id_rsa.pub";
-   privkey_path = "/.ssh/id_rsa";
-
-   session = ssh_new();
-
-   if (session == NULL)
-   {
-      goto error;
-   }
-
-   ssh_options_set(session, SSH_OPTIONS_USER, config->ssh_username);
-   ssh_options_set(session, SSH_OPTIONS_HOST, config->ssh_hostname);
-
-   if (strlen(config->ssh_ciphers) == 0)
-   {
-      ssh_options_set(session, SSH_OPTIONS_CIPHERS_C_S, "aes256-ctr,aes192-ctr,aes128-ctr");
-   }
-   else
-   {
-      ssh_options_set(session, SSH_OPTIONS_CIPHERS_C_S, config->ssh_ciphers);
-   }
-
-   rc = ssh_connect(session);
-   if (rc != SSH_OK)
-   {
-      pgmoneta_log_error("Remote Backup: Error connecting to %s: %s",
-                         config->ssh_hostname, ssh_get_error(session));
-      goto error;
-   }
-
-   rc = ssh_get_server_publickey(session, &srv_pubkey);
-   if (rc < 0)
-   {
-      goto error;
-   }
-
-   rc = ssh_get_publickey_hash(srv_pubkey, SSH_PUBLICKEY_HASH_SHA1,
-                               &srv_pubkey_hash, &hash_length);
-   if (rc < 0)
-   {
-      goto error;
-   }
-
-   state = ssh_session_is_known_server(session);
-   switch (state)
+   if (ssh_open_channel(&channel))
    {
-      case SSH_KNOWN_HOSTS_OK:
-         break;
-      case SSH_KNOWN_HOSTS_CHANGED:
-         pgmoneta_log_error("the server key has changed: %s", strerror(errno));
-         goto error;
-      case SSH_KNOWN_HOSTS_OTHER:
-         pgmoneta_log_error("the host key for this server was not found: %s", strerror(errno));
-         goto error;
-      case SSH_KNOWN_HOSTS_NOT_FOUND:
-         pgmoneta_log_error("could not find known host file: %s", strerror(errno));
-         goto error;
-      case SSH_KNOWN_HOSTS_UNKNOWN:
-         rc = ssh_session_update_known_hosts(session);
-         if (rc < 0)
-         {
-            pgmoneta_log_error("could not update known_hosts file: %s", strerror(errno));
-            goto error;
-         }
-         break;
-      case SSH_KNOWN_HOSTS_ERROR:
-         pgmoneta_log_error("error checking the host: %s", strerror(errno));
-         goto error;
-   }
-
-   pubkey_full_path = pgmoneta_append(pubkey_full_path, homedir);
-   pubkey_full_path = pgmoneta_append(pubkey_full_path, pubkey_path);
-
-   rc = ssh_pki_import_pubkey_file(pubkey_full_path, &client_pubkey);
-   if (rc != SSH_OK)
-   {
-      pgmoneta_log_error("could not import host's public key: %s", strerror(errno));
-      goto error;
-   }
-
-   privkey_full_path = pgmoneta_append(privkey_full_path, homedir);
-   privkey_full_path = pgmoneta_append(privkey_full_path, privkey_path);
-
-   rc = ssh_pki_import_privkey_file(privkey_full_path, NULL, NULL, NULL,
-                                    &client_privkey);
-   if (rc != SSH_OK)
-   {
-      pgmoneta_log_error("could not import host's private key: %s", strerror(errno));
-      goto error;
-   }
-
-   rc = ssh_userauth_publickey(session, NULL, client_privkey);
-   if (rc != SSH_AUTH_SUCCESS)
-   {
-      pgmoneta_log_error("could not authenticate with public/private key: %s", strerror(errno));
-      goto error;
+      is_error = true;
+      return 1;
    }
 
-   sftp = sftp_new(session);
-
-   if (sftp == NULL)
-   {
-      pgmoneta_log_error("Error: %s", ssh_get_error(session));
-      goto error;
-   }
-
-   rc = sftp_init(sftp);
-   if (rc != SSH_OK)
-   {
-      pgmoneta_log_error("Error: %s", sftp_get_error(sftp));
-      goto error;
-   }
+   session = channel.session;
+   sftp = channel.sftp;
 
    is_error = false;
 
-   ssh_string_free_char(hexa);
-   ssh_clean_pubkey_hash(&srv_pubkey_hash);
-   ssh_key_free(srv_pubkey);
-   ssh_key_free(client_pubkey);
-   ssh_key_free(client_privkey);
-
-   free(pubkey_full_path);
-   free(privkey_full_path);
-
    return 0;
-
-error:
-
-   is_error = true;
-
-   ssh_string_free_char(hexa);
-   ssh_clean_pubkey_hash(&srv_pubkey_hash);
-   ssh_key_free(srv_pubkey);
-   ssh_key_free(client_pubkey);
-   ssh_key_free(client_privkey);
-
-   free(pubkey_full_path);
-   free(privkey_full_path);
-
-   sftp_free(sftp);
-
-   ssh_disconnect(session);
-   ssh_free(session);
-   return 1;
 }
 
 static int
@@ -315,6 +203,7 @@ ssh_storage_backup_execute(char* name __attribute__((unused)), struct art* nodes
    int next_newest = -1;
    int number_of_backups = 0;
    struct backup** backups = NULL;
+   struct deque* files = NULL;
    struct main_configuration* config;
 
 #ifdef HAVE_FREEBSD
@@ -389,13 +278,18 @@ ssh_storage_backup_execute(char* name __attribute__((unused)), struct art* nodes
       }
    }
 
-   sftp_copy_file(local_root, remote_root, "/backup.info");
-   sftp_copy_file(local_root, remote_root, "/backup.sha256");
+   sftp_copy_file(&channel, local_root, remote_root, "/backup.info");
+   sftp_copy_file(&channel, local_root, remote_root, "/backup.sha256");
 
    local_root = pgmoneta_append(local_root, "/data");
    remote_root = pgmoneta_append(remote_root, "/data");
 
-   if (sftp_copy_directory(local_root, remote_root, "") != 0)
+   if (pgmoneta_deque_create(true, &files))
+   {
+      goto error;
+   }
+
+   if (sftp_find_files(local_root, remote_root, "", files) || sftp_copy_files(server, local_root, remote_root, files))
    {
       pgmoneta_log_error("failed to transfer the backup directory from the local host to the remote server: %s", strerror(errno));
       goto error;
@@ -422,8 +316,12 @@ ssh_storage_backup_execute(char* name __attribute__((unused)), struct art* nodes
 
    remote_ssh_elapsed_time = pgmoneta_compute_duration(start_t, end_t);
 
+   free(local_root);
+   local_root = pgmoneta_get_server_backup_identifier(server, label);
+
    pgmoneta_update_info_double(local_root, INFO_REMOTE_SSH_ELAPSED, remote_ssh_elapsed_time);
 
+   pgmoneta_deque_destroy(files);
    free(server_path);
    free(remote_root);
    free(local_root);
@@ -445,6 +343,7 @@ error:
       free(latest_backup_sha256);
    }
 
+   pgmoneta_deque_destroy(files);
    free(server_path);
    free(remote_root);
    free(local_root);
@@ -590,6 +489,202 @@ ssh_storage_wal_shipping_teardown(char* name __attribute__((unused)), struct art
    return 0;
 }
 
+static int
+ssh_open_channel(struct sftp_channel* channel)
+{
+   ssh_session session = NULL;
+   sftp_session sftp = NULL;
+   ssh_key srv_pubkey = NULL;
+   ssh_key client_pubkey = NULL;
+   ssh_key client_privkey = NULL;
+   char* pubkey_path = NULL;
+   char* privkey_path = NULL;
+   char* pubkey_full_path = NULL;
+   char* privkey_full_path = NULL;
+   char* homedir = NULL;
+   char* hexa = NULL;
+   unsigned char* srv_pubkey_hash = NULL;
+   size_t hash_length;
+   int rc;
+   enum ssh_known_hosts_e state;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   channel->session = NULL;
+   channel->sftp = NULL;
+
+   homedir = getenv("HOME");
+   pubkey_path = "/.ssh/id_rsa.pub";
+   privkey_path = "/.ssh/id_rsa";
+
+   session = ssh_new();
+
+   if (session == NULL)
+   {
+      goto error;
+   }
+
+   ssh_options_set(session, SSH_OPTIONS_USER, config->ssh_username);
+   ssh_options_set(session, SSH_OPTIONS_HOST, config->ssh_hostname);
+
+   if (strlen(config->ssh_ciphers) == 0)
+   {
+      ssh_options_set(session, SSH_OPTIONS_CIPHERS_C_S, "aes256-ctr,aes192-ctr,aes128-ctr");
+   }
+   else
+   {
+      ssh_options_set(session, SSH_OPTIONS_CIPHERS_C_S, config->ssh_ciphers);
+   }
+
+   rc = ssh_connect(session);
+   if (rc != SSH_OK)
+   {
+      pgmoneta_log_error("Remote Backup: Error connecting to %s: %s",
+                         config->ssh_hostname, ssh_get_error(session));
+      goto error;
+   }
+
+   rc = ssh_get_server_publickey(session, &srv_pubkey);
+   if (rc < 0)
+   {
+      goto error;
+   }
+
+   rc = ssh_get_publickey_hash(srv_pubkey, SSH_PUBLICKEY_HASH_SHA1,
+                               &srv_pubkey_hash, &hash_length);
+   if (rc < 0)
+   {
+      goto error;
+   }
+
+   state = ssh_session_is_known_server(session);
+   switch (state)
+   {
+      case SSH_KNOWN_HOSTS_OK:
+         break;
+      case SSH_KNOWN_HOSTS_CHANGED:
+         pgmoneta_log_error("the server key has changed: %s", strerror(errno));
+         goto error;
+      case SSH_KNOWN_HOSTS_OTHER:
+         pgmoneta_log_error("the host key for this server was not found: %s", strerror(errno));
+         goto error;
+      case SSH_KNOWN_HOSTS_NOT_FOUND:
+         pgmoneta_log_error("could not find known host file: %s", strerror(errno));
+         goto error;
+      case SSH_KNOWN_HOSTS_UNKNOWN:
+         rc = ssh_session_update_known_hosts(session);
+         if (rc < 0)
+         {
+            pgmoneta_log_error("could not update known_hosts file: %s", strerror(errno));
+            goto error;
+         }
+         break;
+      case SSH_KNOWN_HOSTS_ERROR:
+         pgmoneta_log_error("error checking the host: %s", strerror(errno));
+         goto error;
+   }
+
+   pubkey_full_path = pgmoneta_append(pubkey_full_path, homedir);
+   pubkey_full_path = pgmoneta_append(pubkey_full_path, pubkey_path);
+
+   rc = ssh_pki_import_pubkey_file(pubkey_full_path, &client_pubkey);
+   if (rc != SSH_OK)
+   {
+      pgmoneta_log_error("could not import host's public key: %s", strerror(errno));
+      goto error;
+   }
+
+   privkey_full_path = pgmoneta_append(privkey_full_path, homedir);
+   privkey_full_path = pgmoneta_append(privkey_full_path, privkey_path);
+
+   rc = ssh_pki_import_privkey_file(privkey_full_path, NULL, NULL, NULL,
+                                    &client_privkey);
+   if (rc != SSH_OK)
+   {
+      pgmoneta_log_error("could not import host's private key: %s", strerror(errno));
+      goto error;
+   }
+
+   rc = ssh_userauth_publickey(session, NULL, client_privkey);
+   if (rc != SSH_AUTH_SUCCESS)
+   {
+      pgmoneta_log_error("could not authenticate with public/private key: %s", strerror(errno));
+      goto error;
+   }
+
+   sftp = sftp_new(session);
+
+   if (sftp == NULL)
+   {
+      pgmoneta_log_error("Error: %s", ssh_get_error(session));
+      goto error;
+   }
+
+   rc = sftp_init(sftp);
+   if (rc != SSH_OK)
+   {
+      pgmoneta_log_error("Error: %d", sftp_get_error(sftp));
+      goto error;
+   }
+
+   channel->session = session;
+   channel->sftp = sftp;
+
+   ssh_string_free_char(hexa);
+   ssh_clean_pubkey_hash(&srv_pubkey_hash);
+   ssh_key_free(srv_pubkey);
+   ssh_key_free(client_pubkey);
+   ssh_key_free(client_privkey);
+
+   free(pubkey_full_path);
+   free(privkey_full_path);
+
+   return 0;
+
+error:
+
+   ssh_string_free_char(hexa);
+   ssh_clean_pubkey_hash(&srv_pubkey_hash);
+   ssh_key_free(srv_pubkey);
+   ssh_key_free(client_pubkey);
+   ssh_key_free(client_privkey);
+
+   free(pubkey_full_path);
+   free(privkey_full_path);
+
+   if (sftp != NULL)
+   {
+      sftp_free(sftp);
+   }
+
+   if (session != NULL)
+   {
+      ssh_disconnect(session);
+      ssh_free(session);
+   }
+
+   return 1;
+}
+
+
+static void
+ssh_close_channel(struct sftp_channel* channel)
+{
+   if (channel->sftp != NULL)
+   {
+      sftp_free(channel->sftp);
+      channel->sftp = NULL;
+   }
+
+   if (channel->session != NULL)
+   {
+      ssh_disconnect(channel->session);
+      ssh_free(channel->session);
+      channel->session = NULL;
+   }
+}
+
 static int
 sftp_make_directory(char* local_dir, char* remote_dir)
 {
@@ -636,13 +731,13 @@ error:
 }
 
 static int
-sftp_copy_directory(char* local_root, char* remote_root, char* relative_path)
+sftp_find_files(char* local_root, char* remote_root, char* relative_path, struct deque* files)
 {
    char* from = NULL;
    char* to = NULL;
    char* relative_file;
    int rc;
-   DIR* dir;
+   DIR* dir = NULL;
    struct dirent* entry;
    mode_t mode = 0;
 
@@ -659,6 +754,7 @@ sftp_copy_directory(char* local_root, char* remote_root, char* relative_path)
 
    mode = pgmoneta_get_permission(from);
 
+   // the directories are created up front, so the files can be copied in any order
    rc = sftp_mkdir(sftp, to, mode);
    if (rc != SSH_OK)
    {
@@ -681,7 +777,10 @@ sftp_copy_directory(char* local_root, char* remote_root, char* relative_path)
 
          snprintf(relative_dir, sizeof(relative_dir), "%s/%s", relative_path, entry->d_name);
 
-         sftp_copy_directory(local_root, remote_root, relative_dir);
+         if (sftp_find_files(local_root, remote_root, relative_dir, files))
+         {
+            goto error;
+         }
       }
       else
       {
@@ -691,11 +790,7 @@ sftp_copy_directory(char* local_root, char* remote_root, char* relative_path)
          relative_file = pgmoneta_append(relative_file, "/");
          relative_file = pgmoneta_append(relative_file, entry->d_name);
 
-         if (sftp_copy_file(local_root, remote_root, relative_file))
-         {
-            free(relative_file);
-            goto error;
-         }
+         pgmoneta_deque_add(files, NULL, (uintptr_t)relative_file, ValueString);
 
          free(relative_file);
       }
@@ -710,7 +805,10 @@ sftp_copy_directory(char* local_root, char* remote_root, char* relative_path)
 
 error:
 
-   closedir(dir);
+   if (dir != NULL)
+   {
+      closedir(dir);
+   }
 
    free(from);
    free(to);
@@ -719,17 +817,154 @@ error:
 }
 
 static int
-sftp_copy_file(char* local_root, char* remote_root, char* relative_path)
+sftp_copy_files(int server, char* local_root, char* remote_root, struct deque* files)
+{
+   int number_of_workers = 0;
+   int number_of_channels = 1;
+   struct workers* workers = NULL;
+   struct sftp_channel* channels = NULL;
+   struct sftp_copy_input* input = NULL;
+   bool success = true;
+
+   number_of_workers = pgmoneta_get_number_of_workers(server);
+
+   channels = (struct sftp_channel*)calloc(MAX(number_of_workers, 1), sizeof(struct sftp_channel));
+   if (channels == NULL)
+   {
+      goto error;
+   }
+
+   channels[0] = channel;
+
+   // each worker opens its own SSH session, as a session can't be shared between threads
+   if (number_of_workers > 1)
+   {
+      if (pgmoneta_workers_initialize(number_of_workers, &workers))
+      {
+         pgmoneta_log_warn("SSH: Could not start the workers, copying over one session");
+         workers = NULL;
+      }
+      else
+      {
+         number_of_channels = number_of_workers;
+      }
+   }
+
+   for (int i = 0; i < number_of_channels; i++)
+   {
+      input = (struct sftp_copy_input*)malloc(sizeof(struct sftp_copy_input));
+      if (input == NULL)
+      {
+         success = false;
+         break;
+      }
+
+      memset(input, 0, sizeof(struct sftp_copy_input));
+      input->common.workers = workers;
+      input->channel = &channels[i];
+      input->local_root = local_root;
+      input->remote_root = remote_root;
+      input->files = files;
+
+      if (workers != NULL)
+      {
+         pgmoneta_workers_add(workers, do_sftp_copy_files, (struct worker_common*)input);
+      }
+      else
+      {
+         success = sftp_copy_queue(input) == 0;
+         free(input);
+      }
+   }
+
+   if (workers != NULL)
+   {
+      pgmoneta_workers_wait(workers);
+      success = success && workers->outcome;
+      pgmoneta_workers_destroy(workers);
+   }
+
+   success = success && pgmoneta_deque_empty(files);
+
+   for (int i = 1; i < MAX(number_of_workers, 1); i++)
+   {
+      ssh_close_channel(&channels[i]);
+   }
+   free(channels);
+
+   if (!success)
+   {
+      goto error;
+   }
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+static void
+do_sftp_copy_files(struct worker_common* wc)
+{
+   struct sftp_copy_input* input = (struct sftp_copy_input*)wc;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   // the files are left to the other sessions if this one can't be opened
+   if (input->channel->session == NULL && ssh_open_channel(input->channel))
+   {
+      pgmoneta_log_warn("SSH: Could not open an additional session to %s", config->ssh_hostname);
+      free(input);
+      return;
+   }
+
+   if (sftp_copy_queue(input))
+   {
+      input->common.workers->outcome = false;
+   }
+
+   free(input);
+}
+
+static int
+sftp_copy_queue(struct sftp_copy_input* input)
+{
+   char* relative_file = NULL;
+
+   while (input->common.workers == NULL || input->common.workers->outcome)
+   {
+      relative_file = (char*)pgmoneta_deque_poll(input->files, NULL);
+
+      if (relative_file == NULL)
+      {
+         break;
+      }
+
+      if (sftp_copy_file(input->channel, input->local_root, input->remote_root, relative_file))
+      {
+         pgmoneta_log_error("SSH: Could not copy %s%s", input->local_root, relative_file);
+         free(relative_file);
+         return 1;
+      }
+
+      free(relative_file);
+   }
+
+   return 0;
+}
+
+static int
+sftp_copy_file(struct sftp_channel* channel, char* local_root, char* remote_root, char* relative_path)
 {
    char* s = NULL;
    char* d = NULL;
    char* sha256 = NULL;
    char* latest_sha256 = NULL;
    char* latest_backup_path = NULL;
-   char buffer[16384];
    FILE* sfile = NULL;
    sftp_file dfile = NULL;
-   unsigned long read_bytes = 0;
    mode_t mode = 0;
    bool is_link = false;
 
@@ -748,7 +983,7 @@ sftp_copy_file(char* local_root, char* remote_root, char* relative_path)
 
       if ((latest_sha256 = (char*)pgmoneta_art_search(tree_map, relative_path)) != NULL)
       {
-         if (!strcmp(latest_sha256, sha256))
+         if (sha256 != NULL && !strcmp(latest_sha256, sha256))
          {
             is_link = true;
          }
@@ -757,9 +992,9 @@ sftp_copy_file(char* local_root, char* remote_root, char* relative_path)
 
    if (is_link)
    {
-      if (sftp_symlink(sftp, latest_backup_path, d) < 0)
+      if (sftp_symlink(channel->sftp, latest_backup_path, d) < 0)
       {
-         pgmoneta_log_error("Failed to link remotely: %s", ssh_get_error(session));
+         pgmoneta_log_error("Failed to link remotely: %s", ssh_get_error(channel->session));
          goto error;
       }
    }
@@ -774,29 +1009,29 @@ sftp_copy_file(char* local_root, char* remote_root, char* relative_path)
          goto error;
       }
 
-      dfile = sftp_open(sftp, d, O_WRONLY | O_CREAT | O_TRUNC, mode);
+      dfile = sftp_open(channel->sftp, d, O_WRONLY | O_CREAT | O_TRUNC, mode);
 
       if (dfile == NULL)
       {
          goto error;
       }
 
-      memset(buffer, 0, sizeof(buffer));
-
-      while ((read_bytes = fread(buffer, 1, sizeof(buffer), sfile)) > 0)
+      if (sftp_write_file(channel, sfile, dfile, d))
       {
-         sftp_write(dfile, buffer, read_bytes);
+         goto error;
       }
    }
 
    if (sfile != NULL)
    {
       fclose(sfile);
+      sfile = NULL;
    }
 
-   if (dfile != NULL)
+   if (dfile != NULL && sftp_close(dfile) != SSH_OK)
    {
-      sftp_close(dfile);
+      dfile = NULL;
+      goto error;
    }
 
    free(s);
@@ -834,6 +1069,139 @@ error:
    return 1;
 }
 
+static int
+sftp_write_file(struct sftp_channel* channel, FILE* sfile, sftp_file dfile, char* path)
+{
+   char* buffer = NULL;
+   size_t chunk = SFTP_CHUNK_SIZE;
+   size_t read_bytes = 0;
+#if LIBSSH_VERSION_INT >= SSH_VERSION_INT(0, 11, 0)
+   sftp_aio aio[SFTP_IN_FLIGHT];
+   size_t length[SFTP_IN_FLIGHT];
+   int head = 0;
+   int in_flight = 0;
+   bool eof = false;
+   ssize_t written = 0;
+   sftp_limits_t limits = NULL;
+
+   // a write request can't be larger than what the server accepts
+   limits = sftp_limits(channel->sftp);
+   if (limits != NULL)
+   {
+      chunk = MIN(chunk, (size_t)limits->max_write_length);
+      sftp_limits_free(limits);
+   }
+   else
+   {
+      chunk = 32768;
+   }
+
+   buffer = (char*)malloc(chunk);
+   if (buffer == NULL)
+   {
+      goto error;
+   }
+
+   // up to SFTP_IN_FLIGHT write requests are sent before the oldest reply is
+   // waited for, so the transfer isn't bound by the round trip time
+   while (!eof || in_flight > 0)
+   {
+      if (in_flight == SFTP_IN_FLIGHT || (eof && in_flight > 0))
+      {
+         written = sftp_aio_wait_write(&aio[head]);
+         if (written == SSH_ERROR || (size_t)written != length[head])
+         {
+            pgmoneta_log_error("SSH: Could not write %s: %s", path, ssh_get_error(channel->session));
+            aio[head] = NULL;
+            goto error;
+         }
+
+         head = (head + 1) % SFTP_IN_FLIGHT;
+         in_flight--;
+         continue;
+      }
+
+      read_bytes = fread(buffer, 1, chunk, sfile);
+      if (read_bytes == 0)
+      {
+         if (ferror(sfile))
+         {
+            goto error;
+         }
+         eof = true;
+         continue;
+      }
+
+      // the data is copied into the request, so the buffer can be reused right away
+      length[(head + in_flight) % SFTP_IN_FLIGHT] = read_bytes;
+      if (sftp_aio_begin_write(dfile, buffer, read_bytes, &aio[(head + in_flight) % SFTP_IN_FLIGHT]) == SSH_ERROR)
+      {
+         pgmoneta_log_error("SSH: Could not write %s: %s", path, ssh_get_error(channel->session));
+         goto error;
+      }
+      in_flight++;
+   }
+
+   free(buffer);
+
+   return 0;
+
+error:
+
+   // a failed wait frees its request, the others are still pending
+   for (int i = 0; i < in_flight; i++)
+   {
+      if (aio[(head + i) % SFTP_IN_FLIGHT] != NULL)
+      {
+         sftp_aio_free(aio[(head + i) % SFTP_IN_FLIGHT]);
+      }
+   }
+
+   free(buffer);
+
+   return 1;
+#else
+   ssize_t written = 0;
+   size_t offset = 0;
+
+   buffer = (char*)malloc(chunk);
+   if (buffer == NULL)
+   {
+      goto error;
+   }
+
+   while ((read_bytes = fread(buffer, 1, chunk, sfile)) > 0)
+   {
+      offset = 0;
+      while (offset < read_bytes)
+      {
+         written = sftp_write(dfile, buffer + offset, read_bytes - offset);
+         if (written <= 0)
+         {
+            pgmoneta_log_error("SSH: Could not write %s: %s", path, ssh_get_error(channel->session));
+            goto error;
+         }
+         offset += written;
+      }
+   }
+
+   if (ferror(sfile))
+   {
+      goto error;
+   }
+
+   free(buffer);
+
+   return 0;
+
+error:
+
+   free(buffer);
+
+   return 1;
+#endif
+}
+
 static int
 sftp_wal_prepare(sftp_file* file, int segsize)
 {
@@ -28,6 +28,7 @@
 
 /* pgmoneta */
 #include <pgmoneta.h>
+#include <art.h>
 #include <logging.h>
 #include <network.h>
 #include <security.h>
@@ -37,6 +38,7 @@
 #ifdef HAVE_PCLMUL
 #include <nmmintrin.h>
 #endif
+#include <pthread.h>
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -58,6 +60,7 @@
 #include <openssl/ssl.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 
 typedef uint32_t pg_crc32c;
@@ -137,6 +140,28 @@ static int  create_ssl_client(SSL_CTX* ctx, char* key, char* cert, char* root, i
 
 static int create_hash_file(char* filename, char* algorithm, char** hash);
 
+static char* hash_collector_key(char* path);
+static int digest_to_hex(EVP_MD_CTX* ctx, char* hex, size_t size);
+
+/** @struct collected_hash
+ * Defines the digests collected for a written file
+ */
+struct collected_hash
+{
+   dev_t dev;              /**< The device of the file */
+   ino_t ino;              /**< The inode of the file */
+   off_t size;             /**< The size of the file when it was written */
+   struct timespec mtime;  /**< The modification time of the file when it was written */
+   char sha256[65];        /**< The SHA-256, or empty */
+   char sha512[129];       /**< The SHA-512 */
+};
+
+static bool hash_collector_is_current(struct collected_hash* h, struct stat* st);
+
+static pthread_mutex_t hash_collector_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct art* hash_collector = NULL;
+static bool hash_collector_sha256 = false;
+
 int
 pgmoneta_remote_management_auth(int client_fd, char* address, SSL** client_ssl)
 {
@@ -2895,6 +2920,315 @@ pgmoneta_create_sha512_file(char* filename, char** sha512)
    return create_hash_file(filename, "SHA512", sha512);
 }
 
+int
+pgmoneta_create_sha256_buffer(void* buffer, size_t size, char** sha256)
+{
+   unsigned char md_value[EVP_MAX_MD_SIZE];
+   unsigned int md_len = 0;
+   char* sha256_buf = NULL;
+
+   *sha256 = NULL;
+
+   if (!EVP_Digest(buffer, size, md_value, &md_len, EVP_sha256(), NULL))
+   {
+      pgmoneta_log_error("Message digest failed");
+      return 1;
+   }
+
+   sha256_buf = malloc(md_len * 2 + 1);
+   if (sha256_buf == NULL)
+   {
+      return 1;
+   }
+
+   for (unsigned int i = 0; i < md_len; i++)
+   {
+      sprintf(&sha256_buf[i * 2], "%02x", md_value[i]);
+   }
+   sha256_buf[md_len * 2] = 0;
+
+   *sha256 = sha256_buf;
+
+   return 0;
+}
+
+int
+pgmoneta_hash_collector_start(bool sha256)
+{
+   int ret = 0;
+
+   pthread_mutex_lock(&hash_collector_lock);
+
+   if (hash_collector == NULL)
+   {
+      ret = pgmoneta_art_create(&hash_collector);
+   }
+   hash_collector_sha256 = hash_collector_sha256 || sha256;
+
+   pthread_mutex_unlock(&hash_collector_lock);
+
+   return ret;
+}
+
+int
+pgmoneta_hash_collector_get(char* path, char** sha256, char** sha512)
+{
+   char* key = NULL;
+   char* s256 = NULL;
+   char* s512 = NULL;
+   struct collected_hash* h = NULL;
+   struct stat st;
+
+   if (sha256 != NULL)
+   {
+      *sha256 = NULL;
+   }
+   if (sha512 != NULL)
+   {
+      *sha512 = NULL;
+   }
+
+   if (path == NULL || stat(path, &st) != 0)
+   {
+      return 1;
+   }
+
+   key = hash_collector_key(path);
+   if (key == NULL)
+   {
+      return 1;
+   }
+
+   pthread_mutex_lock(&hash_collector_lock);
+
+   if (hash_collector != NULL)
+   {
+      h = (struct collected_hash*)pgmoneta_art_search(hash_collector, key);
+   }
+
+   // the file was replaced or changed after it was written
+   if (h == NULL || !hash_collector_is_current(h, &st) || (sha256 != NULL && strlen(h->sha256) == 0))
+   {
+      goto error;
+   }
+
+   if (sha256 != NULL)
+   {
+      s256 = pgmoneta_append(s256, h->sha256);
+   }
+   if (sha512 != NULL)
+   {
+      s512 = pgmoneta_append(s512, h->sha512);
+   }
+
+   pthread_mutex_unlock(&hash_collector_lock);
+
+   if (sha256 != NULL)
+   {
+      *sha256 = s256;
+   }
+   if (sha512 != NULL)
+   {
+      *sha512 = s512;
+   }
+
+   free(key);
+
+   return 0;
+
+error:
+
+   pthread_mutex_unlock(&hash_collector_lock);
+
+   free(key);
+
+   return 1;
+}
+
+void
+pgmoneta_hash_collector_stop(void)
+{
+   pthread_mutex_lock(&hash_collector_lock);
+
+   pgmoneta_art_destroy(hash_collector);
+   hash_collector = NULL;
+   hash_collector_sha256 = false;
+
+   pthread_mutex_unlock(&hash_collector_lock);
+}
+
+int
+pgmoneta_file_hash_create(struct file_hash** hash)
+{
+   bool active = false;
+   bool sha256 = false;
+   struct file_hash* h = NULL;
+
+   *hash = NULL;
+
+   pthread_mutex_lock(&hash_collector_lock);
+   active = hash_collector != NULL;
+   sha256 = hash_collector_sha256;
+   pthread_mutex_unlock(&hash_collector_lock);
+
+   if (!active)
+   {
+      return 0;
+   }
+
+   h = (struct file_hash*)malloc(sizeof(struct file_hash));
+   if (h == NULL)
+   {
+      goto error;
+   }
+
+   memset(h, 0, sizeof(struct file_hash));
+
+   h->sha512 = EVP_MD_CTX_new();
+   if (h->sha512 == NULL || !EVP_DigestInit_ex(h->sha512, EVP_sha512(), NULL))
+   {
+      goto error;
+   }
+
+   if (sha256)
+   {
+      h->sha256 = EVP_MD_CTX_new();
+      if (h->sha256 == NULL || !EVP_DigestInit_ex(h->sha256, EVP_sha256(), NULL))
+      {
+         goto error;
+      }
+   }
+
+   *hash = h;
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Message digest initialization failed");
+
+   pgmoneta_file_hash_destroy(h);
+
+   return 1;
+}
+
+int
+pgmoneta_file_hash_update(struct file_hash* hash, void* data, size_t size)
+{
+   if (hash == NULL || size == 0)
+   {
+      return 0;
+   }
+
+   if (!EVP_DigestUpdate(hash->sha512, data, size))
+   {
+      goto error;
+   }
+
+   if (hash->sha256 != NULL && !EVP_DigestUpdate(hash->sha256, data, size))
+   {
+      goto error;
+   }
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Message digest update failed");
+
+   return 1;
+}
+
+int
+pgmoneta_file_hash_finish(struct file_hash* hash, char* path)
+{
+   char* key = NULL;
+   struct collected_hash* h = NULL;
+   struct stat st;
+
+   if (hash == NULL)
+   {
+      return 0;
+   }
+
+   if (stat(path, &st) != 0)
+   {
+      goto error;
+   }
+
+   h = (struct collected_hash*)malloc(sizeof(struct collected_hash));
+   if (h == NULL)
+   {
+      goto error;
+   }
+
+   memset(h, 0, sizeof(struct collected_hash));
+
+   h->dev = st.st_dev;
+   h->ino = st.st_ino;
+   h->size = st.st_size;
+   pgmoneta_get_file_mtime(&st, &h->mtime);
+
+   if (digest_to_hex(hash->sha512, h->sha512, sizeof(h->sha512)))
+   {
+      goto error;
+   }
+
+   if (hash->sha256 != NULL && digest_to_hex(hash->sha256, h->sha256, sizeof(h->sha256)))
+   {
+      goto error;
+   }
+
+   key = hash_collector_key(path);
+   if (key == NULL)
+   {
+      goto error;
+   }
+
+   pthread_mutex_lock(&hash_collector_lock);
+
+   if (hash_collector != NULL)
+   {
+      pgmoneta_art_insert(hash_collector, key, (uintptr_t)h, ValueMem);
+      h = NULL;
+   }
+
+   pthread_mutex_unlock(&hash_collector_lock);
+
+   free(key);
+   free(h);
+
+   return 0;
+
+error:
+
+   free(key);
+   free(h);
+
+   return 1;
+}
+
+void
+pgmoneta_file_hash_destroy(struct file_hash* hash)
+{
+   if (hash == NULL)
+   {
+      return;
+   }
+
+   if (hash->sha256 != NULL)
+   {
+      EVP_MD_CTX_free(hash->sha256);
+   }
+
+   if (hash->sha512 != NULL)
+   {
+      EVP_MD_CTX_free(hash->sha512);
+   }
+
+   free(hash);
+}
+
 int
 pgmoneta_generate_string_sha256_hash(char* string, char** sha256)
 {
@@ -3412,4 +3746,61 @@ pgmoneta_finalize_crc32c(uint32_t* crc)
    *crc ^= 0xFFFFFFFF;
 
    return 0;
-}
\ No newline at end of file
+}
+
+static bool
+hash_collector_is_current(struct collected_hash* h, struct stat* st)
+{
+   struct timespec mtime;
+
+   pgmoneta_get_file_mtime(st, &mtime);
+
+   return h->dev == st->st_dev && h->ino == st->st_ino && h->size == st->st_size &&
+          h->mtime.tv_sec == mtime.tv_sec && h->mtime.tv_nsec == mtime.tv_nsec;
+}
+
+static char*
+hash_collector_key(char* path)
+{
+   char* key = NULL;
+   size_t length = 0;
+
+   key = (char*)malloc(strlen(path) + 1);
+   if (key == NULL)
+   {
+      return NULL;
+   }
+
+   // the workflows build paths with repeated separators
+   for (size_t i = 0; path[i] != '\0'; i++)
+   {
+      if (path[i] == '/' && length > 0 && key[length - 1] == '/')
+      {
+         continue;
+      }
+      key[length++] = path[i];
+   }
+   key[length] = '\0';
+
+   return key;
+}
+
+static int
+digest_to_hex(EVP_MD_CTX* ctx, char* hex, size_t size)
+{
+   unsigned char md_value[EVP_MAX_MD_SIZE];
+   unsigned int md_len = 0;
+
+   if (!EVP_DigestFinal_ex(ctx, md_value, &md_len) || md_len * 2 + 1 > size)
+   {
+      pgmoneta_log_error("Message digest finalization failed");
+      return 1;
+   }
+
+   for (unsigned int i = 0; i < md_len; i++)
+   {
+      sprintf(&hex[i * 2], "%02x", md_value[i]);
+   }
+
+   return 0;
+}
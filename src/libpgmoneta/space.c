@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* pgmoneta */
+#include <pgmoneta.h>
+#include <logging.h>
+#include <space.h>
+#include <utils.h>
+
+/* system */
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+static char* space_directory(int server, int area);
+static uint64_t space_walk(int server, int area);
+static uint64_t space_other(void);
+static uint64_t space_entries(char* directory, bool server);
+static bool space_is_server(char* name);
+
+void
+pgmoneta_space_add(int server, int area, int64_t delta)
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (server == SPACE_OTHER)
+   {
+      atomic_fetch_add(&config->space_other, delta);
+      return;
+   }
+
+   if (server < 0 || server >= config->common.number_of_servers || area < 0 || area >= NUMBER_OF_SPACES)
+   {
+      return;
+   }
+
+   atomic_fetch_add(&config->common.servers[server].space[area], delta);
+}
+
+void
+pgmoneta_space_invalidate(int server, int area)
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (server == SPACE_OTHER)
+   {
+      atomic_store(&config->space_other_invalid, true);
+      return;
+   }
+
+   if (server < 0 || server >= config->common.number_of_servers || area < 0 || area >= NUMBER_OF_SPACES)
+   {
+      return;
+   }
+
+   atomic_fetch_or(&config->common.servers[server].space_invalid, 1U << area);
+}
+
+int64_t
+pgmoneta_space_file(char* path)
+{
+   struct stat st;
+   int64_t blocks;
+
+   memset(&st, 0, sizeof(struct stat));
+
+   if (path == NULL || stat(path, &st) != 0 || st.st_blksize <= 0)
+   {
+      return 0;
+   }
+
+   blocks = st.st_size / st.st_blksize;
+
+   if (st.st_size % st.st_blksize != 0)
+   {
+      blocks += 1;
+   }
+
+   return blocks * st.st_blksize;
+}
+
+uint64_t
+pgmoneta_space_get(int server, int area)
+{
+   int64_t size;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (server < 0 || server >= config->common.number_of_servers || area < 0 || area >= NUMBER_OF_SPACES)
+   {
+      return 0;
+   }
+
+   if (atomic_load(&config->space_reconciled) == 0)
+   {
+      return space_walk(server, area);
+   }
+
+   size = atomic_load(&config->common.servers[server].space[area]);
+
+   /* A delta can race with a walk, the next reconciliation corrects it */
+   return size > 0 ? (uint64_t)size : 0;
+}
+
+uint64_t
+pgmoneta_space_server(int server)
+{
+   return pgmoneta_space_get(server, SPACE_BACKUP) + pgmoneta_space_get(server, SPACE_WAL);
+}
+
+uint64_t
+pgmoneta_space_used(void)
+{
+   char* d = NULL;
+   int64_t other;
+   uint64_t size = 0;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (atomic_load(&config->space_reconciled) == 0)
+   {
+      d = pgmoneta_append(d, config->base_dir);
+      d = pgmoneta_append(d, "/");
+
+      size = pgmoneta_directory_size(d);
+
+      free(d);
+
+      return size;
+   }
+
+   other = atomic_load(&config->space_other);
+   size = other > 0 ? (uint64_t)other : 0;
+
+   for (int i = 0; i < config->common.number_of_servers; i++)
+   {
+      size += pgmoneta_space_server(i);
+   }
+
+   return size;
+}
+
+void
+pgmoneta_space_reconcile(void)
+{
+   bool full = false;
+   time_t now;
+   int64_t reconciled;
+   unsigned int invalid;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   now = time(NULL);
+   reconciled = atomic_load(&config->space_reconciled);
+   full = reconciled == 0 || now - reconciled >= SPACE_RECONCILE_INTERVAL;
+
+   for (int i = 0; i < config->common.number_of_servers; i++)
+   {
+      for (int area = 0; area < NUMBER_OF_SPACES; area++)
+      {
+         /* Clear the mark before the walk, so a change during the walk marks it again */
+         invalid = atomic_fetch_and(&config->common.servers[i].space_invalid, ~(1U << area));
+
+         if (full || (invalid & (1U << area)))
+         {
+            atomic_store(&config->common.servers[i].space[area], (int64_t)space_walk(i, area));
+         }
+      }
+   }
+
+   if (atomic_exchange(&config->space_other_invalid, false) || full)
+   {
+      atomic_store(&config->space_other, (int64_t)space_other());
+   }
+
+   if (full)
+   {
+      pgmoneta_log_debug("Space: Reconciled %" PRIu64 " bytes in %lld seconds", pgmoneta_space_used(), (long long)(time(NULL) - now));
+      atomic_store(&config->space_reconciled, (int64_t)now);
+   }
+}
+
+static char*
+space_directory(int server, int area)
+{
+   switch (area)
+   {
+      case SPACE_BACKUP:
+         return pgmoneta_get_server_backup(server);
+      case SPACE_WAL:
+         return pgmoneta_get_server_wal(server);
+      case SPACE_WAL_SHIPPING:
+         return pgmoneta_get_server_wal_shipping(server);
+      case SPACE_HOT_STANDBY:
+         return pgmoneta_get_server_hot_standby(server);
+      case SPACE_WORKSPACE:
+         return pgmoneta_get_server_workspace(server);
+      default:
+         break;
+   }
+
+   return NULL;
+}
+
+static uint64_t
+space_walk(int server, int area)
+{
+   char* d = NULL;
+   uint64_t size = 0;
+
+   d = space_directory(server, area);
+
+   if (d != NULL)
+   {
+      size = pgmoneta_directory_size(d);
+   }
+
+   free(d);
+
+   return size;
+}
+
+static uint64_t
+space_other(void)
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   return space_entries(config->base_dir, false);
+}
+
+static uint64_t
+space_entries(char* directory, bool server)
+{
+   DIR* dir = NULL;
+   struct dirent* entry = NULL;
+   char path[MAX_PATH];
+   uint64_t size = 0;
+
+   if (!(dir = opendir(directory)))
+   {
+      return 0;
+   }
+
+   while ((entry = readdir(dir)) != NULL)
+   {
+      if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+      {
+         continue;
+      }
+
+      if (pgmoneta_ends_with(directory, "/"))
+      {
+         snprintf(path, sizeof(path), "%s%s", directory, entry->d_name);
+      }
+      else
+      {
+         snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+      }
+
+      if (entry->d_type == DT_DIR)
+      {
+         /* The backup and WAL directories of a server have their own counters */
+         if (server && (!strcmp(entry->d_name, "backup") || !strcmp(entry->d_name, "wal")))
+         {
+            continue;
+         }
+
+         if (!server && space_is_server(entry->d_name))
+         {
+            size += space_entries(path, true);
+         }
+         else
+         {
+            size += pgmoneta_directory_size(path);
+         }
+      }
+      else if (entry->d_type == DT_REG)
+      {
+         size += pgmoneta_space_file(path);
+      }
+      else if (entry->d_type == DT_LNK)
+      {
+         struct stat st;
+
+         memset(&st, 0, sizeof(struct stat));
+         stat(path, &st);
+
+         size += st.st_blksize;
+      }
+   }
+
+   closedir(dir);
+
+   return size;
+}
+
+static bool
+space_is_server(char* name)
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   for (int i = 0; i < config->common.number_of_servers; i++)
+   {
+      if (!strcmp(config->common.servers[i].name, name))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
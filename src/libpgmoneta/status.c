@@ -32,6 +32,7 @@
 #include <logging.h>
 #include <management.h>
 #include <network.h>
+#include <space.h>
 #include <utils.h>
 
 #define NAME "status"
@@ -77,17 +78,10 @@ pgmoneta_status(SSL* ssl, int client_fd, bool offline, uint8_t compression, uint
       goto error;
    }
 
-   d = NULL;
-   d = pgmoneta_append(d, config->base_dir);
-   d = pgmoneta_append(d, "/");
-
-   used_size = pgmoneta_directory_size(d);
+   used_size = pgmoneta_space_used();
 
    pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_USED_SPACE, (uintptr_t)used_size, ValueUInt64);
 
-   free(d);
-   d = NULL;
-
    free_size = pgmoneta_free_space(config->base_dir);
    total_size = pgmoneta_total_space(config->base_dir);
 
@@ -143,18 +137,13 @@ pgmoneta_status(SSL* ssl, int client_fd, bool offline, uint8_t compression, uint
       free(d);
       d = NULL;
 
-      d = pgmoneta_get_server(i);
-
-      server_size = pgmoneta_directory_size(d);
+      server_size = pgmoneta_space_server(i);
 
       pgmoneta_json_put(js, MANAGEMENT_ARGUMENT_SERVER_SIZE, (uintptr_t)server_size, ValueUInt64);
 
-      free(d);
-      d = NULL;
-
       if (strlen(config->common.servers[i].workspace) > 0)
       {
-         workspace_size = pgmoneta_directory_size(config->common.servers[i].workspace);
+         workspace_size = pgmoneta_space_get(i, SPACE_WORKSPACE);
       }
       else
       {
@@ -163,7 +152,7 @@ pgmoneta_status(SSL* ssl, int client_fd, bool offline, uint8_t compression, uint
 
       if (strlen(config->common.servers[i].hot_standby) > 0)
       {
-         hot_standby_size = pgmoneta_directory_size(config->common.servers[i].hot_standby);
+         hot_standby_size = pgmoneta_space_get(i, SPACE_HOT_STANDBY);
       }
       else
       {
@@ -291,17 +280,10 @@ pgmoneta_status_details(SSL* ssl, int client_fd, bool offline, uint8_t compressi
       goto error;
    }
 
-   d = NULL;
-   d = pgmoneta_append(d, config->base_dir);
-   d = pgmoneta_append(d, "/");
-
-   used_size = pgmoneta_directory_size(d);
+   used_size = pgmoneta_space_used();
 
    pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_USED_SPACE, (uintptr_t)used_size, ValueUInt64);
 
-   free(d);
-   d = NULL;
-
    free_size = pgmoneta_free_space(config->base_dir);
    total_size = pgmoneta_total_space(config->base_dir);
 
@@ -352,15 +334,10 @@ pgmoneta_status_details(SSL* ssl, int client_fd, bool offline, uint8_t compressi
       pgmoneta_json_put(js, MANAGEMENT_ARGUMENT_RETENTION_MONTHS, (uintptr_t)retention_months, ValueInt32);
       pgmoneta_json_put(js, MANAGEMENT_ARGUMENT_RETENTION_YEARS, (uintptr_t)retention_years, ValueInt32);
 
-      d = pgmoneta_get_server(i);
-
-      server_size = pgmoneta_directory_size(d);
+      server_size = pgmoneta_space_server(i);
 
       pgmoneta_json_put(js, MANAGEMENT_ARGUMENT_SERVER_SIZE, (uintptr_t)server_size, ValueUInt64);
 
-      free(d);
-      d = NULL;
-
       if (strlen(config->common.servers[i].workspace) > 0)
       {
          d = pgmoneta_get_server_workspace(i);
@@ -375,7 +352,7 @@ pgmoneta_status_details(SSL* ssl, int client_fd, bool offline, uint8_t compressi
 
       if (strlen(config->common.servers[i].hot_standby) > 0)
       {
-         hot_standby_size = pgmoneta_directory_size(config->common.servers[i].hot_standby);
+         hot_standby_size = pgmoneta_space_get(i, SPACE_HOT_STANDBY);
       }
       else
       {
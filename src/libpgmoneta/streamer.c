@@ -0,0 +1,1745 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* pgmoneta */
+#include <pgmoneta.h>
+#include <aes.h>
+#include <art.h>
+#include <json.h>
+#include <logging.h>
+#include <lz4_compression.h>
+#include <security.h>
+#include <streamer.h>
+#include <utils.h>
+#include <zstandard_compression.h>
+
+/* system */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define STREAMER_CHUNK_SIZE (64 * 1024)
+#define ZSTD_DEFAULT_NUMBER_OF_WORKERS 4
+
+static int streamer_compress(struct streamer* streamer, void* data, size_t size);
+static int streamer_compress_end(struct streamer* streamer);
+static int streamer_encrypt(struct streamer* streamer, void* data, size_t size);
+static int streamer_output(struct streamer* streamer, void* data, size_t size);
+static int lz4_block(struct streamer* streamer);
+static int zstd_stream(struct streamer* streamer, void* data, size_t size, ZSTD_EndDirective mode);
+static int zstd_frame_end(struct streamer* streamer);
+static char* digest_to_hex(unsigned char* md, unsigned int md_len);
+static const EVP_MD* checksum_md(int hash);
+static int reader_start(struct stream_reader* reader);
+static int reader_jump(struct stream_reader* reader, uint32_t frame);
+static int reader_fill(struct stream_reader* reader);
+static size_t reader_take(struct stream_reader* reader, void* data, size_t size);
+static int reader_decode(struct stream_reader* reader);
+
+int
+pgmoneta_streamer_create(int server, char* root, struct streamer** streamer)
+{
+   struct streamer* s = NULL;
+   int ws;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   *streamer = NULL;
+
+   s = (struct streamer*)malloc(sizeof(struct streamer));
+   if (s == NULL)
+   {
+      goto error;
+   }
+
+   memset(s, 0, sizeof(struct streamer));
+
+   snprintf(s->root, sizeof(s->root), "%s", root);
+
+   s->compression = config->compression_type;
+   s->encryption = config->encryption;
+   s->level = config->compression_level;
+
+   s->hash = config->common.servers[server].manifest;
+   if (s->hash == HASH_ALGORITHM_DEFAULT)
+   {
+      s->hash = config->manifest;
+   }
+
+   s->out_size = STREAMER_CHUNK_SIZE;
+   s->out = (unsigned char*)malloc(s->out_size);
+   if (s->out == NULL)
+   {
+      goto error;
+   }
+
+   if (s->compression == COMPRESSION_CLIENT_ZSTD)
+   {
+      if (s->level < 1)
+      {
+         s->level = 1;
+      }
+      else if (s->level > 19)
+      {
+         s->level = 19;
+      }
+
+      ws = config->workers != 0 ? config->workers : ZSTD_DEFAULT_NUMBER_OF_WORKERS;
+
+      s->zstd = ZSTD_createCCtx();
+      if (s->zstd == NULL)
+      {
+         goto error;
+      }
+
+      ZSTD_CCtx_setParameter(s->zstd, ZSTD_c_compressionLevel, s->level);
+      ZSTD_CCtx_setParameter(s->zstd, ZSTD_c_checksumFlag, 1);
+      ZSTD_CCtx_setParameter(s->zstd, ZSTD_c_nbWorkers, ws);
+
+      if (config->compression_frame_size > 0)
+      {
+         s->frame_size = (size_t)config->compression_frame_size;
+         if (pgmoneta_zstd_seek_table_create(&s->seek_table))
+         {
+            goto error;
+         }
+      }
+   }
+   else if (s->compression == COMPRESSION_CLIENT_GZIP)
+   {
+      if (s->level < 1)
+      {
+         s->level = 1;
+      }
+      else if (s->level > 9)
+      {
+         s->level = 9;
+      }
+
+      s->gzip = (z_stream*)malloc(sizeof(z_stream));
+      if (s->gzip == NULL)
+      {
+         goto error;
+      }
+      memset(s->gzip, 0, sizeof(z_stream));
+
+      /* 16 + MAX_WBITS writes a gzip header, as gzopen() does */
+      if (deflateInit2(s->gzip, s->level, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      {
+         free(s->gzip);
+         s->gzip = NULL;
+         goto error;
+      }
+   }
+   else if (s->compression == COMPRESSION_CLIENT_LZ4)
+   {
+      s->lz4 = LZ4_createStream();
+      s->lz4_in = (char*)malloc(2 * BLOCK_BYTES);
+      if (s->lz4 == NULL || s->lz4_in == NULL)
+      {
+         goto error;
+      }
+
+      free(s->out);
+      s->out_size = LZ4_COMPRESSBOUND(BLOCK_BYTES);
+      s->out = (unsigned char*)malloc(s->out_size);
+      if (s->out == NULL)
+      {
+         goto error;
+      }
+   }
+   else if (s->compression == COMPRESSION_CLIENT_BZIP2)
+   {
+      if (s->level < 1)
+      {
+         s->level = 1;
+      }
+      else if (s->level > 9)
+      {
+         s->level = 9;
+      }
+
+      s->bzip2 = (bz_stream*)malloc(sizeof(bz_stream));
+      if (s->bzip2 == NULL)
+      {
+         goto error;
+      }
+      memset(s->bzip2, 0, sizeof(bz_stream));
+   }
+   else
+   {
+      s->compression = COMPRESSION_NONE;
+   }
+
+   if (s->encryption != ENCRYPTION_NONE)
+   {
+      if (pgmoneta_derive_file_key_iv(s->encryption, s->key, s->iv))
+      {
+         goto error;
+      }
+
+      s->cipher = EVP_CIPHER_CTX_new();
+      if (s->cipher == NULL)
+      {
+         goto error;
+      }
+
+      s->enc_size = STREAMER_CHUNK_SIZE + EVP_MAX_BLOCK_LENGTH;
+      s->enc = (unsigned char*)malloc(s->enc_size);
+      if (s->enc == NULL)
+      {
+         goto error;
+      }
+   }
+
+   s->checksum = EVP_MD_CTX_new();
+   s->sha512 = EVP_MD_CTX_new();
+   if (s->checksum == NULL || s->sha512 == NULL)
+   {
+      goto error;
+   }
+
+   if (pgmoneta_art_create(&s->checksums) || pgmoneta_art_create(&s->hashes))
+   {
+      goto error;
+   }
+
+   *streamer = s;
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Streamer: Could not create streamer for %s", root);
+
+   pgmoneta_streamer_destroy(s);
+
+   return 1;
+}
+
+int
+pgmoneta_streamer_open(struct streamer* streamer, char* path, char* manifest_path)
+{
+   if (streamer->file != NULL)
+   {
+      pgmoneta_log_error("Streamer: %s is still open", streamer->path);
+      goto error;
+   }
+
+   streamer->compress = streamer->compression != COMPRESSION_NONE &&
+                        !pgmoneta_ends_with(path, "backup_label") &&
+                        !pgmoneta_ends_with(path, "backup_manifest");
+
+   streamer->encrypt = streamer->encryption != ENCRYPTION_NONE &&
+                       !pgmoneta_ends_with(path, ".partial") &&
+                       !pgmoneta_ends_with(path, ".history") &&
+                       !pgmoneta_ends_with(path, "backup_label") &&
+                       !pgmoneta_ends_with(path, "backup_manifest");
+
+   snprintf(streamer->path, sizeof(streamer->path), "%s%s%s", path,
+            !streamer->compress ? "" :
+            streamer->compression == COMPRESSION_CLIENT_ZSTD ? ".zstd" :
+            streamer->compression == COMPRESSION_CLIENT_GZIP ? ".gz" :
+            streamer->compression == COMPRESSION_CLIENT_LZ4 ? ".lz4" : ".bz2",
+            streamer->encrypt ? ".aes" : "");
+   snprintf(streamer->manifest_path, sizeof(streamer->manifest_path), "%s", manifest_path);
+
+   streamer->file_size = 0;
+   streamer->crc = 0;
+
+   if (streamer->hash != HASH_ALGORITHM_CRC32C)
+   {
+      if (EVP_DigestInit_ex(streamer->checksum, checksum_md(streamer->hash), NULL) != 1)
+      {
+         goto error;
+      }
+   }
+
+   if (EVP_DigestInit_ex(streamer->sha512, EVP_sha512(), NULL) != 1)
+   {
+      goto error;
+   }
+
+   if (streamer->compress)
+   {
+      if (streamer->compression == COMPRESSION_CLIENT_ZSTD)
+      {
+         if (ZSTD_isError(ZSTD_CCtx_reset(streamer->zstd, ZSTD_reset_session_only)))
+         {
+            goto error;
+         }
+
+         streamer->frame_raw = 0;
+         streamer->frame_compressed = 0;
+         if (streamer->seek_table != NULL)
+         {
+            streamer->seek_table->frames = 0;
+         }
+      }
+      else if (streamer->compression == COMPRESSION_CLIENT_GZIP)
+      {
+         if (deflateReset(streamer->gzip) != Z_OK)
+         {
+            goto error;
+         }
+      }
+      else if (streamer->compression == COMPRESSION_CLIENT_LZ4)
+      {
+         LZ4_resetStream_fast(streamer->lz4);
+         streamer->lz4_index = 0;
+         streamer->lz4_length = 0;
+      }
+      else if (streamer->compression == COMPRESSION_CLIENT_BZIP2)
+      {
+         memset(streamer->bzip2, 0, sizeof(bz_stream));
+         if (BZ2_bzCompressInit(streamer->bzip2, streamer->level, 0, 0) != BZ_OK)
+         {
+            goto error;
+         }
+      }
+   }
+
+   if (streamer->encrypt)
+   {
+      if (EVP_CipherInit_ex(streamer->cipher, pgmoneta_get_file_cipher(streamer->encryption), NULL,
+                            streamer->key, streamer->iv, 1) == 0)
+      {
+         pgmoneta_log_error("EVP_CipherInit_ex: failed to initialize context");
+         goto error;
+      }
+   }
+
+   streamer->file = fopen(streamer->path, "wb");
+   if (streamer->file == NULL)
+   {
+      pgmoneta_log_error("Streamer: Could not create %s", streamer->path);
+      goto error;
+   }
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+int
+pgmoneta_streamer_write(struct streamer* streamer, void* data, size_t size)
+{
+   if (streamer->file == NULL)
+   {
+      goto error;
+   }
+
+   if (size == 0)
+   {
+      return 0;
+   }
+
+   if (streamer->hash == HASH_ALGORITHM_CRC32C)
+   {
+      pgmoneta_create_crc32c_buffer(data, size, &streamer->crc);
+   }
+   else if (EVP_DigestUpdate(streamer->checksum, data, size) != 1)
+   {
+      goto error;
+   }
+
+   streamer->file_size += size;
+
+   if (streamer->compress)
+   {
+      return streamer_compress(streamer, data, size);
+   }
+
+   return streamer_encrypt(streamer, data, size);
+
+error:
+
+   return 1;
+}
+
+int
+pgmoneta_streamer_close(struct streamer* streamer)
+{
+   unsigned char md[EVP_MAX_MD_SIZE];
+   unsigned int md_len = 0;
+   char* checksum = NULL;
+   char* sha512 = NULL;
+   char* relative = NULL;
+   int final_length = 0;
+
+   if (streamer->file == NULL)
+   {
+      goto error;
+   }
+
+   if (streamer->compress && streamer_compress_end(streamer))
+   {
+      goto error;
+   }
+
+   if (streamer->encrypt)
+   {
+      if (EVP_CipherFinal_ex(streamer->cipher, streamer->enc, &final_length) == 0)
+      {
+         pgmoneta_log_error("EVP_CipherFinal_ex: failed to process final cipher block");
+         goto error;
+      }
+
+      if (final_length > 0 && streamer_output(streamer, streamer->enc, final_length))
+      {
+         goto error;
+      }
+   }
+
+   if (fflush(streamer->file) != 0)
+   {
+      pgmoneta_log_error("Streamer: Could not write %s", streamer->path);
+      goto error;
+   }
+
+   fclose(streamer->file);
+   streamer->file = NULL;
+
+   if (streamer->hash == HASH_ALGORITHM_CRC32C)
+   {
+      checksum = (char*)malloc(9);
+      if (checksum == NULL)
+      {
+         goto error;
+      }
+      snprintf(checksum, 9, "%08x", streamer->crc);
+   }
+   else
+   {
+      if (EVP_DigestFinal_ex(streamer->checksum, md, &md_len) != 1)
+      {
+         goto error;
+      }
+      checksum = digest_to_hex(md, md_len);
+   }
+
+   if (EVP_DigestFinal_ex(streamer->sha512, md, &md_len) != 1)
+   {
+      goto error;
+   }
+   sha512 = digest_to_hex(md, md_len);
+
+   if (checksum == NULL || sha512 == NULL)
+   {
+      goto error;
+   }
+
+   /* Same form as the relative paths of backup.sha512, like /data/base/1/1234.zstd */
+   relative = streamer->path + strlen(streamer->root);
+   if (pgmoneta_ends_with(streamer->root, "/"))
+   {
+      relative--;
+   }
+
+   if (pgmoneta_art_insert(streamer->checksums, streamer->manifest_path, (uintptr_t)checksum, ValueString) ||
+       pgmoneta_art_insert(streamer->hashes, relative, (uintptr_t)sha512, ValueString))
+   {
+      goto error;
+   }
+
+   streamer->total_size += streamer->file_size;
+   if (streamer->file_size > streamer->biggest_file_size)
+   {
+      streamer->biggest_file_size = streamer->file_size;
+   }
+
+   free(checksum);
+   free(sha512);
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Streamer: Could not finish %s", streamer->path);
+
+   if (streamer->file != NULL)
+   {
+      fclose(streamer->file);
+      streamer->file = NULL;
+   }
+
+   free(checksum);
+   free(sha512);
+
+   return 1;
+}
+
+int
+pgmoneta_streamer_verify(struct streamer* streamer, char* manifest)
+{
+   char* key_path[1] = {"Files"};
+   struct json_reader* reader = NULL;
+   struct json* file = NULL;
+
+   if (pgmoneta_json_reader_init(manifest, &reader))
+   {
+      goto error;
+   }
+
+   if (pgmoneta_json_locate(reader, key_path, 1))
+   {
+      pgmoneta_log_error("cannot locate files array in manifest %s", manifest);
+      goto error;
+   }
+
+   while (pgmoneta_json_next_array_item(reader, &file))
+   {
+      char* path = NULL;
+      char* algorithm = NULL;
+      char* checksum = NULL;
+      char* computed = NULL;
+
+      path = (char*)pgmoneta_json_get(file, "Path");
+      algorithm = (char*)pgmoneta_json_get(file, "Checksum-Algorithm");
+      checksum = (char*)pgmoneta_json_get(file, "Checksum");
+      computed = (char*)pgmoneta_art_search(streamer->checksums, path);
+
+      if (computed == NULL)
+      {
+         pgmoneta_log_error("File missing from the backup stream: %s", path);
+      }
+      else if (algorithm != NULL && pgmoneta_get_hash_algorithm(algorithm) != streamer->hash &&
+               !(streamer->hash == HASH_ALGORITHM_DEFAULT && pgmoneta_get_hash_algorithm(algorithm) == HASH_ALGORITHM_SHA256))
+      {
+         pgmoneta_log_error("Checksum algorithm mismatch, path: %s. Getting %s", path, algorithm);
+      }
+      else if (!pgmoneta_compare_string(computed, checksum))
+      {
+         pgmoneta_log_error("File checksum mismatch, path: %s. Getting %s, should be %s", path, computed, checksum);
+      }
+
+      pgmoneta_json_destroy(file);
+      file = NULL;
+   }
+
+   pgmoneta_json_reader_close(reader);
+   pgmoneta_json_destroy(file);
+
+   return 0;
+
+error:
+
+   pgmoneta_json_reader_close(reader);
+   pgmoneta_json_destroy(file);
+
+   return 1;
+}
+
+void
+pgmoneta_streamer_destroy(struct streamer* streamer)
+{
+   if (streamer == NULL)
+   {
+      return;
+   }
+
+   if (streamer->file != NULL)
+   {
+      fclose(streamer->file);
+      unlink(streamer->path);
+   }
+
+   if (streamer->zstd != NULL)
+   {
+      ZSTD_freeCCtx(streamer->zstd);
+   }
+
+   pgmoneta_zstd_seek_table_destroy(streamer->seek_table);
+
+   if (streamer->gzip != NULL)
+   {
+      deflateEnd(streamer->gzip);
+      free(streamer->gzip);
+   }
+
+   if (streamer->bzip2 != NULL)
+   {
+      BZ2_bzCompressEnd(streamer->bzip2);
+      free(streamer->bzip2);
+   }
+
+   if (streamer->lz4 != NULL)
+   {
+      LZ4_freeStream(streamer->lz4);
+   }
+
+   if (streamer->cipher != NULL)
+   {
+      EVP_CIPHER_CTX_free(streamer->cipher);
+   }
+
+   if (streamer->checksum != NULL)
+   {
+      EVP_MD_CTX_free(streamer->checksum);
+   }
+
+   if (streamer->sha512 != NULL)
+   {
+      EVP_MD_CTX_free(streamer->sha512);
+   }
+
+   pgmoneta_art_destroy(streamer->checksums);
+   pgmoneta_art_destroy(streamer->hashes);
+
+   free(streamer->lz4_in);
+   free(streamer->out);
+   free(streamer->enc);
+   free(streamer);
+}
+
+int
+pgmoneta_stream_reader_create(char* path, struct stream_reader** reader)
+{
+   struct stream_reader* r = NULL;
+   char stored[MAX_PATH];
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   *reader = NULL;
+
+   r = (struct stream_reader*)malloc(sizeof(struct stream_reader));
+   if (r == NULL)
+   {
+      goto error;
+   }
+
+   memset(r, 0, sizeof(struct stream_reader));
+
+   snprintf(r->path, sizeof(r->path), "%s", path);
+   snprintf(stored, sizeof(stored), "%s", path);
+
+   if (pgmoneta_is_encrypted(stored))
+   {
+      r->encryption = config->encryption;
+      stored[strlen(stored) - strlen(".aes")] = '\0';
+   }
+
+   if (pgmoneta_ends_with(stored, ".zstd"))
+   {
+      r->compression = COMPRESSION_CLIENT_ZSTD;
+   }
+   else if (pgmoneta_ends_with(stored, ".gz"))
+   {
+      r->compression = COMPRESSION_CLIENT_GZIP;
+   }
+   else if (pgmoneta_ends_with(stored, ".lz4"))
+   {
+      r->compression = COMPRESSION_CLIENT_LZ4;
+   }
+   else if (pgmoneta_ends_with(stored, ".bz2"))
+   {
+      r->compression = COMPRESSION_CLIENT_BZIP2;
+   }
+   else
+   {
+      r->compression = COMPRESSION_NONE;
+   }
+
+   r->dec_size = STREAMER_CHUNK_SIZE + EVP_MAX_BLOCK_LENGTH;
+   r->dec = (unsigned char*)malloc(r->dec_size);
+   r->out = (unsigned char*)malloc(STREAMER_CHUNK_SIZE);
+   if (r->dec == NULL || r->out == NULL)
+   {
+      goto error;
+   }
+
+   if (r->compression == COMPRESSION_CLIENT_ZSTD)
+   {
+      r->zstd = ZSTD_createDCtx();
+      if (r->zstd == NULL)
+      {
+         goto error;
+      }
+   }
+   else if (r->compression == COMPRESSION_CLIENT_GZIP)
+   {
+      r->gzip = (z_stream*)malloc(sizeof(z_stream));
+      if (r->gzip == NULL)
+      {
+         goto error;
+      }
+      memset(r->gzip, 0, sizeof(z_stream));
+
+      /* 16 + MAX_WBITS expects a gzip header, as gzopen() writes */
+      if (inflateInit2(r->gzip, 16 + MAX_WBITS) != Z_OK)
+      {
+         free(r->gzip);
+         r->gzip = NULL;
+         goto error;
+      }
+   }
+   else if (r->compression == COMPRESSION_CLIENT_LZ4)
+   {
+      r->lz4 = LZ4_createStreamDecode();
+      r->lz4_in = (char*)malloc(LZ4_COMPRESSBOUND(BLOCK_BYTES));
+      r->lz4_out = (char*)malloc(2 * BLOCK_BYTES);
+      if (r->lz4 == NULL || r->lz4_in == NULL || r->lz4_out == NULL)
+      {
+         goto error;
+      }
+   }
+   else if (r->compression == COMPRESSION_CLIENT_BZIP2)
+   {
+      r->bzip2 = (bz_stream*)malloc(sizeof(bz_stream));
+      if (r->bzip2 == NULL)
+      {
+         goto error;
+      }
+      memset(r->bzip2, 0, sizeof(bz_stream));
+
+      if (BZ2_bzDecompressInit(r->bzip2, 0, 0) != BZ_OK)
+      {
+         free(r->bzip2);
+         r->bzip2 = NULL;
+         goto error;
+      }
+   }
+
+   if (r->encryption != ENCRYPTION_NONE)
+   {
+      if (pgmoneta_derive_file_key_iv(r->encryption, r->key, r->iv))
+      {
+         goto error;
+      }
+
+      r->cipher = EVP_CIPHER_CTX_new();
+      r->in = (unsigned char*)malloc(STREAMER_CHUNK_SIZE);
+      if (r->cipher == NULL || r->in == NULL)
+      {
+         goto error;
+      }
+   }
+
+   r->file = fopen(r->path, "rb");
+   if (r->file == NULL)
+   {
+      goto error;
+   }
+
+   // the frames of a seekable file can be decoded on their own, which needs the plain file
+   if (r->compression == COMPRESSION_CLIENT_ZSTD && r->encryption == ENCRYPTION_NONE)
+   {
+      pgmoneta_zstd_seek_table_read(r->file, &r->seek_table);
+   }
+
+   if (reader_start(r))
+   {
+      goto error;
+   }
+
+   *reader = r;
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Stream reader: Could not open %s", path);
+
+   pgmoneta_stream_reader_destroy(r);
+
+   return 1;
+}
+
+int
+pgmoneta_stream_reader_read(struct stream_reader* reader, void* buffer, size_t size, size_t* length)
+{
+   unsigned char* b = (unsigned char*)buffer;
+   size_t total = 0;
+   size_t n = 0;
+
+   *length = 0;
+
+   while (total < size)
+   {
+      if (reader->raw_pos == reader->raw_length)
+      {
+         if (reader->end)
+         {
+            break;
+         }
+
+         if (reader_decode(reader))
+         {
+            goto error;
+         }
+
+         continue;
+      }
+
+      n = MIN(size - total, reader->raw_length - reader->raw_pos);
+      memcpy(b + total, reader->raw + reader->raw_pos, n);
+      reader->raw_pos += n;
+      reader->position += n;
+      total += n;
+   }
+
+   *length = total;
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+int
+pgmoneta_stream_reader_seek(struct stream_reader* reader, uint64_t offset)
+{
+   size_t n = 0;
+   uint32_t frame = 0;
+
+   if (reader->seek_table != NULL && reader->seek_table->frames > 0)
+   {
+      frame = pgmoneta_zstd_seek_table_find(reader->seek_table, offset);
+      if (frame == reader->seek_table->frames)
+      {
+         frame--;
+      }
+
+      if (offset < reader->position || reader->seek_table->raw[frame] > reader->position)
+      {
+         if (reader_jump(reader, frame))
+         {
+            goto error;
+         }
+      }
+   }
+   else if (offset < reader->position)
+   {
+      if (reader_start(reader))
+      {
+         goto error;
+      }
+   }
+
+   while (reader->position < offset)
+   {
+      if (reader->raw_pos == reader->raw_length)
+      {
+         if (reader->end)
+         {
+            break;
+         }
+
+         if (reader_decode(reader))
+         {
+            goto error;
+         }
+
+         continue;
+      }
+
+      n = MIN(offset - reader->position, reader->raw_length - reader->raw_pos);
+      reader->raw_pos += n;
+      reader->position += n;
+   }
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+int
+pgmoneta_stream_reader_checksum(struct stream_reader* reader, int hash, char** checksum)
+{
+   EVP_MD_CTX* ctx = NULL;
+   unsigned char md[EVP_MAX_MD_SIZE];
+   unsigned int md_len = 0;
+   uint32_t crc = 0;
+   size_t n = 0;
+
+   *checksum = NULL;
+
+   if (hash != HASH_ALGORITHM_CRC32C)
+   {
+      ctx = EVP_MD_CTX_new();
+      if (ctx == NULL || EVP_DigestInit_ex(ctx, checksum_md(hash), NULL) != 1)
+      {
+         goto error;
+      }
+   }
+
+   while (true)
+   {
+      if (reader->raw_pos == reader->raw_length)
+      {
+         if (reader->end)
+         {
+            break;
+         }
+
+         if (reader_decode(reader))
+         {
+            goto error;
+         }
+
+         continue;
+      }
+
+      /* The decoded content is hashed where it is, without copying it out */
+      n = reader->raw_length - reader->raw_pos;
+      if (hash == HASH_ALGORITHM_CRC32C)
+      {
+         pgmoneta_create_crc32c_buffer(reader->raw + reader->raw_pos, n, &crc);
+      }
+      else if (EVP_DigestUpdate(ctx, reader->raw + reader->raw_pos, n) != 1)
+      {
+         goto error;
+      }
+      reader->raw_pos += n;
+      reader->position += n;
+   }
+
+   if (hash == HASH_ALGORITHM_CRC32C)
+   {
+      *checksum = (char*)malloc(9);
+      if (*checksum == NULL)
+      {
+         goto error;
+      }
+      snprintf(*checksum, 9, "%08x", crc);
+   }
+   else
+   {
+      if (EVP_DigestFinal_ex(ctx, md, &md_len) != 1)
+      {
+         goto error;
+      }
+      *checksum = digest_to_hex(md, md_len);
+      if (*checksum == NULL)
+      {
+         goto error;
+      }
+   }
+
+   EVP_MD_CTX_free(ctx);
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Stream reader: Could not calculate the checksum of %s", reader->path);
+
+   EVP_MD_CTX_free(ctx);
+
+   return 1;
+}
+
+void
+pgmoneta_stream_reader_destroy(struct stream_reader* reader)
+{
+   if (reader == NULL)
+   {
+      return;
+   }
+
+   if (reader->file != NULL)
+   {
+      fclose(reader->file);
+   }
+
+   if (reader->zstd != NULL)
+   {
+      ZSTD_freeDCtx(reader->zstd);
+   }
+
+   pgmoneta_zstd_seek_table_destroy(reader->seek_table);
+
+   if (reader->gzip != NULL)
+   {
+      inflateEnd(reader->gzip);
+      free(reader->gzip);
+   }
+
+   if (reader->bzip2 != NULL)
+   {
+      BZ2_bzDecompressEnd(reader->bzip2);
+      free(reader->bzip2);
+   }
+
+   if (reader->lz4 != NULL)
+   {
+      LZ4_freeStreamDecode(reader->lz4);
+   }
+
+   if (reader->cipher != NULL)
+   {
+      EVP_CIPHER_CTX_free(reader->cipher);
+   }
+
+   free(reader->lz4_in);
+   free(reader->lz4_out);
+   free(reader->in);
+   free(reader->dec);
+   free(reader->out);
+   free(reader);
+}
+
+static int
+streamer_compress(struct streamer* streamer, void* data, size_t size)
+{
+   if (streamer->compression == COMPRESSION_CLIENT_ZSTD)
+   {
+      unsigned char* d = (unsigned char*)data;
+
+      while (size > 0)
+      {
+         size_t length = size;
+
+         if (streamer->seek_table != NULL)
+         {
+            length = MIN(size, streamer->frame_size - streamer->frame_raw);
+         }
+
+         if (zstd_stream(streamer, d, length, ZSTD_e_continue))
+         {
+            goto error;
+         }
+
+         streamer->frame_raw += length;
+         d += length;
+         size -= length;
+
+         if (streamer->seek_table != NULL && streamer->frame_raw == streamer->frame_size && zstd_frame_end(streamer))
+         {
+            goto error;
+         }
+      }
+   }
+   else if (streamer->compression == COMPRESSION_CLIENT_GZIP)
+   {
+      streamer->gzip->next_in = (Bytef*)data;
+      streamer->gzip->avail_in = (uInt)size;
+
+      do
+      {
+         streamer->gzip->next_out = streamer->out;
+         streamer->gzip->avail_out = (uInt)streamer->out_size;
+
+         if (deflate(streamer->gzip, Z_NO_FLUSH) == Z_STREAM_ERROR)
+         {
+            goto error;
+         }
+
+         if (streamer_encrypt(streamer, streamer->out, streamer->out_size - streamer->gzip->avail_out))
+         {
+            goto error;
+         }
+      }
+      while (streamer->gzip->avail_out == 0);
+   }
+   else if (streamer->compression == COMPRESSION_CLIENT_LZ4)
+   {
+      char* d = (char*)data;
+
+      while (size > 0)
+      {
+         size_t length = MIN(size, (size_t)BLOCK_BYTES - streamer->lz4_length);
+
+         memcpy(streamer->lz4_in + (streamer->lz4_index * BLOCK_BYTES) + streamer->lz4_length, d, length);
+         streamer->lz4_length += length;
+         d += length;
+         size -= length;
+
+         if (streamer->lz4_length == BLOCK_BYTES && lz4_block(streamer))
+         {
+            goto error;
+         }
+      }
+   }
+   else if (streamer->compression == COMPRESSION_CLIENT_BZIP2)
+   {
+      streamer->bzip2->next_in = (char*)data;
+      streamer->bzip2->avail_in = (unsigned int)size;
+
+      while (streamer->bzip2->avail_in > 0)
+      {
+         streamer->bzip2->next_out = (char*)streamer->out;
+         streamer->bzip2->avail_out = (unsigned int)streamer->out_size;
+
+         if (BZ2_bzCompress(streamer->bzip2, BZ_RUN) != BZ_RUN_OK)
+         {
+            goto error;
+         }
+
+         if (streamer_encrypt(streamer, streamer->out, streamer->out_size - streamer->bzip2->avail_out))
+         {
+            goto error;
+         }
+      }
+   }
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Streamer: Could not compress %s", streamer->path);
+
+   return 1;
+}
+
+static int
+streamer_compress_end(struct streamer* streamer)
+{
+   if (streamer->compression == COMPRESSION_CLIENT_ZSTD)
+   {
+      // unless the last frame ended exactly at the end of the file
+      if ((streamer->seek_table == NULL || streamer->seek_table->frames == 0 || streamer->frame_raw > 0) &&
+          zstd_frame_end(streamer))
+      {
+         goto error;
+      }
+
+      if (streamer->seek_table != NULL)
+      {
+         unsigned char* seek_table = NULL;
+         size_t seek_table_size = 0;
+
+         if (pgmoneta_zstd_seek_table_serialize(streamer->seek_table, &seek_table, &seek_table_size))
+         {
+            goto error;
+         }
+
+         if (streamer_encrypt(streamer, seek_table, seek_table_size))
+         {
+            free(seek_table);
+            goto error;
+         }
+
+         free(seek_table);
+      }
+   }
+   else if (streamer->compression == COMPRESSION_CLIENT_GZIP)
+   {
+      int ret;
+
+      streamer->gzip->next_in = NULL;
+      streamer->gzip->avail_in = 0;
+
+      do
+      {
+         streamer->gzip->next_out = streamer->out;
+         streamer->gzip->avail_out = (uInt)streamer->out_size;
+
+         ret = deflate(streamer->gzip, Z_FINISH);
+         if (ret == Z_STREAM_ERROR)
+         {
+            goto error;
+         }
+
+         if (streamer_encrypt(streamer, streamer->out, streamer->out_size - streamer->gzip->avail_out))
+         {
+            goto error;
+         }
+      }
+      while (ret != Z_STREAM_END);
+   }
+   else if (streamer->compression == COMPRESSION_CLIENT_LZ4)
+   {
+      if (streamer->lz4_length > 0 && lz4_block(streamer))
+      {
+         goto error;
+      }
+   }
+   else if (streamer->compression == COMPRESSION_CLIENT_BZIP2)
+   {
+      int ret;
+
+      streamer->bzip2->next_in = NULL;
+      streamer->bzip2->avail_in = 0;
+
+      do
+      {
+         streamer->bzip2->next_out = (char*)streamer->out;
+         streamer->bzip2->avail_out = (unsigned int)streamer->out_size;
+
+         ret = BZ2_bzCompress(streamer->bzip2, BZ_FINISH);
+         if (ret != BZ_FINISH_OK && ret != BZ_STREAM_END)
+         {
+            goto error;
+         }
+
+         if (streamer_encrypt(streamer, streamer->out, streamer->out_size - streamer->bzip2->avail_out))
+         {
+            goto error;
+         }
+      }
+      while (ret != BZ_STREAM_END);
+
+      BZ2_bzCompressEnd(streamer->bzip2);
+   }
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Streamer: Could not compress %s", streamer->path);
+
+   return 1;
+}
+
+static int
+zstd_stream(struct streamer* streamer, void* data, size_t size, ZSTD_EndDirective mode)
+{
+   ZSTD_inBuffer in = {data, size, 0};
+   size_t remaining = 0;
+
+   do
+   {
+      ZSTD_outBuffer out = {streamer->out, streamer->out_size, 0};
+
+      remaining = ZSTD_compressStream2(streamer->zstd, &out, &in, mode);
+      if (ZSTD_isError(remaining))
+      {
+         pgmoneta_log_error("ZSTD_compressStream2: %s", ZSTD_getErrorName(remaining));
+         return 1;
+      }
+
+      if (streamer_encrypt(streamer, streamer->out, out.pos))
+      {
+         return 1;
+      }
+
+      streamer->frame_compressed += out.pos;
+   }
+   while (mode == ZSTD_e_end ? remaining != 0 : in.pos < in.size);
+
+   return 0;
+}
+
+/* Ends the current frame, and lists it in the seek table of a seekable file */
+static int
+zstd_frame_end(struct streamer* streamer)
+{
+   if (zstd_stream(streamer, NULL, 0, ZSTD_e_end))
+   {
+      return 1;
+   }
+
+   if (streamer->seek_table != NULL && streamer->frame_compressed > 0)
+   {
+      if (pgmoneta_zstd_seek_table_add(streamer->seek_table, (uint32_t)streamer->frame_compressed, (uint32_t)streamer->frame_raw))
+      {
+         return 1;
+      }
+   }
+
+   streamer->frame_raw = 0;
+   streamer->frame_compressed = 0;
+
+   return 0;
+}
+
+/* Same block layout as lz4_compress(): the compressed length followed by the block */
+static int
+lz4_block(struct streamer* streamer)
+{
+   char* block = streamer->lz4_in + (streamer->lz4_index * BLOCK_BYTES);
+   int compressed;
+
+   compressed = LZ4_compress_fast_continue(streamer->lz4, block, (char*)streamer->out,
+                                           (int)streamer->lz4_length, (int)streamer->out_size, 1);
+   if (compressed <= 0)
+   {
+      return 1;
+   }
+
+   if (streamer_encrypt(streamer, &compressed, sizeof(compressed)) ||
+       streamer_encrypt(streamer, streamer->out, (size_t)compressed))
+   {
+      return 1;
+   }
+
+   streamer->lz4_index = (streamer->lz4_index + 1) % 2;
+   streamer->lz4_length = 0;
+
+   return 0;
+}
+
+static int
+streamer_encrypt(struct streamer* streamer, void* data, size_t size)
+{
+   unsigned char* d = (unsigned char*)data;
+   int outl = 0;
+
+   if (!streamer->encrypt)
+   {
+      return streamer_output(streamer, data, size);
+   }
+
+   while (size > 0)
+   {
+      size_t length = MIN(size, (size_t)STREAMER_CHUNK_SIZE);
+
+      if (EVP_CipherUpdate(streamer->cipher, streamer->enc, &outl, d, (int)length) == 0)
+      {
+         pgmoneta_log_error("EVP_CipherUpdate: failed to process block");
+         return 1;
+      }
+
+      if (streamer_output(streamer, streamer->enc, (size_t)outl))
+      {
+         return 1;
+      }
+
+      d += length;
+      size -= length;
+   }
+
+   return 0;
+}
+
+static int
+streamer_output(struct streamer* streamer, void* data, size_t size)
+{
+   if (size == 0)
+   {
+      return 0;
+   }
+
+   if (EVP_DigestUpdate(streamer->sha512, data, size) != 1)
+   {
+      return 1;
+   }
+
+   if (fwrite(data, 1, size, streamer->file) != size)
+   {
+      pgmoneta_log_error("Streamer: Could not write %s", streamer->path);
+      return 1;
+   }
+
+   return 0;
+}
+
+static char*
+digest_to_hex(unsigned char* md, unsigned int md_len)
+{
+   char* hex = NULL;
+
+   hex = (char*)malloc((md_len * 2) + 1);
+   if (hex == NULL)
+   {
+      return NULL;
+   }
+
+   for (unsigned int i = 0; i < md_len; i++)
+   {
+      sprintf(hex + (i * 2), "%02x", md[i]);
+   }
+   hex[md_len * 2] = '\0';
+
+   return hex;
+}
+
+static const EVP_MD*
+checksum_md(int hash)
+{
+   switch (hash)
+   {
+      case HASH_ALGORITHM_SHA224:
+         return EVP_sha224();
+      case HASH_ALGORITHM_SHA384:
+         return EVP_sha384();
+      case HASH_ALGORITHM_SHA512:
+         return EVP_sha512();
+      default:
+         return EVP_sha256();
+   }
+}
+
+static int
+reader_start(struct stream_reader* reader)
+{
+   if (fseeko(reader->file, 0, SEEK_SET))
+   {
+      goto error;
+   }
+
+   if (reader->zstd != NULL)
+   {
+      ZSTD_DCtx_reset(reader->zstd, ZSTD_reset_session_only);
+   }
+
+   if (reader->gzip != NULL && inflateReset(reader->gzip) != Z_OK)
+   {
+      goto error;
+   }
+
+   if (reader->bzip2 != NULL)
+   {
+      BZ2_bzDecompressEnd(reader->bzip2);
+      memset(reader->bzip2, 0, sizeof(bz_stream));
+      if (BZ2_bzDecompressInit(reader->bzip2, 0, 0) != BZ_OK)
+      {
+         goto error;
+      }
+   }
+
+   if (reader->lz4 != NULL)
+   {
+      LZ4_setStreamDecode(reader->lz4, NULL, 0);
+      reader->lz4_index = 0;
+   }
+
+   if (reader->cipher != NULL)
+   {
+      if (EVP_CipherInit_ex(reader->cipher, pgmoneta_get_file_cipher(reader->encryption), NULL,
+                            reader->key, reader->iv, 0) == 0)
+      {
+         pgmoneta_log_error("EVP_CipherInit_ex: failed to initialize context");
+         goto error;
+      }
+   }
+
+   reader->position = 0;
+   reader->eof = false;
+   reader->end = false;
+   reader->complete = true;
+   reader->dec_pos = 0;
+   reader->dec_length = 0;
+   reader->raw = reader->out;
+   reader->raw_pos = 0;
+   reader->raw_length = 0;
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Stream reader: Could not restart %s", reader->path);
+
+   return 1;
+}
+
+static int
+reader_jump(struct stream_reader* reader, uint32_t frame)
+{
+   if (fseeko(reader->file, (off_t)reader->seek_table->compressed[frame], SEEK_SET))
+   {
+      goto error;
+   }
+
+   ZSTD_DCtx_reset(reader->zstd, ZSTD_reset_session_only);
+
+   reader->position = reader->seek_table->raw[frame];
+   reader->eof = false;
+   reader->end = false;
+   reader->complete = true;
+   reader->dec_pos = 0;
+   reader->dec_length = 0;
+   reader->raw = reader->out;
+   reader->raw_pos = 0;
+   reader->raw_length = 0;
+
+   return 0;
+
+error:
+
+   pgmoneta_log_error("Stream reader: Could not move to frame %u of %s", frame, reader->path);
+
+   return 1;
+}
+
+static int
+reader_fill(struct stream_reader* reader)
+{
+   size_t n = 0;
+   int outl = 0;
+
+   reader->dec_pos = 0;
+   reader->dec_length = 0;
+
+   while (reader->dec_length == 0 && !reader->eof)
+   {
+      if (reader->cipher == NULL)
+      {
+         n = fread(reader->dec, 1, STREAMER_CHUNK_SIZE, reader->file);
+         reader->dec_length = n;
+      }
+      else
+      {
+         n = fread(reader->in, 1, STREAMER_CHUNK_SIZE, reader->file);
+         if (n > 0)
+         {
+            if (EVP_CipherUpdate(reader->cipher, reader->dec, &outl, reader->in, n) == 0)
+            {
+               pgmoneta_log_error("EVP_CipherUpdate: failed to process block");
+               goto error;
+            }
+            reader->dec_length = outl;
+         }
+      }
+
+      if (n == 0)
+      {
+         if (ferror(reader->file))
+         {
+            pgmoneta_log_error("Stream reader: Could not read %s", reader->path);
+            goto error;
+         }
+
+         reader->eof = true;
+
+         if (reader->cipher != NULL)
+         {
+            if (EVP_CipherFinal_ex(reader->cipher, reader->dec, &outl) == 0)
+            {
+               pgmoneta_log_error("EVP_CipherFinal_ex: failed to process final cipher block");
+               goto error;
+            }
+            reader->dec_length = outl;
+         }
+      }
+   }
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+static size_t
+reader_take(struct stream_reader* reader, void* data, size_t size)
+{
+   unsigned char* d = (unsigned char*)data;
+   size_t total = 0;
+   size_t n = 0;
+
+   while (total < size)
+   {
+      if (reader->dec_pos == reader->dec_length)
+      {
+         if (reader->eof || reader_fill(reader) || reader->dec_length == 0)
+         {
+            break;
+         }
+      }
+
+      n = MIN(size - total, reader->dec_length - reader->dec_pos);
+      memcpy(d + total, reader->dec + reader->dec_pos, n);
+      reader->dec_pos += n;
+      total += n;
+   }
+
+   return total;
+}
+
+static int
+reader_decode(struct stream_reader* reader)
+{
+   reader->raw = reader->out;
+   reader->raw_pos = 0;
+   reader->raw_length = 0;
+
+   if (reader->compression == COMPRESSION_CLIENT_LZ4)
+   {
+      int compressed = 0;
+      int decompressed = 0;
+      size_t n = 0;
+
+      n = reader_take(reader, &compressed, sizeof(compressed));
+      if (n == 0)
+      {
+         reader->end = true;
+         return 0;
+      }
+
+      if (n != sizeof(compressed) || compressed <= 0 || compressed > LZ4_COMPRESSBOUND(BLOCK_BYTES) ||
+          reader_take(reader, reader->lz4_in, compressed) != (size_t)compressed)
+      {
+         goto truncated;
+      }
+
+      /* The previous block stays in place, since it is the dictionary of the next one */
+      reader->raw = (unsigned char*)reader->lz4_out + (reader->lz4_index * BLOCK_BYTES);
+      decompressed = LZ4_decompress_safe_continue(reader->lz4, reader->lz4_in, (char*)reader->raw, compressed, BLOCK_BYTES);
+      if (decompressed <= 0)
+      {
+         pgmoneta_log_error("LZ4_decompress_safe_continue: corrupt block in %s", reader->path);
+         goto error;
+      }
+
+      reader->raw_length = decompressed;
+      reader->lz4_index = (reader->lz4_index + 1) % 2;
+
+      return 0;
+   }
+
+   while (reader->raw_length == 0)
+   {
+      if (reader->dec_pos == reader->dec_length && !reader->eof)
+      {
+         if (reader_fill(reader))
+         {
+            goto error;
+         }
+      }
+
+      if (reader->compression == COMPRESSION_NONE)
+      {
+         if (reader->dec_pos == reader->dec_length)
+         {
+            reader->end = true;
+            return 0;
+         }
+
+         reader->raw = reader->dec;
+         reader->raw_length = reader->dec_length;
+         reader->dec_pos = reader->dec_length;
+      }
+      else if (reader->compression == COMPRESSION_CLIENT_ZSTD)
+      {
+         ZSTD_inBuffer in = {reader->dec + reader->dec_pos, reader->dec_length - reader->dec_pos, 0};
+         ZSTD_outBuffer out = {reader->out, STREAMER_CHUNK_SIZE, 0};
+         size_t ret = 0;
+
+         if (in.size == 0 && reader->eof && reader->complete)
+         {
+            reader->end = true;
+            return 0;
+         }
+
+         ret = ZSTD_decompressStream(reader->zstd, &out, &in);
+         if (ZSTD_isError(ret))
+         {
+            pgmoneta_log_error("ZSTD_decompressStream: %s in %s", ZSTD_getErrorName(ret), reader->path);
+            goto error;
+         }
+
+         reader->dec_pos += in.pos;
+         reader->raw_length = out.pos;
+         reader->complete = ret == 0;
+
+         if (out.pos == 0 && in.pos == in.size && reader->eof && !reader->complete)
+         {
+            goto truncated;
+         }
+      }
+      else if (reader->compression == COMPRESSION_CLIENT_GZIP)
+      {
+         int ret = 0;
+
+         if (reader->dec_pos == reader->dec_length && reader->eof && reader->complete)
+         {
+            reader->end = true;
+            return 0;
+         }
+
+         reader->gzip->next_in = reader->dec + reader->dec_pos;
+         reader->gzip->avail_in = reader->dec_length - reader->dec_pos;
+         reader->gzip->next_out = reader->out;
+         reader->gzip->avail_out = STREAMER_CHUNK_SIZE;
+
+         ret = inflate(reader->gzip, Z_NO_FLUSH);
+         if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+         {
+            pgmoneta_log_error("inflate: %s in %s", reader->gzip->msg != NULL ? reader->gzip->msg : "error", reader->path);
+            goto error;
+         }
+
+         reader->dec_pos = reader->dec_length - reader->gzip->avail_in;
+         reader->raw_length = STREAMER_CHUNK_SIZE - reader->gzip->avail_out;
+         reader->complete = ret == Z_STREAM_END;
+
+         if (ret == Z_STREAM_END)
+         {
+            /* Another gzip member may follow, as gzread() allows */
+            if (inflateReset(reader->gzip) != Z_OK)
+            {
+               goto error;
+            }
+         }
+         else if (reader->raw_length == 0 && reader->dec_pos == reader->dec_length && reader->eof)
+         {
+            goto truncated;
+         }
+      }
+      else if (reader->compression == COMPRESSION_CLIENT_BZIP2)
+      {
+         int ret = 0;
+
+         if (reader->dec_pos == reader->dec_length && reader->eof && reader->complete)
+         {
+            reader->end = true;
+            return 0;
+         }
+
+         reader->bzip2->next_in = (char*)reader->dec + reader->dec_pos;
+         reader->bzip2->avail_in = reader->dec_length - reader->dec_pos;
+         reader->bzip2->next_out = (char*)reader->out;
+         reader->bzip2->avail_out = STREAMER_CHUNK_SIZE;
+
+         ret = BZ2_bzDecompress(reader->bzip2);
+         if (ret != BZ_OK && ret != BZ_STREAM_END)
+         {
+            pgmoneta_log_error("BZ2_bzDecompress: error %d in %s", ret, reader->path);
+            goto error;
+         }
+
+         reader->dec_pos = reader->dec_length - reader->bzip2->avail_in;
+         reader->raw_length = STREAMER_CHUNK_SIZE - reader->bzip2->avail_out;
+         reader->complete = ret == BZ_STREAM_END;
+
+         if (ret == BZ_STREAM_END)
+         {
+            BZ2_bzDecompressEnd(reader->bzip2);
+            memset(reader->bzip2, 0, sizeof(bz_stream));
+            if (BZ2_bzDecompressInit(reader->bzip2, 0, 0) != BZ_OK)
+            {
+               goto error;
+            }
+         }
+         else if (reader->raw_length == 0 && reader->dec_pos == reader->dec_length && reader->eof)
+         {
+            goto truncated;
+         }
+      }
+   }
+
+   return 0;
+
+truncated:
+
+   pgmoneta_log_error("Stream reader: %s is truncated", reader->path);
+
+error:
+
+   return 1;
+}
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* pgmoneta */
+#include <pgmoneta.h>
+#include <string_builder.h>
+
+/* system */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRING_BUILDER_DEFAULT_CAPACITY 256
+
+static int ensure_capacity(struct string_builder* sb, size_t length);
+
+int
+pgmoneta_string_builder_create(size_t capacity, struct string_builder** sb)
+{
+   struct string_builder* s = NULL;
+
+   *sb = NULL;
+
+   s = (struct string_builder*)malloc(sizeof(struct string_builder));
+   if (s == NULL)
+   {
+      goto error;
+   }
+
+   memset(s, 0, sizeof(struct string_builder));
+
+   s->capacity = capacity > 0 ? capacity : STRING_BUILDER_DEFAULT_CAPACITY;
+   s->data = (char*)malloc(s->capacity);
+   if (s->data == NULL)
+   {
+      goto error;
+   }
+
+   s->data[0] = '\0';
+
+   *sb = s;
+
+   return 0;
+
+error:
+
+   free(s);
+
+   return 1;
+}
+
+int
+pgmoneta_string_builder_append(struct string_builder* sb, char* s)
+{
+   if (s == NULL)
+   {
+      return 0;
+   }
+
+   return pgmoneta_string_builder_append_length(sb, s, strlen(s));
+}
+
+int
+pgmoneta_string_builder_append_length(struct string_builder* sb, char* s, size_t length)
+{
+   if (ensure_capacity(sb, length))
+   {
+      return 1;
+   }
+
+   memcpy(sb->data + sb->length, s, length);
+   sb->length += length;
+   sb->data[sb->length] = '\0';
+
+   return 0;
+}
+
+int
+pgmoneta_string_builder_append_char(struct string_builder* sb, char c)
+{
+   if (ensure_capacity(sb, 1))
+   {
+      return 1;
+   }
+
+   sb->data[sb->length++] = c;
+   sb->data[sb->length] = '\0';
+
+   return 0;
+}
+
+int
+pgmoneta_string_builder_append_int(struct string_builder* sb, int i)
+{
+   char number[12];
+
+   memset(&number[0], 0, sizeof(number));
+   snprintf(&number[0], sizeof(number), "%d", i);
+
+   return pgmoneta_string_builder_append(sb, number);
+}
+
+int
+pgmoneta_string_builder_append_ulong(struct string_builder* sb, unsigned long l)
+{
+   char number[21];
+
+   memset(&number[0], 0, sizeof(number));
+   snprintf(&number[0], sizeof(number), "%lu", l);
+
+   return pgmoneta_string_builder_append(sb, number);
+}
+
+int
+pgmoneta_string_builder_append_double(struct string_builder* sb, double d)
+{
+   return pgmoneta_string_builder_append_format(sb, "%lf", d);
+}
+
+int
+pgmoneta_string_builder_append_double_precision(struct string_builder* sb, double d, int precision)
+{
+   return pgmoneta_string_builder_append_format(sb, "%.*f", precision, d);
+}
+
+int
+pgmoneta_string_builder_append_bool(struct string_builder* sb, bool b)
+{
+   return pgmoneta_string_builder_append(sb, b ? "1" : "0");
+}
+
+int
+pgmoneta_string_builder_append_format(struct string_builder* sb, char* format, ...)
+{
+   va_list args;
+   int size;
+
+   va_start(args, format);
+   size = vsnprintf(NULL, 0, format, args);
+   va_end(args);
+
+   if (size < 0)
+   {
+      sb->error = true;
+      return 1;
+   }
+
+   if (ensure_capacity(sb, (size_t)size))
+   {
+      return 1;
+   }
+
+   // Formatted straight into the free space of the builder
+   va_start(args, format);
+   vsnprintf(sb->data + sb->length, sb->capacity - sb->length, format, args);
+   va_end(args);
+
+   sb->length += (size_t)size;
+
+   return 0;
+}
+
+int
+pgmoneta_string_builder_indent(struct string_builder* sb, char* tag, int indent)
+{
+   if (indent > 0)
+   {
+      if (ensure_capacity(sb, (size_t)indent))
+      {
+         return 1;
+      }
+
+      memset(sb->data + sb->length, ' ', (size_t)indent);
+      sb->length += (size_t)indent;
+      sb->data[sb->length] = '\0';
+   }
+
+   return pgmoneta_string_builder_append(sb, tag);
+}
+
+void
+pgmoneta_string_builder_reset(struct string_builder* sb)
+{
+   sb->length = 0;
+   sb->data[0] = '\0';
+}
+
+char*
+pgmoneta_string_builder_finish(struct string_builder* sb)
+{
+   char* data = NULL;
+
+   if (sb == NULL)
+   {
+      return NULL;
+   }
+
+   data = sb->data;
+   if (sb->error)
+   {
+      free(data);
+      data = NULL;
+   }
+   free(sb);
+
+   return data;
+}
+
+void
+pgmoneta_string_builder_destroy(struct string_builder* sb)
+{
+   if (sb == NULL)
+   {
+      return;
+   }
+
+   free(sb->data);
+   free(sb);
+}
+
+static int
+ensure_capacity(struct string_builder* sb, size_t length)
+{
+   size_t capacity;
+   char* data = NULL;
+
+   if (sb->error)
+   {
+      return 1;
+   }
+
+   if (sb->length + length + 1 <= sb->capacity)
+   {
+      return 0;
+   }
+
+   if (length > SIZE_MAX / 2 - sb->length - 1)
+   {
+      sb->error = true;
+      return 1;
+   }
+
+   capacity = sb->capacity;
+   while (capacity < sb->length + length + 1)
+   {
+      capacity *= 2;
+   }
+
+   data = (char*)realloc(sb->data, capacity);
+   if (data == NULL)
+   {
+      sb->error = true;
+      return 1;
+   }
+
+   sb->data = data;
+   sb->capacity = capacity;
+
+   return 0;
+}
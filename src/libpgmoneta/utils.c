@@ -29,6 +29,7 @@
 /* pgmoneta */
 #include <pgmoneta.h>
 #include <logging.h>
+#include <space.h>
 #include <utils.h>
 
 /* system */
@@ -1869,7 +1870,11 @@ pgmoneta_copy_directory(char* from, char* to, char** restore_last_files_names, s
                {
                   for (int i = 0; restore_last_files_names[i] != NULL; i++)
                   {
-                     file_is_excluded = !strcmp(from_buffer, restore_last_files_names[i]);
+                     if (!strcmp(from_buffer, restore_last_files_names[i]))
+                     {
+                        file_is_excluded = true;
+                        break;
+                     }
                   }
                   if (!file_is_excluded)
                   {
@@ -3242,6 +3247,8 @@ pgmoneta_delete_server_workspace(int server, char* label)
       goto error;
    }
 
+   pgmoneta_space_invalidate(server, SPACE_WORKSPACE);
+
    free(ws);
 
    return 0;
@@ -3683,6 +3690,16 @@ pgmoneta_get_file_size(char* file_path)
    return file_stat.st_size;
 }
 
+void
+pgmoneta_get_file_mtime(struct stat* st, struct timespec* mtime)
+{
+#if defined(HAVE_DARWIN) || defined(HAVE_OSX)
+   *mtime = st->st_mtimespec;
+#else
+   *mtime = st->st_mtim;
+#endif
+}
+
 bool
 pgmoneta_is_encrypted(char* file_path)
 {
@@ -4004,9 +4021,22 @@ pgmoneta_atoi(char* input)
 char*
 pgmoneta_indent(char* str, char* tag, int indent)
 {
-   for (int i = 0; i < indent; i++)
+   size_t length;
+   char* n = NULL;
+
+   if (indent > 0)
    {
-      str = pgmoneta_append(str, " ");
+      length = str != NULL ? strlen(str) : 0;
+
+      n = (char*)realloc(str, length + indent + 1);
+      if (n == NULL)
+      {
+         return str;
+      }
+
+      memset(n + length, ' ', indent);
+      n[length + indent] = '\0';
+      str = n;
    }
    if (tag != NULL)
    {
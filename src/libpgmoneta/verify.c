@@ -28,18 +28,96 @@
 
 /* pgmoneta */
 #include <pgmoneta.h>
+#include <art.h>
+#include <csv.h>
+#include <dedup.h>
+#include <info.h>
 #include <logging.h>
 #include <management.h>
 #include <network.h>
+#include <restore.h>
 #include <utils.h>
+#include <verify.h>
 #include <workflow.h>
 
 /* system */
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 
 #define NAME "verify"
 
+/** @struct verification_backup
+ * Defines a backup seen by the scheduled verification
+ */
+struct verification_backup
+{
+   struct backup* backup;   /**< The backup */
+   char* base;              /**< The backup directory */
+   char* data;              /**< The data directory */
+   struct art* verified;    /**< The time each file was last verified */
+   struct art* failed;      /**< The files that failed their last verification */
+   struct deque* f;         /**< The files that failed in this run */
+   struct deque* a;         /**< The files that passed in this run */
+   int selected;            /**< The number of files selected in this run */
+};
+
+/** @struct verification_file
+ * Defines a file that the scheduled verification may select
+ */
+struct verification_file
+{
+   int backup;              /**< The index of the backup */
+   char* filename;          /**< The file name relative to the data directory */
+   char* checksum;          /**< The checksum of the backup manifest */
+   uint64_t size;           /**< The size of the stored file */
+   int64_t verified;        /**< The time of the last verification, 0 if never */
+   unsigned int order;      /**< A random order between files verified at the same time */
+   bool selected;           /**< Is the file verified in this run */
+};
+
+/**
+ * Verify a sample of the files of the backups of a server
+ * @param server The server
+ * @param now The time of this run
+ */
+static void verification_server(int server, time_t now);
+
+/**
+ * Read the files of a backup and the state of their last verification
+ * @param vb The backup
+ * @param index The index of the backup
+ * @param seed The random seed
+ * @param files The files
+ * @param number_of_files The number of files
+ * @param capacity The capacity of the files array
+ * @return 0 upon success, otherwise 1
+ */
+static int verification_read(struct verification_backup* vb, int index, unsigned int* seed,
+                             struct verification_file** files, int* number_of_files, int* capacity);
+
+/**
+ * Write the state of the files of a backup and the summary in its backup information
+ * @param vb The backup
+ * @param index The index of the backup
+ * @param files The files
+ * @param number_of_files The number of files
+ * @param now The time of this run
+ * @return 0 upon success, otherwise 1
+ */
+static int verification_write(struct verification_backup* vb, int index, struct verification_file* files,
+                              int number_of_files, time_t now);
+
+/**
+ * Order files by their last verification, oldest first
+ * @param a The first file
+ * @param b The second file
+ * @return The order
+ */
+static int verification_compare(const void* a, const void* b);
+
 void
 pgmoneta_verify(SSL* ssl, int client_fd, int server, uint8_t compression, uint8_t encryption, struct json* payload)
 {
@@ -47,6 +125,8 @@ pgmoneta_verify(SSL* ssl, int client_fd, int server, uint8_t compression, uint8_
    char* directory = NULL;
    char* files = NULL;
    char* elapsed = NULL;
+   bool in_place = false;
+   bool materialized = false;
    struct timespec start_t;
    struct timespec end_t;
    double total_seconds;
@@ -106,6 +186,33 @@ pgmoneta_verify(SSL* ssl, int client_fd, int server, uint8_t compression, uint8_
       goto error;
    }
 
+   in_place = directory == NULL || strlen(directory) == 0;
+
+   if (in_place)
+   {
+      // An incremental backup only holds the changed blocks, so it has to be combined first
+      if (backup->type == TYPE_INCREMENTAL)
+      {
+         pgmoneta_log_error("Verify: %s/%s is incremental and needs a directory", config->common.servers[server].name, backup->label);
+         goto error;
+      }
+
+      if (pgmoneta_dedup_materialize(server, backup->label))
+      {
+         pgmoneta_log_error("Verify: Unable to read %s/%s from the chunk store", config->common.servers[server].name, backup->label);
+         goto error;
+      }
+      materialized = true;
+   }
+   else
+   {
+      if (pgmoneta_restore_backup(nodes))
+      {
+         pgmoneta_log_error("Verify: Unable to restore %s/%s to %s", config->common.servers[server].name, backup->label, directory);
+         goto error;
+      }
+   }
+
    workflow = pgmoneta_workflow_create(WORKFLOW_TYPE_VERIFY, backup);
 
    current = workflow;
@@ -208,7 +315,15 @@ pgmoneta_verify(SSL* ssl, int client_fd, int server, uint8_t compression, uint8_
    pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_SERVER, (uintptr_t)config->common.servers[server].name, ValueString);
    pgmoneta_json_put(response, MANAGEMENT_ARGUMENT_FILES, (uintptr_t)filesj, ValueJSON);
 
-   pgmoneta_delete_directory((char*)pgmoneta_art_search(nodes, NODE_TARGET_BASE));
+   if (in_place)
+   {
+      pgmoneta_dedup_dematerialize(server, backup->label);
+      materialized = false;
+   }
+   else
+   {
+      pgmoneta_delete_directory((char*)pgmoneta_art_search(nodes, NODE_TARGET_BASE));
+   }
 
 #ifdef HAVE_FREEBSD
    clock_gettime(CLOCK_MONOTONIC_FAST, &end_t);
@@ -247,7 +362,15 @@ pgmoneta_verify(SSL* ssl, int client_fd, int server, uint8_t compression, uint8_
 
 error:
 
-   pgmoneta_delete_directory((char*)pgmoneta_art_search(nodes, NODE_TARGET_BASE));
+   if (materialized)
+   {
+      pgmoneta_dedup_dematerialize(server, backup->label);
+   }
+
+   if (pgmoneta_art_contains_key(nodes, NODE_TARGET_BASE))
+   {
+      pgmoneta_delete_directory((char*)pgmoneta_art_search(nodes, NODE_TARGET_BASE));
+   }
 
    pgmoneta_deque_iterator_destroy(fiter);
    pgmoneta_deque_iterator_destroy(aiter);
@@ -266,3 +389,628 @@ error:
 
    exit(1);
 }
+
+void
+pgmoneta_verification(char** argv)
+{
+   time_t now;
+   struct main_configuration* config;
+
+   pgmoneta_start_logging();
+
+   config = (struct main_configuration*)shmem;
+
+   pgmoneta_set_proc_title(1, argv, "verification", NULL);
+
+   now = time(NULL);
+
+   for (int server = 0; server < config->common.number_of_servers; server++)
+   {
+      bool active = false;
+
+      if (!atomic_compare_exchange_strong(&config->common.servers[server].verification, &active, true))
+      {
+         pgmoneta_log_info("Verification: Server %s is active", config->common.servers[server].name);
+         continue;
+      }
+
+      verification_server(server, now);
+
+      atomic_store(&config->common.servers[server].verification, false);
+   }
+
+   pgmoneta_stop_logging();
+
+   exit(0);
+}
+
+int
+pgmoneta_get_verification_max_rate(int server)
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (config->common.servers[server].verification_max_rate != -1)
+   {
+      return config->common.servers[server].verification_max_rate;
+   }
+
+   return config->verification_max_rate;
+}
+
+static void
+verification_server(int server, time_t now)
+{
+   char* d = NULL;
+   int number_of_backups = 0;
+   struct backup** backups = NULL;
+   struct verification_backup* vbs = NULL;
+   struct verification_file* files = NULL;
+   int number_of_files = 0;
+   int capacity = 0;
+   unsigned int seed;
+   uint64_t total = 0;
+   int window = 0;
+   uint64_t quota = 0;
+   uint64_t selected = 0;
+   int selected_files = 0;
+   int failed_files = 0;
+   int number_of_workers = 0;
+   int max_rate = 0;
+   char* size = NULL;
+   struct token_bucket* bucket = NULL;
+   struct workers* workers = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   seed = (unsigned int)now ^ (unsigned int)getpid();
+
+   d = pgmoneta_get_server_backup(server);
+
+   if (pgmoneta_get_backups(d, &number_of_backups, &backups))
+   {
+      goto error;
+   }
+
+   if (number_of_backups == 0)
+   {
+      goto done;
+   }
+
+   vbs = (struct verification_backup*)calloc(number_of_backups, sizeof(struct verification_backup));
+   if (vbs == NULL)
+   {
+      goto error;
+   }
+
+   for (int i = 0; i < number_of_backups; i++)
+   {
+      vbs[i].backup = backups[i];
+
+      if (backups[i]->valid != VALID_TRUE)
+      {
+         continue;
+      }
+
+      /* A backup in the chunk store would have to be rebuilt in full to be read */
+      if (pgmoneta_dedup_is_backup(server, backups[i]->label))
+      {
+         pgmoneta_log_debug("Verification: Skipping %s/%s in the chunk store", config->common.servers[server].name, backups[i]->label);
+         continue;
+      }
+
+      vbs[i].base = pgmoneta_get_server_backup_identifier(server, backups[i]->label);
+      vbs[i].data = pgmoneta_get_server_backup_identifier_data(server, backups[i]->label);
+
+      if (verification_read(&vbs[i], i, &seed, &files, &number_of_files, &capacity))
+      {
+         pgmoneta_log_warn("Verification: Unable to read %s/%s", config->common.servers[server].name, backups[i]->label);
+         continue;
+      }
+   }
+
+   if (number_of_files == 0)
+   {
+      goto done;
+   }
+
+   /* Verifying the stalest interval / window part of the data in every run covers all of it within the window */
+   for (int i = 0; i < number_of_files; i++)
+   {
+      total += files[i].size;
+   }
+
+   window = MAX(config->verification_window, config->verification_interval);
+   quota = (uint64_t)((double)total * config->verification_interval / MAX(window, 1)) + 1;
+
+   qsort(files, number_of_files, sizeof(struct verification_file), verification_compare);
+
+   for (int i = 0; i < number_of_files && selected < quota; i++)
+   {
+      files[i].selected = true;
+      selected += files[i].size;
+      selected_files++;
+      vbs[files[i].backup].selected++;
+   }
+
+   number_of_workers = pgmoneta_get_number_of_workers(server);
+   if (number_of_workers > 0)
+   {
+      if (pgmoneta_workers_initialize(number_of_workers, &workers))
+      {
+         goto error;
+      }
+   }
+
+   max_rate = pgmoneta_get_verification_max_rate(server);
+   if (max_rate > 0)
+   {
+      bucket = (struct token_bucket*)malloc(sizeof(struct token_bucket));
+      if (bucket == NULL || pgmoneta_token_bucket_init(bucket, max_rate))
+      {
+         goto error;
+      }
+   }
+
+   for (int i = 0; i < number_of_backups; i++)
+   {
+      if (vbs[i].selected > 0)
+      {
+         if (pgmoneta_deque_create(true, &vbs[i].f) || pgmoneta_deque_create(true, &vbs[i].a))
+         {
+            goto error;
+         }
+      }
+   }
+
+   for (int i = 0; i < number_of_files; i++)
+   {
+      struct verification_backup* vb = NULL;
+      struct worker_input* payload = NULL;
+      struct json* j = NULL;
+
+      if (!files[i].selected)
+      {
+         continue;
+      }
+
+      vb = &vbs[files[i].backup];
+
+      if (bucket != NULL && files[i].size > 0)
+      {
+         while (pgmoneta_token_bucket_consume(bucket, files[i].size))
+         {
+            SLEEP(500000000L)
+         }
+      }
+
+      if (pgmoneta_create_worker_input(NULL, NULL, NULL, 0, workers, &payload))
+      {
+         goto error;
+      }
+
+      if (pgmoneta_json_create(&j))
+      {
+         free(payload);
+         goto error;
+      }
+
+      pgmoneta_json_put(j, MANAGEMENT_ARGUMENT_DIRECTORY, (uintptr_t)vb->data, ValueString);
+      pgmoneta_json_put(j, MANAGEMENT_ARGUMENT_FILENAME, (uintptr_t)files[i].filename, ValueString);
+      pgmoneta_json_put(j, MANAGEMENT_ARGUMENT_ORIGINAL, (uintptr_t)files[i].checksum, ValueString);
+      pgmoneta_json_put(j, MANAGEMENT_ARGUMENT_HASH_ALGORITHM, (uintptr_t)vb->backup->hash_algorithm, ValueInt32);
+
+      payload->data = j;
+      payload->failed = vb->f;
+      payload->all = vb->a;
+
+      if (workers != NULL)
+      {
+         pgmoneta_workers_add(workers, pgmoneta_verify_file, (struct worker_common*)payload);
+      }
+      else
+      {
+         pgmoneta_verify_file((struct worker_common*)payload);
+      }
+   }
+
+   pgmoneta_workers_wait(workers);
+
+   for (int i = 0; i < number_of_backups; i++)
+   {
+      if (vbs[i].selected == 0)
+      {
+         continue;
+      }
+
+      failed_files += pgmoneta_deque_size(vbs[i].f);
+
+      /* The backup may have been deleted while it was verified */
+      if (!pgmoneta_exists(vbs[i].base))
+      {
+         continue;
+      }
+
+      if (verification_write(&vbs[i], i, files, number_of_files, now))
+      {
+         pgmoneta_log_warn("Verification: Unable to save the state of %s/%s", config->common.servers[server].name, vbs[i].backup->label);
+      }
+   }
+
+   size = pgmoneta_translate_file_size(selected);
+
+   if (failed_files > 0)
+   {
+      pgmoneta_log_error("Verification: %s verified %d of %d files (%s), %d failed", config->common.servers[server].name,
+                         selected_files, number_of_files, size, failed_files);
+   }
+   else
+   {
+      pgmoneta_log_info("Verification: %s verified %d of %d files (%s)", config->common.servers[server].name,
+                        selected_files, number_of_files, size);
+   }
+
+   goto done;
+
+error:
+
+   pgmoneta_log_error("Verification: Unable to verify the backups of %s", config->common.servers[server].name);
+
+done:
+
+   pgmoneta_workers_wait(workers);
+   pgmoneta_workers_destroy(workers);
+   pgmoneta_token_bucket_destroy(bucket);
+
+   for (int i = 0; i < number_of_files; i++)
+   {
+      free(files[i].filename);
+      free(files[i].checksum);
+   }
+   free(files);
+
+   if (vbs != NULL)
+   {
+      for (int i = 0; i < number_of_backups; i++)
+      {
+         free(vbs[i].base);
+         free(vbs[i].data);
+         pgmoneta_art_destroy(vbs[i].verified);
+         pgmoneta_art_destroy(vbs[i].failed);
+         pgmoneta_deque_destroy(vbs[i].f);
+         pgmoneta_deque_destroy(vbs[i].a);
+      }
+      free(vbs);
+   }
+
+   for (int i = 0; i < number_of_backups; i++)
+   {
+      free(backups[i]);
+   }
+   free(backups);
+
+   free(size);
+   free(d);
+}
+
+static int
+verification_read(struct verification_backup* vb, int index, unsigned int* seed,
+                  struct verification_file** files, int* number_of_files, int* capacity)
+{
+   char* manifest = NULL;
+   char* state = NULL;
+   char* path = NULL;
+   char* stored = NULL;
+   int number_of_columns = 0;
+   char** columns = NULL;
+   struct csv_reader* csv = NULL;
+
+   if (pgmoneta_art_create(&vb->verified) || pgmoneta_art_create(&vb->failed))
+   {
+      goto error;
+   }
+
+   state = pgmoneta_append(state, vb->base);
+   state = pgmoneta_append(state, VERIFICATION_STATE);
+
+   if (pgmoneta_exists(state))
+   {
+      if (pgmoneta_csv_reader_init(state, &csv))
+      {
+         goto error;
+      }
+
+      while (pgmoneta_csv_next_row(csv, &number_of_columns, &columns))
+      {
+         if (number_of_columns == 3)
+         {
+            pgmoneta_art_insert(vb->verified, columns[0], (uintptr_t)strtoll(columns[1], NULL, 10), ValueInt64);
+
+            if (!strcmp(columns[2], "1"))
+            {
+               pgmoneta_art_insert(vb->failed, columns[0], (uintptr_t)true, ValueBool);
+            }
+         }
+
+         free(columns);
+         columns = NULL;
+      }
+
+      pgmoneta_csv_reader_destroy(csv);
+      csv = NULL;
+   }
+
+   manifest = pgmoneta_append(manifest, vb->base);
+   manifest = pgmoneta_append(manifest, "backup.manifest");
+
+   if (pgmoneta_csv_reader_init(manifest, &csv))
+   {
+      goto error;
+   }
+
+   while (pgmoneta_csv_next_row(csv, &number_of_columns, &columns))
+   {
+      struct verification_file* file = NULL;
+      uint64_t size = 0;
+
+      if (number_of_columns != 2)
+      {
+         free(columns);
+         columns = NULL;
+         continue;
+      }
+
+      path = pgmoneta_append(path, vb->data);
+      path = pgmoneta_append(path, columns[0]);
+
+      if (pgmoneta_exists(path))
+      {
+         size = pgmoneta_get_file_size(path);
+      }
+      else
+      {
+         stored = pgmoneta_verify_stored_file(path);
+
+         if (stored != NULL)
+         {
+            size = pgmoneta_get_file_size(stored);
+         }
+         else if (vb->backup->type == TYPE_INCREMENTAL)
+         {
+            /* Only the changed blocks were kept, so the file can't be checked before it is combined */
+            free(path);
+            path = NULL;
+            free(columns);
+            columns = NULL;
+            continue;
+         }
+      }
+
+      if (*number_of_files == *capacity)
+      {
+         struct verification_file* grown = NULL;
+         int c = *capacity == 0 ? 1024 : *capacity * 2;
+
+         grown = (struct verification_file*)realloc(*files, c * sizeof(struct verification_file));
+         if (grown == NULL)
+         {
+            goto error;
+         }
+
+         *files = grown;
+         *capacity = c;
+      }
+
+      file = &(*files)[*number_of_files];
+      memset(file, 0, sizeof(struct verification_file));
+
+      file->backup = index;
+      file->filename = pgmoneta_append(NULL, columns[0]);
+      file->checksum = pgmoneta_append(NULL, columns[1]);
+      file->size = size;
+      file->verified = (int64_t)pgmoneta_art_search(vb->verified, columns[0]);
+      file->order = rand_r(seed);
+
+      (*number_of_files)++;
+
+      free(stored);
+      stored = NULL;
+      free(path);
+      path = NULL;
+      free(columns);
+      columns = NULL;
+   }
+
+   pgmoneta_csv_reader_destroy(csv);
+
+   free(manifest);
+   free(state);
+
+   return 0;
+
+error:
+
+   pgmoneta_csv_reader_destroy(csv);
+
+   free(columns);
+   free(stored);
+   free(path);
+   free(manifest);
+   free(state);
+
+   return 1;
+}
+
+static int
+verification_write(struct verification_backup* vb, int index, struct verification_file* files,
+                   int number_of_files, time_t now)
+{
+   char* state = NULL;
+   char* temp = NULL;
+   char verified[MISC_LENGTH];
+   char* columns[3];
+   int64_t oldest = -1;
+   uint64_t verified_files = 0;
+   uint64_t failed_files = 0;
+   struct csv_writer* csv = NULL;
+   struct deque_iterator* iter = NULL;
+   struct info_transaction* transaction = NULL;
+
+   /* Record the outcome of this run */
+   if (pgmoneta_deque_iterator_create(vb->a, &iter))
+   {
+      goto error;
+   }
+
+   while (pgmoneta_deque_iterator_next(iter))
+   {
+      char* filename = (char*)pgmoneta_json_get((struct json*)pgmoneta_value_data(iter->value), MANAGEMENT_ARGUMENT_FILENAME);
+
+      pgmoneta_art_insert(vb->verified, filename, (uintptr_t)now, ValueInt64);
+      if (pgmoneta_art_contains_key(vb->failed, filename))
+      {
+         pgmoneta_art_delete(vb->failed, filename);
+      }
+   }
+
+   pgmoneta_deque_iterator_destroy(iter);
+   iter = NULL;
+
+   if (pgmoneta_deque_iterator_create(vb->f, &iter))
+   {
+      goto error;
+   }
+
+   while (pgmoneta_deque_iterator_next(iter))
+   {
+      struct json* j = (struct json*)pgmoneta_value_data(iter->value);
+      char* filename = (char*)pgmoneta_json_get(j, MANAGEMENT_ARGUMENT_FILENAME);
+
+      pgmoneta_log_error("Verification: %s failed (Expected: %s, Calculated: %s)", iter->tag,
+                         (char*)pgmoneta_json_get(j, MANAGEMENT_ARGUMENT_ORIGINAL),
+                         (char*)pgmoneta_json_get(j, MANAGEMENT_ARGUMENT_CALCULATED));
+
+      pgmoneta_art_insert(vb->verified, filename, (uintptr_t)now, ValueInt64);
+      pgmoneta_art_insert(vb->failed, filename, (uintptr_t)true, ValueBool);
+   }
+
+   pgmoneta_deque_iterator_destroy(iter);
+   iter = NULL;
+
+   state = pgmoneta_append(state, vb->base);
+   state = pgmoneta_append(state, VERIFICATION_STATE);
+
+   temp = pgmoneta_append(temp, state);
+   temp = pgmoneta_append(temp, ".tmp");
+
+   if (pgmoneta_csv_writer_init(temp, &csv))
+   {
+      goto error;
+   }
+
+   for (int i = 0; i < number_of_files; i++)
+   {
+      int64_t v = 0;
+      bool failed = false;
+
+      if (files[i].backup != index)
+      {
+         continue;
+      }
+
+      v = (int64_t)pgmoneta_art_search(vb->verified, files[i].filename);
+      failed = pgmoneta_art_contains_key(vb->failed, files[i].filename);
+
+      snprintf(&verified[0], sizeof(verified), "%" PRId64, v);
+
+      columns[0] = files[i].filename;
+      columns[1] = &verified[0];
+      columns[2] = failed ? "1" : "0";
+
+      if (pgmoneta_csv_write(csv, 3, columns))
+      {
+         goto error;
+      }
+
+      if (oldest == -1 || v < oldest)
+      {
+         oldest = v;
+      }
+
+      if (v > 0)
+      {
+         verified_files++;
+      }
+
+      if (failed)
+      {
+         failed_files++;
+      }
+   }
+
+   pgmoneta_csv_writer_destroy(csv);
+   csv = NULL;
+
+   if (rename(temp, state))
+   {
+      goto error;
+   }
+
+   if (pgmoneta_info_begin(vb->base, &transaction))
+   {
+      goto error;
+   }
+
+   pgmoneta_info_set_unsigned_long(transaction, INFO_VERIFIED, oldest > 0 ? (unsigned long)oldest : 0);
+   pgmoneta_info_set_unsigned_long(transaction, INFO_VERIFIED_FILES, verified_files);
+   pgmoneta_info_set_unsigned_long(transaction, INFO_VERIFIED_FAILED, failed_files);
+
+   if (pgmoneta_info_commit(transaction))
+   {
+      goto error;
+   }
+
+   pgmoneta_info_destroy(transaction);
+
+   free(state);
+   free(temp);
+
+   return 0;
+
+error:
+
+   pgmoneta_deque_iterator_destroy(iter);
+   pgmoneta_csv_writer_destroy(csv);
+   pgmoneta_info_destroy(transaction);
+
+   if (temp != NULL)
+   {
+      remove(temp);
+   }
+
+   free(state);
+   free(temp);
+
+   return 1;
+}
+
+static int
+verification_compare(const void* a, const void* b)
+{
+   struct verification_file* fa = (struct verification_file*)a;
+   struct verification_file* fb = (struct verification_file*)b;
+
+   if (fa->verified != fb->verified)
+   {
+      return fa->verified < fb->verified ? -1 : 1;
+   }
+
+   if (fa->order != fb->order)
+   {
+      return fa->order < fb->order ? -1 : 1;
+   }
+
+   return 0;
+}
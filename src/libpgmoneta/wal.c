@@ -28,13 +28,21 @@
 
 /* pgmoneta */
 #include <pgmoneta.h>
+#include <aes.h>
+#include <bzip2_compression.h>
+#include <gzip_compression.h>
 #include <logging.h>
+#include <lz4_compression.h>
 #include <network.h>
+#include <prometheus.h>
 #include <security.h>
 #include <server.h>
+#include <space.h>
 #include <storage.h>
 #include <utils.h>
 #include <wal.h>
+#include <workers.h>
+#include <zstandard_compression.h>
 
 /* system */
 #include <ctype.h>
@@ -42,10 +50,12 @@
 #include <err.h>
 #include <errno.h>
 #include <ev.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -53,16 +63,55 @@
 #include <libssh/sftp.h>
 #include <openssl/ssl.h>
 
+/* Size of the stdio buffer used to coalesce writes to a WAL segment */
+#define WAL_WRITE_BUFFER (256 * 1024)
+
+/* Report the received position after this many bytes even if nothing was synced */
+#define WAL_STATUS_BYTES (1024 * 1024)
+
+/* Upper bound in milliseconds on how long the receiver waits for the socket */
+#define WAL_MAX_WAIT 1000
+
+/* Name of a completed segment waiting for the compression thread */
+#define WAL_QUEUED ".queued.partial"
+
 int mappings_size = 0;
 oid_mapping* oidMappings = NULL;
 bool enable_translation = false;
 
+/** @struct wal_progress
+ * Defines the positions and timers for the standby status reports
+ */
+struct wal_progress
+{
+   size_t received;          /**< The end of the WAL received */
+   size_t flushed;           /**< The end of the WAL synced to disk */
+   size_t reported_received; /**< The received position last reported */
+   size_t reported_flushed;  /**< The flushed position last reported */
+   int64_t first_unsynced;   /**< The time the oldest unsynced WAL was received in microseconds */
+   int64_t last_sync;        /**< The time of the last sync in milliseconds */
+   int64_t last_report;      /**< The time of the last report in milliseconds */
+   int server;               /**< The server */
+};
+
 static char* wal_file_name(uint32_t timeline, size_t segno, int segsize);
 static int wal_fetch_history(char* basedir, int timeline, SSL* ssl, int socket);
-static FILE* wal_open(char* root, char* filename, int segsize);
-static int wal_close(char* root, char* filename, bool partial, FILE* file);
+static FILE* wal_open(int srv, int area, char* root, char* filename, int segsize);
+static int wal_close(int srv, char* root, char* filename, bool partial, FILE* file, struct workers* workers);
+static bool wal_inline(void);
+static void wal_compress_encrypt(struct worker_common* wc);
+static void wal_recover(char* root);
+static bool wal_recovered(char* root, char* name);
+static int wal_sync_path(char* path);
 static int wal_prepare(FILE* file, int segsize);
 static int wal_send_status_report(SSL* ssl, int socket, int64_t received, int64_t flushed, int64_t applied);
+static void wal_received(struct wal_progress* progress, size_t xlogptr);
+static int wal_sync(FILE* file, struct wal_progress* progress);
+static bool wal_sync_due(struct wal_progress* progress, bool idle);
+static int wal_feedback(SSL* ssl, int socket, struct wal_progress* progress, bool force);
+static int wal_wait(SSL* ssl, int socket, struct stream_buffer* buffer, struct wal_progress* progress);
+static int64_t wal_now(void);
+static int64_t wal_now_us(void);
 static int wal_xlog_offset(size_t xlogptr, int segsize);
 static int wal_convert_xlogpos(char* xlogpos, int segsize, uint32_t* high32, uint32_t* low32);
 static int wal_find_streaming_start(char* basedir, int segsize, uint32_t* timeline, uint32_t* high32, uint32_t* low32);
@@ -110,6 +159,8 @@ pgmoneta_wal(int srv, char** argv)
    struct workflow* head = NULL;
    struct workflow* current = NULL;
    struct art* nodes = NULL;
+   struct workers* workers = NULL;
+   struct wal_progress progress;
 
    config = (struct main_configuration*) shmem;
 
@@ -124,6 +175,8 @@ pgmoneta_wal(int srv, char** argv)
    }
 
    memset(msg, 0, sizeof(struct message));
+   memset(&progress, 0, sizeof(struct wal_progress));
+   progress.server = srv;
 
    if (config->common.servers[srv].wal_streaming)
    {
@@ -159,6 +212,18 @@ pgmoneta_wal(int srv, char** argv)
    d = pgmoneta_get_server_wal(srv);
    pgmoneta_mkdir(d);
 
+   wal_recover(d);
+
+   /* Completed segments are compressed and encrypted by a dedicated thread */
+   if (wal_inline())
+   {
+      if (pgmoneta_workers_initialize(1, &workers))
+      {
+         pgmoneta_log_warn("Unable to start WAL compression thread for %s", config->common.servers[srv].name);
+         workers = NULL;
+      }
+   }
+
    if (pgmoneta_art_create(&nodes))
    {
       goto error;
@@ -295,6 +360,13 @@ pgmoneta_wal(int srv, char** argv)
       memset(config->common.servers[srv].current_wal_lsn, 0, MISC_LENGTH);
       snprintf(config->common.servers[srv].current_wal_lsn, MISC_LENGTH, "%s", cmd);
 
+      progress.received = ((size_t)high32 << 32) | low32;
+      progress.flushed = progress.received;
+      progress.reported_received = progress.received;
+      progress.reported_flushed = progress.flushed;
+      progress.last_sync = wal_now();
+      progress.last_report = progress.last_sync;
+
       type = 0;
 
       // wait for the CopyBothResponse message
@@ -322,6 +394,25 @@ pgmoneta_wal(int srv, char** argv)
       // start streaming current timeline's WAL segments
       while (config->running)
       {
+         ret = wal_wait(ssl, socket, buffer, &progress);
+         if (ret < 0)
+         {
+            goto error;
+         }
+         if (ret == 0)
+         {
+            // idle, sync and report on the timers
+            if (wal_file != NULL && wal_sync_due(&progress, true) && wal_sync(wal_file, &progress))
+            {
+               goto error;
+            }
+            if (wal_feedback(ssl, socket, &progress, false))
+            {
+               goto error;
+            }
+            continue;
+         }
+
          ret = pgmoneta_consume_copy_stream_start(ssl, socket, buffer, msg, NULL);
          if (ret == 0)
          {
@@ -371,14 +462,14 @@ pgmoneta_wal(int srv, char** argv)
                      segno = xlogptr / segsize;
                      curr_xlogoff = 0;
                      filename = wal_file_name(timeline, segno, segsize);
-                     if ((wal_file = wal_open(d, filename, segsize)) == NULL)
+                     if ((wal_file = wal_open(srv, SPACE_WAL, d, filename, segsize)) == NULL)
                      {
                         pgmoneta_log_error("Could not create or open WAL segment file at %s", d);
                         goto error;
                      }
                      memset(config->common.servers[srv].current_wal_filename, 0, MISC_LENGTH);
                      snprintf(config->common.servers[srv].current_wal_filename, MISC_LENGTH, "%s.partial", filename);
-                     if ((wal_shipping_file = wal_open(wal_shipping, filename, segsize)) == NULL)
+                     if ((wal_shipping_file = wal_open(srv, SPACE_WAL_SHIPPING, wal_shipping, filename, segsize)) == NULL)
                      {
                         if (wal_shipping != NULL)
                         {
@@ -438,8 +529,12 @@ pgmoneta_wal(int srv, char** argv)
                      if (wal_xlog_offset(xlogptr, segsize) == 0)
                      {
                         // the end of WAL segment
-                        fflush(wal_file);
-                        wal_close(d, filename, false, wal_file);
+                        wal_received(&progress, xlogptr);
+                        if (wal_sync(wal_file, &progress))
+                        {
+                           goto error;
+                        }
+                        wal_close(srv, d, filename, false, wal_file, workers);
                         if (sftp_wal_file != NULL)
                         {
                            pgmoneta_sftp_wal_close(srv, filename, false, &sftp_wal_file);
@@ -450,7 +545,7 @@ pgmoneta_wal(int srv, char** argv)
                         if (wal_shipping_file != NULL)
                         {
                            fflush(wal_shipping_file);
-                           wal_close(wal_shipping, filename, false, wal_shipping_file);
+                           wal_close(srv, wal_shipping, filename, false, wal_shipping_file, NULL);
                            wal_shipping_file = NULL;
                         }
                         free(filename);
@@ -465,14 +560,14 @@ pgmoneta_wal(int srv, char** argv)
                            segno = xlogptr / segsize;
                            curr_xlogoff = 0;
                            filename = wal_file_name(timeline, segno, segsize);
-                           if ((wal_file = wal_open(d, filename, segsize)) == NULL)
+                           if ((wal_file = wal_open(srv, SPACE_WAL, d, filename, segsize)) == NULL)
                            {
                               pgmoneta_log_error("Could not create or open WAL segment file at %s", d);
                               goto error;
                            }
                            memset(config->common.servers[srv].current_wal_filename, 0, MISC_LENGTH);
                            snprintf(config->common.servers[srv].current_wal_filename, MISC_LENGTH, "%s.partial", filename);
-                           if ((wal_shipping_file = wal_open(wal_shipping, filename, segsize)) == NULL)
+                           if ((wal_shipping_file = wal_open(srv, SPACE_WAL_SHIPPING, wal_shipping, filename, segsize)) == NULL)
                            {
                               if (wal_shipping != NULL)
                               {
@@ -497,6 +592,7 @@ pgmoneta_wal(int srv, char** argv)
                            {
                               fwrite(msg->data + hdrlen + bytes_written, 1, bytes_left, wal_shipping_file);
                            }
+                           xlogptr += bytes_left;
                            bytes_left = 0;
                         }
                         break;
@@ -505,13 +601,26 @@ pgmoneta_wal(int srv, char** argv)
                   // update LSN after a message data is written to the segment
                   update_wal_lsn(srv, xlogptr);
 
-                  wal_send_status_report(ssl, socket, xlogptr, xlogptr, 0);
+                  wal_received(&progress, xlogptr);
+                  if (wal_file != NULL && wal_sync_due(&progress, false) && wal_sync(wal_file, &progress))
+                  {
+                     goto error;
+                  }
+                  if (wal_feedback(ssl, socket, &progress, false))
+                  {
+                     goto error;
+                  }
                   break;
                }
                case 'k':
                {
-                  // keep alive request
-                  wal_send_status_report(ssl, socket, xlogptr, xlogptr, 0);
+                  // keep alive, the last byte tells if the server wants a reply now
+                  bool reply = msg->length >= 1 + 8 + 8 + 1 && *((char*)msg->data + 1 + 8 + 8) != 0;
+
+                  if (wal_feedback(ssl, socket, &progress, reply))
+                  {
+                     goto error;
+                  }
                   break;
                }
                default:
@@ -527,9 +636,13 @@ pgmoneta_wal(int srv, char** argv)
             if (wal_file != NULL)
             {
                // Next file would be at a new timeline, so we treat the current wal file completed
-               wal_close(d, filename, false, wal_file);
+               if (wal_sync(wal_file, &progress))
+               {
+                  goto error;
+               }
+               wal_close(srv, d, filename, false, wal_file, workers);
                wal_file = NULL;
-               wal_close(wal_shipping, filename, false, wal_shipping_file);
+               wal_close(srv, wal_shipping, filename, false, wal_shipping_file, NULL);
                wal_shipping_file = NULL;
                if (sftp_wal_file != NULL)
                {
@@ -583,8 +696,9 @@ pgmoneta_wal(int srv, char** argv)
    if (wal_file != NULL)
    {
       bool partial = (wal_xlog_offset(xlogptr, segsize) != 0);
-      wal_close(d, filename, partial, wal_file);
-      wal_close(wal_shipping, filename, partial, wal_shipping_file);
+      wal_sync(wal_file, &progress);
+      wal_close(srv, d, filename, partial, wal_file, workers);
+      wal_close(srv, wal_shipping, filename, partial, wal_shipping_file, NULL);
       if (sftp_wal_file != NULL)
       {
          pgmoneta_sftp_wal_close(srv, filename, partial, &sftp_wal_file);
@@ -592,6 +706,12 @@ pgmoneta_wal(int srv, char** argv)
       }
    }
 
+   if (workers != NULL)
+   {
+      pgmoneta_workers_wait(workers);
+      pgmoneta_workers_destroy(workers);
+   }
+
    current = head;
    while (current != NULL)
    {
@@ -632,8 +752,8 @@ error:
 
    if (wal_file != NULL)
    {
-      wal_close(d, filename, true, wal_file);
-      wal_close(wal_shipping, filename, true, wal_shipping_file);
+      wal_close(srv, d, filename, true, wal_file, workers);
+      wal_close(srv, wal_shipping, filename, true, wal_shipping_file, NULL);
    }
    if (sftp_wal_file != NULL)
    {
@@ -651,6 +771,12 @@ error:
    pgmoneta_free_query_response(end_of_timeline_response);
    pgmoneta_memory_stream_buffer_free(buffer);
 
+   if (workers != NULL)
+   {
+      pgmoneta_workers_wait(workers);
+      pgmoneta_workers_destroy(workers);
+   }
+
    current = head;
    while (current != NULL)
    {
@@ -913,7 +1039,7 @@ error:
 }
 
 static FILE*
-wal_open(char* root, char* filename, int segsize)
+wal_open(int srv, int area, char* root, char* filename, int segsize)
 {
    if (root == NULL || strlen(root) == 0 || !pgmoneta_exists(root))
    {
@@ -943,6 +1069,7 @@ wal_open(char* root, char* filename, int segsize)
             errno = 0;
             goto error;
          }
+         setvbuf(file, NULL, _IOFBF, WAL_WRITE_BUFFER);
          pgmoneta_permission(path, 6, 0, 0);
 
          free(path);
@@ -965,11 +1092,21 @@ wal_open(char* root, char* filename, int segsize)
       goto error;
    }
 
+   setvbuf(file, NULL, _IOFBF, WAL_WRITE_BUFFER);
+
    if (wal_prepare(file, segsize))
    {
       goto error;
    }
 
+   /* The directory entry must be durable before any WAL in it is reported as flushed */
+   if (wal_sync_path(root))
+   {
+      goto error;
+   }
+
+   pgmoneta_space_add(srv, area, segsize);
+
    pgmoneta_permission(path, 6, 0, 0);
 
    free(path);
@@ -985,13 +1122,16 @@ error:
 }
 
 static int
-wal_close(char* root, char* filename, bool partial, FILE* file)
+wal_close(int srv, char* root, char* filename, bool partial, FILE* file, struct workers* workers)
 {
+   struct worker_input* wi = NULL;
+
    if (file == NULL || root == NULL || filename == NULL || strlen(root) == 0 || strlen(filename) == 0)
    {
       return 1;
    }
    char tmp_file_path[MAX_PATH] = {0};
+   char queued_file_path[MAX_PATH] = {0};
    char file_path[MAX_PATH] = {0};
 
    if (partial)
@@ -1004,19 +1144,62 @@ wal_close(char* root, char* filename, bool partial, FILE* file)
    if (pgmoneta_ends_with(root, "/"))
    {
       snprintf(tmp_file_path, sizeof(tmp_file_path), "%s%s.partial", root, filename);
+      snprintf(queued_file_path, sizeof(queued_file_path), "%s%s%s", root, filename, WAL_QUEUED);
       snprintf(file_path, sizeof(file_path), "%s%s", root, filename);
    }
    else
    {
       snprintf(tmp_file_path, sizeof(tmp_file_path), "%s/%s.partial", root, filename);
+      snprintf(queued_file_path, sizeof(queued_file_path), "%s/%s%s", root, filename, WAL_QUEUED);
       snprintf(file_path, sizeof(file_path), "%s/%s", root, filename);
    }
+
+   /* The segment is renamed to its queued name until the compression thread has */
+   /* produced the final file. The sweeper skips it, and a restart knows it is complete */
+   if (workers != NULL)
+   {
+      fclose(file);
+
+      if (rename(tmp_file_path, queued_file_path) != 0)
+      {
+         pgmoneta_log_error("could not rename file %s to %s", tmp_file_path, queued_file_path);
+         return 1;
+      }
+
+      wal_sync_path(root);
+
+      if (!pgmoneta_create_worker_input(root, queued_file_path, file_path, 0, workers, &wi))
+      {
+         wi->server = srv;
+
+         if (!pgmoneta_workers_add(workers, wal_compress_encrypt, (struct worker_common*)wi))
+         {
+            return 0;
+         }
+         free(wi);
+      }
+
+      pgmoneta_log_warn("Could not queue %s for compression", file_path);
+
+      if (rename(queued_file_path, file_path) != 0)
+      {
+         pgmoneta_log_error("could not rename file %s to %s", queued_file_path, file_path);
+         return 1;
+      }
+
+      wal_sync_path(root);
+
+      return 0;
+   }
+
    if (rename(tmp_file_path, file_path) != 0)
    {
       pgmoneta_log_error("could not rename file %s to %s", tmp_file_path, file_path);
       goto error;
    }
 
+   wal_sync_path(root);
+
    fclose(file);
 
    return 0;
@@ -1026,6 +1209,312 @@ error:
    return 1;
 }
 
+static bool
+wal_inline(void)
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   return config->compression_type != COMPRESSION_NONE || config->encryption != ENCRYPTION_NONE;
+}
+
+static void
+wal_compress_encrypt(struct worker_common* wc)
+{
+   char* current = NULL;
+   char* compressed = NULL;
+   char* encrypted = NULL;
+   char* target = NULL;
+   char* suffix = NULL;
+   int64_t raw = 0;
+   int (*compress)(char*, char*) = NULL;
+   struct worker_input* wi = (struct worker_input*)wc;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   switch (config->compression_type)
+   {
+      case COMPRESSION_CLIENT_GZIP:
+      case COMPRESSION_SERVER_GZIP:
+         suffix = ".gz";
+         compress = pgmoneta_gzip_file;
+         break;
+      case COMPRESSION_CLIENT_ZSTD:
+      case COMPRESSION_SERVER_ZSTD:
+         suffix = ".zstd";
+         compress = pgmoneta_zstandardc_file;
+         break;
+      case COMPRESSION_CLIENT_LZ4:
+      case COMPRESSION_SERVER_LZ4:
+         suffix = ".lz4";
+         compress = pgmoneta_lz4c_file;
+         break;
+      case COMPRESSION_CLIENT_BZIP2:
+         suffix = ".bz2";
+         compress = pgmoneta_bzip2_file;
+         break;
+      default:
+         suffix = "";
+         break;
+   }
+
+   target = pgmoneta_append(target, wi->to);
+
+   raw = pgmoneta_space_file(wi->from);
+
+   /* The compressors remove their input, so they are given a link to the queued */
+   /* segment. The synced segment stays until its replacement is durable */
+   current = pgmoneta_append(current, wi->to);
+   current = pgmoneta_append(current, ".input.partial");
+
+   if (link(wi->from, current) != 0)
+   {
+      pgmoneta_log_error("could not link file %s to %s: %s", wi->from, current, strerror(errno));
+      errno = 0;
+      free(current);
+      current = NULL;
+      goto error;
+   }
+
+   /* Intermediate files keep the .partial suffix until the final rename */
+   if (compress != NULL)
+   {
+      compressed = pgmoneta_append(compressed, wi->to);
+      compressed = pgmoneta_append(compressed, suffix);
+      compressed = pgmoneta_append(compressed, ".partial");
+
+      if (compress(current, compressed) || pgmoneta_exists(current))
+      {
+         pgmoneta_log_error("Could not compress %s", current);
+         if (pgmoneta_exists(compressed))
+         {
+            pgmoneta_delete_file(compressed, NULL);
+         }
+         goto error;
+      }
+
+      free(current);
+      current = compressed;
+      compressed = NULL;
+
+      target = pgmoneta_append(target, suffix);
+   }
+
+   if (config->encryption != ENCRYPTION_NONE)
+   {
+      encrypted = pgmoneta_append(encrypted, target);
+      encrypted = pgmoneta_append(encrypted, ".aes.partial");
+
+      if (pgmoneta_encrypt_file(current, encrypted) || pgmoneta_exists(current))
+      {
+         pgmoneta_log_error("Could not encrypt %s", current);
+         if (pgmoneta_exists(encrypted))
+         {
+            pgmoneta_delete_file(encrypted, NULL);
+         }
+         goto error;
+      }
+
+      free(current);
+      current = encrypted;
+      encrypted = NULL;
+
+      target = pgmoneta_append(target, ".aes");
+   }
+
+   if (wal_sync_path(current))
+   {
+      goto error;
+   }
+
+   if (rename(current, target) != 0)
+   {
+      pgmoneta_log_error("could not rename file %s to %s", current, target);
+      goto error;
+   }
+
+   free(current);
+   current = NULL;
+
+   if (wal_sync_path(wi->directory))
+   {
+      goto error;
+   }
+
+   pgmoneta_delete_file(wi->from, NULL);
+
+   pgmoneta_permission(target, 6, 0, 0);
+
+   pgmoneta_space_add(wi->server, SPACE_WAL, pgmoneta_space_file(target) - raw);
+
+   free(current);
+   free(target);
+   free(wi);
+
+   return;
+
+error:
+   /* Publish the synced segment under its final name, the periodic sweeper will finish it. */
+   /* Only this segment is affected, the next one is compressed here again */
+   if (current != NULL && pgmoneta_exists(current))
+   {
+      pgmoneta_delete_file(current, NULL);
+   }
+
+   if (pgmoneta_exists(wi->from))
+   {
+      if (rename(wi->from, wi->to) != 0)
+      {
+         pgmoneta_log_error("could not rename file %s to %s", wi->from, wi->to);
+      }
+      wal_sync_path(wi->directory);
+   }
+
+   pgmoneta_space_invalidate(wi->server, SPACE_WAL);
+
+   free(current);
+   free(compressed);
+   free(encrypted);
+   free(target);
+   free(wi);
+}
+
+static void
+wal_recover(char* root)
+{
+   char path[MAX_PATH];
+   char queued[MAX_PATH];
+   char to[MAX_PATH];
+   char name[MISC_LENGTH];
+   DIR* dir = NULL;
+   struct dirent* entry;
+
+   if (!(dir = opendir(root)))
+   {
+      return;
+   }
+
+   /* Files left by the compression thread: scratch files of a segment that is */
+   /* still queued are removed, finished steps are published for the sweeper */
+   while ((entry = readdir(dir)) != NULL)
+   {
+      size_t length = strlen(entry->d_name);
+
+      if (entry->d_type != DT_REG || length <= 24 + strlen(".partial") || entry->d_name[24] != '.' ||
+          !pgmoneta_ends_with(entry->d_name, ".partial") || pgmoneta_ends_with(entry->d_name, WAL_QUEUED))
+      {
+         continue;
+      }
+
+      snprintf(path, sizeof(path), "%s/%s", root, entry->d_name);
+      snprintf(queued, sizeof(queued), "%s/%.24s%s", root, entry->d_name, WAL_QUEUED);
+
+      if (pgmoneta_exists(queued))
+      {
+         pgmoneta_delete_file(path, NULL);
+         continue;
+      }
+
+      snprintf(name, sizeof(name), "%.*s", (int)(length - strlen(".partial")), entry->d_name);
+
+      if (pgmoneta_is_compressed(name) || pgmoneta_is_encrypted(name))
+      {
+         snprintf(to, sizeof(to), "%s/%s", root, name);
+         if (rename(path, to) != 0)
+         {
+            pgmoneta_log_error("could not rename file %s to %s", path, to);
+         }
+      }
+   }
+
+   /* Queued segments are complete, so they get their final name and the sweeper */
+   /* compresses and encrypts them */
+   rewinddir(dir);
+   while ((entry = readdir(dir)) != NULL)
+   {
+      if (entry->d_type != DT_REG || strlen(entry->d_name) != 24 + strlen(WAL_QUEUED) ||
+          !pgmoneta_ends_with(entry->d_name, WAL_QUEUED))
+      {
+         continue;
+      }
+
+      snprintf(path, sizeof(path), "%s/%s", root, entry->d_name);
+      snprintf(to, sizeof(to), "%s/%.24s", root, entry->d_name);
+
+      if (wal_recovered(root, entry->d_name))
+      {
+         pgmoneta_delete_file(path, NULL);
+         continue;
+      }
+
+      pgmoneta_log_info("Recovering queued WAL segment %.24s", entry->d_name);
+
+      if (rename(path, to) != 0)
+      {
+         pgmoneta_log_error("could not rename file %s to %s", path, to);
+      }
+   }
+
+   closedir(dir);
+}
+
+static bool
+wal_recovered(char* root, char* name)
+{
+   char path[MAX_PATH];
+   char* compression[] = {"", ".gz", ".zstd", ".lz4", ".bz2"};
+   char* encryption[] = {"", ".aes"};
+
+   /* The queued segment is only removed after its compressed or encrypted */
+   /* file is durable, so such a file is complete */
+   for (size_t i = 0; i < sizeof(compression) / sizeof(compression[0]); i++)
+   {
+      for (size_t j = 0; j < sizeof(encryption) / sizeof(encryption[0]); j++)
+      {
+         if (i == 0 && j == 0)
+         {
+            continue;
+         }
+
+         snprintf(path, sizeof(path), "%s/%.24s%s%s", root, name, compression[i], encryption[j]);
+         if (pgmoneta_exists(path))
+         {
+            return true;
+         }
+      }
+   }
+
+   return false;
+}
+
+static int
+wal_sync_path(char* path)
+{
+   int fd = -1;
+
+   fd = open(path, O_RDONLY);
+   if (fd == -1)
+   {
+      pgmoneta_log_error("Could not open %s: %s", path, strerror(errno));
+      errno = 0;
+      return 1;
+   }
+
+   if (fsync(fd) != 0)
+   {
+      pgmoneta_log_error("Could not sync %s: %s", path, strerror(errno));
+      errno = 0;
+      close(fd);
+      return 1;
+   }
+
+   close(fd);
+
+   return 0;
+}
+
 static int
 wal_prepare(FILE* file, int segsize)
 {
@@ -1070,6 +1559,193 @@ error:
    return 1;
 }
 
+static void
+wal_received(struct wal_progress* progress, size_t xlogptr)
+{
+   if (xlogptr > progress->received)
+   {
+      if (progress->flushed >= progress->received)
+      {
+         progress->first_unsynced = wal_now_us();
+      }
+      progress->received = xlogptr;
+   }
+}
+
+static int
+wal_sync(FILE* file, struct wal_progress* progress)
+{
+   int64_t start;
+   int64_t end;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (progress->flushed >= progress->received)
+   {
+      return 0;
+   }
+
+   start = wal_now_us();
+
+   if (fflush(file) != 0)
+   {
+      pgmoneta_log_error("Could not write WAL: %s", strerror(errno));
+      errno = 0;
+      return 1;
+   }
+
+#if defined(HAVE_DARWIN) || defined(HAVE_OSX)
+   if (fsync(fileno(file)) != 0)
+#else
+   if (fdatasync(fileno(file)) != 0)
+#endif
+   {
+      pgmoneta_log_error("Could not sync WAL: %s", strerror(errno));
+      errno = 0;
+      return 1;
+   }
+
+   end = wal_now_us();
+
+   pgmoneta_prometheus_histogram_observe(&config->common.servers[progress->server].wal_sync_duration, end - start);
+   pgmoneta_prometheus_histogram_observe(&config->common.servers[progress->server].wal_flush_lag, end - progress->first_unsynced);
+
+   progress->flushed = progress->received;
+   progress->last_sync = end / 1000;
+
+   return 0;
+}
+
+static bool
+wal_sync_due(struct wal_progress* progress, bool idle)
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (progress->flushed >= progress->received)
+   {
+      return false;
+   }
+
+   switch (config->wal_fsync)
+   {
+      case WAL_FSYNC_MESSAGE:
+         return true;
+      case WAL_FSYNC_INTERVAL:
+         return wal_now() - progress->last_sync >= config->wal_fsync_interval;
+      case WAL_FSYNC_SYNC:
+         // group commit, once everything available on the socket has been written
+         return idle || wal_now_us() - progress->first_unsynced >= (int64_t)config->wal_fsync_interval * 1000;
+      default:
+         // synced when the segment is closed
+         return false;
+   }
+}
+
+static int
+wal_feedback(SSL* ssl, int socket, struct wal_progress* progress, bool force)
+{
+   int64_t now;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   now = wal_now();
+
+   if (!force &&
+       progress->flushed == progress->reported_flushed &&
+       progress->received - progress->reported_received < WAL_STATUS_BYTES &&
+       (config->wal_status_interval <= 0 || now - progress->last_report < (int64_t)config->wal_status_interval * 1000))
+   {
+      return 0;
+   }
+
+   if (wal_send_status_report(ssl, socket, progress->received, progress->flushed, 0))
+   {
+      pgmoneta_log_error("Could not send standby status update");
+      return 1;
+   }
+
+   progress->reported_received = progress->received;
+   progress->reported_flushed = progress->flushed;
+   progress->last_report = now;
+
+   return 0;
+}
+
+static int
+wal_wait(SSL* ssl, int socket, struct stream_buffer* buffer, struct wal_progress* progress)
+{
+   int64_t now;
+   int64_t timeout;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   // data already read, or decrypted and pending inside the SSL object
+   if (buffer->cursor < buffer->end || (ssl != NULL && SSL_pending(ssl) > 0))
+   {
+      return 1;
+   }
+
+   now = wal_now();
+
+   timeout = WAL_MAX_WAIT;
+
+   if (config->wal_status_interval > 0)
+   {
+      timeout = progress->last_report + (int64_t)config->wal_status_interval * 1000 - now;
+   }
+
+   if (config->wal_fsync == WAL_FSYNC_SYNC && progress->flushed < progress->received)
+   {
+      // only check if more WAL is ready before syncing
+      timeout = 0;
+   }
+   else if (config->wal_fsync == WAL_FSYNC_INTERVAL && progress->flushed < progress->received)
+   {
+      int64_t sync = progress->last_sync + config->wal_fsync_interval - now;
+
+      if (sync < timeout)
+      {
+         timeout = sync;
+      }
+   }
+
+   if (timeout > WAL_MAX_WAIT)
+   {
+      timeout = WAL_MAX_WAIT;
+   }
+   else if (timeout < 0)
+   {
+      timeout = 0;
+   }
+
+   return pgmoneta_socket_wait_readable(socket, (int)timeout);
+}
+
+static int64_t
+wal_now(void)
+{
+   return wal_now_us() / 1000;
+}
+
+static int64_t
+wal_now_us(void)
+{
+   struct timespec ts;
+
+#ifdef HAVE_FREEBSD
+   clock_gettime(CLOCK_MONOTONIC_FAST, &ts);
+#else
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+
+   return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 static int
 wal_xlog_offset(size_t xlogptr, int segsize)
 {
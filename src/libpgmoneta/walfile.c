@@ -31,8 +31,56 @@
 #include <logging.h>
 #include <utils.h>
 #include <walfile.h>
+#include <workers.h>
 
 #include <libgen.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_LINUX
+#include <sys/sysinfo.h>
+#endif
+
+#define SEGMENT_PENDING 0
+#define SEGMENT_READY   1
+#define SEGMENT_FAILED  2
+
+/** @struct walfile_prefetch
+ * Defines the state shared by the WAL files prepared ahead of a scan
+ */
+struct walfile_prefetch
+{
+   pthread_mutex_t lock;   /**< The lock */
+   pthread_cond_t ready;   /**< Signaled when a WAL file has been prepared */
+};
+
+/** @struct walfile_segment
+ * Defines a WAL file of a scan
+ */
+struct walfile_segment
+{
+   struct worker_common common;         /**< The worker common */
+   struct walfile_prefetch* prefetch;   /**< The prefetch state */
+   char* path;                          /**< The path of the stored WAL file */
+   char* wal_path;                      /**< The path of the raw WAL file */
+   bool temporary;                      /**< The raw WAL file is a temporary file */
+   uint32_t tli;                        /**< The timeline */
+   uint32_t log;                        /**< The high part of the segment number */
+   uint32_t seg;                        /**< The low part of the segment number */
+   int state;                           /**< The state of the raw WAL file */
+};
+
+static int get_segments(char* directory, uint64_t start_lsn, uint64_t end_lsn, struct walfile_prefetch* prefetch,
+                        struct walfile_segment*** segments, int* number_of_segments);
+static int compare_segments(const void* a, const void* b);
+static bool is_next_segment(struct walfile_segment* segment, struct walfile_segment* next, size_t segment_size);
+static int get_number_of_prefetch_workers(int number_of_segments);
+static int create_segment(char* path, struct walfile_prefetch* prefetch, struct walfile_segment** segment);
+static void prepare_segment(struct worker_common* wc);
+static int wait_for_segment(struct walfile_segment* segment);
+static void release_segment(struct walfile_segment* segment);
+static void destroy_segment(struct walfile_segment* segment);
+static void destroy_segments(struct workers* workers, struct walfile_segment** segments, int number_of_segments);
 
 /**
  * Validate if a WAL file exists and is accessible before processing.
@@ -303,22 +351,469 @@ pgmoneta_describe_walfile(char* path, enum value_type type, char* output, bool q
                           uint32_t limit, char** included_objects)
 {
    FILE* out = NULL;
-   char* tmp_wal = NULL;
-   struct walfile* wf = NULL;
-   struct deque_iterator* record_iterator = NULL;
+   struct walfile_prefetch prefetch;
+   struct walfile_segment** segments = NULL;
+   int number_of_segments = 0;
+   int number_of_workers = 0;
+   int submitted = 0;
+   struct workers* workers = NULL;
+   struct wal_record_iterator* record_iterator = NULL;
    struct decoded_xlog_record* record = NULL;
-   char* decompressed_file_name = NULL;
-   char* decrypted_file_name = NULL;
-   char* wal_path = NULL;
-   bool copy = true;
+   bool follows = false;
+   bool finished = false;
 
-   if (!pgmoneta_is_file(path))
+   memset(&prefetch, 0, sizeof(struct walfile_prefetch));
+   pthread_mutex_init(&prefetch.lock, NULL);
+   pthread_cond_init(&prefetch.ready, NULL);
+
+   if (pgmoneta_is_directory(path))
+   {
+      if (get_segments(path, start_lsn, end_lsn, &prefetch, &segments, &number_of_segments))
+      {
+         pgmoneta_log_fatal("Failed to read WAL files at %s", path);
+         goto error;
+      }
+
+      if (number_of_segments == 0)
+      {
+         pgmoneta_log_fatal("No WAL files at %s", path);
+         goto error;
+      }
+   }
+   else
+   {
+      if (!pgmoneta_is_file(path))
+      {
+         pgmoneta_log_fatal("WAL file at %s does not exist", path);
+         goto error;
+      }
+
+      segments = (struct walfile_segment**)calloc(1, sizeof(struct walfile_segment*));
+      if (segments == NULL || create_segment(path, &prefetch, &segments[0]))
+      {
+         goto error;
+      }
+      number_of_segments = 1;
+   }
+
+   number_of_workers = get_number_of_prefetch_workers(number_of_segments);
+   if (number_of_workers > 0)
+   {
+      if (pgmoneta_workers_initialize(number_of_workers, &workers))
+      {
+         goto error;
+      }
+   }
+
+   if (output == NULL)
+   {
+      out = stdout;
+   }
+   else
+   {
+      out = fopen(output, "w");
+      color = false;
+   }
+
+   if (type == ValueJSON && !quiet)
+   {
+      fprintf(out, "{ \"WAL\": [\n");
+   }
+
+   for (int i = 0; !finished && i < number_of_segments; i++)
+   {
+      // Keep the following WAL files prepared ahead of the scan
+      while (submitted < number_of_segments && submitted <= i + 2 * number_of_workers)
+      {
+         if (segments[submitted]->state == SEGMENT_PENDING)
+         {
+            if (workers != NULL)
+            {
+               if (pgmoneta_workers_add(workers, prepare_segment, (struct worker_common*)segments[submitted]))
+               {
+                  goto error;
+               }
+            }
+            else
+            {
+               prepare_segment((struct worker_common*)segments[submitted]);
+            }
+         }
+         submitted++;
+      }
+
+      if (wait_for_segment(segments[i]))
+      {
+         pgmoneta_log_fatal("Failed to prepare WAL file at %s", segments[i]->path);
+         goto error;
+      }
+
+      if (record_iterator == NULL)
+      {
+         if (pgmoneta_wal_record_iterator_create(segments[i]->wal_path, -1, &record_iterator))
+         {
+            pgmoneta_log_fatal("Failed to read WAL file at %s", segments[i]->path);
+            goto error;
+         }
+      }
+      else
+      {
+         if (pgmoneta_wal_record_iterator_advance(record_iterator, segments[i]->wal_path))
+         {
+            pgmoneta_log_fatal("Failed to read WAL file at %s", segments[i]->path);
+            goto error;
+         }
+      }
+
+      follows = i + 1 < number_of_segments && is_next_segment(segments[i], segments[i + 1], record_iterator->size);
+
+      while (true)
+      {
+         if (pgmoneta_wal_record_iterator_next(record_iterator, &record))
+         {
+            pgmoneta_log_fatal("Failed to read WAL file at %s", segments[i]->path);
+            goto error;
+         }
+
+         if (record == NULL)
+         {
+            break;
+         }
+
+         // The record is completed from the next WAL file
+         if (record->partial && record_iterator->carry_length > 0 && follows)
+         {
+            continue;
+         }
+
+         // Records are in LSN order, so nothing after the end LSN is included
+         if (!record->partial && end_lsn > 0 && record->lsn > end_lsn)
+         {
+            finished = true;
+            break;
+         }
+
+         pgmoneta_wal_record_display(record, record_iterator->long_phd->std.xlp_magic, type, out, quiet, color,
+                                     rms, start_lsn, end_lsn, xids, limit, included_objects);
+      }
+
+      release_segment(segments[i]);
+   }
+
+   if (type == ValueJSON && !quiet)
+   {
+      fprintf(out, "\n]}");
+   }
+
+   if (output != NULL)
+   {
+      if (out != NULL)
+      {
+         fflush(out);
+         fclose(out);
+      }
+   }
+
+   pgmoneta_wal_record_iterator_destroy(record_iterator);
+   destroy_segments(workers, segments, number_of_segments);
+   pthread_cond_destroy(&prefetch.ready);
+   pthread_mutex_destroy(&prefetch.lock);
+   return 0;
+
+error:
+
+   if (output != NULL)
+   {
+      if (out != NULL)
+      {
+         fflush(out);
+         fclose(out);
+      }
+   }
+
+   pgmoneta_wal_record_iterator_destroy(record_iterator);
+   destroy_segments(workers, segments, number_of_segments);
+   pthread_cond_destroy(&prefetch.ready);
+   pthread_mutex_destroy(&prefetch.lock);
+   return 1;
+}
+
+static int
+get_segments(char* directory, uint64_t start_lsn, uint64_t end_lsn, struct walfile_prefetch* prefetch,
+             struct walfile_segment*** segments, int* number_of_segments)
+{
+   char** files = NULL;
+   int number_of_files = 0;
+   struct walfile_segment** array = NULL;
+   struct walfile_segment* segment = NULL;
+   struct xlog_long_page_header_data long_phd;
+   char* p = NULL;
+   FILE* file = NULL;
+   uint64_t segment_size = DEFAULT_WAL_SEGZ_BYTES;
+   uint64_t begin;
+   int n = 0;
+   int m = 0;
+
+   *segments = NULL;
+   *number_of_segments = 0;
+
+   if (pgmoneta_get_wal_files(directory, &number_of_files, &files))
+   {
+      goto error;
+   }
+
+   array = (struct walfile_segment**)calloc(number_of_files + 1, sizeof(struct walfile_segment*));
+   if (array == NULL)
    {
-      pgmoneta_log_fatal("WAL file at %s does not exist", path);
       goto error;
    }
 
-   wal_path = pgmoneta_append(wal_path, path);
+   for (int i = 0; i < number_of_files; i++)
+   {
+      if (strlen(files[i]) < 24 || strspn(files[i], "0123456789ABCDEF") != 24 ||
+          (files[i][24] != '\0' && files[i][24] != '.'))
+      {
+         continue;
+      }
+
+      p = pgmoneta_append(NULL, directory);
+      if (!pgmoneta_ends_with(p, "/"))
+      {
+         p = pgmoneta_append_char(p, '/');
+      }
+      p = pgmoneta_append(p, files[i]);
+
+      if (create_segment(p, prefetch, &segment))
+      {
+         goto error;
+      }
+      free(p);
+      p = NULL;
+
+      array[n++] = segment;
+      segment = NULL;
+   }
+
+   if (n == 0)
+   {
+      goto done;
+   }
+
+   // The highest timeline of each segment is used
+   qsort(array, n, sizeof(struct walfile_segment*), compare_segments);
+   for (int i = 0; i < n; i++)
+   {
+      if (i + 1 < n && array[i]->log == array[i + 1]->log && array[i]->seg == array[i + 1]->seg)
+      {
+         destroy_segment(array[i]);
+         array[i] = NULL;
+      }
+   }
+
+   // The segment size is in the header of the first WAL file
+   for (int i = 0; i < n; i++)
+   {
+      if (array[i] != NULL)
+      {
+         prepare_segment((struct worker_common*)array[i]);
+         if (wait_for_segment(array[i]))
+         {
+            goto error;
+         }
+
+         file = fopen(array[i]->wal_path, "rb");
+         if (file == NULL || fread(&long_phd, sizeof(struct xlog_long_page_header_data), 1, file) != 1)
+         {
+            pgmoneta_log_error("Could not read the header of %s", array[i]->path);
+            goto error;
+         }
+         fclose(file);
+         file = NULL;
+
+         if (long_phd.xlp_seg_size > 0)
+         {
+            segment_size = long_phd.xlp_seg_size;
+         }
+         break;
+      }
+   }
+
+   // Only keep the segments holding the LSN range
+   for (int i = 0; i < n; i++)
+   {
+      if (array[i] == NULL)
+      {
+         continue;
+      }
+
+      begin = ((uint64_t)array[i]->log << 32) + (uint64_t)array[i]->seg * segment_size;
+
+      if ((start_lsn > 0 && begin + segment_size <= start_lsn) ||
+          (end_lsn > 0 && begin > end_lsn))
+      {
+         destroy_segment(array[i]);
+         array[i] = NULL;
+         continue;
+      }
+
+      array[m++] = array[i];
+   }
+
+   for (int i = m; i < n; i++)
+   {
+      array[i] = NULL;
+   }
+
+done:
+
+   for (int i = 0; i < number_of_files; i++)
+   {
+      free(files[i]);
+   }
+   free(files);
+
+   *segments = array;
+   *number_of_segments = m;
+
+   return 0;
+
+error:
+
+   if (file != NULL)
+   {
+      fclose(file);
+   }
+
+   for (int i = 0; i < number_of_files; i++)
+   {
+      free(files[i]);
+   }
+   free(files);
+
+   for (int i = 0; i < n; i++)
+   {
+      destroy_segment(array[i]);
+   }
+   free(array);
+   free(p);
+
+   return 1;
+}
+
+static int
+compare_segments(const void* a, const void* b)
+{
+   struct walfile_segment* s1 = *(struct walfile_segment**)a;
+   struct walfile_segment* s2 = *(struct walfile_segment**)b;
+
+   if (s1->log != s2->log)
+   {
+      return s1->log < s2->log ? -1 : 1;
+   }
+
+   if (s1->seg != s2->seg)
+   {
+      return s1->seg < s2->seg ? -1 : 1;
+   }
+
+   if (s1->tli != s2->tli)
+   {
+      return s1->tli < s2->tli ? -1 : 1;
+   }
+
+   return 0;
+}
+
+static bool
+is_next_segment(struct walfile_segment* segment, struct walfile_segment* next, size_t segment_size)
+{
+   uint64_t segments_per_id = 0x100000000ULL / segment_size;
+
+   if (next->seg == segment->seg + 1)
+   {
+      return next->log == segment->log;
+   }
+
+   return next->log == segment->log + 1 && next->seg == 0 && segment->seg + 1 == segments_per_id;
+}
+
+static int
+get_number_of_prefetch_workers(int number_of_segments)
+{
+   struct walinfo_configuration* config;
+   int nw = 0;
+
+   config = (struct walinfo_configuration*)shmem;
+
+   if (number_of_segments <= 1)
+   {
+      return 0;
+   }
+
+   if (config->common.servers[0].workers > 0)
+   {
+      nw = config->common.servers[0].workers;
+   }
+   else
+   {
+#ifdef HAVE_LINUX
+      nw = get_nprocs();
+#else
+      nw = 4;
+#endif
+   }
+
+   return MIN(nw, number_of_segments);
+}
+
+static int
+create_segment(char* path, struct walfile_prefetch* prefetch, struct walfile_segment** segment)
+{
+   struct walfile_segment* s = NULL;
+   char* name = NULL;
+
+   *segment = NULL;
+
+   s = (struct walfile_segment*)calloc(1, sizeof(struct walfile_segment));
+   if (s == NULL)
+   {
+      goto error;
+   }
+
+   s->prefetch = prefetch;
+   s->path = pgmoneta_append(NULL, path);
+   s->state = SEGMENT_PENDING;
+
+   name = basename(s->path);
+   if (sscanf(name, "%08X%08X%08X", &s->tli, &s->log, &s->seg) != 3)
+   {
+      s->tli = 0;
+      s->log = 0;
+      s->seg = 0;
+   }
+
+   *segment = s;
+
+   return 0;
+
+error:
+
+   pgmoneta_log_fatal("Could not allocate memory for WAL file %s", path);
+
+   return 1;
+}
+
+static void
+prepare_segment(struct worker_common* wc)
+{
+   struct walfile_segment* segment = (struct walfile_segment*)wc;
+   char* wal_path = NULL;
+   char* tmp_wal = NULL;
+   char* name = NULL;
+   bool copy = true;
+   int state = SEGMENT_FAILED;
+
+   wal_path = pgmoneta_append(wal_path, segment->path);
 
    // Based on the file extension, if it's an encrypted file, decrypt it in /tmp
    if (pgmoneta_is_encrypted(wal_path))
@@ -330,18 +825,19 @@ pgmoneta_describe_walfile(char* path, enum value_type type, char* output, bool q
       pgmoneta_copy_file(wal_path, tmp_wal, NULL);
       copy = false;
 
-      pgmoneta_strip_extension(basename(wal_path), &decrypted_file_name);
+      pgmoneta_strip_extension(basename(wal_path), &name);
 
       free(wal_path);
       wal_path = NULL;
 
-      wal_path = pgmoneta_format_and_append(wal_path, "/tmp/%s", decrypted_file_name);
-      free(decrypted_file_name);
+      wal_path = pgmoneta_format_and_append(wal_path, "/tmp/%s", name);
+      free(name);
+      name = NULL;
 
       if (pgmoneta_decrypt_file(tmp_wal, wal_path))
       {
-         pgmoneta_log_fatal("Failed to decrypt WAL file at %s", path);
-         goto error;
+         pgmoneta_log_error("Failed to decrypt WAL file at %s", segment->path);
+         goto done;
       }
    }
 
@@ -361,101 +857,94 @@ pgmoneta_describe_walfile(char* path, enum value_type type, char* output, bool q
          pgmoneta_copy_file(wal_path, tmp_wal, NULL);
       }
 
-      pgmoneta_strip_extension(basename(wal_path), &decompressed_file_name);
+      pgmoneta_strip_extension(basename(wal_path), &name);
 
       free(wal_path);
       wal_path = NULL;
 
-      wal_path = pgmoneta_format_and_append(wal_path, "/tmp/%s", decompressed_file_name);
-      free(decompressed_file_name);
+      wal_path = pgmoneta_format_and_append(wal_path, "/tmp/%s", name);
+      free(name);
+      name = NULL;
 
       if (pgmoneta_decompress(tmp_wal, wal_path))
       {
-         pgmoneta_log_fatal("Failed to decompress WAL file at %s", path);
-         goto error;
+         pgmoneta_log_error("Failed to decompress WAL file at %s", segment->path);
+         goto done;
       }
    }
 
-   if (pgmoneta_read_walfile(-1, wal_path, &wf))
-   {
-      pgmoneta_log_fatal("Failed to read WAL file at %s", path);
-      goto error;
-   }
+   state = SEGMENT_READY;
 
-   if (pgmoneta_deque_iterator_create(wf->records, &record_iterator))
-   {
-      pgmoneta_log_fatal("Failed to create deque iterator");
-      goto error;
-   }
+done:
 
-   if (output == NULL)
-   {
-      out = stdout;
-   }
-   else
-   {
-      out = fopen(output, "w");
-      color = false;
-   }
+   free(tmp_wal);
 
-   if (type == ValueJSON)
-   {
-      if (!quiet)
-      {
-         fprintf(out, "{ \"WAL\": [\n");
-      }
+   pthread_mutex_lock(&segment->prefetch->lock);
+   segment->wal_path = wal_path;
+   segment->temporary = wal_path != NULL && strcmp(wal_path, segment->path) != 0;
+   segment->state = state;
+   pthread_cond_broadcast(&segment->prefetch->ready);
+   pthread_mutex_unlock(&segment->prefetch->lock);
+}
 
-      while (pgmoneta_deque_iterator_next(record_iterator))
-      {
-         record = (struct decoded_xlog_record*) record_iterator->value->data;
-         pgmoneta_wal_record_display(record, wf->long_phd->std.xlp_magic, type, out, quiet, color,
-                                     rms, start_lsn, end_lsn, xids, limit, included_objects);
-      }
+static int
+wait_for_segment(struct walfile_segment* segment)
+{
+   int state;
 
-      if (!quiet)
-      {
-         fprintf(out, "\n]}");
-      }
+   pthread_mutex_lock(&segment->prefetch->lock);
+   while (segment->state == SEGMENT_PENDING)
+   {
+      pthread_cond_wait(&segment->prefetch->ready, &segment->prefetch->lock);
    }
-   else
+   state = segment->state;
+   pthread_mutex_unlock(&segment->prefetch->lock);
+
+   return state == SEGMENT_READY ? 0 : 1;
+}
+
+static void
+release_segment(struct walfile_segment* segment)
+{
+   if (segment->temporary && segment->wal_path != NULL)
    {
-      while (pgmoneta_deque_iterator_next(record_iterator))
-      {
-         record = (struct decoded_xlog_record*) record_iterator->value->data;
-         pgmoneta_wal_record_display(record, wf->long_phd->std.xlp_magic, type, out, quiet, color,
-                                     rms, start_lsn, end_lsn, xids, limit, included_objects);
-      }
+      pgmoneta_delete_file(segment->wal_path, NULL);
    }
 
-   if (output != NULL)
+   free(segment->wal_path);
+   segment->wal_path = NULL;
+   segment->temporary = false;
+}
+
+static void
+destroy_segment(struct walfile_segment* segment)
+{
+   if (segment == NULL)
    {
-      if (out != NULL)
-      {
-         fflush(out);
-         fclose(out);
-      }
+      return;
    }
 
-   free(tmp_wal);
-   free(wal_path);
-   pgmoneta_deque_iterator_destroy(record_iterator);
-   pgmoneta_destroy_walfile(wf);
-   return 0;
+   release_segment(segment);
+   free(segment->path);
+   free(segment);
+}
 
-error:
+static void
+destroy_segments(struct workers* workers, struct walfile_segment** segments, int number_of_segments)
+{
+   if (workers != NULL)
+   {
+      pgmoneta_workers_wait(workers);
+      pgmoneta_workers_destroy(workers);
+   }
 
-   if (output != NULL)
+   if (segments != NULL)
    {
-      if (out != NULL)
+      for (int i = 0; i < number_of_segments; i++)
       {
-         fflush(out);
-         fclose(out);
+         destroy_segment(segments[i]);
       }
+      free(segments);
    }
-
-   free(tmp_wal);
-   free(wal_path);
-   pgmoneta_destroy_walfile(wf);
-   pgmoneta_deque_iterator_destroy(record_iterator);
-   return 1;
 }
+
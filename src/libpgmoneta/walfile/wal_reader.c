@@ -38,17 +38,27 @@
 
 /* system */
 #include <assert.h>
+#include <fcntl.h>
 #include <libgen.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 struct server* server_config;
 
-static int decode_xlog_record(char* buffer, struct decoded_xlog_record* decoded, struct xlog_record* record, uint32_t block_size, uint16_t magic_value, xlog_rec_ptr lsn);
+static int decode_xlog_record(char* buffer, struct decoded_xlog_record* decoded, struct xlog_record* record, uint32_t block_size, uint16_t magic_value, xlog_rec_ptr lsn, char* storage);
 static void record_json(struct decoded_xlog_record* record, uint8_t magic_value, struct value** value);
 static bool get_record_block_tag_extended(struct decoded_xlog_record* pRecord, int id, struct rel_file_locator* pLocator, enum fork_number* pNumber, block_number* pInt, buffer* pVoid);
 static char* get_record_block_ref_info(char* buf, struct decoded_xlog_record* record, bool pretty, bool detailed_format, uint32_t* fpi_len, uint8_t magic_value);
 static int magic_value_to_postgres_version(uint16_t magic_value);
+static int open_walfile(struct wal_record_iterator* iterator, char* path);
+static void close_walfile(struct wal_record_iterator* iterator);
+static int ensure_buffer(char** buffer, size_t* size, size_t length);
+static int decode_record(struct wal_record_iterator* iterator, char* data, struct xlog_record* header, xlog_rec_ptr lsn);
+static int save_carry(struct wal_record_iterator* iterator, xlog_rec_ptr lsn, char* header, size_t header_length, char* data, size_t data_length);
+static int stitch_record(struct wal_record_iterator* iterator, bool* stitched);
 
 static bool is_included(char* rm, struct deque* rms,
                         uint64_t s_lsn, uint64_t start_lsn,
@@ -141,345 +151,725 @@ pgmoneta_wal_array_desc(char* buf, void* array, size_t elem_size, int count)
    return buf;
 }
 
-static void
-read_all_page_headers(FILE* file, struct xlog_long_page_header_data* long_header, struct walfile* wal_file)
+static int
+copy_record(struct decoded_xlog_record* record, struct decoded_xlog_record** copy)
 {
-   int page_number = 1;
-   while (true)
+   struct decoded_xlog_record* c = NULL;
+
+   *copy = NULL;
+
+   c = malloc(sizeof(struct decoded_xlog_record));
+   if (c == NULL)
    {
-      fseek(file, page_number * long_header->xlp_xlog_blcksz, SEEK_SET);
-      struct xlog_page_header_data* page_header = NULL;
-      page_header = malloc(SIZE_OF_XLOG_SHORT_PHD);
-      size_t bytes_read = fread(page_header, SIZE_OF_XLOG_SHORT_PHD, 1, file);
-      if (feof(file))
+      goto error;
+   }
+
+   memcpy(c, record, sizeof(struct decoded_xlog_record));
+   c->main_data = NULL;
+   for (int i = 0; i <= record->max_block_id; i++)
+   {
+      c->blocks[i].bkp_image = NULL;
+      c->blocks[i].data = NULL;
+   }
+
+   for (int i = 0; i <= record->max_block_id; i++)
+   {
+      struct decoded_bkp_block* blk = &record->blocks[i];
+
+      if (!blk->in_use)
       {
-         free(page_header);
-         goto finish;
+         continue;
       }
-      if (bytes_read != 1)
+
+      if (blk->has_image)
+      {
+         c->blocks[i].bkp_image = malloc(blk->bimg_len);
+         if (c->blocks[i].bkp_image == NULL)
+         {
+            goto error;
+         }
+         memcpy(c->blocks[i].bkp_image, blk->bkp_image, blk->bimg_len);
+      }
+      if (blk->has_data)
+      {
+         c->blocks[i].data = malloc(blk->data_len);
+         if (c->blocks[i].data == NULL)
+         {
+            goto error;
+         }
+         memcpy(c->blocks[i].data, blk->data, blk->data_len);
+      }
+   }
+
+   if (record->main_data_len > 0)
+   {
+      c->main_data = malloc(record->main_data_len);
+      if (c->main_data == NULL)
       {
-         pgmoneta_log_error("Error: Failed to read the complete data");
          goto error;
       }
-      pgmoneta_deque_add(wal_file->page_headers, NULL, (uintptr_t) page_header, ValueRef);
-      page_number++;
+      memcpy(c->main_data, record->main_data, record->main_data_len);
    }
-finish:
-   return;
+
+   *copy = c;
+
+   return 0;
+
 error:
-   pgmoneta_log_fatal("Error: Could not read all page headers");
-   return;
+
+   pgmoneta_log_fatal("Error: Could not allocate memory for decoded");
+
+   if (c != NULL)
+   {
+      for (int i = 0; i <= c->max_block_id; i++)
+      {
+         free(c->blocks[i].bkp_image);
+         free(c->blocks[i].data);
+      }
+      free(c->main_data);
+      free(c);
+   }
+
+   return 1;
 }
 
 int
 pgmoneta_wal_parse_wal_file(char* path, int server, struct walfile* wal_file)
 {
-#define MALLOC(pointer, size) \
-        pointer = malloc(size); \
-        if (pointer == NULL) \
-        { \
-           pgmoneta_log_fatal("Error: Could not allocate memory for %s", #pointer); \
-           goto error; \
-        }
-
-   struct xlog_record* record = NULL;
-   struct xlog_long_page_header_data* long_header = NULL;
-   char* buffer = NULL;
+   struct wal_record_iterator* iterator = NULL;
+   struct decoded_xlog_record* record = NULL;
    struct decoded_xlog_record* decoded = NULL;
    struct xlog_page_header_data* page_header = NULL;
-   struct walinfo_configuration* config = NULL;
-   timeline_id tli = 0;
-   xlog_seg_no logSegNo = 0;
-   xlog_rec_ptr base;
-   int wal_segz_bytes = DEFAULT_WAL_SEGZ_BYTES;
-   char* temp_buffer = NULL;
+   uint32_t blcksz;
 
-   config = (struct walinfo_configuration*) shmem;
-
-   FILE* file = fopen(path, "rb");
-   if (file == NULL)
+   if (pgmoneta_wal_record_iterator_create(path, server, &iterator))
    {
-      pgmoneta_log_fatal("Error: Could not open file %s", path);
       goto error;
    }
 
-   // calculate the size of the file
-   fseek(file, 0, SEEK_END);
-   wal_segz_bytes = ftell(file);
-   fseek(file, 0, SEEK_SET);
-
-   MALLOC(long_header, SIZE_OF_XLOG_LONG_PHD);
-   size_t bytes_read = fread(long_header, SIZE_OF_XLOG_LONG_PHD, 1, file);
-
-   if (bytes_read < 1)
+   wal_file->long_phd = malloc(SIZE_OF_XLOG_LONG_PHD);
+   if (wal_file->long_phd == NULL)
    {
-      pgmoneta_log_error("Error: Failed to read the complete data");
+      pgmoneta_log_fatal("Error: Could not allocate memory for long_header");
       goto error;
    }
+   memcpy(wal_file->long_phd, iterator->long_phd, SIZE_OF_XLOG_LONG_PHD);
 
-   assert(magic_value_to_postgres_version(long_header->std.xlp_magic) != -1);
-
-   if (server == -1)
-   {
-      config->common.servers[0].version = magic_value_to_postgres_version(long_header->std.xlp_magic);
-      server_config = &config->common.servers[0];
-   }
-   else
+   blcksz = iterator->long_phd->xlp_xlog_blcksz;
+   for (size_t page = 1; page * blcksz + SIZE_OF_XLOG_SHORT_PHD <= iterator->size; page++)
    {
-      assert(config->common.servers[server].version == magic_value_to_postgres_version(long_header->std.xlp_magic));
-      server_config = &config->common.servers[server];
+      page_header = malloc(SIZE_OF_XLOG_SHORT_PHD);
+      if (page_header == NULL)
+      {
+         pgmoneta_log_fatal("Error: Could not allocate memory for page_header");
+         goto error;
+      }
+      memcpy(page_header, iterator->data + page * blcksz, SIZE_OF_XLOG_SHORT_PHD);
+      if (pgmoneta_deque_add(wal_file->page_headers, NULL, (uintptr_t) page_header, ValueRef))
+      {
+         goto error;
+      }
+      page_header = NULL;
    }
 
-   if (long_header->std.xlp_rem_len > 0)
+   while (true)
    {
-      decoded = malloc(sizeof(struct decoded_xlog_record));
-      if (decoded == NULL)
+      if (pgmoneta_wal_record_iterator_next(iterator, &record))
       {
-         pgmoneta_log_fatal("Error: Could not allocate memory for decoded");
          goto error;
       }
-      decoded->partial = true;
+
+      if (record == NULL)
+      {
+         break;
+      }
+
+      if (copy_record(record, &decoded))
+      {
+         goto error;
+      }
+
       if (pgmoneta_deque_add(wal_file->records, NULL, (uintptr_t) decoded, ValueRef))
       {
-         free(decoded);
-         decoded = NULL;
          goto error;
       }
       decoded = NULL;
    }
 
-   uint32_t next_record = MAXALIGN(
-      ftell(file) +
-      ((long_header->std.xlp_rem_len / long_header->xlp_xlog_blcksz) * SIZE_OF_XLOG_SHORT_PHD) +
-      long_header->std.xlp_rem_len % long_header->xlp_xlog_blcksz
-      );
-   int page_number = 0;
-   wal_file->long_phd = long_header;
-   long_header = NULL;
+   pgmoneta_wal_record_iterator_destroy(iterator);
 
-   read_all_page_headers(file, wal_file->long_phd, wal_file);
-   fseek(file, next_record, SEEK_SET);
+   return 0;
 
-   if (xlog_from_file_name(basename(path), &tli, &logSegNo, wal_segz_bytes))
+error:
+   free(page_header);
+   if (decoded != NULL)
    {
-      pgmoneta_log_fatal("Failed to extract LSN from the filename");
+      for (int i = 0; i <= decoded->max_block_id; i++)
+      {
+         free(decoded->blocks[i].bkp_image);
+         free(decoded->blocks[i].data);
+      }
+      free(decoded->main_data);
+      free(decoded);
+   }
+   pgmoneta_wal_record_iterator_destroy(iterator);
+   pgmoneta_log_fatal("Error: Could not parse WAL file");
+   return 1;
+}
+
+int
+pgmoneta_wal_record_iterator_create(char* path, int server, struct wal_record_iterator** iterator)
+{
+   struct wal_record_iterator* i = NULL;
+   struct walinfo_configuration* config = NULL;
+   int version;
+
+   config = (struct walinfo_configuration*) shmem;
+
+   *iterator = NULL;
+
+   i = calloc(1, sizeof(struct wal_record_iterator));
+   if (i == NULL)
+   {
+      pgmoneta_log_fatal("Error: Could not allocate memory for the WAL record iterator");
       goto error;
    }
-   XLOG_SEG_NO_OFFEST_TO_REC_PTR(logSegNo, 0, wal_segz_bytes, base);
+   i->fd = -1;
 
-   while (true)
+   if (open_walfile(i, path))
    {
-      // Check if next record is beyond the current page
-      if (next_record >= (wal_file->long_phd->xlp_xlog_blcksz * (page_number + 1)))
+      goto error;
+   }
+
+   version = magic_value_to_postgres_version(i->long_phd->std.xlp_magic);
+   if (version == -1)
+   {
+      pgmoneta_log_error("Error: WAL file %s holds no records", path);
+      goto error;
+   }
+
+   if (server == -1)
+   {
+      config->common.servers[0].version = version;
+      server_config = &config->common.servers[0];
+   }
+   else
+   {
+      if (config->common.servers[server].version != version)
       {
-         page_number++;
-         fseek(file, page_number * wal_file->long_phd->xlp_xlog_blcksz, SEEK_SET);
-         MALLOC(page_header, SIZE_OF_XLOG_SHORT_PHD);
-         bytes_read = fread(page_header, SIZE_OF_XLOG_SHORT_PHD, 1, file);
-         if (feof(file))
+         pgmoneta_log_error("Error: WAL file %s is from PostgreSQL %d, not %d", path, version, config->common.servers[server].version);
+         goto error;
+      }
+      server_config = &config->common.servers[server];
+   }
+
+   *iterator = i;
+
+   return 0;
+
+error:
+
+   pgmoneta_wal_record_iterator_destroy(i);
+
+   return 1;
+}
+
+int
+pgmoneta_wal_record_iterator_next(struct wal_record_iterator* iterator, struct decoded_xlog_record** record)
+{
+   struct xlog_page_header_data page_header;
+   struct xlog_record header;
+   size_t position;
+   size_t end_of_page;
+   size_t length;
+   size_t copied;
+   uint32_t data_length;
+   uint32_t blcksz;
+   xlog_rec_ptr lsn;
+   bool stitched = false;
+   char* data = NULL;
+
+   *record = NULL;
+
+   if (iterator == NULL || iterator->done)
+   {
+      return 0;
+   }
+
+   memset(&iterator->record, 0, sizeof(struct decoded_xlog_record));
+
+   if (iterator->partial)
+   {
+      iterator->partial = false;
+
+      if (iterator->carry_length > 0)
+      {
+         if (stitch_record(iterator, &stitched))
          {
-            decoded = calloc(1, sizeof(struct decoded_xlog_record));
-            if (decoded == NULL)
-            {
-               pgmoneta_log_fatal("Error: Could not allocate memory for decoded");
-               free(page_header);
-               page_header = NULL;
-               goto error;
-            }
-            decoded->partial = true;
-            if (pgmoneta_deque_add(wal_file->records, NULL, (uintptr_t) decoded, ValueRef))
-            {
-               free(decoded);
-               decoded = NULL;
-               free(page_header);
-               page_header = NULL;
-               goto error;
-            }
-            decoded = NULL;
-            free(page_header);
-            page_header = NULL;
-            goto finish;
+            goto error;
          }
-         if (bytes_read < 1)
+
+         if (stitched)
          {
-            pgmoneta_log_error("Error: Failed to read the complete data");
-            free(page_header);
-            page_header = NULL;
-            goto error;
+            *record = &iterator->record;
+            return 0;
          }
-         next_record = MAXALIGN(ftell(file) + page_header->xlp_rem_len);
-         free(page_header);
-         page_header = NULL;
-         continue;
       }
-      fseek(file, next_record, SEEK_SET);
-
-      // Check if record crosses the page boundary
-      if (ftell(file) + SIZE_OF_XLOG_RECORD > wal_file->long_phd->xlp_xlog_blcksz * (page_number + 1))
-      {
-         MALLOC(temp_buffer, SIZE_OF_XLOG_RECORD);
-         uint32_t end_of_page = (page_number + 1) * wal_file->long_phd->xlp_xlog_blcksz;
-         bytes_read = fread(temp_buffer, 1, end_of_page - ftell(file), file);
 
-         fseek(file, SIZE_OF_XLOG_SHORT_PHD, SEEK_CUR);
-         bytes_read += fread(temp_buffer + bytes_read, 1, SIZE_OF_XLOG_RECORD - bytes_read, file);
+      goto partial_record;
+   }
 
-         if (feof(file) && bytes_read != SIZE_OF_XLOG_RECORD)
-         {
-            free(temp_buffer);
-            temp_buffer = NULL;
-            decoded = calloc(1, sizeof(struct decoded_xlog_record));
-            if (decoded == NULL)
-            {
-               pgmoneta_log_fatal("Error: Could not allocate memory for decoded");
-               goto error;
-            }
-            decoded->partial = true;
-            if (pgmoneta_deque_add(wal_file->records, NULL, (uintptr_t) decoded, ValueRef))
-            {
-               free(decoded);
-               decoded = NULL;
-               goto error;
-            }
-            decoded = NULL;
-            goto finish;
-         }
+   blcksz = iterator->long_phd->xlp_xlog_blcksz;
 
-         assert(bytes_read == SIZE_OF_XLOG_RECORD);
-         record = (struct xlog_record*) temp_buffer;
-         temp_buffer = NULL;
-         page_number++;
+   // Move to the page holding the next record
+   while (iterator->next_record >= blcksz * (iterator->page_number + 1))
+   {
+      iterator->page_number++;
+      position = iterator->page_number * blcksz;
+      if (position + SIZE_OF_XLOG_SHORT_PHD > iterator->size)
+      {
+         iterator->done = true;
+         goto partial_record;
       }
-      else
+      memcpy(&page_header, iterator->data + position, SIZE_OF_XLOG_SHORT_PHD);
+      iterator->next_record = MAXALIGN(position + SIZE_OF_XLOG_SHORT_PHD + page_header.xlp_rem_len);
+   }
+
+   position = iterator->next_record;
+   end_of_page = (iterator->page_number + 1) * blcksz;
+
+   // Check if the record header crosses the page boundary
+   if (position + SIZE_OF_XLOG_RECORD > end_of_page)
+   {
+      length = end_of_page - position;
+      if (end_of_page + SIZE_OF_XLOG_SHORT_PHD + SIZE_OF_XLOG_RECORD - length > iterator->size)
       {
-         MALLOC(record, SIZE_OF_XLOG_RECORD);
-         bytes_read = fread(record, SIZE_OF_XLOG_RECORD, 1, file);
-         if (bytes_read < 1)
+         // The header continues in the next WAL file
+         if (end_of_page == iterator->size &&
+             save_carry(iterator, position + iterator->base, iterator->data + position, length, NULL, 0))
          {
-            pgmoneta_log_error("Error: Failed to read the complete data");
             goto error;
          }
+         iterator->done = true;
+         goto partial_record;
+      }
+      memcpy(&header, iterator->data + position, length);
+      memcpy((char*) &header + length, iterator->data + end_of_page + SIZE_OF_XLOG_SHORT_PHD, SIZE_OF_XLOG_RECORD - length);
+      position = end_of_page + SIZE_OF_XLOG_SHORT_PHD + SIZE_OF_XLOG_RECORD - length;
+      iterator->page_number++;
+   }
+   else
+   {
+      if (position + SIZE_OF_XLOG_RECORD > iterator->size)
+      {
+         pgmoneta_log_error("Error: Failed to read the complete data");
+         goto error;
       }
+      memcpy(&header, iterator->data + position, SIZE_OF_XLOG_RECORD);
+      position += SIZE_OF_XLOG_RECORD;
+   }
 
-      if (record->xl_tot_len == 0)
+   if (header.xl_tot_len == 0)
+   {
+      iterator->done = true;
+      return 0;
+   }
+
+   if (header.xl_tot_len < SIZE_OF_XLOG_RECORD)
+   {
+      pgmoneta_log_error("Error: Invalid record length %u", header.xl_tot_len);
+      goto error;
+   }
+
+   data_length = header.xl_tot_len - SIZE_OF_XLOG_RECORD;
+   lsn = position + iterator->base - SIZE_OF_XLOG_RECORD;
+   iterator->next_record = position + MAXALIGN(data_length);
+   end_of_page = (iterator->page_number + 1) * blcksz;
+
+   // Reassemble record data crossing page boundaries, otherwise decode it in place
+   if (data_length > 0 && data_length + position >= end_of_page)
+   {
+      if (ensure_buffer(&iterator->buffer, &iterator->buffer_size, data_length))
       {
-         free(record);
-         record = NULL;
-         break;
+         goto error;
       }
-      uint32_t data_length = record->xl_tot_len - SIZE_OF_XLOG_RECORD;
-      xlog_rec_ptr lsn = ftell(file) + base - SIZE_OF_XLOG_RECORD;
-      next_record = ftell(file) + MAXALIGN(record->xl_tot_len - SIZE_OF_XLOG_RECORD);
-      uint32_t end_of_page = (page_number + 1) * wal_file->long_phd->xlp_xlog_blcksz;
 
-      MALLOC(buffer, data_length);
+      length = end_of_page - position;
+      if (position + length > iterator->size)
+      {
+         iterator->done = true;
+         goto partial_record;
+      }
+      memcpy(iterator->buffer, iterator->data + position, length);
+      copied = length;
+      position += length;
 
-      // Read record data, possibly across page boundaries
-      if (data_length + ftell(file) >= end_of_page)
+      while (copied < data_length)
       {
-         size_t bytes_read = 0;
-         size_t total_bytes_read = 0;
-         uint32_t remaining_data_length = data_length;
-         bytes_read = fread(buffer, 1, end_of_page - ftell(file), file);
-         total_bytes_read += bytes_read;
-         remaining_data_length -= bytes_read;
-         while (remaining_data_length != 0)
+         if (position == iterator->size)
          {
-            if (feof(file))
+            // The data continues in the next WAL file
+            if (save_carry(iterator, lsn, (char*) &header, SIZE_OF_XLOG_RECORD, iterator->buffer, copied))
             {
-               free(record);
-               record = NULL;
-               decoded = calloc(1, sizeof(struct decoded_xlog_record));
-               if (decoded == NULL)
-               {
-                  pgmoneta_log_fatal("Error: Could not allocate memory for decoded");
-                  free(buffer);
-                  buffer = NULL;
-                  goto error;
-               }
-               decoded->partial = true;
-               if (pgmoneta_deque_add(wal_file->records, NULL, (uintptr_t) decoded, ValueRef))
-               {
-                  free(decoded);
-                  decoded = NULL;
-                  free(buffer);
-                  buffer = NULL;
-                  goto error;
-               }
-               decoded = NULL;
-               free(buffer);
-               buffer = NULL;
-               goto finish;
+               goto error;
             }
-            fseek(file, SIZE_OF_XLOG_SHORT_PHD, SEEK_CUR);
-            bytes_read = fread(buffer + total_bytes_read, 1,
-                               MIN(remaining_data_length, wal_file->long_phd->xlp_xlog_blcksz - SIZE_OF_XLOG_SHORT_PHD), file);
-            remaining_data_length -= bytes_read;
-            total_bytes_read += bytes_read;
+            iterator->done = true;
+            goto partial_record;
          }
-         assert(total_bytes_read == data_length);
-      }
-      else
-      {
-         bytes_read = fread(buffer, 1, data_length, file);
 
-         if (bytes_read != data_length)
+         position += SIZE_OF_XLOG_SHORT_PHD;
+         length = MIN(data_length - copied, blcksz - SIZE_OF_XLOG_SHORT_PHD);
+         if (position + length > iterator->size)
          {
-            pgmoneta_log_error("Error: Actual bytes read do not match the expected length");
-            goto error;
+            iterator->done = true;
+            goto partial_record;
          }
+         memcpy(iterator->buffer + copied, iterator->data + position, length);
+         copied += length;
+         position += length;
       }
 
-      decoded = calloc(1, sizeof(struct decoded_xlog_record));
-      if (decoded == NULL)
+      data = iterator->buffer;
+   }
+   else
+   {
+      if (position + data_length > iterator->size)
       {
-         pgmoneta_log_fatal("Error: Could not allocate memory for decoded");
+         pgmoneta_log_error("Error: Actual bytes read do not match the expected length");
          goto error;
       }
 
-      if (decode_xlog_record(buffer, decoded, record, wal_file->long_phd->xlp_xlog_blcksz, wal_file->long_phd->std.xlp_magic, lsn))
-      {
-         free(decoded);
-         decoded = NULL;
-         goto error;
-      }
-      else
+      data = iterator->data + position;
+   }
+
+   if (decode_record(iterator, data, &header, lsn))
+   {
+      goto error;
+   }
+
+   *record = &iterator->record;
+
+   return 0;
+
+partial_record:
+
+   iterator->record.partial = true;
+   *record = &iterator->record;
+
+   return 0;
+
+error:
+
+   iterator->done = true;
+
+   return 1;
+}
+
+int
+pgmoneta_wal_record_iterator_advance(struct wal_record_iterator* iterator, char* path)
+{
+   xlog_rec_ptr end;
+   uint16_t magic_value;
+
+   end = iterator->base + iterator->size;
+   magic_value = iterator->long_phd->std.xlp_magic;
+
+   close_walfile(iterator);
+
+   if (open_walfile(iterator, path))
+   {
+      goto error;
+   }
+
+   // A preallocated WAL file that was never written holds no records
+   if (iterator->long_phd->std.xlp_magic == 0)
+   {
+      iterator->carry_length = 0;
+      iterator->done = true;
+      return 0;
+   }
+
+   if (magic_value != 0 && iterator->long_phd->std.xlp_magic != magic_value)
+   {
+      pgmoneta_log_error("Error: WAL file %s is from another PostgreSQL version", path);
+      goto error;
+   }
+
+   // A cut record that can not be completed is returned as partial
+   if (iterator->carry_length > 0 && (iterator->base != end || !iterator->partial))
+   {
+      iterator->carry_length = 0;
+      iterator->partial = true;
+   }
+
+   return 0;
+
+error:
+
+   iterator->done = true;
+
+   return 1;
+}
+
+void
+pgmoneta_wal_record_iterator_destroy(struct wal_record_iterator* iterator)
+{
+   if (iterator == NULL)
+   {
+      return;
+   }
+
+   close_walfile(iterator);
+
+   free(iterator->buffer);
+   free(iterator->storage);
+   free(iterator->carry);
+   free(iterator);
+}
+
+static int
+open_walfile(struct wal_record_iterator* iterator, char* path)
+{
+   struct stat st;
+   timeline_id tli = 0;
+   xlog_seg_no logSegNo = 0;
+   size_t position;
+   size_t length;
+   uint32_t rem_len;
+   uint32_t blcksz;
+
+   iterator->fd = open(path, O_RDONLY);
+   if (iterator->fd == -1)
+   {
+      pgmoneta_log_fatal("Error: Could not open file %s", path);
+      goto error;
+   }
+
+   if (fstat(iterator->fd, &st) == -1)
+   {
+      pgmoneta_log_fatal("Error: Could not stat file %s", path);
+      goto error;
+   }
+   iterator->size = st.st_size;
+
+   if (iterator->size < SIZE_OF_XLOG_LONG_PHD)
+   {
+      pgmoneta_log_error("Error: Failed to read the complete data");
+      goto error;
+   }
+
+   iterator->data = mmap(NULL, iterator->size, PROT_READ, MAP_PRIVATE, iterator->fd, 0);
+   if (iterator->data == MAP_FAILED)
+   {
+      iterator->data = NULL;
+      pgmoneta_log_fatal("Error: Could not map file %s", path);
+      goto error;
+   }
+   madvise(iterator->data, iterator->size, MADV_SEQUENTIAL);
+
+   iterator->long_phd = (struct xlog_long_page_header_data*) iterator->data;
+
+   if (xlog_from_file_name(basename(path), &tli, &logSegNo, iterator->size))
+   {
+      pgmoneta_log_fatal("Failed to extract LSN from the filename");
+      goto error;
+   }
+   XLOG_SEG_NO_OFFEST_TO_REC_PTR(logSegNo, 0, iterator->size, iterator->base);
+
+   // A preallocated WAL file that was never written has no page header
+   if (iterator->long_phd->std.xlp_magic == 0)
+   {
+      iterator->done = true;
+      return 0;
+   }
+
+   if (magic_value_to_postgres_version(iterator->long_phd->std.xlp_magic) == -1)
+   {
+      pgmoneta_log_error("Error: WAL file %s has an invalid page magic 0x%04X", path, iterator->long_phd->std.xlp_magic);
+      goto error;
+   }
+
+   // The pages are walked by their size, so it must be usable
+   blcksz = iterator->long_phd->xlp_xlog_blcksz;
+   if (blcksz < SIZE_OF_XLOG_LONG_PHD || (blcksz & (blcksz - 1)) != 0)
+   {
+      pgmoneta_log_error("Error: WAL file %s has an invalid page size %u", path, blcksz);
+      goto error;
+   }
+
+   rem_len = iterator->long_phd->std.xlp_rem_len;
+
+   // Skip the end of a record continued from the previous WAL file
+   position = SIZE_OF_XLOG_LONG_PHD;
+   while (rem_len > 0)
+   {
+      if (position % blcksz == 0)
       {
-         if (pgmoneta_deque_add(wal_file->records, NULL, (uintptr_t) decoded, ValueRef))
-         {
-            free(decoded);
-            decoded = NULL;
-            goto error;
-         }
-         decoded = NULL;
+         position += SIZE_OF_XLOG_SHORT_PHD;
       }
-      free(buffer);
-      buffer = NULL;
-      free(record);
-      record = NULL;
+
+      length = MIN(rem_len, blcksz - position % blcksz);
+      position += length;
+      rem_len -= length;
    }
-finish:
-   fclose(file);
+
+   iterator->partial = iterator->long_phd->std.xlp_rem_len > 0;
+   iterator->next_record = MAXALIGN(position);
+   iterator->page_number = 0;
+   iterator->done = false;
+
    return 0;
 
 error:
-   // Cleanup all allocated resources
-   free(long_header);
-   free(page_header);
-   free(temp_buffer);
-   free(buffer);
-   free(record);
-   free(decoded);
-   if (file != NULL)
+
+   close_walfile(iterator);
+
+   return 1;
+}
+
+static void
+close_walfile(struct wal_record_iterator* iterator)
+{
+   if (iterator->data != NULL)
    {
-      fclose(file);
+      munmap(iterator->data, iterator->size);
    }
-   pgmoneta_log_fatal("Error: Could not parse WAL file");
+
+   if (iterator->fd != -1)
+   {
+      close(iterator->fd);
+   }
+
+   iterator->data = NULL;
+   iterator->fd = -1;
+   iterator->long_phd = NULL;
+}
+
+static int
+ensure_buffer(char** buffer, size_t* size, size_t length)
+{
+   char* b = NULL;
+
+   if (*size >= length)
+   {
+      return 0;
+   }
+
+   b = realloc(*buffer, length);
+   if (b == NULL)
+   {
+      pgmoneta_log_fatal("Error: Could not allocate memory for buffer");
+      return 1;
+   }
+
+   *buffer = b;
+   *size = length;
+
+   return 0;
+}
+
+static int
+decode_record(struct wal_record_iterator* iterator, char* data, struct xlog_record* header, xlog_rec_ptr lsn)
+{
+   size_t storage_size;
+
+   // Every block image, block data and main data starts at an aligned offset
+   storage_size = header->xl_tot_len - SIZE_OF_XLOG_RECORD + (2 * (XLR_MAX_BLOCK_ID + 1) + 1) * sizeof(void*);
+   if (ensure_buffer(&iterator->storage, &iterator->storage_size, storage_size))
+   {
+      return 1;
+   }
+
+   return decode_xlog_record(data, &iterator->record, header, iterator->long_phd->xlp_xlog_blcksz,
+                             iterator->long_phd->std.xlp_magic, lsn, iterator->storage);
+}
+
+static int
+save_carry(struct wal_record_iterator* iterator, xlog_rec_ptr lsn, char* header, size_t header_length, char* data, size_t data_length)
+{
+   if (ensure_buffer(&iterator->carry, &iterator->carry_size, header_length + data_length))
+   {
+      return 1;
+   }
+
+   memcpy(iterator->carry, header, header_length);
+   if (data_length > 0)
+   {
+      memcpy(iterator->carry + header_length, data, data_length);
+   }
+   iterator->carry_length = header_length + data_length;
+   iterator->carry_lsn = lsn;
+
+   return 0;
+}
+
+static int
+stitch_record(struct wal_record_iterator* iterator, bool* stitched)
+{
+   struct xlog_record header;
+   size_t position;
+   size_t total;
+   size_t length;
+   uint32_t blcksz;
+
+   *stitched = false;
+
+   blcksz = iterator->long_phd->xlp_xlog_blcksz;
+   total = iterator->carry_length + iterator->long_phd->std.xlp_rem_len;
+   position = SIZE_OF_XLOG_LONG_PHD;
+
+   if (ensure_buffer(&iterator->carry, &iterator->carry_size, total))
+   {
+      goto error;
+   }
+
+   // The rest of the record follows the page headers of this WAL file
+   while (iterator->carry_length < total)
+   {
+      if (position % blcksz == 0)
+      {
+         position += SIZE_OF_XLOG_SHORT_PHD;
+      }
+
+      length = MIN(total - iterator->carry_length, blcksz - position % blcksz);
+      if (position + length > iterator->size)
+      {
+         goto done;
+      }
+
+      memcpy(iterator->carry + iterator->carry_length, iterator->data + position, length);
+      iterator->carry_length += length;
+      position += length;
+   }
+
+   memcpy(&header, iterator->carry, SIZE_OF_XLOG_RECORD);
+   if (total < SIZE_OF_XLOG_RECORD || header.xl_tot_len != total)
+   {
+      goto done;
+   }
+
+   if (decode_record(iterator, iterator->carry + SIZE_OF_XLOG_RECORD, &header, iterator->carry_lsn))
+   {
+      goto error;
+   }
+
+   *stitched = true;
+
+done:
+
+   iterator->carry_length = 0;
+
+   return 0;
+
+error:
+
+   iterator->carry_length = 0;
+
    return 1;
 }
 
 static int
-decode_xlog_record(char* buffer, struct decoded_xlog_record* decoded, struct xlog_record* record, uint32_t block_size, uint16_t magic_value, xlog_rec_ptr lsn)
+decode_xlog_record(char* buffer, struct decoded_xlog_record* decoded, struct xlog_record* record, uint32_t block_size, uint16_t magic_value, xlog_rec_ptr lsn, char* storage)
 {
 #define COPY_HEADER_FIELD(_dst, _size)          \
         do {                                        \
@@ -691,27 +1081,23 @@ decode_xlog_record(char* buffer, struct decoded_xlog_record* decoded, struct xlo
 
       if (blk->has_image)
       {
-         /* no need to align image */
-         blk->bkp_image = malloc(blk->bimg_len);
+         blk->bkp_image = storage;
          memcpy(blk->bkp_image, ptr, blk->bimg_len);
          ptr += blk->bimg_len;
+         storage += MAXALIGN(blk->bimg_len);
       }
       if (blk->has_data)
       {
-         blk->data = malloc(blk->data_len);
+         blk->data = storage;
          memcpy(blk->data, ptr, blk->data_len);
          ptr += blk->data_len;
+         storage += MAXALIGN(blk->data_len);
       }
    }
 
    if (decoded->main_data_len > 0)
    {
-      decoded->main_data = malloc(decoded->main_data_len);
-      if (decoded->main_data == NULL)
-      {
-         goto
-         shortdata_err;
-      }
+      decoded->main_data = storage;
       memcpy(decoded->main_data, ptr, decoded->main_data_len);
       ptr += decoded->main_data_len;
    }
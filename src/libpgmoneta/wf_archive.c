@@ -31,6 +31,7 @@
 #include <achv.h>
 #include <logging.h>
 #include <utils.h>
+#include <workers.h>
 #include <workflow.h>
 
 /* system */
@@ -83,9 +84,9 @@ static int
 archive_execute(char* name __attribute__((unused)), struct art* nodes)
 {
    int server = -1;
+   bool stored = false;
    char* label = NULL;
    char* root = NULL;
-   char* base = NULL;
    char* src = NULL;
    char* dst = NULL;
    char* d_name = NULL;
@@ -105,17 +106,24 @@ archive_execute(char* name __attribute__((unused)), struct art* nodes)
    assert(pgmoneta_art_contains_key(nodes, NODE_SERVER_ID));
    assert(pgmoneta_art_contains_key(nodes, NODE_LABEL));
    assert(pgmoneta_art_contains_key(nodes, NODE_TARGET_ROOT));
-   assert(pgmoneta_art_contains_key(nodes, NODE_TARGET_BASE));
 #endif
 
    server = (int)pgmoneta_art_search(nodes, NODE_SERVER_ID);
    label = (char*)pgmoneta_art_search(nodes, NODE_LABEL);
    root = (char*)pgmoneta_art_search(nodes, NODE_TARGET_ROOT);
-   base = (char*)pgmoneta_art_search(nodes, NODE_TARGET_BASE);
 
    pgmoneta_log_debug("Archive (execute): %s/%s", config->common.servers[server].name, label);
 
-   src = pgmoneta_append(src, base);
+   // Without a restored directory the backup is read from the repository as stored
+   if (pgmoneta_art_contains_key(nodes, NODE_TARGET_BASE))
+   {
+      src = pgmoneta_append(src, (char*)pgmoneta_art_search(nodes, NODE_TARGET_BASE));
+   }
+   else
+   {
+      src = pgmoneta_get_server_backup_identifier_data(server, label);
+      stored = true;
+   }
 
    dst = pgmoneta_append(dst, root);
    if (!pgmoneta_ends_with(dst, "/"))
@@ -128,16 +136,47 @@ archive_execute(char* name __attribute__((unused)), struct art* nodes)
    dst = pgmoneta_append(dst, label);
    dst = pgmoneta_append(dst, ".tar");
 
+   if (config->compression_type == COMPRESSION_CLIENT_GZIP || config->compression_type == COMPRESSION_SERVER_GZIP)
+   {
+      dst = pgmoneta_append(dst, ".gz");
+   }
+   else if (config->compression_type == COMPRESSION_CLIENT_ZSTD || config->compression_type == COMPRESSION_SERVER_ZSTD)
+   {
+      dst = pgmoneta_append(dst, ".zstd");
+   }
+   else if (config->compression_type == COMPRESSION_CLIENT_LZ4 || config->compression_type == COMPRESSION_SERVER_LZ4)
+   {
+      dst = pgmoneta_append(dst, ".lz4");
+   }
+   else if (config->compression_type == COMPRESSION_CLIENT_BZIP2)
+   {
+      dst = pgmoneta_append(dst, ".bz2");
+   }
+
+   if (config->encryption != ENCRYPTION_NONE)
+   {
+      dst = pgmoneta_append(dst, ".aes");
+   }
+
    d_name = pgmoneta_append(d_name, config->common.servers[server].name);
    d_name = pgmoneta_append(d_name, "-");
    d_name = pgmoneta_append(d_name, label);
 
+   if (!pgmoneta_exists(root))
+   {
+      if (pgmoneta_mkdir(root))
+      {
+         pgmoneta_log_error("Unable to create target root directory %s", root);
+         goto error;
+      }
+   }
+
    if (pgmoneta_exists(dst))
    {
       pgmoneta_delete_file(dst, NULL);
    }
 
-   if (pgmoneta_tar_directory(src, dst, d_name))
+   if (pgmoneta_tar_directory(src, dst, d_name, stored, pgmoneta_get_number_of_workers(server)))
    {
       goto error;
    }
@@ -183,7 +222,6 @@ archive_teardown(char* name __attribute__((unused)), struct art* nodes)
    assert(nodes != NULL);
    assert(pgmoneta_art_contains_key(nodes, NODE_SERVER_ID));
    assert(pgmoneta_art_contains_key(nodes, NODE_LABEL));
-   assert(pgmoneta_art_contains_key(nodes, NODE_TARGET_BASE));
 #endif
 
    server = (int)pgmoneta_art_search(nodes, NODE_SERVER_ID);
@@ -191,11 +229,14 @@ archive_teardown(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_log_debug("Archive (teardown): %s/%s", config->common.servers[server].name, label);
 
-   destination = (char*)pgmoneta_art_search(nodes, NODE_TARGET_BASE);
-
-   if (pgmoneta_exists(destination))
+   if (pgmoneta_art_contains_key(nodes, NODE_TARGET_BASE))
    {
-      pgmoneta_delete_directory(destination);
+      destination = (char*)pgmoneta_art_search(nodes, NODE_TARGET_BASE);
+
+      if (pgmoneta_exists(destination))
+      {
+         pgmoneta_delete_directory(destination);
+      }
    }
 
    return 0;
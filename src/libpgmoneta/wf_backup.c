@@ -32,10 +32,13 @@
 #include <backup.h>
 #include <logging.h>
 #include <network.h>
+#include <parallel.h>
 #include <security.h>
 #include <server.h>
+#include <streamer.h>
 #include <tablespace.h>
 #include <utils.h>
+#include <workers.h>
 #include <workflow.h>
 
 /* system */
@@ -47,6 +50,8 @@
 static char* basebackup_name(void);
 static int basebackup_execute(char*, struct art*);
 
+static bool use_streaming(int server, bool incremental);
+static bool use_parallel(int server, bool incremental);
 static int send_upload_manifest(SSL* ssl, int socket);
 static int upload_manifest(SSL* ssl, int socket, char* path);
 
@@ -115,9 +120,11 @@ basebackup_execute(char* name __attribute__((unused)), struct art* nodes)
    int network_max_rate;
    int hash;
    uint64_t biggest_file_size;
+   bool parallel = false;
    struct main_configuration* config;
    struct message* basebackup_msg = NULL;
    struct message* tablespace_msg = NULL;
+   struct message* recovery_msg = NULL;
    struct stream_buffer* buffer = NULL;
    struct query_response* response = NULL;
    struct tablespace* tablespaces = NULL;
@@ -125,6 +132,9 @@ basebackup_execute(char* name __attribute__((unused)), struct art* nodes)
    struct tuple* tup = NULL;
    struct token_bucket* bucket = NULL;
    struct token_bucket* network_bucket = NULL;
+   struct streamer* streamer = NULL;
+   struct info_transaction* info = NULL;
+   struct parallel_result parallel_result;
 
    config = (struct main_configuration*)shmem;
 
@@ -248,125 +258,183 @@ basebackup_execute(char* name __attribute__((unused)), struct art* nodes)
    }
    pgmoneta_free_query_response(response);
    response = NULL;
+
+   parallel = use_parallel(server, incremental != NULL);
+   if (parallel)
+   {
+      // pg_backup_start can't be used on a standby for the WAL of the backup
+      pgmoneta_create_query_message("SELECT pg_is_in_recovery();", &recovery_msg);
+      if (pgmoneta_query_execute(ssl, socket, recovery_msg, &response) || response == NULL)
+      {
+         goto error;
+      }
+
+      if (response->tuples != NULL && response->tuples->data[0] != NULL && !strcmp(response->tuples->data[0], "t"))
+      {
+         pgmoneta_log_debug("Backup: %s is in recovery, using a single connection", config->common.servers[server].name);
+         parallel = false;
+      }
+      pgmoneta_free_query_response(response);
+      response = NULL;
+   }
+
    pgmoneta_close_ssl(ssl);
    pgmoneta_disconnect(socket);
+   ssl = NULL;
+   socket = -1;
 
-   if (pgmoneta_server_authenticate(server, "postgres", config->common.users[usr].username, config->common.users[usr].password, true, &ssl, &socket) != AUTH_SUCCESS)
+   hash = config->common.servers[server].manifest;
+   if (hash == HASH_ALGORITHM_DEFAULT)
    {
-      pgmoneta_log_info("Invalid credentials for %s", config->common.users[usr].username);
-      goto error;
+      hash = config->manifest;
    }
 
-   pgmoneta_memory_stream_buffer_init(&buffer);
+   if (parallel)
+   {
+      backup_base = pgmoneta_get_server_backup_identifier(server, label);
+
+      pgmoneta_mkdir(backup_base);
+      if (pgmoneta_parallel_backup(server, usr, label, backup_base, tablespaces, hash, pgmoneta_get_number_of_workers(server),
+                                   bucket, network_bucket, &parallel_result))
+      {
+         pgmoneta_log_error("Backup: Could not backup %s", config->common.servers[server].name);
 
-   if (incremental != NULL)
+         pgmoneta_create_info(backup_base, label, 0);
+
+         goto error;
+      }
+
+      memset(startpos, 0, sizeof(startpos));
+      memcpy(startpos, parallel_result.startpos, strlen(parallel_result.startpos));
+      start_timeline = parallel_result.start_timeline;
+      memset(endpos, 0, sizeof(endpos));
+      memcpy(endpos, parallel_result.endpos, strlen(parallel_result.endpos));
+      end_timeline = parallel_result.end_timeline;
+   }
+   else
    {
-      // send UPLOAD_MANIFEST
-      if (send_upload_manifest(ssl, socket))
+      if (pgmoneta_server_authenticate(server, "postgres", config->common.users[usr].username, config->common.users[usr].password, true, &ssl, &socket) != AUTH_SUCCESS)
       {
-         pgmoneta_log_error("Fail to send UPLOAD_MANIFEST to server %s", config->common.servers[server].name);
+         pgmoneta_log_info("Invalid credentials for %s", config->common.users[usr].username);
          goto error;
       }
-      manifest_path = pgmoneta_append(NULL, incremental);
-      manifest_path = pgmoneta_append(manifest_path, "data/backup_manifest");
-      old_manifest_path = pgmoneta_append(NULL, incremental);
-      old_manifest_path = pgmoneta_append(old_manifest_path, "backup_manifest.old");
-
-      // use the old manifest because postgres doesn't recognize our own manifest,
-      // we can remove this when we have a format converter
-      if (pgmoneta_exists(old_manifest_path))
+
+      pgmoneta_memory_stream_buffer_init(&buffer);
+
+      if (incremental != NULL)
       {
-         if (upload_manifest(ssl, socket, old_manifest_path))
+         // send UPLOAD_MANIFEST
+         if (send_upload_manifest(ssl, socket))
          {
-            pgmoneta_log_error("Fail to upload manifest to server %s", config->common.servers[server].name);
+            pgmoneta_log_error("Fail to send UPLOAD_MANIFEST to server %s", config->common.servers[server].name);
             goto error;
          }
-      }
-      else
-      {
-         if (upload_manifest(ssl, socket, manifest_path))
+         manifest_path = pgmoneta_append(NULL, incremental);
+         manifest_path = pgmoneta_append(manifest_path, "data/backup_manifest");
+         old_manifest_path = pgmoneta_append(NULL, incremental);
+         old_manifest_path = pgmoneta_append(old_manifest_path, "backup_manifest.old");
+
+         // use the old manifest because postgres doesn't recognize our own manifest,
+         // we can remove this when we have a format converter
+         if (pgmoneta_exists(old_manifest_path))
+         {
+            if (upload_manifest(ssl, socket, old_manifest_path))
+            {
+               pgmoneta_log_error("Fail to upload manifest to server %s", config->common.servers[server].name);
+               goto error;
+            }
+         }
+         else
+         {
+            if (upload_manifest(ssl, socket, manifest_path))
+            {
+               pgmoneta_log_error("Fail to upload manifest to server %s", config->common.servers[server].name);
+               goto error;
+            }
+         }
+
+         // receive and ignore the result set for UPLOAD_MANIFEST
+         if (pgmoneta_consume_data_row_messages(ssl, socket, buffer, &response))
          {
-            pgmoneta_log_error("Fail to upload manifest to server %s", config->common.servers[server].name);
             goto error;
          }
+         pgmoneta_free_query_response(response);
+         response = NULL;
+      }
+
+      tag = pgmoneta_append(tag, "pgmoneta_");
+      tag = pgmoneta_append(tag, label);
+
+      pgmoneta_create_base_backup_message(config->common.servers[server].version, incremental != NULL, tag, true, hash,
+                                          config->compression_type, config->compression_level,
+                                          &basebackup_msg);
+
+      status = pgmoneta_write_message(ssl, socket, basebackup_msg);
+      if (status != MESSAGE_STATUS_OK)
+      {
+         goto error;
       }
 
-      // receive and ignore the result set for UPLOAD_MANIFEST
+      // Receive the first result set, which contains the WAL starting point
       if (pgmoneta_consume_data_row_messages(ssl, socket, buffer, &response))
       {
          goto error;
       }
+      memset(startpos, 0, sizeof(startpos));
+      memcpy(startpos, response->tuples[0].data[0], strlen(response->tuples[0].data[0]));
+      start_timeline = atoi(response->tuples[0].data[1]);
       pgmoneta_free_query_response(response);
       response = NULL;
-   }
 
-   tag = pgmoneta_append(tag, "pgmoneta_");
-   tag = pgmoneta_append(tag, label);
-
-   hash = config->common.servers[server].manifest;
-   if (hash == HASH_ALGORITHM_DEFAULT)
-   {
-      hash = config->manifest;
-   }
-
-   pgmoneta_create_base_backup_message(config->common.servers[server].version, incremental != NULL, tag, true, hash,
-                                       config->compression_type, config->compression_level,
-                                       &basebackup_msg);
-
-   status = pgmoneta_write_message(ssl, socket, basebackup_msg);
-   if (status != MESSAGE_STATUS_OK)
-   {
-      goto error;
-   }
-
-   // Receive the first result set, which contains the WAL starting point
-   if (pgmoneta_consume_data_row_messages(ssl, socket, buffer, &response))
-   {
-      goto error;
-   }
-   memset(startpos, 0, sizeof(startpos));
-   memcpy(startpos, response->tuples[0].data[0], strlen(response->tuples[0].data[0]));
-   start_timeline = atoi(response->tuples[0].data[1]);
-   pgmoneta_free_query_response(response);
-   response = NULL;
-
-   // create the root dir
-   backup_base = pgmoneta_get_server_backup_identifier(server, label);
+      // create the root dir
+      backup_base = pgmoneta_get_server_backup_identifier(server, label);
 
-   pgmoneta_mkdir(backup_base);
-   if (config->common.servers[server].version < 15)
-   {
-      if (pgmoneta_receive_archive_files(ssl, socket, buffer, backup_base, tablespaces, bucket, network_bucket))
+      pgmoneta_mkdir(backup_base);
+      if (config->common.servers[server].version < 15)
       {
-         pgmoneta_log_error("Backup: Could not backup %s", config->common.servers[server].name);
+         if (pgmoneta_receive_archive_files(ssl, socket, buffer, backup_base, tablespaces, bucket, network_bucket))
+         {
+            pgmoneta_log_error("Backup: Could not backup %s", config->common.servers[server].name);
 
-         pgmoneta_create_info(backup_base, label, 0);
+            pgmoneta_create_info(backup_base, label, 0);
 
-         goto error;
+            goto error;
+         }
       }
-   }
-   else
-   {
-      if (pgmoneta_receive_archive_stream(ssl, socket, buffer, backup_base, tablespaces, bucket, network_bucket))
+      else
       {
-         pgmoneta_log_error("Backup: Could not backup %s", config->common.servers[server].name);
+         if (use_streaming(server, incremental != NULL))
+         {
+            if (pgmoneta_streamer_create(server, backup_base, &streamer))
+            {
+               goto error;
+            }
+         }
 
-         pgmoneta_create_info(backup_base, label, 0);
+         if (pgmoneta_receive_archive_stream(ssl, socket, buffer, backup_base, tablespaces, bucket, network_bucket, streamer))
+         {
+            pgmoneta_log_error("Backup: Could not backup %s", config->common.servers[server].name);
+
+            pgmoneta_create_info(backup_base, label, 0);
 
+            goto error;
+         }
+      }
+
+      // Receive the final result set, which contains the WAL ending point
+      if (pgmoneta_consume_data_row_messages(ssl, socket, buffer, &response))
+      {
          goto error;
       }
-   }
+      memset(endpos, 0, sizeof(endpos));
+      memcpy(endpos, response->tuples[0].data[0], strlen(response->tuples[0].data[0]));
+      end_timeline = atoi(response->tuples[0].data[1]);
+      pgmoneta_free_query_response(response);
+      response = NULL;
 
-   // Receive the final result set, which contains the WAL ending point
-   if (pgmoneta_consume_data_row_messages(ssl, socket, buffer, &response))
-   {
-      goto error;
+      // receive and ignore the last result set, it's just a summary
+      pgmoneta_consume_data_row_messages(ssl, socket, buffer, &response);
    }
-   memset(endpos, 0, sizeof(endpos));
-   memcpy(endpos, response->tuples[0].data[0], strlen(response->tuples[0].data[0]));
-   end_timeline = atoi(response->tuples[0].data[1]);
-   pgmoneta_free_query_response(response);
-   response = NULL;
 
    // remove backup_label.old if it exists
    memset(old_label_path, 0, MAX_PATH);
@@ -391,9 +459,6 @@ basebackup_execute(char* name __attribute__((unused)), struct art* nodes)
       }
    }
 
-   // receive and ignore the last result set, it's just a summary
-   pgmoneta_consume_data_row_messages(ssl, socket, buffer, &response);
-
 #ifdef HAVE_FREEBSD
    clock_gettime(CLOCK_MONOTONIC_FAST, &end_t);
 #else
@@ -412,7 +477,12 @@ basebackup_execute(char* name __attribute__((unused)), struct art* nodes)
 
    backup_data = pgmoneta_get_server_backup_identifier_data(server, label);
 
-   if (!incremental)
+   if (streamer != NULL)
+   {
+      size = streamer->total_size;
+      biggest_file_size = streamer->biggest_file_size;
+   }
+   else if (!incremental)
    {
       size = pgmoneta_directory_size(backup_data);
       biggest_file_size = pgmoneta_biggest_file(backup_data);
@@ -438,33 +508,51 @@ basebackup_execute(char* name __attribute__((unused)), struct art* nodes)
       goto error;
    }
 
-   pgmoneta_create_info(backup_base, label, 1);
-   pgmoneta_update_info_string(backup_base, INFO_WAL, wal);
-   pgmoneta_update_info_unsigned_long(backup_base, INFO_RESTORE, size);
-   pgmoneta_update_info_unsigned_long(backup_base, INFO_BIGGEST_FILE, biggest_file_size);
-   pgmoneta_update_info_string(backup_base, INFO_MAJOR_VERSION, version);
-   pgmoneta_update_info_string(backup_base, INFO_MINOR_VERSION, minor_version);
-   pgmoneta_update_info_bool(backup_base, INFO_KEEP, false);
-   pgmoneta_update_info_string(backup_base, INFO_START_WALPOS, startpos);
-   pgmoneta_update_info_string(backup_base, INFO_END_WALPOS, endpos);
-   pgmoneta_update_info_unsigned_long(backup_base, INFO_START_TIMELINE, start_timeline);
-   pgmoneta_update_info_unsigned_long(backup_base, INFO_END_TIMELINE, end_timeline);
-   pgmoneta_update_info_unsigned_long(backup_base, INFO_HASH_ALGORITHM, hash);
-   pgmoneta_update_info_double(backup_base, INFO_BASEBACKUP_ELAPSED, basebackup_elapsed_time);
+   if (streamer != NULL)
+   {
+      if (pgmoneta_art_insert(nodes, NODE_STREAMED, (uintptr_t)true, ValueBool))
+      {
+         goto error;
+      }
+
+      if (pgmoneta_art_insert(nodes, NODE_SHA512, (uintptr_t)streamer->hashes, ValueART))
+      {
+         goto error;
+      }
+      streamer->hashes = NULL;
+   }
+
+   if (pgmoneta_info_begin_new(backup_base, label, 1, &info))
+   {
+      goto error;
+   }
+
+   pgmoneta_info_set_string(info, INFO_WAL, wal);
+   pgmoneta_info_set_unsigned_long(info, INFO_RESTORE, size);
+   pgmoneta_info_set_unsigned_long(info, INFO_BIGGEST_FILE, biggest_file_size);
+   pgmoneta_info_set_string(info, INFO_MAJOR_VERSION, version);
+   pgmoneta_info_set_string(info, INFO_MINOR_VERSION, minor_version);
+   pgmoneta_info_set_bool(info, INFO_KEEP, false);
+   pgmoneta_info_set_string(info, INFO_START_WALPOS, startpos);
+   pgmoneta_info_set_string(info, INFO_END_WALPOS, endpos);
+   pgmoneta_info_set_unsigned_long(info, INFO_START_TIMELINE, start_timeline);
+   pgmoneta_info_set_unsigned_long(info, INFO_END_TIMELINE, end_timeline);
+   pgmoneta_info_set_unsigned_long(info, INFO_HASH_ALGORITHM, hash);
+   pgmoneta_info_set_double(info, INFO_BASEBACKUP_ELAPSED, basebackup_elapsed_time);
 
    if (incremental != NULL)
    {
-      pgmoneta_update_info_unsigned_long(backup_base, INFO_TYPE, TYPE_INCREMENTAL);
-      pgmoneta_update_info_string(backup_base, INFO_PARENT, incremental_label);
+      pgmoneta_info_set_unsigned_long(info, INFO_TYPE, TYPE_INCREMENTAL);
+      pgmoneta_info_set_string(info, INFO_PARENT, incremental_label);
    }
    else
    {
-      pgmoneta_update_info_unsigned_long(backup_base, INFO_TYPE, TYPE_FULL);
+      pgmoneta_info_set_unsigned_long(info, INFO_TYPE, TYPE_FULL);
    }
    // in case of parsing error
    if (chkptpos != NULL)
    {
-      pgmoneta_update_info_string(backup_base, INFO_CHKPT_WALPOS, chkptpos);
+      pgmoneta_info_set_string(info, INFO_CHKPT_WALPOS, chkptpos);
    }
 
    current_tablespace = tablespaces;
@@ -476,19 +564,27 @@ basebackup_execute(char* name __attribute__((unused)), struct art* nodes)
       snprintf(&tblname[0], MAX_PATH, "tblspc_%s", current_tablespace->name);
 
       number_of_tablespaces++;
-      pgmoneta_update_info_unsigned_long(backup_base, INFO_TABLESPACES, number_of_tablespaces);
+      pgmoneta_info_set_unsigned_long(info, INFO_TABLESPACES, number_of_tablespaces);
 
       snprintf(key, sizeof(key) - 1, "TABLESPACE%d", number_of_tablespaces);
-      pgmoneta_update_info_string(backup_base, key, tblname);
+      pgmoneta_info_set_string(info, key, tblname);
 
       snprintf(key, sizeof(key) - 1, "TABLESPACE_OID%d", number_of_tablespaces);
-      pgmoneta_update_info_unsigned_long(backup_base, key, current_tablespace->oid);
+      pgmoneta_info_set_unsigned_long(info, key, current_tablespace->oid);
 
       snprintf(key, sizeof(key) - 1, "TABLESPACE_PATH%d", number_of_tablespaces);
-      pgmoneta_update_info_string(backup_base, key, current_tablespace->path);
+      pgmoneta_info_set_string(info, key, current_tablespace->path);
 
       current_tablespace = current_tablespace->next;
    }
+
+   if (pgmoneta_info_commit(info))
+   {
+      goto error;
+   }
+   pgmoneta_info_destroy(info);
+   info = NULL;
+
    pgmoneta_close_ssl(ssl);
    if (socket != -1)
    {
@@ -499,9 +595,11 @@ basebackup_execute(char* name __attribute__((unused)), struct art* nodes)
    pgmoneta_free_tablespaces(tablespaces);
    pgmoneta_free_message(basebackup_msg);
    pgmoneta_free_message(tablespace_msg);
+   pgmoneta_free_message(recovery_msg);
    pgmoneta_free_query_response(response);
    pgmoneta_token_bucket_destroy(bucket);
    pgmoneta_token_bucket_destroy(network_bucket);
+   pgmoneta_streamer_destroy(streamer);
    free(backup_base);
    free(backup_data);
    free(manifest_path);
@@ -535,9 +633,12 @@ error:
    pgmoneta_free_tablespaces(tablespaces);
    pgmoneta_free_message(basebackup_msg);
    pgmoneta_free_message(tablespace_msg);
+   pgmoneta_free_message(recovery_msg);
    pgmoneta_free_query_response(response);
    pgmoneta_token_bucket_destroy(bucket);
    pgmoneta_token_bucket_destroy(network_bucket);
+   pgmoneta_streamer_destroy(streamer);
+   pgmoneta_info_destroy(info);
    free(backup_base);
    free(backup_data);
    free(manifest_path);
@@ -549,6 +650,58 @@ error:
    return 1;
 }
 
+static bool
+use_streaming(int server, bool incremental)
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (!config->backup_streaming || incremental)
+   {
+      return false;
+   }
+
+   // the compressed stream is extracted by libarchive
+   if (config->compression_type == COMPRESSION_SERVER_GZIP ||
+       config->compression_type == COMPRESSION_SERVER_LZ4 ||
+       config->compression_type == COMPRESSION_SERVER_ZSTD)
+   {
+      return false;
+   }
+
+   // hot standby copies the raw files of the backup
+   if (strlen(config->common.servers[server].hot_standby) > 0)
+   {
+      return false;
+   }
+
+   return true;
+}
+
+static bool
+use_parallel(int server, bool incremental)
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (!config->backup_parallel || incremental)
+   {
+      return false;
+   }
+
+   // the server side compression is part of the replication protocol
+   if (config->compression_type == COMPRESSION_SERVER_GZIP ||
+       config->compression_type == COMPRESSION_SERVER_LZ4 ||
+       config->compression_type == COMPRESSION_SERVER_ZSTD)
+   {
+      return false;
+   }
+
+   return pgmoneta_get_number_of_workers(server) > 1;
+}
+
 static int
 send_upload_manifest(SSL* ssl, int socket)
 {
@@ -30,6 +30,7 @@
 #include <pgmoneta.h>
 #include <bzip2_compression.h>
 #include <logging.h>
+#include <security.h>
 #include <utils.h>
 #include <workflow.h>
 
@@ -41,6 +42,7 @@
 static char* bzip2_name(void);
 static int bzip2_execute_compress(char*, struct art*);
 static int bzip2_execute_uncompress(char*, struct art*);
+static int bzip2_teardown_compress(char*, struct art*);
 
 struct workflow*
 pgmoneta_create_bzip2(bool compress)
@@ -60,13 +62,14 @@ pgmoneta_create_bzip2(bool compress)
    if (compress == true)
    {
       wf->execute = &bzip2_execute_compress;
+      wf->teardown = &bzip2_teardown_compress;
    }
    else
    {
       wf->execute = &bzip2_execute_uncompress;
+      wf->teardown = &pgmoneta_common_teardown;
    }
 
-   wf->teardown = &pgmoneta_common_teardown;
    wf->next = NULL;
 
    return wf;
@@ -119,6 +122,14 @@ bzip2_execute_compress(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_log_debug("BZip2 (compress): %s/%s", config->common.servers[server].name, label);
 
+   if ((bool)pgmoneta_art_search(nodes, NODE_STREAMED))
+   {
+      pgmoneta_log_debug("BZip2 (compress): %s/%s was compressed while streaming", config->common.servers[server].name, label);
+      return 0;
+   }
+
+   pgmoneta_hash_collector_start(config->storage_engine & STORAGE_ENGINE_SSH);
+
 #ifdef HAVE_FREEBSD
    clock_gettime(CLOCK_MONOTONIC_FAST, &start_t);
 #else
@@ -192,6 +203,15 @@ bzip2_execute_compress(char* name __attribute__((unused)), struct art* nodes)
    return ret;
 }
 
+static int
+bzip2_teardown_compress(char* name, struct art* nodes)
+{
+   // the hash stages have used the digests collected while writing
+   pgmoneta_hash_collector_stop();
+
+   return pgmoneta_common_teardown(name, nodes);
+}
+
 static int
 bzip2_execute_uncompress(char* name __attribute__((unused)), struct art* nodes)
 {
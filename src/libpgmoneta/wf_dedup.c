@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* pgmoneta */
+#include <pgmoneta.h>
+#include <dedup.h>
+#include <info.h>
+#include <logging.h>
+#include <utils.h>
+#include <workflow.h>
+
+/* system */
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char* dedup_name(void);
+static int dedup_execute(char*, struct art*);
+
+struct workflow*
+pgmoneta_create_dedup(void)
+{
+   struct workflow* wf = NULL;
+
+   wf = (struct workflow*)malloc(sizeof(struct workflow));
+
+   if (wf == NULL)
+   {
+      return NULL;
+   }
+
+   wf->name = &dedup_name;
+   wf->setup = &pgmoneta_common_setup;
+   wf->execute = &dedup_execute;
+   wf->teardown = &pgmoneta_common_teardown;
+   wf->next = NULL;
+
+   return wf;
+}
+
+static char*
+dedup_name(void)
+{
+   return "Deduplicate";
+}
+
+static int
+dedup_execute(char* name __attribute__((unused)), struct art* nodes)
+{
+   int server = -1;
+   char* label = NULL;
+   struct timespec start_t;
+   struct timespec end_t;
+   double elapsed_time;
+   int hours;
+   int minutes;
+   double seconds;
+   char elapsed[128];
+   uint64_t size = 0;
+   char* s = NULL;
+   struct backup* backup = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+#ifdef DEBUG
+   if (pgmoneta_log_is_enabled(PGMONETA_LOGGING_LEVEL_DEBUG1))
+   {
+      char* a = NULL;
+      a = pgmoneta_art_to_string(nodes, FORMAT_TEXT, NULL, 0);
+      pgmoneta_log_debug("(Tree)\n%s", a);
+      free(a);
+   }
+   assert(nodes != NULL);
+   assert(pgmoneta_art_contains_key(nodes, NODE_SERVER_ID));
+   assert(pgmoneta_art_contains_key(nodes, NODE_LABEL));
+#endif
+
+   server = (int)pgmoneta_art_search(nodes, NODE_SERVER_ID);
+   label = (char*)pgmoneta_art_search(nodes, NODE_LABEL);
+
+   pgmoneta_log_debug("Deduplicate (execute): %s/%s", config->common.servers[server].name, label);
+
+   if (pgmoneta_get_backup_server(server, label, &backup) || backup == NULL)
+   {
+      pgmoneta_log_error("Deduplicate: Unable to read %s/%s", config->common.servers[server].name, label);
+      goto error;
+   }
+
+   /* Incremental backups only hold the changed blocks, and are read through their full backup */
+   if (backup->type != TYPE_FULL)
+   {
+      free(backup);
+      return 0;
+   }
+
+#ifdef HAVE_FREEBSD
+   clock_gettime(CLOCK_MONOTONIC_FAST, &start_t);
+#else
+   clock_gettime(CLOCK_MONOTONIC_RAW, &start_t);
+#endif
+
+   if (pgmoneta_dedup_backup(server, label, &size))
+   {
+      pgmoneta_log_error("Deduplicate: Unable to store %s/%s in the chunk store", config->common.servers[server].name, label);
+      goto error;
+   }
+
+#ifdef HAVE_FREEBSD
+   clock_gettime(CLOCK_MONOTONIC_FAST, &end_t);
+#else
+   clock_gettime(CLOCK_MONOTONIC_RAW, &end_t);
+#endif
+
+   elapsed_time = pgmoneta_compute_duration(start_t, end_t);
+
+   hours = elapsed_time / 3600;
+   minutes = ((int)elapsed_time % 3600) / 60;
+   seconds = (int)elapsed_time % 60 + (elapsed_time - ((long)elapsed_time));
+
+   memset(&elapsed[0], 0, sizeof(elapsed));
+   sprintf(&elapsed[0], "%02i:%02i:%.4f", hours, minutes, seconds);
+
+   s = pgmoneta_translate_file_size(size);
+
+   pgmoneta_log_info("Deduplicate: %s/%s (Added: %s, Elapsed: %s)", config->common.servers[server].name, label, s, &elapsed[0]);
+
+   free(s);
+   free(backup);
+
+   return 0;
+
+error:
+
+   free(backup);
+
+   return 1;
+}
@@ -31,9 +31,11 @@
 #include "management.h"
 #include "value.h"
 #include <pgmoneta.h>
+#include <dedup.h>
 #include <link.h>
 #include <logging.h>
 #include <restore.h>
+#include <space.h>
 #include <utils.h>
 #include <workflow.h>
 
@@ -206,6 +208,7 @@ done:
          if (pgmoneta_exists(hs))
          {
             pgmoneta_delete_directory(hs);
+            pgmoneta_space_invalidate(server, SPACE_HOT_STANDBY);
 
             pgmoneta_log_info("Hot standby deleted: %s", config->common.servers[server].name);
          }
@@ -258,7 +261,10 @@ delete_backup(int server, int index, struct backup* backup __attribute__((unused
    char* from = NULL;
    char* to = NULL;
    char* d = NULL;
+   char* next = NULL;
    unsigned long size;
+   unsigned long deleted;
+   unsigned long previous;
    int number_of_workers = 0;
    struct workers* workers = NULL;
    struct main_configuration* config;
@@ -295,8 +301,16 @@ delete_backup(int server, int index, struct backup* backup __attribute__((unused
       pgmoneta_log_trace("Next label: %s/%s", config->common.servers[server].name, backups[next_index]->label);
    }
 
+   if (pgmoneta_dedup_release(server, backups[index]->label))
+   {
+      pgmoneta_log_error("Delete: Unable to release %s/%s from the chunk store", config->common.servers[server].name, backups[index]->label);
+      goto error;
+   }
+
    d = pgmoneta_get_server_backup_identifier(server, backups[index]->label);
 
+   deleted = pgmoneta_directory_size(d);
+
    number_of_workers = pgmoneta_get_number_of_workers(server);
    if (number_of_workers > 0)
    {
@@ -311,6 +325,12 @@ delete_backup(int server, int index, struct backup* backup __attribute__((unused
          from = pgmoneta_get_server_backup_identifier_data(server, backups[index]->label);
          to = pgmoneta_get_server_backup_identifier_data(server, backups[next_index]->label);
 
+         /* Symbolic links to the deleted backup become files in the next one */
+         next = pgmoneta_get_server_backup_identifier(server, backups[next_index]->label);
+         previous = pgmoneta_directory_size(next);
+         free(next);
+         next = NULL;
+
          pgmoneta_relink(from, to, workers);
 
          pgmoneta_workers_wait(workers);
@@ -331,6 +351,8 @@ delete_backup(int server, int index, struct backup* backup __attribute__((unused
          size = pgmoneta_directory_size(d);
          pgmoneta_update_info_unsigned_long(d, INFO_BACKUP, size);
 
+         pgmoneta_space_add(server, SPACE_BACKUP, (int64_t)size - (int64_t)previous);
+
          free(from);
          free(to);
          from = NULL;
@@ -347,6 +369,12 @@ delete_backup(int server, int index, struct backup* backup __attribute__((unused
          from = pgmoneta_get_server_backup_identifier_data(server, backups[index]->label);
          to = pgmoneta_get_server_backup_identifier_data(server, backups[next_index]->label);
 
+         /* Symbolic links to the deleted backup become files in the next one */
+         next = pgmoneta_get_server_backup_identifier(server, backups[next_index]->label);
+         previous = pgmoneta_directory_size(next);
+         free(next);
+         next = NULL;
+
          pgmoneta_relink(from, to, workers);
 
          pgmoneta_workers_wait(workers);
@@ -367,6 +395,8 @@ delete_backup(int server, int index, struct backup* backup __attribute__((unused
          size = pgmoneta_directory_size(d);
          pgmoneta_update_info_unsigned_long(d, INFO_BACKUP, size);
 
+         pgmoneta_space_add(server, SPACE_BACKUP, (int64_t)size - (int64_t)previous);
+
          free(from);
          free(to);
          from = NULL;
@@ -384,6 +414,8 @@ delete_backup(int server, int index, struct backup* backup __attribute__((unused
       pgmoneta_delete_directory(d);
    }
 
+   pgmoneta_space_add(server, SPACE_BACKUP, -(int64_t)deleted);
+
    free(d);
    free(from);
    free(to);
@@ -30,6 +30,7 @@
 #include <pgmoneta.h>
 #include <aes.h>
 #include <logging.h>
+#include <security.h>
 #include <utils.h>
 #include <workflow.h>
 
@@ -40,6 +41,7 @@
 static char* encryption_name(void);
 static int encryption_execute(char*, struct art*);
 static int decryption_execute(char*, struct art*);
+static int encryption_teardown(char*, struct art*);
 
 struct workflow*
 pgmoneta_encryption(bool encrypt)
@@ -59,13 +61,14 @@ pgmoneta_encryption(bool encrypt)
    if (encrypt)
    {
       wf->execute = &encryption_execute;
+      wf->teardown = &encryption_teardown;
    }
    else
    {
       wf->execute = &decryption_execute;
+      wf->teardown = &pgmoneta_common_teardown;
    }
 
-   wf->teardown = &pgmoneta_common_teardown;
    wf->next = NULL;
 
    return wf;
@@ -125,6 +128,14 @@ encryption_execute(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_log_debug("Encryption (execute): %s/%s", config->common.servers[server].name, label);
 
+   if ((bool)pgmoneta_art_search(nodes, NODE_STREAMED))
+   {
+      pgmoneta_log_debug("Encryption (execute): %s/%s was encrypted while streaming", config->common.servers[server].name, label);
+      return 0;
+   }
+
+   pgmoneta_hash_collector_start(config->storage_engine & STORAGE_ENGINE_SSH);
+
    tarfile = (char*)pgmoneta_art_search(nodes, NODE_TARGET_FILE);
 
    if (tarfile == NULL)
@@ -238,6 +249,15 @@ error:
    return 1;
 }
 
+static int
+encryption_teardown(char* name, struct art* nodes)
+{
+   // the hash stages have used the digests collected while writing
+   pgmoneta_hash_collector_stop();
+
+   return pgmoneta_common_teardown(name, nodes);
+}
+
 static int
 decryption_execute(char* name __attribute__((unused)), struct art* nodes)
 {
@@ -30,6 +30,7 @@
 #include <pgmoneta.h>
 #include <gzip_compression.h>
 #include <logging.h>
+#include <security.h>
 #include <utils.h>
 #include <workflow.h>
 
@@ -41,6 +42,7 @@
 static char* gzip_name(void);
 static int gzip_execute_compress(char*, struct art*);
 static int gzip_execute_uncompress(char*, struct art*);
+static int gzip_teardown_compress(char*, struct art*);
 
 struct workflow*
 pgmoneta_create_gzip(bool compress)
@@ -60,13 +62,14 @@ pgmoneta_create_gzip(bool compress)
    if (compress == true)
    {
       wf->execute = &gzip_execute_compress;
+      wf->teardown = &gzip_teardown_compress;
    }
    else
    {
       wf->execute = &gzip_execute_uncompress;
+      wf->teardown = &pgmoneta_common_teardown;
    }
 
-   wf->teardown = &pgmoneta_common_teardown;
    wf->next = NULL;
 
    return wf;
@@ -124,6 +127,14 @@ gzip_execute_compress(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_log_debug("GZip (compress): %s/%s", config->common.servers[server].name, label);
 
+   if ((bool)pgmoneta_art_search(nodes, NODE_STREAMED))
+   {
+      pgmoneta_log_debug("GZip (compress): %s/%s was compressed while streaming", config->common.servers[server].name, label);
+      return 0;
+   }
+
+   pgmoneta_hash_collector_start(config->storage_engine & STORAGE_ENGINE_SSH);
+
    tarfile = (char*)pgmoneta_art_search(nodes, NODE_TARGET_FILE);
 
    if (tarfile == NULL)
@@ -203,6 +214,15 @@ error:
    return 1;
 }
 
+static int
+gzip_teardown_compress(char* name, struct art* nodes)
+{
+   // the hash stages have used the digests collected while writing
+   pgmoneta_hash_collector_stop();
+
+   return pgmoneta_common_teardown(name, nodes);
+}
+
 static int
 gzip_execute_uncompress(char* name __attribute__((unused)), struct art* nodes)
 {
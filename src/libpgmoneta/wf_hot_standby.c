@@ -31,6 +31,7 @@
 #include <logging.h>
 #include <manifest.h>
 #include <restore.h>
+#include <space.h>
 #include <utils.h>
 #include <workflow.h>
 
@@ -344,6 +345,8 @@ hot_standby_execute(char* name __attribute__((unused)), struct art* nodes)
       sprintf(&elapsed[0], "%02i:%02i:%.4f", hours, minutes, seconds);
 
       pgmoneta_log_debug("Hot standby: %s/%s (Elapsed: %s)", config->common.servers[server].name, label, &elapsed[0]);
+
+      pgmoneta_space_invalidate(server, SPACE_HOT_STANDBY);
    }
 
    free(old_manifest);
@@ -378,6 +381,8 @@ hot_standby_execute(char* name __attribute__((unused)), struct art* nodes)
 
 error:
 
+   pgmoneta_space_invalidate(server, SPACE_HOT_STANDBY);
+
    free(old_manifest);
    free(new_manifest);
 
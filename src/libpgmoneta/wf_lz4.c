@@ -29,6 +29,7 @@
 /* pgmoneta */
 #include <pgmoneta.h>
 #include <logging.h>
+#include <security.h>
 #include <utils.h>
 #include <lz4_compression.h>
 #include <workflow.h>
@@ -40,6 +41,7 @@
 static char* lz4_name(void);
 static int lz4_execute_compress(char*, struct art*);
 static int lz4_execute_uncompress(char*, struct art*);
+static int lz4_teardown_compress(char*, struct art*);
 
 struct workflow*
 pgmoneta_create_lz4(bool compress)
@@ -59,13 +61,14 @@ pgmoneta_create_lz4(bool compress)
    if (compress == true)
    {
       wf->execute = &lz4_execute_compress;
+      wf->teardown = &lz4_teardown_compress;
    }
    else
    {
       wf->execute = &lz4_execute_uncompress;
+      wf->teardown = &pgmoneta_common_teardown;
    }
 
-   wf->teardown = &pgmoneta_common_teardown;
    wf->next = NULL;
 
    return wf;
@@ -117,6 +120,14 @@ lz4_execute_compress(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_log_debug("LZ4 (compress): %s/%s", config->common.servers[server].name, label);
 
+   if ((bool)pgmoneta_art_search(nodes, NODE_STREAMED))
+   {
+      pgmoneta_log_debug("LZ4 (compress): %s/%s was compressed while streaming", config->common.servers[server].name, label);
+      return 0;
+   }
+
+   pgmoneta_hash_collector_start(config->storage_engine & STORAGE_ENGINE_SSH);
+
 #ifdef HAVE_FREEBSD
    clock_gettime(CLOCK_MONOTONIC_FAST, &start_t);
 #else
@@ -201,6 +212,15 @@ error:
    return 1;
 }
 
+static int
+lz4_teardown_compress(char* name, struct art* nodes)
+{
+   // the hash stages have used the digests collected while writing
+   pgmoneta_hash_collector_stop();
+
+   return pgmoneta_common_teardown(name, nodes);
+}
+
 static int
 lz4_execute_uncompress(char* name __attribute__((unused)), struct art* nodes)
 {
@@ -188,6 +188,7 @@ permissions_execute_archive(char* name __attribute__((unused)), struct art* node
    assert(nodes != NULL);
    assert(pgmoneta_art_contains_key(nodes, NODE_SERVER_ID));
    assert(pgmoneta_art_contains_key(nodes, NODE_LABEL));
+   assert(pgmoneta_art_contains_key(nodes, NODE_TARGET_FILE));
 #endif
 
    server = (int)pgmoneta_art_search(nodes, NODE_SERVER_ID);
@@ -195,32 +196,7 @@ permissions_execute_archive(char* name __attribute__((unused)), struct art* node
 
    pgmoneta_log_debug("Permissions (archive): %s/%s", config->common.servers[server].name, label);
 
-   path = pgmoneta_append(path, (char*)pgmoneta_art_search(nodes, NODE_TARGET_ROOT));
-   if (!pgmoneta_ends_with(path, "/"))
-   {
-      path = pgmoneta_append(path, "/");
-   }
-   path = pgmoneta_append(path, config->common.servers[server].name);
-   path = pgmoneta_append(path, "-");
-   path = pgmoneta_append(path, label);
-   path = pgmoneta_append(path, ".tar");
-
-   if (config->compression_type == COMPRESSION_CLIENT_GZIP || config->compression_type == COMPRESSION_SERVER_GZIP)
-   {
-      path = pgmoneta_append(path, ".gz");
-   }
-   else if (config->compression_type == COMPRESSION_CLIENT_ZSTD || config->compression_type == COMPRESSION_SERVER_ZSTD)
-   {
-      path = pgmoneta_append(path, ".zstd");
-   }
-   else if (config->compression_type == COMPRESSION_CLIENT_LZ4 || config->compression_type == COMPRESSION_SERVER_LZ4)
-   {
-      path = pgmoneta_append(path, ".lz4");
-   }
-   else if (config->compression_type == COMPRESSION_CLIENT_BZIP2)
-   {
-      path = pgmoneta_append(path, ".bz2");
-   }
+   path = pgmoneta_append(path, (char*)pgmoneta_art_search(nodes, NODE_TARGET_FILE));
 
    pgmoneta_permission(path, 6, 0, 0);
 
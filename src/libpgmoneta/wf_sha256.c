@@ -187,7 +187,10 @@ write_backup_sha256(char* root, char* relative_path)
          absolute_file_path = pgmoneta_append(absolute_file_path, "/");
          absolute_file_path = pgmoneta_append(absolute_file_path, relative_file_path);
 
-         pgmoneta_create_sha256_file(absolute_file_path, &sha256);
+         if (pgmoneta_hash_collector_get(absolute_file_path, &sha256, NULL))
+         {
+            pgmoneta_create_sha256_file(absolute_file_path, &sha256);
+         }
 
          buffer = pgmoneta_append(buffer, relative_file_path);
          buffer = pgmoneta_append(buffer, ":");
@@ -43,7 +43,7 @@
 static char* sha512_name(void);
 static int sha512_execute(char*, struct art*);
 
-static int write_backup_sha512(char* root, char* relative_path);
+static int write_backup_sha512(char* root, char* relative_path, struct art* hashes);
 
 static FILE* sha512_file = NULL;
 
@@ -77,6 +77,7 @@ sha512_execute(char* name __attribute__((unused)), struct art* nodes)
    char* root = NULL;
    char* d = NULL;
    char* sha512_path = NULL;
+   struct art* hashes = NULL;
    struct main_configuration* config;
 
    config = (struct main_configuration*)shmem;
@@ -112,7 +113,10 @@ sha512_execute(char* name __attribute__((unused)), struct art* nodes)
 
    d = pgmoneta_get_server_backup_identifier_data(server, label);
 
-   if (write_backup_sha512(root, ""))
+   // hashes calculated while streaming the backup
+   hashes = (struct art*)pgmoneta_art_search(nodes, NODE_SHA512);
+
+   if (write_backup_sha512(root, "", hashes))
    {
       goto error;
    }
@@ -142,7 +146,7 @@ error:
 }
 
 static int
-write_backup_sha512(char* root, char* relative_path)
+write_backup_sha512(char* root, char* relative_path, struct art* hashes)
 {
    char* dir_path = NULL;
    char* relative_file_path;
@@ -173,7 +177,7 @@ write_backup_sha512(char* root, char* relative_path)
 
          snprintf(relative_dir, sizeof(relative_dir), "%s/%s", relative_path, entry->d_name);
 
-         write_backup_sha512(root, relative_dir);
+         write_backup_sha512(root, relative_dir, hashes);
       }
       else if (strcmp(entry->d_name, "backup.sha512"))
       {
@@ -190,7 +194,14 @@ write_backup_sha512(char* root, char* relative_path)
          absolute_file_path = pgmoneta_append(absolute_file_path, "/");
          absolute_file_path = pgmoneta_append(absolute_file_path, relative_file_path);
 
-         pgmoneta_create_sha512_file(absolute_file_path, &sha512);
+         if (hashes != NULL && pgmoneta_art_contains_key(hashes, relative_file_path))
+         {
+            sha512 = pgmoneta_append(sha512, (char*)pgmoneta_art_search(hashes, relative_file_path));
+         }
+         else if (pgmoneta_hash_collector_get(absolute_file_path, NULL, &sha512))
+         {
+            pgmoneta_create_sha512_file(absolute_file_path, &sha512);
+         }
 
          buffer = pgmoneta_append(buffer, sha512);
          buffer = pgmoneta_append(buffer, " *.");
@@ -32,7 +32,9 @@
 #include <logging.h>
 #include <management.h>
 #include <security.h>
+#include <streamer.h>
 #include <utils.h>
+#include <verify.h>
 #include <workflow.h>
 
 /* system */
@@ -44,7 +46,9 @@
 static char* verify_name(void);
 static int verify_execute(char*, struct art*);
 
-static void do_verify(struct worker_common* wc);
+static int create_stored_hash(char* path, int hash, char** calculated);
+
+static char* stored_suffixes[] = {".zstd.aes", ".gz.aes", ".lz4.aes", ".bz2.aes", ".aes", ".zstd", ".gz", ".lz4", ".bz2", NULL};
 
 struct workflow*
 pgmoneta_create_verify(void)
@@ -79,6 +83,7 @@ verify_execute(char* name __attribute__((unused)), struct art* nodes)
    int server = -1;
    char* label = NULL;
    char* base = NULL;
+   char* directory = NULL;
    char* info_file = NULL;
    char* manifest_file = NULL;
    int number_of_columns = 0;
@@ -114,6 +119,13 @@ verify_execute(char* name __attribute__((unused)), struct art* nodes)
 
    base = pgmoneta_get_server_backup_identifier(server, (char*)pgmoneta_art_search(nodes, NODE_LABEL));
 
+   // Without a restored copy the files are read from the backup itself
+   directory = (char*)pgmoneta_art_search(nodes, NODE_TARGET_BASE);
+   if (directory == NULL)
+   {
+      directory = (char*)pgmoneta_art_search(nodes, NODE_BACKUP_DATA);
+   }
+
    info_file = pgmoneta_append(info_file, base);
    if (!pgmoneta_ends_with(info_file, "/"))
    {
@@ -169,7 +181,7 @@ verify_execute(char* name __attribute__((unused)), struct art* nodes)
          goto error;
       }
 
-      pgmoneta_json_put(j, MANAGEMENT_ARGUMENT_DIRECTORY, (uintptr_t)pgmoneta_art_search(nodes, NODE_TARGET_BASE), ValueString);
+      pgmoneta_json_put(j, MANAGEMENT_ARGUMENT_DIRECTORY, (uintptr_t)directory, ValueString);
       pgmoneta_json_put(j, MANAGEMENT_ARGUMENT_FILENAME, (uintptr_t)columns[0], ValueString);
       pgmoneta_json_put(j, MANAGEMENT_ARGUMENT_ORIGINAL, (uintptr_t)columns[1], ValueString);
       pgmoneta_json_put(j, MANAGEMENT_ARGUMENT_HASH_ALGORITHM, (uintptr_t)backup->hash_algorithm, ValueInt32);
@@ -182,12 +194,12 @@ verify_execute(char* name __attribute__((unused)), struct art* nodes)
       {
          if (workers->outcome)
          {
-            pgmoneta_workers_add(workers, do_verify, (struct worker_common*)payload);
+            pgmoneta_workers_add(workers, pgmoneta_verify_file, (struct worker_common*)payload);
          }
       }
       else
       {
-         do_verify((struct worker_common*)payload);
+         pgmoneta_verify_file((struct worker_common*)payload);
       }
 
       free(columns);
@@ -241,11 +253,12 @@ error:
    return 1;
 }
 
-static void
-do_verify(struct worker_common* wc)
+void
+pgmoneta_verify_file(struct worker_common* wc)
 {
    struct worker_input* wi = (struct worker_input*)wc;
    char* f = NULL;
+   char* stored = NULL;
    char* hash_cal = NULL;
    bool failed = false;
    int ha = 0;
@@ -260,13 +273,39 @@ do_verify(struct worker_common* wc)
    }
    f = pgmoneta_append(f, (char*)pgmoneta_json_get(j, MANAGEMENT_ARGUMENT_FILENAME));
 
+   ha = (int)pgmoneta_json_get(j, MANAGEMENT_ARGUMENT_HASH_ALGORITHM);
+
    if (!pgmoneta_exists(f))
    {
-      goto error;
+      stored = pgmoneta_verify_stored_file(f);
    }
 
-   ha = (int)pgmoneta_json_get(j, MANAGEMENT_ARGUMENT_HASH_ALGORITHM);
-   if (ha == HASH_ALGORITHM_SHA256)
+   if (!pgmoneta_exists(f) && stored == NULL)
+   {
+      pgmoneta_log_debug("Verify: %s is missing", f);
+      failed = true;
+   }
+   else if (stored != NULL)
+   {
+      if (ha != HASH_ALGORITHM_CRC32C && ha != HASH_ALGORITHM_SHA224 && ha != HASH_ALGORITHM_SHA256 &&
+          ha != HASH_ALGORITHM_SHA384 && ha != HASH_ALGORITHM_SHA512)
+      {
+         goto error;
+      }
+
+      if (!create_stored_hash(stored, ha, &hash_cal))
+      {
+         if (strcmp(hash_cal, (char*)pgmoneta_json_get(j, MANAGEMENT_ARGUMENT_ORIGINAL)))
+         {
+            failed = true;
+         }
+      }
+      else
+      {
+         failed = true;
+      }
+   }
+   else if (ha == HASH_ALGORITHM_SHA256)
    {
       if (!pgmoneta_create_sha256_file(f, &hash_cal))
       {
@@ -369,6 +408,7 @@ do_verify(struct worker_common* wc)
    wi->all = NULL;
 
    free(hash_cal);
+   free(stored);
    free(f);
    free(wi);
 
@@ -384,6 +424,57 @@ error:
    wi->all = NULL;
 
    free(hash_cal);
+   free(stored);
    free(f);
    free(wi);
 }
+
+char*
+pgmoneta_verify_stored_file(char* path)
+{
+   char* stored = NULL;
+
+   for (int i = 0; stored_suffixes[i] != NULL; i++)
+   {
+      stored = pgmoneta_append(stored, path);
+      stored = pgmoneta_append(stored, stored_suffixes[i]);
+
+      if (pgmoneta_exists(stored))
+      {
+         return stored;
+      }
+
+      free(stored);
+      stored = NULL;
+   }
+
+   return NULL;
+}
+
+static int
+create_stored_hash(char* path, int hash, char** calculated)
+{
+   struct stream_reader* reader = NULL;
+
+   *calculated = NULL;
+
+   if (pgmoneta_stream_reader_create(path, &reader))
+   {
+      goto error;
+   }
+
+   if (pgmoneta_stream_reader_checksum(reader, hash, calculated))
+   {
+      goto error;
+   }
+
+   pgmoneta_stream_reader_destroy(reader);
+
+   return 0;
+
+error:
+
+   pgmoneta_stream_reader_destroy(reader);
+
+   return 1;
+}
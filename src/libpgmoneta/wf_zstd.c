@@ -29,6 +29,7 @@
 /* pgmoneta */
 #include <pgmoneta.h>
 #include <logging.h>
+#include <security.h>
 #include <utils.h>
 #include <zstandard_compression.h>
 #include <workflow.h>
@@ -41,6 +42,7 @@
 static char* zstd_name(void);
 static int zstd_execute_compress(char*, struct art*);
 static int zstd_execute_uncompress(char*, struct art*);
+static int zstd_teardown_compress(char*, struct art*);
 
 struct workflow*
 pgmoneta_create_zstd(bool compress)
@@ -60,13 +62,14 @@ pgmoneta_create_zstd(bool compress)
    if (compress == true)
    {
       wf->execute = &zstd_execute_compress;
+      wf->teardown = &zstd_teardown_compress;
    }
    else
    {
       wf->execute = &zstd_execute_uncompress;
+      wf->teardown = &pgmoneta_common_teardown;
    }
 
-   wf->teardown = &pgmoneta_common_teardown;
    wf->next = NULL;
 
    return wf;
@@ -124,6 +127,14 @@ zstd_execute_compress(char* name __attribute__((unused)), struct art* nodes)
 
    pgmoneta_log_debug("ZSTD (compress): %s/%s", config->common.servers[server].name, label);
 
+   if ((bool)pgmoneta_art_search(nodes, NODE_STREAMED))
+   {
+      pgmoneta_log_debug("ZSTD (compress): %s/%s was compressed while streaming", config->common.servers[server].name, label);
+      return 0;
+   }
+
+   pgmoneta_hash_collector_start(config->storage_engine & STORAGE_ENGINE_SSH);
+
    tarfile = (char*)pgmoneta_art_search(nodes, NODE_TARGET_FILE);
 
    if (tarfile == NULL)
@@ -198,6 +209,15 @@ error:
    return 1;
 }
 
+static int
+zstd_teardown_compress(char* name, struct art* nodes)
+{
+   // the hash stages have used the digests collected while writing
+   pgmoneta_hash_collector_stop();
+
+   return pgmoneta_common_teardown(name, nodes);
+}
+
 static int
 zstd_execute_uncompress(char* name __attribute__((unused)), struct art* nodes)
 {
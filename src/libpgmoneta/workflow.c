@@ -445,15 +445,14 @@ wf_backup(void)
    }
 
 #ifdef DEBUG
-   if (config->link)
+   if (config->link && !config->deduplication)
+#else
+   if (!config->deduplication)
+#endif
    {
       current->next = pgmoneta_create_link();
       current = current->next;
    }
-#else
-   current->next = pgmoneta_create_link();
-   current = current->next;
-#endif
 
    current->next = pgmoneta_create_permissions(PERMISSION_TYPE_BACKUP);
    current = current->next;
@@ -482,6 +481,12 @@ wf_backup(void)
    current->next = pgmoneta_create_sha512();
    current = current->next;
 
+   if (config->deduplication)
+   {
+      current->next = pgmoneta_create_dedup();
+      current = current->next;
+   }
+
 #ifdef DEBUG
    current = head;
    while (current != NULL)
@@ -498,41 +503,15 @@ wf_backup(void)
 }
 
 static struct workflow*
-wf_restore(struct backup* backup)
+wf_restore(struct backup* backup __attribute__((unused)))
 {
    struct workflow* head = NULL;
    struct workflow* current = NULL;
 
+   // The restore step decrypts and decompresses the files while copying them
    head = pgmoneta_create_restore();
    current = head;
 
-   if (backup->encryption != ENCRYPTION_NONE)
-   {
-      current->next = pgmoneta_encryption(false);
-      current = current->next;
-   }
-
-   if (backup->compression == COMPRESSION_CLIENT_GZIP || backup->compression == COMPRESSION_SERVER_GZIP)
-   {
-      current->next = pgmoneta_create_gzip(false);
-      current = current->next;
-   }
-   else if (backup->compression == COMPRESSION_CLIENT_ZSTD || backup->compression == COMPRESSION_SERVER_ZSTD)
-   {
-      current->next = pgmoneta_create_zstd(false);
-      current = current->next;
-   }
-   else if (backup->compression == COMPRESSION_CLIENT_LZ4 || backup->compression == COMPRESSION_SERVER_LZ4)
-   {
-      current->next = pgmoneta_create_lz4(false);
-      current = current->next;
-   }
-   else if (backup->compression == COMPRESSION_CLIENT_BZIP2)
-   {
-      current->next = pgmoneta_create_bzip2(false);
-      current = current->next;
-   }
-
    current->next = pgmoneta_create_copy_wal();
    current = current->next;
 
@@ -648,15 +627,14 @@ wf_post_rollup(struct backup* backup)
    }
 
 #ifdef DEBUG
-   if (config->link)
+   if (config->link && !config->deduplication)
+#else
+   if (!config->deduplication)
+#endif
    {
       current->next = pgmoneta_create_link();
       current = current->next;
    }
-#else
-   current->next = pgmoneta_create_link();
-   current = current->next;
-#endif
 
    current->next = pgmoneta_create_permissions(PERMISSION_TYPE_BACKUP);
    current = current->next;
@@ -685,6 +663,12 @@ wf_post_rollup(struct backup* backup)
    current->next = pgmoneta_create_sha512();
    current = current->next;
 
+   if (config->deduplication)
+   {
+      current->next = pgmoneta_create_dedup();
+      current = current->next;
+   }
+
 #ifdef DEBUG
    current = head;
    while (current != NULL)
@@ -796,51 +780,15 @@ wf_incremental_backup(void)
 }
 
 static struct workflow*
-wf_verify(struct backup* backup)
+wf_verify(struct backup* backup __attribute__((unused)))
 {
    struct workflow* head = NULL;
-   struct workflow* current = NULL;
 
-   head = pgmoneta_create_restore();
-   current = head;
-
-   if (backup->encryption != ENCRYPTION_NONE)
-   {
-      current->next = pgmoneta_encryption(false);
-      current = current->next;
-   }
-
-   if (backup->compression == COMPRESSION_CLIENT_GZIP || backup->compression == COMPRESSION_SERVER_GZIP)
-   {
-      current->next = pgmoneta_create_gzip(false);
-      current = current->next;
-   }
-   else if (backup->compression == COMPRESSION_CLIENT_ZSTD || backup->compression == COMPRESSION_SERVER_ZSTD)
-   {
-      current->next = pgmoneta_create_zstd(false);
-      current = current->next;
-   }
-   else if (backup->compression == COMPRESSION_CLIENT_LZ4 || backup->compression == COMPRESSION_SERVER_LZ4)
-   {
-      current->next = pgmoneta_create_lz4(false);
-      current = current->next;
-   }
-   else if (backup->compression == COMPRESSION_CLIENT_BZIP2)
-   {
-      current->next = pgmoneta_create_bzip2(false);
-      current = current->next;
-   }
-
-   current->next = pgmoneta_restore_excluded_files();
-   current = current->next;
-
-   current->next = pgmoneta_create_permissions(PERMISSION_TYPE_RESTORE);
-   current = current->next;
-
-   current->next = pgmoneta_create_verify();
-   current = current->next;
+   // The backup is either restored up front or verified where it is stored
+   head = pgmoneta_create_verify();
 
 #ifdef DEBUG
+   struct workflow* current = NULL;
    current = head;
    while (current != NULL)
    {
@@ -856,43 +804,15 @@ wf_verify(struct backup* backup)
 }
 
 static struct workflow*
-wf_archive(struct backup* backup)
+wf_archive(struct backup* backup __attribute__((unused)))
 {
    struct workflow* head = NULL;
    struct workflow* current = NULL;
 
+   // The archive step compresses and encrypts the tar file while writing it
    head = pgmoneta_create_archive();
    current = head;
 
-   if (backup->compression == COMPRESSION_CLIENT_GZIP || backup->compression == COMPRESSION_SERVER_GZIP)
-   {
-      current->next = pgmoneta_create_gzip(true);
-      current = current->next;
-   }
-   else if (backup->compression == COMPRESSION_CLIENT_ZSTD || backup->compression == COMPRESSION_SERVER_ZSTD)
-   {
-      current->next = pgmoneta_create_zstd(true);
-      current = current->next;
-   }
-   else if (backup->compression == COMPRESSION_CLIENT_LZ4 || backup->compression == COMPRESSION_SERVER_LZ4)
-   {
-      current->next = pgmoneta_create_lz4(true);
-
-      current = current->next;
-   }
-   else if (backup->compression == COMPRESSION_CLIENT_BZIP2)
-   {
-      current->next = pgmoneta_create_bzip2(true);
-
-      current = current->next;
-   }
-
-   if (backup->encryption != ENCRYPTION_NONE)
-   {
-      current->next = pgmoneta_encryption(true);
-      current = current->next;
-   }
-
    current->next = pgmoneta_create_permissions(PERMISSION_TYPE_ARCHIVE);
    current = current->next;
 
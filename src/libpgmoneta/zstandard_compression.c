@@ -30,11 +30,13 @@
 #include <pgmoneta.h>
 #include <logging.h>
 #include <management.h>
+#include <security.h>
 #include <utils.h>
 #include <zstandard_compression.h>
 
 /* system */
 #include <dirent.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -46,23 +48,49 @@
 #define NAME "zstd"
 #define ZSTD_DEFAULT_NUMBER_OF_WORKERS 4
 
+#define ZSTD_SEEKABLE_MAGIC       0x8F92EAB1
+#define ZSTD_SEEK_TABLE_MAGIC     0x184D2A5E
+#define ZSTD_SEEK_HEADER_SIZE     8
+#define ZSTD_SEEK_FOOTER_SIZE     9
+#define ZSTD_SEEK_ENTRY_SIZE      8
+#define ZSTD_SEEK_CHECKSUM_FLAG   0x80
+#define ZSTD_SEEK_MAX_FRAMES      0x8000000
+
+/** @struct zstd_context
+ * Defines the reusable Zstandard state of a thread
+ */
+struct zstd_context
+{
+   ZSTD_CCtx* cctx;   /**< The compression context */
+   ZSTD_DCtx* dctx;   /**< The decompression context */
+   void* zin;         /**< The input buffer */
+   size_t zin_size;   /**< The size of the input buffer */
+   void* zout;        /**< The output buffer */
+   size_t zout_size;  /**< The size of the output buffer */
+};
+
+static pthread_key_t context_key;
+static pthread_once_t context_once = PTHREAD_ONCE_INIT;
+
+static void do_zstd_compress(struct worker_common* wc);
+static void do_zstd_decompress(struct worker_common* wc);
+static struct zstd_context* get_context(void);
+static void create_context_key(void);
+static void destroy_context(void* context);
 static int zstd_compress(char* from, char* to, ZSTD_CCtx* cctx, size_t zin_size, void* zin, size_t zout_size, void* zout);
 static int zstd_decompress(char* from, char* to, ZSTD_DCtx* dctx, size_t zin_size, void* zin, size_t zout_size, void* zout);
+static void write_le32(unsigned char* buffer, uint32_t value);
+static uint32_t read_le32(unsigned char* buffer);
 
 void
 pgmoneta_zstandardc_data(char* directory, struct workers* workers)
 {
-   size_t zin_size = -1;
-   void* zin = NULL;
-   size_t zout_size = -1;
-   void* zout = NULL;
-   ZSTD_CCtx* cctx = NULL;
    char* from = NULL;
    char* to = NULL;
    DIR* dir;
    struct dirent* entry;
    int level;
-   int ws;
+   struct worker_input* wi = NULL;
    struct main_configuration* config;
 
    config = (struct main_configuration*)shmem;
@@ -82,23 +110,6 @@ pgmoneta_zstandardc_data(char* directory, struct workers* workers)
       level = 19;
    }
 
-   ws = config->workers != 0 ? config->workers : ZSTD_DEFAULT_NUMBER_OF_WORKERS;
-
-   zin_size = ZSTD_CStreamInSize();
-   zin = malloc(zin_size);
-   zout_size = ZSTD_CStreamOutSize();
-   zout = malloc(zout_size);
-
-   cctx = ZSTD_createCCtx();
-   if (cctx == NULL)
-   {
-      goto error;
-   }
-
-   ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
-   ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
-   ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, ws);
-
    while ((entry = readdir(dir)) != NULL)
    {
       if (entry->d_type == DT_DIR)
@@ -125,38 +136,36 @@ pgmoneta_zstandardc_data(char* directory, struct workers* workers)
          if (!pgmoneta_is_compressed(entry->d_name) &&
              !pgmoneta_is_encrypted(entry->d_name))
          {
-            from = NULL;
-
             from = pgmoneta_append(from, directory);
             from = pgmoneta_append(from, "/");
             from = pgmoneta_append(from, entry->d_name);
 
-            to = NULL;
-
             to = pgmoneta_append(to, directory);
             to = pgmoneta_append(to, "/");
             to = pgmoneta_append(to, entry->d_name);
             to = pgmoneta_append(to, ".zstd");
 
-            if (pgmoneta_exists(from))
+            if (!pgmoneta_create_worker_input(directory, from, to, level, workers, &wi))
             {
-               if (zstd_compress(from, to, cctx, zin_size, zin, zout_size, zout))
-               {
-                  pgmoneta_log_error("ZSTD: Could not compress %s/%s", directory, entry->d_name);
-                  break;
-               }
-
-               if (pgmoneta_exists(from))
+               if (workers != NULL)
                {
-                  pgmoneta_delete_file(from, NULL);
+                  if (workers->outcome)
+                  {
+                     pgmoneta_workers_add(workers, do_zstd_compress, (struct worker_common*)wi);
+                  }
+                  else
+                  {
+                     free(wi);
+                  }
                }
                else
                {
-                  pgmoneta_log_debug("%s doesn't exists", from);
+                  do_zstd_compress((struct worker_common*)wi);
                }
-
-               memset(zin, 0, zin_size);
-               memset(zout, 0, zout_size);
+            }
+            else
+            {
+               goto error;
             }
 
             free(from);
@@ -170,25 +179,11 @@ pgmoneta_zstandardc_data(char* directory, struct workers* workers)
 
    closedir(dir);
 
-   ZSTD_freeCCtx(cctx);
-
-   free(zin);
-   free(zout);
-
-   free(from);
-   free(to);
-
    return;
 
 error:
 
-   if (cctx != NULL)
-   {
-      ZSTD_freeCCtx(cctx);
-   }
-
-   free(zin);
-   free(zout);
+   closedir(dir);
 
    free(from);
    free(to);
@@ -522,44 +517,18 @@ error:
 void
 pgmoneta_zstandardd_directory(char* directory, struct workers* workers)
 {
-   ZSTD_DCtx* dctx = NULL;
-   size_t zin_size = -1;
-   void* zin = NULL;
-   size_t zout_size = -1;
-   void* zout = NULL;
    char* from = NULL;
    char* to = NULL;
    char* name = NULL;
    DIR* dir;
    struct dirent* entry;
+   struct worker_input* wi = NULL;
 
    if (!(dir = opendir(directory)))
    {
       return;
    }
 
-   zin_size = ZSTD_DStreamInSize();
-   zin = malloc(zin_size);
-
-   if (zin == NULL)
-   {
-      goto error;
-   }
-
-   zout_size = ZSTD_DStreamOutSize();
-   zout = malloc(zout_size);
-
-   if (zout == NULL)
-   {
-      goto error;
-   }
-
-   dctx = ZSTD_createDCtx();
-   if (dctx == NULL)
-   {
-      goto error;
-   }
-
    while ((entry = readdir(dir)) != NULL)
    {
       if (entry->d_type == DT_DIR || entry->d_type == DT_LNK)
@@ -579,8 +548,6 @@ pgmoneta_zstandardd_directory(char* directory, struct workers* workers)
       {
          if (pgmoneta_ends_with(entry->d_name, ".zstd"))
          {
-            from = NULL;
-
             from = pgmoneta_append(from, directory);
             if (!pgmoneta_ends_with(from, "/"))
             {
@@ -598,8 +565,6 @@ pgmoneta_zstandardd_directory(char* directory, struct workers* workers)
             memset(name, 0, strlen(entry->d_name) - 4);
             memcpy(name, entry->d_name, strlen(entry->d_name) - 5);
 
-            to = NULL;
-
             to = pgmoneta_append(to, directory);
             if (!pgmoneta_ends_with(to, "/"))
             {
@@ -607,24 +572,29 @@ pgmoneta_zstandardd_directory(char* directory, struct workers* workers)
             }
             to = pgmoneta_append(to, name);
 
-            if (zstd_decompress(from, to, dctx, zin_size, zin, zout_size, zout))
-            {
-               pgmoneta_log_error("ZSTD: Could not decompress %s/%s", directory, entry->d_name);
-               break;
-            }
-
-            if (pgmoneta_exists(from))
+            if (!pgmoneta_create_worker_input(directory, from, to, 0, workers, &wi))
             {
-               pgmoneta_delete_file(from, NULL);
+               if (workers != NULL)
+               {
+                  if (workers->outcome)
+                  {
+                     pgmoneta_workers_add(workers, do_zstd_decompress, (struct worker_common*)wi);
+                  }
+                  else
+                  {
+                     free(wi);
+                  }
+               }
+               else
+               {
+                  do_zstd_decompress((struct worker_common*)wi);
+               }
             }
             else
             {
-               pgmoneta_log_debug("%s doesn't exists", from);
+               goto error;
             }
 
-            memset(zin, 0, zin_size);
-            memset(zout, 0, zout_size);
-
             free(name);
             free(from);
             free(to);
@@ -638,26 +608,11 @@ pgmoneta_zstandardd_directory(char* directory, struct workers* workers)
 
    closedir(dir);
 
-   ZSTD_freeDCtx(dctx);
-
-   free(zin);
-   free(zout);
-
-   free(from);
-   free(to);
-   free(name);
-
    return;
 
 error:
 
-   if (dctx != NULL)
-   {
-      ZSTD_freeDCtx(dctx);
-   }
-
-   free(zin);
-   free(zout);
+   closedir(dir);
 
    free(name);
    free(from);
@@ -908,12 +863,447 @@ pgmoneta_zstdd_string(unsigned char* compressed_buffer, size_t compressed_size,
    return 0;
 }
 
+int
+pgmoneta_zstd_seek_table_create(struct zstd_seek_table** table)
+{
+   struct zstd_seek_table* t = NULL;
+
+   *table = NULL;
+
+   t = (struct zstd_seek_table*)malloc(sizeof(struct zstd_seek_table));
+   if (t == NULL)
+   {
+      goto error;
+   }
+
+   memset(t, 0, sizeof(struct zstd_seek_table));
+
+   t->capacity = 16;
+   t->compressed = (uint64_t*)malloc((t->capacity + 1) * sizeof(uint64_t));
+   t->raw = (uint64_t*)malloc((t->capacity + 1) * sizeof(uint64_t));
+   if (t->compressed == NULL || t->raw == NULL)
+   {
+      goto error;
+   }
+
+   t->compressed[0] = 0;
+   t->raw[0] = 0;
+
+   *table = t;
+
+   return 0;
+
+error:
+
+   pgmoneta_zstd_seek_table_destroy(t);
+
+   return 1;
+}
+
+int
+pgmoneta_zstd_seek_table_add(struct zstd_seek_table* table, uint32_t compressed_size, uint32_t raw_size)
+{
+   uint64_t* compressed = NULL;
+   uint64_t* raw = NULL;
+
+   if (table->frames >= ZSTD_SEEK_MAX_FRAMES)
+   {
+      pgmoneta_log_error("ZSTD: Too many frames for a seek table");
+      goto error;
+   }
+
+   if (table->frames == table->capacity)
+   {
+      compressed = (uint64_t*)realloc(table->compressed, (2 * table->capacity + 1) * sizeof(uint64_t));
+      if (compressed == NULL)
+      {
+         goto error;
+      }
+      table->compressed = compressed;
+
+      raw = (uint64_t*)realloc(table->raw, (2 * table->capacity + 1) * sizeof(uint64_t));
+      if (raw == NULL)
+      {
+         goto error;
+      }
+      table->raw = raw;
+
+      table->capacity *= 2;
+   }
+
+   table->compressed[table->frames + 1] = table->compressed[table->frames] + compressed_size;
+   table->raw[table->frames + 1] = table->raw[table->frames] + raw_size;
+   table->frames++;
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+int
+pgmoneta_zstd_seek_table_serialize(struct zstd_seek_table* table, unsigned char** buffer, size_t* size)
+{
+   unsigned char* b = NULL;
+   size_t sz = 0;
+   size_t offset = 0;
+
+   *buffer = NULL;
+   *size = 0;
+
+   sz = ZSTD_SEEK_HEADER_SIZE + ((size_t)table->frames * ZSTD_SEEK_ENTRY_SIZE) + ZSTD_SEEK_FOOTER_SIZE;
+
+   b = (unsigned char*)malloc(sz);
+   if (b == NULL)
+   {
+      goto error;
+   }
+
+   write_le32(b, ZSTD_SEEK_TABLE_MAGIC);
+   write_le32(b + 4, (uint32_t)(sz - ZSTD_SEEK_HEADER_SIZE));
+   offset = ZSTD_SEEK_HEADER_SIZE;
+
+   for (uint32_t i = 0; i < table->frames; i++)
+   {
+      write_le32(b + offset, (uint32_t)(table->compressed[i + 1] - table->compressed[i]));
+      write_le32(b + offset + 4, (uint32_t)(table->raw[i + 1] - table->raw[i]));
+      offset += ZSTD_SEEK_ENTRY_SIZE;
+   }
+
+   write_le32(b + offset, table->frames);
+   b[offset + 4] = 0;
+   write_le32(b + offset + 5, ZSTD_SEEKABLE_MAGIC);
+
+   *buffer = b;
+   *size = sz;
+
+   return 0;
+
+error:
+
+   return 1;
+}
+
+int
+pgmoneta_zstd_seek_table_read(FILE* file, struct zstd_seek_table** table)
+{
+   struct zstd_seek_table* t = NULL;
+   unsigned char footer[ZSTD_SEEK_FOOTER_SIZE];
+   unsigned char header[ZSTD_SEEK_HEADER_SIZE];
+   unsigned char* entries = NULL;
+   size_t entry_size = 0;
+   size_t table_size = 0;
+   uint32_t frames = 0;
+   off_t length = 0;
+
+   *table = NULL;
+
+   if (fseeko(file, 0, SEEK_END) != 0)
+   {
+      goto error;
+   }
+
+   length = ftello(file);
+   if (length < ZSTD_SEEK_HEADER_SIZE + ZSTD_SEEK_FOOTER_SIZE)
+   {
+      goto error;
+   }
+
+   if (fseeko(file, length - ZSTD_SEEK_FOOTER_SIZE, SEEK_SET) != 0 ||
+       fread(footer, 1, ZSTD_SEEK_FOOTER_SIZE, file) != ZSTD_SEEK_FOOTER_SIZE)
+   {
+      goto error;
+   }
+
+   if (read_le32(footer + 5) != ZSTD_SEEKABLE_MAGIC || (footer[4] & 0x7C) != 0)
+   {
+      goto error;
+   }
+
+   frames = read_le32(footer);
+   entry_size = (footer[4] & ZSTD_SEEK_CHECKSUM_FLAG) ? ZSTD_SEEK_ENTRY_SIZE + 4 : ZSTD_SEEK_ENTRY_SIZE;
+   table_size = ZSTD_SEEK_HEADER_SIZE + ((size_t)frames * entry_size) + ZSTD_SEEK_FOOTER_SIZE;
+
+   if (frames > ZSTD_SEEK_MAX_FRAMES || (off_t)table_size > length)
+   {
+      goto error;
+   }
+
+   if (fseeko(file, length - table_size, SEEK_SET) != 0 ||
+       fread(header, 1, ZSTD_SEEK_HEADER_SIZE, file) != ZSTD_SEEK_HEADER_SIZE)
+   {
+      goto error;
+   }
+
+   if (read_le32(header) != ZSTD_SEEK_TABLE_MAGIC || read_le32(header + 4) != table_size - ZSTD_SEEK_HEADER_SIZE)
+   {
+      goto error;
+   }
+
+   if (frames > 0)
+   {
+      entries = (unsigned char*)malloc((size_t)frames * entry_size);
+      if (entries == NULL || fread(entries, entry_size, frames, file) != frames)
+      {
+         goto error;
+      }
+   }
+
+   if (pgmoneta_zstd_seek_table_create(&t))
+   {
+      goto error;
+   }
+
+   for (uint32_t i = 0; i < frames; i++)
+   {
+      if (pgmoneta_zstd_seek_table_add(t, read_le32(entries + (i * entry_size)), read_le32(entries + (i * entry_size) + 4)))
+      {
+         goto error;
+      }
+   }
+
+   if ((off_t)(t->compressed[frames] + table_size) != length)
+   {
+      goto error;
+   }
+
+   free(entries);
+
+   *table = t;
+
+   return 0;
+
+error:
+
+   free(entries);
+   pgmoneta_zstd_seek_table_destroy(t);
+
+   return 1;
+}
+
+uint32_t
+pgmoneta_zstd_seek_table_find(struct zstd_seek_table* table, uint64_t offset)
+{
+   uint32_t low = 0;
+   uint32_t high = table->frames;
+
+   if (offset >= table->raw[table->frames])
+   {
+      return table->frames;
+   }
+
+   // the last frame starting at or before the offset
+   while (high - low > 1)
+   {
+      uint32_t middle = low + ((high - low) / 2);
+
+      if (table->raw[middle] <= offset)
+      {
+         low = middle;
+      }
+      else
+      {
+         high = middle;
+      }
+   }
+
+   return low;
+}
+
+void
+pgmoneta_zstd_seek_table_destroy(struct zstd_seek_table* table)
+{
+   if (table == NULL)
+   {
+      return;
+   }
+
+   free(table->compressed);
+   free(table->raw);
+   free(table);
+}
+
+static void
+do_zstd_compress(struct worker_common* wc)
+{
+   int ws = 0;
+   struct zstd_context* context = NULL;
+   struct worker_input* wi = (struct worker_input*)wc;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (pgmoneta_exists(wi->from))
+   {
+      context = get_context();
+      if (context == NULL || context->cctx == NULL)
+      {
+         pgmoneta_log_error("ZSTD: Could not create a compression context for %s", wi->from);
+         goto error;
+      }
+
+      // the pool already runs a file per thread, so the context only uses its own threads without one
+      if (wi->common.workers == NULL)
+      {
+         ws = config->workers != 0 ? config->workers : ZSTD_DEFAULT_NUMBER_OF_WORKERS;
+      }
+
+      ZSTD_CCtx_setParameter(context->cctx, ZSTD_c_compressionLevel, wi->level);
+      ZSTD_CCtx_setParameter(context->cctx, ZSTD_c_checksumFlag, 1);
+      ZSTD_CCtx_setParameter(context->cctx, ZSTD_c_nbWorkers, ws);
+
+      if (zstd_compress(wi->from, wi->to, context->cctx, context->zin_size, context->zin, context->zout_size, context->zout))
+      {
+         pgmoneta_log_error("ZSTD: Could not compress %s", wi->from);
+         ZSTD_CCtx_reset(context->cctx, ZSTD_reset_session_only);
+         goto error;
+      }
+
+      pgmoneta_delete_file(wi->from, NULL);
+   }
+
+   free(wi);
+
+   return;
+
+error:
+
+   if (wi->common.workers != NULL)
+   {
+      wi->common.workers->outcome = false;
+   }
+
+   free(wi);
+}
+
+static void
+do_zstd_decompress(struct worker_common* wc)
+{
+   struct zstd_context* context = NULL;
+   struct worker_input* wi = (struct worker_input*)wc;
+
+   if (pgmoneta_exists(wi->from))
+   {
+      context = get_context();
+      if (context == NULL || context->dctx == NULL)
+      {
+         pgmoneta_log_error("ZSTD: Could not create a decompression context for %s", wi->from);
+         goto error;
+      }
+
+      if (zstd_decompress(wi->from, wi->to, context->dctx, context->zin_size, context->zin, context->zout_size, context->zout))
+      {
+         pgmoneta_log_error("ZSTD: Could not decompress %s", wi->from);
+         ZSTD_DCtx_reset(context->dctx, ZSTD_reset_session_only);
+         goto error;
+      }
+
+      pgmoneta_delete_file(wi->from, NULL);
+   }
+
+   free(wi);
+
+   return;
+
+error:
+
+   if (wi->common.workers != NULL)
+   {
+      wi->common.workers->outcome = false;
+   }
+
+   free(wi);
+}
+
+static struct zstd_context*
+get_context(void)
+{
+   struct zstd_context* context = NULL;
+
+   pthread_once(&context_once, create_context_key);
+
+   context = (struct zstd_context*)pthread_getspecific(context_key);
+   if (context != NULL)
+   {
+      return context;
+   }
+
+   context = (struct zstd_context*)malloc(sizeof(struct zstd_context));
+   if (context == NULL)
+   {
+      return NULL;
+   }
+
+   memset(context, 0, sizeof(struct zstd_context));
+
+   // big enough for both directions, the sizes are only recommendations
+   context->zin_size = MAX(ZSTD_CStreamInSize(), ZSTD_DStreamInSize());
+   context->zin = malloc(context->zin_size);
+   context->zout_size = MAX(ZSTD_CStreamOutSize(), ZSTD_DStreamOutSize());
+   context->zout = malloc(context->zout_size);
+   context->cctx = ZSTD_createCCtx();
+   context->dctx = ZSTD_createDCtx();
+
+   if (context->zin == NULL || context->zout == NULL)
+   {
+      destroy_context(context);
+      return NULL;
+   }
+
+   pthread_setspecific(context_key, context);
+
+   return context;
+}
+
+static void
+create_context_key(void)
+{
+   // the context is freed when the thread exits
+   pthread_key_create(&context_key, destroy_context);
+}
+
+static void
+destroy_context(void* context)
+{
+   struct zstd_context* c = (struct zstd_context*)context;
+
+   if (c != NULL)
+   {
+      ZSTD_freeCCtx(c->cctx);
+      ZSTD_freeDCtx(c->dctx);
+      free(c->zin);
+      free(c->zout);
+      free(c);
+   }
+}
+
 static int
 zstd_compress(char* from, char* to, ZSTD_CCtx* cctx, size_t zin_size, void* zin, size_t zout_size, void* zout)
 {
    FILE* fin = NULL;
    FILE* fout = NULL;
    size_t toRead;
+   size_t frame_size = 0;
+   size_t frame_raw = 0;
+   size_t frame_compressed = 0;
+   struct zstd_seek_table* table = NULL;
+   unsigned char* seek_table = NULL;
+   size_t seek_table_size = 0;
+   struct file_hash* hash = NULL;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   // the seekable format ends a frame every frame_size raw bytes, and lists the frames at the end
+   if (config->compression_frame_size > 0)
+   {
+      frame_size = (size_t)config->compression_frame_size;
+      if (pgmoneta_zstd_seek_table_create(&table))
+      {
+         goto error;
+      }
+   }
 
    fin = fopen(from, "rb");
 
@@ -929,12 +1319,26 @@ zstd_compress(char* from, char* to, ZSTD_CCtx* cctx, size_t zin_size, void* zin,
       goto error;
    }
 
-   toRead = zin_size;
+   if (pgmoneta_file_hash_create(&hash))
+   {
+      goto error;
+   }
+
    for (;;)
    {
+      toRead = table != NULL ? MIN(zin_size, frame_size - frame_raw) : zin_size;
+
       size_t read = fread(zin, sizeof(char), toRead, fin);
       int lastChunk = (read < toRead);
-      ZSTD_EndDirective mode = lastChunk ? ZSTD_e_end : ZSTD_e_continue;
+
+      // the last frame ended exactly at the end of the file
+      if (read == 0 && table != NULL && table->frames > 0)
+      {
+         break;
+      }
+
+      int frameEnd = lastChunk || (table != NULL && frame_raw + read == frame_size);
+      ZSTD_EndDirective mode = frameEnd ? ZSTD_e_end : ZSTD_e_continue;
       ZSTD_inBuffer input = {zin, read, 0};
       int finished;
       do
@@ -947,19 +1351,54 @@ zstd_compress(char* from, char* to, ZSTD_CCtx* cctx, size_t zin_size, void* zin,
             goto error;
          }
          fwrite(zout, sizeof(char), output.pos, fout);
-         finished = lastChunk ? (remaining == 0) : (input.pos == input.size);
+         pgmoneta_file_hash_update(hash, zout, output.pos);
+         frame_compressed += output.pos;
+         finished = frameEnd ? (remaining == 0) : (input.pos == input.size);
       }
       while (!finished);
 
+      frame_raw += read;
+
+      if (table != NULL && frameEnd && frame_compressed > 0)
+      {
+         if (pgmoneta_zstd_seek_table_add(table, (uint32_t)frame_compressed, (uint32_t)frame_raw))
+         {
+            goto error;
+         }
+         frame_raw = 0;
+         frame_compressed = 0;
+      }
+
       if (lastChunk)
       {
          break;
       }
    }
 
+   if (table != NULL)
+   {
+      if (pgmoneta_zstd_seek_table_serialize(table, &seek_table, &seek_table_size))
+      {
+         goto error;
+      }
+
+      if (fwrite(seek_table, 1, seek_table_size, fout) != seek_table_size)
+      {
+         pgmoneta_log_error("ZSTD: Could not write the seek table of %s", to);
+         goto error;
+      }
+      pgmoneta_file_hash_update(hash, seek_table, seek_table_size);
+   }
+
    fclose(fout);
    fclose(fin);
 
+   pgmoneta_file_hash_finish(hash, to);
+
+   free(seek_table);
+   pgmoneta_zstd_seek_table_destroy(table);
+   pgmoneta_file_hash_destroy(hash);
+
    return 0;
 
 error:
@@ -974,6 +1413,10 @@ error:
       fclose(fin);
    }
 
+   free(seek_table);
+   pgmoneta_zstd_seek_table_destroy(table);
+   pgmoneta_file_hash_destroy(hash);
+
    return 1;
 }
 
@@ -1043,3 +1486,18 @@ error:
 
    return 1;
 }
+
+static void
+write_le32(unsigned char* buffer, uint32_t value)
+{
+   buffer[0] = (unsigned char)(value & 0xFF);
+   buffer[1] = (unsigned char)((value >> 8) & 0xFF);
+   buffer[2] = (unsigned char)((value >> 16) & 0xFF);
+   buffer[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+static uint32_t
+read_le32(unsigned char* buffer)
+{
+   return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
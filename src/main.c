@@ -51,6 +51,7 @@
 #include <security.h>
 #include <server.h>
 #include <shmem.h>
+#include <space.h>
 #include <status.h>
 #include <utils.h>
 #include <verify.h>
@@ -74,6 +75,7 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 
 #include <openssl/crypto.h>
 #ifdef HAVE_SYSTEMD
@@ -92,8 +94,11 @@ static void reload_cb(struct ev_loop* loop, ev_signal* w, int revents);
 static void coredump_cb(struct ev_loop* loop, ev_signal* w, int revents);
 static void wal_cb(struct ev_loop* loop, ev_periodic* w, int revents);
 static void retention_cb(struct ev_loop* loop, ev_periodic* w, int revents);
+static void verification_cb(struct ev_loop* loop, ev_periodic* w, int revents);
 static void valid_cb(struct ev_loop* loop, ev_periodic* w, int revents);
 static void wal_streaming_cb(struct ev_loop* loop, ev_periodic* w, int revents);
+static void space_cb(struct ev_loop* loop, ev_periodic* w, int revents);
+static void space_child_cb(struct ev_loop* loop, ev_child* w, int revents);
 static bool accept_fatal(int error);
 static bool reload_configuration(void);
 static void init_receivewals(void);
@@ -123,6 +128,7 @@ static struct accept_io io_management[MAX_FDS];
 static int* management_fds = NULL;
 static int management_fds_length = -1;
 static bool offline = false;
+static ev_child space_child;
 
 static void
 start_mgt(void)
@@ -245,8 +251,10 @@ main(int argc, char** argv)
    struct signal_info signal_watcher[5];
    struct ev_periodic wal;
    struct ev_periodic retention;
+   struct ev_periodic verification;
    struct ev_periodic valid;
    struct ev_periodic wal_streaming;
+   struct ev_periodic space;
    size_t shmem_size;
    size_t prometheus_cache_shmem_size = 0;
    struct main_configuration* config = NULL;
@@ -662,7 +670,7 @@ main(int argc, char** argv)
 
    if (!offline)
    {
-      /* Start WAL compression */
+      /* Start WAL compression fallback sweeper */
       if (config->compression_type != COMPRESSION_NONE ||
           config->encryption != ENCRYPTION_NONE)
       {
@@ -678,6 +686,17 @@ main(int argc, char** argv)
       ev_periodic_start(main_loop, &retention);
    }
 
+   if (!offline && config->verification_interval > 0)
+   {
+      /* Start scheduled backup verification */
+      ev_periodic_init(&verification, verification_cb, 0., config->verification_interval, 0);
+      ev_periodic_start(main_loop, &verification);
+   }
+
+   /* Start repository space reconciliation */
+   ev_periodic_init(&space, space_cb, 0., 60, 0);
+   ev_periodic_start(main_loop, &space);
+
    if (!offline)
    {
       pgmoneta_log_info("Started on %s", config->host);
@@ -1838,7 +1857,9 @@ wal_cb(struct ev_loop* loop __attribute__((unused)), ev_periodic* w __attribute_
 
    for (int i = 0; i < config->common.number_of_servers; i++)
    {
-      /* Compression is always in a fork() */
+      /* Segments are normally compressed and encrypted by the WAL receiver when */
+      /* they are closed, so this only sweeps up what was left behind. Compression */
+      /* is always in a fork() */
       if (!fork())
       {
          bool active = false;
@@ -1876,6 +1897,8 @@ wal_cb(struct ev_loop* loop __attribute__((unused)), ev_periodic* w __attribute_
 
             free(d);
 
+            pgmoneta_space_invalidate(i, SPACE_WAL);
+
             atomic_store(&config->common.servers[i].repository, false);
          }
 
@@ -1901,6 +1924,23 @@ retention_cb(struct ev_loop* loop __attribute__((unused)), ev_periodic* w __attr
    }
 }
 
+static void
+verification_cb(struct ev_loop* loop __attribute__((unused)), ev_periodic* w __attribute__((unused)), int revents)
+{
+   if (EV_ERROR & revents)
+   {
+      pgmoneta_log_trace("verification_cb: got invalid event: %s", strerror(errno));
+      errno = 0;
+      return;
+   }
+
+   if (!fork())
+   {
+      shutdown_ports();
+      pgmoneta_verification(argv_ptr);
+   }
+}
+
 static void
 valid_cb(struct ev_loop* loop __attribute__((unused)), ev_periodic* w __attribute__((unused)), int revents)
 {
@@ -1937,6 +1977,68 @@ valid_cb(struct ev_loop* loop __attribute__((unused)), ev_periodic* w __attribut
    }
 }
 
+static void
+space_cb(struct ev_loop* loop __attribute__((unused)), ev_periodic* w __attribute__((unused)), int revents)
+{
+   bool active = false;
+   pid_t pid;
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   if (EV_ERROR & revents)
+   {
+      pgmoneta_log_trace("space_cb: got invalid event: %s", strerror(errno));
+      errno = 0;
+      return;
+   }
+
+   /* Claimed here and released when the child is reaped, even if it didn't finish */
+   if (!atomic_compare_exchange_strong(&config->space_active, &active, true))
+   {
+      return;
+   }
+
+   pid = fork();
+   if (pid == -1)
+   {
+      pgmoneta_log_error("Space - Cannot create process");
+      atomic_store(&config->space_active, false);
+   }
+   else if (pid == 0)
+   {
+      pgmoneta_set_proc_title(1, argv_ptr, "space", NULL);
+
+      shutdown_ports();
+
+      pgmoneta_space_reconcile();
+
+      exit(0);
+   }
+   else
+   {
+      ev_child_init(&space_child, space_child_cb, pid, 0);
+      ev_child_start(main_loop, &space_child);
+   }
+}
+
+static void
+space_child_cb(struct ev_loop* loop, ev_child* w, int revents __attribute__((unused)))
+{
+   struct main_configuration* config;
+
+   config = (struct main_configuration*)shmem;
+
+   ev_child_stop(loop, w);
+
+   if (!WIFEXITED(w->rstatus) || WEXITSTATUS(w->rstatus) != 0)
+   {
+      pgmoneta_log_warn("Space: Reconciliation process %d did not finish", w->rpid);
+   }
+
+   atomic_store(&config->space_active, false);
+}
+
 static void
 wal_streaming_cb(struct ev_loop* loop __attribute__((unused)), ev_periodic* w __attribute__((unused)), int revents)
 {
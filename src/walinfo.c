@@ -63,7 +63,7 @@ usage(void)
    printf("\n");
 
    printf("Usage:\n");
-   printf("  pgmoneta-walinfo <file>\n");
+   printf("  pgmoneta-walinfo <file|directory>\n");
    printf("\n");
    printf("Options:\n");
    printf("  -c,   --config      Set the path to the pgmoneta_walinfo.conf file\n");
@@ -593,7 +593,7 @@ main(int argc, char** argv)
    }
    else
    {
-      fprintf(stderr, "Missing <file> argument\n");
+      fprintf(stderr, "Missing <file|directory> argument\n");
       usage();
       goto error;
    }
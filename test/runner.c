@@ -30,6 +30,8 @@
 
 #include "testcases/pgmoneta_test_1.h"
 #include "testcases/pgmoneta_test_2.h"
+#include "testcases/pgmoneta_test_3.h"
+#include "testcases/pgmoneta_test_4.h"
 
 int
 main(int argc, char* argv[])
@@ -44,6 +46,8 @@ main(int argc, char* argv[])
    int number_failed;
    Suite* s1;
    Suite* s2;
+   Suite* s3;
+   Suite* s4;
    SRunner* sr;
 
    if (pgmoneta_tsclient_init(argv[1]))
@@ -53,9 +57,13 @@ main(int argc, char* argv[])
 
    s1 = pgmoneta_test1_suite();
    s2 = pgmoneta_test2_suite();
+   s3 = pgmoneta_test3_suite();
+   s4 = pgmoneta_test4_suite();
 
    sr = srunner_create(s1);
    srunner_add_suite(sr, s2);
+   srunner_add_suite(sr, s3);
+   srunner_add_suite(sr, s4);
 
    // Run the tests in verbose mode
    srunner_run_all(sr, CK_VERBOSE);
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <tsclient.h>
+#include <string_builder.h>
+#include <utils.h>
+
+#include "pgmoneta_test_3.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define SCRAPE_SERVERS 64
+#define SCRAPE_BACKUPS 500
+
+static char* scrape_metrics[] = {"pgmoneta_backup", "pgmoneta_backup_verified", "pgmoneta_backup_version",
+                                 "pgmoneta_backup_total_elapsed_time", "pgmoneta_backup_start_timeline"};
+
+static void scrape_line(struct string_builder* sb, char* metric, int server, int backup);
+
+// test growth from a small capacity
+START_TEST(test_pgmoneta_string_builder_growth)
+{
+   struct string_builder* sb = NULL;
+   char* s = NULL;
+
+   ck_assert_msg(!pgmoneta_string_builder_create(4, &sb), "create failed");
+   ck_assert_msg(sb->capacity == 4, "capacity %zu", sb->capacity);
+
+   for (int i = 0; i < 10000; i++)
+   {
+      ck_assert_msg(!pgmoneta_string_builder_append_char(sb, 'a' + i % 26), "append_char failed at %d", i);
+   }
+   ck_assert_msg(!pgmoneta_string_builder_append(sb, "end"), "append failed");
+
+   ck_assert_msg(sb->length == 10003, "length %zu", sb->length);
+   ck_assert_msg(strlen(sb->data) == sb->length, "not terminated");
+   ck_assert_msg(sb->capacity > sb->length && sb->capacity == 16384, "capacity %zu", sb->capacity);
+   ck_assert_msg(sb->data[26] == 'a' && sb->data[9999] == 'a' + 9999 % 26, "wrong content");
+   ck_assert_msg(!strcmp(sb->data + 10000, "end"), "wrong tail");
+   ck_assert_msg(!sb->error, "error set");
+
+   s = pgmoneta_string_builder_finish(sb);
+   ck_assert_msg(s != NULL && strlen(s) == 10003, "finish failed");
+   free(s);
+}
+END_TEST
+// test formatting, also past the capacity
+START_TEST(test_pgmoneta_string_builder_append_format)
+{
+   struct string_builder* sb = NULL;
+   char large[1024];
+
+   memset(&large[0], 'x', sizeof(large) - 1);
+   large[sizeof(large) - 1] = '\0';
+
+   ck_assert_msg(!pgmoneta_string_builder_create(8, &sb), "create failed");
+
+   ck_assert_msg(!pgmoneta_string_builder_append_format(sb, "%s=%d;", "key", -42), "append_format failed");
+   ck_assert_msg(!strcmp(sb->data, "key=-42;"), "got %s", sb->data);
+
+   ck_assert_msg(!pgmoneta_string_builder_append_format(sb, "%zX|%.2f|%s", (size_t)255, 1.5, &large[0]), "append_format failed");
+   ck_assert_msg(!strncmp(sb->data, "key=-42;FF|1.50|xxx", 19), "got %.19s", sb->data);
+   ck_assert_msg(sb->length == 8 + 8 + sizeof(large) - 1, "length %zu", sb->length);
+   ck_assert_msg(strlen(sb->data) == sb->length, "not terminated");
+
+   ck_assert_msg(!pgmoneta_string_builder_append_ulong(sb, 18446744073709551615UL), "append_ulong failed");
+   ck_assert_msg(!pgmoneta_string_builder_append_bool(sb, true), "append_bool failed");
+   ck_assert_msg(!strcmp(sb->data + sb->length - 21, "184467440737095516151"), "got %s", sb->data + sb->length - 21);
+
+   ck_assert_msg(!pgmoneta_string_builder_append_int(sb, -2147483647 - 1), "append_int failed");
+   ck_assert_msg(!strcmp(sb->data + sb->length - 11, "-2147483648"), "got %s", sb->data + sb->length - 11);
+
+   pgmoneta_string_builder_destroy(sb);
+}
+END_TEST
+// test reset, which keeps the allocation
+START_TEST(test_pgmoneta_string_builder_reset)
+{
+   struct string_builder* sb = NULL;
+   size_t capacity;
+
+   ck_assert_msg(!pgmoneta_string_builder_create(0, &sb), "create failed");
+
+   for (int i = 0; i < 100; i++)
+   {
+      pgmoneta_string_builder_append(sb, "0123456789");
+   }
+   capacity = sb->capacity;
+
+   pgmoneta_string_builder_reset(sb);
+   ck_assert_msg(sb->length == 0 && sb->data[0] == '\0', "not empty");
+   ck_assert_msg(sb->capacity == capacity, "capacity %zu", sb->capacity);
+
+   ck_assert_msg(!pgmoneta_string_builder_indent(sb, "tag", 2), "indent failed");
+   ck_assert_msg(!strcmp(sb->data, "  tag"), "got %s", sb->data);
+
+   pgmoneta_string_builder_destroy(sb);
+}
+END_TEST
+// test that a failed append is remembered
+START_TEST(test_pgmoneta_string_builder_error)
+{
+   struct string_builder* sb = NULL;
+
+   ck_assert_msg(!pgmoneta_string_builder_create(0, &sb), "create failed");
+   ck_assert_msg(!pgmoneta_string_builder_append(sb, "ok"), "append failed");
+
+   ck_assert_msg(pgmoneta_string_builder_append_length(sb, "", SIZE_MAX / 2), "oversized append succeeded");
+   ck_assert_msg(sb->error, "error not set");
+   ck_assert_msg(pgmoneta_string_builder_append(sb, "more"), "append after error succeeded");
+   ck_assert_msg(!strcmp(sb->data, "ok"), "got %s", sb->data);
+
+   pgmoneta_string_builder_reset(sb);
+   ck_assert_msg(sb->error, "error cleared by reset");
+
+   ck_assert_msg(pgmoneta_string_builder_finish(sb) == NULL, "finish returned a string");
+}
+END_TEST
+
+// test a metrics page of 64 servers with 500 backups each, built in chunks like prometheus.c
+START_TEST(test_pgmoneta_string_builder_scrape)
+{
+   struct string_builder* chunk = NULL;
+   struct string_builder* page = NULL;
+   char* reference = NULL;
+   char line[256];
+   char* p = NULL;
+   size_t lines = 0;
+   int number_of_metrics = sizeof(scrape_metrics) / sizeof(scrape_metrics[0]);
+
+   ck_assert_msg(!pgmoneta_string_builder_create(0, &chunk), "create failed");
+   ck_assert_msg(!pgmoneta_string_builder_create(0, &page), "create failed");
+
+   for (int m = 0; m < number_of_metrics; m++)
+   {
+      pgmoneta_string_builder_append_format(chunk, "#HELP %s The metric\n", scrape_metrics[m]);
+      pgmoneta_string_builder_append_format(chunk, "#TYPE %s gauge\n", scrape_metrics[m]);
+      for (int i = 0; i < SCRAPE_SERVERS; i++)
+      {
+         for (int j = 0; j < SCRAPE_BACKUPS; j++)
+         {
+            scrape_line(chunk, scrape_metrics[m], i, j);
+         }
+      }
+      pgmoneta_string_builder_append(chunk, "\n");
+
+      // the chunk is sent, and reused for the next metric
+      ck_assert_msg(!pgmoneta_string_builder_append_length(page, chunk->data, chunk->length), "append of chunk failed");
+      pgmoneta_string_builder_reset(chunk);
+   }
+
+   ck_assert_msg(!chunk->error && !page->error, "error set");
+   ck_assert_msg(strlen(page->data) == page->length, "not terminated");
+
+   for (p = page->data; *p != '\0'; p++)
+   {
+      if (*p == '\n')
+      {
+         lines++;
+      }
+   }
+   ck_assert_msg(lines == (size_t)number_of_metrics * (3 + SCRAPE_SERVERS * SCRAPE_BACKUPS), "lines %zu", lines);
+
+   // the last backup of the last server of the last metric
+   snprintf(line, sizeof(line), "%s{name=\"server%d\", label=\"20250101%06d\"} %d\n\n",
+            scrape_metrics[number_of_metrics - 1], SCRAPE_SERVERS - 1, SCRAPE_BACKUPS - 1, SCRAPE_BACKUPS - 1);
+   ck_assert_msg(page->length > strlen(line) && !strcmp(page->data + page->length - strlen(line), line),
+                 "got %s", page->data + page->length - strlen(line));
+
+   // the first server of the first metric is the same as with pgmoneta_append
+   reference = pgmoneta_append(reference, "#HELP pgmoneta_backup The metric\n#TYPE pgmoneta_backup gauge\n");
+   for (int j = 0; j < SCRAPE_BACKUPS; j++)
+   {
+      snprintf(line, sizeof(line), "pgmoneta_backup{name=\"server0\", label=\"20250101%06d\"} %d\n", j, j);
+      reference = pgmoneta_append(reference, line);
+   }
+   ck_assert_msg(!strncmp(page->data, reference, strlen(reference)), "page differs from pgmoneta_append");
+
+   free(reference);
+   pgmoneta_string_builder_destroy(chunk);
+   pgmoneta_string_builder_destroy(page);
+}
+END_TEST
+
+Suite*
+pgmoneta_test3_suite()
+{
+   Suite* s;
+   TCase* tc_core;
+
+   s = suite_create("pgmoneta_test3");
+
+   tc_core = tcase_create("Core");
+
+   tcase_set_timeout(tc_core, 60);
+   tcase_add_test(tc_core, test_pgmoneta_string_builder_growth);
+   tcase_add_test(tc_core, test_pgmoneta_string_builder_append_format);
+   tcase_add_test(tc_core, test_pgmoneta_string_builder_reset);
+   tcase_add_test(tc_core, test_pgmoneta_string_builder_error);
+   tcase_add_test(tc_core, test_pgmoneta_string_builder_scrape);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+static void
+scrape_line(struct string_builder* sb, char* metric, int server, int backup)
+{
+   char label[32];
+
+   snprintf(label, sizeof(label), "20250101%06d", backup);
+
+   pgmoneta_string_builder_append(sb, metric);
+   pgmoneta_string_builder_append(sb, "{name=\"server");
+   pgmoneta_string_builder_append_int(sb, server);
+   pgmoneta_string_builder_append(sb, "\", label=\"");
+   pgmoneta_string_builder_append(sb, label);
+   pgmoneta_string_builder_append(sb, "\"} ");
+   pgmoneta_string_builder_append_int(sb, backup);
+   pgmoneta_string_builder_append(sb, "\n");
+}
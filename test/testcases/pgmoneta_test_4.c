@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2025 The pgmoneta community
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this
+ * list of conditions and the following disclaimer in the documentation and/or other
+ * materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may
+ * be used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <tsclient.h>
+#include <art.h>
+#include <csv.h>
+#include <manifest.h>
+
+#include "pgmoneta_test_4.h"
+
+#include <unistd.h>
+
+#define MANIFEST_ENTRIES 20000
+
+static int write_manifest(char* path, int from, int to, int changed_step, int deleted_step);
+
+// compare two manifests with deleted, changed and added files
+START_TEST(test_pgmoneta_compare_manifests)
+{
+   char old_manifest[] = "/tmp/pgmoneta_test_4_old_XXXXXX";
+   char new_manifest[] = "/tmp/pgmoneta_test_4_new_XXXXXX";
+   struct art* deleted = NULL;
+   struct art* changed = NULL;
+   struct art* added = NULL;
+   int fd;
+   int deleted_expected = 0;
+   int changed_expected = 0;
+   int added_expected = MANIFEST_ENTRIES / 10;
+
+   for (int i = 0; i < MANIFEST_ENTRIES; i++)
+   {
+      if (i % 10 == 0)
+      {
+         deleted_expected++;
+      }
+      else if (i % 7 == 0)
+      {
+         changed_expected++;
+      }
+   }
+
+   fd = mkstemp(old_manifest);
+   ck_assert_msg(fd != -1, "unable to create old manifest");
+   close(fd);
+   fd = mkstemp(new_manifest);
+   ck_assert_msg(fd != -1, "unable to create new manifest");
+   close(fd);
+
+   ck_assert_msg(!write_manifest(old_manifest, 0, MANIFEST_ENTRIES, 0, 0), "unable to write old manifest");
+   ck_assert_msg(!write_manifest(new_manifest, 0, MANIFEST_ENTRIES + added_expected, 7, 10), "unable to write new manifest");
+
+   ck_assert_msg(!pgmoneta_compare_manifests(old_manifest, new_manifest, &deleted, &changed, &added), "comparison failed");
+
+   ck_assert_msg(deleted->size == (uint64_t)deleted_expected, "deleted %lu, expected %d", (unsigned long)deleted->size, deleted_expected);
+   // the backup_manifest itself is reported as changed
+   ck_assert_msg(changed->size == (uint64_t)changed_expected + 1, "changed %lu, expected %d", (unsigned long)changed->size, changed_expected + 1);
+   ck_assert_msg(added->size == (uint64_t)added_expected, "added %lu, expected %d", (unsigned long)added->size, added_expected);
+   ck_assert_msg(pgmoneta_art_search(deleted, "base/1/10") != 0, "base/1/10 not deleted");
+   ck_assert_msg(pgmoneta_art_search(changed, "base/1/7") != 0, "base/1/7 not changed");
+   ck_assert_msg(pgmoneta_art_search(added, "base/1/20000") != 0, "base/1/20000 not added");
+   ck_assert_msg(!pgmoneta_art_contains_key(deleted, "base/1/1") && !pgmoneta_art_contains_key(changed, "base/1/1") &&
+                 !pgmoneta_art_contains_key(added, "base/1/1"), "base/1/1 reported");
+
+   pgmoneta_art_destroy(deleted);
+   pgmoneta_art_destroy(changed);
+   pgmoneta_art_destroy(added);
+   unlink(old_manifest);
+   unlink(new_manifest);
+}
+END_TEST
+
+Suite*
+pgmoneta_test4_suite()
+{
+   Suite* s;
+   TCase* tc_core;
+
+   s = suite_create("pgmoneta_test4");
+
+   tc_core = tcase_create("Core");
+
+   tcase_set_timeout(tc_core, 60);
+   tcase_add_test(tc_core, test_pgmoneta_compare_manifests);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+static int
+write_manifest(char* path, int from, int to, int changed_step, int deleted_step)
+{
+   struct csv_writer* writer = NULL;
+   char file[MISC_LENGTH];
+   char checksum[MISC_LENGTH];
+   char* cols[MANIFEST_COLUMN_COUNT];
+
+   if (pgmoneta_csv_writer_init(path, &writer))
+   {
+      return 1;
+   }
+
+   for (int i = from; i < to; i++)
+   {
+      if (deleted_step > 0 && i < MANIFEST_ENTRIES && i % deleted_step == 0)
+      {
+         continue;
+      }
+
+      snprintf(file, sizeof(file), "base/1/%d", i);
+      snprintf(checksum, sizeof(checksum), "%064x", (changed_step > 0 && i < MANIFEST_ENTRIES && i % changed_step == 0) ? i + 1 : i);
+
+      cols[MANIFEST_PATH_INDEX] = file;
+      cols[MANIFEST_CHECKSUM_INDEX] = checksum;
+      pgmoneta_csv_write(writer, MANIFEST_COLUMN_COUNT, cols);
+   }
+
+   pgmoneta_csv_writer_destroy(writer);
+
+   return 0;
+}